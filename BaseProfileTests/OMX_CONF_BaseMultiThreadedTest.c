@@ -60,28 +60,12 @@ static char szDesc[256];
     OMX_OSAL_Trace(OMX_OSAL_TRACE_ERROR, "%s\n", _desc);		\
 }
 
-#define LIST_CLEAR_ENTRY(_pL, _pB)	\
-    _pB = _pL->pBufHdr;			\
-    _pL->pBufHdr = NULL;		\
-    _pL = _pL->pNextBuf;
-
-#define LIST_SET_ENTRY(_pL, _pB)\
-{				\
-    BufferList *_pT = _pL;	\
-    while(_pT && _pT->pBufHdr){	\
-        _pT = _pT->pNextBuf;	\
-    }				\
-    if(_pT && !_pT->pBufHdr)	\
-        _pT->pBufHdr = _pB;	\
-}
-
 /*
  *     D E F I N I T I O N S
  */
 typedef struct _BufferList BufferList;
 
 struct _BufferList{
-    OMX_BUFFERHEADERTYPE *pBufHdr;
     OMX_BUFFERHEADERTYPE *pOrigBufHdr;
     BufferList *pNextBuf;
 };
@@ -105,6 +89,8 @@ typedef struct{
     OMX_HANDLETYPE hOutLock;
     BufferList *pInBufferList;
     BufferList *pOutBufferList;
+    OMX_HANDLETYPE hInQueue;    /* idle input buffers */
+    OMX_HANDLETYPE hOutQueue;   /* idle output buffers */
     OMX_PORT_PARAM_TYPE sPortParam[NUM_DOMAINS];
 } BaseMultiThreadedTestCtxt;
 
@@ -184,7 +170,7 @@ OMX_ERRORTYPE BaseMultiThreadedTest_EmptyBufferDone(OMX_IN OMX_HANDLETYPE hCompo
     else if(pCtxt->nInBufBusy){
         pCtxt->nInBufBusy--;
 	pCtxt->nBufDoneCalls++;
-	LIST_SET_ENTRY(pCtxt->pInBufferList, pBuffer);
+	OMX_OSAL_QueuePush(pCtxt->hInQueue, pBuffer);
 	OMX_OSAL_EventSet(pCtxt->hEmptyBufDoneEvent);
     }
     else{
@@ -217,7 +203,7 @@ OMX_ERRORTYPE BaseMultiThreadedTest_FillBufferDone(OMX_OUT OMX_HANDLETYPE hCompo
     else if(pCtxt->nOutBufBusy){
         pCtxt->nOutBufBusy--;
 	pCtxt->nBufDoneCalls++;
-	LIST_SET_ENTRY(pCtxt->pOutBufferList, pBuffer);
+	OMX_OSAL_QueuePush(pCtxt->hOutQueue, pBuffer);
 	OMX_OSAL_EventSet(pCtxt->hFillBufDoneEvent);
     }
     else{
@@ -251,7 +237,6 @@ OMX_ERRORTYPE BaseMultiThreadedTest_AllocateBuffers(BaseMultiThreadedTestCtxt *p
 						  0, pPortDef->nBufferSize));
 
 	pBufferList->pNextBuf = NULL;
- 	pBufferList->pBufHdr = pBufferHdr;
 	pBufferList->pOrigBufHdr = pBufferHdr;
 
 	if(pPortDef->eDir == OMX_DirInput){
@@ -269,6 +254,8 @@ OMX_ERRORTYPE BaseMultiThreadedTest_AllocateBuffers(BaseMultiThreadedTestCtxt *p
 		pTemp->pNextBuf = pBufferList;
 	    }
 	    pCtxt->nInBuf++;
+	    if(OMX_ErrorNone != OMX_OSAL_QueuePush(pCtxt->hInQueue, pBufferHdr))
+	        OMX_CONF_SET_ERROR_BAIL("Too many buffers to queue\n", OMX_ErrorInsufficientResources);
 	}
 	else{
 	    if(pBufferHdr->nAllocLen != pPortDef->nBufferSize || !pBufferHdr->pBuffer || 
@@ -285,6 +272,8 @@ OMX_ERRORTYPE BaseMultiThreadedTest_AllocateBuffers(BaseMultiThreadedTestCtxt *p
 		pTemp->pNextBuf = pBufferList;
 	    }
 	    pCtxt->nOutBuf++;
+	    if(OMX_ErrorNone != OMX_OSAL_QueuePush(pCtxt->hOutQueue, pBufferHdr))
+	        OMX_CONF_SET_ERROR_BAIL("Too many buffers to queue\n", OMX_ErrorInsufficientResources);
 	}
     }
 
@@ -299,6 +288,7 @@ OMX_CONF_TEST_BAIL:
 /*****************************************************************************/
 OMX_ERRORTYPE BaseMultiThreadedTest_DeInitBuffer(BaseMultiThreadedTestCtxt* pCtxt)
 {
+    OMX_BUFFERHEADERTYPE *pBufferHdr;
     BufferList *pBufferListObject;
     BufferList *pTemp;
     OMX_ERRORTYPE eError = OMX_ErrorNone;
@@ -319,6 +309,7 @@ OMX_ERRORTYPE BaseMultiThreadedTest_DeInitBuffer(BaseMultiThreadedTestCtxt* pCtx
 	pCtxt->nInBuf--;
     }
     pCtxt->pInBufferList = NULL;
+    while(OMX_ErrorNone == OMX_OSAL_QueuePop(pCtxt->hInQueue, 0, (OMX_PTR *)&pBufferHdr));
 
     pTemp = pCtxt->pOutBufferList;
     while(pTemp){
@@ -335,6 +326,7 @@ OMX_ERRORTYPE BaseMultiThreadedTest_DeInitBuffer(BaseMultiThreadedTestCtxt* pCtx
 	pCtxt->nOutBuf--;
     }
     pCtxt->pOutBufferList = NULL;
+    while(OMX_ErrorNone == OMX_OSAL_QueuePop(pCtxt->hOutQueue, 0, (OMX_PTR *)&pBufferHdr));
 OMX_CONF_TEST_BAIL:
     return eError;
 }
@@ -441,38 +433,38 @@ OMX_CONF_TEST_BAIL:
 /*****************************************************************************/
 OMX_U32 BaseMultiThreadedTest_ReadOutBuffers(OMX_PTR pParam)
 {
-    BufferList * pList;
-    OMX_BOOL bTimeout = OMX_FALSE;
     OMX_BUFFERHEADERTYPE *pBufHeader = NULL;
     OMX_ERRORTYPE eError = OMX_ErrorNone;
     BaseMultiThreadedTestCtxt * pCtxt;
     pCtxt = (BaseMultiThreadedTestCtxt *)pParam;
 
     OMX_OSAL_Trace(OMX_OSAL_TRACE_INFO, "Created new thread for output processing\n");
-    do{
-	OMX_OSAL_EventReset(pCtxt->hFillBufDoneEvent);
-        pList = pCtxt->pOutBufferList;
-	while(pList && pList->pBufHdr && pCtxt->nBufDoneCalls < OMX_CONF_BUFFERS_OF_TRAFFIC){
-	    OMX_OSAL_MutexLock(pCtxt->hOutLock);
-	    pCtxt->nOutBufBusy++;
-	    LIST_CLEAR_ENTRY(pList, pBufHeader);
-	    OMX_OSAL_MutexUnlock(pCtxt->hOutLock);
-	    OMX_CONF_BAIL_IF_ERROR(OMX_FillThisBuffer(pCtxt->hWComp, pBufHeader));
-	}
-	if(bTimeout == OMX_TRUE)
-	    OMX_CONF_SET_ERROR_BAIL("No Out buffers being processed\n", OMX_ErrorTimeout);
-	OMX_OSAL_EventWait(pCtxt->hFillBufDoneEvent, 
-			   OMX_CONF_TIMEOUT_BUFFER_TRAFFIC, &bTimeout);
-    } while(pCtxt->nBufDoneCalls < OMX_CONF_BUFFERS_OF_TRAFFIC); 
+    while(pCtxt->nBufDoneCalls < OMX_CONF_BUFFERS_OF_TRAFFIC){
+        /* wait for the component to hand back an output buffer */
+        if(OMX_ErrorNone != OMX_OSAL_QueuePop(pCtxt->hOutQueue, OMX_CONF_TIMEOUT_BUFFER_TRAFFIC, 
+                                              (OMX_PTR *)&pBufHeader)){
+            if(pCtxt->nBufDoneCalls < OMX_CONF_BUFFERS_OF_TRAFFIC)
+                OMX_CONF_SET_ERROR_BAIL("No Out buffers being processed\n", OMX_ErrorTimeout);
+            break;
+        }
+        if(pCtxt->nBufDoneCalls >= OMX_CONF_BUFFERS_OF_TRAFFIC){
+            OMX_OSAL_QueuePush(pCtxt->hOutQueue, pBufHeader);
+            break;
+        }
+        OMX_OSAL_MutexLock(pCtxt->hOutLock);
+        pCtxt->nOutBufBusy++;
+        OMX_OSAL_MutexUnlock(pCtxt->hOutLock);
+        OMX_CONF_BAIL_IF_ERROR(OMX_FillThisBuffer(pCtxt->hWComp, pBufHeader));
+    }
 
 OMX_CONF_TEST_BAIL:
     if(eError != OMX_ErrorNone){
         if(pCtxt->bStop && eError == OMX_ErrorIncorrectStateOperation){
-	    /* Expected behavior; fix the list */
+	    /* Expected behavior; give the buffer back */
 	    eError = OMX_ErrorNone;
 	    OMX_OSAL_MutexLock(pCtxt->hOutLock);
 	    pCtxt->nOutBufBusy--;
-	    LIST_SET_ENTRY(pCtxt->pOutBufferList, pBufHeader);
+	    OMX_OSAL_QueuePush(pCtxt->hOutQueue, pBufHeader);
 	    OMX_OSAL_MutexUnlock(pCtxt->hOutLock);
 	}
 	OMX_CONF_ErrorToString(eError, szDesc);
@@ -486,46 +478,46 @@ OMX_CONF_TEST_BAIL:
 /*****************************************************************************/
 OMX_U32 BaseMultiThreadedTest_WriteInBuffers(OMX_PTR pParam)
 {
-    BufferList * pList;
-    OMX_BOOL bTimeout = OMX_FALSE;
     OMX_BUFFERHEADERTYPE *pBufHeader = NULL;
     OMX_ERRORTYPE eError = OMX_ErrorNone;
     BaseMultiThreadedTestCtxt * pCtxt;
     pCtxt = (BaseMultiThreadedTestCtxt *)pParam;
 
     OMX_OSAL_Trace(OMX_OSAL_TRACE_INFO, "Created new thread for input processing\n");
-    do{
-	OMX_OSAL_EventReset(pCtxt->hEmptyBufDoneEvent);
-        pList = pCtxt->pInBufferList;
-	while(pList && pList->pBufHdr && pCtxt->nBufDoneCalls < OMX_CONF_BUFFERS_OF_TRAFFIC){
-	    OMX_OSAL_MutexLock(pCtxt->hInLock);
-	    pCtxt->nInBufBusy++;
-	    LIST_CLEAR_ENTRY(pList, pBufHeader);
-	    OMX_OSAL_MutexUnlock(pCtxt->hInLock);
-
-       pBufHeader->nOffset = 0;
-            pBufHeader->nFilledLen = OMX_OSAL_ReadFromInputFileWithSize(pBufHeader->pBuffer, pBufHeader->nAllocLen, pBufHeader->nInputPortIndex); 
-	    if(OMX_OSAL_InputFileAtEOS(pBufHeader->nInputPortIndex)){
-	        pBufHeader->nFlags |= OMX_BUFFERFLAG_EOS;
-		pCtxt->nBufDoneCalls = OMX_CONF_BUFFERS_OF_TRAFFIC;
-	    }
-	    OMX_CONF_BAIL_IF_ERROR(OMX_EmptyThisBuffer(pCtxt->hWComp, pBufHeader));
-	}
-	if(bTimeout == OMX_TRUE)
-	    OMX_CONF_SET_ERROR_BAIL("No In buffers being processed\n", OMX_ErrorTimeout);
-	OMX_OSAL_EventWait(pCtxt->hEmptyBufDoneEvent, 
-			   OMX_CONF_TIMEOUT_BUFFER_TRAFFIC, &bTimeout);
-    } while(pCtxt->nBufDoneCalls < OMX_CONF_BUFFERS_OF_TRAFFIC); 
+    while(pCtxt->nBufDoneCalls < OMX_CONF_BUFFERS_OF_TRAFFIC){
+        /* wait for the component to hand back an input buffer */
+        if(OMX_ErrorNone != OMX_OSAL_QueuePop(pCtxt->hInQueue, OMX_CONF_TIMEOUT_BUFFER_TRAFFIC, 
+                                              (OMX_PTR *)&pBufHeader)){
+            if(pCtxt->nBufDoneCalls < OMX_CONF_BUFFERS_OF_TRAFFIC)
+                OMX_CONF_SET_ERROR_BAIL("No In buffers being processed\n", OMX_ErrorTimeout);
+            break;
+        }
+        if(pCtxt->nBufDoneCalls >= OMX_CONF_BUFFERS_OF_TRAFFIC){
+            OMX_OSAL_QueuePush(pCtxt->hInQueue, pBufHeader);
+            break;
+        }
+        OMX_OSAL_MutexLock(pCtxt->hInLock);
+        pCtxt->nInBufBusy++;
+        OMX_OSAL_MutexUnlock(pCtxt->hInLock);
+
+        pBufHeader->nOffset = 0;
+        pBufHeader->nFilledLen = OMX_OSAL_ReadFromInputFileWithSize(pBufHeader->pBuffer, pBufHeader->nAllocLen, pBufHeader->nInputPortIndex); 
+        if(OMX_OSAL_InputFileAtEOS(pBufHeader->nInputPortIndex)){
+            pBufHeader->nFlags |= OMX_BUFFERFLAG_EOS;
+            pCtxt->nBufDoneCalls = OMX_CONF_BUFFERS_OF_TRAFFIC;
+        }
+        OMX_CONF_BAIL_IF_ERROR(OMX_EmptyThisBuffer(pCtxt->hWComp, pBufHeader));
+    }
 
 OMX_CONF_TEST_BAIL:
     if(eError != OMX_ErrorNone){
         if(pCtxt->bStop && eError == OMX_ErrorIncorrectStateOperation){
-	    /* Expected behavior; fix the list */
+	    /* Expected behavior; give the buffer back */
 	    eError = OMX_ErrorNone;
 
 	    OMX_OSAL_MutexLock(pCtxt->hInLock);
 	    pCtxt->nInBufBusy--;
-	    LIST_SET_ENTRY(pCtxt->pInBufferList, pBufHeader);
+	    OMX_OSAL_QueuePush(pCtxt->hInQueue, pBufHeader);
 	    OMX_OSAL_MutexUnlock(pCtxt->hInLock);
 	}
 	OMX_CONF_ErrorToString(eError, szDesc);
@@ -638,9 +630,9 @@ OMX_ERRORTYPE BaseMultiThreadedTest_TransmitTest(BaseMultiThreadedTestCtxt* pCtx
     }
 
     if(pCtxt->nOutBuf)
-        OMX_CONF_BAIL_IF_ERROR( OMX_OSAL_ThreadCreate(BaseMultiThreadedTest_ReadOutBuffers, (OMX_PTR)pCtxt, 0, hOutThread) );
+        OMX_CONF_BAIL_IF_ERROR( OMX_OSAL_ThreadPoolSubmit(BaseMultiThreadedTest_ReadOutBuffers, (OMX_PTR)pCtxt, 0, 0, hOutThread) );
     if(pCtxt->nInBuf)
-        OMX_CONF_BAIL_IF_ERROR( OMX_OSAL_ThreadCreate(BaseMultiThreadedTest_WriteInBuffers, (OMX_PTR)pCtxt, 0, hInThread) );
+        OMX_CONF_BAIL_IF_ERROR( OMX_OSAL_ThreadPoolSubmit(BaseMultiThreadedTest_WriteInBuffers, (OMX_PTR)pCtxt, 0, 0, hInThread) );
 
     if(bClose){
         /* process buffers */
@@ -650,9 +642,9 @@ OMX_ERRORTYPE BaseMultiThreadedTest_TransmitTest(BaseMultiThreadedTestCtxt* pCtx
 	}
 
     if(pCtxt->nOutBuf)	
-       OMX_CONF_BAIL_IF_ERROR(OMX_OSAL_ThreadDestroy(*hOutThread));
+       OMX_CONF_BAIL_IF_ERROR(OMX_OSAL_ThreadPoolWait(*hOutThread, NULL));
     if(pCtxt->nInBuf)
-       OMX_CONF_BAIL_IF_ERROR(OMX_OSAL_ThreadDestroy(*hInThread));
+       OMX_CONF_BAIL_IF_ERROR(OMX_OSAL_ThreadPoolWait(*hInThread, NULL));
 
     *hInThread = *hOutThread;
 	if(pCtxt->eThreadError){
@@ -724,6 +716,8 @@ OMX_ERRORTYPE OMX_CONF_BaseMultiThreadedTest(OMX_IN OMX_STRING cComponentName)
     OMX_OSAL_EventReset(pCtxt->hThreadEvent);
     OMX_OSAL_MutexCreate(&pCtxt->hInLock);
     OMX_OSAL_MutexCreate(&pCtxt->hOutLock);
+    OMX_OSAL_QueueCreate(OMX_CONF_BUFFERQUEUE_ENTRIES, &pCtxt->hInQueue);
+    OMX_OSAL_QueueCreate(OMX_CONF_BUFFERQUEUE_ENTRIES, &pCtxt->hOutQueue);
     OMX_OSAL_EventCreate(&pCtxt->hBufDoneCallsEvent);
     OMX_OSAL_EventReset(pCtxt->hBufDoneCallsEvent);
     
@@ -793,8 +787,8 @@ OMX_ERRORTYPE OMX_CONF_BaseMultiThreadedTest(OMX_IN OMX_STRING cComponentName)
     OMX_CONF_BAIL_IF_ERROR(BaseMultiThreadedTest_OperateOnPorts(pCtxt, OpenFile));
 
     /* create a separate initialization thread (InitialThread) */
-    OMX_CONF_BAIL_IF_ERROR(OMX_OSAL_ThreadCreate(BaseMultiThreadedTest_IntialThread, 
-						 (OMX_PTR)pCtxt, 0, &hInitialThread));
+    OMX_CONF_BAIL_IF_ERROR(OMX_OSAL_ThreadPoolSubmit(BaseMultiThreadedTest_IntialThread, 
+						 (OMX_PTR)pCtxt, 0, 0, &hInitialThread));
 
     /* wait for initialization thread to send idle command  (InitialThread)*/
     OMX_OSAL_EventWait(pCtxt->hThreadEvent, OMX_CONF_TIMEOUT_EXPECTING_SUCCESS, &bTimeout);
@@ -815,8 +809,8 @@ OMX_ERRORTYPE OMX_CONF_BaseMultiThreadedTest(OMX_IN OMX_STRING cComponentName)
     
     /* create a relay thread that will change component state to executing (RelayThread) */
     OMX_OSAL_EventReset(pCtxt->hThreadEvent);
-    OMX_CONF_BAIL_IF_ERROR(OMX_OSAL_ThreadCreate(BaseMultiThreadedTest_RelayThread, 
-    						 (OMX_PTR)pCtxt, 0, &hRelayThread));
+    OMX_CONF_BAIL_IF_ERROR(OMX_OSAL_ThreadPoolSubmit(BaseMultiThreadedTest_RelayThread, 
+    						 (OMX_PTR)pCtxt, 0, 0, &hRelayThread));
     /* wait for relay thread to put component in execute state */
     /* Note that the we allow 2 x OMX_CONF_TIMEOUT_EXPECTING_SUCCESS here as
        the RelayThread may itself wait */
@@ -829,9 +823,9 @@ OMX_ERRORTYPE OMX_CONF_BaseMultiThreadedTest(OMX_IN OMX_STRING cComponentName)
     OMX_CONF_BAIL_IF_ERROR(BaseMultiThreadedTest_TransmitTest(pCtxt, OMX_FALSE, OMX_TRUE, &hInThread, &hOutThread));
 
     /* Cleanup accesories threads */
-    OMX_CONF_BAIL_IF_ERROR(OMX_OSAL_ThreadDestroy(hInitialThread));
+    OMX_CONF_BAIL_IF_ERROR(OMX_OSAL_ThreadPoolWait(hInitialThread, NULL));
     OMX_CONF_BAIL_IF_ERROR(pCtxt->eThreadError);
-    OMX_CONF_BAIL_IF_ERROR(OMX_OSAL_ThreadDestroy(hRelayThread));
+    OMX_CONF_BAIL_IF_ERROR(OMX_OSAL_ThreadPoolWait(hRelayThread, NULL));
     OMX_CONF_BAIL_IF_ERROR(pCtxt->eThreadError);
 
     /* 3.7.3. Start and Stop in different threads */
@@ -848,8 +842,8 @@ OMX_ERRORTYPE OMX_CONF_BaseMultiThreadedTest(OMX_IN OMX_STRING cComponentName)
     }
 
     /* create a separate thread to send idle command */
-    OMX_CONF_BAIL_IF_ERROR(OMX_OSAL_ThreadCreate(BaseMultiThreadedTest_StopThread, 
-						 (OMX_PTR)pCtxt, 0, &hStopThread));
+    OMX_CONF_BAIL_IF_ERROR(OMX_OSAL_ThreadPoolSubmit(BaseMultiThreadedTest_StopThread, 
+						 (OMX_PTR)pCtxt, 0, 0, &hStopThread));
 
     /* wait for stop thread to send idle command */
     OMX_OSAL_EventWait(pCtxt->hThreadEvent, OMX_CONF_TIMEOUT_EXPECTING_SUCCESS, &bTimeout);
@@ -858,9 +852,9 @@ OMX_ERRORTYPE OMX_CONF_BaseMultiThreadedTest(OMX_IN OMX_STRING cComponentName)
     OMX_CONF_BAIL_IF_ERROR(pCtxt->eThreadError);
 
     if(hInThread)
-       OMX_OSAL_ThreadDestroy(hInThread);
+       OMX_OSAL_ThreadPoolWait(hInThread, NULL);
     if(hOutThread)
-       OMX_OSAL_ThreadDestroy(hOutThread);
+       OMX_OSAL_ThreadPoolWait(hOutThread, NULL);
     /* wrap up buffer processing */
     OMX_OSAL_EventWait(pCtxt->hStateSetEvent, OMX_CONF_TIMEOUT_EXPECTING_SUCCESS, &bTimeout);
     OMX_CONF_BAIL_IF_ERROR(OMX_GetState(pCtxt->hWComp, &pCtxt->eState));
@@ -870,7 +864,7 @@ OMX_ERRORTYPE OMX_CONF_BaseMultiThreadedTest(OMX_IN OMX_STRING cComponentName)
     OMX_CONF_BAIL_IF_ERROR(BaseMultiThreadedTest_TransitionWait(OMX_StateLoaded, pCtxt));
     OMX_CONF_BAIL_IF_ERROR(BaseMultiThreadedTest_OperateOnPorts(pCtxt, CloseFile));
 
-    OMX_CONF_BAIL_IF_ERROR(OMX_OSAL_ThreadDestroy(hStopThread));
+    OMX_CONF_BAIL_IF_ERROR(OMX_OSAL_ThreadPoolWait(hStopThread, NULL));
     OMX_CONF_BAIL_IF_ERROR(pCtxt->eThreadError);
 
 OMX_CONF_TEST_BAIL:
@@ -908,6 +902,8 @@ OMX_CONF_TEST_BAIL:
     OMX_OSAL_EventDestroy(pCtxt->hThreadEvent);
     OMX_OSAL_MutexDestroy(pCtxt->hInLock);
     OMX_OSAL_MutexDestroy(pCtxt->hOutLock);
+    OMX_OSAL_QueueDestroy(pCtxt->hInQueue);
+    OMX_OSAL_QueueDestroy(pCtxt->hOutQueue);
     OMX_OSAL_EventDestroy(pCtxt->hBufDoneCallsEvent);
 
     return eError;
@@ -92,45 +92,6 @@ static char szState[256];
     OMX_CONF_SET_STATE(_p_, _s_, _e_);\
     OMX_CONF_WAIT_STATE(_p_, _s_, _e_)
 
-#define Q_ALLOC(_p_, _n_)\
-    _p_ = (QTYPE*)OMX_OSAL_Malloc(sizeof(QTYPE) + (sizeof(OMX_PTR) * (_n_ + 1)));\
-    if (0x0 != _p_)\
-    {\
-        _p_->nNumEntries = _n_;\
-        _p_->nEnd = 0;\
-        _p_->nStart = 0;\
-        _p_->nInQueue = 0;\
-    }
-
-#define Q_FREE(_p_)\
-    if (0x0 != _p_)\
-    {\
-        OMX_OSAL_Free(_p_);\
-    }\
-    _p_ = 0x0
-    
-#define Q_ADD(_p_, _e_)\
-    _p_->aEntires[_p_->nStart++] = (OMX_PTR)_e_;\
-    if (_p_->nStart == _p_->nNumEntries) _p_->nStart = 0;\
-    _p_->nInQueue++
-
-#define Q_PEEK(_p_, _e_)\
-    if (0x0 != _p_->nInQueue)\
-    {\
-        _e_ = _p_->aEntires[_p_->nEnd];\
-    }    
-
-#define Q_REMOVE(_p_, _e_)\
-    _e_ = 0x0;\
-    if (0x0 != _p_->nInQueue)\
-    {\
-        _e_ = _p_->aEntires[_p_->nEnd++];\
-        if (_p_->nEnd == _p_->nNumEntries) _p_->nEnd = 0;\
-        _p_->nInQueue--;\
-    }    
-
-#define Q_INQUEUE(_p_) _p_->nInQueue
-
 
 /*
  *     D E F I N I T I O N S
@@ -138,21 +99,11 @@ static char szState[256];
 
 typedef struct _TEST_CTXTYPE TEST_CTXTYPE;
 
-typedef struct _QTYPE
-{
-    OMX_U32 nNumEntries;
-    OMX_U32 nEnd;
-    OMX_U32 nStart;
-    OMX_U32 nInQueue;
-    OMX_PTR aEntires[1];
-
-} QTYPE;
-
 typedef struct _TEST_PORTTYPE
 {
     TEST_CTXTYPE *pCtx;
     OMX_PARAM_PORTDEFINITIONTYPE sPortDef;
-    QTYPE *pQ;
+    OMX_HANDLETYPE hQueue;
     OMX_U32 nBuffersOutstanding;
     OMX_U32 nBuffersProcessed;
     OMX_BOOL bEOS;
@@ -224,17 +175,17 @@ OMX_ERRORTYPE BufferFlagTest_EmptyBufferDone(
         pCtx = pPort->pCtx;
     
         /* EmptyBufferDone can only be called from an input port */
-        if ((OMX_DirInput == pPort->sPortDef.eDir) && (0x0 != pPort->pQ))
+        if ((OMX_DirInput == pPort->sPortDef.eDir) && (0x0 != pPort->hQueue))
         {
             /* when the queue is full, don't add another buffer header
                as something is wrong with the component.  It is 
                incorrectly returning more buffers than sent in */
-            if (Q_INQUEUE(pPort->pQ) < pPort->sPortDef.nBufferCountActual)
+            if (OMX_OSAL_QueueCount(pPort->hQueue) < pPort->sPortDef.nBufferCountActual)
             {
                 pBufHdr->hMarkTargetComponent = 0x0;
                 pBufHdr->pMarkData = 0x0;
                 pBufHdr->nFlags = 0x0;
-                Q_ADD(pPort->pQ, pBufHdr);
+                OMX_OSAL_QueuePush(pPort->hQueue, pBufHdr);
                 pPort->nBuffersOutstanding--;
                 pPort->nBuffersProcessed++;
                 pCtx->nBuffersProcessed++;
@@ -267,7 +218,7 @@ OMX_ERRORTYPE BufferFlagTest_FillBufferDone(
         pCtx = pPort->pCtx;
 
         /* FillBufferDone can only be called from an output port */
-        if ((OMX_DirOutput == pPort->sPortDef.eDir) && (0x0 != pPort->pQ))
+        if ((OMX_DirOutput == pPort->sPortDef.eDir) && (0x0 != pPort->hQueue))
         {
             if (OMX_BUFFERFLAG_EOS & pBufHdr->nFlags)
             {
@@ -293,7 +244,7 @@ OMX_ERRORTYPE BufferFlagTest_FillBufferDone(
             /* when the queue is full, don't add another buffer header
                as something is wrong with the component.  It is 
                incorrectly returning more buffers than sent in */
-            if (Q_INQUEUE(pPort->pQ) < pPort->sPortDef.nBufferCountActual)
+            if (OMX_OSAL_QueueCount(pPort->hQueue) < pPort->sPortDef.nBufferCountActual)
             {
                 /* write to file if enabled */
                 if (OMX_TRUE == pPort->bOpenFile)
@@ -302,7 +253,7 @@ OMX_ERRORTYPE BufferFlagTest_FillBufferDone(
                                                pBufHdr->nFilledLen, pPort->sPortDef.nPortIndex);
                 }
 
-                Q_ADD(pPort->pQ, pBufHdr);
+                OMX_OSAL_QueuePush(pPort->hQueue, pBufHdr);
                 pPort->nBuffersOutstanding--;
                 pPort->nBuffersProcessed++;
                 pCtx->nBuffersProcessed++;
@@ -467,12 +418,12 @@ OMX_ERRORTYPE BufferFlagTest_SendNBuffers(
 
     if (OMX_DirInput == pPort->sPortDef.eDir)
     {
-        while ((0x0 != Q_INQUEUE(pPort->pQ)) && (0x0 != nNumBuffers))
+        while ((0x0 != OMX_OSAL_QueueCount(pPort->hQueue)) && (0x0 != nNumBuffers))
         {
             if (OMX_TRUE == pCtx->bForceEOS)
             {
                 /* when forcing end of stream, set the flag only once */
-                Q_REMOVE(pPort->pQ, pBufHdr);
+                OMX_OSAL_QueuePop(pPort->hQueue, 0, (OMX_PTR *)&pBufHdr);
                 pBufHdr->nFilledLen = 0x0;
                 if (OMX_TRUE != pPort->bEOS)
                 {
@@ -492,7 +443,7 @@ OMX_ERRORTYPE BufferFlagTest_SendNBuffers(
 
                 }
          
-                Q_REMOVE(pPort->pQ, pBufHdr);
+                OMX_OSAL_QueuePop(pPort->hQueue, 0, (OMX_PTR *)&pBufHdr);
                 if (OMX_TRUE == bReadFromInputFile)
                 {
                     pBufHdr->nOffset = 0;
@@ -540,9 +491,9 @@ OMX_ERRORTYPE BufferFlagTest_SendNBuffers(
 
     } else
     {
-        while ((0x0 != Q_INQUEUE(pPort->pQ)) && (0x0 != nNumBuffers))
+        while ((0x0 != OMX_OSAL_QueueCount(pPort->hQueue)) && (0x0 != nNumBuffers))
         {
-            Q_REMOVE(pPort->pQ, pBufHdr);
+            OMX_OSAL_QueuePop(pPort->hQueue, 0, (OMX_PTR *)&pBufHdr);
 
             /* mark buffer header as empty on OMX_FillThisBuffer calls */
             pBufHdr->nFlags = 0x0; 
@@ -596,7 +547,7 @@ OMX_ERRORTYPE BufferFlagTest_ProcessNBuffers(
         bHasPortDir = OMX_FALSE;
         for (i = 0; i < pCtx->nNumPorts; i++, pPort++)
         {
-            nToSend = Q_INQUEUE(pPort->pQ);            
+            nToSend = OMX_OSAL_QueueCount(pPort->hQueue);            
             eError = BufferFlagTest_SendNBuffers(pCtx, pPort, nToSend, OMX_TRUE);
             OMX_CONF_BAIL_ON_ERROR(eError);
             nSent += nToSend;
@@ -663,7 +614,7 @@ OMX_ERRORTYPE BufferFlagTest_PortAllocateNumBuffers(
                                     pPort->sPortDef.nPortIndex, 
                                     pPort, pPort->sPortDef.nBufferSize);
         OMX_CONF_BAIL_ON_ERROR(eError);
-        Q_ADD(pPort->pQ, pBufHdr);
+        OMX_OSAL_QueuePush(pPort->hQueue, pBufHdr);
         if (pBufHdr->pAppPrivate != (OMX_PTR)pPort)
         {
             OMX_CONF_SET_ERROR_BAIL(eError, OMX_ErrorUndefined, 
@@ -689,9 +640,9 @@ OMX_ERRORTYPE BufferFlagTest_PortFreeNumBuffers(
     OMX_ERRORTYPE eError = OMX_ErrorNone;
     OMX_BUFFERHEADERTYPE *pBufHdr;
 
-    while ((0x0 != Q_INQUEUE(pPort->pQ)) && (0x0 != nNumBuffers))
+    while ((0x0 != OMX_OSAL_QueueCount(pPort->hQueue)) && (0x0 != nNumBuffers))
     {
-        Q_REMOVE(pPort->pQ, pBufHdr);
+        OMX_OSAL_QueuePop(pPort->hQueue, 0, (OMX_PTR *)&pBufHdr);
         eError = OMX_FreeBuffer(pCtx->hWrappedComp, pPort->sPortDef.nPortIndex, pBufHdr);
         OMX_CONF_BAIL_ON_ERROR(eError);
         nNumBuffers--;
@@ -871,8 +822,7 @@ OMX_ERRORTYPE BufferFlagTest_AllocatePortStructures(
                 }
     
                 /* allocate LIFO with that or the actual required buffers */
-                Q_ALLOC(pPort->pQ, (pPort->sPortDef.nBufferCountActual));
-                if (0x0 == pPort->pQ)
+                if (OMX_ErrorNone != OMX_OSAL_QueueCreate(pPort->sPortDef.nBufferCountActual, &pPort->hQueue))
                 {
                     OMX_CONF_SET_ERROR_BAIL(eError, OMX_ErrorUndefined, 
                                             "memory allocation failure\n");
@@ -905,23 +855,23 @@ OMX_ERRORTYPE BufferFlagTest_FreePortStructures(TEST_CTXTYPE *pCtx)
         for (i = 0; i < pCtx->nNumPorts; i++)
         {
             /* free all allocated buffers */
-            if (0x0 != pPort->pQ)
+            if (0x0 != pPort->hQueue)
             {
                 if (OMX_ErrorNone == eError)
                 {
                     /* record the return code, but don't exit on failure as the 
                        test has memory it must free */
-                    eError = BufferFlagTest_PortFreeNumBuffers(pCtx, pPort, Q_INQUEUE(pPort->pQ));
+                    eError = BufferFlagTest_PortFreeNumBuffers(pCtx, pPort, OMX_OSAL_QueueCount(pPort->hQueue));
   
                 } else
                 {
                     /* preserve the first failure from freeing buffers */
-                    BufferFlagTest_PortFreeNumBuffers(pCtx, pPort, Q_INQUEUE(pPort->pQ));
+                    BufferFlagTest_PortFreeNumBuffers(pCtx, pPort, OMX_OSAL_QueueCount(pPort->hQueue));
                 }    
        
                 /* free LIFO */
-                Q_FREE(pPort->pQ);
-                pPort->pQ = 0x0;
+                OMX_OSAL_QueueDestroy(pPort->hQueue);
+                pPort->hQueue = 0x0;
 
             }
 
@@ -966,7 +916,7 @@ OMX_ERRORTYPE BufferFlagTest_AllocateAllBuffers(TEST_CTXTYPE *pCtx)
                       pPort->sPortDef.nBufferCountActual, pPort->sPortDef.nPortIndex);
         /* allocate all buffers on each port */
         nCount = pPort->sPortDef.nBufferCountActual;
-        nCount -= Q_INQUEUE(pPort->pQ);
+        nCount -= OMX_OSAL_QueueCount(pPort->hQueue);
         eError = BufferFlagTest_PortAllocateNumBuffers(pCtx, pPort, nCount);
         OMX_CONF_BAIL_ON_ERROR(eError);
         pPort++;
@@ -1034,7 +984,7 @@ OMX_ERRORTYPE BufferFlagTest_FreeAllBuffers(TEST_CTXTYPE *pCtx)
         OMX_OSAL_Trace(OMX_OSAL_TRACE_INFO, "Freeing all buffers on port %i\n",
                        pPort->sPortDef.nPortIndex);
         eError = BufferFlagTest_PortFreeNumBuffers(pCtx, pPort, 
-                                          Q_INQUEUE(pPort->pQ));
+                                          OMX_OSAL_QueueCount(pPort->hQueue));
         OMX_CONF_BAIL_ON_ERROR(eError);
         pPort++;
     }
@@ -60,6 +60,13 @@ static char szState[256];
     OMX_OSAL_Trace(OMX_OSAL_TRACE_ERROR, _s_);\
     goto OMX_CONF_TEST_BAIL
 
+/* a pop can fail with entries counted, leaving the last buffer header behind */
+#define OMX_CONF_BAIL_ON_QUEUE_ERROR(_e_)\
+    if (OMX_ErrorNone != (_e_))\
+    {\
+        OMX_CONF_SET_ERROR_BAIL(_e_, _e_, "Buffer queue operation failed\n");\
+    }
+
 #define OMX_CONF_WAIT_STATE(_p_, _s_, _e_)\
 {\
     OMX_BOOL _bTimeout_;\
@@ -94,65 +101,17 @@ static char szState[256];
     OMX_CONF_SET_STATE(_p_, _s_, _e_);\
     OMX_CONF_WAIT_STATE(_p_, _s_, _e_)
     
-#define Q_ALLOC(_p_, _n_)\
-    _p_ = (QTYPE*)OMX_OSAL_Malloc(sizeof(QTYPE) + (sizeof(OMX_PTR) * (_n_ + 1)));\
-    if (0x0 != _p_)\
-    {\
-        _p_->nNumEntries = _n_;\
-        _p_->nEnd = 0;\
-        _p_->nStart = 0;\
-        _p_->nInQueue = 0;\
-    }
-
-#define Q_FREE(_p_)\
-    if (0x0 != _p_)\
-    {\
-        OMX_OSAL_Free(_p_);\
-    }\
-    _p_ = 0x0
-    
-#define Q_ADD(_p_, _e_)\
-    _p_->aEntires[_p_->nStart++] = (OMX_PTR)_e_;\
-    if (_p_->nStart == _p_->nNumEntries) _p_->nStart = 0;\
-    _p_->nInQueue++
-
-#define Q_PEEK(_p_, _e_)\
-    if (0x0 != _p_->nInQueue)\
-    {\
-        _e_ = _p_->aEntires[_p_->nEnd];\
-    }    
-
-#define Q_REMOVE(_p_, _e_)\
-    if (0x0 != _p_->nInQueue)\
-    {\
-        _e_ = _p_->aEntires[_p_->nEnd++];\
-        if (_p_->nEnd == _p_->nNumEntries) _p_->nEnd = 0;\
-        _p_->nInQueue--;\
-    }    
-
-#define Q_INQUEUE(_p_) _p_->nInQueue
-
 /*
  *     D E F I N I T I O N S
  */
 
 typedef struct _TEST_CTXTYPE TEST_CTXTYPE;
 
-typedef struct _QTYPE
-{
-    OMX_U32 nNumEntries;
-    OMX_U32 nEnd;
-    OMX_U32 nStart;
-    OMX_U32 nInQueue;
-    OMX_PTR aEntires[1];
-
-} QTYPE;
-
 typedef struct _TEST_PORTTYPE
 {
     TEST_CTXTYPE *pCtx;
     OMX_PARAM_PORTDEFINITIONTYPE sPortDef;
-    QTYPE *pQ;
+    OMX_HANDLETYPE hQueue;
     OMX_U32 nBuffersOutstanding;
     OMX_BOOL bEOS;
     OMX_BOOL bOpenFile;
@@ -223,14 +182,19 @@ OMX_ERRORTYPE FlushTest_EmptyBufferDone(
         pCtx = pPort->pCtx;
     
         /* EmptyBufferDone can only be called from an input port */
-        if ((OMX_DirInput == pPort->sPortDef.eDir) && (0x0 != pPort->pQ))
+        if ((OMX_DirInput == pPort->sPortDef.eDir) && (0x0 != pPort->hQueue))
         {
             /* when the queue is full, don't add another buffer header
                as something is wrong with the component.  It is 
                incorrectly returning more buffers than sent in */
-            if (Q_INQUEUE(pPort->pQ) < pPort->sPortDef.nBufferCountActual)
+            if (OMX_OSAL_QueueCount(pPort->hQueue) < pPort->sPortDef.nBufferCountActual)
             {
-                Q_ADD(pPort->pQ, pBufHdr);
+                if (OMX_ErrorNone != OMX_OSAL_QueuePush(pPort->hQueue, pBufHdr))
+                {
+                    /* not counted as returned, so the test fails waiting for it */
+                    OMX_OSAL_Trace(OMX_OSAL_TRACE_ERROR, "Cannot queue returned buffer\n");
+                    return OMX_ErrorNone;
+                }
                 pPort->nBuffersOutstanding--;
                 pCtx->nBuffersProcessed++;
                 OMX_OSAL_EventSet(pCtx->hBufferCallbackEvent);
@@ -262,12 +226,12 @@ OMX_ERRORTYPE FlushTest_FillBufferDone(
         pCtx = pPort->pCtx;
 
         /* FillBufferDone can only be called from an output port */
-        if ((OMX_DirOutput == pPort->sPortDef.eDir) && (0x0 != pPort->pQ))
+        if ((OMX_DirOutput == pPort->sPortDef.eDir) && (0x0 != pPort->hQueue))
         {
             /* when the queue is full, don't add another buffer header
                as something is wrong with the component.  It is 
                incorrectly returning more buffers than sent in */
-            if (Q_INQUEUE(pPort->pQ) < pPort->sPortDef.nBufferCountActual)
+            if (OMX_OSAL_QueueCount(pPort->hQueue) < pPort->sPortDef.nBufferCountActual)
             {
                 /* write to file if enabled */
                 if (OMX_TRUE == pPort->bOpenFile)
@@ -276,7 +240,11 @@ OMX_ERRORTYPE FlushTest_FillBufferDone(
                                                pBufHdr->nFilledLen, pPort->sPortDef.nPortIndex);
                 }
 
-                Q_ADD(pPort->pQ, pBufHdr);
+                if (OMX_ErrorNone != OMX_OSAL_QueuePush(pPort->hQueue, pBufHdr))
+                {
+                    OMX_OSAL_Trace(OMX_OSAL_TRACE_ERROR, "Cannot queue returned buffer\n");
+                    return OMX_ErrorNone;
+                }
                 pPort->nBuffersOutstanding--;
                 pCtx->nBuffersProcessed++;
                 OMX_OSAL_EventSet(pCtx->hBufferCallbackEvent);
@@ -359,7 +327,7 @@ OMX_ERRORTYPE FlushTest_EventHandler(
                        received as part of the flush */
                     if (OMX_ErrorNone == FlushTest_FindPortFromIndex(pCtx, &pPort, nData2))
                     {
-                        if (Q_INQUEUE(pPort->pQ) == pPort->sPortDef.nBufferCountActual)
+                        if (OMX_OSAL_QueueCount(pPort->hQueue) == pPort->sPortDef.nBufferCountActual)
                         {
                             pCtx->nNumPortsFlushed++;
                             if (pCtx->nNumPortsFlushed == pCtx->nNumPorts)
@@ -380,7 +348,7 @@ OMX_ERRORTYPE FlushTest_EventHandler(
                 {
                     if (OMX_ErrorNone == FlushTest_FindPortFromIndex(pCtx, &pPort, nData2))
                     {
-                        if (Q_INQUEUE(pPort->pQ) == pPort->sPortDef.nBufferCountActual)
+                        if (OMX_OSAL_QueueCount(pPort->hQueue) == pPort->sPortDef.nBufferCountActual)
                         {
                             OMX_OSAL_EventSet(pCtx->hPortFlushEvent); 
 
@@ -514,25 +482,30 @@ OMX_CONF_TEST_BAIL:
 OMX_ERRORTYPE FlushTest_SaveBufferOrder( 
     TEST_PORTTYPE *pPort)
 {
+    OMX_ERRORTYPE eError = OMX_ErrorNone;
     OMX_BUFFERHEADERTYPE *pBufHdr = NULL;
     OMX_BUFFERHEADERTYPE **pBufOrder;
     OMX_U32 i;
 
     if ((0x0 != pPort) && (0x0 != pPort->aSaveBufferOrder))
     { 
-        pPort->nNumSaveBufferOrder = Q_INQUEUE(pPort->pQ);
+        pPort->nNumSaveBufferOrder = OMX_OSAL_QueueCount(pPort->hQueue);
         pBufOrder = (OMX_BUFFERHEADERTYPE**)pPort->aSaveBufferOrder;
         for (i = 0; i < pPort->nNumSaveBufferOrder; i++)
         {
-            Q_REMOVE(pPort->pQ, pBufHdr);
+            eError = OMX_OSAL_QueuePop(pPort->hQueue, 0, (OMX_PTR *)&pBufHdr);
+            OMX_CONF_BAIL_ON_QUEUE_ERROR(eError);
             *pBufOrder = pBufHdr;
             pBufOrder++;
-            Q_ADD(pPort->pQ, pBufHdr);
+            eError = OMX_OSAL_QueuePush(pPort->hQueue, pBufHdr);
+            OMX_CONF_BAIL_ON_QUEUE_ERROR(eError);
         }
 
     }
 
-    return(OMX_ErrorNone);    
+OMX_CONF_TEST_BAIL:
+
+    return(eError);    
 
 }
 
@@ -551,13 +524,15 @@ OMX_ERRORTYPE FlushTest_CheckBufferOrder(
         pBufOrder = (OMX_BUFFERHEADERTYPE**)pPort->aSaveBufferOrder;
         for (i = 0; i < pPort->nNumSaveBufferOrder; i++)
         {
-            Q_REMOVE(pPort->pQ, pBufHdr);
+            eError = OMX_OSAL_QueuePop(pPort->hQueue, 0, (OMX_PTR *)&pBufHdr);
+            OMX_CONF_BAIL_ON_QUEUE_ERROR(eError);
             if (*pBufOrder != pBufHdr)
             {
                 OMX_CONF_SET_ERROR_BAIL(eError, OMX_ErrorUndefined, "buffers returned out of order\n");
             }
             pBufOrder++;
-            Q_ADD(pPort->pQ, pBufHdr);
+            eError = OMX_OSAL_QueuePush(pPort->hQueue, pBufHdr);
+            OMX_CONF_BAIL_ON_QUEUE_ERROR(eError);
         }
 
     }
@@ -579,7 +554,7 @@ OMX_ERRORTYPE FlushTest_SendBogusBuffers(
 	OMX_U32 nPortIndex;
 
     /* construct bogus buffer header */
-    Q_PEEK(pPort->pQ, pBufHdr);
+    OMX_OSAL_QueuePeek(pPort->hQueue, (OMX_PTR *)&pBufHdr);
 
     if (!pBufHdr) 
         return OMX_ErrorUndefined;
@@ -625,7 +600,7 @@ OMX_ERRORTYPE FlushTest_SendNBuffers(
 
     if (OMX_DirInput == pPort->sPortDef.eDir)
     {
-        while ((0x0 != Q_INQUEUE(pPort->pQ)) && (0x0 != nNumBuffers))
+        while ((0x0 != OMX_OSAL_QueueCount(pPort->hQueue)) && (0x0 != nNumBuffers))
         {
             if (OMX_TRUE == pPort->bEOS)
             {
@@ -635,7 +610,8 @@ OMX_ERRORTYPE FlushTest_SendNBuffers(
 
             }
 
-            Q_REMOVE(pPort->pQ, pBufHdr);
+            eError = OMX_OSAL_QueuePop(pPort->hQueue, 0, (OMX_PTR *)&pBufHdr);
+            OMX_CONF_BAIL_ON_QUEUE_ERROR(eError);
             if (OMX_TRUE == bReadFromInputFile)
             {
                 pBufHdr->nOffset = 0;
@@ -661,9 +637,10 @@ OMX_ERRORTYPE FlushTest_SendNBuffers(
 
     } else
     {
-        while ((0x0 != Q_INQUEUE(pPort->pQ)) && (0x0 != nNumBuffers))
+        while ((0x0 != OMX_OSAL_QueueCount(pPort->hQueue)) && (0x0 != nNumBuffers))
         {
-            Q_REMOVE(pPort->pQ, pBufHdr);
+            eError = OMX_OSAL_QueuePop(pPort->hQueue, 0, (OMX_PTR *)&pBufHdr);
+            OMX_CONF_BAIL_ON_QUEUE_ERROR(eError);
 
             /* mark buffer header as empty on OMX_FillThisBuffer calls */
             pBufHdr->nFlags = 0x0; 
@@ -705,7 +682,7 @@ OMX_ERRORTYPE FlushTest_ProcessNBuffers(
         pPort = pCtx->aPorts; 
         for (i = 0; i < pCtx->nNumPorts; i++)
         {
-            nToSend = Q_INQUEUE(pPort->pQ);    
+            nToSend = OMX_OSAL_QueueCount(pPort->hQueue);    
             eError = FlushTest_SendNBuffers(pCtx, pPort, nToSend, OMX_TRUE);
             OMX_CONF_BAIL_ON_ERROR(eError);
             nSent += nToSend;
@@ -761,7 +738,8 @@ OMX_ERRORTYPE FlushTest_PortAllocateNumBuffers(
                                     pPort->sPortDef.nPortIndex, 
                                     pPort, pPort->sPortDef.nBufferSize);
         OMX_CONF_BAIL_ON_ERROR(eError);
-        Q_ADD(pPort->pQ, pBufHdr);
+        eError = OMX_OSAL_QueuePush(pPort->hQueue, pBufHdr);
+        OMX_CONF_BAIL_ON_QUEUE_ERROR(eError);
         if (pBufHdr->pAppPrivate != (OMX_PTR)pPort)
         {
             OMX_CONF_SET_ERROR_BAIL(eError, OMX_ErrorUndefined, 
@@ -799,9 +777,10 @@ OMX_ERRORTYPE FlushTest_PortFreeNumBuffers(
     OMX_ERRORTYPE eError = OMX_ErrorNone;
     OMX_BUFFERHEADERTYPE *pBufHdr = NULL;
 
-    while ((0x0 != Q_INQUEUE(pPort->pQ)) && (0x0 != nNumBuffers))
+    while ((0x0 != OMX_OSAL_QueueCount(pPort->hQueue)) && (0x0 != nNumBuffers))
     {
-        Q_REMOVE(pPort->pQ, pBufHdr);
+        eError = OMX_OSAL_QueuePop(pPort->hQueue, 0, (OMX_PTR *)&pBufHdr);
+        OMX_CONF_BAIL_ON_QUEUE_ERROR(eError);
         eError = OMX_FreeBuffer(pCtx->hWrappedComp, pPort->sPortDef.nPortIndex, pBufHdr);
         OMX_CONF_BAIL_ON_ERROR(eError);
         nNumBuffers--;
@@ -879,8 +858,7 @@ OMX_ERRORTYPE FlushTest_AllocatePortStructures(
             }
 
             /* allocate LIFO with that or the actual required buffers */
-            Q_ALLOC(pPort->pQ, (pPort->sPortDef.nBufferCountActual));
-            if (0x0 == pPort->pQ)
+            if (OMX_ErrorNone != OMX_OSAL_QueueCreate(pPort->sPortDef.nBufferCountActual, &pPort->hQueue))
             {
                 OMX_CONF_SET_ERROR_BAIL(eError, OMX_ErrorUndefined, 
                                         "memory allocation failure\n");
@@ -920,23 +898,23 @@ OMX_ERRORTYPE FlushTest_FreePortStructures(TEST_CTXTYPE *pCtx)
         for (i = 0; i < pCtx->nNumPorts; i++)
         {
             /* free all allocated buffers */
-            if (0x0 != pPort->pQ)
+            if (0x0 != pPort->hQueue)
             {
                 if (OMX_ErrorNone == eError)
                 {
                     /* record the return code, but don't exit on failure as the 
                        test has memory it must free */
-                    eError = FlushTest_PortFreeNumBuffers(pCtx, pPort, Q_INQUEUE(pPort->pQ));
+                    eError = FlushTest_PortFreeNumBuffers(pCtx, pPort, OMX_OSAL_QueueCount(pPort->hQueue));
   
                 } else
                 {
                     /* preserve the first failure from freeing buffers */
-                    FlushTest_PortFreeNumBuffers(pCtx, pPort, Q_INQUEUE(pPort->pQ));
+                    FlushTest_PortFreeNumBuffers(pCtx, pPort, OMX_OSAL_QueueCount(pPort->hQueue));
                 }    
        
                 /* free LIFO */
-                Q_FREE(pPort->pQ);
-                pPort->pQ = 0x0;
+                OMX_OSAL_QueueDestroy(pPort->hQueue);
+                pPort->hQueue = 0x0;
 
             }
 
@@ -987,7 +965,7 @@ OMX_ERRORTYPE FlushTest_AllocateAllBuffers(TEST_CTXTYPE *pCtx)
                        pPort->sPortDef.nBufferCountActual, pPort->sPortDef.nPortIndex);
         /* allocate all buffers on each port */
         nCount = pPort->sPortDef.nBufferCountActual;
-        nCount -= Q_INQUEUE(pPort->pQ);
+        nCount -= OMX_OSAL_QueueCount(pPort->hQueue);
         eError = FlushTest_PortAllocateNumBuffers(pCtx, pPort, nCount);
         OMX_CONF_BAIL_ON_ERROR(eError);
         pPort++;
@@ -1014,7 +992,7 @@ OMX_ERRORTYPE FlushTest_FreeAllBuffers(TEST_CTXTYPE *pCtx)
         OMX_OSAL_Trace(OMX_OSAL_TRACE_INFO, "Freeing all buffers on port %i\n",
                        pPort->sPortDef.nPortIndex);
         eError = FlushTest_PortFreeNumBuffers(pCtx, pPort, 
-                                              Q_INQUEUE(pPort->pQ));
+                                              OMX_OSAL_QueueCount(pPort->hQueue));
         OMX_CONF_BAIL_ON_ERROR(eError);
         pPort++;
     }
@@ -1162,7 +1140,7 @@ OMX_ERRORTYPE OMX_CONF_FlushTest(OMX_IN OMX_STRING cComponentName)
         nPortIndex = pPort->sPortDef.nPortIndex;
         /* feed in more buffers to fill the receive queues on each port of the 
            component */
-        eError = FlushTest_SendNBuffers(pCtx, pPort, Q_INQUEUE(pPort->pQ), OMX_TRUE);
+        eError = FlushTest_SendNBuffers(pCtx, pPort, OMX_OSAL_QueueCount(pPort->hQueue), OMX_TRUE);
         OMX_CONF_BAIL_ON_ERROR(eError);    
         pPort++;
     }
@@ -1197,7 +1175,7 @@ OMX_ERRORTYPE OMX_CONF_FlushTest(OMX_IN OMX_STRING cComponentName)
         OMX_CONF_BAIL_ON_ERROR(eError);    
 
         /* confirm none of the buffers were returned to the IL Client */
-        if (0x0 != Q_INQUEUE(pPort->pQ))
+        if (0x0 != OMX_OSAL_QueueCount(pPort->hQueue))
         {
             OMX_CONF_SET_ERROR_BAIL(eError, OMX_ErrorUndefined, "Port returned buffers unexpectedly\n");
         }
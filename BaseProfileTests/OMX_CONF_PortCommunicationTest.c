@@ -54,21 +54,6 @@ char szDesc[256];
     goto OMX_CONF_TEST_BAIL;			\
 }
 
-#define LIST_CLEAR_ENTRY(_pL, _pB)\
-    _pB = _pL->pBufHdr;		\
-    _pL->pBufHdr = NULL;	\
-    _pL = _pL->pNextBuf;
-
-#define LIST_SET_ENTRY(_pL, _pB)	\
-{				\
-    BufferList *_pT = _pL;	\
-    while(_pT && _pT->pBufHdr){	\
-        _pT = _pT->pNextBuf;	\
-    }				\
-    if(_pT)			\
-        _pT->pBufHdr = _pB;	\
-}
-
 #define OMX_CONF_EVENT_HANDLER_ERROR(_nX, _nY, _nZ, _desc)	\
 {								\
     _nX = _nY + 1;						\
@@ -83,7 +68,6 @@ char szDesc[256];
 typedef struct _BufferList BufferList;
 
 struct _BufferList{
-    OMX_BUFFERHEADERTYPE *pBufHdr;
     OMX_BUFFERHEADERTYPE *pOrigBufHdr;
     BufferList *pNextBuf;
     OMX_BOOL bBuffersContiguous;
@@ -102,6 +86,8 @@ typedef struct{
     OMX_HANDLETYPE hOutLock;
     BufferList *pInBufferList;
     BufferList *pOutBufferList;
+    OMX_HANDLETYPE hInQueue;    /* idle input buffers */
+    OMX_HANDLETYPE hOutQueue;   /* idle output buffers */
     OMX_U32 nBufDoneCalls;
     OMX_U32 nPorts;
     OMX_U32 nPortsStopped;
@@ -210,7 +196,7 @@ OMX_ERRORTYPE PortCommTest_EmptyBufferDone(OMX_IN OMX_HANDLETYPE hComponent,
     else if(pCtxt->nInBufBusy){
         pCtxt->nInBufBusy--;
 	pCtxt->nBufDoneCalls++;
-	LIST_SET_ENTRY(pCtxt->pInBufferList, pBuffer);
+	OMX_OSAL_QueuePush(pCtxt->hInQueue, pBuffer);
 	OMX_OSAL_EventSet(pCtxt->hEmptyBufDoneEvent);
 	OMX_OSAL_EventSet(pCtxt->hBufDoneEvent);
     }
@@ -244,7 +230,7 @@ OMX_ERRORTYPE PortCommTest_FillBufferDone(OMX_OUT OMX_HANDLETYPE hComponent,
     else if(pCtxt->nOutBufBusy){
         pCtxt->nOutBufBusy--;
 	pCtxt->nBufDoneCalls++;
-	LIST_SET_ENTRY(pCtxt->pOutBufferList, pBuffer);
+	OMX_OSAL_QueuePush(pCtxt->hOutQueue, pBuffer);
 	OMX_OSAL_EventSet(pCtxt->hBufDoneEvent);
     }
     else{
@@ -297,7 +283,6 @@ OMX_ERRORTYPE PortCommTest_AllocateBuffers(PortCommTestCtxt *pContext,
             }
 	}
 	pBufferList->pNextBuf = NULL;
-	pBufferList->pBufHdr = pBufferHdr;
 	pBufferList->pOrigBufHdr = pBufferHdr;
   pBufferList->bBuffersContiguous = pPortDef->bBuffersContiguous;
   pBufferList->nBufferAlignment = pPortDef->nBufferAlignment;
@@ -320,6 +305,8 @@ OMX_ERRORTYPE PortCommTest_AllocateBuffers(PortCommTestCtxt *pContext,
 		pTemp->pNextBuf = pBufferList;
 	    }
 	    pContext->nInBuf++;
+	    if(OMX_ErrorNone != OMX_OSAL_QueuePush(pContext->hInQueue, pBufferHdr))
+	        OMX_CONF_SET_ERROR_BAIL("Too many buffers to queue\n", OMX_ErrorInsufficientResources);
 	}
 	else{
 	    /* check if buffer header is as expected */ 
@@ -339,6 +326,8 @@ OMX_ERRORTYPE PortCommTest_AllocateBuffers(PortCommTestCtxt *pContext,
 		pTemp->pNextBuf = pBufferList;
 	    }
 	    pContext->nOutBuf++;
+	    if(OMX_ErrorNone != OMX_OSAL_QueuePush(pContext->hOutQueue, pBufferHdr))
+	        OMX_CONF_SET_ERROR_BAIL("Too many buffers to queue\n", OMX_ErrorInsufficientResources);
 	}
     }
 
@@ -349,6 +338,7 @@ OMX_CONF_TEST_BAIL:
 /*****************************************************************************/
 OMX_ERRORTYPE PortCommTest_DeInitBuffer(PortCommTestCtxt* pContext)
 {
+    OMX_BUFFERHEADERTYPE *pBufferHdr;
     OMX_U8 *pBuffer;
     BufferList *pBufferListObject;
     BufferList *pTemp;
@@ -373,6 +363,7 @@ OMX_ERRORTYPE PortCommTest_DeInitBuffer(PortCommTestCtxt* pContext)
 	pContext->nInBuf--;
     }
     pContext->pInBufferList = NULL;
+    while(OMX_ErrorNone == OMX_OSAL_QueuePop(pContext->hInQueue, 0, (OMX_PTR *)&pBufferHdr));
 
     pTemp = pContext->pOutBufferList;
     while(pTemp){
@@ -392,6 +383,7 @@ OMX_ERRORTYPE PortCommTest_DeInitBuffer(PortCommTestCtxt* pContext)
 	pContext->nOutBuf--;
     }
     pContext->pOutBufferList = NULL;
+    while(OMX_ErrorNone == OMX_OSAL_QueuePop(pContext->hOutQueue, 0, (OMX_PTR *)&pBufferHdr));
 OMX_CONF_TEST_BAIL:
     return eError;
 }
@@ -399,15 +391,15 @@ OMX_CONF_TEST_BAIL:
 /*****************************************************************************/
 OMX_ERRORTYPE PortCommTest_ReadOutBuffers(PortCommTestCtxt* pContext)
 {
-    BufferList * pList;
     OMX_BUFFERHEADERTYPE *pBufHeader;
     OMX_ERRORTYPE eError = OMX_ErrorNone;
+    OMX_U32 nIdle;
 
-    pList = pContext->pOutBufferList;
-    while(pList && pList->pBufHdr){
+    /* only the buffers idle on entry: one returned from within FillThisBuffer waits for the next pass */
+    nIdle = OMX_OSAL_QueueCount(pContext->hOutQueue);
+    while(nIdle-- && OMX_ErrorNone == OMX_OSAL_QueuePop(pContext->hOutQueue, 0, (OMX_PTR *)&pBufHeader)){
       OMX_OSAL_MutexLock(pContext->hOutLock);
         pContext->nOutBufBusy++;
-	LIST_CLEAR_ENTRY(pList, pBufHeader);
   OMX_OSAL_MutexUnlock(pContext->hOutLock);
 	OMX_CONF_BAIL_IF_ERROR(OMX_FillThisBuffer(pContext->hWComp, pBufHeader));
 	if (pBufHeader->nFlags == OMX_BUFFERFLAG_EOS)
@@ -420,15 +412,15 @@ OMX_CONF_TEST_BAIL:
 /*****************************************************************************/
 OMX_ERRORTYPE PortCommTest_WriteInBuffers(PortCommTestCtxt* pContext)
 {
-    BufferList * pList;
     OMX_BUFFERHEADERTYPE *pBufHeader;
     OMX_ERRORTYPE eError = OMX_ErrorNone;
+    OMX_U32 nIdle;
 
-    pList = pContext->pInBufferList;
-    while(pList && pList->pBufHdr){
+    /* only the buffers idle on entry: one returned from within EmptyThisBuffer waits for the next pass */
+    nIdle = OMX_OSAL_QueueCount(pContext->hInQueue);
+    while(nIdle-- && OMX_ErrorNone == OMX_OSAL_QueuePop(pContext->hInQueue, 0, (OMX_PTR *)&pBufHeader)){
       OMX_OSAL_MutexLock(pContext->hInLock);
 	pContext->nInBufBusy++;
-	LIST_CLEAR_ENTRY(pList, pBufHeader);
   OMX_OSAL_MutexUnlock(pContext->hInLock);
    pBufHeader->nOffset = 0;
 	pBufHeader->nFilledLen = OMX_OSAL_ReadFromInputFileWithSize(pBufHeader->pBuffer, pBufHeader->nAllocLen, 
@@ -756,6 +748,8 @@ OMX_ERRORTYPE OMX_CONF_PortCommunicationTest(OMX_IN OMX_STRING cComponentName)
     OMX_OSAL_EventReset(pCtxt->hEmptyBufDoneEvent);
     OMX_OSAL_MutexCreate(&pCtxt->hInLock);
     OMX_OSAL_MutexCreate(&pCtxt->hOutLock);
+    OMX_OSAL_QueueCreate(OMX_CONF_BUFFERQUEUE_ENTRIES, &pCtxt->hInQueue);
+    OMX_OSAL_QueueCreate(OMX_CONF_BUFFERQUEUE_ENTRIES, &pCtxt->hOutQueue);
     
     /* Initialize OpenMax */
     eError = OMX_Init(); 
@@ -873,6 +867,8 @@ OMX_CONF_TEST_BAIL:
     OMX_OSAL_EventDestroy(pCtxt->hEmptyBufDoneEvent);
     OMX_OSAL_MutexDestroy(pCtxt->hInLock);
     OMX_OSAL_MutexDestroy(pCtxt->hOutLock);
+    OMX_OSAL_QueueDestroy(pCtxt->hInQueue);
+    OMX_OSAL_QueueDestroy(pCtxt->hOutQueue);
     
     return eError;
 }
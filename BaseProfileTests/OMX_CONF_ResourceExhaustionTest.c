@@ -236,9 +236,7 @@ OMX_ERRORTYPE ResourceExhaustionTest_AllocateAllBuffers(ResourceExhaustionTestCo
 	    
 	    OMX_CONF_INIT_STRUCT(sPortDef, OMX_PARAM_PORTDEFINITIONTYPE);
 	    sPortDef.nPortIndex = i;
-	    OMX_CONF_BAIL_IF_ERROR(OMX_GetParameter(pCtxt->hWComp[pCtxt->nInst], 
-						    OMX_IndexParamPortDefinition, 
-						    (OMX_PTR)&sPortDef));
+	    OMX_CONF_BAIL_IF_ERROR(OMX_CONF_TopologyGetPort(pCtxt->hWComp[pCtxt->nInst], &sPortDef));
 	    if(sPortDef.nBufferCountActual == 0x0 || 
 	       sPortDef.nBufferCountActual < sPortDef.nBufferCountMin)
 	        OMX_CONF_SET_ERROR_BAIL("Incorrect nBufferCountActual\n", OMX_ErrorUndefined);
@@ -365,8 +363,8 @@ OMX_ERRORTYPE OMX_CONF_ResourceExhaustionTest(OMX_IN OMX_STRING cComponentName)
 
     /* detect all audio ports on the component */
     OMX_CONF_INIT_STRUCT(pCtxt->sPortParam[0], OMX_PORT_PARAM_TYPE);
-    eError = OMX_GetParameter(pCtxt->hWComp[pCtxt->nInst], OMX_IndexParamAudioInit, 
-			      (OMX_PTR)&pCtxt->sPortParam[0]);
+    eError = OMX_CONF_TopologyGetDomain(pCtxt->hWComp[pCtxt->nInst], OMX_IndexParamAudioInit, 
+			      &pCtxt->sPortParam[0]);
     if(OMX_ErrorUnsupportedIndex == eError)
         eError = OMX_ErrorNone;
     OMX_CONF_BAIL_IF_ERROR(eError);
@@ -375,8 +373,8 @@ OMX_ERRORTYPE OMX_CONF_ResourceExhaustionTest(OMX_IN OMX_STRING cComponentName)
 
     /* detect all video ports on the component */
     OMX_CONF_INIT_STRUCT(pCtxt->sPortParam[1], OMX_PORT_PARAM_TYPE);
-    eError = OMX_GetParameter(pCtxt->hWComp[pCtxt->nInst], OMX_IndexParamVideoInit, 
-			      (OMX_PTR)&pCtxt->sPortParam[1]);
+    eError = OMX_CONF_TopologyGetDomain(pCtxt->hWComp[pCtxt->nInst], OMX_IndexParamVideoInit, 
+			      &pCtxt->sPortParam[1]);
     if(OMX_ErrorUnsupportedIndex == eError)
         eError = OMX_ErrorNone;
     OMX_CONF_BAIL_IF_ERROR(eError);
@@ -385,8 +383,8 @@ OMX_ERRORTYPE OMX_CONF_ResourceExhaustionTest(OMX_IN OMX_STRING cComponentName)
     
     /* detect all image ports on the component */
     OMX_CONF_INIT_STRUCT(pCtxt->sPortParam[2], OMX_PORT_PARAM_TYPE);
-    eError = OMX_GetParameter(pCtxt->hWComp[pCtxt->nInst], OMX_IndexParamImageInit, 
-			      (OMX_PTR)&pCtxt->sPortParam[2]);
+    eError = OMX_CONF_TopologyGetDomain(pCtxt->hWComp[pCtxt->nInst], OMX_IndexParamImageInit, 
+			      &pCtxt->sPortParam[2]);
     if(OMX_ErrorUnsupportedIndex == eError)
         eError = OMX_ErrorNone;
     OMX_CONF_BAIL_IF_ERROR(eError);
@@ -395,8 +393,8 @@ OMX_ERRORTYPE OMX_CONF_ResourceExhaustionTest(OMX_IN OMX_STRING cComponentName)
     
     /* detect all other ports on the component */
     OMX_CONF_INIT_STRUCT(pCtxt->sPortParam[3], OMX_PORT_PARAM_TYPE);
-    eError = OMX_GetParameter(pCtxt->hWComp[pCtxt->nInst], OMX_IndexParamOtherInit, 
-			      (OMX_PTR)&pCtxt->sPortParam[3]);
+    eError = OMX_CONF_TopologyGetDomain(pCtxt->hWComp[pCtxt->nInst], OMX_IndexParamOtherInit, 
+			      &pCtxt->sPortParam[3]);
     if(OMX_ErrorUnsupportedIndex == eError)
         eError = OMX_ErrorNone;
     OMX_CONF_BAIL_IF_ERROR(eError);
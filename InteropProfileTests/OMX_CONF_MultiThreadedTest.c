@@ -152,8 +152,8 @@ OMX_ERRORTYPE OMX_CONF_MultiThreadedTest(OMX_IN OMX_STRING cComponentName)
     g_cComponentName = cComponentName;
     g_pWrappedCallbacks = g_pWrappedCallbacks;
     g_pWrappedAppData = g_pWrappedAppData;
-    OMX_OSAL_ThreadCreate( CreateCUT, 0, 0, &hCUTThread);
-    OMX_OSAL_ThreadCreate( CreateTTC, 0, 0, &hTTCThread);
+    OMX_OSAL_ThreadPoolSubmit( CreateCUT, 0, 0, 0, &hCUTThread);
+    OMX_OSAL_ThreadPoolSubmit( CreateTTC, 0, 0, 0, &hTTCThread);
 
     OMX_OSAL_Trace(OMX_OSAL_TRACE_INFO, "Waiting for threads to instantiate components.\n");
     bTimedOut = OMX_FALSE;
@@ -171,8 +171,8 @@ OMX_ERRORTYPE OMX_CONF_MultiThreadedTest(OMX_IN OMX_STRING cComponentName)
     }
     oAppData.hCUT = g_hComp;
 
-    OMX_OSAL_ThreadDestroy( hCUTThread);
-    OMX_OSAL_ThreadDestroy( hTTCThread);
+    OMX_OSAL_ThreadPoolWait( hCUTThread, NULL);
+    OMX_OSAL_ThreadPoolWait( hTTCThread, NULL);
 
     OMX_CONF_FAIL_IF_ERROR(g_eCUTError);
     OMX_CONF_FAIL_IF_ERROR(g_eTTCError);
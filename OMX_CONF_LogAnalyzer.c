@@ -0,0 +1,1102 @@
+/*
+ * Copyright (c) 2019 The Khronos Group Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/** OMX_CONF_LogAnalyzer.c
+ *  Standalone analyzer of harness logs. Reads a text log written with the ol
+ *  command or a binary event log written with oe or or, and reports per test
+ *  and component the call counts, latency distributions, state transition
+ *  durations, buffer throughput and the slowest calls. The summary goes to
+ *  stdout, the same report as JSON to the file given with -j.
+ *
+ *  The analyzer is its own executable and needs nothing else from the tree:
+ *      cc -I<OpenMAX IL headers> -I. OMX_CONF_LogAnalyzer.c -o OMX_CONF_LogAnalyzer
+ *      OMX_CONF_LogAnalyzer [-j report.json] [-n slowest] logfile
+ *
+ *  Text logs carry call durations but no timestamps, so state transitions are
+ *  timed by their SendCommand only and buffer rates are not known. Event logs
+ *  time transitions up to the completing EventHandler when they were recorded
+ *  with call arguments (or command); tests are found from the test spans the
+ *  harness logs.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+#include <OMX_Types.h>
+#include <OMX_Component.h>
+#include <OMX_Core.h>
+
+#include "OMX_OSAL_Interfaces.h"
+#include "OMX_CONF_TestHarness.h"
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+/**********************************************************************
+ * ANALYZER STATE
+ **********************************************************************/
+
+#define OMX_CONF_ANALYZER_NAMESIZE     128
+#define OMX_CONF_ANALYZER_CONTEXTSIZE  160
+#define OMX_CONF_ANALYZER_MAXNAMES     65536
+#define OMX_CONF_ANALYZER_SLOWEST      20     /* slowest calls reported by default */
+
+typedef enum OMX_CONF_ANALYZERBUFFERTYPE {
+    OMX_CONF_AnalyzerEmptyThisBuffer,
+    OMX_CONF_AnalyzerFillThisBuffer,
+    OMX_CONF_AnalyzerEmptyBufferDone,
+    OMX_CONF_AnalyzerFillBufferDone,
+    OMX_CONF_AnalyzerBufferMax
+} OMX_CONF_ANALYZERBUFFERTYPE;
+
+static OMX_STRING g_OMX_CONF_sAnalyzerBufferApis[OMX_CONF_AnalyzerBufferMax] = {
+    "EmptyThisBuffer", "FillThisBuffer", "EmptyBufferDone", "FillBufferDone"
+};
+
+typedef struct OMX_CONF_ANALYZERSAMPLESTYPE {
+    OMX_U64 *pNs;
+    OMX_U32 nCount;
+    OMX_U32 nAlloc;
+    OMX_U64 nTotalNs;
+} OMX_CONF_ANALYZERSAMPLESTYPE;
+
+typedef struct OMX_CONF_ANALYZERTESTTYPE {
+    char sName[OMX_CONF_ANALYZER_NAMESIZE];
+    char sComponent[OMX_CONF_ANALYZER_NAMESIZE];
+    char sResult[OMX_CONF_ANALYZER_NAMESIZE];   /* empty if the log has no result */
+    OMX_BOOL bTimed;                            /* nBeginNs and nEndNs are known */
+    OMX_U64 nBeginNs;
+    OMX_U64 nEndNs;
+} OMX_CONF_ANALYZERTESTTYPE;
+
+typedef struct OMX_CONF_ANALYZERAPITYPE {
+    OMX_U32 nTest;
+    char sComponent[OMX_CONF_ANALYZER_NAMESIZE];
+    char sApi[OMX_CONF_ANALYZER_NAMESIZE];
+    OMX_U32 nErrors;
+    OMX_CONF_ANALYZERSAMPLESTYPE oCalls;
+} OMX_CONF_ANALYZERAPITYPE;
+
+typedef struct OMX_CONF_ANALYZERTRANSITIONTYPE {
+    OMX_U32 nTest;
+    char sComponent[OMX_CONF_ANALYZER_NAMESIZE];
+    char sTransition[OMX_CONF_ANALYZER_NAMESIZE];
+    OMX_CONF_ANALYZERSAMPLESTYPE oCommand;      /* SendCommand call */
+    OMX_CONF_ANALYZERSAMPLESTYPE oComplete;     /* SendCommand to the completing EventHandler */
+} OMX_CONF_ANALYZERTRANSITIONTYPE;
+
+typedef struct OMX_CONF_ANALYZERTRAFFICTYPE {
+    OMX_U32 nTest;
+    char sComponent[OMX_CONF_ANALYZER_NAMESIZE];
+    OMX_U64 nBuffers[OMX_CONF_AnalyzerBufferMax];
+    OMX_U64 nFilledBytes;                       /* nFilledLen of FillBufferDone */
+    OMX_BOOL bTimed;
+    OMX_U64 nFirstNs;
+    OMX_U64 nLastNs;
+} OMX_CONF_ANALYZERTRAFFICTYPE;
+
+/* State of a component, and the transition it was last commanded to */
+typedef struct OMX_CONF_ANALYZERSTATETYPE {
+    char sComponent[OMX_CONF_ANALYZER_NAMESIZE];
+    char sState[OMX_CONF_ANALYZER_NAMESIZE];    /* empty until a transition completed */
+    char sTarget[OMX_CONF_ANALYZER_NAMESIZE];   /* empty if no transition is pending */
+    char sTransition[OMX_CONF_ANALYZER_NAMESIZE];
+    OMX_U32 nTest;
+    OMX_U64 nCommandNs;
+} OMX_CONF_ANALYZERSTATETYPE;
+
+typedef struct OMX_CONF_ANALYZERSLOWTYPE {
+    OMX_U64 nNs;
+    OMX_U32 nTest;
+    char sComponent[OMX_CONF_ANALYZER_NAMESIZE];
+    char sApi[OMX_CONF_ANALYZER_NAMESIZE];
+    char sContext[OMX_CONF_ANALYZER_CONTEXTSIZE];
+} OMX_CONF_ANALYZERSLOWTYPE;
+
+typedef struct OMX_CONF_ANALYZERTYPE {
+    OMX_BOOL bEventLog;
+    OMX_BOOL bArguments;                        /* event log has call arguments */
+    OMX_U64 nCalls;
+    OMX_CONF_ANALYZERTESTTYPE *pTests;
+    OMX_U32 nTests, nTestsAlloc;
+    OMX_CONF_ANALYZERAPITYPE *pApis;
+    OMX_U32 nApis, nApisAlloc;
+    OMX_CONF_ANALYZERTRANSITIONTYPE *pTransitions;
+    OMX_U32 nTransitions, nTransitionsAlloc;
+    OMX_CONF_ANALYZERTRAFFICTYPE *pTraffic;
+    OMX_U32 nTraffic, nTrafficAlloc;
+    OMX_CONF_ANALYZERSTATETYPE *pStates;
+    OMX_U32 nStates, nStatesAlloc;
+    OMX_CONF_ANALYZERSLOWTYPE *pSlowest;        /* slowest first */
+    OMX_U32 nSlowest, nMaxSlowest;
+} OMX_CONF_ANALYZERTYPE;
+
+/* Make room for one more element of nSize bytes in *ppArray. */
+static void OMX_CONF_AnalyzerGrow(void **ppArray, OMX_U32 nCount, OMX_U32 *pnAlloc, size_t nSize)
+{
+    void *pArray;
+
+    if (nCount < *pnAlloc)
+        return;
+    *pnAlloc = *pnAlloc ? *pnAlloc * 2 : 16;
+    pArray = realloc(*ppArray, *pnAlloc * nSize);
+    if (!pArray) {
+        fprintf(stderr, "Out of memory\n");
+        exit(1);
+    }
+    *ppArray = pArray;
+}
+
+static void OMX_CONF_AnalyzerCopy(OMX_STRING sTo, const char *sFrom)
+{
+    size_t nLength = strnlen(sFrom, OMX_CONF_ANALYZER_NAMESIZE - 1);
+
+    memcpy(sTo, sFrom, nLength);
+    sTo[nLength] = '\0';
+}
+
+static void OMX_CONF_AnalyzerSample(OMX_CONF_ANALYZERSAMPLESTYPE *pSamples, OMX_U64 nNs)
+{
+    OMX_CONF_AnalyzerGrow((void **)&pSamples->pNs, pSamples->nCount, &pSamples->nAlloc, sizeof(OMX_U64));
+    pSamples->pNs[pSamples->nCount++] = nNs;
+    pSamples->nTotalNs += nNs;
+}
+
+static int OMX_CONF_AnalyzerCompareNs(const void *pA, const void *pB)
+{
+    OMX_U64 nA = *(const OMX_U64 *)pA, nB = *(const OMX_U64 *)pB;
+    return nA < nB ? -1 : nA > nB;
+}
+
+/* Samples must have been sorted. */
+static OMX_U64 OMX_CONF_AnalyzerPercentile(OMX_CONF_ANALYZERSAMPLESTYPE *pSamples, OMX_U32 nPerMille)
+{
+    if (!pSamples->nCount)
+        return 0;
+    return pSamples->pNs[(OMX_U64)(pSamples->nCount - 1) * nPerMille / 1000];
+}
+
+static OMX_U32 OMX_CONF_AnalyzerTest(OMX_CONF_ANALYZERTYPE *pA, const char *sName, const char *sComponent)
+{
+    OMX_CONF_ANALYZERTESTTYPE *pTest;
+
+    OMX_CONF_AnalyzerGrow((void **)&pA->pTests, pA->nTests, &pA->nTestsAlloc, sizeof(OMX_CONF_ANALYZERTESTTYPE));
+    pTest = &pA->pTests[pA->nTests];
+    memset(pTest, 0, sizeof(*pTest));
+    OMX_CONF_AnalyzerCopy(pTest->sName, sName);
+    OMX_CONF_AnalyzerCopy(pTest->sComponent, sComponent);
+    return pA->nTests++;
+}
+
+static OMX_CONF_ANALYZERAPITYPE *OMX_CONF_AnalyzerApi(OMX_CONF_ANALYZERTYPE *pA, OMX_U32 nTest,
+                                                      const char *sComponent, const char *sApi)
+{
+    OMX_CONF_ANALYZERAPITYPE *pApi;
+    OMX_U32 i;
+
+    /* calls of one test come together, so search from the end */
+    for (i = pA->nApis; i-- > 0 && pA->pApis[i].nTest == nTest; ) {
+        pApi = &pA->pApis[i];
+        if (!strcmp(pApi->sComponent, sComponent) && !strcmp(pApi->sApi, sApi))
+            return pApi;
+    }
+    for (i = 0; i < pA->nApis; i++) {
+        pApi = &pA->pApis[i];
+        if (pApi->nTest == nTest && !strcmp(pApi->sComponent, sComponent) && !strcmp(pApi->sApi, sApi))
+            return pApi;
+    }
+    OMX_CONF_AnalyzerGrow((void **)&pA->pApis, pA->nApis, &pA->nApisAlloc, sizeof(OMX_CONF_ANALYZERAPITYPE));
+    pApi = &pA->pApis[pA->nApis++];
+    memset(pApi, 0, sizeof(*pApi));
+    pApi->nTest = nTest;
+    OMX_CONF_AnalyzerCopy(pApi->sComponent, sComponent);
+    OMX_CONF_AnalyzerCopy(pApi->sApi, sApi);
+    return pApi;
+}
+
+static OMX_CONF_ANALYZERTRANSITIONTYPE *OMX_CONF_AnalyzerTransition(OMX_CONF_ANALYZERTYPE *pA, OMX_U32 nTest,
+                                                                    const char *sComponent, const char *sTransition)
+{
+    OMX_CONF_ANALYZERTRANSITIONTYPE *pTransition;
+    OMX_U32 i;
+
+    for (i = 0; i < pA->nTransitions; i++) {
+        pTransition = &pA->pTransitions[i];
+        if (pTransition->nTest == nTest && !strcmp(pTransition->sComponent, sComponent) &&
+            !strcmp(pTransition->sTransition, sTransition))
+            return pTransition;
+    }
+    OMX_CONF_AnalyzerGrow((void **)&pA->pTransitions, pA->nTransitions, &pA->nTransitionsAlloc, sizeof(OMX_CONF_ANALYZERTRANSITIONTYPE));
+    pTransition = &pA->pTransitions[pA->nTransitions++];
+    memset(pTransition, 0, sizeof(*pTransition));
+    pTransition->nTest = nTest;
+    OMX_CONF_AnalyzerCopy(pTransition->sComponent, sComponent);
+    OMX_CONF_AnalyzerCopy(pTransition->sTransition, sTransition);
+    return pTransition;
+}
+
+static OMX_CONF_ANALYZERTRAFFICTYPE *OMX_CONF_AnalyzerTraffic(OMX_CONF_ANALYZERTYPE *pA, OMX_U32 nTest, const char *sComponent)
+{
+    OMX_CONF_ANALYZERTRAFFICTYPE *pTraffic;
+    OMX_U32 i;
+
+    for (i = pA->nTraffic; i-- > 0 && pA->pTraffic[i].nTest == nTest; ) {
+        if (!strcmp(pA->pTraffic[i].sComponent, sComponent))
+            return &pA->pTraffic[i];
+    }
+    OMX_CONF_AnalyzerGrow((void **)&pA->pTraffic, pA->nTraffic, &pA->nTrafficAlloc, sizeof(OMX_CONF_ANALYZERTRAFFICTYPE));
+    pTraffic = &pA->pTraffic[pA->nTraffic++];
+    memset(pTraffic, 0, sizeof(*pTraffic));
+    pTraffic->nTest = nTest;
+    OMX_CONF_AnalyzerCopy(pTraffic->sComponent, sComponent);
+    return pTraffic;
+}
+
+static OMX_CONF_ANALYZERSTATETYPE *OMX_CONF_AnalyzerState(OMX_CONF_ANALYZERTYPE *pA, const char *sComponent)
+{
+    OMX_CONF_ANALYZERSTATETYPE *pState;
+    OMX_U32 i;
+
+    for (i = 0; i < pA->nStates; i++) {
+        if (!strcmp(pA->pStates[i].sComponent, sComponent))
+            return &pA->pStates[i];
+    }
+    OMX_CONF_AnalyzerGrow((void **)&pA->pStates, pA->nStates, &pA->nStatesAlloc, sizeof(OMX_CONF_ANALYZERSTATETYPE));
+    pState = &pA->pStates[pA->nStates++];
+    memset(pState, 0, sizeof(*pState));
+    OMX_CONF_AnalyzerCopy(pState->sComponent, sComponent);
+    return pState;
+}
+
+/**********************************************************************
+ * CALL ACCOUNTING
+ **********************************************************************/
+
+static void OMX_CONF_AnalyzerCall(OMX_CONF_ANALYZERTYPE *pA, OMX_U32 nTest, const char *sComponent, const char *sApi,
+                                  OMX_U64 nNs, OMX_BOOL bError, const char *sContext)
+{
+    OMX_CONF_ANALYZERAPITYPE *pApi;
+    OMX_CONF_ANALYZERSLOWTYPE *pSlow;
+    OMX_U32 i;
+
+    pA->nCalls++;
+    pApi = OMX_CONF_AnalyzerApi(pA, nTest, sComponent, sApi);
+    OMX_CONF_AnalyzerSample(&pApi->oCalls, nNs);
+    if (bError)
+        pApi->nErrors++;
+
+    if (!pA->nMaxSlowest || (pA->nSlowest == pA->nMaxSlowest && nNs <= pA->pSlowest[pA->nSlowest - 1].nNs))
+        return;
+    if (pA->nSlowest < pA->nMaxSlowest)
+        pA->nSlowest++;
+    for (i = pA->nSlowest - 1; i > 0 && pA->pSlowest[i - 1].nNs < nNs; i--)
+        pA->pSlowest[i] = pA->pSlowest[i - 1];
+    pSlow = &pA->pSlowest[i];
+    pSlow->nNs = nNs;
+    pSlow->nTest = nTest;
+    OMX_CONF_AnalyzerCopy(pSlow->sComponent, sComponent);
+    OMX_CONF_AnalyzerCopy(pSlow->sApi, sApi);
+    strncpy(pSlow->sContext, sContext, OMX_CONF_ANALYZER_CONTEXTSIZE - 1);
+    pSlow->sContext[OMX_CONF_ANALYZER_CONTEXTSIZE - 1] = '\0';
+}
+
+/* SendCommand(OMX_CommandStateSet) of sComponent to sTarget was called at nBeginNs */
+static void OMX_CONF_AnalyzerCommand(OMX_CONF_ANALYZERTYPE *pA, OMX_U32 nTest, const char *sComponent,
+                                     const char *sTarget, OMX_U64 nBeginNs)
+{
+    OMX_CONF_ANALYZERSTATETYPE *pState = OMX_CONF_AnalyzerState(pA, sComponent);
+
+    sprintf(pState->sTransition, "%.60s->%.60s", pState->sState[0] ? pState->sState : "?", sTarget);
+    OMX_CONF_AnalyzerCopy(pState->sTarget, sTarget);
+    pState->nTest = nTest;
+    pState->nCommandNs = nBeginNs;
+}
+
+/* and returned after nNs; the transition may have completed meanwhile */
+static void OMX_CONF_AnalyzerCommandReturned(OMX_CONF_ANALYZERTYPE *pA, const char *sComponent, OMX_U64 nNs)
+{
+    OMX_CONF_ANALYZERSTATETYPE *pState = OMX_CONF_AnalyzerState(pA, sComponent);
+
+    if (pState->sTransition[0])
+        OMX_CONF_AnalyzerSample(&OMX_CONF_AnalyzerTransition(pA, pState->nTest, sComponent, pState->sTransition)->oCommand, nNs);
+}
+
+/* EventHandler reported that sComponent reached sState at nNs, 0 if not known */
+static void OMX_CONF_AnalyzerComplete(OMX_CONF_ANALYZERTYPE *pA, const char *sComponent, const char *sState, OMX_U64 nNs)
+{
+    OMX_CONF_ANALYZERSTATETYPE *pState = OMX_CONF_AnalyzerState(pA, sComponent);
+
+    if (pState->sTarget[0] && !strcmp(pState->sTarget, sState) && nNs >= pState->nCommandNs && nNs) {
+        OMX_CONF_AnalyzerSample(&OMX_CONF_AnalyzerTransition(pA, pState->nTest, sComponent, pState->sTransition)->oComplete,
+            nNs - pState->nCommandNs);
+    }
+    pState->sTarget[0] = '\0';
+    OMX_CONF_AnalyzerCopy(pState->sState, sState);
+}
+
+static void OMX_CONF_AnalyzerBuffer(OMX_CONF_ANALYZERTYPE *pA, OMX_U32 nTest, const char *sComponent, const char *sApi,
+                                    OMX_BOOL bTimed, OMX_U64 nNs, OMX_U32 nFilledLen)
+{
+    OMX_CONF_ANALYZERTRAFFICTYPE *pTraffic;
+    OMX_U32 i;
+
+    for (i = 0; i < OMX_CONF_AnalyzerBufferMax && strcmp(sApi, g_OMX_CONF_sAnalyzerBufferApis[i]); i++)
+        ;
+    if (i == OMX_CONF_AnalyzerBufferMax)
+        return;
+    pTraffic = OMX_CONF_AnalyzerTraffic(pA, nTest, sComponent);
+    pTraffic->nBuffers[i]++;
+    if (i == OMX_CONF_AnalyzerFillBufferDone)
+        pTraffic->nFilledBytes += nFilledLen;
+    if (bTimed) {
+        if (!pTraffic->bTimed || nNs < pTraffic->nFirstNs)
+            pTraffic->nFirstNs = nNs;
+        if (!pTraffic->bTimed || nNs > pTraffic->nLastNs)
+            pTraffic->nLastNs = nNs;
+        pTraffic->bTimed = OMX_TRUE;
+    }
+}
+
+/* "OMX_StateIdle" -> "Idle" */
+static const char *OMX_CONF_AnalyzerStateName(const char *sState)
+{
+    return strncmp(sState, "OMX_State", 9) ? sState : sState + 9;
+}
+
+/**********************************************************************
+ * TEXT LOGS
+ *
+ * Calls appear as "<component><- <function>(" (or "-> " for callbacks),
+ * followed by parameter lines starting with a tab and closed by
+ * ") returned <result>, took <ms> ms". Callbacks made during a call are
+ * traced inside it, starting right where the output of the call stopped.
+ * Tests start with a "## <test>" header and end with a PASSED or FAILED
+ * line.
+ **********************************************************************/
+
+#define OMX_CONF_ANALYZER_MAXNESTING 8
+
+typedef struct OMX_CONF_ANALYZERTEXTCALLTYPE {
+    char sComponent[OMX_CONF_ANALYZER_NAMESIZE];
+    char sApi[OMX_CONF_ANALYZER_NAMESIZE];
+    char sCmd[OMX_CONF_ANALYZER_NAMESIZE];
+    char sState[OMX_CONF_ANALYZER_NAMESIZE];
+    char sEvent[OMX_CONF_ANALYZER_NAMESIZE];
+    OMX_U32 nFilledLen;
+    OMX_U32 nLine;
+    OMX_BOOL bOpen;                 /* announcement still has parameters to come */
+    OMX_BOOL bCommanded;            /* the state transition was passed to OMX_CONF_AnalyzerCommand */
+} OMX_CONF_ANALYZERTEXTCALLTYPE;
+
+/* Parse "<key> = <value>" into pCall and return where the value ends. */
+static char *OMX_CONF_AnalyzerTextParameter(OMX_CONF_ANALYZERTYPE *pA, OMX_CONF_ANALYZERTEXTCALLTYPE *pCall, char *sLine)
+{
+    char sKey[OMX_CONF_ANALYZER_NAMESIZE];
+    char sValue[OMX_CONF_ANALYZER_NAMESIZE];
+    char *pValue, *pEnd, *pFound;
+    size_t nLength;
+    OMX_U32 i;
+
+    while (*sLine == '\t')
+        sLine++;
+    pValue = strstr(sLine, " = ");
+    if (!pValue)
+        return sLine + strlen(sLine);
+    nLength = pValue - sLine < OMX_CONF_ANALYZER_NAMESIZE ? pValue - sLine : OMX_CONF_ANALYZER_NAMESIZE - 1;
+    memcpy(sKey, sLine, nLength);
+    sKey[nLength] = '\0';
+    pValue += 3;
+
+    /* the value ends where the result or a callback made meanwhile follows */
+    if (pValue[0] == '0' && pValue[1] == 'x' && strspn(pValue + 2, "0123456789abcdefABCDEF") >= 8) {
+        pEnd = pValue + 10;
+    } else {
+        pEnd = strstr(pValue, ") returned ");
+        if (!pEnd)
+            pEnd = pValue + strlen(pValue);
+        for (i = 0; i < pA->nApis; i++) {
+            nLength = strlen(pA->pApis[i].sComponent);
+            pFound = strstr(pValue, pA->pApis[i].sComponent);
+            if (pFound && pFound < pEnd && (!strncmp(pFound + nLength, "-> ", 3) || !strncmp(pFound + nLength, "<- ", 3)))
+                pEnd = pFound;
+        }
+    }
+    if (!pCall)
+        return pEnd;
+    nLength = pEnd - pValue < OMX_CONF_ANALYZER_NAMESIZE ? pEnd - pValue : OMX_CONF_ANALYZER_NAMESIZE - 1;
+    memcpy(sValue, pValue, nLength);
+    sValue[nLength] = '\0';
+
+    if (!strcmp(sKey, "Cmd") || !strcmp(sKey, "Command(nData1)"))
+        strcpy(pCall->sCmd, sValue);
+    else if (!strcmp(sKey, "state(nParam1)") || !strcmp(sKey, "state(nData2)"))
+        strcpy(pCall->sState, sValue);
+    else if (!strcmp(sKey, "eEvent"))
+        strcpy(pCall->sEvent, sValue);
+    else if (!strcmp(sKey, "nFilledLen"))
+        pCall->nFilledLen = (OMX_U32)strtoul(sValue, NULL, 0);
+    return pEnd;
+}
+
+static void OMX_CONF_AnalyzerTextCall(OMX_CONF_ANALYZERTYPE *pA, OMX_U32 nTest, OMX_CONF_ANALYZERTEXTCALLTYPE *pCall,
+                                      OMX_CONF_ANALYZERTEXTCALLTYPE *pAnnounced, char *sReturned)
+{
+    char sResult[OMX_CONF_ANALYZER_NAMESIZE];
+    char sContext[OMX_CONF_ANALYZER_CONTEXTSIZE];
+    unsigned int nMsec = 0, nUsec = 0, nDigits;
+    int nParsed = 0;
+    char *pC;
+    OMX_U64 nNs;
+
+    /* the fraction is only printed since calls are timed in ns, older logs have whole ms */
+    if (sscanf(sReturned, ") returned %127[^,], took %u%n", sResult, &nMsec, &nParsed) != 2)
+        return;
+    pC = sReturned + nParsed;
+    if (*pC == '.') {
+        /* the first three decimals, in us */
+        for (pC++, nDigits = 0; nDigits < 3; nDigits++)
+            nUsec = nUsec * 10 + ((*pC >= '0' && *pC <= '9') ? (unsigned int)(*pC++ - '0') : 0);
+    }
+    nNs = (OMX_U64)nMsec * 1000000 + (OMX_U64)nUsec * 1000;
+
+    /* SendCommand announces its arguments before the call, without parameter 
+       tracing they are only found there */
+    if (!strcmp(pCall->sApi, "SendCommand") && pAnnounced->sApi[0] && !strcmp(pAnnounced->sComponent, pCall->sComponent)) {
+        if (!pCall->sCmd[0]) {
+            strcpy(pCall->sCmd, pAnnounced->sCmd);
+            strcpy(pCall->sState, pAnnounced->sState);
+        }
+        pCall->bCommanded = pAnnounced->bCommanded;
+        memset(pAnnounced, 0, sizeof(*pAnnounced));
+    }
+
+    sprintf(sContext, "line %u", pCall->nLine);
+    if (pCall->sEvent[0])
+        sprintf(sContext + strlen(sContext), ", %.40s", pCall->sEvent);
+    if (pCall->sCmd[0])
+        sprintf(sContext + strlen(sContext), ", %.40s", pCall->sCmd);
+    if (pCall->sState[0])
+        sprintf(sContext + strlen(sContext), ", %.40s", pCall->sState);
+    OMX_CONF_AnalyzerCall(pA, nTest, pCall->sComponent, pCall->sApi, nNs, strcmp(sResult, "OMX_ErrorNone") ? OMX_TRUE : OMX_FALSE, sContext);
+    OMX_CONF_AnalyzerBuffer(pA, nTest, pCall->sComponent, pCall->sApi, OMX_FALSE, 0, pCall->nFilledLen);
+
+    if (!strcmp(pCall->sCmd, "OMX_CommandStateSet") && pCall->sState[0]) {
+        if (!strcmp(pCall->sApi, "SendCommand")) {
+            if (!pCall->bCommanded)
+                OMX_CONF_AnalyzerCommand(pA, nTest, pCall->sComponent, OMX_CONF_AnalyzerStateName(pCall->sState), 0);
+            OMX_CONF_AnalyzerCommandReturned(pA, pCall->sComponent, nNs);
+        } else if (!strcmp(pCall->sApi, "EventHandler") && !strcmp(pCall->sEvent, "OMX_EventCmdComplete"))
+            OMX_CONF_AnalyzerComplete(pA, pCall->sComponent, OMX_CONF_AnalyzerStateName(pCall->sState), 0);
+    }
+}
+
+/* Parse "<component><- <function>(" or "<component>-> <function>(" and return
+   what follows the parenthesis, NULL if sLine starts no call. */
+static char *OMX_CONF_AnalyzerTextCallStart(char *sLine, OMX_CONF_ANALYZERTEXTCALLTYPE *pCall)
+{
+    char *sArrow, *sApi, *sParen, *sSpace;
+
+    sArrow = strstr(sLine, "<- ");
+    if (!sArrow)
+        sArrow = strstr(sLine, "-> ");
+    sSpace = strchr(sLine, ' ');
+    if (!sArrow || sArrow == sLine || sSpace < sArrow || sArrow - sLine >= OMX_CONF_ANALYZER_NAMESIZE)
+        return NULL;
+    sApi = sArrow + 3;
+    for (sParen = sApi; (*sParen >= 'A' && *sParen <= 'Z') || (*sParen >= 'a' && *sParen <= 'z'); sParen++)
+        ;
+    if (*sParen != '(' || sParen == sApi || sParen - sApi >= OMX_CONF_ANALYZER_NAMESIZE)
+        return NULL;
+
+    memset(pCall, 0, sizeof(*pCall));
+    memcpy(pCall->sComponent, sLine, sArrow - sLine);
+    memcpy(pCall->sApi, sApi, sParen - sApi);
+    return sParen + 1;
+}
+
+static OMX_ERRORTYPE OMX_CONF_AnalyzeText(OMX_CONF_ANALYZERTYPE *pA, FILE *pLog)
+{
+    OMX_CONF_ANALYZERTEXTCALLTYPE oCalls[OMX_CONF_ANALYZER_MAXNESTING], oAnnounced;
+    char sComponent[OMX_CONF_ANALYZER_NAMESIZE] = "";
+    char sName[OMX_CONF_ANALYZER_NAMESIZE];
+    char sResult[OMX_CONF_ANALYZER_NAMESIZE];
+    char sLine[1024];
+    char *pLine, *pNext;
+    OMX_U32 nTest = 0, nLine = 0, nDepth = 0;
+    size_t nLength;
+
+    memset(&oAnnounced, 0, sizeof(oAnnounced));
+
+    while (fgets(sLine, sizeof(sLine), pLog)) {
+        nLine++;
+        nLength = strlen(sLine);
+        while (nLength && (sLine[nLength - 1] == '\n' || sLine[nLength - 1] == '\r'))
+            sLine[--nLength] = '\0';
+
+        if (!strncmp(sLine, "## ", 3)) {
+            pLine = sLine + 3;
+            for (pNext = pLine + strlen(pLine); pNext > pLine && pNext[-1] == ' '; *--pNext = '\0')
+                ;
+            if (*pLine)
+                nTest = OMX_CONF_AnalyzerTest(pA, pLine, sComponent);
+            nDepth = 0;
+            continue;
+        }
+        if (!strncmp(sLine, "OMX_CONF_TestComponent ", 23)) {
+            OMX_CONF_AnalyzerCopy(sComponent, sLine + 23);
+            continue;
+        }
+
+        /* skip the trace prefix */
+        for (pLine = sLine; *pLine && strchr("=-*!^", *pLine); pLine++)
+            ;
+        while (*pLine) {
+            if (!strncmp(pLine, "calling ", 8)) {
+                if (OMX_CONF_AnalyzerTextCallStart(pLine + 8, &oAnnounced)) {
+                    oAnnounced.nLine = nLine;
+                    oAnnounced.bOpen = OMX_TRUE;
+                }
+                break;
+            }
+            if (!strncmp(pLine, ")....", 5)) {
+                /* callbacks may complete the transition before SendCommand returns */
+                if (oAnnounced.bOpen && !strcmp(oAnnounced.sCmd, "OMX_CommandStateSet") && oAnnounced.sState[0]) {
+                    OMX_CONF_AnalyzerCommand(pA, nTest, oAnnounced.sComponent, OMX_CONF_AnalyzerStateName(oAnnounced.sState), 0);
+                    oAnnounced.bCommanded = OMX_TRUE;
+                }
+                oAnnounced.bOpen = OMX_FALSE;
+                break;
+            }
+            if (!strncmp(pLine, ") returned ", 11)) {
+                if (nDepth)
+                    OMX_CONF_AnalyzerTextCall(pA, nTest, &oCalls[--nDepth], &oAnnounced, pLine);
+                break;
+            }
+            if (*pLine == '\t') {
+                pLine = OMX_CONF_AnalyzerTextParameter(pA, oAnnounced.bOpen ? &oAnnounced : nDepth ? &oCalls[nDepth - 1] : NULL, pLine);
+                continue;
+            }
+            if (nDepth < OMX_CONF_ANALYZER_MAXNESTING && (pNext = OMX_CONF_AnalyzerTextCallStart(pLine, &oCalls[nDepth])) != NULL) {
+                oCalls[nDepth++].nLine = nLine;
+                pLine = pNext;
+                continue;
+            }
+
+            /* " <test> <component> PASSED" or " <test> <component> FAILED, ..." */
+            if (nTest && sscanf(pLine, " %127s %*s %127[^\n]", sName, sResult) == 2 &&
+                !strcmp(sName, pA->pTests[nTest].sName) && !pA->pTests[nTest].sResult[0] &&
+                (!strncmp(sResult, "PASSED", 6) || !strncmp(sResult, "FAILED", 6))) {
+                OMX_CONF_AnalyzerCopy(pA->pTests[nTest].sResult, sResult);
+            }
+            break;
+        }
+    }
+    return OMX_ErrorNone;
+}
+
+/**********************************************************************
+ * EVENT LOGS
+ **********************************************************************/
+
+typedef struct OMX_CONF_ANALYZEREVENTTYPE {
+    OMX_OSAL_EVENTLOGRECORDTYPE *pRecord;
+    OMX_CONF_RECORDEDCALLTYPE *pArgs;       /* NULL if the call has no data record */
+} OMX_CONF_ANALYZEREVENTTYPE;
+
+static int OMX_CONF_AnalyzerCompareEvents(const void *pA, const void *pB)
+{
+    const OMX_OSAL_EVENTLOGRECORDTYPE *pRecordA = ((const OMX_CONF_ANALYZEREVENTTYPE *)pA)->pRecord;
+    const OMX_OSAL_EVENTLOGRECORDTYPE *pRecordB = ((const OMX_CONF_ANALYZEREVENTTYPE *)pB)->pRecord;
+    return pRecordA->nBeginNs < pRecordB->nBeginNs ? -1 : pRecordA->nBeginNs > pRecordB->nBeginNs;
+}
+
+static const char *OMX_CONF_AnalyzerState2Name(OMX_U32 nState)
+{
+    switch (nState) {
+    case OMX_StateInvalid:          return "Invalid";
+    case OMX_StateLoaded:           return "Loaded";
+    case OMX_StateIdle:             return "Idle";
+    case OMX_StateExecuting:        return "Executing";
+    case OMX_StatePause:            return "Pause";
+    case OMX_StateWaitForResources: return "WaitForResources";
+    default:                        return "?";
+    }
+}
+
+static OMX_ERRORTYPE OMX_CONF_AnalyzeEventLog(OMX_CONF_ANALYZERTYPE *pA, OMX_U8 *pLog, size_t nBytes)
+{
+    OMX_CONF_ANALYZEREVENTTYPE *pEvents = NULL, *pEvent;
+    OMX_OSAL_EVENTLOGRECORDTYPE *pRecord;
+    OMX_CONF_ANALYZERTESTTYPE *pTest;
+    OMX_CONF_RECORDEDCALLTYPE *pArgs;
+    char **sNames;
+    const char *sComponent, *sApi;
+    char sContext[OMX_CONF_ANALYZER_CONTEXTSIZE];
+    OMX_U32 nEvents = 0, nEventsAlloc = 0, nTest, nNextTest, i;
+    size_t nOffset, nPadded;
+    OMX_ERRORTYPE eError = OMX_ErrorNone;
+
+    sNames = (char **)calloc(OMX_CONF_ANALYZER_MAXNAMES, sizeof(char *));
+    if (!sNames)
+        return OMX_ErrorInsufficientResources;
+
+    /* names, test spans and calls; names are written before their first use */
+    for (nOffset = sizeof(OMX_OSAL_EVENTLOGHEADERTYPE); nOffset + sizeof(OMX_OSAL_EVENTLOGRECORDTYPE) <= nBytes; ) {
+        pRecord = (OMX_OSAL_EVENTLOGRECORDTYPE *)(pLog + nOffset);
+        nOffset += sizeof(OMX_OSAL_EVENTLOGRECORDTYPE);
+        if (pRecord->nKind == OMX_OSAL_EVENTLOG_NAME || pRecord->nKind == OMX_OSAL_EVENTLOG_DATA) {
+            /* checked before padding, which wraps for lengths near 4 GB */
+            if ((size_t)pRecord->nResult > nBytes - nOffset) {
+                fprintf(stderr, "Record at offset %lu runs past the end of the log\n",
+                        (unsigned long)(nOffset - sizeof(OMX_OSAL_EVENTLOGRECORDTYPE)));
+                eError = OMX_ErrorBadParameter;
+                break;
+            }
+            nPadded = ((size_t)pRecord->nResult + 7) & ~(size_t)7;
+            if (nOffset + nPadded > nBytes)
+                break;
+            if (pRecord->nKind == OMX_OSAL_EVENTLOG_NAME) {
+                /* names are not terminated when they fill their padding */
+                free(sNames[pRecord->nNameId]);
+                sNames[pRecord->nNameId] = (char *)malloc(pRecord->nResult + 1);
+                if (sNames[pRecord->nNameId]) {
+                    memcpy(sNames[pRecord->nNameId], pLog + nOffset, pRecord->nResult);
+                    sNames[pRecord->nNameId][pRecord->nResult] = '\0';
+                }
+            } else if (nEvents && pEvents[nEvents - 1].pRecord == pRecord - 1 &&
+                       pRecord->nResult >= sizeof(OMX_CONF_RECORDEDCALLTYPE)) {
+                pEvents[nEvents - 1].pArgs = (OMX_CONF_RECORDEDCALLTYPE *)(pLog + nOffset);
+                pA->bArguments = OMX_TRUE;
+            }
+            nOffset += nPadded;
+            continue;
+        }
+        if (pRecord->nKind != OMX_OSAL_EVENTLOG_CALL)
+            break;
+        if (pRecord->nFlags & OMX_OSAL_EVENTLOG_TEST) {
+            nTest = OMX_CONF_AnalyzerTest(pA, sNames[pRecord->nApiId] ? sNames[pRecord->nApiId] : "?",
+                sNames[pRecord->nNameId] ? sNames[pRecord->nNameId] : "?");
+            pTest = &pA->pTests[nTest];
+            pTest->bTimed = OMX_TRUE;
+            pTest->nBeginNs = pRecord->nBeginNs;
+            pTest->nEndNs = pRecord->nEndNs;
+            strcpy(pTest->sResult, pRecord->nResult == OMX_ErrorNone ? "PASSED" : "FAILED");
+            if (pRecord->nResult != OMX_ErrorNone)
+                sprintf(pTest->sResult + 6, ", %x", pRecord->nResult);
+            continue;
+        }
+        OMX_CONF_AnalyzerGrow((void **)&pEvents, nEvents, &nEventsAlloc, sizeof(OMX_CONF_ANALYZEREVENTTYPE));
+        pEvents[nEvents].pRecord = pRecord;
+        pEvents[nEvents].pArgs = NULL;
+        nEvents++;
+    }
+
+    /* records are written when calls return, order them by when they began */
+    if (eError != OMX_ErrorNone)
+        nEvents = 0;
+    if (nEvents)
+        qsort(pEvents, nEvents, sizeof(OMX_CONF_ANALYZEREVENTTYPE), OMX_CONF_AnalyzerCompareEvents);
+
+    nNextTest = 1;
+    nTest = 0;
+    for (i = 0; i < nEvents; i++) {
+        pEvent = &pEvents[i];
+        pRecord = pEvent->pRecord;
+        pArgs = pEvent->pArgs;
+
+        /* tests run one after the other and are logged in that order */
+        while (nTest && pRecord->nBeginNs > pA->pTests[nTest].nEndNs)
+            nTest = 0;
+        while (nNextTest < pA->nTests && pRecord->nBeginNs >= pA->pTests[nNextTest].nBeginNs) {
+            nTest = pRecord->nBeginNs <= pA->pTests[nNextTest].nEndNs ? nNextTest : 0;
+            nNextTest++;
+        }
+
+        sComponent = sNames[pRecord->nNameId] ? sNames[pRecord->nNameId] : "?";
+        sApi = sNames[pRecord->nApiId] ? sNames[pRecord->nApiId] : "?";
+        sprintf(sContext, "thread %u", pRecord->nThreadId);
+        if (nTest)
+            sprintf(sContext + strlen(sContext), ", %.3f ms into the test",
+                (double)(pRecord->nBeginNs - pA->pTests[nTest].nBeginNs) / 1000000);
+        if (pRecord->nBuffer)
+            sprintf(sContext + strlen(sContext), ", buffer 0x%llx", (unsigned long long)pRecord->nBuffer);
+        if (pArgs)
+            sprintf(sContext + strlen(sContext), ", args 0x%x 0x%x 0x%x", pArgs->nArgs[0], pArgs->nArgs[1], pArgs->nArgs[2]);
+        OMX_CONF_AnalyzerCall(pA, nTest, sComponent, sApi, pRecord->nEndNs - pRecord->nBeginNs,
+            pRecord->nResult != OMX_ErrorNone ? OMX_TRUE : OMX_FALSE, sContext);
+        OMX_CONF_AnalyzerBuffer(pA, nTest, sComponent, sApi, OMX_TRUE, pRecord->nBeginNs, pArgs ? pArgs->nFilledLen : 0);
+
+        if (!pArgs)
+            continue;
+        if (!strcmp(sApi, "SendCommand") && pArgs->nArgs[0] == OMX_CommandStateSet && pRecord->nResult == OMX_ErrorNone) {
+            OMX_CONF_AnalyzerCommand(pA, nTest, sComponent, OMX_CONF_AnalyzerState2Name(pArgs->nArgs[1]), pRecord->nBeginNs);
+            OMX_CONF_AnalyzerCommandReturned(pA, sComponent, pRecord->nEndNs - pRecord->nBeginNs);
+        }
+        else if (!strcmp(sApi, "EventHandler") && pArgs->nArgs[0] == OMX_EventCmdComplete && pArgs->nArgs[1] == OMX_CommandStateSet)
+            OMX_CONF_AnalyzerComplete(pA, sComponent, OMX_CONF_AnalyzerState2Name(pArgs->nArgs[2]), pRecord->nBeginNs);
+    }
+
+    free(pEvents);
+    for (i = 0; i < OMX_CONF_ANALYZER_MAXNAMES; i++)
+        free(sNames[i]);
+    free(sNames);
+    return eError;
+}
+
+/**********************************************************************
+ * REPORTS
+ **********************************************************************/
+
+static void OMX_CONF_AnalyzerJsonString(FILE *pJson, const char *sText)
+{
+    fputc('"', pJson);
+    for (; *sText; sText++) {
+        if (*sText == '"' || *sText == '\\')
+            fprintf(pJson, "\\%c", *sText);
+        else if ((unsigned char)*sText < 0x20)
+            fprintf(pJson, "\\u%04x", (unsigned char)*sText);
+        else
+            fputc(*sText, pJson);
+    }
+    fputc('"', pJson);
+}
+
+/* Distinct components with calls in test nTest, in order of their first call */
+static OMX_U32 OMX_CONF_AnalyzerComponents(OMX_CONF_ANALYZERTYPE *pA, OMX_U32 nTest, const char **sComponents, OMX_U32 nMax)
+{
+    OMX_U32 nComponents = 0, i, j;
+
+    for (i = 0; i < pA->nApis && nComponents < nMax; i++) {
+        if (pA->pApis[i].nTest != nTest)
+            continue;
+        for (j = 0; j < nComponents && strcmp(sComponents[j], pA->pApis[i].sComponent); j++)
+            ;
+        if (j == nComponents)
+            sComponents[nComponents++] = pA->pApis[i].sComponent;
+    }
+    return nComponents;
+}
+
+#define OMX_CONF_ANALYZER_MAXCOMPONENTS 64
+
+static void OMX_CONF_AnalyzerSummary(OMX_CONF_ANALYZERTYPE *pA, OMX_STRING sLogName)
+{
+    const char *sComponents[OMX_CONF_ANALYZER_MAXCOMPONENTS];
+    OMX_CONF_ANALYZERTRANSITIONTYPE *pTransition;
+    OMX_CONF_ANALYZERTRAFFICTYPE *pTraffic;
+    OMX_CONF_ANALYZERTESTTYPE *pTest;
+    OMX_CONF_ANALYZERAPITYPE *pApi;
+    OMX_U32 nComponents, nTest, c, i;
+    OMX_U64 nSpanNs;
+
+    printf("%s: %s, %u tests, %llu calls\n", sLogName, pA->bEventLog ? "event log" : "text log",
+        pA->nTests - 1, (unsigned long long)pA->nCalls);
+    if (pA->bEventLog && !pA->bArguments)
+        printf("State transitions and filled bytes need call arguments, record the log with the or command.\n");
+
+    for (nTest = 0; nTest < pA->nTests; nTest++) {
+        pTest = &pA->pTests[nTest];
+        nComponents = OMX_CONF_AnalyzerComponents(pA, nTest, sComponents, OMX_CONF_ANALYZER_MAXCOMPONENTS);
+        if (!nTest && !nComponents)
+            continue;
+        printf("\n%s", nTest ? pTest->sName : "Outside of tests");
+        if (pTest->sComponent[0])
+            printf(" on %s", pTest->sComponent);
+        if (pTest->sResult[0])
+            printf(": %s", pTest->sResult);
+        if (pTest->bTimed)
+            printf(" in %.3f ms", (double)(pTest->nEndNs - pTest->nBeginNs) / 1000000);
+        printf("\n");
+
+        for (c = 0; c < nComponents; c++) {
+            printf("  %s\n", sComponents[c]);
+            printf("    %-24s %8s %6s %10s %8s %8s %8s %8s\n", "call", "count", "errors", "total ms", "p50 us", "p90 us", "p99 us", "max us");
+            for (i = 0; i < pA->nApis; i++) {
+                pApi = &pA->pApis[i];
+                if (pApi->nTest != nTest || strcmp(pApi->sComponent, sComponents[c]))
+                    continue;
+                printf("    %-24s %8u %6u %10.3f %8llu %8llu %8llu %8llu\n", pApi->sApi, pApi->oCalls.nCount, pApi->nErrors,
+                    (double)pApi->oCalls.nTotalNs / 1000000,
+                    (unsigned long long)(OMX_CONF_AnalyzerPercentile(&pApi->oCalls, 500) / 1000),
+                    (unsigned long long)(OMX_CONF_AnalyzerPercentile(&pApi->oCalls, 900) / 1000),
+                    (unsigned long long)(OMX_CONF_AnalyzerPercentile(&pApi->oCalls, 990) / 1000),
+                    (unsigned long long)(OMX_CONF_AnalyzerPercentile(&pApi->oCalls, 1000) / 1000));
+            }
+            for (i = 0; i < pA->nTransitions; i++) {
+                pTransition = &pA->pTransitions[i];
+                if (pTransition->nTest != nTest || strcmp(pTransition->sComponent, sComponents[c]))
+                    continue;
+                printf("    transition %-20s x%u, SendCommand max %llu us", pTransition->sTransition, pTransition->oCommand.nCount,
+                    (unsigned long long)(OMX_CONF_AnalyzerPercentile(&pTransition->oCommand, 1000) / 1000));
+                if (pTransition->oComplete.nCount)
+                    printf(", completed p50 %.3f ms max %.3f ms",
+                        (double)OMX_CONF_AnalyzerPercentile(&pTransition->oComplete, 500) / 1000000,
+                        (double)OMX_CONF_AnalyzerPercentile(&pTransition->oComplete, 1000) / 1000000);
+                printf("\n");
+            }
+            for (i = 0; i < pA->nTraffic; i++) {
+                pTraffic = &pA->pTraffic[i];
+                if (pTraffic->nTest != nTest || strcmp(pTraffic->sComponent, sComponents[c]))
+                    continue;
+                printf("    buffers ETB %llu, FTB %llu, EBD %llu, FBD %llu, %llu bytes filled",
+                    (unsigned long long)pTraffic->nBuffers[0], (unsigned long long)pTraffic->nBuffers[1],
+                    (unsigned long long)pTraffic->nBuffers[2], (unsigned long long)pTraffic->nBuffers[3],
+                    (unsigned long long)pTraffic->nFilledBytes);
+                nSpanNs = pTraffic->nLastNs - pTraffic->nFirstNs;
+                if (pTraffic->bTimed && nSpanNs)
+                    printf(", %.1f buffers/s out over %.3f ms", pTraffic->nBuffers[OMX_CONF_AnalyzerFillBufferDone] * 1e9 / nSpanNs,
+                        (double)nSpanNs / 1000000);
+                printf("\n");
+            }
+        }
+    }
+
+    if (pA->nSlowest) {
+        printf("\nSlowest calls:\n");
+        for (i = 0; i < pA->nSlowest; i++) {
+            printf("  %10.3f ms  %s on %s in %s (%s)\n", (double)pA->pSlowest[i].nNs / 1000000, pA->pSlowest[i].sApi,
+                pA->pSlowest[i].sComponent, pA->pSlowest[i].nTest ? pA->pTests[pA->pSlowest[i].nTest].sName : "no test",
+                pA->pSlowest[i].sContext);
+        }
+    }
+}
+
+static void OMX_CONF_AnalyzerJsonSamples(FILE *pJson, const char *sName, OMX_CONF_ANALYZERSAMPLESTYPE *pSamples)
+{
+    if (!pSamples->nCount) {
+        fprintf(pJson, "\"%s\":null", sName);
+        return;
+    }
+    fprintf(pJson, "\"%s\":{\"count\":%u,\"total_us\":%llu,\"p50_us\":%llu,\"p90_us\":%llu,\"p99_us\":%llu,\"max_us\":%llu}",
+        sName, pSamples->nCount, (unsigned long long)(pSamples->nTotalNs / 1000),
+        (unsigned long long)(OMX_CONF_AnalyzerPercentile(pSamples, 500) / 1000),
+        (unsigned long long)(OMX_CONF_AnalyzerPercentile(pSamples, 900) / 1000),
+        (unsigned long long)(OMX_CONF_AnalyzerPercentile(pSamples, 990) / 1000),
+        (unsigned long long)(OMX_CONF_AnalyzerPercentile(pSamples, 1000) / 1000));
+}
+
+static OMX_ERRORTYPE OMX_CONF_AnalyzerJson(OMX_CONF_ANALYZERTYPE *pA, OMX_STRING sLogName, OMX_STRING sJsonName)
+{
+    const char *sComponents[OMX_CONF_ANALYZER_MAXCOMPONENTS];
+    OMX_CONF_ANALYZERTRANSITIONTYPE *pTransition;
+    OMX_CONF_ANALYZERTRAFFICTYPE *pTraffic;
+    OMX_CONF_ANALYZERTESTTYPE *pTest;
+    OMX_CONF_ANALYZERAPITYPE *pApi;
+    OMX_U32 nComponents, nTest, nTests = 0, nItems, c, i;
+    FILE *pJson;
+
+    pJson = fopen(sJsonName, "w");
+    if (!pJson)
+        return OMX_ErrorUndefined;
+
+    fprintf(pJson, "{\"log\":");
+    OMX_CONF_AnalyzerJsonString(pJson, sLogName);
+    fprintf(pJson, ",\"format\":\"%s\",\"arguments\":%s,\"calls\":%llu,\"tests\":[", pA->bEventLog ? "eventlog" : "text",
+        pA->bArguments ? "true" : "false", (unsigned long long)pA->nCalls);
+    for (nTest = 0; nTest < pA->nTests; nTest++) {
+        pTest = &pA->pTests[nTest];
+        nComponents = OMX_CONF_AnalyzerComponents(pA, nTest, sComponents, OMX_CONF_ANALYZER_MAXCOMPONENTS);
+        if (!nTest && !nComponents)
+            continue;
+        fprintf(pJson, "%s\n{\"name\":", nTests++ ? "," : "");
+        if (nTest)
+            OMX_CONF_AnalyzerJsonString(pJson, pTest->sName);
+        else
+            fprintf(pJson, "null");
+        fprintf(pJson, ",\"component\":");
+        OMX_CONF_AnalyzerJsonString(pJson, pTest->sComponent);
+        fprintf(pJson, ",\"result\":");
+        OMX_CONF_AnalyzerJsonString(pJson, pTest->sResult);
+        if (pTest->bTimed)
+            fprintf(pJson, ",\"duration_us\":%llu", (unsigned long long)((pTest->nEndNs - pTest->nBeginNs) / 1000));
+        else
+            fprintf(pJson, ",\"duration_us\":null");
+        fprintf(pJson, ",\"components\":[");
+
+        for (c = 0; c < nComponents; c++) {
+            fprintf(pJson, "%s\n {\"name\":", c ? "," : "");
+            OMX_CONF_AnalyzerJsonString(pJson, sComponents[c]);
+            fprintf(pJson, ",\"calls\":[");
+            for (nItems = 0, i = 0; i < pA->nApis; i++) {
+                pApi = &pA->pApis[i];
+                if (pApi->nTest != nTest || strcmp(pApi->sComponent, sComponents[c]))
+                    continue;
+                fprintf(pJson, "%s\n  {\"api\":", nItems++ ? "," : "");
+                OMX_CONF_AnalyzerJsonString(pJson, pApi->sApi);
+                fprintf(pJson, ",\"errors\":%u,", pApi->nErrors);
+                OMX_CONF_AnalyzerJsonSamples(pJson, "latency", &pApi->oCalls);
+                fprintf(pJson, "}");
+            }
+            fprintf(pJson, "],\"transitions\":[");
+            for (nItems = 0, i = 0; i < pA->nTransitions; i++) {
+                pTransition = &pA->pTransitions[i];
+                if (pTransition->nTest != nTest || strcmp(pTransition->sComponent, sComponents[c]))
+                    continue;
+                fprintf(pJson, "%s\n  {\"transition\":", nItems++ ? "," : "");
+                OMX_CONF_AnalyzerJsonString(pJson, pTransition->sTransition);
+                fprintf(pJson, ",");
+                OMX_CONF_AnalyzerJsonSamples(pJson, "command", &pTransition->oCommand);
+                fprintf(pJson, ",");
+                OMX_CONF_AnalyzerJsonSamples(pJson, "complete", &pTransition->oComplete);
+                fprintf(pJson, "}");
+            }
+            fprintf(pJson, "],\"buffers\":");
+            for (i = 0; i < pA->nTraffic; i++) {
+                pTraffic = &pA->pTraffic[i];
+                if (pTraffic->nTest == nTest && !strcmp(pTraffic->sComponent, sComponents[c]))
+                    break;
+            }
+            if (i == pA->nTraffic) {
+                fprintf(pJson, "null}");
+                continue;
+            }
+            fprintf(pJson, "{\"EmptyThisBuffer\":%llu,\"FillThisBuffer\":%llu,\"EmptyBufferDone\":%llu,\"FillBufferDone\":%llu,\"filled_bytes\":%llu",
+                (unsigned long long)pTraffic->nBuffers[0], (unsigned long long)pTraffic->nBuffers[1],
+                (unsigned long long)pTraffic->nBuffers[2], (unsigned long long)pTraffic->nBuffers[3],
+                (unsigned long long)pTraffic->nFilledBytes);
+            if (pTraffic->bTimed)
+                fprintf(pJson, ",\"span_us\":%llu}}", (unsigned long long)((pTraffic->nLastNs - pTraffic->nFirstNs) / 1000));
+            else
+                fprintf(pJson, ",\"span_us\":null}}");
+        }
+        fprintf(pJson, "]}");
+    }
+
+    fprintf(pJson, "],\n\"slowest\":[");
+    for (i = 0; i < pA->nSlowest; i++) {
+        fprintf(pJson, "%s\n{\"us\":%llu,\"test\":", i ? "," : "", (unsigned long long)(pA->pSlowest[i].nNs / 1000));
+        if (pA->pSlowest[i].nTest)
+            OMX_CONF_AnalyzerJsonString(pJson, pA->pTests[pA->pSlowest[i].nTest].sName);
+        else
+            fprintf(pJson, "null");
+        fprintf(pJson, ",\"component\":");
+        OMX_CONF_AnalyzerJsonString(pJson, pA->pSlowest[i].sComponent);
+        fprintf(pJson, ",\"api\":");
+        OMX_CONF_AnalyzerJsonString(pJson, pA->pSlowest[i].sApi);
+        fprintf(pJson, ",\"context\":");
+        OMX_CONF_AnalyzerJsonString(pJson, pA->pSlowest[i].sContext);
+        fprintf(pJson, "}");
+    }
+    fprintf(pJson, "]}\n");
+    fclose(pJson);
+    return OMX_ErrorNone;
+}
+
+/**********************************************************************
+ * MAIN
+ **********************************************************************/
+
+static void OMX_CONF_AnalyzerUsage()
+{
+    printf("usage: OMX_CONF_LogAnalyzer [-j <json file>] [-n <slowest calls>] <log file>\n");
+    printf("\tAnalyzes a text log (ol command) or an event log (oe or or command).\n");
+    printf("\t-j writes the report as JSON in addition to the summary on stdout.\n");
+    printf("\t-n sets how many of the slowest calls are listed (default %u).\n", OMX_CONF_ANALYZER_SLOWEST);
+}
+
+int main(int argc, char **argv)
+{
+    OMX_CONF_ANALYZERTYPE oAnalyzer;
+    OMX_OSAL_EVENTLOGHEADERTYPE oHeader;
+    OMX_STRING sLogName = NULL, sJsonName = NULL;
+    OMX_ERRORTYPE eError;
+    OMX_U8 *pLog = NULL;
+    long nBytes;
+    FILE *pFile;
+    OMX_U32 i;
+    int nArg;
+
+    memset(&oAnalyzer, 0, sizeof(oAnalyzer));
+    oAnalyzer.nMaxSlowest = OMX_CONF_ANALYZER_SLOWEST;
+    for (nArg = 1; nArg < argc; nArg++) {
+        if (!strcmp(argv[nArg], "-j") && nArg + 1 < argc)
+            sJsonName = argv[++nArg];
+        else if (!strcmp(argv[nArg], "-n") && nArg + 1 < argc)
+            oAnalyzer.nMaxSlowest = (OMX_U32)strtol(argv[++nArg], NULL, 0);
+        else if (argv[nArg][0] != '-' && !sLogName)
+            sLogName = argv[nArg];
+        else {
+            OMX_CONF_AnalyzerUsage();
+            return 2;
+        }
+    }
+    if (!sLogName) {
+        OMX_CONF_AnalyzerUsage();
+        return 2;
+    }
+
+    pFile = fopen(sLogName, "rb");
+    if (!pFile) {
+        fprintf(stderr, "Cannot open %s\n", sLogName);
+        return 1;
+    }
+    oAnalyzer.pSlowest = (OMX_CONF_ANALYZERSLOWTYPE *)calloc(oAnalyzer.nMaxSlowest + 1, sizeof(OMX_CONF_ANALYZERSLOWTYPE));
+    if (!oAnalyzer.pSlowest) {
+        fclose(pFile);
+        return 1;
+    }
+    OMX_CONF_AnalyzerTest(&oAnalyzer, "", "");     /* calls outside of tests */
+
+    if (fread(&oHeader, sizeof(oHeader), 1, pFile) == 1 && oHeader.nMagic == OMX_OSAL_EVENTLOG_MAGIC) {
+        if (oHeader.nVersion < 1 || oHeader.nVersion > OMX_OSAL_EVENTLOG_VERSION) {
+            fprintf(stderr, "%s: unsupported event log version %u\n", sLogName, oHeader.nVersion);
+            fclose(pFile);
+            return 1;
+        }
+        oAnalyzer.bEventLog = OMX_TRUE;
+        fseek(pFile, 0, SEEK_END);
+        nBytes = ftell(pFile);
+        fseek(pFile, 0, SEEK_SET);
+        pLog = (OMX_U8 *)malloc(nBytes > 0 ? (size_t)nBytes : 1);
+        if (!pLog || nBytes <= 0 || fread(pLog, 1, (size_t)nBytes, pFile) != (size_t)nBytes) {
+            fprintf(stderr, "Cannot read %s\n", sLogName);
+            fclose(pFile);
+            return 1;
+        }
+        eError = OMX_CONF_AnalyzeEventLog(&oAnalyzer, pLog, (size_t)nBytes);
+    } else {
+        fseek(pFile, 0, SEEK_SET);
+        eError = OMX_CONF_AnalyzeText(&oAnalyzer, pFile);
+    }
+    fclose(pFile);
+    if (eError != OMX_ErrorNone) {
+        fprintf(stderr, "Cannot analyze %s\n", sLogName);
+        return 1;
+    }
+
+    for (i = 0; i < oAnalyzer.nApis; i++)
+        qsort(oAnalyzer.pApis[i].oCalls.pNs, oAnalyzer.pApis[i].oCalls.nCount, sizeof(OMX_U64), OMX_CONF_AnalyzerCompareNs);
+    for (i = 0; i < oAnalyzer.nTransitions; i++) {
+        qsort(oAnalyzer.pTransitions[i].oCommand.pNs, oAnalyzer.pTransitions[i].oCommand.nCount, sizeof(OMX_U64), OMX_CONF_AnalyzerCompareNs);
+        qsort(oAnalyzer.pTransitions[i].oComplete.pNs, oAnalyzer.pTransitions[i].oComplete.nCount, sizeof(OMX_U64), OMX_CONF_AnalyzerCompareNs);
+    }
+
+    OMX_CONF_AnalyzerSummary(&oAnalyzer, sLogName);
+    if (sJsonName && OMX_CONF_AnalyzerJson(&oAnalyzer, sLogName, sJsonName) != OMX_ErrorNone) {
+        fprintf(stderr, "Cannot write %s\n", sJsonName);
+        return 1;
+    }
+    free(pLog);
+    return 0;
+}
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+/* File EOF */
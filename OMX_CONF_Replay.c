@@ -0,0 +1,767 @@
+/*
+ * Copyright (c) 2019 The Khronos Group Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/** OMX_CONF_Replay.c
+ *  Replay of an event log recorded with call arguments (see OMX_CONF_EventLogOpen).
+ *  New instances of the recorded components are driven through the recorded calls,
+ *  paced as recorded or faster, and results, output payloads and timings are
+ *  compared against the recording.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+#include <OMX_Types.h>
+#include <OMX_Component.h>
+#include <OMX_Core.h>
+#include <OMX_Index.h>
+
+#include "OMX_OSAL_Interfaces.h"
+#include "OMX_CONF_TestHarness.h"
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+/**********************************************************************
+ * REPLAY STATE
+ **********************************************************************/
+
+#define OMX_CONF_REPLAY_MAXINSTANCES  16
+#define OMX_CONF_REPLAY_MAXBUFFERS    64
+#define OMX_CONF_REPLAY_MAXNAMES      1024
+#define OMX_CONF_REPLAY_MAXPORTS      32
+#define OMX_CONF_REPLAY_TIMEOUT       1000   /* ms to wait for the callbacks a call followed */
+
+typedef struct OMX_CONF_REPLAYCALLTYPE {
+    OMX_OSAL_EVENTLOGRECORDTYPE *pRecord;
+    OMX_CONF_RECORDEDCALLTYPE *pArgs;   /* NULL if the call has no data record */
+    OMX_U8 *pData;                      /* structure or string recorded after the arguments */
+    OMX_U32 nDataBytes;
+    OMX_CONF_TRACEAPITYPE eApi;         /* OMX_CONF_TraceApiMax if not known */
+    OMX_S32 nInstance;                  /* -1 if the call is not replayed */
+    OMX_U32 nCallbacksBefore;           /* callbacks of the instance recorded before the call */
+} OMX_CONF_REPLAYCALLTYPE;
+
+typedef struct OMX_CONF_REPLAYBUFFERTYPE {
+    OMX_U64 nRecorded;                  /* recorded buffer header */
+    OMX_BUFFERHEADERTYPE *pHeader;      /* replayed buffer header */
+    OMX_U8 *pUseBuffer;                 /* memory passed to UseBuffer, NULL if allocated by the component */
+    OMX_U64 nSubmitNs;                  /* when the buffer was last handed to the component, 0 if not */
+} OMX_CONF_REPLAYBUFFERTYPE;
+
+struct OMX_CONF_REPLAYTYPE;
+
+typedef struct OMX_CONF_REPLAYINSTANCETYPE {
+    struct OMX_CONF_REPLAYTYPE *pReplay;
+    OMX_U64 nRecordedHandle;
+    OMX_STRING sName;
+    OMX_HANDLETYPE hComp;
+    OMX_BOOL bClosed;
+    OMX_U32 nRecordedCallbacks;
+    OMX_U32 nCallbacks;                 /* callbacks received while replaying */
+    OMX_U32 nMissing;                   /* callbacks given up on after a timeout */
+    OMX_U32 nNextOutput;                /* next call to look for a recorded FillBufferDone from */
+    OMX_U32 nBuffers;
+    OMX_CONF_REPLAYBUFFERTYPE oBuffers[OMX_CONF_REPLAY_MAXBUFFERS];
+} OMX_CONF_REPLAYINSTANCETYPE;
+
+typedef struct OMX_CONF_REPLAYTYPE {
+    OMX_CONF_REPLAYCALLTYPE *pCalls;
+    OMX_U32 nCalls;
+    OMX_CONF_REPLAYINSTANCETYPE oInstances[OMX_CONF_REPLAY_MAXINSTANCES];
+    OMX_U32 nInstances;
+    OMX_HANDLETYPE hMutex;
+    OMX_HANDLETYPE hCallbackEvent;
+    OMX_U32 nInputPorts;                /* ports with an open input file */
+    OMX_U32 nResults;
+    OMX_U32 nSkipped;
+    OMX_U32 nTimeouts;
+    OMX_U32 nOutputs;
+    OMX_U32 nOutputMismatches;
+    OMX_U32 nInputs;
+    OMX_U32 nInputMismatches;
+    OMX_CONF_HISTOGRAMTYPE oRecorded[OMX_CONF_TRACE_COMPONENTAPIS];
+    OMX_CONF_HISTOGRAMTYPE oReplayed[OMX_CONF_TRACE_COMPONENTAPIS];
+    OMX_CONF_HISTOGRAMTYPE oRecordedResidency[2];   /* input, output */
+    OMX_CONF_HISTOGRAMTYPE oReplayedResidency[2];
+} OMX_CONF_REPLAYTYPE;
+
+static OMX_BOOL OMX_CONF_ReplayIsCallback(OMX_CONF_TRACEAPITYPE eApi)
+{
+    return (eApi >= OMX_CONF_TraceApiEventHandler && eApi <= OMX_CONF_TraceApiFillBufferDone) ? OMX_TRUE : OMX_FALSE;
+}
+
+static OMX_CONF_REPLAYBUFFERTYPE *OMX_CONF_ReplayFindBuffer(OMX_CONF_REPLAYINSTANCETYPE *pInstance,
+                                                            OMX_U64 nRecorded, OMX_BUFFERHEADERTYPE *pHeader)
+{
+    OMX_U32 i;
+
+    for (i = 0; i < pInstance->nBuffers; i++) {
+        if (pHeader ? pInstance->oBuffers[i].pHeader == pHeader : pInstance->oBuffers[i].nRecorded == nRecorded)
+            return &pInstance->oBuffers[i];
+    }
+    return NULL;
+}
+
+static OMX_CONF_REPLAYBUFFERTYPE *OMX_CONF_ReplayAddBuffer(OMX_CONF_REPLAYINSTANCETYPE *pInstance, OMX_U64 nRecorded)
+{
+    OMX_CONF_REPLAYBUFFERTYPE *pBuffer;
+
+    if (pInstance->nBuffers == OMX_CONF_REPLAY_MAXBUFFERS)
+        return NULL;
+    pBuffer = &pInstance->oBuffers[pInstance->nBuffers++];
+    memset(pBuffer, 0, sizeof(*pBuffer));
+    pBuffer->nRecorded = nRecorded;
+    return pBuffer;
+}
+
+static void OMX_CONF_ReplayRemoveBuffer(OMX_CONF_REPLAYINSTANCETYPE *pInstance, OMX_CONF_REPLAYBUFFERTYPE *pBuffer)
+{
+    if (pBuffer->pUseBuffer)
+        OMX_OSAL_Free(pBuffer->pUseBuffer);
+    *pBuffer = pInstance->oBuffers[--pInstance->nBuffers];
+}
+
+/**********************************************************************
+ * LOADING - index the calls of the log, assign them to component
+ * instances and work out what each call waited for.
+ **********************************************************************/
+
+static int OMX_CONF_ReplayCompare(const void *pA, const void *pB)
+{
+    const OMX_CONF_REPLAYCALLTYPE *pCallA = (const OMX_CONF_REPLAYCALLTYPE *)pA;
+    const OMX_CONF_REPLAYCALLTYPE *pCallB = (const OMX_CONF_REPLAYCALLTYPE *)pB;
+
+    /* calls that began together keep their order in the log */
+    if (pCallA->pRecord->nBeginNs != pCallB->pRecord->nBeginNs)
+        return pCallA->pRecord->nBeginNs < pCallB->pRecord->nBeginNs ? -1 : 1;
+    return pCallA->pRecord < pCallB->pRecord ? -1 : (pCallA->pRecord > pCallB->pRecord);
+}
+
+static OMX_ERRORTYPE OMX_CONF_ReplayIndex(OMX_CONF_REPLAYTYPE *pReplay, OMX_U8 *pLog, OMX_U32 nBytes)
+{
+    OMX_OSAL_EVENTLOGRECORDTYPE *pRecord;
+    OMX_CONF_REPLAYCALLTYPE *pCall = NULL;
+    OMX_U8 eApis[OMX_CONF_REPLAY_MAXNAMES + 1];
+    OMX_U32 nPos, nPass, nCalls = 0, nLength, i;
+
+    memset(eApis, OMX_CONF_TraceApiMax, sizeof(eApis));
+
+    /* the first pass counts the calls, the second indexes them */
+    for (nPass = 0; nPass < 2; nPass++) {
+        nPos = sizeof(OMX_OSAL_EVENTLOGHEADERTYPE);
+        while (nPos + sizeof(OMX_OSAL_EVENTLOGRECORDTYPE) <= nBytes) {
+            pRecord = (OMX_OSAL_EVENTLOGRECORDTYPE *)(pLog + nPos);
+            nPos += sizeof(OMX_OSAL_EVENTLOGRECORDTYPE);
+            if (pRecord->nKind == OMX_OSAL_EVENTLOG_NAME || pRecord->nKind == OMX_OSAL_EVENTLOG_DATA) {
+                nLength = (pRecord->nResult + 7) & ~7;
+                if (nLength > nBytes - nPos)
+                    break;
+                if (nPass == 1 && pRecord->nKind == OMX_OSAL_EVENTLOG_NAME && pRecord->nNameId <= OMX_CONF_REPLAY_MAXNAMES) {
+                    for (i = 0; i < OMX_CONF_TraceApiMax; i++) {
+                        if (strlen(g_OMX_CONF_sTraceApiNames[i]) == pRecord->nResult
+                            && !memcmp(g_OMX_CONF_sTraceApiNames[i], pLog + nPos, pRecord->nResult))
+                            eApis[pRecord->nNameId] = (OMX_U8)i;
+                    }
+                }
+                if (nPass == 1 && pRecord->nKind == OMX_OSAL_EVENTLOG_DATA && pCall && !pCall->pArgs
+                    && pRecord->nResult >= sizeof(OMX_CONF_RECORDEDCALLTYPE)) {
+                    pCall->pArgs = (OMX_CONF_RECORDEDCALLTYPE *)(pLog + nPos);
+                    pCall->pData = pLog + nPos + sizeof(OMX_CONF_RECORDEDCALLTYPE);
+                    pCall->nDataBytes = pRecord->nResult - sizeof(OMX_CONF_RECORDEDCALLTYPE);
+                }
+                nPos += nLength;
+                continue;
+            }
+            if (pRecord->nKind != OMX_OSAL_EVENTLOG_CALL)
+                break;
+            if (nPass == 1) {
+                pCall = &pReplay->pCalls[pReplay->nCalls++];
+                memset(pCall, 0, sizeof(*pCall));
+                pCall->pRecord = pRecord;
+                pCall->nInstance = -1;
+                /* names are always defined before the calls that use them */
+                pCall->eApi = (OMX_CONF_TRACEAPITYPE)((pRecord->nApiId <= OMX_CONF_REPLAY_MAXNAMES) ?
+                              eApis[pRecord->nApiId] : OMX_CONF_TraceApiMax);
+            } else {
+                nCalls++;
+            }
+        }
+        if (nPass == 0) {
+            if (!nCalls)
+                return OMX_ErrorUndefined;
+            pReplay->pCalls = (OMX_CONF_REPLAYCALLTYPE *)OMX_OSAL_Malloc(nCalls * sizeof(OMX_CONF_REPLAYCALLTYPE));
+            if (!pReplay->pCalls)
+                return OMX_ErrorInsufficientResources;
+        }
+    }
+
+    qsort(pReplay->pCalls, pReplay->nCalls, sizeof(OMX_CONF_REPLAYCALLTYPE), OMX_CONF_ReplayCompare);
+    return OMX_ErrorNone;
+}
+
+static void OMX_CONF_ReplayAssign(OMX_CONF_REPLAYTYPE *pReplay)
+{
+    OMX_CONF_REPLAYCALLTYPE *pCall;
+    OMX_CONF_REPLAYINSTANCETYPE *pInstance;
+    OMX_CONF_REPLAYBUFFERTYPE *pBuffer;
+    OMX_U64 nNsec;
+    OMX_S32 nInstance;
+    OMX_U32 i, j;
+
+    for (i = 0; i < pReplay->nCalls; i++) {
+        pCall = &pReplay->pCalls[i];
+        if (!pCall->pArgs || pCall->eApi == OMX_CONF_TraceApiMax)
+            continue;
+
+        nInstance = -1;
+        if (pCall->eApi == OMX_CONF_TraceApiTracerCreate) {
+            if (pReplay->nInstances < OMX_CONF_REPLAY_MAXINSTANCES && pCall->nDataBytes
+                && memchr(pCall->pData, 0, pCall->nDataBytes)) {
+                nInstance = (OMX_S32)pReplay->nInstances++;
+                pReplay->oInstances[nInstance].nRecordedHandle = pCall->pArgs->nHandle;
+                pReplay->oInstances[nInstance].sName = (OMX_STRING)pCall->pData;
+            }
+        } else {
+            /* handles are reused, so take the latest instance still open */
+            for (j = pReplay->nInstances; j-- > 0 && nInstance < 0; ) {
+                if (!pReplay->oInstances[j].bClosed && pReplay->oInstances[j].nRecordedHandle == pCall->pArgs->nHandle)
+                    nInstance = (OMX_S32)j;
+            }
+        }
+        if (nInstance < 0)
+            continue;
+
+        pInstance = &pReplay->oInstances[nInstance];
+        pCall->nInstance = nInstance;
+        pCall->nCallbacksBefore = pInstance->nRecordedCallbacks;
+        if (OMX_CONF_ReplayIsCallback(pCall->eApi))
+            pInstance->nRecordedCallbacks++;
+        if (pCall->eApi == OMX_CONF_TraceApiTracerDestroy)
+            pInstance->bClosed = OMX_TRUE;
+
+        nNsec = pCall->pRecord->nEndNs - pCall->pRecord->nBeginNs;
+        if (pCall->eApi < OMX_CONF_TRACE_COMPONENTAPIS)
+            OMX_CONF_HistogramRecord(&pReplay->oRecorded[pCall->eApi], nNsec);
+
+        /* recorded buffer residency, from handing a buffer over to getting it back */
+        if (!pCall->pArgs->nBuffer)
+            continue;
+        pBuffer = OMX_CONF_ReplayFindBuffer(pInstance, pCall->pArgs->nBuffer, NULL);
+        if (!pBuffer && !(pBuffer = OMX_CONF_ReplayAddBuffer(pInstance, pCall->pArgs->nBuffer)))
+            continue;
+        switch (pCall->eApi) {
+        case OMX_CONF_TraceApiEmptyThisBuffer:
+        case OMX_CONF_TraceApiFillThisBuffer:
+            pBuffer->nSubmitNs = (pCall->pRecord->nResult == OMX_ErrorNone) ? pCall->pRecord->nBeginNs : 0;
+            break;
+        case OMX_CONF_TraceApiEmptyBufferDone:
+        case OMX_CONF_TraceApiFillBufferDone:
+            if (pBuffer->nSubmitNs && pCall->pRecord->nBeginNs >= pBuffer->nSubmitNs)
+                OMX_CONF_HistogramRecord(&pReplay->oRecordedResidency[pCall->eApi == OMX_CONF_TraceApiFillBufferDone],
+                                         pCall->pRecord->nBeginNs - pBuffer->nSubmitNs);
+            pBuffer->nSubmitNs = 0;
+            break;
+        case OMX_CONF_TraceApiFreeBuffer:
+            OMX_CONF_ReplayRemoveBuffer(pInstance, pBuffer);
+            break;
+        default:
+            break;
+        }
+    }
+
+    /* the replay starts from scratch */
+    for (i = 0; i < pReplay->nInstances; i++) {
+        pReplay->oInstances[i].pReplay = pReplay;
+        pReplay->oInstances[i].bClosed = OMX_FALSE;
+        pReplay->oInstances[i].nBuffers = 0;
+    }
+}
+
+/**********************************************************************
+ * CALLBACKS of the replayed components
+ **********************************************************************/
+
+static OMX_ERRORTYPE OMX_CONF_ReplayEventHandler(
+    OMX_IN OMX_HANDLETYPE hComponent,
+    OMX_IN OMX_PTR pAppData,
+    OMX_IN OMX_EVENTTYPE eEvent,
+    OMX_IN OMX_U32 nData1,
+    OMX_IN OMX_U32 nData2,
+    OMX_IN OMX_PTR pEventData)
+{
+    OMX_CONF_REPLAYINSTANCETYPE *pInstance = (OMX_CONF_REPLAYINSTANCETYPE *)pAppData;
+
+    UNUSED_PARAMETER(hComponent);
+    UNUSED_PARAMETER(eEvent);
+    UNUSED_PARAMETER(nData1);
+    UNUSED_PARAMETER(nData2);
+    UNUSED_PARAMETER(pEventData);
+
+    OMX_OSAL_MutexLock(pInstance->pReplay->hMutex);
+    pInstance->nCallbacks++;
+    OMX_OSAL_MutexUnlock(pInstance->pReplay->hMutex);
+    OMX_OSAL_EventSet(pInstance->pReplay->hCallbackEvent);
+    return OMX_ErrorNone;
+}
+
+/* Called with the replay mutex held. */
+static void OMX_CONF_ReplayBufferDone(OMX_CONF_REPLAYINSTANCETYPE *pInstance, OMX_BUFFERHEADERTYPE *pHeader, OMX_U32 nResidency)
+{
+    OMX_CONF_REPLAYTYPE *pReplay = pInstance->pReplay;
+    OMX_CONF_REPLAYBUFFERTYPE *pBuffer;
+    OMX_U64 nNowNs = OMX_OSAL_GetTimeNs();
+
+    pInstance->nCallbacks++;
+    pBuffer = OMX_CONF_ReplayFindBuffer(pInstance, 0, pHeader);
+    if (pBuffer && pBuffer->nSubmitNs) {
+        OMX_CONF_HistogramRecord(&pReplay->oReplayedResidency[nResidency], nNowNs - pBuffer->nSubmitNs);
+        pBuffer->nSubmitNs = 0;
+    }
+}
+
+static OMX_ERRORTYPE OMX_CONF_ReplayEmptyBufferDone(
+    OMX_IN OMX_HANDLETYPE hComponent,
+    OMX_IN OMX_PTR pAppData,
+    OMX_IN OMX_BUFFERHEADERTYPE* pBuffer)
+{
+    OMX_CONF_REPLAYINSTANCETYPE *pInstance = (OMX_CONF_REPLAYINSTANCETYPE *)pAppData;
+
+    UNUSED_PARAMETER(hComponent);
+
+    OMX_OSAL_MutexLock(pInstance->pReplay->hMutex);
+    OMX_CONF_ReplayBufferDone(pInstance, pBuffer, 0);
+    OMX_OSAL_MutexUnlock(pInstance->pReplay->hMutex);
+    OMX_OSAL_EventSet(pInstance->pReplay->hCallbackEvent);
+    return OMX_ErrorNone;
+}
+
+static OMX_ERRORTYPE OMX_CONF_ReplayFillBufferDone(
+    OMX_IN OMX_HANDLETYPE hComponent,
+    OMX_IN OMX_PTR pAppData,
+    OMX_IN OMX_BUFFERHEADERTYPE* pBuffer)
+{
+    OMX_CONF_REPLAYINSTANCETYPE *pInstance = (OMX_CONF_REPLAYINSTANCETYPE *)pAppData;
+    OMX_CONF_REPLAYTYPE *pReplay = pInstance->pReplay;
+    OMX_CONF_REPLAYCALLTYPE *pCall;
+    OMX_U64 nHash;
+
+    UNUSED_PARAMETER(hComponent);
+
+    nHash = OMX_CONF_PayloadHash(pBuffer->pBuffer ? pBuffer->pBuffer + pBuffer->nOffset : NULL, pBuffer->nFilledLen);
+
+    OMX_OSAL_MutexLock(pReplay->hMutex);
+    OMX_CONF_ReplayBufferDone(pInstance, pBuffer, 1);
+
+    /* output is compared in order against the recorded FillBufferDone calls */
+    for (; pInstance->nNextOutput < pReplay->nCalls; pInstance->nNextOutput++) {
+        pCall = &pReplay->pCalls[pInstance->nNextOutput];
+        if (pCall->eApi == OMX_CONF_TraceApiFillBufferDone && pCall->nInstance == pInstance - pReplay->oInstances) {
+            pReplay->nOutputs++;
+            if (pCall->pArgs->nPayloadHash != nHash || pCall->pArgs->nFilledLen != pBuffer->nFilledLen)
+                pReplay->nOutputMismatches++;
+            pInstance->nNextOutput++;
+            break;
+        }
+    }
+    OMX_OSAL_MutexUnlock(pReplay->hMutex);
+    OMX_OSAL_EventSet(pReplay->hCallbackEvent);
+    return OMX_ErrorNone;
+}
+
+static OMX_CALLBACKTYPE g_OMX_CONF_ReplayCallbacks = {
+    OMX_CONF_ReplayEventHandler,
+    OMX_CONF_ReplayEmptyBufferDone,
+    OMX_CONF_ReplayFillBufferDone
+};
+
+/**********************************************************************
+ * REPLAY
+ **********************************************************************/
+
+/* Wait until the instance has had nCallbacks callbacks and it is nDueNs. Returns
+   OMX_FALSE if the callbacks did not come within OMX_CONF_REPLAY_TIMEOUT. */
+static OMX_BOOL OMX_CONF_ReplayWait(OMX_CONF_REPLAYINSTANCETYPE *pInstance, OMX_U32 nCallbacks, OMX_U64 nDueNs)
+{
+    OMX_CONF_REPLAYTYPE *pReplay = pInstance->pReplay;
+    OMX_U64 nNowNs, nGiveUpNs = OMX_OSAL_GetTimeNs() + (OMX_U64)OMX_CONF_REPLAY_TIMEOUT * 1000000;
+    OMX_U32 nReceived, nWaitMs;
+    OMX_BOOL bTimedOut;
+
+    for (;;) {
+        OMX_OSAL_EventReset(pReplay->hCallbackEvent);
+        OMX_OSAL_MutexLock(pReplay->hMutex);
+        nReceived = pInstance->nCallbacks + pInstance->nMissing;
+        OMX_OSAL_MutexUnlock(pReplay->hMutex);
+        nNowNs = OMX_OSAL_GetTimeNs();
+        if (nReceived >= nCallbacks) {
+            if (nNowNs >= nDueNs)
+                return OMX_TRUE;
+            nWaitMs = (OMX_U32)((nDueNs - nNowNs) / 1000000);
+        } else {
+            if (nNowNs >= nGiveUpNs) {
+                /* stop waiting for these callbacks on later calls too */
+                OMX_OSAL_MutexLock(pReplay->hMutex);
+                pInstance->nMissing += nCallbacks - nReceived;
+                OMX_OSAL_MutexUnlock(pReplay->hMutex);
+                return OMX_FALSE;
+            }
+            nWaitMs = (OMX_U32)((nGiveUpNs - nNowNs) / 1000000) + 1;
+        }
+        /* less than a millisecond to go is spun off */
+        if (nWaitMs)
+            OMX_OSAL_EventWait(pReplay->hCallbackEvent, nWaitMs, &bTimedOut);
+    }
+}
+
+static void OMX_CONF_ReplayClose(OMX_CONF_REPLAYINSTANCETYPE *pInstance)
+{
+    if (pInstance->hComp)
+        OMX_FreeHandle(pInstance->hComp);
+    pInstance->hComp = NULL;
+    while (pInstance->nBuffers)
+        OMX_CONF_ReplayRemoveBuffer(pInstance, &pInstance->oBuffers[0]);
+    pInstance->bClosed = OMX_TRUE;
+}
+
+/* Give the buffer of an EmptyThisBuffer call the recorded contents. Without an
+   input file for the port only the header fields are set. */
+static void OMX_CONF_ReplayFillInput(OMX_CONF_REPLAYTYPE *pReplay, OMX_CONF_RECORDEDCALLTYPE *pArgs, OMX_BUFFERHEADERTYPE *pHeader)
+{
+    OMX_U32 nPort = pArgs->nPortIndex, nBit;
+    OMX_U64 nHash;
+
+    pHeader->nOffset = (pArgs->nOffset < pHeader->nAllocLen) ? pArgs->nOffset : 0;
+    pHeader->nFilledLen = (pArgs->nFilledLen <= pHeader->nAllocLen - pHeader->nOffset) ? pArgs->nFilledLen : pHeader->nAllocLen - pHeader->nOffset;
+    pHeader->nFlags = pArgs->nFlags;
+    pHeader->nTimeStamp = pArgs->nTimeStamp;
+    if (nPort >= OMX_CONF_REPLAY_MAXPORTS || !pHeader->pBuffer)
+        return;
+
+    nBit = 1 << nPort;
+    if (!(pReplay->nInputPorts & nBit) && OMX_ErrorNone == OMX_OSAL_OpenInputFile(nPort))
+        pReplay->nInputPorts |= nBit;
+    if (!(pReplay->nInputPorts & nBit))
+        return;
+
+    pHeader->nFilledLen = OMX_OSAL_ReadFromInputFile(pHeader->pBuffer + pHeader->nOffset, pHeader->nFilledLen, nPort);
+    nHash = OMX_CONF_PayloadHash(pHeader->pBuffer + pHeader->nOffset, pHeader->nFilledLen);
+    pReplay->nInputs++;
+    if (nHash != pArgs->nPayloadHash || pHeader->nFilledLen != pArgs->nFilledLen)
+        pReplay->nInputMismatches++;
+}
+
+/* Make one recorded call on the replayed instance. Returns OMX_FALSE if the call
+   could not be replayed. */
+static OMX_BOOL OMX_CONF_ReplayCall(OMX_CONF_REPLAYTYPE *pReplay, OMX_CONF_REPLAYCALLTYPE *pCall)
+{
+    OMX_CONF_REPLAYINSTANCETYPE *pInstance = &pReplay->oInstances[pCall->nInstance];
+    OMX_CONF_RECORDEDCALLTYPE *pArgs = pCall->pArgs;
+    OMX_CONF_REPLAYBUFFERTYPE *pBuffer = NULL;
+    OMX_BUFFERHEADERTYPE *pHeader = NULL;
+    OMX_U64 aStructure[OMX_CONF_RECORD_MAXDATA / sizeof(OMX_U64)];
+    char sName[OMX_MAX_STRINGNAME_SIZE], sResult[64], sRecorded[64];
+    OMX_VERSIONTYPE oComponentVersion, oSpecVersion;
+    OMX_UUIDTYPE oUUID;
+    OMX_INDEXTYPE nIndex = OMX_IndexComponentStartUnused;
+    OMX_STATETYPE eState = OMX_StateInvalid;
+    OMX_ERRORTYPE eError = OMX_ErrorNone;
+    OMX_U8 *pUseBuffer = NULL;
+    OMX_U64 nBeginNs, nNsec;
+
+    if (pCall->eApi == OMX_CONF_TraceApiTracerCreate) {
+        if (OMX_ErrorNone != OMX_GetHandle(&pInstance->hComp, pInstance->sName, pInstance, &g_OMX_CONF_ReplayCallbacks)) {
+            OMX_OSAL_Trace(OMX_OSAL_TRACE_ERROR, "Replay failed to get a handle for %s\n", pInstance->sName);
+            pInstance->hComp = NULL;
+            return OMX_FALSE;
+        }
+        return OMX_TRUE;
+    }
+    if (pCall->eApi == OMX_CONF_TraceApiTracerDestroy) {
+        OMX_CONF_ReplayClose(pInstance);
+        return OMX_TRUE;
+    }
+    if (!pInstance->hComp)
+        return OMX_FALSE;
+
+    /* map the recorded buffer header, and set up what the call passes */
+    switch (pCall->eApi) {
+    case OMX_CONF_TraceApiGetParameter:
+    case OMX_CONF_TraceApiSetParameter:
+    case OMX_CONF_TraceApiGetConfig:
+    case OMX_CONF_TraceApiSetConfig:
+        if (pCall->nDataBytes < sizeof(OMX_U32) || *(OMX_U32 *)pCall->pData > pCall->nDataBytes)
+            return OMX_FALSE;
+        memcpy(aStructure, pCall->pData, pCall->nDataBytes);
+        break;
+    case OMX_CONF_TraceApiGetExtensionIndex:
+        if (!pCall->nDataBytes || !memchr(pCall->pData, 0, pCall->nDataBytes))
+            return OMX_FALSE;
+        break;
+    case OMX_CONF_TraceApiSendCommand:
+        if (pArgs->nArgs[0] == OMX_CommandMarkBuffer)
+            return OMX_FALSE;
+        break;
+    case OMX_CONF_TraceApiUseBuffer:
+        if (pInstance->nBuffers == OMX_CONF_REPLAY_MAXBUFFERS || (pUseBuffer = (OMX_U8 *)OMX_OSAL_Malloc(pArgs->nArgs[1])) == NULL)
+            return OMX_FALSE;
+        break;
+    case OMX_CONF_TraceApiAllocateBuffer:
+        if (pInstance->nBuffers == OMX_CONF_REPLAY_MAXBUFFERS)
+            return OMX_FALSE;
+        break;
+    case OMX_CONF_TraceApiFreeBuffer:
+    case OMX_CONF_TraceApiEmptyThisBuffer:
+    case OMX_CONF_TraceApiFillThisBuffer:
+        OMX_OSAL_MutexLock(pReplay->hMutex);
+        pBuffer = OMX_CONF_ReplayFindBuffer(pInstance, pArgs->nBuffer, NULL);
+        pHeader = pBuffer ? pBuffer->pHeader : NULL;
+        OMX_OSAL_MutexUnlock(pReplay->hMutex);
+        if (!pBuffer)
+            return OMX_FALSE;
+        if (pCall->eApi == OMX_CONF_TraceApiEmptyThisBuffer)
+            OMX_CONF_ReplayFillInput(pReplay, pArgs, pHeader);
+        break;
+    case OMX_CONF_TraceApiGetComponentVersion:
+    case OMX_CONF_TraceApiGetState:
+        break;
+    default:
+        /* tunnels need the other component and the core owns callbacks and deinit */
+        return OMX_FALSE;
+    }
+
+    nBeginNs = OMX_OSAL_GetTimeNs();
+    if (pBuffer && pCall->eApi != OMX_CONF_TraceApiFreeBuffer) {
+        OMX_OSAL_MutexLock(pReplay->hMutex);
+        pBuffer->nSubmitNs = nBeginNs;
+        OMX_OSAL_MutexUnlock(pReplay->hMutex);
+    }
+    switch (pCall->eApi) {
+    case OMX_CONF_TraceApiGetComponentVersion:
+        eError = OMX_GetComponentVersion(pInstance->hComp, sName, &oComponentVersion, &oSpecVersion, &oUUID);
+        break;
+    case OMX_CONF_TraceApiSendCommand:
+        eError = OMX_SendCommand(pInstance->hComp, (OMX_COMMANDTYPE)pArgs->nArgs[0], pArgs->nArgs[1], NULL);
+        break;
+    case OMX_CONF_TraceApiGetParameter:
+        eError = OMX_GetParameter(pInstance->hComp, (OMX_INDEXTYPE)pArgs->nArgs[0], aStructure);
+        break;
+    case OMX_CONF_TraceApiSetParameter:
+        eError = OMX_SetParameter(pInstance->hComp, (OMX_INDEXTYPE)pArgs->nArgs[0], aStructure);
+        break;
+    case OMX_CONF_TraceApiGetConfig:
+        eError = OMX_GetConfig(pInstance->hComp, (OMX_INDEXTYPE)pArgs->nArgs[0], aStructure);
+        break;
+    case OMX_CONF_TraceApiSetConfig:
+        eError = OMX_SetConfig(pInstance->hComp, (OMX_INDEXTYPE)pArgs->nArgs[0], aStructure);
+        break;
+    case OMX_CONF_TraceApiGetExtensionIndex:
+        eError = OMX_GetExtensionIndex(pInstance->hComp, (OMX_STRING)pCall->pData, &nIndex);
+        break;
+    case OMX_CONF_TraceApiGetState:
+        eError = OMX_GetState(pInstance->hComp, &eState);
+        break;
+    case OMX_CONF_TraceApiUseBuffer:
+        eError = OMX_UseBuffer(pInstance->hComp, &pHeader, pArgs->nArgs[0], NULL, pArgs->nArgs[1], pUseBuffer);
+        break;
+    case OMX_CONF_TraceApiAllocateBuffer:
+        eError = OMX_AllocateBuffer(pInstance->hComp, &pHeader, pArgs->nArgs[0], NULL, pArgs->nArgs[1]);
+        break;
+    case OMX_CONF_TraceApiFreeBuffer:
+        eError = OMX_FreeBuffer(pInstance->hComp, pArgs->nArgs[0], pHeader);
+        break;
+    case OMX_CONF_TraceApiEmptyThisBuffer:
+        eError = OMX_EmptyThisBuffer(pInstance->hComp, pHeader);
+        break;
+    case OMX_CONF_TraceApiFillThisBuffer:
+        eError = OMX_FillThisBuffer(pInstance->hComp, pHeader);
+        break;
+    default:
+        break;
+    }
+    nNsec = OMX_OSAL_GetTimeNs() - nBeginNs;
+    OMX_CONF_HistogramRecord(&pReplay->oReplayed[pCall->eApi], nNsec);
+
+    /* keep track of the replayed buffer headers */
+    OMX_OSAL_MutexLock(pReplay->hMutex);
+    if ((pCall->eApi == OMX_CONF_TraceApiUseBuffer || pCall->eApi == OMX_CONF_TraceApiAllocateBuffer) && eError == OMX_ErrorNone) {
+        pBuffer = OMX_CONF_ReplayAddBuffer(pInstance, pArgs->nBuffer);
+        pBuffer->pHeader = pHeader;
+        pBuffer->pUseBuffer = pUseBuffer;
+        pUseBuffer = NULL;
+    } else if (pCall->eApi == OMX_CONF_TraceApiFreeBuffer) {
+        OMX_CONF_ReplayRemoveBuffer(pInstance, pBuffer);
+    } else if (pBuffer && eError != OMX_ErrorNone) {
+        pBuffer->nSubmitNs = 0;
+    }
+    OMX_OSAL_MutexUnlock(pReplay->hMutex);
+    if (pUseBuffer)
+        OMX_OSAL_Free(pUseBuffer);
+
+    if (eError != (OMX_ERRORTYPE)pCall->pRecord->nResult
+        || (pCall->eApi == OMX_CONF_TraceApiGetState && eError == OMX_ErrorNone && eState != (OMX_STATETYPE)pArgs->nArgs[0])) {
+        pReplay->nResults++;
+        if (OMX_ErrorNone != OMX_CONF_ErrorToString(eError, sResult))
+            sprintf(sResult, "0x%08x", eError);
+        if (OMX_ErrorNone != OMX_CONF_ErrorToString((OMX_ERRORTYPE)pCall->pRecord->nResult, sRecorded))
+            sprintf(sRecorded, "0x%08x", pCall->pRecord->nResult);
+        OMX_OSAL_Trace(OMX_OSAL_TRACE_WARNING, "Replayed %s on %s returned %s, recorded %s\n",
+            g_OMX_CONF_sTraceApiNames[pCall->eApi], pInstance->sName, sResult, sRecorded);
+    }
+    return OMX_TRUE;
+}
+
+static void OMX_CONF_ReplayPrintRow(OMX_STRING sName, OMX_CONF_HISTOGRAMTYPE *pRecorded, OMX_CONF_HISTOGRAMTYPE *pReplayed)
+{
+    static const OMX_U32 nPerMille[] = {500, 990};
+    OMX_U64 nValue;
+    OMX_U32 i;
+
+    if (!pRecorded->nCount && !pReplayed->nCount)
+        return;
+    OMX_OSAL_Trace(OMX_OSAL_TRACE_INFO, "\t%-24s %10llu %10llu", sName,
+        (unsigned long long)pRecorded->nCount, (unsigned long long)pReplayed->nCount);
+    for (i = 0; i < 2 * (sizeof(nPerMille) / sizeof(nPerMille[0]) + 1); i++) {
+        if (i / 2 < sizeof(nPerMille) / sizeof(nPerMille[0]))
+            nValue = OMX_CONF_HistogramPercentile((i & 1) ? pReplayed : pRecorded, nPerMille[i / 2]);
+        else
+            nValue = ((i & 1) ? pReplayed : pRecorded)->nMax;
+        OMX_OSAL_Trace(OMX_OSAL_TRACE_INFO, " %6llu.%03u", (unsigned long long)(nValue / 1000), (unsigned)(nValue % 1000));
+    }
+    OMX_OSAL_Trace(OMX_OSAL_TRACE_INFO, "\n");
+}
+
+static void OMX_CONF_ReplayReport(OMX_CONF_REPLAYTYPE *pReplay, OMX_STRING sFilename, OMX_U32 nSpeed,
+                                  OMX_U64 nRecordedNs, OMX_U64 nReplayedNs)
+{
+    OMX_U32 i, nMissing = 0;
+
+    for (i = 0; i < pReplay->nInstances; i++)
+        nMissing += pReplay->oInstances[i].nMissing;
+
+    OMX_OSAL_Trace(OMX_OSAL_TRACE_INFO, "\nReplay of %s (%s pacing): %u calls on %u components\n", sFilename,
+        nSpeed ? (nSpeed == 1 ? "recorded" : "accelerated") : "no", pReplay->nCalls, pReplay->nInstances);
+    OMX_OSAL_Trace(OMX_OSAL_TRACE_INFO, "\trecorded in %llu.%03u ms, replayed in %llu.%03u ms\n",
+        (unsigned long long)(nRecordedNs / 1000000), (unsigned)(nRecordedNs / 1000 % 1000),
+        (unsigned long long)(nReplayedNs / 1000000), (unsigned)(nReplayedNs / 1000 % 1000));
+    OMX_OSAL_Trace(OMX_OSAL_TRACE_INFO, "\t%u results differ, %u calls not replayed, %u waits for callbacks timed out, %u callbacks missing\n",
+        pReplay->nResults, pReplay->nSkipped, pReplay->nTimeouts, nMissing);
+    /* output only follows the recording if the input did */
+    if (pReplay->nInputs)
+        OMX_OSAL_Trace(OMX_OSAL_TRACE_INFO, "\t%u of %u output buffers differ, %u of %u input buffers differ from the input files\n",
+            pReplay->nOutputMismatches, pReplay->nOutputs, pReplay->nInputMismatches, pReplay->nInputs);
+    else
+        OMX_OSAL_Trace(OMX_OSAL_TRACE_INFO, "\toutput not compared, no input files are mapped to the input ports\n");
+
+    OMX_OSAL_Trace(OMX_OSAL_TRACE_INFO, "\nRecorded and replayed latency (us):\n");
+    OMX_OSAL_Trace(OMX_OSAL_TRACE_INFO, "\t%-24s %10s %10s %10s %10s %10s %10s %10s %10s\n",
+        "call", "count", "replayed", "p50", "replayed", "p99", "replayed", "max", "replayed");
+    for (i = 0; i < OMX_CONF_TRACE_COMPONENTAPIS; i++)
+        OMX_CONF_ReplayPrintRow(g_OMX_CONF_sTraceApiNames[i], &pReplay->oRecorded[i], &pReplay->oReplayed[i]);
+    OMX_CONF_ReplayPrintRow("input buffer residency", &pReplay->oRecordedResidency[0], &pReplay->oReplayedResidency[0]);
+    OMX_CONF_ReplayPrintRow("output buffer residency", &pReplay->oRecordedResidency[1], &pReplay->oReplayedResidency[1]);
+}
+
+OMX_ERRORTYPE OMX_CONF_Replay(OMX_IN OMX_STRING sFilename, OMX_IN OMX_U32 nSpeed)
+{
+    OMX_CONF_REPLAYTYPE *pReplay;
+    OMX_CONF_REPLAYCALLTYPE *pCall;
+    OMX_CONF_REPLAYINSTANCETYPE *pInstance;
+    OMX_ERRORTYPE eError;
+    OMX_U8 *pLog;
+    OMX_U32 nBytes, i;
+    OMX_U64 nFirstNs, nLastNs = 0, nStartNs, nDueNs;
+
+    eError = OMX_OSAL_EventLogLoad(sFilename, &pLog, &nBytes);
+    if (eError != OMX_ErrorNone)
+        return eError;
+    pReplay = (OMX_CONF_REPLAYTYPE *)OMX_OSAL_Malloc(sizeof(OMX_CONF_REPLAYTYPE));
+    if (!pReplay) {
+        OMX_OSAL_Free(pLog);
+        return OMX_ErrorInsufficientResources;
+    }
+    memset(pReplay, 0, sizeof(OMX_CONF_REPLAYTYPE));
+
+    eError = OMX_CONF_ReplayIndex(pReplay, pLog, nBytes);
+    if (eError == OMX_ErrorNone) {
+        OMX_CONF_ReplayAssign(pReplay);
+        if (!pReplay->nInstances) {
+            OMX_OSAL_Trace(OMX_OSAL_TRACE_ERROR, "%s has no components recorded with their arguments\n", sFilename);
+            eError = OMX_ErrorUndefined;
+        }
+    }
+    if (eError == OMX_ErrorNone) {
+        OMX_OSAL_MutexCreate(&pReplay->hMutex);
+        OMX_OSAL_EventCreate(&pReplay->hCallbackEvent);
+        eError = OMX_Init();
+    }
+    if (eError != OMX_ErrorNone)
+        goto OMX_CONF_REPLAY_BAIL;
+
+    nFirstNs = pReplay->pCalls[0].pRecord->nBeginNs;
+    nStartNs = OMX_OSAL_GetTimeNs();
+    for (i = 0; i < pReplay->nCalls; i++) {
+        pCall = &pReplay->pCalls[i];
+        if (pCall->pRecord->nEndNs > nLastNs)
+            nLastNs = pCall->pRecord->nEndNs;
+        if (pCall->nInstance < 0 || OMX_CONF_ReplayIsCallback(pCall->eApi))
+            continue;
+
+        /* make the call once the instance had the callbacks recorded before it, and no earlier than paced */
+        nDueNs = nSpeed ? nStartNs + (pCall->pRecord->nBeginNs - nFirstNs) / nSpeed : 0;
+        pInstance = &pReplay->oInstances[pCall->nInstance];
+        if (!OMX_CONF_ReplayWait(pInstance, pCall->nCallbacksBefore, nDueNs))
+            pReplay->nTimeouts++;
+        if (!OMX_CONF_ReplayCall(pReplay, pCall))
+            pReplay->nSkipped++;
+    }
+
+    /* let instances left open finish what was recorded of them */
+    for (i = 0; i < pReplay->nInstances; i++) {
+        pInstance = &pReplay->oInstances[i];
+        if (pInstance->bClosed)
+            continue;
+        if (pInstance->hComp && !OMX_CONF_ReplayWait(pInstance, pInstance->nRecordedCallbacks, 0))
+            pReplay->nTimeouts++;
+        OMX_CONF_ReplayClose(pInstance);
+    }
+    OMX_CONF_ReplayReport(pReplay, sFilename, nSpeed, nLastNs - nFirstNs, OMX_OSAL_GetTimeNs() - nStartNs);
+
+    for (i = 0; i < OMX_CONF_REPLAY_MAXPORTS; i++) {
+        if (pReplay->nInputPorts & (1 << i))
+            OMX_OSAL_CloseInputFile(i);
+    }
+    OMX_Deinit();
+
+OMX_CONF_REPLAY_BAIL:
+    if (pReplay->hCallbackEvent)
+        OMX_OSAL_EventDestroy(pReplay->hCallbackEvent);
+    if (pReplay->hMutex)
+        OMX_OSAL_MutexDestroy(pReplay->hMutex);
+    if (pReplay->pCalls)
+        OMX_OSAL_Free(pReplay->pCalls);
+    OMX_OSAL_Free(pReplay);
+    OMX_OSAL_Free(pLog);
+    return eError;
+}
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+/* File EOF */
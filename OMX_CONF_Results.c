@@ -0,0 +1,987 @@
+/*
+ * Copyright (c) 2019 The Khronos Group Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/** OMX_CONF_Results.c
+ *  Results files and sharding. While a results file is open every test run
+ *  appends its outcome and duration to it. The durations of earlier runs
+ *  weigh the split of component and test pairs between the shards of a run
+ *  on several machines, and the results files of all shards merge into one
+ *  summary per component. The values of earlier runs are also the baseline
+ *  against which the performance of a test is found to have regressed.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+#include "OMX_OSAL_Interfaces.h"
+#include "OMX_CONF_TestHarness.h"
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+/**********************************************************************
+ * RESULT SETS
+ **********************************************************************/
+
+#define OMX_CONF_RESULTS_MAXNAME 128
+
+typedef struct OMX_CONF_RESULTTYPE {
+    char sComponentName[OMX_CONF_RESULTS_MAXNAME];
+    char sTestName[OMX_CONF_RESULTS_MAXNAME];   /* empty for the profile of a component */
+    OMX_U32 nValue;                             /* error of a test, detected compliance of a profile */
+    OMX_U32 nMs;
+    OMX_U32 nShard;
+    OMX_BOOL bRegressed;
+} OMX_CONF_RESULTTYPE;
+
+typedef struct OMX_CONF_RESULTSETTYPE {
+    OMX_CONF_RESULTTYPE *pResults;
+    OMX_U32 nResults;
+    OMX_U32 nMaxResults;
+} OMX_CONF_RESULTSETTYPE;
+
+static OMX_CONF_RESULTTYPE *OMX_CONF_ResultFind(OMX_CONF_RESULTSETTYPE *pSet,
+                                                const char *sComponentName, const char *sTestName)
+{
+    OMX_U32 i;
+
+    for (i = 0; i < pSet->nResults; i++) {
+        if (!strcmp(pSet->pResults[i].sTestName, sTestName) &&
+            !strcmp(pSet->pResults[i].sComponentName, sComponentName))
+            return &pSet->pResults[i];
+    }
+    return NULL;
+}
+
+/* A later result of the same component and test replaces the earlier one. */
+static OMX_ERRORTYPE OMX_CONF_ResultAdd(OMX_CONF_RESULTSETTYPE *pSet, const char *sComponentName,
+                                        const char *sTestName, OMX_U32 nValue, OMX_U32 nMs)
+{
+    OMX_CONF_RESULTTYPE *pResult, *pResults;
+
+    pResult = OMX_CONF_ResultFind(pSet, sComponentName, sTestName);
+    if (!pResult) {
+        if (pSet->nResults == pSet->nMaxResults) {
+            pResults = (OMX_CONF_RESULTTYPE *)OMX_OSAL_Malloc((pSet->nMaxResults * 2 + 256) * sizeof(OMX_CONF_RESULTTYPE));
+            if (!pResults)
+                return OMX_ErrorInsufficientResources;
+            if (pSet->pResults) {
+                memcpy(pResults, pSet->pResults, pSet->nResults * sizeof(OMX_CONF_RESULTTYPE));
+                OMX_OSAL_Free(pSet->pResults);
+            }
+            pSet->pResults = pResults;
+            pSet->nMaxResults = pSet->nMaxResults * 2 + 256;
+        }
+        pResult = &pSet->pResults[pSet->nResults++];
+        strncpy(pResult->sComponentName, sComponentName, OMX_CONF_RESULTS_MAXNAME - 1);
+        pResult->sComponentName[OMX_CONF_RESULTS_MAXNAME - 1] = '\0';
+        strncpy(pResult->sTestName, sTestName, OMX_CONF_RESULTS_MAXNAME - 1);
+        pResult->sTestName[OMX_CONF_RESULTS_MAXNAME - 1] = '\0';
+    }
+    pResult->nValue = nValue;
+    pResult->nMs = nMs;
+    pResult->nShard = 0;
+    pResult->bRegressed = OMX_FALSE;
+    return OMX_ErrorNone;
+}
+
+static void OMX_CONF_ResultSetClear(OMX_CONF_RESULTSETTYPE *pSet)
+{
+    if (pSet->pResults)
+        OMX_OSAL_Free(pSet->pResults);
+    memset(pSet, 0, sizeof(OMX_CONF_RESULTSETTYPE));
+}
+
+static OMX_U32 OMX_CONF_ResultTestFlags(const char *sTestName)
+{
+    OMX_U32 i;
+
+    for (i = 0; i < g_OMX_CONF_nTestLookupTableEntries; i++) {
+        if (!strcmp(g_OMX_CONF_TestLookupTable[i].pName, sTestName))
+            return g_OMX_CONF_TestLookupTable[i].nFlags ? g_OMX_CONF_TestLookupTable[i].nFlags : OMX_CONF_TestFlag_Base;
+    }
+    return OMX_CONF_TestFlag_Base;
+}
+
+/* Add the records of results file sFilename to pSet. */
+static OMX_ERRORTYPE OMX_CONF_ResultSetLoad(OMX_CONF_RESULTSETTYPE *pSet, OMX_STRING sFilename)
+{
+    FILE *pFile;
+    char sLine[512], sComponentName[OMX_CONF_RESULTS_MAXNAME], sTestName[OMX_CONF_RESULTS_MAXNAME], sOutcome[8];
+    OMX_CONF_RESULTTYPE *pResult;
+    OMX_U32 nValue, nMs, nLine = 0;
+    OMX_ERRORTYPE eError = OMX_ErrorNone;
+
+    pFile = fopen(sFilename, "r");
+    if (!pFile) {
+        OMX_OSAL_Trace(OMX_OSAL_TRACE_ERROR, "Cannot open results file %s\n", sFilename);
+        return OMX_ErrorBadParameter;
+    }
+    while (eError == OMX_ErrorNone && fgets(sLine, sizeof(sLine), pFile)) {
+        nLine++;
+        if (sLine[0] == 'T' &&
+            sscanf(sLine, "T %127s %127s %7s %x %u", sComponentName, sTestName, sOutcome, &nValue, &nMs) == 5) {
+            eError = OMX_CONF_ResultAdd(pSet, sComponentName, sTestName, nValue, nMs);
+        } else if (sLine[0] == 'P' && sscanf(sLine, "P %127s %x", sComponentName, &nValue) == 2) {
+            eError = OMX_CONF_ResultAdd(pSet, sComponentName, "", nValue, 0);
+        } else if (sLine[0] == 'R' && sscanf(sLine, "R %127s %127s", sComponentName, sTestName) == 2) {
+            /* follows the T line of its test */
+            pResult = OMX_CONF_ResultFind(pSet, sComponentName, sTestName);
+            if (pResult)
+                pResult->bRegressed = OMX_TRUE;
+        } else if (sLine[0] == 'M') {
+            /* metrics are not needed to shard or merge */
+        } else if (sLine[0] != '#' && sLine[0] != '\n') {
+            OMX_OSAL_Trace(OMX_OSAL_TRACE_WARNING, "%s:%u: unknown results record ignored\n", sFilename, nLine);
+        }
+    }
+    fclose(pFile);
+    return eError;
+}
+
+/**********************************************************************
+ * METRICS
+ *
+ * The record of the test running: its CPU time, peak memory and the 
+ * metrics it recorded. A test job's record is handed from the child to
+ * the harness as a whole.
+ **********************************************************************/
+
+#define OMX_CONF_METRIC_MAXNAME 64
+#define OMX_CONF_METRIC_MAXUNIT 16
+
+typedef struct OMX_CONF_METRICTYPE {
+    char sName[OMX_CONF_METRIC_MAXNAME];
+    char sUnit[OMX_CONF_METRIC_MAXUNIT];
+    double fValue;
+} OMX_CONF_METRICTYPE;
+
+typedef struct OMX_CONF_TESTRECORDTYPE {
+    OMX_U64 nCpuNs;
+    OMX_U64 nPeakRssKb;         /* of the process that ran the test */
+    OMX_U32 nValid;             /* OMX_OSAL_COUNTERSTYPE bits of the above */
+    OMX_U32 nMetrics;
+    OMX_CONF_METRICTYPE oMetrics[OMX_CONF_MAXMETRICS];
+} OMX_CONF_TESTRECORDTYPE;
+
+OMX_HANDLETYPE g_OMX_CONF_hResultsMutex;
+static OMX_CONF_TESTRECORDTYPE g_OMX_CONF_TestRecord;
+static OMX_OSAL_COUNTERSTYPE g_OMX_CONF_TestBegin;
+
+/* Copy sFrom to sTo as one word, for the results files. */
+static void OMX_CONF_MetricWord(char *sTo, const char *sFrom, OMX_U32 nMax)
+{
+    OMX_U32 i;
+
+    for (i = 0; sFrom && sFrom[i] && i < nMax - 1; i++)
+        sTo[i] = (sFrom[i] == ' ' || sFrom[i] == '\t' || sFrom[i] == '\n') ? '_' : sFrom[i];
+    if (!i)
+        sTo[i++] = '-';
+    sTo[i] = '\0';
+}
+
+void OMX_CONF_RecordMetric(OMX_IN OMX_STRING sName, OMX_IN double fValue, OMX_IN OMX_STRING sUnit)
+{
+    OMX_CONF_METRICTYPE *pMetric = NULL;
+    char sWord[OMX_CONF_METRIC_MAXNAME];
+    OMX_U32 i;
+
+    OMX_CONF_MetricWord(sWord, sName, OMX_CONF_METRIC_MAXNAME);
+    if (g_OMX_CONF_hResultsMutex) OMX_OSAL_MutexLock(g_OMX_CONF_hResultsMutex);
+    for (i = 0; i < g_OMX_CONF_TestRecord.nMetrics && !pMetric; i++) {
+        if (!strcmp(g_OMX_CONF_TestRecord.oMetrics[i].sName, sWord))
+            pMetric = &g_OMX_CONF_TestRecord.oMetrics[i];
+    }
+    if (!pMetric && g_OMX_CONF_TestRecord.nMetrics < OMX_CONF_MAXMETRICS) {
+        pMetric = &g_OMX_CONF_TestRecord.oMetrics[g_OMX_CONF_TestRecord.nMetrics++];
+        strcpy(pMetric->sName, sWord);
+    }
+    if (pMetric) {
+        OMX_CONF_MetricWord(pMetric->sUnit, sUnit, OMX_CONF_METRIC_MAXUNIT);
+        pMetric->fValue = fValue;
+    }
+    if (g_OMX_CONF_hResultsMutex) OMX_OSAL_MutexUnlock(g_OMX_CONF_hResultsMutex);
+}
+
+void OMX_CONF_ResultsTestBegin()
+{
+    if (g_OMX_CONF_hResultsMutex) OMX_OSAL_MutexLock(g_OMX_CONF_hResultsMutex);
+    memset(&g_OMX_CONF_TestRecord, 0, sizeof(g_OMX_CONF_TestRecord));
+    if (g_OMX_CONF_hResultsMutex) OMX_OSAL_MutexUnlock(g_OMX_CONF_hResultsMutex);
+    OMX_OSAL_CountersRead(OMX_FALSE, &g_OMX_CONF_TestBegin);
+    /* a peak that includes the tests before this one is not reported */
+    if (OMX_ErrorNone != OMX_OSAL_CountersResetPeak())
+        g_OMX_CONF_TestBegin.nValid &= ~(1 << OMX_OSAL_CounterPeakRssKb);
+}
+
+void OMX_CONF_ResultsTestEnd()
+{
+    OMX_OSAL_COUNTERSTYPE oEnd;
+    OMX_U32 nValid;
+
+    OMX_OSAL_CountersRead(OMX_FALSE, &oEnd);
+    nValid = g_OMX_CONF_TestBegin.nValid & oEnd.nValid;
+    if (g_OMX_CONF_hResultsMutex) OMX_OSAL_MutexLock(g_OMX_CONF_hResultsMutex);
+    g_OMX_CONF_TestRecord.nValid = nValid & ((1 << OMX_OSAL_CounterCpuNs) | (1 << OMX_OSAL_CounterPeakRssKb));
+    if (nValid & (1 << OMX_OSAL_CounterCpuNs))
+        g_OMX_CONF_TestRecord.nCpuNs = oEnd.nValue[OMX_OSAL_CounterCpuNs] - g_OMX_CONF_TestBegin.nValue[OMX_OSAL_CounterCpuNs];
+    if (nValid & (1 << OMX_OSAL_CounterPeakRssKb))
+        g_OMX_CONF_TestRecord.nPeakRssKb = oEnd.nValue[OMX_OSAL_CounterPeakRssKb];
+    if (g_OMX_CONF_hResultsMutex) OMX_OSAL_MutexUnlock(g_OMX_CONF_hResultsMutex);
+}
+
+void OMX_CONF_ResultsTestExport(OMX_OUT OMX_PTR *ppRecord, OMX_OUT OMX_U32 *pnBytes)
+{
+    *ppRecord = &g_OMX_CONF_TestRecord;
+    *pnBytes = sizeof(g_OMX_CONF_TestRecord);
+}
+
+void OMX_CONF_ResultsTestImport(OMX_IN OMX_PTR pRecord, OMX_IN OMX_U32 nBytes)
+{
+    if (g_OMX_CONF_hResultsMutex) OMX_OSAL_MutexLock(g_OMX_CONF_hResultsMutex);
+    if (pRecord && nBytes == sizeof(g_OMX_CONF_TestRecord))
+        memcpy(&g_OMX_CONF_TestRecord, pRecord, sizeof(g_OMX_CONF_TestRecord));
+    else
+        memset(&g_OMX_CONF_TestRecord, 0, sizeof(g_OMX_CONF_TestRecord));
+    if (g_OMX_CONF_hResultsMutex) OMX_OSAL_MutexUnlock(g_OMX_CONF_hResultsMutex);
+}
+
+/**********************************************************************
+ * BASELINE
+ *
+ * The baseline of a value is the median of its samples in a text results
+ * file of earlier runs, with the median absolute deviation (MAD) as its
+ * noise. A passing test regresses when one of its values is worse than
+ * the median by more than the tolerance and by more than three times the
+ * noise, 1.4826 MAD being the standard deviation of normal samples. Only
+ * values with a unit that tells which way is worse are compared, and only
+ * against at least OMX_CONF_BASELINE_MINSAMPLES samples: with fewer the MAD
+ * says nothing of the noise. Peak RSS is recorded but not compared, as the
+ * histories of earlier runs hold the peak of the whole process.
+ **********************************************************************/
+
+typedef struct OMX_CONF_BASELINETYPE {
+    char sComponentName[OMX_CONF_RESULTS_MAXNAME];
+    char sTestName[OMX_CONF_RESULTS_MAXNAME];
+    char sName[OMX_CONF_METRIC_MAXNAME];
+    double *pSamples;
+    OMX_U32 nSamples;
+    OMX_U32 nMaxSamples;
+    double fMedian;
+    double fMad;
+} OMX_CONF_BASELINETYPE;
+
+typedef struct OMX_CONF_REGRESSIONTYPE {
+    char sName[OMX_CONF_METRIC_MAXNAME];
+    char sUnit[OMX_CONF_METRIC_MAXUNIT];
+    double fValue;
+    double fMedian;
+    double fMad;
+} OMX_CONF_REGRESSIONTYPE;
+
+static OMX_CONF_BASELINETYPE *g_OMX_CONF_pBaselines = NULL;
+static OMX_U32 g_OMX_CONF_nBaselines = 0;
+static OMX_U32 g_OMX_CONF_nMaxBaselines = 0;
+static OMX_BOOL g_OMX_CONF_bBaseline = OMX_FALSE;
+static OMX_U32 g_OMX_CONF_nBaselineTolerance = OMX_CONF_BASELINE_TOLERANCE;
+
+/* the values of the test last compared that regressed, for its results */
+static OMX_CONF_REGRESSIONTYPE g_OMX_CONF_Regressions[OMX_CONF_MAXMETRICS + 3];
+static OMX_U32 g_OMX_CONF_nRegressions = 0;
+/* set if a value of the test last compared had too few samples to compare */
+static OMX_BOOL g_OMX_CONF_bShortHistory = OMX_FALSE;
+
+/* 1 if a larger value in unit sUnit is better, -1 if a smaller one is, 0 if neither */
+static int OMX_CONF_BaselineDirection(const char *sUnit)
+{
+    size_t nLength = strlen(sUnit);
+
+    if (!strcmp(sUnit, "fps") || (nLength > 2 && !strcmp(sUnit + nLength - 2, "/s")))
+        return 1;
+    if (!strcmp(sUnit, "ns") || !strcmp(sUnit, "us") || !strcmp(sUnit, "ms") || !strcmp(sUnit, "s") ||
+        !strcmp(sUnit, "KB") || !strcmp(sUnit, "bytes"))
+        return -1;
+    return 0;
+}
+
+static OMX_CONF_BASELINETYPE *OMX_CONF_BaselineFind(const char *sComponentName, const char *sTestName, const char *sName)
+{
+    OMX_U32 i;
+
+    for (i = 0; i < g_OMX_CONF_nBaselines; i++) {
+        if (!strcmp(g_OMX_CONF_pBaselines[i].sName, sName) &&
+            !strcmp(g_OMX_CONF_pBaselines[i].sTestName, sTestName) &&
+            !strcmp(g_OMX_CONF_pBaselines[i].sComponentName, sComponentName))
+            return &g_OMX_CONF_pBaselines[i];
+    }
+    return NULL;
+}
+
+static OMX_ERRORTYPE OMX_CONF_BaselineAdd(const char *sComponentName, const char *sTestName, const char *sName, double fValue)
+{
+    OMX_CONF_BASELINETYPE *pBaseline, *pBaselines;
+    double *pSamples;
+
+    pBaseline = OMX_CONF_BaselineFind(sComponentName, sTestName, sName);
+    if (!pBaseline) {
+        if (g_OMX_CONF_nBaselines == g_OMX_CONF_nMaxBaselines) {
+            pBaselines = (OMX_CONF_BASELINETYPE *)OMX_OSAL_Malloc((g_OMX_CONF_nMaxBaselines * 2 + 256) * sizeof(OMX_CONF_BASELINETYPE));
+            if (!pBaselines)
+                return OMX_ErrorInsufficientResources;
+            if (g_OMX_CONF_pBaselines) {
+                memcpy(pBaselines, g_OMX_CONF_pBaselines, g_OMX_CONF_nBaselines * sizeof(OMX_CONF_BASELINETYPE));
+                OMX_OSAL_Free(g_OMX_CONF_pBaselines);
+            }
+            g_OMX_CONF_pBaselines = pBaselines;
+            g_OMX_CONF_nMaxBaselines = g_OMX_CONF_nMaxBaselines * 2 + 256;
+        }
+        pBaseline = &g_OMX_CONF_pBaselines[g_OMX_CONF_nBaselines++];
+        memset(pBaseline, 0, sizeof(OMX_CONF_BASELINETYPE));
+        strncpy(pBaseline->sComponentName, sComponentName, OMX_CONF_RESULTS_MAXNAME - 1);
+        strncpy(pBaseline->sTestName, sTestName, OMX_CONF_RESULTS_MAXNAME - 1);
+        strncpy(pBaseline->sName, sName, OMX_CONF_METRIC_MAXNAME - 1);
+    }
+    if (pBaseline->nSamples == pBaseline->nMaxSamples) {
+        pSamples = (double *)OMX_OSAL_Malloc((pBaseline->nMaxSamples * 2 + 8) * sizeof(double));
+        if (!pSamples)
+            return OMX_ErrorInsufficientResources;
+        if (pBaseline->pSamples) {
+            memcpy(pSamples, pBaseline->pSamples, pBaseline->nSamples * sizeof(double));
+            OMX_OSAL_Free(pBaseline->pSamples);
+        }
+        pBaseline->pSamples = pSamples;
+        pBaseline->nMaxSamples = pBaseline->nMaxSamples * 2 + 8;
+    }
+    pBaseline->pSamples[pBaseline->nSamples++] = fValue;
+    return OMX_ErrorNone;
+}
+
+static int OMX_CONF_BaselineSampleCompare(const void *pA, const void *pB)
+{
+    double fA = *(const double *)pA, fB = *(const double *)pB;
+
+    return (fA < fB) ? -1 : (fA > fB) ? 1 : 0;
+}
+
+/* Sort the nSamples of pSamples and return their median. */
+static double OMX_CONF_BaselineMedian(double *pSamples, OMX_U32 nSamples)
+{
+    qsort(pSamples, nSamples, sizeof(double), OMX_CONF_BaselineSampleCompare);
+    return (nSamples & 1) ? pSamples[nSamples / 2] : (pSamples[nSamples / 2 - 1] + pSamples[nSamples / 2]) / 2;
+}
+
+static void OMX_CONF_BaselineClear()
+{
+    OMX_U32 i;
+
+    for (i = 0; i < g_OMX_CONF_nBaselines; i++) {
+        if (g_OMX_CONF_pBaselines[i].pSamples)
+            OMX_OSAL_Free(g_OMX_CONF_pBaselines[i].pSamples);
+    }
+    if (g_OMX_CONF_pBaselines)
+        OMX_OSAL_Free(g_OMX_CONF_pBaselines);
+    g_OMX_CONF_pBaselines = NULL;
+    g_OMX_CONF_nBaselines = g_OMX_CONF_nMaxBaselines = 0;
+    g_OMX_CONF_bBaseline = OMX_FALSE;
+}
+
+OMX_ERRORTYPE OMX_CONF_BaselineSet(OMX_IN OMX_STRING sFilename, OMX_IN OMX_U32 nTolerance)
+{
+    FILE *pFile;
+    char sLine[512], sComponentName[OMX_CONF_RESULTS_MAXNAME], sTestName[OMX_CONF_RESULTS_MAXNAME], sOutcome[8];
+    char sLastComponentName[OMX_CONF_RESULTS_MAXNAME] = "", sLastTestName[OMX_CONF_RESULTS_MAXNAME] = "";
+    char sName[OMX_CONF_METRIC_MAXNAME];
+    OMX_BOOL bLastPassed = OMX_FALSE;
+    OMX_U32 nValue, nWallMs, nCpuMs, nMaxSamples = 0, i, j;
+    double fValue;
+    OMX_CONF_BASELINETYPE *pBaseline;
+    OMX_ERRORTYPE eError = OMX_ErrorNone;
+
+    OMX_CONF_BaselineClear();
+    if (!sFilename)
+        return OMX_ErrorNone;
+
+    pFile = fopen(sFilename, "r");
+    if (!pFile) {
+        OMX_OSAL_Trace(OMX_OSAL_TRACE_ERROR, "Cannot open baseline file %s\n", sFilename);
+        return OMX_ErrorBadParameter;
+    }
+    while (eError == OMX_ErrorNone && fgets(sLine, sizeof(sLine), pFile)) {
+        if (sLine[0] == 'T' &&
+            sscanf(sLine, "T %127s %127s %7s %x %u", sComponentName, sTestName, sOutcome, &nValue, &nWallMs) == 5) {
+            /* the values of failed runs say nothing of the performance of the component */
+            bLastPassed = (OMX_ErrorNone == nValue) ? OMX_TRUE : OMX_FALSE;
+            strcpy(sLastComponentName, sComponentName);
+            strcpy(sLastTestName, sTestName);
+            if (!bLastPassed)
+                continue;
+            eError = OMX_CONF_BaselineAdd(sComponentName, sTestName, "wallMs", nWallMs);
+            if (eError == OMX_ErrorNone && sscanf(sLine, "T %*s %*s %*s %*x %*u %u", &nCpuMs) == 1)
+                eError = OMX_CONF_BaselineAdd(sComponentName, sTestName, "cpuMs", nCpuMs);
+        } else if (sLine[0] == 'M' && 
+                   sscanf(sLine, "M %127s %127s %63s %lf", sComponentName, sTestName, sName, &fValue) == 4) {
+            if (bLastPassed && !strcmp(sComponentName, sLastComponentName) && !strcmp(sTestName, sLastTestName))
+                eError = OMX_CONF_BaselineAdd(sComponentName, sTestName, sName, fValue);
+        }
+    }
+    fclose(pFile);
+    if (eError != OMX_ErrorNone) {
+        OMX_CONF_BaselineClear();
+        return eError;
+    }
+
+    for (i = 0; i < g_OMX_CONF_nBaselines; i++) {
+        pBaseline = &g_OMX_CONF_pBaselines[i];
+        pBaseline->fMedian = OMX_CONF_BaselineMedian(pBaseline->pSamples, pBaseline->nSamples);
+        for (j = 0; j < pBaseline->nSamples; j++) {
+            pBaseline->pSamples[j] -= pBaseline->fMedian;
+            if (pBaseline->pSamples[j] < 0)
+                pBaseline->pSamples[j] = -pBaseline->pSamples[j];
+        }
+        pBaseline->fMad = OMX_CONF_BaselineMedian(pBaseline->pSamples, pBaseline->nSamples);
+        if (pBaseline->nSamples > nMaxSamples)
+            nMaxSamples = pBaseline->nSamples;
+        OMX_OSAL_Free(pBaseline->pSamples);
+        pBaseline->pSamples = NULL;
+    }
+    OMX_OSAL_Trace(OMX_OSAL_TRACE_INFO, "Baseline %s: %u values of up to %u runs, tolerance %u%%\n", sFilename,
+                   g_OMX_CONF_nBaselines, nMaxSamples, nTolerance);
+    g_OMX_CONF_nBaselineTolerance = nTolerance;
+    g_OMX_CONF_bBaseline = OMX_TRUE;
+    return OMX_ErrorNone;
+}
+
+OMX_BOOL OMX_CONF_BaselineActive()
+{
+    return g_OMX_CONF_bBaseline;
+}
+
+/* Compare one value of a test with its baseline; fResolution is the step in 
+   which the value was recorded. */
+static void OMX_CONF_BaselineCheck(const char *sComponentName, const char *sTestName, const char *sName,
+                                   const char *sUnit, double fValue, double fResolution)
+{
+    OMX_CONF_BASELINETYPE *pBaseline;
+    OMX_CONF_REGRESSIONTYPE *pRegression;
+    double fAllowed, fNoise, fWorse;
+    int nDirection = OMX_CONF_BaselineDirection(sUnit);
+
+    if (!nDirection)
+        return;
+    pBaseline = OMX_CONF_BaselineFind(sComponentName, sTestName, sName);
+    if (!pBaseline || pBaseline->nSamples < OMX_CONF_BASELINE_MINSAMPLES) {
+        g_OMX_CONF_bShortHistory = OMX_TRUE;
+        return;
+    }
+    if (g_OMX_CONF_nRegressions == OMX_CONF_MAXMETRICS + 3)
+        return;
+
+    /* samples that all round to the same step have no MAD, but are not exact */
+    fNoise = 1.4826 * pBaseline->fMad;
+    if (fNoise < fResolution)
+        fNoise = fResolution;
+    fAllowed = pBaseline->fMedian * g_OMX_CONF_nBaselineTolerance / 100;
+    if (fAllowed < 0)
+        fAllowed = -fAllowed;
+    if (fAllowed < 3 * fNoise)
+        fAllowed = 3 * fNoise;
+    fWorse = (nDirection > 0) ? pBaseline->fMedian - fValue : fValue - pBaseline->fMedian;
+    if (fWorse <= fAllowed)
+        return;
+
+    pRegression = &g_OMX_CONF_Regressions[g_OMX_CONF_nRegressions++];
+    strcpy(pRegression->sName, sName);
+    OMX_CONF_MetricWord(pRegression->sUnit, sUnit, OMX_CONF_METRIC_MAXUNIT);
+    pRegression->fValue = fValue;
+    pRegression->fMedian = pBaseline->fMedian;
+    pRegression->fMad = pBaseline->fMad;
+    OMX_OSAL_Trace(OMX_OSAL_TRACE_WARNING, "%s on %s: %s of %.4g %s against a baseline of %.4g (MAD %.4g)\n",
+                   sTestName, sComponentName, sName, fValue, sUnit, pBaseline->fMedian, pBaseline->fMad);
+}
+
+OMX_BOOL OMX_CONF_BaselineCompare(OMX_IN OMX_STRING sComponentName, OMX_IN OMX_STRING sTestName,
+                                  OMX_IN OMX_ERRORTYPE eError, OMX_IN OMX_U64 nWallNs, OMX_OUT OMX_BOOL *pbShortHistory)
+{
+    OMX_CONF_TESTRECORDTYPE *pRecord = &g_OMX_CONF_TestRecord;
+    OMX_U32 i;
+
+    g_OMX_CONF_nRegressions = 0;
+    g_OMX_CONF_bShortHistory = OMX_FALSE;
+    *pbShortHistory = OMX_FALSE;
+    if (!g_OMX_CONF_bBaseline || OMX_ErrorNone != eError)
+        return OMX_FALSE;
+
+    if (g_OMX_CONF_hResultsMutex) OMX_OSAL_MutexLock(g_OMX_CONF_hResultsMutex);
+    /* the results files keep times in whole ms */
+    OMX_CONF_BaselineCheck(sComponentName, sTestName, "wallMs", "ms", (double)(nWallNs / 1000000), 1);
+    if (pRecord->nValid & (1 << OMX_OSAL_CounterCpuNs))
+        OMX_CONF_BaselineCheck(sComponentName, sTestName, "cpuMs", "ms", (double)(pRecord->nCpuNs / 1000000), 1);
+    for (i = 0; i < pRecord->nMetrics; i++) {
+        OMX_CONF_BaselineCheck(sComponentName, sTestName, pRecord->oMetrics[i].sName, pRecord->oMetrics[i].sUnit,
+                               pRecord->oMetrics[i].fValue, 0);
+    }
+    *pbShortHistory = g_OMX_CONF_bShortHistory;
+    if (g_OMX_CONF_hResultsMutex) OMX_OSAL_MutexUnlock(g_OMX_CONF_hResultsMutex);
+    return g_OMX_CONF_nRegressions ? OMX_TRUE : OMX_FALSE;
+}
+
+/**********************************************************************
+ * RESULTS FILES
+ *
+ * One of each format may be open at a time. The text format appends,
+ * so that it can collect the history of many runs; JSON and JUnit XML 
+ * files are rewritten and only complete once closed.
+ **********************************************************************/
+
+typedef enum OMX_CONF_RESULTSFORMATTYPE {
+    OMX_CONF_ResultsText,
+    OMX_CONF_ResultsJson,
+    OMX_CONF_ResultsJUnit,
+    OMX_CONF_RESULTSFORMATS
+} OMX_CONF_RESULTSFORMATTYPE;
+
+static FILE *g_OMX_CONF_pResultsFiles[OMX_CONF_RESULTSFORMATS];
+static OMX_U32 g_OMX_CONF_nJsonRecords;
+
+static OMX_CONF_RESULTSFORMATTYPE OMX_CONF_ResultsFormat(OMX_STRING sFilename)
+{
+    size_t nLength = strlen(sFilename);
+
+    if (nLength >= 5 && !strcmp(sFilename + nLength - 5, ".json"))
+        return OMX_CONF_ResultsJson;
+    if (nLength >= 4 && !strcmp(sFilename + nLength - 4, ".xml"))
+        return OMX_CONF_ResultsJUnit;
+    return OMX_CONF_ResultsText;
+}
+
+static void OMX_CONF_ResultsCloseFormat(OMX_CONF_RESULTSFORMATTYPE eFormat)
+{
+    FILE *pFile = g_OMX_CONF_pResultsFiles[eFormat];
+
+    if (!pFile)
+        return;
+    if (eFormat == OMX_CONF_ResultsJson)
+        fprintf(pFile, "\n]\n");
+    else if (eFormat == OMX_CONF_ResultsJUnit)
+        fprintf(pFile, "</testsuite>\n");
+    fclose(pFile);
+    g_OMX_CONF_pResultsFiles[eFormat] = NULL;
+}
+
+/* Write sText as the contents of a JSON string or XML attribute. */
+static void OMX_CONF_ResultsEscaped(FILE *pFile, const char *sText, OMX_BOOL bXml)
+{
+    for (; *sText; sText++) {
+        if (bXml && *sText == '&') fputs("&amp;", pFile);
+        else if (bXml && *sText == '<') fputs("&lt;", pFile);
+        else if (bXml && *sText == '"') fputs("&quot;", pFile);
+        else if (!bXml && (*sText == '"' || *sText == '\\')) fprintf(pFile, "\\%c", *sText);
+        else fputc(*sText, pFile);
+    }
+}
+
+/* JSON has no nan or inf, write those as null */
+static void OMX_CONF_ResultsNumber(FILE *pFile, const char *sName, double fValue)
+{
+    if (fValue - fValue == 0)
+        fprintf(pFile, "\"%s\": %.10g", sName, fValue);
+    else
+        fprintf(pFile, "\"%s\": null", sName);
+}
+
+OMX_ERRORTYPE OMX_CONF_ResultsOpen(OMX_IN OMX_STRING sFilename)
+{
+    OMX_CONF_RESULTSFORMATTYPE eFormat = OMX_CONF_ResultsFormat(sFilename);
+    FILE *pFile;
+
+    OMX_CONF_ResultsCloseFormat(eFormat);
+    pFile = fopen(sFilename, (eFormat == OMX_CONF_ResultsText) ? "a" : "w");
+    if (!pFile) {
+        OMX_OSAL_Trace(OMX_OSAL_TRACE_ERROR, "Cannot open results file %s\n", sFilename);
+        return OMX_ErrorBadParameter;
+    }
+    if (eFormat == OMX_CONF_ResultsJson) {
+        fprintf(pFile, "[");
+        g_OMX_CONF_nJsonRecords = 0;
+    } else if (eFormat == OMX_CONF_ResultsJUnit) {
+        fprintf(pFile, "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n<testsuite name=\"OpenMAX IL conformance\">\n");
+    }
+    g_OMX_CONF_pResultsFiles[eFormat] = pFile;
+    return OMX_ErrorNone;
+}
+
+OMX_ERRORTYPE OMX_CONF_ResultsClose()
+{
+    OMX_U32 i;
+
+    for (i = 0; i < OMX_CONF_RESULTSFORMATS; i++)
+        OMX_CONF_ResultsCloseFormat((OMX_CONF_RESULTSFORMATTYPE)i);
+    return OMX_ErrorNone;
+}
+
+static void OMX_CONF_ResultsWriteText(FILE *pFile, OMX_STRING sComponentName, OMX_STRING sTestName,
+                                      OMX_ERRORTYPE eError, OMX_U64 nWallNs, OMX_CONF_TESTRECORDTYPE *pRecord)
+{
+    OMX_U32 i;
+
+    fprintf(pFile, "T %s %s %s 0x%08x %u %u %llu\n", sComponentName, sTestName,
+            (OMX_ErrorNone == eError) ? "PASSED" : "FAILED", (OMX_U32)eError, (OMX_U32)(nWallNs / 1000000),
+            (OMX_U32)(pRecord->nCpuNs / 1000000), (unsigned long long)pRecord->nPeakRssKb);
+    for (i = 0; i < pRecord->nMetrics; i++) {
+        fprintf(pFile, "M %s %s %s %.10g %s\n", sComponentName, sTestName, pRecord->oMetrics[i].sName,
+                pRecord->oMetrics[i].fValue, pRecord->oMetrics[i].sUnit);
+    }
+    for (i = 0; i < g_OMX_CONF_nRegressions; i++) {
+        fprintf(pFile, "R %s %s %s %.10g %.10g %.10g %s\n", sComponentName, sTestName, g_OMX_CONF_Regressions[i].sName,
+                g_OMX_CONF_Regressions[i].fValue, g_OMX_CONF_Regressions[i].fMedian, g_OMX_CONF_Regressions[i].fMad,
+                g_OMX_CONF_Regressions[i].sUnit);
+    }
+}
+
+static void OMX_CONF_ResultsWriteJson(FILE *pFile, OMX_STRING sComponentName, OMX_STRING sTestName,
+                                      OMX_ERRORTYPE eError, OMX_U64 nWallNs, OMX_CONF_TESTRECORDTYPE *pRecord)
+{
+    char szDesc[256];
+    OMX_U32 i;
+
+    OMX_CONF_ErrorToString(eError, szDesc);
+    fprintf(pFile, "%s\n  {\"component\": \"", g_OMX_CONF_nJsonRecords++ ? "," : "");
+    OMX_CONF_ResultsEscaped(pFile, sComponentName, OMX_FALSE);
+    fprintf(pFile, "\", \"test\": \"");
+    OMX_CONF_ResultsEscaped(pFile, sTestName, OMX_FALSE);
+    fprintf(pFile, "\", \"flags\": \"0x%08x\", \"passed\": %s, \"error\": \"0x%08x\", \"errorName\": \"%s\", \"wallMs\": %.3f",
+            OMX_CONF_ResultTestFlags(sTestName), (OMX_ErrorNone == eError) ? "true" : "false", (OMX_U32)eError, szDesc,
+            nWallNs / 1e6);
+    if (pRecord->nValid & (1 << OMX_OSAL_CounterCpuNs))
+        fprintf(pFile, ", \"cpuMs\": %.3f", pRecord->nCpuNs / 1e6);
+    if (pRecord->nValid & (1 << OMX_OSAL_CounterPeakRssKb))
+        fprintf(pFile, ", \"peakRssKb\": %llu", (unsigned long long)pRecord->nPeakRssKb);
+    fprintf(pFile, ", \"metrics\": [");
+    for (i = 0; i < pRecord->nMetrics; i++) {
+        fprintf(pFile, "%s{\"name\": \"", i ? ", " : "");
+        OMX_CONF_ResultsEscaped(pFile, pRecord->oMetrics[i].sName, OMX_FALSE);
+        fprintf(pFile, "\", ");
+        OMX_CONF_ResultsNumber(pFile, "value", pRecord->oMetrics[i].fValue);
+        fprintf(pFile, ", \"unit\": \"");
+        OMX_CONF_ResultsEscaped(pFile, pRecord->oMetrics[i].sUnit, OMX_FALSE);
+        fprintf(pFile, "\"}");
+    }
+    fprintf(pFile, "]");
+    if (g_OMX_CONF_bBaseline) {
+        fprintf(pFile, ", \"regressed\": %s, \"insufficientHistory\": %s, \"regressions\": [", 
+                g_OMX_CONF_nRegressions ? "true" : "false", g_OMX_CONF_bShortHistory ? "true" : "false");
+        for (i = 0; i < g_OMX_CONF_nRegressions; i++) {
+            fprintf(pFile, "%s{\"name\": \"", i ? ", " : "");
+            OMX_CONF_ResultsEscaped(pFile, g_OMX_CONF_Regressions[i].sName, OMX_FALSE);
+            fprintf(pFile, "\", ");
+            OMX_CONF_ResultsNumber(pFile, "value", g_OMX_CONF_Regressions[i].fValue);
+            fprintf(pFile, ", ");
+            OMX_CONF_ResultsNumber(pFile, "baseline", g_OMX_CONF_Regressions[i].fMedian);
+            fprintf(pFile, ", ");
+            OMX_CONF_ResultsNumber(pFile, "mad", g_OMX_CONF_Regressions[i].fMad);
+            fprintf(pFile, ", \"unit\": \"");
+            OMX_CONF_ResultsEscaped(pFile, g_OMX_CONF_Regressions[i].sUnit, OMX_FALSE);
+            fprintf(pFile, "\"}");
+        }
+        fprintf(pFile, "]");
+    }
+    fprintf(pFile, "}");
+}
+
+static void OMX_CONF_ResultsWriteJUnit(FILE *pFile, OMX_STRING sComponentName, OMX_STRING sTestName,
+                                       OMX_ERRORTYPE eError, OMX_U64 nWallNs, OMX_CONF_TESTRECORDTYPE *pRecord)
+{
+    char szDesc[256];
+    OMX_U32 i;
+
+    fprintf(pFile, "  <testcase classname=\"");
+    OMX_CONF_ResultsEscaped(pFile, sComponentName, OMX_TRUE);
+    fprintf(pFile, "\" name=\"");
+    OMX_CONF_ResultsEscaped(pFile, sTestName, OMX_TRUE);
+    fprintf(pFile, "\" time=\"%.3f\">\n", nWallNs / 1e9);
+    if (OMX_ErrorNone != eError) {
+        OMX_CONF_ErrorToString(eError, szDesc);
+        fprintf(pFile, "    <failure type=\"0x%08x\" message=\"%s\"/>\n", (OMX_U32)eError, szDesc);
+    }
+    fprintf(pFile, "    <properties>\n");
+    fprintf(pFile, "      <property name=\"flags\" value=\"0x%08x\"/>\n", OMX_CONF_ResultTestFlags(sTestName));
+    if (pRecord->nValid & (1 << OMX_OSAL_CounterCpuNs))
+        fprintf(pFile, "      <property name=\"cpuMs\" value=\"%.3f\"/>\n", pRecord->nCpuNs / 1e6);
+    if (pRecord->nValid & (1 << OMX_OSAL_CounterPeakRssKb))
+        fprintf(pFile, "      <property name=\"peakRssKb\" value=\"%llu\"/>\n", (unsigned long long)pRecord->nPeakRssKb);
+    for (i = 0; i < pRecord->nMetrics; i++) {
+        fprintf(pFile, "      <property name=\"");
+        OMX_CONF_ResultsEscaped(pFile, pRecord->oMetrics[i].sName, OMX_TRUE);
+        fprintf(pFile, "\" value=\"%.10g ", pRecord->oMetrics[i].fValue);
+        OMX_CONF_ResultsEscaped(pFile, pRecord->oMetrics[i].sUnit, OMX_TRUE);
+        fprintf(pFile, "\"/>\n");
+    }
+    if (g_OMX_CONF_nRegressions) {
+        /* a regression is not a failure, so that it does not fail the suite */
+        fprintf(pFile, "      <property name=\"regressed\" value=\"");
+        for (i = 0; i < g_OMX_CONF_nRegressions; i++) {
+            fprintf(pFile, "%s", i ? " " : "");
+            OMX_CONF_ResultsEscaped(pFile, g_OMX_CONF_Regressions[i].sName, OMX_TRUE);
+        }
+        fprintf(pFile, "\"/>\n");
+    }
+    if (g_OMX_CONF_bShortHistory)
+        fprintf(pFile, "      <property name=\"insufficientHistory\" value=\"true\"/>\n");
+    fprintf(pFile, "    </properties>\n  </testcase>\n");
+}
+
+void OMX_CONF_ResultsRecordTest(OMX_IN OMX_STRING sComponentName, OMX_IN OMX_STRING sTestName,
+                                OMX_IN OMX_ERRORTYPE eError, OMX_IN OMX_U64 nWallNs)
+{
+    OMX_CONF_TESTRECORDTYPE *pRecord = &g_OMX_CONF_TestRecord;
+    OMX_U32 i;
+
+    if (g_OMX_CONF_hResultsMutex) OMX_OSAL_MutexLock(g_OMX_CONF_hResultsMutex);
+    if (g_OMX_CONF_pResultsFiles[OMX_CONF_ResultsText])
+        OMX_CONF_ResultsWriteText(g_OMX_CONF_pResultsFiles[OMX_CONF_ResultsText], sComponentName, sTestName, eError, nWallNs, pRecord);
+    if (g_OMX_CONF_pResultsFiles[OMX_CONF_ResultsJson])
+        OMX_CONF_ResultsWriteJson(g_OMX_CONF_pResultsFiles[OMX_CONF_ResultsJson], sComponentName, sTestName, eError, nWallNs, pRecord);
+    if (g_OMX_CONF_pResultsFiles[OMX_CONF_ResultsJUnit])
+        OMX_CONF_ResultsWriteJUnit(g_OMX_CONF_pResultsFiles[OMX_CONF_ResultsJUnit], sComponentName, sTestName, eError, nWallNs, pRecord);
+    /* flushed per record so that the files survive a harness that is killed */
+    for (i = 0; i < OMX_CONF_RESULTSFORMATS; i++) {
+        if (g_OMX_CONF_pResultsFiles[i])
+            fflush(g_OMX_CONF_pResultsFiles[i]);
+    }
+    if (g_OMX_CONF_hResultsMutex) OMX_OSAL_MutexUnlock(g_OMX_CONF_hResultsMutex);
+}
+
+void OMX_CONF_ResultsRecordProfile(OMX_IN OMX_STRING sComponentName, OMX_IN OMX_U32 nDetectedCompliance)
+{
+    FILE *pFile = g_OMX_CONF_pResultsFiles[OMX_CONF_ResultsText];
+
+    if (!pFile)
+        return;
+    fprintf(pFile, "P %s 0x%08x\n", sComponentName, nDetectedCompliance);
+    fflush(pFile);
+}
+
+/**********************************************************************
+ * SHARDING
+ *
+ * Pairs with a duration in the history are dealt out longest first,
+ * each to the shard with the least work so far. Pairs without one go
+ * to the shard their name hashes to. Both depend only on the history
+ * file, so every machine given the same file makes the same split.
+ **********************************************************************/
+
+static OMX_CONF_RESULTSETTYPE g_OMX_CONF_ShardHistory;
+static OMX_U32 g_OMX_CONF_nShard = 0;
+static OMX_U32 g_OMX_CONF_nShards = 0;
+
+static int OMX_CONF_ShardCompare(const void *pA, const void *pB)
+{
+    const OMX_CONF_RESULTTYPE *pResultA = *(const OMX_CONF_RESULTTYPE * const *)pA;
+    const OMX_CONF_RESULTTYPE *pResultB = *(const OMX_CONF_RESULTTYPE * const *)pB;
+    int nCompare;
+
+    if (pResultA->nMs != pResultB->nMs)
+        return (pResultA->nMs > pResultB->nMs) ? -1 : 1;
+    nCompare = strcmp(pResultA->sComponentName, pResultB->sComponentName);
+    return nCompare ? nCompare : strcmp(pResultA->sTestName, pResultB->sTestName);
+}
+
+OMX_ERRORTYPE OMX_CONF_ShardSet(OMX_IN OMX_U32 nShard, OMX_IN OMX_U32 nShards, OMX_IN OMX_STRING sHistoryFilename)
+{
+    OMX_CONF_RESULTTYPE **ppSorted;
+    OMX_U64 *pLoads;
+    OMX_U32 i, j, nSorted = 0, nOwned = 0, nLightest;
+    OMX_U64 nTotalMs = 0;
+    OMX_ERRORTYPE eError;
+
+    OMX_CONF_ResultSetClear(&g_OMX_CONF_ShardHistory);
+    g_OMX_CONF_nShard = g_OMX_CONF_nShards = 0;
+    if (nShards <= 1)
+        return OMX_ErrorNone;
+    if (nShard < 1 || nShard > nShards)
+        return OMX_ErrorBadParameter;
+
+    if (sHistoryFilename && sHistoryFilename[0]) {
+        eError = OMX_CONF_ResultSetLoad(&g_OMX_CONF_ShardHistory, sHistoryFilename);
+        if (OMX_ErrorNone != eError)
+            return eError;
+    }
+
+    ppSorted = (OMX_CONF_RESULTTYPE **)OMX_OSAL_Malloc((g_OMX_CONF_ShardHistory.nResults + 1) * sizeof(OMX_CONF_RESULTTYPE *));
+    pLoads = (OMX_U64 *)OMX_OSAL_Malloc(nShards * sizeof(OMX_U64));
+    if (!ppSorted || !pLoads) {
+        if (ppSorted) OMX_OSAL_Free(ppSorted);
+        if (pLoads) OMX_OSAL_Free(pLoads);
+        OMX_CONF_ResultSetClear(&g_OMX_CONF_ShardHistory);
+        return OMX_ErrorInsufficientResources;
+    }
+    for (i = 0; i < g_OMX_CONF_ShardHistory.nResults; i++) {
+        if (g_OMX_CONF_ShardHistory.pResults[i].sTestName[0])
+            ppSorted[nSorted++] = &g_OMX_CONF_ShardHistory.pResults[i];
+    }
+    qsort(ppSorted, nSorted, sizeof(OMX_CONF_RESULTTYPE *), OMX_CONF_ShardCompare);
+    memset(pLoads, 0, nShards * sizeof(OMX_U64));
+    for (i = 0; i < nSorted; i++) {
+        for (nLightest = 0, j = 1; j < nShards; j++) {
+            if (pLoads[j] < pLoads[nLightest])
+                nLightest = j;
+        }
+        /* a pair that took 0 ms still costs the setting up of a test */
+        pLoads[nLightest] += ppSorted[i]->nMs + 1;
+        ppSorted[i]->nShard = nLightest + 1;
+        nTotalMs += ppSorted[i]->nMs + 1;
+        nOwned += (ppSorted[i]->nShard == nShard) ? 1 : 0;
+    }
+    OMX_OSAL_Trace(OMX_OSAL_TRACE_INFO, "Shard %u of %u: %u of %u timed tests, %llu of %llu ms\n", nShard, nShards,
+                   nOwned, nSorted, (unsigned long long)pLoads[nShard - 1], (unsigned long long)nTotalMs);
+    OMX_OSAL_Free(ppSorted);
+    OMX_OSAL_Free(pLoads);
+
+    g_OMX_CONF_nShard = nShard;
+    g_OMX_CONF_nShards = nShards;
+    return OMX_ErrorNone;
+}
+
+OMX_BOOL OMX_CONF_ShardActive()
+{
+    return g_OMX_CONF_nShards ? OMX_TRUE : OMX_FALSE;
+}
+
+OMX_BOOL OMX_CONF_ShardOwns(OMX_IN OMX_STRING sComponentName, OMX_IN OMX_STRING sTestName)
+{
+    OMX_CONF_RESULTTYPE *pResult;
+    char sPair[2 * OMX_CONF_RESULTS_MAXNAME + 2];
+
+    if (!g_OMX_CONF_nShards)
+        return OMX_TRUE;
+    pResult = OMX_CONF_ResultFind(&g_OMX_CONF_ShardHistory, sComponentName, sTestName);
+    if (pResult)
+        return (pResult->nShard == g_OMX_CONF_nShard) ? OMX_TRUE : OMX_FALSE;
+    sprintf(sPair, "%.127s/%.127s", sComponentName, sTestName);
+    return (OMX_CONF_PayloadHash((OMX_U8 *)sPair, (OMX_U32)strlen(sPair)) % g_OMX_CONF_nShards == g_OMX_CONF_nShard - 1) ?
+           OMX_TRUE : OMX_FALSE;
+}
+
+/**********************************************************************
+ * MERGING
+ **********************************************************************/
+
+/* Print the summary of one component in the form OMX_CONF_TestComponent does,
+   and its compliance if a profile was recorded for it. */
+static void OMX_CONF_ResultsSummary(OMX_CONF_RESULTSETTYPE *pSet, const char *sComponentName)
+{
+    OMX_U32 nTestFlags[OMX_CONF_MAXTESTNUMBER];
+    OMX_BOOL bPassed[OMX_CONF_MAXTESTNUMBER], bRegressed[OMX_CONF_MAXTESTNUMBER];
+    OMX_CONF_RESULTTYPE *pResult, *pProfile = NULL;
+    OMX_U32 i, nTests = 0, nPassedTests = 0, nRegressedTests = 0;
+    OMX_U64 nMs = 0;
+    char szDesc[256];
+
+    for (i = 0; i < pSet->nResults; i++) {
+        pResult = &pSet->pResults[i];
+        if (strcmp(pResult->sComponentName, sComponentName))
+            continue;
+        if (!pResult->sTestName[0]) {
+            pProfile = pResult;
+        } else if (nTests < OMX_CONF_MAXTESTNUMBER) {
+            nTestFlags[nTests] = OMX_CONF_ResultTestFlags(pResult->sTestName);
+            bPassed[nTests] = (OMX_ErrorNone == pResult->nValue) ? OMX_TRUE : OMX_FALSE;
+            bRegressed[nTests] = pResult->bRegressed;
+            nPassedTests += bPassed[nTests] ? 1 : 0;
+            nRegressedTests += bRegressed[nTests] ? 1 : 0;
+            nMs += pResult->nMs;
+            nTests++;
+        }
+    }
+
+    OMX_OSAL_Trace(OMX_OSAL_TRACE_PASSFAIL, "\n");
+    OMX_OSAL_Trace(OMX_OSAL_TRACE_PASSFAIL, " \n");
+    OMX_OSAL_Trace(OMX_OSAL_TRACE_PASSFAIL, " Summary for %s (%llu ms of tests)\n", sComponentName, (unsigned long long)nMs);
+    OMX_OSAL_Trace(OMX_OSAL_TRACE_PASSFAIL, " \n");
+    OMX_OSAL_Trace(OMX_OSAL_TRACE_PASSFAIL, " %i tests passed:\n", nPassedTests);
+    for (i = 0; i < pSet->nResults; i++) {
+        pResult = &pSet->pResults[i];
+        if (pResult->sTestName[0] && OMX_ErrorNone == pResult->nValue && !strcmp(pResult->sComponentName, sComponentName))
+            OMX_OSAL_Trace(OMX_OSAL_TRACE_PASSFAIL, " \t%s\n", pResult->sTestName);
+    }
+    OMX_OSAL_Trace(OMX_OSAL_TRACE_PASSFAIL, " \n");
+    OMX_OSAL_Trace(OMX_OSAL_TRACE_PASSFAIL, " %i tests failed: \n", nTests - nPassedTests);
+    for (i = 0; i < pSet->nResults; i++) {
+        pResult = &pSet->pResults[i];
+        if (pResult->sTestName[0] && OMX_ErrorNone != pResult->nValue && !strcmp(pResult->sComponentName, sComponentName)) {
+            OMX_CONF_ErrorToString((OMX_ERRORTYPE)pResult->nValue, szDesc);
+            OMX_OSAL_Trace(OMX_OSAL_TRACE_PASSFAIL, " \t%s, %x %s\n", pResult->sTestName, pResult->nValue, szDesc);
+        }
+    }
+    OMX_OSAL_Trace(OMX_OSAL_TRACE_PASSFAIL, " \n");
+    /* the files do not tell whether a baseline was compared, only what regressed */
+    if (nRegressedTests) {
+        OMX_OSAL_Trace(OMX_OSAL_TRACE_PASSFAIL, " %i tests regressed: \n", nRegressedTests);
+        for (i = 0; i < pSet->nResults; i++) {
+            pResult = &pSet->pResults[i];
+            if (pResult->sTestName[0] && pResult->bRegressed && !strcmp(pResult->sComponentName, sComponentName))
+                OMX_OSAL_Trace(OMX_OSAL_TRACE_PASSFAIL, " \t%s\n", pResult->sTestName);
+        }
+        OMX_OSAL_Trace(OMX_OSAL_TRACE_PASSFAIL, " \n");
+    }
+
+    if (pProfile)
+        OMX_CONF_ReportCompliance(pProfile->nValue, nTests, nTestFlags, bPassed, nRegressedTests ? bRegressed : NULL);
+}
+
+OMX_ERRORTYPE OMX_CONF_ResultsMerge(OMX_IN OMX_STRING *psFilenames, OMX_IN OMX_U32 nFiles)
+{
+    OMX_CONF_RESULTSETTYPE oSet, oFile;
+    OMX_ERRORTYPE eError = OMX_ErrorNone;
+    OMX_U32 i, j;
+    OMX_U64 nMs;
+
+    memset(&oSet, 0, sizeof(oSet));
+    OMX_OSAL_Trace(OMX_OSAL_TRACE_INFO, "\nOMX_CONF_ResultsMerge of %u files\n\n", nFiles);
+    for (i = 0; eError == OMX_ErrorNone && i < nFiles; i++) {
+        memset(&oFile, 0, sizeof(oFile));
+        eError = OMX_CONF_ResultSetLoad(&oFile, psFilenames[i]);
+        for (nMs = 0, j = 0; eError == OMX_ErrorNone && j < oFile.nResults; j++) {
+            nMs += oFile.pResults[j].nMs;
+            eError = OMX_CONF_ResultAdd(&oSet, oFile.pResults[j].sComponentName, oFile.pResults[j].sTestName,
+                                        oFile.pResults[j].nValue, oFile.pResults[j].nMs);
+            if (eError == OMX_ErrorNone)
+                OMX_CONF_ResultFind(&oSet, oFile.pResults[j].sComponentName, oFile.pResults[j].sTestName)->bRegressed =
+                    oFile.pResults[j].bRegressed;
+        }
+        if (eError == OMX_ErrorNone)
+            OMX_OSAL_Trace(OMX_OSAL_TRACE_INFO, "\t%s: %u records, %llu ms of tests\n", psFilenames[i], oFile.nResults,
+                           (unsigned long long)nMs);
+        OMX_CONF_ResultSetClear(&oFile);
+    }
+
+    /* each component once, in the order it first appears */
+    for (i = 0; eError == OMX_ErrorNone && i < oSet.nResults; i++) {
+        for (j = 0; j < i && strcmp(oSet.pResults[j].sComponentName, oSet.pResults[i].sComponentName); j++);
+        if (j == i)
+            OMX_CONF_ResultsSummary(&oSet, oSet.pResults[i].sComponentName);
+    }
+    OMX_CONF_ResultSetClear(&oSet);
+    return eError;
+}
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+/* File EOF */
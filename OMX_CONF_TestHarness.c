@@ -29,6 +29,7 @@ extern "C" {
 #include "OMX_CONF_StubbedCallbacks.h"
 #include "OMX_CONF_TunnelTestComponent.h"
 
+#include <stdio.h>
 #include <string.h>
 #include <stdlib.h>
 
@@ -215,55 +216,501 @@ OMX_ERRORTYPE OMX_CONF_ListComponents()
     return OMX_ErrorNone;
 }
 
-OMX_ERRORTYPE OMX_CONF_TestComponent( OMX_IN OMX_STRING sComponentName, OMX_BOOL *bPassed)
+#define OMX_CONF_MAXREPORTEDWAITSITES 16
+
+/***********************************************************************
+ * COMPONENT TOPOLOGY
+ ***********************************************************************/
+
+#define OMX_CONF_TOPOLOGY_DOMAINS 4
+
+typedef struct OMX_CONF_TOPOLOGYTYPE {
+    OMX_BOOL bValid;
+    char sComponentName[OMX_MAX_STRINGNAME_SIZE];
+    OMX_PORT_PARAM_TYPE oDomains[OMX_CONF_TOPOLOGY_DOMAINS];
+    OMX_ERRORTYPE eDomainErrors[OMX_CONF_TOPOLOGY_DOMAINS];    /* OMX_ErrorUnsupportedIndex for domains the component lacks */
+    OMX_U32 nPorts;
+    OMX_PARAM_PORTDEFINITIONTYPE oPorts[OMX_CONF_TOPOLOGY_MAXPORTS];
+    OMX_BOOL bPortValid[OMX_CONF_TOPOLOGY_MAXPORTS];    /* cleared on OMX_EventPortSettingsChanged */
+    OMX_BOOL bRolesValid;
+    OMX_U32 nRoles;
+    char sRoles[OMX_CONF_TOPOLOGY_MAXROLES][OMX_MAX_STRINGNAME_SIZE];
+    OMX_U32 nHits;      /* queries answered from the snapshot */
+    OMX_U32 nMisses;    /* queries passed to the component */
+} OMX_CONF_TOPOLOGYTYPE;
+
+static OMX_CONF_TOPOLOGYTYPE g_OMX_CONF_Topology;
+OMX_HANDLETYPE g_OMX_CONF_hTopologyMutex;
+
+static const OMX_INDEXTYPE g_OMX_CONF_TopologyDomainIndex[OMX_CONF_TOPOLOGY_DOMAINS] = {
+    OMX_IndexParamAudioInit, OMX_IndexParamVideoInit, OMX_IndexParamImageInit, OMX_IndexParamOtherInit
+};
+
+/* Called with g_OMX_CONF_hTopologyMutex held. */
+static OMX_BOOL OMX_CONF_TopologyCovers(OMX_HANDLETYPE hComp, OMX_BOOL *pbParametersSet)
+{
+    OMX_STRING sComponentName;
+
+    if (!g_OMX_CONF_Topology.bValid ||
+        OMX_ErrorNone != OMX_CONF_ComponentTracerInfo(hComp, &sComponentName, pbParametersSet))
+        return OMX_FALSE;
+    return (0 == strcmp(sComponentName, g_OMX_CONF_Topology.sComponentName)) ? OMX_TRUE : OMX_FALSE;
+}
+
+/* Takes the snapshot from a new instance of the component, which is freed again */
+OMX_ERRORTYPE OMX_CONF_TopologyBuild(OMX_IN OMX_STRING sComponentName)
+{
+    OMX_CONF_TOPOLOGYTYPE *pTopology = &g_OMX_CONF_Topology;
+    OMX_CALLBACKTYPE oCallbacks;
+    OMX_HANDLETYPE hComp = NULL;
+    OMX_U8 *pRoles[OMX_CONF_TOPOLOGY_MAXROLES];
+    OMX_U32 i, j, nRoles;
+    OMX_ERRORTYPE eError;
+
+    OMX_CONF_TopologyInvalidate(NULL, OMX_ALL);
+    pTopology->nPorts = 0;
+    pTopology->bRolesValid = OMX_FALSE;
+
+    oCallbacks.EventHandler    = StubbedEventHandler;
+    oCallbacks.EmptyBufferDone = StubbedEmptyBufferDone;
+    oCallbacks.FillBufferDone  = StubbedFillBufferDone;
+
+    if (OMX_ErrorNone != (eError = OMX_Init())) return eError;
+    if (OMX_ErrorNone != (eError = OMX_GetHandle(&hComp, sComponentName, NULL, &oCallbacks))) goto OMX_CONF_TOPOLOGY_BAIL;
+
+    for (i=0;i<OMX_CONF_TOPOLOGY_DOMAINS;i++)
+    {
+        INIT_PARAM(pTopology->oDomains[i]);
+        eError = OMX_GetParameter(hComp, g_OMX_CONF_TopologyDomainIndex[i], &pTopology->oDomains[i]);
+        pTopology->eDomainErrors[i] = eError;
+        if (OMX_ErrorUnsupportedIndex == eError) {
+            /* a component without ports of this domain, which is answered with the same error */
+            pTopology->oDomains[i].nPorts = 0;
+            eError = OMX_ErrorNone;
+            continue;
+        }
+        if (OMX_ErrorNone != eError)
+            goto OMX_CONF_TOPOLOGY_BAIL;
+        for (j=0;j<pTopology->oDomains[i].nPorts;j++)
+        {
+            if (OMX_CONF_TOPOLOGY_MAXPORTS == pTopology->nPorts) {
+                eError = OMX_ErrorInsufficientResources;
+                goto OMX_CONF_TOPOLOGY_BAIL;
+            }
+            INIT_PARAM(pTopology->oPorts[pTopology->nPorts]);
+            pTopology->oPorts[pTopology->nPorts].nPortIndex = pTopology->oDomains[i].nStartPortNumber + j;
+            if (OMX_ErrorNone != (eError = OMX_GetParameter(hComp, OMX_IndexParamPortDefinition, &pTopology->oPorts[pTopology->nPorts])))
+                goto OMX_CONF_TOPOLOGY_BAIL;
+            pTopology->bPortValid[pTopology->nPorts++] = OMX_TRUE;
+        }
+    }
+
+    /* roles are optional, so failing to get them only leaves them out of the snapshot */
+    nRoles = 0;
+    if (OMX_ErrorNone == OMX_GetRolesOfComponent(sComponentName, &nRoles, NULL) && nRoles <= OMX_CONF_TOPOLOGY_MAXROLES)
+    {
+        for (i=0;i<nRoles;i++)
+            pRoles[i] = (OMX_U8 *)pTopology->sRoles[i];
+        if (OMX_ErrorNone == OMX_GetRolesOfComponent(sComponentName, &nRoles, pRoles)) {
+            pTopology->nRoles = nRoles;
+            pTopology->bRolesValid = OMX_TRUE;
+        }
+    }
+
+OMX_CONF_TOPOLOGY_BAIL:
+    if (hComp) OMX_FreeHandle(hComp);
+    OMX_Deinit();
+
+    if (OMX_ErrorNone != eError) {
+        OMX_OSAL_Trace(OMX_OSAL_TRACE_WARNING, "Could not take the topology of %s, ports are queried by each test\n", sComponentName);
+        return eError;
+    }
+
+    if (g_OMX_CONF_hTopologyMutex) OMX_OSAL_MutexLock(g_OMX_CONF_hTopologyMutex);
+    strncpy(pTopology->sComponentName, sComponentName, OMX_MAX_STRINGNAME_SIZE - 1);
+    pTopology->sComponentName[OMX_MAX_STRINGNAME_SIZE - 1] = 0;
+    pTopology->nHits = 0;
+    pTopology->nMisses = 0;
+    pTopology->bValid = OMX_TRUE;
+    if (g_OMX_CONF_hTopologyMutex) OMX_OSAL_MutexUnlock(g_OMX_CONF_hTopologyMutex);
+
+    OMX_OSAL_Trace(OMX_OSAL_TRACE_INFO, "Topology of %s: %i ports, %i roles\n", sComponentName,
+                   pTopology->nPorts, pTopology->bRolesValid ? pTopology->nRoles : 0);
+    return OMX_ErrorNone;
+}
+
+/* Drops the entry of a port (all ports for OMX_ALL), or the whole snapshot if sComponentName is NULL */
+void OMX_CONF_TopologyInvalidate(OMX_IN OMX_STRING sComponentName, OMX_IN OMX_U32 nPortIndex)
+{
+    OMX_U32 i;
+
+    if (g_OMX_CONF_hTopologyMutex) OMX_OSAL_MutexLock(g_OMX_CONF_hTopologyMutex);
+    if (NULL == sComponentName) {
+        g_OMX_CONF_Topology.bValid = OMX_FALSE;
+    } else if (g_OMX_CONF_Topology.bValid && 0 == strcmp(sComponentName, g_OMX_CONF_Topology.sComponentName)) {
+        for (i=0;i<g_OMX_CONF_Topology.nPorts;i++)
+        {
+            if (OMX_ALL == nPortIndex || g_OMX_CONF_Topology.oPorts[i].nPortIndex == nPortIndex)
+                g_OMX_CONF_Topology.bPortValid[i] = OMX_FALSE;
+        }
+    }
+    if (g_OMX_CONF_hTopologyMutex) OMX_OSAL_MutexUnlock(g_OMX_CONF_hTopologyMutex);
+}
+
+/* Drop-in for OMX_GetParameter of OMX_IndexParam*****Init */
+OMX_ERRORTYPE OMX_CONF_TopologyGetDomain(OMX_IN OMX_HANDLETYPE hComp, OMX_IN OMX_INDEXTYPE eIndexParamDomainInit,
+                                         OMX_INOUT OMX_PORT_PARAM_TYPE *pParam)
+{
+    OMX_U32 i;
+    OMX_BOOL bParametersSet;
+
+    if (g_OMX_CONF_hTopologyMutex) OMX_OSAL_MutexLock(g_OMX_CONF_hTopologyMutex);
+    if (OMX_CONF_TopologyCovers(hComp, &bParametersSet))
+    {
+        for (i=0;i<OMX_CONF_TOPOLOGY_DOMAINS;i++)
+        {
+            if (g_OMX_CONF_TopologyDomainIndex[i] == eIndexParamDomainInit) {
+                if (OMX_ErrorNone == g_OMX_CONF_Topology.eDomainErrors[i]) {
+                    pParam->nPorts = g_OMX_CONF_Topology.oDomains[i].nPorts;
+                    pParam->nStartPortNumber = g_OMX_CONF_Topology.oDomains[i].nStartPortNumber;
+                }
+                g_OMX_CONF_Topology.nHits++;
+                if (g_OMX_CONF_hTopologyMutex) OMX_OSAL_MutexUnlock(g_OMX_CONF_hTopologyMutex);
+                return g_OMX_CONF_Topology.eDomainErrors[i];
+            }
+        }
+    }
+    g_OMX_CONF_Topology.nMisses++;
+    if (g_OMX_CONF_hTopologyMutex) OMX_OSAL_MutexUnlock(g_OMX_CONF_hTopologyMutex);
+
+    return OMX_GetParameter(hComp, eIndexParamDomainInit, pParam);
+}
+
+/* Drop-in for OMX_GetParameter of OMX_IndexParamPortDefinition */
+OMX_ERRORTYPE OMX_CONF_TopologyGetPort(OMX_IN OMX_HANDLETYPE hComp, OMX_INOUT OMX_PARAM_PORTDEFINITIONTYPE *pPortDef)
+{
+    OMX_U32 i;
+    OMX_BOOL bParametersSet;
+
+    if (g_OMX_CONF_hTopologyMutex) OMX_OSAL_MutexLock(g_OMX_CONF_hTopologyMutex);
+    if (OMX_CONF_TopologyCovers(hComp, &bParametersSet) && !bParametersSet)
+    {
+        for (i=0;i<g_OMX_CONF_Topology.nPorts;i++)
+        {
+            if (g_OMX_CONF_Topology.oPorts[i].nPortIndex == pPortDef->nPortIndex && g_OMX_CONF_Topology.bPortValid[i]) {
+                memcpy(pPortDef, &g_OMX_CONF_Topology.oPorts[i], sizeof(OMX_PARAM_PORTDEFINITIONTYPE));
+                g_OMX_CONF_Topology.nHits++;
+                if (g_OMX_CONF_hTopologyMutex) OMX_OSAL_MutexUnlock(g_OMX_CONF_hTopologyMutex);
+                return OMX_ErrorNone;
+            }
+        }
+    }
+    g_OMX_CONF_Topology.nMisses++;
+    if (g_OMX_CONF_hTopologyMutex) OMX_OSAL_MutexUnlock(g_OMX_CONF_hTopologyMutex);
+
+    return OMX_GetParameter(hComp, OMX_IndexParamPortDefinition, pPortDef);
+}
+
+/* Drop-in for OMX_GetRolesOfComponent */
+OMX_ERRORTYPE OMX_CONF_TopologyGetRoles(OMX_IN OMX_STRING sComponentName, OMX_INOUT OMX_U32 *pNumRoles, 
+                                        OMX_OUT OMX_U8 **ppRoles)
 {
     OMX_U32 i;
+
+    if (g_OMX_CONF_hTopologyMutex) OMX_OSAL_MutexLock(g_OMX_CONF_hTopologyMutex);
+    if (g_OMX_CONF_Topology.bValid && g_OMX_CONF_Topology.bRolesValid &&
+        0 == strcmp(sComponentName, g_OMX_CONF_Topology.sComponentName))
+    {
+        if (NULL == ppRoles) {
+            *pNumRoles = g_OMX_CONF_Topology.nRoles;
+        } else {
+            if (*pNumRoles > g_OMX_CONF_Topology.nRoles)
+                *pNumRoles = g_OMX_CONF_Topology.nRoles;
+            for (i=0;i<*pNumRoles;i++)
+                strcpy((OMX_STRING)ppRoles[i], g_OMX_CONF_Topology.sRoles[i]);
+        }
+        g_OMX_CONF_Topology.nHits++;
+        if (g_OMX_CONF_hTopologyMutex) OMX_OSAL_MutexUnlock(g_OMX_CONF_hTopologyMutex);
+        return OMX_ErrorNone;
+    }
+    g_OMX_CONF_Topology.nMisses++;
+    if (g_OMX_CONF_hTopologyMutex) OMX_OSAL_MutexUnlock(g_OMX_CONF_hTopologyMutex);
+
+    return OMX_GetRolesOfComponent(sComponentName, pNumRoles, ppRoles);
+}
+
+/* Report where a test spent its time blocked in OMX_OSAL_EventWait, and 
+   how close the waits came to the timeouts they were allowed. */
+static void OMX_CONF_PrintWaitSites(OMX_STRING sTestName, OMX_U64 nWallNs)
+{
+    OMX_OSAL_WAITSITETYPE oSites[OMX_CONF_MAXREPORTEDWAITSITES];
+    OMX_U32 i, nSites;
+    OMX_U64 nBlockedNs = 0;
+    const char *sFile;
+
+    if (OMX_OSAL_WaitSitesGet(oSites, OMX_CONF_MAXREPORTEDWAITSITES, &nSites, OMX_TRUE) != OMX_ErrorNone || !nSites)
+        return;
+    for (i = 0; i < nSites; i++)
+        nBlockedNs += oSites[i].nBlockedNs;
+    OMX_OSAL_Trace(OMX_OSAL_TRACE_INFO, "Waits of %s: %llu ms blocked in %llu ms\n", sTestName,
+        (unsigned long long)(nBlockedNs / 1000000), (unsigned long long)(nWallNs / 1000000));
+    OMX_OSAL_Trace(OMX_OSAL_TRACE_INFO, "\t%-40s %6s %8s %11s %11s %13s\n", "site", "waits", "timeouts",
+        "blocked ms", "allowed ms", "max signaled");
+    for (i = 0; i < nSites; i++) {
+        for (sFile = oSites[i].sFile + strlen(oSites[i].sFile); sFile > oSites[i].sFile && sFile[-1] != '/' && sFile[-1] != '\\'; sFile--);
+        OMX_OSAL_Trace(OMX_OSAL_TRACE_INFO, "\t%-34s:%-5u %6u %8u %11llu %11llu %10llu ms\n", sFile, oSites[i].nLine,
+            oSites[i].nWaits, oSites[i].nTimedOut, (unsigned long long)(oSites[i].nBlockedNs / 1000000),
+            (unsigned long long)(oSites[i].nAllowedNs / 1000000), (unsigned long long)(oSites[i].nMaxSignaledNs / 1000000));
+    }
+}
+
+/**********************************************************************
+ * TEST JOBS
+ *
+ * With g_OMX_CONF_nTestJobs set each test runs in a child process of 
+ * its own, up to that many at a time, so that a test which hangs is 
+ * killed after g_OMX_CONF_nTestJobTimeout seconds and one which crashes
+ * fails alone. A child returns the OMX_ERRORTYPE of its test and its 
+ * trace output is written when it is collected.
+ **********************************************************************/
+
+#define OMX_CONF_MAXTESTJOBS 32
+
+typedef struct OMX_CONF_TESTJOBTYPE {
+    OMX_STRING sComponentName;
+    OMX_U32 testId;
+    OMX_U32 nIndex;             /* position in g_OMX_CONF_TestIndexList */
+    OMX_HANDLETYPE hProcess;
+    OMX_U64 nBeginNs;
+} OMX_CONF_TESTJOBTYPE;
+
+OMX_U32 g_OMX_CONF_nTestJobs = 0;      /* 0 runs the tests in this process */
+OMX_U32 g_OMX_CONF_nTestJobTimeout = OMX_CONF_TIMEOUT_TEST_JOB;
+
+/* tests of the current list that belong to other shards (see OMX_CONF_ShardSet) */
+static OMX_BOOL g_OMX_CONF_bOtherShard[OMX_CONF_MAXTESTNUMBER];
+/* passing tests of the current list that did worse than the baseline (see OMX_CONF_BaselineSet) */
+static OMX_BOOL g_OMX_CONF_bRegressed[OMX_CONF_MAXTESTNUMBER];
+
+static OMX_ERRORTYPE OMX_CONF_RunTest(OMX_STRING sComponentName, OMX_U32 testId)
+{
     OMX_ERRORTYPE eError;
     char szDesc[256]; 
-    OMX_U32 nPassedTests, nFailedTests;
+    OMX_U64 nBeginNs;
+    OMX_OSAL_COUNTERSTYPE oBegin, oEnd;
+    OMX_U32 nSites;
+
+    /* emit test header */
+    OMX_OSAL_Trace(OMX_OSAL_TRACE_INFO, "\n");
+    OMX_OSAL_Trace(OMX_OSAL_TRACE_INFO, "##\n");
+    OMX_OSAL_Trace(OMX_OSAL_TRACE_INFO, "## %s \n", g_OMX_CONF_TestLookupTable[testId].pName );
+    OMX_OSAL_Trace(OMX_OSAL_TRACE_INFO, "##\n");
+
+    /* perform test */
+    if (g_OMX_OSAL_TraceFlags & OMX_OSAL_TRACE_COUNTERS)
+        OMX_OSAL_CountersRead(OMX_FALSE, &oBegin);
+    OMX_OSAL_WaitSitesGet(NULL, 0, &nSites, OMX_TRUE);
+    OMX_CONF_ResultsTestBegin();
+    OMX_CONF_TimeoutTestBegin();
+    nBeginNs = OMX_OSAL_GetTimeNs();
+    eError = g_OMX_CONF_TestLookupTable[testId].pFunc(sComponentName);
+    OMX_CONF_ResultsTestEnd();
+    if (OMX_OSAL_EventLogActive()) {
+        OMX_OSAL_EventLogCall(OMX_OSAL_EventLogName(sComponentName), OMX_OSAL_EventLogName(g_OMX_CONF_TestLookupTable[testId].pName),
+            OMX_OSAL_EVENTLOG_TEST, nBeginNs, OMX_OSAL_GetTimeNs(), NULL, (OMX_U32)eError);
+    }
+    if (g_OMX_OSAL_TraceFlags & OMX_OSAL_TRACE_COUNTERS) {
+        OMX_OSAL_CountersRead(OMX_FALSE, &oEnd);
+        sprintf(szDesc, "%.100s on %.128s", g_OMX_CONF_TestLookupTable[testId].pName, sComponentName);
+        OMX_CONF_PrintCounters(szDesc, &oBegin, &oEnd, OMX_OSAL_GetTimeNs() - nBeginNs);
+    }
+    if (g_OMX_OSAL_TraceFlags & OMX_OSAL_TRACE_STATISTICS) {
+        sprintf(szDesc, "%.100s on %.128s", g_OMX_CONF_TestLookupTable[testId].pName, sComponentName);
+        OMX_CONF_PrintWaitSites(szDesc, OMX_OSAL_GetTimeNs() - nBeginNs);
+    }
+    return eError;
+}
+
+static OMX_U32 OMX_CONF_RunTestJob(OMX_PTR pParam)
+{
+    OMX_CONF_TESTJOBTYPE *pJob = (OMX_CONF_TESTJOBTYPE *)pParam;
+    OMX_ERRORTYPE eError;
+    OMX_PTR pRecord;
+    OMX_U32 nBytes;
+
+    eError = OMX_CONF_RunTest(pJob->sComponentName, pJob->testId);
+    OMX_CONF_ResultsTestExport(&pRecord, &nBytes);
+    OMX_OSAL_ProcessReply(pRecord, nBytes);
+    return (OMX_U32)eError;
+}
+
+static void OMX_CONF_ReportTest(OMX_STRING sComponentName, OMX_U32 testId, OMX_ERRORTYPE eError, 
+                                OMX_U64 nWallNs, OMX_BOOL *pbPassed, OMX_BOOL *pbRegressed)
+{
+    char szDesc[256]; 
+    OMX_BOOL bShortHistory;
+
+    *pbRegressed = OMX_CONF_BaselineCompare(sComponentName, g_OMX_CONF_TestLookupTable[testId].pName, eError, nWallNs,
+                                            &bShortHistory);
+    OMX_CONF_ResultsRecordTest(sComponentName, g_OMX_CONF_TestLookupTable[testId].pName, eError, nWallNs);
+
+    /* emit test result */
+    if( OMX_ErrorNone != eError ) {
+        OMX_CONF_ErrorToString( eError, szDesc );
+        OMX_OSAL_Trace(OMX_OSAL_TRACE_PASSFAIL, " %s %s FAILED, %x %s\n",
+            g_OMX_CONF_TestLookupTable[testId].pName, sComponentName, eError, szDesc);
+        *pbPassed = OMX_FALSE;
+    } else {
+        OMX_OSAL_Trace(OMX_OSAL_TRACE_PASSFAIL, " %s %s PASSED\n",
+            g_OMX_CONF_TestLookupTable[testId].pName, sComponentName);
+        if (*pbRegressed) {
+            OMX_OSAL_Trace(OMX_OSAL_TRACE_PASSFAIL, " %s %s REGRESSED\n",
+                g_OMX_CONF_TestLookupTable[testId].pName, sComponentName);
+        } else if (bShortHistory) {
+            OMX_OSAL_Trace(OMX_OSAL_TRACE_PASSFAIL, " %s %s insufficient history for the baseline\n",
+                g_OMX_CONF_TestLookupTable[testId].pName, sComponentName);
+        }
+        *pbPassed = OMX_TRUE;
+    }
+}
+
+/* Run the current list of tests in child processes, collecting and reporting
+   each as it finishes. */
+static void OMX_CONF_RunTestJobs(OMX_STRING sComponentName, OMX_BOOL *bPassed)
+{
+    OMX_CONF_TESTJOBTYPE oJobs[OMX_CONF_MAXTESTJOBS];
+    OMX_HANDLETYPE hProcesses[OMX_CONF_MAXTESTJOBS];
+    OMX_CONF_TESTJOBTYPE *pJob;
+    OMX_U32 nJobs = 0, nNext = 0, nMaxJobs, nIndex, i;
+    OMX_U64 nTimeoutNs = (OMX_U64)g_OMX_CONF_nTestJobTimeout * 1000000000;
+    OMX_U64 nNowNs, nDeadlineNs;
+    OMX_U32 uReturn = 0, nRecordBytes;
+    OMX_PTR pRecord;
+    OMX_ERRORTYPE eError;
+
+    nMaxJobs = (g_OMX_CONF_nTestJobs > OMX_CONF_MAXTESTJOBS) ? OMX_CONF_MAXTESTJOBS : g_OMX_CONF_nTestJobs;
+    while (nNext < g_OMX_CONF_nTests || nJobs)
+    {
+        while (nNext < g_OMX_CONF_nTests && nJobs < nMaxJobs)
+        {
+            pJob = &oJobs[nJobs];
+            pJob->sComponentName = sComponentName;
+            pJob->testId = g_OMX_CONF_TestIndexList[nNext];
+            pJob->nIndex = nNext++;
+            if (g_OMX_CONF_bOtherShard[pJob->nIndex])
+                continue;
+            pJob->nBeginNs = OMX_OSAL_GetTimeNs();
+            if (OMX_ErrorNone != OMX_OSAL_ProcessStart(OMX_CONF_RunTestJob, pJob, &pJob->hProcess)) {
+                /* no child processes on this platform, or none left: run it here */
+                eError = OMX_CONF_RunTest(sComponentName, pJob->testId);
+                OMX_CONF_ReportTest(sComponentName, pJob->testId, eError, OMX_OSAL_GetTimeNs() - pJob->nBeginNs, 
+                                    &bPassed[pJob->nIndex], &g_OMX_CONF_bRegressed[pJob->nIndex]);
+                continue;
+            }
+            nJobs++;
+        }
+        if (!nJobs)
+            continue;
+
+        nNowNs = OMX_OSAL_GetTimeNs();
+        nDeadlineNs = oJobs[0].nBeginNs + nTimeoutNs;
+        for (i = 0; i < nJobs; i++) {
+            hProcesses[i] = oJobs[i].hProcess;
+            if (oJobs[i].nBeginNs + nTimeoutNs < nDeadlineNs)
+                nDeadlineNs = oJobs[i].nBeginNs + nTimeoutNs;
+        }
+        if (OMX_ErrorNone != OMX_OSAL_ProcessWait(hProcesses, nJobs, 
+                (nDeadlineNs > nNowNs) ? (OMX_U32)((nDeadlineNs - nNowNs + 999999) / 1000000) : 0, &nIndex)) {
+            /* nothing finished in time, collect the job whose time is up */
+            nNowNs = OMX_OSAL_GetTimeNs();
+            for (nIndex = 0; nIndex < nJobs && oJobs[nIndex].nBeginNs + nTimeoutNs > nNowNs; nIndex++);
+            if (nIndex == nJobs)
+                continue;
+        }
+
+        pJob = &oJobs[nIndex];
+        eError = OMX_OSAL_ProcessDestroy(pJob->hProcess, &uReturn, &pRecord, &nRecordBytes);
+        OMX_CONF_ResultsTestImport(pRecord, nRecordBytes);
+        if (pRecord)
+            OMX_OSAL_Free(pRecord);
+        if (OMX_ErrorTimeout == eError) {
+            OMX_OSAL_Trace(OMX_OSAL_TRACE_ERROR, "%s on %s killed after %u s\n", 
+                g_OMX_CONF_TestLookupTable[pJob->testId].pName, sComponentName, g_OMX_CONF_nTestJobTimeout);
+        } else if (OMX_ErrorNone == eError) {
+            eError = (OMX_ERRORTYPE)uReturn;
+        }
+        /* the children do not write the event log, so the span of each test is recorded here */
+        if (OMX_OSAL_EventLogActive()) {
+            OMX_OSAL_EventLogCall(OMX_OSAL_EventLogName(sComponentName), OMX_OSAL_EventLogName(g_OMX_CONF_TestLookupTable[pJob->testId].pName),
+                OMX_OSAL_EVENTLOG_TEST, pJob->nBeginNs, OMX_OSAL_GetTimeNs(), NULL, (OMX_U32)eError);
+        }
+        OMX_CONF_ReportTest(sComponentName, pJob->testId, eError, OMX_OSAL_GetTimeNs() - pJob->nBeginNs, 
+                            &bPassed[pJob->nIndex], &g_OMX_CONF_bRegressed[pJob->nIndex]);
+        oJobs[nIndex] = oJobs[--nJobs];
+    }
+}
+
+OMX_ERRORTYPE OMX_CONF_TestComponent( OMX_IN OMX_STRING sComponentName, OMX_BOOL *bPassed)
+{
+    OMX_U32 i;
+    OMX_U32 nPassedTests, nFailedTests, nRegressedTests, nOtherShardTests;
     OMX_U32 testId;
+    OMX_U64 nBeginNs;
+    OMX_ERRORTYPE eError;
 
     if (!OMX_CONF_ComponentExists(sComponentName)){
         OMX_OSAL_Trace(OMX_OSAL_TRACE_PASSFAIL, "Cannot find component %s, all tests FAILED\n", sComponentName);
         return OMX_ErrorUndefined;
     }
 
-    /* initialize passed and failed test counters */
-    nPassedTests = 0;
-    nFailedTests = 0;
-
     OMX_OSAL_Trace(OMX_OSAL_TRACE_INFO, "\nOMX_CONF_TestComponent %s\n\n", sComponentName);
 
-    /* Run each test in current list on component */
+    /* tests of other shards count as passed for the compliance of this one, but are not listed */
+    nOtherShardTests = 0;
     for (i=0;i<g_OMX_CONF_nTests;i++)
     {
-        /* get test id */
         testId = g_OMX_CONF_TestIndexList[i];
+        g_OMX_CONF_bOtherShard[i] = OMX_CONF_ShardOwns(sComponentName, g_OMX_CONF_TestLookupTable[testId].pName) ? OMX_FALSE : OMX_TRUE;
+        bPassed[i] = OMX_TRUE;
+        g_OMX_CONF_bRegressed[i] = OMX_FALSE;
+        nOtherShardTests += g_OMX_CONF_bOtherShard[i] ? 1 : 0;
+    }
+    if (nOtherShardTests < g_OMX_CONF_nTests)
+        OMX_CONF_TopologyBuild(sComponentName);
 
-        /* emit test header */
-        OMX_OSAL_Trace(OMX_OSAL_TRACE_INFO, "\n");
-        OMX_OSAL_Trace(OMX_OSAL_TRACE_INFO, "##\n");
-        OMX_OSAL_Trace(OMX_OSAL_TRACE_INFO, "## %s \n", g_OMX_CONF_TestLookupTable[testId].pName );
-        OMX_OSAL_Trace(OMX_OSAL_TRACE_INFO, "##\n");
-
-        /* perform test */
-        eError = g_OMX_CONF_TestLookupTable[testId].pFunc(sComponentName);
-
-        /* emit test result */
-        if( OMX_ErrorNone != eError ) {
-            OMX_CONF_ErrorToString( eError, szDesc );
-            OMX_OSAL_Trace(OMX_OSAL_TRACE_PASSFAIL, " %s %s FAILED, %x %s\n",
-                g_OMX_CONF_TestLookupTable[testId].pName, sComponentName, eError, szDesc);
-            bPassed[i] = OMX_FALSE;
-            nFailedTests++;
-        } else {
-            OMX_OSAL_Trace(OMX_OSAL_TRACE_PASSFAIL, " %s %s PASSED\n",
-                g_OMX_CONF_TestLookupTable[testId].pName, sComponentName);
-            bPassed[i] = OMX_TRUE;
-            nPassedTests++;
+    /* Run each test in current list on component */
+    if (g_OMX_CONF_nTestJobs) {
+        OMX_CONF_RunTestJobs(sComponentName, bPassed);
+    } else {
+        for (i=0;i<g_OMX_CONF_nTests;i++)
+        {
+            if (g_OMX_CONF_bOtherShard[i])
+                continue;
+            testId = g_OMX_CONF_TestIndexList[i];
+            nBeginNs = OMX_OSAL_GetTimeNs();
+            eError = OMX_CONF_RunTest(sComponentName, testId);
+            OMX_CONF_ReportTest(sComponentName, testId, eError, OMX_OSAL_GetTimeNs() - nBeginNs, 
+                                &bPassed[i], &g_OMX_CONF_bRegressed[i]);
         }
     }
 
+    /* count passed and failed tests */
+    nPassedTests = 0;
+    nFailedTests = 0;
+    nRegressedTests = 0;
+    for (i=0;i<g_OMX_CONF_nTests;i++)
+    {
+        if (g_OMX_CONF_bOtherShard[i]) continue;
+        if (bPassed[i]) nPassedTests++;
+        else nFailedTests++;
+        if (g_OMX_CONF_bRegressed[i]) nRegressedTests++;
+    }
+
+    if (g_OMX_CONF_Topology.bValid) {
+        OMX_OSAL_Trace(OMX_OSAL_TRACE_STATISTICS, "Topology of %s: %i queries answered from the snapshot, %i by the component\n",
+                       sComponentName, g_OMX_CONF_Topology.nHits, g_OMX_CONF_Topology.nMisses);
+    }
+    OMX_CONF_TopologyInvalidate(NULL, OMX_ALL);
 
     OMX_OSAL_Trace(OMX_OSAL_TRACE_PASSFAIL, "\n");
     OMX_OSAL_Trace(OMX_OSAL_TRACE_PASSFAIL, " \n");
@@ -280,7 +727,7 @@ OMX_ERRORTYPE OMX_CONF_TestComponent( OMX_IN OMX_STRING sComponentName, OMX_BOOL
     for (i=0;i<g_OMX_CONF_nTests;i++)
     {
         /* if passed emit test name */
-        if (bPassed[i]){
+        if (bPassed[i] && !g_OMX_CONF_bOtherShard[i]){
             testId = g_OMX_CONF_TestIndexList[i];
             OMX_OSAL_Trace(OMX_OSAL_TRACE_PASSFAIL, " \t%s\n", g_OMX_CONF_TestLookupTable[testId].pName);
         }
@@ -299,15 +746,67 @@ OMX_ERRORTYPE OMX_CONF_TestComponent( OMX_IN OMX_STRING sComponentName, OMX_BOOL
     }
     OMX_OSAL_Trace(OMX_OSAL_TRACE_PASSFAIL, " \n");
 
+    /* Report regressed tests */
+    if (OMX_CONF_BaselineActive()) {
+        OMX_OSAL_Trace(OMX_OSAL_TRACE_PASSFAIL, " %i tests regressed: \n", nRegressedTests);
+        for (i=0;i<g_OMX_CONF_nTests;i++)
+        {
+            if (g_OMX_CONF_bRegressed[i]){
+                testId = g_OMX_CONF_TestIndexList[i];
+                OMX_OSAL_Trace(OMX_OSAL_TRACE_PASSFAIL, " \t%s\n", g_OMX_CONF_TestLookupTable[testId].pName);
+            }
+        }
+        OMX_OSAL_Trace(OMX_OSAL_TRACE_PASSFAIL, " \n");
+    }
+    if (nOtherShardTests) {
+        OMX_OSAL_Trace(OMX_OSAL_TRACE_PASSFAIL, " %i tests left to other shards\n", nOtherShardTests);
+        OMX_OSAL_Trace(OMX_OSAL_TRACE_PASSFAIL, " \n");
+    }
+
     return OMX_ErrorNone;
 }
 
+/* Time the commands of nPasses runs of the current list of tests on component, 
+   in this process and without reporting them, and adapt its timeouts to them. */
+OMX_ERRORTYPE OMX_CONF_CalibrateComponent(OMX_IN OMX_STRING sComponentName, OMX_U32 nPasses)
+{
+    OMX_U32 i, nPass;
+    OMX_U32 testId;
+
+    if (!OMX_CONF_ComponentExists(sComponentName)){
+        OMX_OSAL_Trace(OMX_OSAL_TRACE_ERROR, "Cannot find component %s to calibrate\n", sComponentName);
+        return OMX_ErrorUndefined;
+    }
+
+    OMX_OSAL_Trace(OMX_OSAL_TRACE_INFO, "\nOMX_CONF_CalibrateComponent %s\n\n", sComponentName);
+
+    /* time against the default timeouts, not those of an earlier calibration */
+    OMX_CONF_TimeoutCalibrated(sComponentName, OMX_FALSE);
+    OMX_CONF_TopologyBuild(sComponentName);
+    for (nPass=0;nPass<nPasses;nPass++)
+    {
+        for (i=0;i<g_OMX_CONF_nTests;i++)
+        {
+            testId = g_OMX_CONF_TestIndexList[i];
+            if (OMX_CONF_ShardOwns(sComponentName, g_OMX_CONF_TestLookupTable[testId].pName))
+                OMX_CONF_RunTest(sComponentName, testId);
+        }
+    }
+    OMX_CONF_TopologyInvalidate(NULL, OMX_ALL);
+
+    OMX_CONF_TimeoutCalibrated(sComponentName, OMX_TRUE);
+    return OMX_CONF_PrintTimeouts(sComponentName);
+}
+
 OMX_ERRORTYPE OMX_CONF_PrintSettings()
 {
     OMX_U32 i;
 
     OMX_OSAL_Trace(OMX_OSAL_TRACE_INFO, "\nOMX_CONF_PrintSettings\n");
     OMX_OSAL_Trace(OMX_OSAL_TRACE_INFO, "Trace Flags = 0x%08x\n", g_OMX_OSAL_TraceFlags);
+    if (g_OMX_CONF_nTestJobs) {
+        OMX_OSAL_Trace(OMX_OSAL_TRACE_INFO, "Test Jobs = %u, killed after %u s\n", g_OMX_CONF_nTestJobs, g_OMX_CONF_nTestJobTimeout);
+    }
     OMX_OSAL_Trace(OMX_OSAL_TRACE_INFO, "Active Tests:\n");
     for (i=0;i<g_OMX_CONF_nTests;i++){
         OMX_OSAL_Trace(OMX_OSAL_TRACE_INFO, "\t%s\n", 
@@ -323,6 +822,7 @@ OMX_ERRORTYPE OMX_CONF_PrintSettings()
         OMX_OSAL_Trace(OMX_OSAL_TRACE_INFO, "\t%i:%s\n", 
             g_OMX_CONF_OutFileMap[i].nPortIndex, g_OMX_CONF_OutFileMap[i].sOutputFileName);
     }
+    OMX_CONF_PrintTimeouts(NULL);
     OMX_OSAL_Trace(OMX_OSAL_TRACE_INFO, "\n");
 
     return OMX_ErrorNone;
@@ -344,6 +844,10 @@ void OMX_CONF_PrintStUsage()
     OMX_OSAL_Trace(OMX_OSAL_TRACE_INFO, "\t\t0x0008 = Info.\n");
     OMX_OSAL_Trace(OMX_OSAL_TRACE_INFO, "\t\t0x0010 = Error.\n");
     OMX_OSAL_Trace(OMX_OSAL_TRACE_INFO, "\t\t0x0020 = Buffer.\n");
+    OMX_OSAL_Trace(OMX_OSAL_TRACE_INFO, "\t\t0x0040 = Warning.\n");
+    OMX_OSAL_Trace(OMX_OSAL_TRACE_INFO, "\t\t0x0080 = Statistics (call latency and buffer traffic).\n");
+    OMX_OSAL_Trace(OMX_OSAL_TRACE_INFO, "\t\t0x0100 = Validate (buffer header checks on every buffer handed over).\n");
+    OMX_OSAL_Trace(OMX_OSAL_TRACE_INFO, "\t\t0x0200 = Counters (performance counters per test and per traced call).\n");
 }
 
 void OMX_CONF_PrintOlUsage()
@@ -366,6 +870,57 @@ void OMX_CONF_PrintTcUsage()
     OMX_OSAL_Trace(OMX_OSAL_TRACE_INFO, "\ttc <testname>: test given component.\n");
 }
 
+void OMX_CONF_PrintPjUsage()
+{
+    OMX_OSAL_Trace(OMX_OSAL_TRACE_INFO, "\tpj <jobs> [timeout]: run up to <jobs> tests at a time, each in its own process and killed\n");
+    OMX_OSAL_Trace(OMX_OSAL_TRACE_INFO, "\t\tafter [timeout] seconds (default %u). 0 jobs runs the tests in this process.\n", OMX_CONF_TIMEOUT_TEST_JOB);
+}
+
+void OMX_CONF_PrintRfUsage()
+{
+    OMX_OSAL_Trace(OMX_OSAL_TRACE_INFO, "\trf <resultsfilename>: write the outcome, times and metrics of the tests run from now on to given\n");
+    OMX_OSAL_Trace(OMX_OSAL_TRACE_INFO, "\t\tfile, as a JSON array if it ends in .json, JUnit XML if in .xml, else appended as text.\n");
+}
+
+void OMX_CONF_PrintShUsage()
+{
+    OMX_OSAL_Trace(OMX_OSAL_TRACE_INFO, "\tsh <shard>/<shards> [resultsfilename]: run only shard <shard> (1 to <shards>) of the tests of\n");
+    OMX_OSAL_Trace(OMX_OSAL_TRACE_INFO, "\t\tfollowing tc and cc commands, split by the durations in given results file.\n");
+    OMX_OSAL_Trace(OMX_OSAL_TRACE_INFO, "\t\t1/1 runs all tests.\n");
+}
+
+void OMX_CONF_PrintCbUsage()
+{
+    OMX_OSAL_Trace(OMX_OSAL_TRACE_INFO, "\tcb <resultsfilename> [tolerance]: compare the tests run from now on with the median\n");
+    OMX_OSAL_Trace(OMX_OSAL_TRACE_INFO, "\t\tof the passing runs in given text results file, and report a passing test as REGRESSED\n");
+    OMX_OSAL_Trace(OMX_OSAL_TRACE_INFO, "\t\twhen worse by more than tolerance percent (default %u) and three times the noise.\n",
+                   OMX_CONF_BASELINE_TOLERANCE);
+    OMX_OSAL_Trace(OMX_OSAL_TRACE_INFO, "\t\tValues with fewer than %u passing runs are reported as insufficient history.\n",
+                   OMX_CONF_BASELINE_MINSAMPLES);
+    OMX_OSAL_Trace(OMX_OSAL_TRACE_INFO, "\t\t'cb -' stops comparing.\n");
+}
+
+void OMX_CONF_PrintCaUsage()
+{
+    OMX_OSAL_Trace(OMX_OSAL_TRACE_INFO, "\tca <component-name> [passes]: run the active tests [passes] times (default %u) in this\n",
+                   OMX_CONF_CALIBRATION_PASSES);
+    OMX_OSAL_Trace(OMX_OSAL_TRACE_INFO, "\t\tprocess without reporting them, and shorten the waits of later tests of component\n");
+    OMX_OSAL_Trace(OMX_OSAL_TRACE_INFO, "\t\tto a few times the longest its commands took.\n");
+}
+
+void OMX_CONF_PrintToUsage()
+{
+    OMX_OSAL_Trace(OMX_OSAL_TRACE_INFO, "\tto <timeout> <ms>: set the timeout of waits for success, failure, resources or traffic,\n");
+    OMX_OSAL_Trace(OMX_OSAL_TRACE_INFO, "\t\tor on commands of type state, disable, enable or flush, to <ms>. 0 restores it.\n");
+    OMX_OSAL_Trace(OMX_OSAL_TRACE_INFO, "\t\t'to adaptive 0' stops adapting timeouts to calibrated components.\n");
+}
+
+void OMX_CONF_PrintMrUsage()
+{
+    OMX_OSAL_Trace(OMX_OSAL_TRACE_INFO, "\tmr <resultsfilename> [resultsfilename ...]: merge results files and print the summary\n");
+    OMX_OSAL_Trace(OMX_OSAL_TRACE_INFO, "\t\tand compliance of each component.\n");
+}
+
 void OMX_CONF_PrintMiUsage()
 {
     OMX_OSAL_Trace(OMX_OSAL_TRACE_INFO, "\tmi <inputfilename> <portindex> : map input file to port.\n");
@@ -376,6 +931,49 @@ void OMX_CONF_PrintMoUsage()
     OMX_OSAL_Trace(OMX_OSAL_TRACE_INFO, "\tmo <outputfilename> <portindex> : map output file to port.\n");
 }
 
+void OMX_CONF_PrintFiUsage()
+{
+    OMX_OSAL_Trace(OMX_OSAL_TRACE_INFO, "\tfi <depth> [chunkbytes]: read input files ahead and write output files behind in up to\n");
+    OMX_OSAL_Trace(OMX_OSAL_TRACE_INFO, "\t\t<depth> chunks of [chunkbytes] each. 0 does file I/O in the test thread. Applies to files\n");
+    OMX_OSAL_Trace(OMX_OSAL_TRACE_INFO, "\t\topened from now on.\n");
+}
+
+void OMX_CONF_PrintIxUsage()
+{
+    OMX_OSAL_Trace(OMX_OSAL_TRACE_INFO, "\tix <inputfilename> : convert <inputfilename>.length to the binary <inputfilename>.index.\n");
+}
+
+void OMX_CONF_PrintOeUsage()
+{
+    OMX_OSAL_Trace(OMX_OSAL_TRACE_INFO, "\toe <eventlogfilename>: open given binary event log of timed component calls and callbacks.\n");
+}
+
+void OMX_CONF_PrintOrUsage()
+{
+    OMX_OSAL_Trace(OMX_OSAL_TRACE_INFO, "\tor <eventlogfilename>: open given event log and record call arguments and buffer payload hashes for replay.\n");
+}
+
+void OMX_CONF_PrintRpUsage()
+{
+    OMX_OSAL_Trace(OMX_OSAL_TRACE_INFO, "\trp <eventlogfilename> [speed]: replay the recorded calls speed times as fast as recorded (default 1, 0 unpaced).\n");
+}
+
+void OMX_CONF_PrintEjUsage()
+{
+    OMX_OSAL_Trace(OMX_OSAL_TRACE_INFO, "\tej <eventlogfilename> <jsonfilename>: convert event log to Chrome trace event JSON.\n");
+}
+
+void OMX_CONF_PrintBpUsage()
+{
+    OMX_OSAL_Trace(OMX_OSAL_TRACE_INFO, "\tbp <hugepages> [contiguousbytes]: back the buffer pools with hugepages (1) or not (0),\n");
+    OMX_OSAL_Trace(OMX_OSAL_TRACE_INFO, "\t\tand size the region contiguous buffers are carved from.\n");
+}
+
+void OMX_CONF_PrintTbUsage()
+{
+    OMX_OSAL_Trace(OMX_OSAL_TRACE_INFO, "\ttb [calls]: measure the tracer overhead on EmptyThisBuffer of a stubbed component.\n");
+}
+
 void OMX_CONF_PrintHelp()
 {
     OMX_OSAL_Trace(OMX_OSAL_TRACE_INFO, "\nOMX_CONF_PrintHelp()\n");
@@ -384,14 +982,32 @@ void OMX_CONF_PrintHelp()
     OMX_CONF_PrintStUsage();
     OMX_CONF_PrintOlUsage();
     OMX_OSAL_Trace(OMX_OSAL_TRACE_INFO, "\tcl : close log file.\n");
+    OMX_CONF_PrintOeUsage();
+    OMX_CONF_PrintOrUsage();
+    OMX_OSAL_Trace(OMX_OSAL_TRACE_INFO, "\tce : close event log.\n");
+    OMX_CONF_PrintEjUsage();
+    OMX_CONF_PrintRpUsage();
     OMX_CONF_PrintAtUsage();
     OMX_CONF_PrintRtUsage();
     OMX_OSAL_Trace(OMX_OSAL_TRACE_INFO, "\tlt : list all available tests\n");
     OMX_OSAL_Trace(OMX_OSAL_TRACE_INFO, "\tlc : list all available components\n");
     OMX_CONF_PrintTcUsage();
+    OMX_CONF_PrintPjUsage();
+    OMX_CONF_PrintRfUsage();
+    OMX_OSAL_Trace(OMX_OSAL_TRACE_INFO, "\tcr : close results files.\n");
+    OMX_CONF_PrintShUsage();
+    OMX_CONF_PrintCbUsage();
+    OMX_CONF_PrintCaUsage();
+    OMX_CONF_PrintToUsage();
+    OMX_CONF_PrintMrUsage();
     OMX_CONF_PrintMiUsage();
     OMX_CONF_PrintMoUsage();
+    OMX_CONF_PrintFiUsage();
+    OMX_CONF_PrintIxUsage();
     OMX_OSAL_Trace(OMX_OSAL_TRACE_INFO, "\tps: print settings.\n");
+    OMX_OSAL_Trace(OMX_OSAL_TRACE_INFO, "\tpl: print latency percentiles of the component calls traced so far.\n");
+    OMX_CONF_PrintBpUsage();
+    OMX_CONF_PrintTbUsage();
     OMX_OSAL_Trace(OMX_OSAL_TRACE_INFO, "\th: help.\n");
     OMX_OSAL_Trace(OMX_OSAL_TRACE_INFO, "\tq: quit.\n\n");
 }
@@ -522,94 +1138,121 @@ static const char * OMX_CONF_ConformanceResult(OMX_U32 flags, OMX_U32 detectedCo
         return "PASSED";
 }
 
-OMX_ERRORTYPE OMX_CONF_ConformancetestComponent(OMX_STRING sArgument, OMX_BOOL *bPassed)
+void OMX_CONF_ReportCompliance(OMX_IN OMX_U32 nDetectedCompliance, OMX_IN OMX_U32 nTests, 
+                               OMX_IN OMX_U32 *pTestFlags, OMX_IN OMX_BOOL *pbPassed,
+                               OMX_IN OMX_BOOL *pbRegressed)
 {
-    OMX_U32 i, nTestFlags[OMX_CONF_MAXTESTNUMBER], nTests;
-    OMX_U32 detectedCompliance, actualCompliance;
+    OMX_U32 i, actualCompliance, nRegressedTests;
 
-    if (!OMX_CONF_ComponentExists(sArgument)){
-        OMX_OSAL_Trace(OMX_OSAL_TRACE_PASSFAIL, "Cannot find component %s, all tests FAILED\n", sArgument);
-        return OMX_ErrorUndefined;
-    }
-
-    detectedCompliance = DetectComplianceProfile(sArgument);
-
-    /* remove tests */
-    OMX_CONF_RemoveTest("*");
-
-    /* only add tests in that compliance profile */
-    nTests = 0;
-    for(i=0;i<g_OMX_CONF_nTestLookupTableEntries;i++)
-    {
-        OMX_U32 nFlag = g_OMX_CONF_TestLookupTable[i].nFlags;
-        if (nFlag == 0)
-            nFlag = OMX_CONF_TestFlag_Base;
-        if ((nFlag & detectedCompliance)==nFlag)
-        {         
-            nTestFlags[nTests++] = nFlag;
-            OMX_CONF_AddTest(g_OMX_CONF_TestLookupTable[i].pName);
-        }
-    }
-        
-    /* run the tests */
-    OMX_CONF_SetTraceflags(OMX_OSAL_TRACE_PASSFAIL|OMX_OSAL_TRACE_WARNING|OMX_OSAL_TRACE_INFO);
-    OMX_CONF_TestComponent(sArgument, bPassed);
-    
     /* determine actual compliance */
-    actualCompliance = detectedCompliance;  /* assume best case */
+    actualCompliance = nDetectedCompliance;  /* assume best case */
     for(i=0;i<nTests;i++)
     {
         /* if the test failed invalidate appropriate profiles */
-        if (OMX_FALSE == bPassed[i]){
-            if (0==(OMX_CONF_TestFlag_Interop & nTestFlags[i])){
+        if (OMX_FALSE == pbPassed[i]){
+            if (0==(OMX_CONF_TestFlag_Interop & pTestFlags[i])){
                 /* not an interop test */
-                if (OMX_CONF_TestFlag_Metabolism & nTestFlags[i]){
+                if (OMX_CONF_TestFlag_Metabolism & pTestFlags[i]){
                     /* failed data metabolism */
                     actualCompliance &= ~OMX_CONF_TestFlag_Metabolism;                             
                 }
-                else if (OMX_CONF_TestFlag_StdComponent & nTestFlags[i]){
+                else if (OMX_CONF_TestFlag_StdComponent & pTestFlags[i]){
                     /* failed standard component */
                     actualCompliance &= ~OMX_CONF_TestFlag_StdComponent;                             
                 }
-                else if (OMX_CONF_TestFlag_Threaded & nTestFlags[i]){
+                else if (OMX_CONF_TestFlag_Threaded & pTestFlags[i]){
                     /* failed a threaded test - fail threaded compliance */
                     actualCompliance &= ~OMX_CONF_TestFlag_Threaded;                             
                 } else {
                     /* failed a non-thread test - fail base comformance */
                     actualCompliance &=  ~OMX_CONF_TestFlag_Base;
                 }
-            } else if ( OMX_CONF_TestFlag_Interop == nTestFlags[i]
-                        || (OMX_CONF_TestFlag_Interop|OMX_CONF_TestFlag_AutoOutput) == nTestFlags[i] ) {
+            } else if ( OMX_CONF_TestFlag_Interop == pTestFlags[i]
+                        || (OMX_CONF_TestFlag_Interop|OMX_CONF_TestFlag_AutoOutput) == pTestFlags[i] ) {
                 /* failed a interop test without clock/threaded/seeking - fail interop */
                 actualCompliance &= ~OMX_CONF_TestFlag_Interop;     
             } else {
                 /* failed something above and beyond interop - fail that flag */
-                actualCompliance &= ~(~OMX_CONF_TestFlag_Interop & nTestFlags[i]);
+                actualCompliance &= ~(~OMX_CONF_TestFlag_Interop & pTestFlags[i]);
             }
         }
     }
 
     /* report on actual compliance */
     OMX_OSAL_Trace(OMX_OSAL_TRACE_PASSFAIL, " Base Profile:                   %s\n", 
-        OMX_CONF_ConformanceResult(OMX_CONF_TestFlag_Base, detectedCompliance, actualCompliance));
+        OMX_CONF_ConformanceResult(OMX_CONF_TestFlag_Base, nDetectedCompliance, actualCompliance));
 
     OMX_OSAL_Trace(OMX_OSAL_TRACE_PASSFAIL, " Base Profile with threading:    %s\n", 
-        OMX_CONF_ConformanceResult(OMX_CONF_TestFlag_Base|OMX_CONF_TestFlag_Threaded, detectedCompliance, actualCompliance));
+        OMX_CONF_ConformanceResult(OMX_CONF_TestFlag_Base|OMX_CONF_TestFlag_Threaded, nDetectedCompliance, actualCompliance));
 
     OMX_OSAL_Trace(OMX_OSAL_TRACE_PASSFAIL, " Interop Profile:                %s\n", 
-        OMX_CONF_ConformanceResult(OMX_CONF_TestFlag_Interop, detectedCompliance, actualCompliance));
+        OMX_CONF_ConformanceResult(OMX_CONF_TestFlag_Interop, nDetectedCompliance, actualCompliance));
 
     OMX_OSAL_Trace(OMX_OSAL_TRACE_PASSFAIL, " Interop Profile with threading: %s\n", 
-         OMX_CONF_ConformanceResult(OMX_CONF_TestFlag_Interop|OMX_CONF_TestFlag_Threaded, detectedCompliance, actualCompliance));
+         OMX_CONF_ConformanceResult(OMX_CONF_TestFlag_Interop|OMX_CONF_TestFlag_Threaded, nDetectedCompliance, actualCompliance));
     OMX_OSAL_Trace(OMX_OSAL_TRACE_PASSFAIL, " Clock Component:                %s\n", 
-         OMX_CONF_ConformanceResult(OMX_CONF_TestFlag_Interop|OMX_CONF_TestFlag_ClockComp, detectedCompliance, actualCompliance));
+         OMX_CONF_ConformanceResult(OMX_CONF_TestFlag_Interop|OMX_CONF_TestFlag_ClockComp, nDetectedCompliance, actualCompliance));
     OMX_OSAL_Trace(OMX_OSAL_TRACE_PASSFAIL, " Seeking Component:              %s\n", 
-         OMX_CONF_ConformanceResult(OMX_CONF_TestFlag_Interop|OMX_CONF_TestFlag_Seeking, detectedCompliance, actualCompliance));
+         OMX_CONF_ConformanceResult(OMX_CONF_TestFlag_Interop|OMX_CONF_TestFlag_Seeking, nDetectedCompliance, actualCompliance));
 
     OMX_OSAL_Trace(OMX_OSAL_TRACE_PASSFAIL, " Standard Component Role:        %s\n", 
-         OMX_CONF_ConformanceResult(OMX_CONF_TestFlag_StdComponent, detectedCompliance, actualCompliance));
+         OMX_CONF_ConformanceResult(OMX_CONF_TestFlag_StdComponent, nDetectedCompliance, actualCompliance));
     OMX_OSAL_Trace(OMX_OSAL_TRACE_PASSFAIL, " Data Metabolism:                %s\n", 
-         OMX_CONF_ConformanceResult(OMX_CONF_TestFlag_StdComponent|OMX_CONF_TestFlag_Metabolism, detectedCompliance, actualCompliance));
+         OMX_CONF_ConformanceResult(OMX_CONF_TestFlag_StdComponent|OMX_CONF_TestFlag_Metabolism, nDetectedCompliance, actualCompliance));
+
+    /* performance is reported beside the profiles; a regression fails none of them */
+    if (pbRegressed) {
+        for (nRegressedTests=0,i=0;i<nTests;i++)
+            nRegressedTests += pbRegressed[i] ? 1 : 0;
+        if (nRegressedTests) {
+            OMX_OSAL_Trace(OMX_OSAL_TRACE_PASSFAIL, " Performance against Baseline:   REGRESSED in %i tests\n", nRegressedTests);
+        } else {
+            OMX_OSAL_Trace(OMX_OSAL_TRACE_PASSFAIL, " Performance against Baseline:   PASSED\n");
+        }
+    }
+}
+
+OMX_ERRORTYPE OMX_CONF_ConformancetestComponent(OMX_STRING sArgument, OMX_BOOL *bPassed)
+{
+    OMX_U32 i, nTestFlags[OMX_CONF_MAXTESTNUMBER], nTests;
+    OMX_U32 detectedCompliance;
+
+    if (!OMX_CONF_ComponentExists(sArgument)){
+        OMX_OSAL_Trace(OMX_OSAL_TRACE_PASSFAIL, "Cannot find component %s, all tests FAILED\n", sArgument);
+        return OMX_ErrorUndefined;
+    }
+
+    detectedCompliance = DetectComplianceProfile(sArgument);
+
+    /* remove tests */
+    OMX_CONF_RemoveTest("*");
+
+    /* only add tests in that compliance profile */
+    nTests = 0;
+    for(i=0;i<g_OMX_CONF_nTestLookupTableEntries;i++)
+    {
+        OMX_U32 nFlag = g_OMX_CONF_TestLookupTable[i].nFlags;
+        if (nFlag == 0)
+            nFlag = OMX_CONF_TestFlag_Base;
+        if ((nFlag & detectedCompliance)==nFlag)
+        {         
+            nTestFlags[nTests++] = nFlag;
+            OMX_CONF_AddTest(g_OMX_CONF_TestLookupTable[i].pName);
+        }
+    }
+        
+    /* run the tests */
+    OMX_CONF_SetTraceflags(OMX_OSAL_TRACE_PASSFAIL|OMX_OSAL_TRACE_WARNING|OMX_OSAL_TRACE_INFO|OMX_OSAL_TRACE_STATISTICS);
+    OMX_CONF_TestComponent(sArgument, bPassed);
+    
+    /* report on actual compliance */
+    OMX_CONF_ResultsRecordProfile(sArgument, detectedCompliance);
+    if (OMX_CONF_ShardActive()) {
+        OMX_OSAL_Trace(OMX_OSAL_TRACE_PASSFAIL, " Compliance: merge the results files of all shards\n");
+    } else {
+        OMX_CONF_ReportCompliance(detectedCompliance, nTests, nTestFlags, bPassed, 
+                                  OMX_CONF_BaselineActive() ? g_OMX_CONF_bRegressed : NULL);
+    }
 
     /* remove tests */
     OMX_CONF_RemoveTest("*");
@@ -617,12 +1260,16 @@ OMX_ERRORTYPE OMX_CONF_ConformancetestComponent(OMX_STRING sArgument, OMX_BOOL *
     return OMX_ErrorNone;
 }
 
+#define OMX_CONF_MAXMERGEDFILES 64
+
 OMX_ERRORTYPE OMX_CONF_ParseCommand( OMX_IN OMX_STRING sCommandAndArgs )
 {
     char sLocalCopy[512];
     char sCommand[5], *sArgument, *sArgument2;
     char *pC;
     OMX_BOOL *bPassed = g_bPassed;
+    OMX_STRING psFiles[OMX_CONF_MAXMERGEDFILES];
+    OMX_U32 nFiles, nShard;
 
     if (('h' == sCommandAndArgs[0]) || ('H' == sCommandAndArgs[0]))
     {
@@ -649,8 +1296,7 @@ OMX_ERRORTYPE OMX_CONF_ParseCommand( OMX_IN OMX_STRING sCommandAndArgs )
     for(;(*pC == ' ')||(*pC == '\t');pC++);     // strip spaces before argument
     sArgument = pC;
     for(;(*pC != ' ')&&(*pC != '\t')&&(*pC != '\0');pC++);     // null terminate argument
-    *pC = '\0';
-    pC++;
+    if (*pC != '\0') *pC++ = '\0';
 
     if (!strcmp("cc", sCommand))
     {
@@ -679,6 +1325,53 @@ OMX_ERRORTYPE OMX_CONF_ParseCommand( OMX_IN OMX_STRING sCommandAndArgs )
     else if (!strcmp("cl", sCommand)){
         OMX_OSAL_CloseLogfile();
     } 
+    else if (!strcmp("oe", sCommand))
+    {
+        if (sArgument[0] == '\0'){
+           OMX_CONF_PrintOeUsage();     
+        } else if (OMX_ErrorNone != OMX_CONF_EventLogOpen(sArgument, OMX_FALSE)) {
+            OMX_OSAL_Trace(OMX_OSAL_TRACE_ERROR, "Failed to open event log %s\n", sArgument);
+        }
+    }
+    else if (!strcmp("or", sCommand))
+    {
+        if (sArgument[0] == '\0'){
+           OMX_CONF_PrintOrUsage();     
+        } else if (OMX_ErrorNone != OMX_CONF_EventLogOpen(sArgument, OMX_TRUE)) {
+            OMX_OSAL_Trace(OMX_OSAL_TRACE_ERROR, "Failed to open event log %s\n", sArgument);
+        }
+    }
+    else if (!strcmp("ce", sCommand)){
+        OMX_OSAL_EventLogClose();
+    } 
+    else if (!strcmp("ej", sCommand))
+    {
+        // extract second argument
+        for(;(*pC == ' ')||(*pC == '\t');pC++);     // strip spaces before argument
+        sArgument2 = pC;
+        for(;(*pC != ' ')&&(*pC != '\t')&&(*pC != '\0');pC++);     // null terminate argument
+        *pC = '\0';
+
+        if ((sArgument[0] == '\0')||(sArgument2[0] == '\0')){
+           OMX_CONF_PrintEjUsage();     
+        } else {
+            OMX_OSAL_ConvertEventLog(sArgument, sArgument2);
+        }
+    }
+    else if (!strcmp("rp", sCommand))
+    {
+        // extract second argument
+        for(;(*pC == ' ')||(*pC == '\t');pC++);     // strip spaces before argument
+        sArgument2 = pC;
+        for(;(*pC != ' ')&&(*pC != '\t')&&(*pC != '\0');pC++);     // null terminate argument
+        *pC = '\0';
+
+        if (sArgument[0] == '\0'){
+           OMX_CONF_PrintRpUsage();     
+        } else {
+            OMX_CONF_Replay(sArgument, (sArgument2[0] == '\0') ? 1 : strtol(sArgument2,NULL,0));
+        }
+    }
     else if (!strcmp("at", sCommand))
     {
         if (sArgument[0] == '\0'){
@@ -711,10 +1404,136 @@ OMX_ERRORTYPE OMX_CONF_ParseCommand( OMX_IN OMX_STRING sCommandAndArgs )
             OMX_CONF_TestComponent(sArgument, bPassed);
         }
     } 
+    else if (!strcmp("pj", sCommand))
+    {
+        // extract second argument
+        for(;(*pC == ' ')||(*pC == '\t');pC++);     // strip spaces before argument
+        sArgument2 = pC;
+        for(;(*pC != ' ')&&(*pC != '\t')&&(*pC != '\0');pC++);     // null terminate argument
+        *pC = '\0';
+
+        if (sArgument[0] == '\0'){
+           OMX_CONF_PrintPjUsage();     
+        } else {
+            g_OMX_CONF_nTestJobs = strtol(sArgument,NULL,0);
+            g_OMX_CONF_nTestJobTimeout = (sArgument2[0] == '\0') ? OMX_CONF_TIMEOUT_TEST_JOB : strtol(sArgument2,NULL,0);
+        }
+    } 
+    else if (!strcmp("rf", sCommand))
+    {
+        if (sArgument[0] == '\0'){
+           OMX_CONF_PrintRfUsage();     
+        } else {
+            OMX_CONF_ResultsOpen(sArgument);
+        }
+    }
+    else if (!strcmp("cr", sCommand)){
+        OMX_CONF_ResultsClose();
+    } 
+    else if (!strcmp("sh", sCommand))
+    {
+        // extract second argument
+        for(;(*pC == ' ')||(*pC == '\t');pC++);     // strip spaces before argument
+        sArgument2 = pC;
+        for(;(*pC != ' ')&&(*pC != '\t')&&(*pC != '\0');pC++);     // null terminate argument
+        *pC = '\0';
+
+        nShard = strtol(sArgument,&pC,0);
+        if ((sArgument[0] == '\0') || (*pC != '/')){
+           OMX_CONF_PrintShUsage();     
+        } else if (OMX_ErrorNone != OMX_CONF_ShardSet(nShard, strtol(pC+1,NULL,0), sArgument2)) {
+            OMX_OSAL_Trace(OMX_OSAL_TRACE_ERROR, "Cannot run shard %s, all tests of following commands are run\n", sArgument);
+        }
+    }
+    else if (!strcmp("cb", sCommand))
+    {
+        // extract second argument
+        for(;(*pC == ' ')||(*pC == '\t');pC++);     // strip spaces before argument
+        sArgument2 = pC;
+        for(;(*pC != ' ')&&(*pC != '\t')&&(*pC != '\0');pC++);     // null terminate argument
+        *pC = '\0';
+
+        if (sArgument[0] == '\0'){
+           OMX_CONF_PrintCbUsage();     
+        } else if (!strcmp("-", sArgument)) {
+            OMX_CONF_BaselineSet(NULL, 0);
+        } else {
+            OMX_CONF_BaselineSet(sArgument, (sArgument2[0] == '\0') ? OMX_CONF_BASELINE_TOLERANCE : strtol(sArgument2,NULL,0));
+        }
+    }
+    else if (!strcmp("ca", sCommand))
+    {
+        // extract second argument
+        for(;(*pC == ' ')||(*pC == '\t');pC++);     // strip spaces before argument
+        sArgument2 = pC;
+        for(;(*pC != ' ')&&(*pC != '\t')&&(*pC != '\0');pC++);     // null terminate argument
+        *pC = '\0';
+
+        if (sArgument[0] == '\0'){
+           OMX_CONF_PrintCaUsage();     
+        } else {
+            OMX_CONF_CalibrateComponent(sArgument, (sArgument2[0] == '\0') ? OMX_CONF_CALIBRATION_PASSES : strtol(sArgument2,NULL,0));
+        }
+    }
+    else if (!strcmp("to", sCommand))
+    {
+        // extract second argument
+        for(;(*pC == ' ')||(*pC == '\t');pC++);     // strip spaces before argument
+        sArgument2 = pC;
+        for(;(*pC != ' ')&&(*pC != '\t')&&(*pC != '\0');pC++);     // null terminate argument
+        *pC = '\0';
+
+        if ((sArgument[0] == '\0') || (sArgument2[0] == '\0')){
+           OMX_CONF_PrintToUsage();     
+        } else if (OMX_ErrorNone != OMX_CONF_TimeoutSet(sArgument, strtol(sArgument2,NULL,0))) {
+           OMX_CONF_PrintToUsage();     
+        }
+    }
+    else if (!strcmp("mr", sCommand))
+    {
+        // extract further arguments
+        psFiles[0] = sArgument;
+        for (nFiles = 1; nFiles < OMX_CONF_MAXMERGEDFILES; nFiles++) {
+            for(;(*pC == ' ')||(*pC == '\t');pC++);     // strip spaces before argument
+            if (*pC == '\0') break;
+            psFiles[nFiles] = pC;
+            for(;(*pC != ' ')&&(*pC != '\t')&&(*pC != '\0');pC++);     // null terminate argument
+            if (*pC != '\0') *pC++ = '\0';
+        }
+
+        if (sArgument[0] == '\0'){
+           OMX_CONF_PrintMrUsage();     
+        } else {
+            OMX_CONF_ResultsMerge(psFiles, nFiles);
+        }
+    }
     else if (!strcmp("ps", sCommand))
     {
         OMX_CONF_PrintSettings();
     } 
+    else if (!strcmp("pl", sCommand))
+    {
+        OMX_CONF_PrintLatencies();
+    } 
+    else if (!strcmp("bp", sCommand))
+    {
+        // extract second argument
+        for(;(*pC == ' ')||(*pC == '\t');pC++);     // strip spaces before argument
+        sArgument2 = pC;
+        for(;(*pC != ' ')&&(*pC != '\t')&&(*pC != '\0');pC++);     // null terminate argument
+        *pC = '\0';
+
+        if (sArgument[0] == '\0'){
+           OMX_CONF_PrintBpUsage();     
+        } else if (OMX_ErrorNone != OMX_OSAL_BufferPoolSetup(strtol(sArgument,NULL,0) ? OMX_TRUE : OMX_FALSE, 
+                                                            strtoul(sArgument2,NULL,0))) {
+            OMX_OSAL_Trace(OMX_OSAL_TRACE_ERROR, "Contiguous region in use, its size is unchanged\n");
+        }
+    } 
+    else if (!strcmp("tb", sCommand))
+    {
+        OMX_CONF_TraceBenchmark(strtol(sArgument,NULL,0));
+    } 
     else if (!strcmp("mi", sCommand))
     {
         // extract second argument
@@ -743,6 +1562,34 @@ OMX_ERRORTYPE OMX_CONF_ParseCommand( OMX_IN OMX_STRING sCommandAndArgs )
             OMX_CONF_MapOutputfile(sArgument, strtol(sArgument2,NULL,0));
         }
     }
+    else if (!strcmp("fi", sCommand))
+    {
+        // extract second argument
+        for(;(*pC == ' ')||(*pC == '\t');pC++);     // strip spaces before argument
+        sArgument2 = pC;
+        for(;(*pC != ' ')&&(*pC != '\t')&&(*pC != '\0');pC++);     // null terminate argument
+        *pC = '\0';
+
+        if (sArgument[0] == '\0'){
+           OMX_CONF_PrintFiUsage();     
+        } else {
+            OMX_OSAL_FileIoConfigure(strtoul(sArgument,NULL,0), strtoul(sArgument2,NULL,0));
+        }
+    }
+    else if (!strcmp("ix", sCommand))
+    {
+        if (sArgument[0] == '\0'){
+           OMX_CONF_PrintIxUsage();     
+        } else {
+            char sLengthName[sizeof(g_OMX_CONF_InFileMap[0].sInputFileName) + sizeof(".length")];
+            char sIndexName[sizeof(g_OMX_CONF_InFileMap[0].sInputFileName) + sizeof(".index")];
+            if ((snprintf(sLengthName, sizeof(sLengthName), "%s.length", sArgument) >= (int)sizeof(sLengthName)) ||
+                (snprintf(sIndexName, sizeof(sIndexName), "%s.index", sArgument) >= (int)sizeof(sIndexName)))
+                OMX_OSAL_Trace(OMX_OSAL_TRACE_ERROR, "File name too long: %s\n", sArgument);
+            else if (OMX_ErrorNone != OMX_OSAL_ConvertBufferVarianceFile(sLengthName, sIndexName))
+                OMX_OSAL_Trace(OMX_OSAL_TRACE_ERROR, "Failed to convert %s\n", sLengthName);
+        }
+    }
 
     return OMX_ErrorNone;
 }
@@ -762,12 +1609,12 @@ OMX_ERRORTYPE ForceSuppliersPerDomain(OMX_INDEXTYPE nIndex, OMX_HANDLETYPE hComp
     INIT_PARAM(oPortDef);
     oSupplier.eBufferSupplier = bSupplier ? OMX_BufferSupplyInput : OMX_BufferSupplyOutput;
 
-	if (OMX_ErrorNone != (eError = OMX_GetParameter(hComp, nIndex, &oParam))) return eError;
+	if (OMX_ErrorNone != (eError = OMX_CONF_TopologyGetDomain(hComp, nIndex, &oParam))) return eError;
     for (i=0;i<oParam.nPorts;i++)
     {
         iPort = oParam.nStartPortNumber + i;
         oPortDef.nPortIndex = iPort;
-        OMX_GetParameter(hComp, OMX_IndexParamPortDefinition, &oPortDef);
+        OMX_CONF_TopologyGetPort(hComp, &oPortDef);
         
         /* only set inputs */
         if (oPortDef.eDir == OMX_DirInput){
@@ -803,14 +1650,14 @@ OMX_ERRORTYPE AreAllPortsSameDirection(OMX_HANDLETYPE hComp, OMX_BOOL *pbAllSame
 
     /* query the component's ports */
     INIT_PARAM(oParam);
-    if (OMX_ErrorNone != (eError = OMX_GetParameter(hComp, eIndexParamDomainInit, &oParam))) return eError;
+    if (OMX_ErrorNone != (eError = OMX_CONF_TopologyGetDomain(hComp, eIndexParamDomainInit, &oParam))) return eError;
     oPortDef.nPortIndex = oParam.nStartPortNumber;
 
     /* for each discovered port */
     for (i=0;i<oParam.nPorts;i++)
     {        
         /* check direction of port */
-        if (OMX_ErrorNone != (eError = OMX_GetParameter(hComp, OMX_IndexParamPortDefinition, &oPortDef)) ||
+        if (OMX_ErrorNone != (eError = OMX_CONF_TopologyGetPort(hComp, &oPortDef)) ||
             (oPortDef.eDir != eDir))
         { 
             *pbAllSame = OMX_FALSE;
@@ -875,8 +1722,18 @@ int main(int argc, char **argv)
     g_OMX_CONF_nInFileMappings = 0;
     g_OMX_CONF_nOutFileMappings = 0;
     g_OMX_CONF_hTraceMutex = 0;
+    g_OMX_CONF_hTopologyMutex = 0;
+    g_OMX_CONF_hResultsMutex = 0;
+    g_OMX_CONF_hTimeoutsMutex = 0;
 
+    /* before any thread is started, so that the counters follow all of them */
+    OMX_OSAL_CountersOpen();
     OMX_OSAL_MutexCreate(&g_OMX_CONF_hTraceMutex);
+    OMX_OSAL_MutexCreate(&g_OMX_CONF_hTopologyMutex);
+    OMX_OSAL_MutexCreate(&g_OMX_CONF_hResultsMutex);
+    OMX_OSAL_MutexCreate(&g_OMX_CONF_hTimeoutsMutex);
+    OMX_OSAL_TraceConfigure(OMX_CONF_TRACE_RING_ENTRIES);
+    OMX_OSAL_ThreadPoolSetup(OMX_CONF_THREADPOOL_WORKERS);
 
     /* Setup common version structure */
     g_OMX_CONF_Version.s.nVersionMajor = OMX_VERSION_MAJOR;
@@ -885,7 +1742,8 @@ int main(int argc, char **argv)
     g_OMX_CONF_Version.s.nStep = OMX_VERSION_STEP;
 
     /* set default error level, so that you can detect errors in script startup! */
-    OMX_CONF_SetTraceflags(OMX_OSAL_TRACE_INFO|OMX_OSAL_TRACE_ERROR|OMX_OSAL_TRACE_PASSFAIL|OMX_OSAL_TRACE_WARNING);
+    OMX_CONF_SetTraceflags(OMX_OSAL_TRACE_INFO|OMX_OSAL_TRACE_ERROR|OMX_OSAL_TRACE_PASSFAIL|OMX_OSAL_TRACE_WARNING|
+                           OMX_OSAL_TRACE_STATISTICS);
 
     OMX_OSAL_Trace(OMX_OSAL_TRACE_INFO, "\n%s\n\n", OMX_CONF_TEST_VERSION);
 
@@ -895,7 +1753,17 @@ int main(int argc, char **argv)
         OMX_OSAL_ProcessCommandsFromPrompt();
     }
 
+    OMX_OSAL_ThreadPoolRelease();
+    OMX_OSAL_BufferPoolRelease();
+    OMX_OSAL_EventLogClose();
+    OMX_CONF_ResultsClose();
+    OMX_CONF_BaselineSet(NULL, 0);
+    OMX_OSAL_TraceConfigure(0);
     OMX_OSAL_MutexDestroy(g_OMX_CONF_hTraceMutex);
+    OMX_OSAL_MutexDestroy(g_OMX_CONF_hTopologyMutex);
+    OMX_OSAL_MutexDestroy(g_OMX_CONF_hResultsMutex);
+    OMX_OSAL_MutexDestroy(g_OMX_CONF_hTimeoutsMutex);
+    OMX_OSAL_CountersClose();
 
     return 0;
 }
@@ -25,6 +25,9 @@
 
 #include <OMX_Types.h>
 #include <OMX_Core.h>
+#include <OMX_Component.h>
+
+#include "OMX_OSAL_Interfaces.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -34,18 +37,29 @@ extern "C" {
  * GLOBAL VARIABLES/CONSTANTS
  ***********************************************************************/
 extern OMX_VERSIONTYPE g_OMX_CONF_Version;
-#define OMX_CONF_TIMEOUT_EXPECTING_SUCCESS 500  /* duration of event timeout in msec when we expect event to be set */
-#define OMX_CONF_TIMEOUT_EXPECTING_FAILURE 2000 /* duration of event timeout in msec when we don't expect event to be set */
+#define OMX_CONF_TIMEOUT_DEFAULT_EXPECTING_SUCCESS 500  /* duration of event timeout in msec when we expect event to be set */
+#define OMX_CONF_TIMEOUT_DEFAULT_EXPECTING_FAILURE 2000 /* duration of event timeout in msec when we don't expect event to be set */
+
+#define OMX_CONF_TIMEOUT_DEFAULT_WAITING_FOR_RESOURCES 5000 /* duration of event timeout in msec when we are waiting on for a resource */
 
-#define OMX_CONF_TIMEOUT_WAITING_FOR_RESOURCES 5000 /* duration of event timeout in msec when we are waiting on for a resource */
+/* The timeouts tests wait with, adapted to the component under test (see OMX_CONF_Timeout) */
+#define OMX_CONF_TIMEOUT_EXPECTING_SUCCESS      OMX_CONF_Timeout(OMX_CONF_TimeoutExpectingSuccess)
+#define OMX_CONF_TIMEOUT_EXPECTING_FAILURE      OMX_CONF_Timeout(OMX_CONF_TimeoutExpectingFailure)
+#define OMX_CONF_TIMEOUT_WAITING_FOR_RESOURCES  OMX_CONF_Timeout(OMX_CONF_TimeoutWaitingForResources)
+#define OMX_CONF_TIMEOUT_BUFFER_TRAFFIC         OMX_CONF_Timeout(OMX_CONF_TimeoutBufferTraffic)
+
+#define OMX_CONF_THREADPOOL_WORKERS 4   /* worker threads started up front for tests that run work on the OSAL thread pool */
+#define OMX_CONF_TIMEOUT_TEST_JOB 600  /* duration in sec a test may run in its own process (see the pj command) before it is killed */
+#define OMX_CONF_TRACE_RING_ENTRIES 1024 /* trace messages each thread may have queued before further ones are dropped */
 
 /***********************************************************************
  * UTILITY FUNCTIONS
  ***********************************************************************/
 
 /* Constants for when we are waiting on buffer traffic (to implement "wait a while" in OMX_StateExecuting). */
-#define OMX_CONF_TIMEOUT_BUFFER_TRAFFIC    5000 /* duration of event timeout in msec when we are waiting on buffer traffic */
+#define OMX_CONF_TIMEOUT_DEFAULT_BUFFER_TRAFFIC 5000 /* duration of event timeout in msec when we are waiting on buffer traffic */
 #define OMX_CONF_BUFFERS_OF_TRAFFIC 100 /* number of buffers exchanged by TTC's Fill/EmptyThisBuffer when we are waiting on buffer traffic */
+#define OMX_CONF_BUFFERQUEUE_ENTRIES 256 /* capacity of the OSAL queues tests use to hold the idle buffers of all their ports */
 
 /* Force all the component's ports to be suppliers/non-suppliers */
 OMX_ERRORTYPE OMX_CONF_ForceSuppliers(OMX_HANDLETYPE hComp, OMX_BOOL bSupplier);
@@ -56,6 +70,27 @@ OMX_ERRORTYPE OMX_CONF_IsSource(OMX_HANDLETYPE hComp, OMX_BOOL *pbIsSource);
 /* Examines the direction of all the component's ports to determine if it is a sink */
 OMX_ERRORTYPE OMX_CONF_IsSink(OMX_HANDLETYPE hComp, OMX_BOOL *pbIsSink);
 
+/* Component topology
+
+   Snapshot of the component under test taken from a freshly loaded instance once per 
+   OMX_CONF_TestComponent: its port domains, the definition of each of its ports (direction, 
+   domain, format, buffer requirements) and its roles. Queries made through a component 
+   tracer of that component are answered from the snapshot instead of OMX_GetParameter. 
+   A port's entry is dropped when the component reports OMX_EventPortSettingsChanged on it,
+   and port definitions of an instance whose parameters were set through its tracer are 
+   always read from the instance. Other handles are passed to the component.
+*/
+#define OMX_CONF_TOPOLOGY_MAXPORTS 64
+#define OMX_CONF_TOPOLOGY_MAXROLES 32
+
+OMX_ERRORTYPE OMX_CONF_TopologyBuild(OMX_IN OMX_STRING sComponentName);
+void OMX_CONF_TopologyInvalidate(OMX_IN OMX_STRING sComponentName, OMX_IN OMX_U32 nPortIndex);
+OMX_ERRORTYPE OMX_CONF_TopologyGetDomain(OMX_IN OMX_HANDLETYPE hComp, OMX_IN OMX_INDEXTYPE eIndexParamDomainInit,
+                                         OMX_INOUT OMX_PORT_PARAM_TYPE *pParam);
+OMX_ERRORTYPE OMX_CONF_TopologyGetPort(OMX_IN OMX_HANDLETYPE hComp, OMX_INOUT OMX_PARAM_PORTDEFINITIONTYPE *pPortDef);
+OMX_ERRORTYPE OMX_CONF_TopologyGetRoles(OMX_IN OMX_STRING sComponentName, OMX_INOUT OMX_U32 *pNumRoles, 
+                                        OMX_OUT OMX_U8 **ppRoles);
+
 /**********************************************************************
  * COMMON MACROS               
  **********************************************************************/
@@ -124,6 +159,12 @@ OMX_ERRORTYPE OMX_CONF_ComponentTracerCreate( OMX_IN OMX_HANDLETYPE hOrigComp,
                                               OMX_OUT OMX_HANDLETYPE *phWrappedComp);
 OMX_ERRORTYPE OMX_CONF_ComponentTracerDestroy( OMX_IN OMX_HANDLETYPE hWrappedComp);
 
+/* Returns OMX_ErrorBadParameter if hComp is not a component tracer. Otherwise gives the name of
+   the wrapped component and whether parameters were successfully set through the tracer. */
+OMX_ERRORTYPE OMX_CONF_ComponentTracerInfo( OMX_IN OMX_HANDLETYPE hComp,
+                                            OMX_OUT OMX_STRING *psComponentName,
+                                            OMX_OUT OMX_BOOL *pbParametersSet);
+
 /* Component Tracer
 
    A callback tracer is a thin wrapper around a callback structure (OMX_CALLBACKTYPE) 
@@ -151,6 +192,213 @@ OMX_ERRORTYPE OMX_CONF_CommandToString( OMX_IN OMX_COMMANDTYPE eCommand, OMX_OUT
 OMX_ERRORTYPE OMX_CONF_IndexToString( OMX_IN OMX_INDEXTYPE nIndex, OMX_OUT OMX_STRING sName);
 OMX_ERRORTYPE OMX_OSAL_GetTracePrefix(OMX_IN OMX_U32 nTraceFlags, OMX_OUT OMX_STRING szPrefix);
 
+/* Latency histograms
+
+   Log bucketed histograms of durations in nanoseconds. Values below 32 ns are kept 
+   exactly, larger ones in 32 buckets per power of two (within about 3%) up to 2^40 ns.
+   The component tracer keeps one per component entry point.
+*/
+#define OMX_CONF_HISTOGRAM_SUBBITS  5
+#define OMX_CONF_HISTOGRAM_MAXBITS  40
+#define OMX_CONF_HISTOGRAM_BUCKETS  ((OMX_CONF_HISTOGRAM_MAXBITS - OMX_CONF_HISTOGRAM_SUBBITS + 1) << OMX_CONF_HISTOGRAM_SUBBITS)
+
+typedef struct OMX_CONF_HISTOGRAMTYPE {
+    OMX_U64 nCount;
+    OMX_U64 nMax;
+    OMX_U32 nBuckets[OMX_CONF_HISTOGRAM_BUCKETS];
+} OMX_CONF_HISTOGRAMTYPE;
+
+void OMX_CONF_HistogramRecord( OMX_INOUT OMX_CONF_HISTOGRAMTYPE *pHistogram, OMX_IN OMX_U64 nValue);
+void OMX_CONF_HistogramMerge( OMX_INOUT OMX_CONF_HISTOGRAMTYPE *pTo, OMX_IN OMX_CONF_HISTOGRAMTYPE *pFrom);
+/** Return the value nPerMille thousandths of the recorded values do not exceed
+ *  (500 for the median, 999 for p99.9), 0 if the histogram is empty. */
+OMX_U64 OMX_CONF_HistogramPercentile( OMX_IN OMX_CONF_HISTOGRAMTYPE *pHistogram, OMX_IN OMX_U32 nPerMille);
+/** Print latency percentiles per entry point of every component whose tracer 
+ *  has been destroyed since the harness started. */
+OMX_ERRORTYPE OMX_CONF_PrintLatencies();
+
+/** Print what the counters read into pBegin and pEnd nWallNs apart changed by,
+ *  and whether the CPU time spent in between makes sWhat CPU- or wait-bound. */
+void OMX_CONF_PrintCounters( OMX_IN OMX_STRING sWhat, OMX_IN OMX_OSAL_COUNTERSTYPE *pBegin, 
+                             OMX_IN OMX_OSAL_COUNTERSTYPE *pEnd, OMX_IN OMX_U64 nWallNs);
+
+/** Time nCalls EmptyThisBuffer calls on a stubbed component, directly and 
+ *  through a component tracer, and print the cost per call of both under the 
+ *  current trace flags. nCalls of 0 runs OMX_CONF_TRACE_BENCHMARK_CALLS. */
+#define OMX_CONF_TRACE_BENCHMARK_CALLS 1000000
+OMX_ERRORTYPE OMX_CONF_TraceBenchmark(OMX_IN OMX_U32 nCalls);
+
+/* Call recording and replay
+
+   The tracers log every call and callback to the event log. Opened with 
+   bRecordArguments each call is followed by a data record holding an 
+   OMX_CONF_RECORDEDCALLTYPE and then the parameter structure or string it 
+   passed, if any. OMX_CONF_Replay drives new instances of the recorded 
+   components through the same sequence and compares results and timings.
+*/
+typedef enum OMX_CONF_TRACEAPITYPE {
+    OMX_CONF_TraceApiGetComponentVersion,
+    OMX_CONF_TraceApiSendCommand,
+    OMX_CONF_TraceApiGetParameter,
+    OMX_CONF_TraceApiSetParameter,
+    OMX_CONF_TraceApiGetConfig,
+    OMX_CONF_TraceApiSetConfig,
+    OMX_CONF_TraceApiGetExtensionIndex,
+    OMX_CONF_TraceApiGetState,
+    OMX_CONF_TraceApiComponentTunnelRequest,
+    OMX_CONF_TraceApiUseBuffer,
+    OMX_CONF_TraceApiAllocateBuffer,
+    OMX_CONF_TraceApiFreeBuffer,
+    OMX_CONF_TraceApiEmptyThisBuffer,
+    OMX_CONF_TraceApiFillThisBuffer,
+    OMX_CONF_TraceApiSetCallbacks,
+    OMX_CONF_TraceApiComponentDeInit,
+    OMX_CONF_TraceApiEventHandler,
+    OMX_CONF_TraceApiEmptyBufferDone,
+    OMX_CONF_TraceApiFillBufferDone,
+    OMX_CONF_TraceApiTracerCreate,      /**< recorded only, data is the component name */
+    OMX_CONF_TraceApiTracerDestroy,     /**< recorded only */
+    OMX_CONF_TraceApiMax
+} OMX_CONF_TRACEAPITYPE;
+
+/* component entry points come before the callbacks */
+#define OMX_CONF_TRACE_COMPONENTAPIS OMX_CONF_TraceApiEventHandler
+
+extern OMX_STRING g_OMX_CONF_sTraceApiNames[OMX_CONF_TraceApiMax];
+
+/* longest structure or string recorded with a call */
+#define OMX_CONF_RECORD_MAXDATA 4096
+
+/* nArgs holds: SendCommand Cmd, nParam1; Get/SetParameter, Get/SetConfig the index;
+   GetExtensionIndex the returned index; GetState the returned state; 
+   ComponentTunnelRequest nPort, nTunneledPort; UseBuffer, AllocateBuffer nPortIndex, 
+   nSizeBytes; FreeBuffer nPortIndex; EventHandler eEvent, nData1, nData2. */
+typedef struct OMX_CONF_RECORDEDCALLTYPE {
+    OMX_U64 nHandle;        /**< handle of the original component */
+    OMX_U64 nBuffer;        /**< buffer header involved, 0 if none */
+    OMX_U64 nPayloadHash;   /**< OMX_CONF_PayloadHash of the filled bytes, EmptyThisBuffer and FillBufferDone only */
+    OMX_TICKS nTimeStamp;
+    OMX_U32 nArgs[3];
+    OMX_U32 nFilledLen;
+    OMX_U32 nOffset;
+    OMX_U32 nFlags;
+    OMX_U32 nAllocLen;
+    OMX_U32 nPortIndex;
+} OMX_CONF_RECORDEDCALLTYPE;
+
+/** Open the event log sFilename. With bRecordArguments calls are logged with their 
+ *  arguments and buffer payload hashes, for OMX_CONF_Replay. */
+OMX_ERRORTYPE OMX_CONF_EventLogOpen(OMX_IN OMX_STRING sFilename, OMX_IN OMX_BOOL bRecordArguments);
+/** 64 bit FNV-1a hash of nBytes of pData, 0 for no data. */
+OMX_U64 OMX_CONF_PayloadHash(OMX_IN OMX_U8 *pData, OMX_IN OMX_U32 nBytes);
+/** Replay the calls recorded in event log sFilename on new instances of the same 
+ *  components, nSpeed times as fast as recorded (0 for as fast as possible), and 
+ *  report differences in results, output and timing. */
+OMX_ERRORTYPE OMX_CONF_Replay(OMX_IN OMX_STRING sFilename, OMX_IN OMX_U32 nSpeed);
+
+/* Results files, baselines and sharding
+
+   Results files are written in the format their name ends in: .json for a
+   JSON array of test records, .xml for JUnit XML, otherwise text. A text 
+   results file holds one line per test run, metric it recorded, value that
+   regressed or profile detected, later lines replacing earlier ones of the
+   same component and test:
+       T <component> <test> PASSED|FAILED <error> <wall ms> <cpu ms> <peak rss KB>
+       M <component> <test> <metric> <value> <unit>
+       R <component> <test> <metric> <value> <baseline median> <baseline MAD> <unit>
+       P <component> <detected compliance>
+   A text results file appended to over several runs is a baseline: each
+   value of a passing test is compared with the median of the same value
+   in the passing runs of the file.
+   Sharding runs the component and test pairs of one shard of a run split 
+   over several machines. The split is weighed with the durations in a 
+   results file of earlier runs, and is the same on every machine given 
+   the same file.
+*/
+/** Write the results of the tests run from now on to sFilename, appending to
+ *  a text file. Replaces the open file of the same format. */
+OMX_ERRORTYPE OMX_CONF_ResultsOpen(OMX_IN OMX_STRING sFilename);
+/** Complete and close all open results files. */
+OMX_ERRORTYPE OMX_CONF_ResultsClose();
+/** Record a measurement of the running test, such as a throughput, for its
+ *  results. A metric recorded again under the same name replaces the first;
+ *  up to OMX_CONF_MAXMETRICS are kept per test. */
+#define OMX_CONF_MAXMETRICS 64
+void OMX_CONF_RecordMetric(OMX_IN OMX_STRING sName, OMX_IN double fValue, OMX_IN OMX_STRING sUnit);
+/** Start and end the record of a test: its metrics, CPU time and peak memory. */
+void OMX_CONF_ResultsTestBegin();
+void OMX_CONF_ResultsTestEnd();
+/** Hand the record of a test run in a child process to the harness. */
+void OMX_CONF_ResultsTestExport(OMX_OUT OMX_PTR *ppRecord, OMX_OUT OMX_U32 *pnBytes);
+void OMX_CONF_ResultsTestImport(OMX_IN OMX_PTR pRecord, OMX_IN OMX_U32 nBytes);
+extern OMX_HANDLETYPE g_OMX_CONF_hResultsMutex;
+/** Write the outcome of a test with the record of the test last ended. */
+void OMX_CONF_ResultsRecordTest(OMX_IN OMX_STRING sComponentName, OMX_IN OMX_STRING sTestName,
+                                OMX_IN OMX_ERRORTYPE eError, OMX_IN OMX_U64 nWallNs);
+void OMX_CONF_ResultsRecordProfile(OMX_IN OMX_STRING sComponentName, OMX_IN OMX_U32 nDetectedCompliance);
+/** Run only shard nShard (1 to nShards) of the tests from now on, weighed with the 
+ *  results file sHistoryFilename if not NULL. nShards of 0 or 1 runs all tests. */
+OMX_ERRORTYPE OMX_CONF_ShardSet(OMX_IN OMX_U32 nShard, OMX_IN OMX_U32 nShards, OMX_IN OMX_STRING sHistoryFilename);
+OMX_BOOL OMX_CONF_ShardActive();
+OMX_BOOL OMX_CONF_ShardOwns(OMX_IN OMX_STRING sComponentName, OMX_IN OMX_STRING sTestName);
+/** Compare the tests run from now on with the baseline in results file sFilename, 
+ *  or stop comparing if NULL. A passing test whose time or metrics are worse 
+ *  than their baseline by nTolerance percent and three times its noise has
+ *  REGRESSED. A value with fewer than OMX_CONF_BASELINE_MINSAMPLES passing runs
+ *  in the file is not compared. */
+#define OMX_CONF_BASELINE_TOLERANCE 10
+#define OMX_CONF_BASELINE_MINSAMPLES 3
+OMX_ERRORTYPE OMX_CONF_BaselineSet(OMX_IN OMX_STRING sFilename, OMX_IN OMX_U32 nTolerance);
+OMX_BOOL OMX_CONF_BaselineActive();
+/** Compare the record of the test last ended with the baseline, for the next
+ *  OMX_CONF_ResultsRecordTest. Returns whether it regressed, and in 
+ *  pbShortHistory whether a value had too few runs to be compared. */
+OMX_BOOL OMX_CONF_BaselineCompare(OMX_IN OMX_STRING sComponentName, OMX_IN OMX_STRING sTestName,
+                                  OMX_IN OMX_ERRORTYPE eError, OMX_IN OMX_U64 nWallNs, OMX_OUT OMX_BOOL *pbShortHistory);
+/** Print the summary and compliance of every component in the nFiles results files. */
+OMX_ERRORTYPE OMX_CONF_ResultsMerge(OMX_IN OMX_STRING *psFilenames, OMX_IN OMX_U32 nFiles);
+/** Print the profiles a component detected as nDetectedCompliance passes, given the 
+ *  flags and outcomes of the nTests tests run on it, and their performance against
+ *  a baseline if pbRegressed is not NULL. */
+void OMX_CONF_ReportCompliance(OMX_IN OMX_U32 nDetectedCompliance, OMX_IN OMX_U32 nTests, 
+                               OMX_IN OMX_U32 *pTestFlags, OMX_IN OMX_BOOL *pbPassed,
+                               OMX_IN OMX_BOOL *pbRegressed);
+
+/* Timeouts
+
+   Every command a test sends through a component tracer, and its completion,
+   is timed. Once a component is calibrated (see the ca command) a wait for 
+   success or failure while the command the test sent last is outstanding
+   lasts a few times the longest completion of that command seen, but no 
+   longer than the default and no shorter than 100 ms. Values set by the 
+   script take precedence.
+*/
+typedef enum OMX_CONF_TIMEOUTTYPE {
+    OMX_CONF_TimeoutExpectingSuccess,
+    OMX_CONF_TimeoutExpectingFailure,
+    OMX_CONF_TimeoutWaitingForResources,
+    OMX_CONF_TimeoutBufferTraffic,
+    OMX_CONF_TIMEOUTS
+} OMX_CONF_TIMEOUTTYPE;
+/** The timeout in ms of a wait of kind eTimeout. */
+OMX_U32 OMX_CONF_Timeout(OMX_IN OMX_CONF_TIMEOUTTYPE eTimeout);
+/** eCmd was sent with nParam and is due to complete nCompletions times, 0 if not known. */
+void OMX_CONF_TimeoutCommandSent(OMX_IN OMX_STRING sComponentName, OMX_IN OMX_COMMANDTYPE eCmd, OMX_IN OMX_U32 nParam,
+                                 OMX_IN OMX_U32 nCompletions);
+/** The component returned an error from SendCommand of eCmd, which will not complete. */
+void OMX_CONF_TimeoutCommandRejected(OMX_IN OMX_STRING sComponentName, OMX_IN OMX_COMMANDTYPE eCmd);
+void OMX_CONF_TimeoutCommandComplete(OMX_IN OMX_STRING sComponentName, OMX_IN OMX_COMMANDTYPE eCmd, OMX_IN OMX_U32 nParam);
+void OMX_CONF_TimeoutTestBegin();
+/** Adapt the timeouts of sComponentName to the commands timed so far, or stop. */
+void OMX_CONF_TimeoutCalibrated(OMX_IN OMX_STRING sComponentName, OMX_IN OMX_BOOL bCalibrated);
+/** Set the timeout sName (success, failure, resources or traffic), or that of a 
+ *  command (state, disable, enable or flush), to nMs; 0 restores it. "adaptive" 
+ *  with 0 stops adapting timeouts to any component. */
+OMX_ERRORTYPE OMX_CONF_TimeoutSet(OMX_IN OMX_STRING sName, OMX_IN OMX_U32 nMs);
+OMX_ERRORTYPE OMX_CONF_PrintTimeouts(OMX_IN OMX_STRING sComponentName);
+extern OMX_HANDLETYPE g_OMX_CONF_hTimeoutsMutex;
+#define OMX_CONF_CALIBRATION_PASSES 2  /* runs of the test list the ca command times commands over */
+
 /**********************************************************************
  * TEST FUNCTION PROTOTYPES               
  **********************************************************************/
@@ -210,6 +458,10 @@ OMX_ERRORTYPE OMX_CONF_ListComponents();
 /** Test the component using the current trace flags, input/output mapping, and test settings */
 OMX_ERRORTYPE OMX_CONF_TestComponent( OMX_IN OMX_STRING sComponentName, OMX_BOOL *bPassed );
 
+/** Run the current list of tests on the component without reporting them, and adapt its 
+    timeouts to how long its commands took. */
+OMX_ERRORTYPE OMX_CONF_CalibrateComponent( OMX_IN OMX_STRING sComponentName, OMX_U32 nPasses );
+
 /** Test the component using the official trace flags, input/output mapping, and test settings 
     for conformance testing. Report on compliance. */
 OMX_ERRORTYPE OMX_CONF_ConformanceTestComponent( OMX_IN OMX_STRING sComponentName, OMX_BOOL *bPassed );
@@ -55,8 +55,15 @@ OMX_ERRORTYPE OMX_CONF_TunnelledUnitTest(OMX_IN OMX_STRING cComponentName);
 /* OSAL Test Prototypes */
 OMX_ERRORTYPE OMX_OSAL_TestAll(OMX_IN OMX_STRING cComponentName);
 OMX_ERRORTYPE OMX_OSAL_MemoryTest1(OMX_IN OMX_STRING cComponentName);
+OMX_ERRORTYPE OMX_OSAL_BufferPoolTest1(OMX_IN OMX_STRING cComponentName);
 OMX_ERRORTYPE OMX_OSAL_MultiThreadTest1(OMX_IN OMX_STRING cComponentName);
 OMX_ERRORTYPE OMX_OSAL_TimerTest1(OMX_IN OMX_STRING cComponentName);
+OMX_ERRORTYPE OMX_OSAL_SyncTest1(OMX_IN OMX_STRING cComponentName);
+OMX_ERRORTYPE OMX_OSAL_ThreadPoolTest1(OMX_IN OMX_STRING cComponentName);
+OMX_ERRORTYPE OMX_OSAL_QueueTest1(OMX_IN OMX_STRING cComponentName);
+
+/* Tracer Test Prototypes */
+OMX_ERRORTYPE OMX_CONF_TraceValidateTest1(OMX_IN OMX_STRING cComponentName);
 
 /* Standard Component Class tests */
 OMX_ERRORTYPE OMX_CONF_StdAudioDecoderTest(OMX_IN OMX_STRING cComponentName);
@@ -203,11 +210,16 @@ OMX_CONF_TESTLOOKUPTYPE g_OMX_CONF_TestLookupTable [] =
 
     
 #ifdef OSAL_TESTS
-    /* special tests for OSAL layer (useful when bringing up new platform); component is ignored */
+    /* special tests for OSAL layer (useful when bringing up new platform) and the tracers; component is ignored */
     ,{"_OSAL_All", OMX_OSAL_TestAll},
     {"_OSAL_MemoryTest1", OMX_OSAL_MemoryTest1},
+    {"_OSAL_BufferPoolTest1", OMX_OSAL_BufferPoolTest1},
     {"_OSAL_MultiThreadTest1", OMX_OSAL_MultiThreadTest1},
-    {"_OSAL_TimereTest1", OMX_OSAL_TimerTest1}
+    {"_OSAL_TimereTest1", OMX_OSAL_TimerTest1},
+    {"_OSAL_SyncTest1", OMX_OSAL_SyncTest1},
+    {"_OSAL_ThreadPoolTest1", OMX_OSAL_ThreadPoolTest1},
+    {"_OSAL_QueueTest1", OMX_OSAL_QueueTest1},
+    {"_TRACE_ValidateTest1", OMX_CONF_TraceValidateTest1}
 #endif
 };
 
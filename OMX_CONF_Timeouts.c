@@ -0,0 +1,326 @@
+/*
+ * Copyright (c) 2019 The Khronos Group Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/** OMX_CONF_Timeouts.c
+ *  Timeouts of the waits of the tests. The component tracers report each
+ *  command sent and completed, from which the time each component takes to
+ *  change state, enable or disable a port and flush is learned. Once a
+ *  component is calibrated, a test waiting on the command it last sent
+ *  waits a few times as long as the component has been seen to take rather
+ *  than the fixed OMX_CONF_TIMEOUT_DEFAULT_ values; waits that expect
+ *  nothing to happen gain the most. Waits with no command outstanding
+ *  keep the defaults.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+#include <OMX_Types.h>
+#include <OMX_Core.h>
+
+#include "OMX_OSAL_Interfaces.h"
+#include "OMX_CONF_TestHarness.h"
+
+#include <stdio.h>
+#include <string.h>
+
+/**********************************************************************
+ * LEARNED LATENCIES
+ **********************************************************************/
+
+#define OMX_CONF_TIMEOUT_MAXCOMPONENTS 32
+#define OMX_CONF_TIMEOUT_MINSAMPLES    4    /* completions of a command before its timeout adapts */
+#define OMX_CONF_TIMEOUT_SCALE         4    /* times the longest completion seen that a wait lasts */
+#define OMX_CONF_TIMEOUT_MARGIN        20   /* ms added to that for the scheduling of the test */
+#define OMX_CONF_TIMEOUT_MINIMUM       100  /* ms below which no wait is shortened */
+
+typedef enum OMX_CONF_TIMEDCOMMANDTYPE {
+    OMX_CONF_TimedStateSet,
+    OMX_CONF_TimedPortDisable,
+    OMX_CONF_TimedPortEnable,
+    OMX_CONF_TimedFlush,
+    OMX_CONF_TIMEDCOMMANDS
+} OMX_CONF_TIMEDCOMMANDTYPE;
+
+typedef struct OMX_CONF_COMMANDTIMINGTYPE {
+    OMX_U32 nSamples;
+    OMX_U64 nMaxNs;
+    OMX_U64 nTotalNs;
+    OMX_BOOL bPending;
+    OMX_U32 nPendingParam;      /* target state or port of the command in flight */
+    OMX_U32 nPendingCompletions;    /* OMX_EventCmdComplete still due for it, one per port for OMX_ALL */
+    OMX_U64 nSentNs;
+} OMX_CONF_COMMANDTIMINGTYPE;
+
+typedef struct OMX_CONF_TIMEDCOMPONENTTYPE {
+    char sComponentName[OMX_MAX_STRINGNAME_SIZE];
+    OMX_BOOL bCalibrated;
+    OMX_CONF_COMMANDTIMINGTYPE oCommands[OMX_CONF_TIMEDCOMMANDS];
+} OMX_CONF_TIMEDCOMPONENTTYPE;
+
+OMX_HANDLETYPE g_OMX_CONF_hTimeoutsMutex;
+static OMX_CONF_TIMEDCOMPONENTTYPE g_OMX_CONF_TimedComponents[OMX_CONF_TIMEOUT_MAXCOMPONENTS];
+static OMX_U32 g_OMX_CONF_nTimedComponents = 0;
+static OMX_BOOL g_OMX_CONF_bAdaptiveTimeouts = OMX_TRUE;
+
+/* the command a test sent last, which the wait that follows is most likely for */
+static OMX_CONF_TIMEDCOMPONENTTYPE *g_OMX_CONF_pLastComponent = NULL;
+static OMX_CONF_TIMEDCOMMANDTYPE g_OMX_CONF_eLastCommand = OMX_CONF_TIMEDCOMMANDS;
+
+/* timeouts set by the script, 0 where not set */
+static OMX_U32 g_OMX_CONF_nTimeoutOverrides[OMX_CONF_TIMEOUTS];
+static OMX_U32 g_OMX_CONF_nCommandOverrides[OMX_CONF_TIMEDCOMMANDS];
+
+static const OMX_U32 g_OMX_CONF_nTimeoutDefaults[OMX_CONF_TIMEOUTS] = {
+    OMX_CONF_TIMEOUT_DEFAULT_EXPECTING_SUCCESS,
+    OMX_CONF_TIMEOUT_DEFAULT_EXPECTING_FAILURE,
+    OMX_CONF_TIMEOUT_DEFAULT_WAITING_FOR_RESOURCES,
+    OMX_CONF_TIMEOUT_DEFAULT_BUFFER_TRAFFIC
+};
+static const OMX_STRING g_OMX_CONF_sTimeoutNames[OMX_CONF_TIMEOUTS] = { "success", "failure", "resources", "traffic" };
+static const OMX_STRING g_OMX_CONF_sCommandNames[OMX_CONF_TIMEDCOMMANDS] = { "state", "disable", "enable", "flush" };
+
+static OMX_CONF_TIMEDCOMMANDTYPE OMX_CONF_TimedCommand(OMX_COMMANDTYPE eCmd)
+{
+    switch (eCmd) {
+    case OMX_CommandStateSet:    return OMX_CONF_TimedStateSet;
+    case OMX_CommandPortDisable: return OMX_CONF_TimedPortDisable;
+    case OMX_CommandPortEnable:  return OMX_CONF_TimedPortEnable;
+    case OMX_CommandFlush:       return OMX_CONF_TimedFlush;
+    default:                     return OMX_CONF_TIMEDCOMMANDS;
+    }
+}
+
+/* Called with g_OMX_CONF_hTimeoutsMutex held. */
+static OMX_CONF_TIMEDCOMPONENTTYPE *OMX_CONF_TimedComponent(OMX_STRING sComponentName, OMX_BOOL bCreate)
+{
+    OMX_CONF_TIMEDCOMPONENTTYPE *pComponent;
+    OMX_U32 i;
+
+    for (i = 0; i < g_OMX_CONF_nTimedComponents; i++) {
+        if (!strcmp(g_OMX_CONF_TimedComponents[i].sComponentName, sComponentName))
+            return &g_OMX_CONF_TimedComponents[i];
+    }
+    if (!bCreate || g_OMX_CONF_nTimedComponents == OMX_CONF_TIMEOUT_MAXCOMPONENTS)
+        return NULL;
+    pComponent = &g_OMX_CONF_TimedComponents[g_OMX_CONF_nTimedComponents++];
+    memset(pComponent, 0, sizeof(OMX_CONF_TIMEDCOMPONENTTYPE));
+    strncpy(pComponent->sComponentName, sComponentName, OMX_MAX_STRINGNAME_SIZE - 1);
+    return pComponent;
+}
+
+void OMX_CONF_TimeoutCommandSent(OMX_IN OMX_STRING sComponentName, OMX_IN OMX_COMMANDTYPE eCmd, OMX_IN OMX_U32 nParam,
+                                 OMX_IN OMX_U32 nCompletions)
+{
+    OMX_CONF_TIMEDCOMMANDTYPE eCommand = OMX_CONF_TimedCommand(eCmd);
+    OMX_CONF_TIMEDCOMPONENTTYPE *pComponent;
+
+    if (eCommand == OMX_CONF_TIMEDCOMMANDS)
+        return;
+    if (g_OMX_CONF_hTimeoutsMutex) OMX_OSAL_MutexLock(g_OMX_CONF_hTimeoutsMutex);
+    pComponent = OMX_CONF_TimedComponent(sComponentName, OMX_TRUE);
+    if (pComponent) {
+        /* a command sent again before it completed is timed from the latest */
+        pComponent->oCommands[eCommand].bPending = nCompletions ? OMX_TRUE : OMX_FALSE;
+        pComponent->oCommands[eCommand].nPendingParam = nParam;
+        pComponent->oCommands[eCommand].nPendingCompletions = nCompletions;
+        pComponent->oCommands[eCommand].nSentNs = OMX_OSAL_GetTimeNs();
+        g_OMX_CONF_pLastComponent = pComponent;
+        g_OMX_CONF_eLastCommand = eCommand;
+    }
+    if (g_OMX_CONF_hTimeoutsMutex) OMX_OSAL_MutexUnlock(g_OMX_CONF_hTimeoutsMutex);
+}
+
+void OMX_CONF_TimeoutCommandRejected(OMX_IN OMX_STRING sComponentName, OMX_IN OMX_COMMANDTYPE eCmd)
+{
+    OMX_CONF_TIMEDCOMMANDTYPE eCommand = OMX_CONF_TimedCommand(eCmd);
+    OMX_CONF_TIMEDCOMPONENTTYPE *pComponent;
+
+    if (eCommand == OMX_CONF_TIMEDCOMMANDS)
+        return;
+    if (g_OMX_CONF_hTimeoutsMutex) OMX_OSAL_MutexLock(g_OMX_CONF_hTimeoutsMutex);
+    pComponent = OMX_CONF_TimedComponent(sComponentName, OMX_FALSE);
+    if (pComponent) {
+        pComponent->oCommands[eCommand].bPending = OMX_FALSE;
+        pComponent->oCommands[eCommand].nPendingCompletions = 0;
+    }
+    if (g_OMX_CONF_hTimeoutsMutex) OMX_OSAL_MutexUnlock(g_OMX_CONF_hTimeoutsMutex);
+}
+
+void OMX_CONF_TimeoutCommandComplete(OMX_IN OMX_STRING sComponentName, OMX_IN OMX_COMMANDTYPE eCmd, OMX_IN OMX_U32 nParam)
+{
+    OMX_CONF_TIMEDCOMMANDTYPE eCommand = OMX_CONF_TimedCommand(eCmd);
+    OMX_CONF_TIMEDCOMPONENTTYPE *pComponent;
+    OMX_CONF_COMMANDTIMINGTYPE *pCommand;
+    OMX_U64 nNs;
+
+    if (eCommand == OMX_CONF_TIMEDCOMMANDS)
+        return;
+    if (g_OMX_CONF_hTimeoutsMutex) OMX_OSAL_MutexLock(g_OMX_CONF_hTimeoutsMutex);
+    pComponent = OMX_CONF_TimedComponent(sComponentName, OMX_FALSE);
+    pCommand = pComponent ? &pComponent->oCommands[eCommand] : NULL;
+    if (pCommand && pCommand->bPending && (pCommand->nPendingParam == nParam || pCommand->nPendingParam == OMX_ALL)) {
+        nNs = OMX_OSAL_GetTimeNs() - pCommand->nSentNs;
+        pCommand->nSamples++;
+        pCommand->nTotalNs += nNs;
+        if (nNs > pCommand->nMaxNs)
+            pCommand->nMaxNs = nNs;
+        /* a port command sent to all ports completes once for each of them */
+        if (--pCommand->nPendingCompletions == 0)
+            pCommand->bPending = OMX_FALSE;
+    }
+    if (g_OMX_CONF_hTimeoutsMutex) OMX_OSAL_MutexUnlock(g_OMX_CONF_hTimeoutsMutex);
+}
+
+void OMX_CONF_TimeoutTestBegin()
+{
+    if (g_OMX_CONF_hTimeoutsMutex) OMX_OSAL_MutexLock(g_OMX_CONF_hTimeoutsMutex);
+    g_OMX_CONF_pLastComponent = NULL;
+    g_OMX_CONF_eLastCommand = OMX_CONF_TIMEDCOMMANDS;
+    if (g_OMX_CONF_hTimeoutsMutex) OMX_OSAL_MutexUnlock(g_OMX_CONF_hTimeoutsMutex);
+}
+
+/**********************************************************************
+ * POLICY
+ **********************************************************************/
+
+/* The time in ms a wait on eCommand of pComponent needs, 0 if not known yet. */
+static OMX_U32 OMX_CONF_TimeoutLearned(OMX_CONF_TIMEDCOMPONENTTYPE *pComponent, OMX_CONF_TIMEDCOMMANDTYPE eCommand)
+{
+    OMX_CONF_COMMANDTIMINGTYPE *pCommand = &pComponent->oCommands[eCommand];
+    OMX_U64 nMs;
+
+    if (g_OMX_CONF_nCommandOverrides[eCommand])
+        return g_OMX_CONF_nCommandOverrides[eCommand];
+    if (!g_OMX_CONF_bAdaptiveTimeouts || !pComponent->bCalibrated || pCommand->nSamples < OMX_CONF_TIMEOUT_MINSAMPLES)
+        return 0;
+    nMs = pCommand->nMaxNs * OMX_CONF_TIMEOUT_SCALE / 1000000 + OMX_CONF_TIMEOUT_MARGIN;
+    return (nMs < OMX_CONF_TIMEOUT_MINIMUM) ? OMX_CONF_TIMEOUT_MINIMUM : (OMX_U32)nMs;
+}
+
+/* The wait of kind eTimeout of pComponent while eCommand is outstanding, or 
+   with none outstanding if eCommand is OMX_CONF_TIMEDCOMMANDS, in which case 
+   the test waits on something no command timing tells of, such as buffers or 
+   an end of stream, and keeps the default. Called with g_OMX_CONF_hTimeoutsMutex held. */
+static OMX_U32 OMX_CONF_TimeoutFor(OMX_CONF_TIMEOUTTYPE eTimeout, OMX_CONF_TIMEDCOMPONENTTYPE *pComponent,
+                                   OMX_CONF_TIMEDCOMMANDTYPE eCommand)
+{
+    OMX_U32 nMs = 0;
+    OMX_BOOL bOverridden = OMX_FALSE;
+
+    if (g_OMX_CONF_nTimeoutOverrides[eTimeout])
+        return g_OMX_CONF_nTimeoutOverrides[eTimeout];
+    if (!pComponent || (eTimeout != OMX_CONF_TimeoutExpectingSuccess && eTimeout != OMX_CONF_TimeoutExpectingFailure))
+        return g_OMX_CONF_nTimeoutDefaults[eTimeout];
+
+    if (eCommand != OMX_CONF_TIMEDCOMMANDS) {
+        nMs = OMX_CONF_TimeoutLearned(pComponent, eCommand);
+        bOverridden = g_OMX_CONF_nCommandOverrides[eCommand] ? OMX_TRUE : OMX_FALSE;
+    }
+    /* only the script lengthens a wait */
+    if (nMs == 0 || (nMs > g_OMX_CONF_nTimeoutDefaults[eTimeout] && !bOverridden))
+        return g_OMX_CONF_nTimeoutDefaults[eTimeout];
+    return nMs;
+}
+
+OMX_U32 OMX_CONF_Timeout(OMX_IN OMX_CONF_TIMEOUTTYPE eTimeout)
+{
+    OMX_CONF_TIMEDCOMMANDTYPE eCommand;
+    OMX_U32 nMs;
+
+    if (g_OMX_CONF_hTimeoutsMutex) OMX_OSAL_MutexLock(g_OMX_CONF_hTimeoutsMutex);
+    eCommand = g_OMX_CONF_eLastCommand;
+    /* once the command completed the test waits on something else, such as buffers */
+    if (eCommand != OMX_CONF_TIMEDCOMMANDS && !g_OMX_CONF_pLastComponent->oCommands[eCommand].bPending)
+        eCommand = OMX_CONF_TIMEDCOMMANDS;
+    nMs = OMX_CONF_TimeoutFor(eTimeout, g_OMX_CONF_pLastComponent, eCommand);
+    if (g_OMX_CONF_hTimeoutsMutex) OMX_OSAL_MutexUnlock(g_OMX_CONF_hTimeoutsMutex);
+    return nMs;
+}
+
+OMX_ERRORTYPE OMX_CONF_TimeoutSet(OMX_IN OMX_STRING sName, OMX_IN OMX_U32 nMs)
+{
+    OMX_U32 i;
+
+    if (!strcmp(sName, "adaptive")) {
+        g_OMX_CONF_bAdaptiveTimeouts = nMs ? OMX_TRUE : OMX_FALSE;
+        return OMX_ErrorNone;
+    }
+    for (i = 0; i < OMX_CONF_TIMEOUTS; i++) {
+        if (!strcmp(sName, g_OMX_CONF_sTimeoutNames[i])) {
+            g_OMX_CONF_nTimeoutOverrides[i] = nMs;
+            return OMX_ErrorNone;
+        }
+    }
+    for (i = 0; i < OMX_CONF_TIMEDCOMMANDS; i++) {
+        if (!strcmp(sName, g_OMX_CONF_sCommandNames[i])) {
+            g_OMX_CONF_nCommandOverrides[i] = nMs;
+            return OMX_ErrorNone;
+        }
+    }
+    return OMX_ErrorBadParameter;
+}
+
+void OMX_CONF_TimeoutCalibrated(OMX_IN OMX_STRING sComponentName, OMX_IN OMX_BOOL bCalibrated)
+{
+    OMX_CONF_TIMEDCOMPONENTTYPE *pComponent;
+
+    if (g_OMX_CONF_hTimeoutsMutex) OMX_OSAL_MutexLock(g_OMX_CONF_hTimeoutsMutex);
+    pComponent = OMX_CONF_TimedComponent(sComponentName, OMX_TRUE);
+    if (pComponent)
+        pComponent->bCalibrated = bCalibrated;
+    if (g_OMX_CONF_hTimeoutsMutex) OMX_OSAL_MutexUnlock(g_OMX_CONF_hTimeoutsMutex);
+}
+
+OMX_ERRORTYPE OMX_CONF_PrintTimeouts(OMX_IN OMX_STRING sComponentName)
+{
+    OMX_CONF_TIMEDCOMPONENTTYPE *pComponent;
+    OMX_CONF_COMMANDTIMINGTYPE *pCommand;
+    OMX_U32 i;
+
+    if (g_OMX_CONF_hTimeoutsMutex) OMX_OSAL_MutexLock(g_OMX_CONF_hTimeoutsMutex);
+    pComponent = sComponentName ? OMX_CONF_TimedComponent(sComponentName, OMX_FALSE) : NULL;
+    OMX_OSAL_Trace(OMX_OSAL_TRACE_INFO, "Timeouts%s%s%s:\n", pComponent ? " of " : "", pComponent ? sComponentName : "",
+                   (pComponent && pComponent->bCalibrated && g_OMX_CONF_bAdaptiveTimeouts) ? " (adapted)" : "");
+    for (i = 0; !pComponent && i < OMX_CONF_TIMEDCOMMANDS; i++) {
+        if (g_OMX_CONF_nCommandOverrides[i])
+            OMX_OSAL_Trace(OMX_OSAL_TRACE_INFO, "\t%-9s %u ms (set)\n", g_OMX_CONF_sCommandNames[i], g_OMX_CONF_nCommandOverrides[i]);
+    }
+    for (i = 0; pComponent && i < OMX_CONF_TIMEDCOMMANDS; i++) {
+        pCommand = &pComponent->oCommands[i];
+        if (!pCommand->nSamples && !g_OMX_CONF_nCommandOverrides[i])
+            continue;
+        OMX_OSAL_Trace(OMX_OSAL_TRACE_INFO, "\t%-9s completed %u times, mean %.1f ms, max %.1f ms: waits of %u ms, %u ms expecting failure\n",
+                       g_OMX_CONF_sCommandNames[i], pCommand->nSamples,
+                       pCommand->nSamples ? pCommand->nTotalNs / 1e6 / pCommand->nSamples : 0.0, pCommand->nMaxNs / 1e6,
+                       OMX_CONF_TimeoutFor(OMX_CONF_TimeoutExpectingSuccess, pComponent, (OMX_CONF_TIMEDCOMMANDTYPE)i),
+                       OMX_CONF_TimeoutFor(OMX_CONF_TimeoutExpectingFailure, pComponent, (OMX_CONF_TIMEDCOMMANDTYPE)i));
+    }
+    for (i = 0; i < OMX_CONF_TIMEOUTS; i++) {
+        OMX_OSAL_Trace(OMX_OSAL_TRACE_INFO, "\t%-9s %u ms%s\n", g_OMX_CONF_sTimeoutNames[i],
+                       OMX_CONF_TimeoutFor((OMX_CONF_TIMEOUTTYPE)i, pComponent, OMX_CONF_TIMEDCOMMANDS),
+                       g_OMX_CONF_nTimeoutOverrides[i] ? " (set)" : "");
+    }
+    if (g_OMX_CONF_hTimeoutsMutex) OMX_OSAL_MutexUnlock(g_OMX_CONF_hTimeoutsMutex);
+    return OMX_ErrorNone;
+}
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+/* File EOF */
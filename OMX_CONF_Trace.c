@@ -37,7 +37,9 @@ extern "C" {
 
 #include "OMX_OSAL_Interfaces.h"
 #include "OMX_CONF_TestHarness.h"
+#include "OMX_CONF_StubbedComponent.h"
 
+#include <stdio.h>
 #include "string.h"
 
 /**********************************************************************
@@ -47,6 +49,8 @@ extern "C" {
 OMX_U32 g_OMX_OSAL_TraceFlags = 0;
 OMX_HANDLETYPE g_OMX_CONF_hTraceMutex;
 
+static void OMX_CONF_HashNames();
+
 OMX_ERRORTYPE OMX_CONF_SetTraceflags(OMX_IN OMX_U32 nTraceFlags)
 {
     OMX_OSAL_Trace(OMX_OSAL_TRACE_INFO, "\nOMX_CONF_SetTraceFlags 0x%08x\n\n", nTraceFlags);
@@ -57,9 +61,76 @@ OMX_ERRORTYPE OMX_CONF_SetTraceflags(OMX_IN OMX_U32 nTraceFlags)
     }
 
     g_OMX_OSAL_TraceFlags = nTraceFlags;
+    OMX_CONF_HashNames();
     return OMX_ErrorNone;
 }
 
+/**********************************************************************
+ * NAME HASH - the lookup tables below, hashed once by 
+ * OMX_CONF_SetTraceflags so that the tracers name enum values 
+ * without scanning the tables.
+ **********************************************************************/
+
+#define OMX_CONF_NAMEHASHBITS 10    /* the tables hold some 220 names; a quarter full keeps probes short */
+#define OMX_CONF_NAMEHASHSLOTS (1 << OMX_CONF_NAMEHASHBITS)
+
+typedef enum OMX_CONF_NAMEKINDTYPE {
+    OMX_CONF_NameKindNone,          /* marks a free slot */
+    OMX_CONF_NameKindCommand,
+    OMX_CONF_NameKindEvent,
+    OMX_CONF_NameKindState,
+    OMX_CONF_NameKindError,
+    OMX_CONF_NameKindIndex
+} OMX_CONF_NAMEKINDTYPE;
+
+typedef struct OMX_CONF_NAMEHASHTYPE {
+    OMX_CONF_NAMEKINDTYPE eKind;
+    OMX_U32 nValue;
+    OMX_STRING sName;
+} OMX_CONF_NAMEHASHTYPE;
+
+static OMX_CONF_NAMEHASHTYPE g_OMX_CONF_NameHash[OMX_CONF_NAMEHASHSLOTS];
+static OMX_BOOL g_OMX_CONF_bNamesHashed = OMX_FALSE;
+
+static OMX_U32 OMX_CONF_NameHashSlot(OMX_CONF_NAMEKINDTYPE eKind, OMX_U32 nValue)
+{
+    return ((nValue ^ (nValue >> 16) ^ ((OMX_U32)eKind << 8)) * 0x9E3779B1U) >> (32 - OMX_CONF_NAMEHASHBITS);
+}
+
+/* Keeps the first name given to a value, as the table scans did. Fails when the hash is full. */
+static OMX_BOOL OMX_CONF_NameHashInsert(OMX_CONF_NAMEKINDTYPE eKind, OMX_U32 nValue, OMX_STRING sName)
+{
+    OMX_U32 i = OMX_CONF_NameHashSlot(eKind, nValue);
+    OMX_U32 nProbes;
+
+    for (nProbes = 0; g_OMX_CONF_NameHash[i].eKind != OMX_CONF_NameKindNone; nProbes++) {
+        if (g_OMX_CONF_NameHash[i].eKind == eKind && g_OMX_CONF_NameHash[i].nValue == nValue)
+            return OMX_TRUE;
+        if (nProbes == OMX_CONF_NAMEHASHSLOTS - 1)
+            return OMX_FALSE;
+        i = (i + 1) & (OMX_CONF_NAMEHASHSLOTS - 1);
+    }
+    g_OMX_CONF_NameHash[i].eKind = eKind;
+    g_OMX_CONF_NameHash[i].nValue = nValue;
+    g_OMX_CONF_NameHash[i].sName = sName;
+    return OMX_TRUE;
+}
+
+static OMX_ERRORTYPE OMX_CONF_NameHashCopy(OMX_CONF_NAMEKINDTYPE eKind, OMX_U32 nValue, OMX_STRING sName)
+{
+    OMX_U32 i = OMX_CONF_NameHashSlot(eKind, nValue);
+    OMX_U32 nProbes;
+
+    for (nProbes = 0; nProbes < OMX_CONF_NAMEHASHSLOTS && g_OMX_CONF_NameHash[i].eKind != OMX_CONF_NameKindNone; nProbes++) {
+        if (g_OMX_CONF_NameHash[i].eKind == eKind && g_OMX_CONF_NameHash[i].nValue == nValue) {
+            strcpy(sName, g_OMX_CONF_NameHash[i].sName);
+            return OMX_ErrorNone;
+        }
+        i = (i + 1) & (OMX_CONF_NAMEHASHSLOTS - 1);
+    }
+    return OMX_ErrorBadParameter;
+}
+
 /**********************************************************************
  * COMMAND TO STRING
  **********************************************************************/
@@ -82,6 +153,8 @@ OMX_CONF_COMMANDLOOKUPTYPE OMX_CONF_CommandLookupTable[] =
 OMX_ERRORTYPE OMX_CONF_CommandToString( OMX_IN OMX_COMMANDTYPE eCommand, OMX_OUT OMX_STRING sName)
 {
     int i;
+    if (g_OMX_CONF_bNamesHashed)
+        return OMX_CONF_NameHashCopy(OMX_CONF_NameKindCommand, (OMX_U32)eCommand, sName);
     for(i =0;i<(sizeof(OMX_CONF_CommandLookupTable)/sizeof(OMX_CONF_COMMANDLOOKUPTYPE));i++){
         if (OMX_CONF_CommandLookupTable[i].eCommand == eCommand){
             strcpy( sName, OMX_CONF_CommandLookupTable[i].sName);
@@ -113,6 +186,8 @@ OMX_CONF_EVENTLOOKUPTYPE OMX_CONF_EventLookupTable[] =
 OMX_ERRORTYPE OMX_CONF_EventToString( OMX_IN OMX_EVENTTYPE eEvent, OMX_OUT OMX_STRING sName)
 {
     int i;
+    if (g_OMX_CONF_bNamesHashed)
+        return OMX_CONF_NameHashCopy(OMX_CONF_NameKindEvent, (OMX_U32)eEvent, sName);
     for(i =0;i<(sizeof(OMX_CONF_EventLookupTable)/sizeof(OMX_CONF_EVENTLOOKUPTYPE));i++){
         if (OMX_CONF_EventLookupTable[i].eEvent == eEvent){
             strcpy( sName, OMX_CONF_EventLookupTable[i].sName);
@@ -145,6 +220,8 @@ OMX_CONF_STATELOOKUPTYPE OMX_CONF_StateLookupTable[] =
 OMX_ERRORTYPE OMX_CONF_StateToString( OMX_IN OMX_STATETYPE eState, OMX_OUT OMX_STRING sName)
 {
     int i;
+    if (g_OMX_CONF_bNamesHashed)
+        return OMX_CONF_NameHashCopy(OMX_CONF_NameKindState, (OMX_U32)eState, sName);
     for(i =0;i<(sizeof(OMX_CONF_StateLookupTable)/sizeof(OMX_CONF_STATELOOKUPTYPE));i++){
         if (OMX_CONF_StateLookupTable[i].eState == eState){
             strcpy( sName, OMX_CONF_StateLookupTable[i].sName);
@@ -208,10 +285,15 @@ OMX_CONF_ERRORLOOKUPTYPE OMX_CONF_ErrorLookupTable[] =
 OMX_ERRORTYPE OMX_CONF_ErrorToString( OMX_IN OMX_ERRORTYPE eError, OMX_OUT OMX_STRING sName)
 {
     int i;
-    for(i =0;i<(sizeof(OMX_CONF_ErrorLookupTable)/sizeof(OMX_CONF_ERRORLOOKUPTYPE));i++){
-        if (OMX_CONF_ErrorLookupTable[i].eError == eError){
-            strcpy( sName, OMX_CONF_ErrorLookupTable[i].sName);
+    if (g_OMX_CONF_bNamesHashed) {
+        if (OMX_ErrorNone == OMX_CONF_NameHashCopy(OMX_CONF_NameKindError, (OMX_U32)eError, sName))
             return OMX_ErrorNone;
+    } else {
+        for(i =0;i<(sizeof(OMX_CONF_ErrorLookupTable)/sizeof(OMX_CONF_ERRORLOOKUPTYPE));i++){
+            if (OMX_CONF_ErrorLookupTable[i].eError == eError){
+                strcpy( sName, OMX_CONF_ErrorLookupTable[i].sName);
+                return OMX_ErrorNone;
+            }
         }
     }
     strcpy( sName, "(vendor OMX_ERRORTYPE value?)");
@@ -222,21 +304,47 @@ OMX_ERRORTYPE OMX_CONF_ErrorToString( OMX_IN OMX_ERRORTYPE eError, OMX_OUT OMX_S
 #define OMX_CONF_LONG_TIMELIMIT 20
 #define OMX_CONF_NOT_TESTED_TIMELIMIT ((OMX_U32) -1)
 
-void OMX_OSAL_TraceResultAndTime(OMX_ERRORTYPE eError, OMX_U32 nMsec, OMX_U32 nMsecLimit, OMX_STRING sComp, OMX_STRING sFunc)
+/* Trace flags whose output the tracers produce around every call */
+#define OMX_CONF_TRACE_CALLFLAGS (OMX_OSAL_TRACE_CALLSEQUENCE | OMX_OSAL_TRACE_PARAMETERS | OMX_OSAL_TRACE_BUFFER)
+
+void OMX_OSAL_TraceResultAndTime(OMX_ERRORTYPE eError, OMX_U64 nNsec, OMX_U32 nMsecLimit, OMX_STRING sComp, OMX_STRING sFunc)
 {
     char sErrorName[256];
+    OMX_U32 nMsec = (OMX_U32)(nNsec / 1000000);
+    OMX_U32 nUsec = (OMX_U32)((nNsec / 1000) % 1000);
+
     if (OMX_ErrorNone == OMX_CONF_ErrorToString(eError, sErrorName)){
-        OMX_OSAL_Trace(OMX_OSAL_TRACE_CALLSEQUENCE, ") returned %s, took %i ms\n", sErrorName, nMsec);
+        OMX_OSAL_Trace(OMX_OSAL_TRACE_CALLSEQUENCE, ") returned %s, took %u.%03u ms\n", sErrorName, nMsec, nUsec);
     } else {
-        OMX_OSAL_Trace(OMX_OSAL_TRACE_CALLSEQUENCE, ") returned 0x%08x, took %i ms\n", eError, nMsec);
+        OMX_OSAL_Trace(OMX_OSAL_TRACE_CALLSEQUENCE, ") returned 0x%08x, took %u.%03u ms\n", eError, nMsec, nUsec);
     }
 
-    if (nMsec > nMsecLimit && strncmp("OMX.CONF.", sComp, 9) != 0) {
-        OMX_OSAL_Trace(OMX_OSAL_TRACE_WARNING, "Call execution of %s on %s took longer than limit: Limit=%i ms Actual=%i ms\n",
-            sFunc, sComp, nMsecLimit, nMsec );
+    if (nMsecLimit != OMX_CONF_NOT_TESTED_TIMELIMIT && nNsec > (OMX_U64)nMsecLimit * 1000000 && 
+        strncmp("OMX.CONF.", sComp, 9) != 0) {
+        OMX_OSAL_Trace(OMX_OSAL_TRACE_WARNING, "Call execution of %s on %s took longer than limit: Limit=%i ms Actual=%u.%03u ms\n",
+            sFunc, sComp, nMsecLimit, nMsec, nUsec);
     }
 }
 
+/* Whether anything uses the timing of traced calls. Without it the tracers
+   pass calls straight through. */
+static OMX_BOOL OMX_CONF_TraceTimed()
+{
+    if (g_OMX_OSAL_TraceFlags & (OMX_CONF_TRACE_CALLFLAGS | OMX_OSAL_TRACE_WARNING | OMX_OSAL_TRACE_STATISTICS | OMX_OSAL_TRACE_COUNTERS))
+        return OMX_TRUE;
+    return OMX_OSAL_EventLogActive();
+}
+
+/* Whether a traced call still has work for the trace mutex once it returned: 
+   output for nTraceFlags, or a warning about its duration. */
+static OMX_BOOL OMX_CONF_TraceWanted(OMX_U32 nTraceFlags, OMX_U64 nNsec, OMX_U32 nMsecLimit)
+{
+    if (g_OMX_OSAL_TraceFlags & nTraceFlags)
+        return OMX_TRUE;
+    return (g_OMX_OSAL_TraceFlags & OMX_OSAL_TRACE_WARNING) && nMsecLimit != OMX_CONF_NOT_TESTED_TIMELIMIT &&
+        nNsec > (OMX_U64)nMsecLimit * 1000000 ? OMX_TRUE : OMX_FALSE;
+}
+
 /**********************************************************************
  * INDEX TO STRING
  **********************************************************************/
@@ -429,6 +537,8 @@ OMX_CONF_INDEXLOOKUPTYPE OMX_CONF_IndexLookupTable[] =
 OMX_ERRORTYPE OMX_CONF_IndexToString( OMX_IN OMX_INDEXTYPE nIndex, OMX_OUT OMX_STRING sName)
 {
     int i;
+    if (g_OMX_CONF_bNamesHashed)
+        return OMX_CONF_NameHashCopy(OMX_CONF_NameKindIndex, (OMX_U32)nIndex, sName);
     for(i =0;i<(sizeof(OMX_CONF_IndexLookupTable)/sizeof(OMX_CONF_INDEXLOOKUPTYPE));i++){
         if (OMX_CONF_IndexLookupTable[i].nIndex == nIndex){
             strcpy( sName, OMX_CONF_IndexLookupTable[i].sName);
@@ -438,9 +548,30 @@ OMX_ERRORTYPE OMX_CONF_IndexToString( OMX_IN OMX_INDEXTYPE nIndex, OMX_OUT OMX_S
     return OMX_ErrorBadParameter;
 }
 
+static void OMX_CONF_HashNames()
+{
+    int i;
+    OMX_BOOL bHashed = OMX_TRUE;
+
+    if (g_OMX_CONF_bNamesHashed)
+        return;
+    for(i =0;i<(sizeof(OMX_CONF_CommandLookupTable)/sizeof(OMX_CONF_COMMANDLOOKUPTYPE));i++)
+        bHashed &= OMX_CONF_NameHashInsert(OMX_CONF_NameKindCommand, (OMX_U32)OMX_CONF_CommandLookupTable[i].eCommand, OMX_CONF_CommandLookupTable[i].sName);
+    for(i =0;i<(sizeof(OMX_CONF_EventLookupTable)/sizeof(OMX_CONF_EVENTLOOKUPTYPE));i++)
+        bHashed &= OMX_CONF_NameHashInsert(OMX_CONF_NameKindEvent, (OMX_U32)OMX_CONF_EventLookupTable[i].eEvent, OMX_CONF_EventLookupTable[i].sName);
+    for(i =0;i<(sizeof(OMX_CONF_StateLookupTable)/sizeof(OMX_CONF_STATELOOKUPTYPE));i++)
+        bHashed &= OMX_CONF_NameHashInsert(OMX_CONF_NameKindState, (OMX_U32)OMX_CONF_StateLookupTable[i].eState, OMX_CONF_StateLookupTable[i].sName);
+    for(i =0;i<(sizeof(OMX_CONF_ErrorLookupTable)/sizeof(OMX_CONF_ERRORLOOKUPTYPE));i++)
+        bHashed &= OMX_CONF_NameHashInsert(OMX_CONF_NameKindError, (OMX_U32)OMX_CONF_ErrorLookupTable[i].eError, OMX_CONF_ErrorLookupTable[i].sName);
+    for(i =0;i<(sizeof(OMX_CONF_IndexLookupTable)/sizeof(OMX_CONF_INDEXLOOKUPTYPE));i++)
+        bHashed &= OMX_CONF_NameHashInsert(OMX_CONF_NameKindIndex, (OMX_U32)OMX_CONF_IndexLookupTable[i].nIndex, OMX_CONF_IndexLookupTable[i].sName);
+    /* a name that did not fit would be missing from the hash: keep scanning the tables */
+    g_OMX_CONF_bNamesHashed = bHashed;
+}
+
 OMX_ERRORTYPE OMX_CONF_TraceBuffer(OMX_BUFFERHEADERTYPE *pHeader)
 {
-    if (!pHeader) {
+    if (!pHeader || !(g_OMX_OSAL_TraceFlags & OMX_OSAL_TRACE_BUFFER)) {
         return OMX_ErrorNone;
     }
 
@@ -469,6 +600,1038 @@ OMX_ERRORTYPE OMX_CONF_TraceBuffer(OMX_BUFFERHEADERTYPE *pHeader)
     return OMX_ErrorNone;
 }
 
+/**************************************************************
+ * EVENT LOG - timed calls and callbacks recorded by the 
+ * tracers for offline timeline analysis.
+ **************************************************************/
+
+OMX_STRING g_OMX_CONF_sTraceApiNames[OMX_CONF_TraceApiMax] =
+{
+    "GetComponentVersion",
+    "SendCommand",
+    "GetParameter",
+    "SetParameter",
+    "GetConfig",
+    "SetConfig",
+    "GetExtensionIndex",
+    "GetState",
+    "ComponentTunnelRequest",
+    "UseBuffer",
+    "AllocateBuffer",
+    "FreeBuffer",
+    "EmptyThisBuffer",
+    "FillThisBuffer",
+    "SetCallbacks",
+    "ComponentDeInit",
+    "EventHandler",
+    "EmptyBufferDone",
+    "FillBufferDone",
+    "TracerCreate",
+    "TracerDestroy"
+};
+
+static OMX_U16 g_OMX_CONF_nTraceApiIds[OMX_CONF_TraceApiMax];
+
+static void OMX_CONF_TraceApiIdsInit()
+{
+    int i;
+    if (g_OMX_CONF_nTraceApiIds[0])
+        return;
+    for (i = 0; i < OMX_CONF_TraceApiMax; i++)
+        g_OMX_CONF_nTraceApiIds[i] = OMX_OSAL_EventLogName(g_OMX_CONF_sTraceApiNames[i]);
+}
+
+/* set while the event log records call arguments for replay */
+static OMX_BOOL g_OMX_CONF_bRecordArguments = OMX_FALSE;
+
+static OMX_U16 OMX_CONF_TraceApiFlags(OMX_CONF_TRACEAPITYPE eApi)
+{
+    return (eApi >= OMX_CONF_TraceApiEventHandler && eApi <= OMX_CONF_TraceApiFillBufferDone) ? OMX_OSAL_EVENTLOG_CALLBACK : 0;
+}
+
+static void OMX_CONF_TraceEvent(OMX_U16 nNameId, OMX_CONF_TRACEAPITYPE eApi, OMX_U64 nBeginNs, OMX_U64 nNsec,
+                                OMX_PTR pBuffer, OMX_ERRORTYPE eError)
+{
+    /* recorded calls are logged with their arguments by OMX_CONF_TraceRecord */
+    if (g_OMX_CONF_bRecordArguments)
+        return;
+    OMX_OSAL_EventLogCall(nNameId, g_OMX_CONF_nTraceApiIds[eApi], OMX_CONF_TraceApiFlags(eApi),
+        nBeginNs, nBeginNs + nNsec, pBuffer, (OMX_U32)eError);
+}
+
+OMX_ERRORTYPE OMX_CONF_EventLogOpen(OMX_IN OMX_STRING sFilename, OMX_IN OMX_BOOL bRecordArguments)
+{
+    OMX_ERRORTYPE eError;
+
+    g_OMX_CONF_bRecordArguments = OMX_FALSE;
+    eError = OMX_OSAL_EventLogOpen(sFilename);
+    if (eError == OMX_ErrorNone)
+        g_OMX_CONF_bRecordArguments = bRecordArguments;
+    return eError;
+}
+
+OMX_U64 OMX_CONF_PayloadHash(OMX_IN OMX_U8 *pData, OMX_IN OMX_U32 nBytes)
+{
+    OMX_U64 nHash = 0xcbf29ce484222325ULL;  /* FNV-1a */
+    OMX_U32 i;
+
+    if (!pData || !nBytes)
+        return 0;
+    for (i = 0; i < nBytes; i++)
+        nHash = (nHash ^ pData[i]) * 0x100000001b3ULL;
+    return nHash;
+}
+
+/* Size of a parameter or config structure, which starts with its nSize. */
+static OMX_U32 OMX_CONF_StructBytes(OMX_PTR pStructure)
+{
+    return pStructure ? *(OMX_U32 *)pStructure : 0;
+}
+
+/* Fill in the recorded arguments of a call. Buffer header fields are taken as 
+   they are now, so calls that hand the buffer over are recorded before the call. */
+static void OMX_CONF_RecordArgs(OMX_CONF_RECORDEDCALLTYPE *pArgs, OMX_CONF_TRACEAPITYPE eApi, OMX_HANDLETYPE hOrigComp,
+                                OMX_BUFFERHEADERTYPE *pBuffer, OMX_U32 nArg0, OMX_U32 nArg1, OMX_U32 nArg2)
+{
+    memset(pArgs, 0, sizeof(*pArgs));
+    pArgs->nHandle = (OMX_U64)(size_t)hOrigComp;
+    pArgs->nArgs[0] = nArg0;
+    pArgs->nArgs[1] = nArg1;
+    pArgs->nArgs[2] = nArg2;
+    if (!pBuffer)
+        return;
+    pArgs->nBuffer = (OMX_U64)(size_t)pBuffer;
+    pArgs->nTimeStamp = pBuffer->nTimeStamp;
+    pArgs->nFilledLen = pBuffer->nFilledLen;
+    pArgs->nOffset = pBuffer->nOffset;
+    pArgs->nFlags = pBuffer->nFlags;
+    pArgs->nAllocLen = pBuffer->nAllocLen;
+    if (eApi == OMX_CONF_TraceApiEmptyThisBuffer || eApi == OMX_CONF_TraceApiEmptyBufferDone)
+        pArgs->nPortIndex = pBuffer->nInputPortIndex;
+    else if (eApi == OMX_CONF_TraceApiFillThisBuffer || eApi == OMX_CONF_TraceApiFillBufferDone)
+        pArgs->nPortIndex = pBuffer->nOutputPortIndex;
+    else
+        pArgs->nPortIndex = nArg0;
+    if ((eApi == OMX_CONF_TraceApiEmptyThisBuffer || eApi == OMX_CONF_TraceApiFillBufferDone) && pBuffer->pBuffer)
+        pArgs->nPayloadHash = OMX_CONF_PayloadHash(pBuffer->pBuffer + pBuffer->nOffset, pBuffer->nFilledLen);
+}
+
+/* Log a call with its recorded arguments, followed by up to OMX_CONF_RECORD_MAXDATA 
+   bytes of the structure or string it passed. */
+static void OMX_CONF_TraceRecord(OMX_U16 nNameId, OMX_CONF_TRACEAPITYPE eApi, OMX_U64 nBeginNs, OMX_U64 nNsec,
+                                 OMX_ERRORTYPE eError, OMX_CONF_RECORDEDCALLTYPE *pArgs, OMX_PTR pData, OMX_U32 nDataBytes)
+{
+    OMX_U8 aRecord[sizeof(OMX_CONF_RECORDEDCALLTYPE) + OMX_CONF_RECORD_MAXDATA];
+
+    if (nDataBytes > OMX_CONF_RECORD_MAXDATA)
+        nDataBytes = OMX_CONF_RECORD_MAXDATA;
+    memcpy(aRecord, pArgs, sizeof(OMX_CONF_RECORDEDCALLTYPE));
+    if (nDataBytes)
+        memcpy(aRecord + sizeof(OMX_CONF_RECORDEDCALLTYPE), pData, nDataBytes);
+    OMX_OSAL_EventLogCallData(nNameId, g_OMX_CONF_nTraceApiIds[eApi], OMX_CONF_TraceApiFlags(eApi),
+        nBeginNs, nBeginNs + nNsec, (OMX_PTR)(size_t)pArgs->nBuffer, (OMX_U32)eError,
+        aRecord, sizeof(OMX_CONF_RECORDEDCALLTYPE) + nDataBytes);
+}
+
+/**************************************************************
+ * LATENCY HISTOGRAMS
+ **************************************************************/
+
+#define OMX_CONF_MAXLATENCYCOMPONENTS 32
+
+typedef struct OMX_CONF_LATENCYTYPE {
+    char sComponentName[OMX_MAX_STRINGNAME_SIZE];
+    OMX_CONF_HISTOGRAMTYPE oApi[OMX_CONF_TRACE_COMPONENTAPIS];
+} OMX_CONF_LATENCYTYPE;
+
+/* latencies of destroyed tracers, guarded by g_OMX_CONF_hTraceMutex */
+static OMX_CONF_LATENCYTYPE *g_OMX_CONF_pLatencies[OMX_CONF_MAXLATENCYCOMPONENTS];
+static OMX_U32 g_OMX_CONF_nLatencies = 0;
+
+void OMX_CONF_HistogramRecord( OMX_INOUT OMX_CONF_HISTOGRAMTYPE *pHistogram, OMX_IN OMX_U64 nValue)
+{
+    OMX_U64 nSub = nValue;
+    OMX_U32 nExp = OMX_CONF_HISTOGRAM_SUBBITS;
+    OMX_U32 nBucket;
+
+    pHistogram->nCount++;
+    if (nValue > pHistogram->nMax)
+        pHistogram->nMax = nValue;
+
+    if (nValue < (1 << OMX_CONF_HISTOGRAM_SUBBITS)) {
+        nBucket = (OMX_U32)nValue;
+    } else {
+        if (nSub >> OMX_CONF_HISTOGRAM_MAXBITS)
+            nSub = ((OMX_U64)1 << OMX_CONF_HISTOGRAM_MAXBITS) - 1;
+        /* keep the top SUBBITS+1 bits, the leading one selects the power of two */
+        while (nSub >> (OMX_CONF_HISTOGRAM_SUBBITS + 1)) {
+            nSub >>= 1;
+            nExp++;
+        }
+        nBucket = ((nExp - OMX_CONF_HISTOGRAM_SUBBITS + 1) << OMX_CONF_HISTOGRAM_SUBBITS)
+                + (OMX_U32)nSub - (1 << OMX_CONF_HISTOGRAM_SUBBITS);
+    }
+    pHistogram->nBuckets[nBucket]++;
+}
+
+void OMX_CONF_HistogramMerge( OMX_INOUT OMX_CONF_HISTOGRAMTYPE *pTo, OMX_IN OMX_CONF_HISTOGRAMTYPE *pFrom)
+{
+    OMX_U32 i;
+
+    pTo->nCount += pFrom->nCount;
+    if (pFrom->nMax > pTo->nMax)
+        pTo->nMax = pFrom->nMax;
+    for (i = 0; i < OMX_CONF_HISTOGRAM_BUCKETS; i++)
+        pTo->nBuckets[i] += pFrom->nBuckets[i];
+}
+
+OMX_U64 OMX_CONF_HistogramPercentile( OMX_IN OMX_CONF_HISTOGRAMTYPE *pHistogram, OMX_IN OMX_U32 nPerMille)
+{
+    OMX_U64 nRank, nSeen = 0, nHighest;
+    OMX_U32 i, nExp;
+
+    if (!pHistogram->nCount)
+        return 0;
+    nRank = (pHistogram->nCount * nPerMille + 999) / 1000;
+    if (nRank == 0)
+        nRank = 1;
+
+    for (i = 0; i < OMX_CONF_HISTOGRAM_BUCKETS; i++) {
+        nSeen += pHistogram->nBuckets[i];
+        if (nSeen >= nRank)
+            break;
+    }
+
+    /* report the highest value that falls into the bucket */
+    if (i >= OMX_CONF_HISTOGRAM_BUCKETS - 1) {
+        return pHistogram->nMax;
+    } else if (i < (1 << OMX_CONF_HISTOGRAM_SUBBITS)) {
+        nHighest = i;
+    } else {
+        nExp = (i >> OMX_CONF_HISTOGRAM_SUBBITS) - 1;
+        nHighest = (OMX_U64)(i & ((1 << OMX_CONF_HISTOGRAM_SUBBITS) - 1)) + (1 << OMX_CONF_HISTOGRAM_SUBBITS);
+        nHighest = ((nHighest + 1) << nExp) - 1;
+    }
+    return nHighest < pHistogram->nMax ? nHighest : pHistogram->nMax;
+}
+
+/* Called with g_OMX_CONF_hTraceMutex held. */
+static void OMX_CONF_LatencyMerge(OMX_STRING sComponentName, OMX_CONF_HISTOGRAMTYPE *pApi)
+{
+    OMX_CONF_LATENCYTYPE *pLatency = NULL;
+    OMX_U32 i;
+
+    for (i = 0; i < g_OMX_CONF_nLatencies && !pLatency; i++) {
+        if (!strcmp(g_OMX_CONF_pLatencies[i]->sComponentName, sComponentName))
+            pLatency = g_OMX_CONF_pLatencies[i];
+    }
+    if (!pLatency) {
+        if (g_OMX_CONF_nLatencies == OMX_CONF_MAXLATENCYCOMPONENTS)
+            return;
+        pLatency = (OMX_CONF_LATENCYTYPE *)OMX_OSAL_Malloc(sizeof(OMX_CONF_LATENCYTYPE));
+        if (!pLatency)
+            return;
+        memset(pLatency, 0, sizeof(OMX_CONF_LATENCYTYPE));
+        strcpy(pLatency->sComponentName, sComponentName);
+        g_OMX_CONF_pLatencies[g_OMX_CONF_nLatencies++] = pLatency;
+    }
+    for (i = 0; i < OMX_CONF_TRACE_COMPONENTAPIS; i++)
+        OMX_CONF_HistogramMerge(&pLatency->oApi[i], &pApi[i]);
+}
+
+/* Record the median and p99 latency of each entry point a test called as metrics of the test. */
+static void OMX_CONF_LatencyMetrics(OMX_CONF_HISTOGRAMTYPE *pApi)
+{
+    char sMetric[64];
+    OMX_U32 i;
+
+    for (i = 0; i < OMX_CONF_TRACE_COMPONENTAPIS; i++) {
+        if (!pApi[i].nCount)
+            continue;
+        sprintf(sMetric, "%s.p50", g_OMX_CONF_sTraceApiNames[i]);
+        OMX_CONF_RecordMetric(sMetric, OMX_CONF_HistogramPercentile(&pApi[i], 500) / 1e3, "us");
+        sprintf(sMetric, "%s.p99", g_OMX_CONF_sTraceApiNames[i]);
+        OMX_CONF_RecordMetric(sMetric, OMX_CONF_HistogramPercentile(&pApi[i], 990) / 1e3, "us");
+    }
+}
+
+OMX_ERRORTYPE OMX_CONF_PrintLatencies()
+{
+    static const OMX_U32 nPerMille[] = {500, 900, 990, 999};
+    OMX_CONF_HISTOGRAMTYPE *pHistogram;
+    OMX_U64 nValue;
+    OMX_U32 i, j, k;
+
+    if (g_OMX_CONF_hTraceMutex) OMX_OSAL_MutexLock(g_OMX_CONF_hTraceMutex);
+
+    if (!g_OMX_CONF_nLatencies)
+        OMX_OSAL_Trace(OMX_OSAL_TRACE_INFO, "\nNo component calls traced yet.\n");
+    for (i = 0; i < g_OMX_CONF_nLatencies; i++) {
+        OMX_OSAL_Trace(OMX_OSAL_TRACE_INFO, "\nLatency of %s (us):\n", g_OMX_CONF_pLatencies[i]->sComponentName);
+        OMX_OSAL_Trace(OMX_OSAL_TRACE_INFO, "\t%-24s %10s %10s %10s %10s %10s %10s\n", 
+            "call", "count", "p50", "p90", "p99", "p99.9", "max");
+        for (j = 0; j < OMX_CONF_TRACE_COMPONENTAPIS; j++) {
+            pHistogram = &g_OMX_CONF_pLatencies[i]->oApi[j];
+            if (!pHistogram->nCount)
+                continue;
+            OMX_OSAL_Trace(OMX_OSAL_TRACE_INFO, "\t%-24s %10llu", g_OMX_CONF_sTraceApiNames[j], 
+                (unsigned long long)pHistogram->nCount);
+            for (k = 0; k <= sizeof(nPerMille) / sizeof(nPerMille[0]); k++) {
+                nValue = (k < sizeof(nPerMille) / sizeof(nPerMille[0])) ?
+                    OMX_CONF_HistogramPercentile(pHistogram, nPerMille[k]) : pHistogram->nMax;
+                OMX_OSAL_Trace(OMX_OSAL_TRACE_INFO, " %6llu.%03u", 
+                    (unsigned long long)(nValue / 1000), (unsigned)(nValue % 1000));
+            }
+            OMX_OSAL_Trace(OMX_OSAL_TRACE_INFO, "\n");
+        }
+    }
+
+    if (g_OMX_CONF_hTraceMutex) OMX_OSAL_MutexUnlock(g_OMX_CONF_hTraceMutex);
+    return OMX_ErrorNone;
+}
+
+/**************************************************************
+ * BUFFER TRAFFIC - correlates buffers handed to a component
+ * by EmptyThisBuffer/FillThisBuffer with their return through
+ * EmptyBufferDone/FillBufferDone. All of it runs with 
+ * g_OMX_CONF_hTraceMutex held.
+ **************************************************************/
+
+#define OMX_CONF_MAXTRACEDPORTS     8
+#define OMX_CONF_BUFFERTRACKSLOTS   4096   /* power of two */
+
+typedef struct OMX_CONF_PORTTRAFFICTYPE {
+    OMX_U32 nPortIndex;
+    OMX_BOOL bOutput;
+    OMX_U64 nBuffers;         /* completed round trips */
+    OMX_U64 nBytes;           /* nFilledLen emptied, or filled for output ports */
+    OMX_U32 nDepth;           /* buffers currently inside the component */
+    OMX_U32 nMaxDepth;
+    OMX_U64 nDepthNs;         /* integral of nDepth over time */
+    OMX_U64 nFirstNs;
+    OMX_U64 nLastNs;
+    OMX_CONF_HISTOGRAMTYPE oResidency;
+} OMX_CONF_PORTTRAFFICTYPE;
+
+typedef enum OMX_CONF_BUFFEROWNERTYPE {
+    OMX_CONF_BufferOwnerClient,
+    OMX_CONF_BufferOwnerEmpty,      /* handed to the component by EmptyThisBuffer */
+    OMX_CONF_BufferOwnerFill        /* handed to the component by FillThisBuffer */
+} OMX_CONF_BUFFEROWNERTYPE;
+
+/* Slot of a buffer header table. The traffic table uses the first group of 
+   fields, the shadow ownership table of BUFFER CHECKS the second. */
+typedef struct OMX_CONF_BUFFERTRACKTYPE {
+    OMX_BUFFERHEADERTYPE *pBuffer;  /* NULL marks a free slot */
+    OMX_CONF_PORTTRAFFICTYPE *pTraffic;
+    OMX_U32 nFilledLen;
+    OMX_U64 nSubmitNs;
+    OMX_HANDLETYPE hHolder;         /* original handle of the component it belongs to */
+    OMX_U32 nPortIndex;
+    OMX_CONF_BUFFEROWNERTYPE eOwner;
+} OMX_CONF_BUFFERTRACKTYPE;
+
+static OMX_CONF_BUFFERTRACKTYPE g_OMX_CONF_BufferTrack[OMX_CONF_BUFFERTRACKSLOTS];
+
+static OMX_U32 OMX_CONF_BufferTrackHash(OMX_BUFFERHEADERTYPE *pBuffer)
+{
+    OMX_U64 nKey = (OMX_U64)(size_t)pBuffer >> 3;
+    return (OMX_U32)((nKey * 0x9E3779B97F4A7C15ULL) >> 32) & (OMX_CONF_BUFFERTRACKSLOTS - 1);
+}
+
+/* Returns the slot of pBuffer in pTable, or the free slot it would take. */
+static OMX_CONF_BUFFERTRACKTYPE *OMX_CONF_BufferTrackFind(OMX_CONF_BUFFERTRACKTYPE *pTable, OMX_BUFFERHEADERTYPE *pBuffer)
+{
+    OMX_U32 i, n;
+
+    for (i = OMX_CONF_BufferTrackHash(pBuffer), n = 0; n < OMX_CONF_BUFFERTRACKSLOTS; 
+         i = (i + 1) & (OMX_CONF_BUFFERTRACKSLOTS - 1), n++) {
+        if (pTable[i].pBuffer == pBuffer || !pTable[i].pBuffer)
+            return &pTable[i];
+    }
+    return NULL;
+}
+
+/* Frees a slot, shifting back later entries of its probe chain so that 
+   lookups never meet a hole. */
+static void OMX_CONF_BufferTrackRemove(OMX_CONF_BUFFERTRACKTYPE *pTable, OMX_CONF_BUFFERTRACKTYPE *pSlot)
+{
+    OMX_U32 i = (OMX_U32)(pSlot - pTable), j = i, nHome;
+
+    for (;;) {
+        pTable[i].pBuffer = NULL;
+        for (;;) {
+            j = (j + 1) & (OMX_CONF_BUFFERTRACKSLOTS - 1);
+            if (!pTable[j].pBuffer)
+                return;
+            nHome = OMX_CONF_BufferTrackHash(pTable[j].pBuffer);
+            /* move j into the hole unless its home lies cyclically in (i, j] */
+            if ((i <= j) ? (i >= nHome || nHome > j) : (i >= nHome && nHome > j))
+                break;
+        }
+        pTable[i] = pTable[j];
+        i = j;
+    }
+}
+
+static void OMX_CONF_TrafficDepth(OMX_CONF_PORTTRAFFICTYPE *pTraffic, OMX_U64 nNowNs, OMX_S32 nDelta)
+{
+    if (!pTraffic->nFirstNs) {
+        pTraffic->nFirstNs = pTraffic->nLastNs = nNowNs;
+    }
+    if (nNowNs > pTraffic->nLastNs) {
+        pTraffic->nDepthNs += (OMX_U64)pTraffic->nDepth * (nNowNs - pTraffic->nLastNs);
+        pTraffic->nLastNs = nNowNs;
+    }
+    pTraffic->nDepth += nDelta;
+    if (pTraffic->nDepth > pTraffic->nMaxDepth)
+        pTraffic->nMaxDepth = pTraffic->nDepth;
+}
+
+/* Note a buffer handed to the component, before the call so that a return 
+   racing with it is seen. */
+static void OMX_CONF_BufferSubmitted(OMX_CONF_PORTTRAFFICTYPE *pPorts, OMX_BUFFERHEADERTYPE *pBuffer, OMX_BOOL bOutput)
+{
+    OMX_CONF_PORTTRAFFICTYPE *pTraffic = NULL;
+    OMX_CONF_BUFFERTRACKTYPE *pSlot;
+    OMX_U32 nPortIndex, i;
+
+    if (!pBuffer || !(g_OMX_OSAL_TraceFlags & OMX_OSAL_TRACE_STATISTICS))
+        return;
+    nPortIndex = bOutput ? pBuffer->nOutputPortIndex : pBuffer->nInputPortIndex;
+    for (i = 0; i < OMX_CONF_MAXTRACEDPORTS && !pTraffic; i++) {
+        if (!pPorts[i].nFirstNs || (pPorts[i].nPortIndex == nPortIndex && pPorts[i].bOutput == bOutput))
+            pTraffic = &pPorts[i];
+    }
+    pSlot = OMX_CONF_BufferTrackFind(g_OMX_CONF_BufferTrack, pBuffer);
+    if (!pTraffic || !pSlot)
+        return;
+
+    if (pSlot->pBuffer) {
+        /* submitted twice without a return, restart its residency */
+        OMX_CONF_TrafficDepth(pSlot->pTraffic, OMX_OSAL_GetTimeNs(), -1);
+    }
+    pTraffic->nPortIndex = nPortIndex;
+    pTraffic->bOutput = bOutput;
+    pSlot->pBuffer = pBuffer;
+    pSlot->pTraffic = pTraffic;
+    pSlot->nFilledLen = pBuffer->nFilledLen;
+    pSlot->nSubmitNs = OMX_OSAL_GetTimeNs();
+    OMX_CONF_TrafficDepth(pTraffic, pSlot->nSubmitNs, 1);
+}
+
+/* Note a buffer coming back at nNowNs. With bCompleted clear the submission 
+   failed and does not count as a round trip. */
+static void OMX_CONF_BufferReturned(OMX_BUFFERHEADERTYPE *pBuffer, OMX_U64 nNowNs, OMX_BOOL bCompleted)
+{
+    OMX_CONF_BUFFERTRACKTYPE *pSlot;
+    OMX_CONF_PORTTRAFFICTYPE *pTraffic;
+
+    if (!pBuffer || (pSlot = OMX_CONF_BufferTrackFind(g_OMX_CONF_BufferTrack, pBuffer)) == NULL || !pSlot->pBuffer)
+        return;
+
+    pTraffic = pSlot->pTraffic;
+    OMX_CONF_TrafficDepth(pTraffic, nNowNs, -1);
+    if (bCompleted) {
+        pTraffic->nBuffers++;
+        pTraffic->nBytes += pTraffic->bOutput ? pBuffer->nFilledLen : pSlot->nFilledLen;
+        OMX_CONF_HistogramRecord(&pTraffic->oResidency, nNowNs > pSlot->nSubmitNs ? nNowNs - pSlot->nSubmitNs : 0);
+    }
+    OMX_CONF_BufferTrackRemove(g_OMX_CONF_BufferTrack, pSlot);
+}
+
+/* Report the traffic of a tracer's ports and forget its buffers still in flight. */
+static void OMX_CONF_TrafficReport(OMX_STRING sComponentName, OMX_CONF_PORTTRAFFICTYPE *pPorts)
+{
+    OMX_CONF_PORTTRAFFICTYPE *pTraffic;
+    OMX_U64 nSpanNs;
+    OMX_U32 i;
+    char sMetric[64];
+
+    for (i = 0; i < OMX_CONF_BUFFERTRACKSLOTS; ) {
+        pTraffic = g_OMX_CONF_BufferTrack[i].pTraffic;
+        if (g_OMX_CONF_BufferTrack[i].pBuffer && pTraffic >= pPorts && pTraffic < pPorts + OMX_CONF_MAXTRACEDPORTS) {
+            OMX_CONF_BufferTrackRemove(g_OMX_CONF_BufferTrack, &g_OMX_CONF_BufferTrack[i]);
+            continue;   /* the shift may have refilled the slot */
+        }
+        i++;
+    }
+
+    for (i = 0; i < OMX_CONF_MAXTRACEDPORTS && pPorts[i].nFirstNs; i++) {
+        pTraffic = &pPorts[i];
+        if (!pTraffic->nBuffers)
+            continue;
+        nSpanNs = pTraffic->nLastNs - pTraffic->nFirstNs;
+        if (!nSpanNs) 
+            nSpanNs = 1;
+        OMX_OSAL_Trace(OMX_OSAL_TRACE_INFO, "Buffer traffic of %s %s port %u: %llu buffers, %llu bytes in %llu ms\n",
+            sComponentName, pTraffic->bOutput ? "output" : "input", pTraffic->nPortIndex,
+            (unsigned long long)pTraffic->nBuffers, (unsigned long long)pTraffic->nBytes, (unsigned long long)(nSpanNs / 1000000));
+        OMX_OSAL_Trace(OMX_OSAL_TRACE_INFO, "\t%.1f buffers/s, %.1f KB/s, in flight avg %.2f max %u\n",
+            pTraffic->nBuffers * 1e9 / nSpanNs, pTraffic->nBytes * 1e9 / 1024 / nSpanNs,
+            (double)pTraffic->nDepthNs / nSpanNs, pTraffic->nMaxDepth);
+        OMX_OSAL_Trace(OMX_OSAL_TRACE_INFO, "\tresidency us p50 %llu p90 %llu p99 %llu max %llu\n",
+            (unsigned long long)(OMX_CONF_HistogramPercentile(&pTraffic->oResidency, 500) / 1000),
+            (unsigned long long)(OMX_CONF_HistogramPercentile(&pTraffic->oResidency, 900) / 1000),
+            (unsigned long long)(OMX_CONF_HistogramPercentile(&pTraffic->oResidency, 990) / 1000),
+            (unsigned long long)(pTraffic->oResidency.nMax / 1000));
+
+        sprintf(sMetric, "%s%u.buffers", pTraffic->bOutput ? "out" : "in", pTraffic->nPortIndex);
+        OMX_CONF_RecordMetric(sMetric, (double)pTraffic->nBuffers, "buffers");
+        sprintf(sMetric, "%s%u.throughput", pTraffic->bOutput ? "out" : "in", pTraffic->nPortIndex);
+        OMX_CONF_RecordMetric(sMetric, pTraffic->nBytes * 1e9 / nSpanNs, "bytes/s");
+        sprintf(sMetric, "%s%u.residency.p50", pTraffic->bOutput ? "out" : "in", pTraffic->nPortIndex);
+        OMX_CONF_RecordMetric(sMetric, OMX_CONF_HistogramPercentile(&pTraffic->oResidency, 500) / 1e3, "us");
+        sprintf(sMetric, "%s%u.residency.p99", pTraffic->bOutput ? "out" : "in", pTraffic->nPortIndex);
+        OMX_CONF_RecordMetric(sMetric, OMX_CONF_HistogramPercentile(&pTraffic->oResidency, 990) / 1e3, "us");
+    }
+}
+
+/**************************************************************
+ * BUFFER CHECKS - validates every buffer header handed over 
+ * between client and component: its size, version and fill
+ * range, its port, and through a shadow ownership table that 
+ * the side handing it over holds it. A few compares and one 
+ * table lookup per buffer, so OMX_OSAL_TRACE_VALIDATE can stay
+ * on in runs where tracing each call is too costly. On a tunnel
+ * the components hand buffers to each other without the client, 
+ * which a submit from the other end of the tunnel stands for. 
+ * All of it runs with g_OMX_CONF_hTraceMutex held.
+ **************************************************************/
+
+#define OMX_CONF_BUFFERCHECKREPORTS 8   /* violations printed per tracer, later ones are only counted */
+#define OMX_CONF_BUFFERCHECKTUNNELS 64
+
+typedef enum OMX_CONF_BUFFERCHECKTYPE {
+    OMX_CONF_BufferCheckSize,
+    OMX_CONF_BufferCheckVersion,
+    OMX_CONF_BufferCheckRange,
+    OMX_CONF_BufferCheckPort,
+    OMX_CONF_BufferCheckOwner,
+    OMX_CONF_BUFFERCHECKS
+} OMX_CONF_BUFFERCHECKTYPE;
+
+static OMX_STRING g_OMX_CONF_sBufferCheckNames[OMX_CONF_BUFFERCHECKS] =
+{
+    "nSize",
+    "nVersion",
+    "nOffset + nFilledLen",
+    "port index",
+    "owner"
+};
+
+static OMX_STRING g_OMX_CONF_sBufferOwnerNames[] = { "client", "component (emptying)", "component (filling)" };
+
+typedef struct OMX_CONF_BUFFERCHECKSTYPE {
+    OMX_U64 nHeaders;       /* headers checked */
+    OMX_U32 nViolations[OMX_CONF_BUFFERCHECKS];
+    OMX_U32 nReported;
+} OMX_CONF_BUFFERCHECKSTYPE;
+
+static OMX_CONF_BUFFERTRACKTYPE g_OMX_CONF_BufferOwners[OMX_CONF_BUFFERTRACKSLOTS];
+
+typedef struct OMX_CONF_BUFFERTUNNELTYPE {
+    OMX_HANDLETYPE hComponent;      /* original handle, NULL marks a free entry */
+    OMX_U32 nPortIndex;
+    OMX_HANDLETYPE hPeer;           /* original handle of the other end, NULL if it is not traced */
+} OMX_CONF_BUFFERTUNNELTYPE;
+
+static OMX_CONF_BUFFERTUNNELTYPE g_OMX_CONF_BufferTunnels[OMX_CONF_BUFFERCHECKTUNNELS];
+
+static OMX_CONF_BUFFERTUNNELTYPE *OMX_CONF_BufferTunnel(OMX_HANDLETYPE hComponent, OMX_U32 nPortIndex)
+{
+    OMX_U32 i;
+
+    for (i = 0; hComponent && i < OMX_CONF_BUFFERCHECKTUNNELS; i++) {
+        if (g_OMX_CONF_BufferTunnels[i].hComponent == hComponent && g_OMX_CONF_BufferTunnels[i].nPortIndex == nPortIndex)
+            return &g_OMX_CONF_BufferTunnels[i];
+    }
+    return NULL;
+}
+
+/* Note that ComponentTunnelRequest tunneled nPortIndex of hComponent to hPeer, 
+   or tore the tunnel down if bTunneled is not set. */
+static void OMX_CONF_BufferTunnelSet(OMX_HANDLETYPE hComponent, OMX_U32 nPortIndex, OMX_BOOL bTunneled, OMX_HANDLETYPE hPeer)
+{
+    OMX_CONF_BUFFERTUNNELTYPE *pTunnel = OMX_CONF_BufferTunnel(hComponent, nPortIndex);
+    OMX_U32 i;
+
+    for (i = 0; !pTunnel && bTunneled && i < OMX_CONF_BUFFERCHECKTUNNELS; i++) {
+        if (!g_OMX_CONF_BufferTunnels[i].hComponent)
+            pTunnel = &g_OMX_CONF_BufferTunnels[i];
+    }
+    if (!pTunnel)
+        return;
+    pTunnel->hComponent = bTunneled ? hComponent : NULL;
+    pTunnel->nPortIndex = nPortIndex;
+    pTunnel->hPeer = hPeer;
+}
+
+static void OMX_CONF_BufferViolation(OMX_CONF_BUFFERCHECKSTYPE *pChecks, OMX_CONF_BUFFERCHECKTYPE eCheck, 
+                                     OMX_STRING sComponentName, OMX_CONF_TRACEAPITYPE eApi, 
+                                     OMX_BUFFERHEADERTYPE *pBuffer, OMX_U32 nValue, OMX_U32 nExpected)
+{
+    pChecks->nViolations[eCheck]++;
+    if (pChecks->nReported >= OMX_CONF_BUFFERCHECKREPORTS)
+        return;
+    pChecks->nReported++;
+    if (eCheck == OMX_CONF_BufferCheckOwner) {
+        OMX_OSAL_Trace(OMX_OSAL_TRACE_WARNING, "%s %s of buffer header 0x%08x held by %s\n", 
+            sComponentName, g_OMX_CONF_sTraceApiNames[eApi], pBuffer, g_OMX_CONF_sBufferOwnerNames[nValue]);
+    } else {
+        OMX_OSAL_Trace(OMX_OSAL_TRACE_WARNING, "%s %s of buffer header 0x%08x with %s %u, expected %s%u\n", 
+            sComponentName, g_OMX_CONF_sTraceApiNames[eApi], pBuffer, g_OMX_CONF_sBufferCheckNames[eCheck], nValue,
+            eCheck == OMX_CONF_BufferCheckRange ? "at most nAllocLen " : "", nExpected);
+    }
+}
+
+/* Check pBuffer as handed over by eApi: returned by UseBuffer/AllocateBuffer on
+   nPortIndex, given back by FreeBuffer, or passed by EmptyThisBuffer, 
+   FillThisBuffer, EmptyBufferDone or FillBufferDone of hComponent, the handle 
+   of the original component. Headers the tracer did not see allocated are 
+   adopted when first submitted. */
+static void OMX_CONF_BufferCheck(OMX_CONF_BUFFERCHECKSTYPE *pChecks, OMX_STRING sComponentName, OMX_CONF_TRACEAPITYPE eApi,
+                                 OMX_HANDLETYPE hComponent, OMX_BUFFERHEADERTYPE *pBuffer, OMX_U32 nPortIndex)
+{
+    OMX_CONF_BUFFERTRACKTYPE *pSlot;
+    OMX_CONF_BUFFERTUNNELTYPE *pTunnel;
+    OMX_CONF_BUFFEROWNERTYPE eOwner, eExpected;
+    OMX_BOOL bOutput, bSubmit;
+
+    if (!pBuffer)
+        return;
+    pSlot = OMX_CONF_BufferTrackFind(g_OMX_CONF_BufferOwners, pBuffer);
+
+    if (eApi == OMX_CONF_TraceApiFreeBuffer) {
+        if (pSlot && pSlot->pBuffer) {
+            /* the supplier of a tunnel frees the buffers the peer gave back to it */
+            if (pSlot->eOwner != OMX_CONF_BufferOwnerClient && !OMX_CONF_BufferTunnel(hComponent, nPortIndex))
+                OMX_CONF_BufferViolation(pChecks, OMX_CONF_BufferCheckOwner, sComponentName, eApi, pBuffer, pSlot->eOwner, 0);
+            OMX_CONF_BufferTrackRemove(g_OMX_CONF_BufferOwners, pSlot);
+        }
+        return;
+    }
+
+    pChecks->nHeaders++;
+    if (pBuffer->nSize != sizeof(OMX_BUFFERHEADERTYPE))
+        OMX_CONF_BufferViolation(pChecks, OMX_CONF_BufferCheckSize, sComponentName, eApi, pBuffer, 
+            pBuffer->nSize, sizeof(OMX_BUFFERHEADERTYPE));
+    if (pBuffer->nVersion.s.nVersionMajor != OMX_VERSION_MAJOR || pBuffer->nVersion.s.nVersionMinor != OMX_VERSION_MINOR)
+        OMX_CONF_BufferViolation(pChecks, OMX_CONF_BufferCheckVersion, sComponentName, eApi, pBuffer, 
+            pBuffer->nVersion.nVersion, (OMX_VERSION_MAJOR | (OMX_VERSION_MINOR << 8)));
+    if ((OMX_U64)pBuffer->nOffset + pBuffer->nFilledLen > pBuffer->nAllocLen)
+        OMX_CONF_BufferViolation(pChecks, OMX_CONF_BufferCheckRange, sComponentName, eApi, pBuffer, 
+            pBuffer->nOffset + pBuffer->nFilledLen, pBuffer->nAllocLen);
+
+    if (eApi == OMX_CONF_TraceApiUseBuffer || eApi == OMX_CONF_TraceApiAllocateBuffer) {
+        if (pBuffer->nInputPortIndex != nPortIndex && pBuffer->nOutputPortIndex != nPortIndex)
+            OMX_CONF_BufferViolation(pChecks, OMX_CONF_BufferCheckPort, sComponentName, eApi, pBuffer, 
+                pBuffer->nInputPortIndex, nPortIndex);
+        if (!pSlot)
+            return;
+        pSlot->pBuffer = pBuffer;
+        pSlot->hHolder = hComponent;
+        pSlot->nPortIndex = nPortIndex;
+        pSlot->eOwner = OMX_CONF_BufferOwnerClient;
+        return;
+    }
+
+    bOutput = (eApi == OMX_CONF_TraceApiFillThisBuffer || eApi == OMX_CONF_TraceApiFillBufferDone) ? OMX_TRUE : OMX_FALSE;
+    bSubmit = (eApi == OMX_CONF_TraceApiEmptyThisBuffer || eApi == OMX_CONF_TraceApiFillThisBuffer) ? OMX_TRUE : OMX_FALSE;
+    nPortIndex = bOutput ? pBuffer->nOutputPortIndex : pBuffer->nInputPortIndex;
+    eOwner = bOutput ? OMX_CONF_BufferOwnerFill : OMX_CONF_BufferOwnerEmpty;
+
+    if (!pSlot || !pSlot->pBuffer) {
+        if (!pSlot || !bSubmit)
+            return;
+        pSlot->pBuffer = pBuffer;
+        pSlot->nPortIndex = nPortIndex;
+        pSlot->eOwner = OMX_CONF_BufferOwnerClient;
+    } else if (bSubmit && pSlot->eOwner != OMX_CONF_BufferOwnerClient &&
+               (pTunnel = OMX_CONF_BufferTunnel(hComponent, nPortIndex)) != NULL &&
+               (!pTunnel->hPeer || pTunnel->hPeer == pSlot->hHolder)) {
+        /* handed over by the other end of the tunnel, or by an end the tracers do not see */
+        pSlot->nPortIndex = nPortIndex;
+        pSlot->eOwner = eOwner;
+        pSlot->hHolder = hComponent;
+        return;
+    } else if (pSlot->nPortIndex != nPortIndex) {
+        OMX_CONF_BufferViolation(pChecks, OMX_CONF_BufferCheckPort, sComponentName, eApi, pBuffer, nPortIndex, pSlot->nPortIndex);
+    }
+
+    /* a buffer is submitted by the client and returned by the component holding it */
+    eExpected = bSubmit ? OMX_CONF_BufferOwnerClient : eOwner;
+    if (pSlot->eOwner != eExpected || (!bSubmit && pSlot->hHolder != hComponent))
+        OMX_CONF_BufferViolation(pChecks, OMX_CONF_BufferCheckOwner, sComponentName, eApi, pBuffer, pSlot->eOwner, 0);
+    pSlot->eOwner = bSubmit ? eOwner : OMX_CONF_BufferOwnerClient;
+    if (bSubmit)
+        pSlot->hHolder = hComponent;
+}
+
+/* OMX_CONF_BufferCheck for calls that do not take g_OMX_CONF_hTraceMutex anyway. */
+static void OMX_CONF_ValidateBuffer(OMX_CONF_BUFFERCHECKSTYPE *pChecks, OMX_STRING sComponentName, OMX_CONF_TRACEAPITYPE eApi,
+                                    OMX_HANDLETYPE hComponent, OMX_BUFFERHEADERTYPE *pBuffer, OMX_U32 nPortIndex)
+{
+    if (!(g_OMX_OSAL_TraceFlags & OMX_OSAL_TRACE_VALIDATE))
+        return;
+    if (g_OMX_CONF_hTraceMutex) OMX_OSAL_MutexLock(g_OMX_CONF_hTraceMutex);
+    OMX_CONF_BufferCheck(pChecks, sComponentName, eApi, hComponent, pBuffer, nPortIndex);
+    if (g_OMX_CONF_hTraceMutex) OMX_OSAL_MutexUnlock(g_OMX_CONF_hTraceMutex);
+}
+
+/* The component refused a submitted buffer, so the client still holds it. */
+static void OMX_CONF_BufferRefused(OMX_BUFFERHEADERTYPE *pBuffer)
+{
+    OMX_CONF_BUFFERTRACKTYPE *pSlot;
+
+    if (!pBuffer || !(g_OMX_OSAL_TraceFlags & OMX_OSAL_TRACE_VALIDATE))
+        return;
+    if (g_OMX_CONF_hTraceMutex) OMX_OSAL_MutexLock(g_OMX_CONF_hTraceMutex);
+    pSlot = OMX_CONF_BufferTrackFind(g_OMX_CONF_BufferOwners, pBuffer);
+    if (pSlot && pSlot->pBuffer)
+        pSlot->eOwner = OMX_CONF_BufferOwnerClient;
+    if (g_OMX_CONF_hTraceMutex) OMX_OSAL_MutexUnlock(g_OMX_CONF_hTraceMutex);
+}
+
+/* Report the violations a tracer counted. With hComponent set also forget the 
+   headers and tunnels of that component, which is going away. */
+static void OMX_CONF_BufferCheckReport(OMX_STRING sComponentName, OMX_STRING sSide, OMX_CONF_BUFFERCHECKSTYPE *pChecks, 
+                                       OMX_HANDLETYPE hComponent)
+{
+    OMX_U32 i, nViolations = 0;
+
+    for (i = 0; hComponent && i < OMX_CONF_BUFFERTRACKSLOTS; ) {
+        if (g_OMX_CONF_BufferOwners[i].pBuffer && g_OMX_CONF_BufferOwners[i].hHolder == hComponent) {
+            OMX_CONF_BufferTrackRemove(g_OMX_CONF_BufferOwners, &g_OMX_CONF_BufferOwners[i]);
+            continue;   /* the shift may have refilled the slot */
+        }
+        i++;
+    }
+    for (i = 0; hComponent && i < OMX_CONF_BUFFERCHECKTUNNELS; i++) {
+        if (g_OMX_CONF_BufferTunnels[i].hComponent == hComponent)
+            g_OMX_CONF_BufferTunnels[i].hComponent = NULL;
+        else if (g_OMX_CONF_BufferTunnels[i].hPeer == hComponent)
+            g_OMX_CONF_BufferTunnels[i].hPeer = NULL;
+    }
+
+    if (!pChecks->nHeaders)
+        return;
+    for (i = 0; i < OMX_CONF_BUFFERCHECKS; i++)
+        nViolations += pChecks->nViolations[i];
+    OMX_OSAL_Trace(nViolations ? OMX_OSAL_TRACE_WARNING : OMX_OSAL_TRACE_INFO, 
+        "Buffer header checks of %s %s: %llu headers, %u violations\n", 
+        sComponentName, sSide, (unsigned long long)pChecks->nHeaders, nViolations);
+    for (i = 0; i < OMX_CONF_BUFFERCHECKS; i++) {
+        if (pChecks->nViolations[i])
+            OMX_OSAL_Trace(OMX_OSAL_TRACE_WARNING, "\t%s: %u\n", g_OMX_CONF_sBufferCheckNames[i], pChecks->nViolations[i]);
+    }
+}
+
+/**************************************************************
+ * CALLBACK THREADS - which threads deliver the callbacks of a
+ * component, whether they re-enter the IL client from inside
+ * one of its IL calls and how long the client keeps them.
+ **************************************************************/
+
+#define OMX_CONF_MAXILCALLTHREADS 32
+#define OMX_CONF_MAXCALLBACKTHREADS 16
+#define OMX_CONF_CALLBACKAPIS 3
+
+typedef struct OMX_CONF_ILCALLTYPE {
+    OMX_U32 nThreadId;
+    OMX_U32 nDepth;
+} OMX_CONF_ILCALLTYPE;
+
+/* threads inside a traced IL call, guarded by g_OMX_CONF_hTraceMutex */
+static OMX_CONF_ILCALLTYPE g_OMX_CONF_ILCalls[OMX_CONF_MAXILCALLTHREADS];
+
+typedef struct OMX_CONF_CALLBACKTHREADTYPE {
+    OMX_U32 nThreadId;
+    OMX_U32 nCallbacks[OMX_CONF_CALLBACKAPIS];
+    OMX_U32 nReentrant;
+    OMX_U64 nCallbackNs;
+    OMX_U64 nMaxNs;
+    OMX_BOOL bSwitches;
+    OMX_U64 nCallbackVoluntary;    /* context switches while in callbacks */
+    OMX_U64 nCallbackInvoluntary;
+    OMX_U64 nFirstVoluntary;       /* context switch counts before the first callback */
+    OMX_U64 nFirstInvoluntary;
+    OMX_U64 nLastVoluntary;        /* and after the latest one */
+    OMX_U64 nLastInvoluntary;
+} OMX_CONF_CALLBACKTHREADTYPE;
+
+typedef struct OMX_CONF_CALLBACKTHREADSTYPE {
+    OMX_CONF_CALLBACKTHREADTYPE oThreads[OMX_CONF_MAXCALLBACKTHREADS];
+    OMX_U32 nThreads;
+    OMX_U32 nUntracked;            /* callbacks on threads beyond the table */
+    OMX_CONF_HISTOGRAMTYPE oDuration[OMX_CONF_CALLBACKAPIS];
+} OMX_CONF_CALLBACKTHREADSTYPE;
+
+/* State of the delivering thread taken before a callback */
+typedef struct OMX_CONF_CALLBACKSAMPLETYPE {
+    OMX_U32 nThreadId;
+    OMX_BOOL bSwitches;
+    OMX_U64 nVoluntary;
+    OMX_U64 nInvoluntary;
+} OMX_CONF_CALLBACKSAMPLETYPE;
+
+/* Mark the calling thread as inside an IL call of the client. Returns whether 
+   OMX_CONF_ILCallLeave has to undo it. */
+static OMX_BOOL OMX_CONF_ILCallEnter()
+{
+    OMX_U32 nThreadId, nFree, i;
+
+    if (!(g_OMX_OSAL_TraceFlags & OMX_OSAL_TRACE_STATISTICS))
+        return OMX_FALSE;
+    nThreadId = OMX_OSAL_GetThreadId();
+    nFree = OMX_CONF_MAXILCALLTHREADS;
+    if (g_OMX_CONF_hTraceMutex) OMX_OSAL_MutexLock(g_OMX_CONF_hTraceMutex);
+    for (i = 0; i < OMX_CONF_MAXILCALLTHREADS; i++) {
+        if (g_OMX_CONF_ILCalls[i].nDepth && g_OMX_CONF_ILCalls[i].nThreadId == nThreadId)
+            break;
+        if (!g_OMX_CONF_ILCalls[i].nDepth && nFree == OMX_CONF_MAXILCALLTHREADS)
+            nFree = i;
+    }
+    if (i == OMX_CONF_MAXILCALLTHREADS)
+        i = nFree;
+    if (i < OMX_CONF_MAXILCALLTHREADS) {
+        g_OMX_CONF_ILCalls[i].nThreadId = nThreadId;
+        g_OMX_CONF_ILCalls[i].nDepth++;
+    }
+    if (g_OMX_CONF_hTraceMutex) OMX_OSAL_MutexUnlock(g_OMX_CONF_hTraceMutex);
+    return i < OMX_CONF_MAXILCALLTHREADS ? OMX_TRUE : OMX_FALSE;
+}
+
+static void OMX_CONF_ILCallLeave(OMX_BOOL bEntered)
+{
+    OMX_U32 nThreadId, i;
+
+    if (!bEntered)
+        return;
+    nThreadId = OMX_OSAL_GetThreadId();
+    if (g_OMX_CONF_hTraceMutex) OMX_OSAL_MutexLock(g_OMX_CONF_hTraceMutex);
+    for (i = 0; i < OMX_CONF_MAXILCALLTHREADS; i++) {
+        if (g_OMX_CONF_ILCalls[i].nDepth && g_OMX_CONF_ILCalls[i].nThreadId == nThreadId) {
+            g_OMX_CONF_ILCalls[i].nDepth--;
+            break;
+        }
+    }
+    if (g_OMX_CONF_hTraceMutex) OMX_OSAL_MutexUnlock(g_OMX_CONF_hTraceMutex);
+}
+
+/* Called with g_OMX_CONF_hTraceMutex held. */
+static OMX_BOOL OMX_CONF_InILCall(OMX_U32 nThreadId)
+{
+    OMX_U32 i;
+
+    for (i = 0; i < OMX_CONF_MAXILCALLTHREADS; i++) {
+        if (g_OMX_CONF_ILCalls[i].nDepth && g_OMX_CONF_ILCalls[i].nThreadId == nThreadId)
+            return OMX_TRUE;
+    }
+    return OMX_FALSE;
+}
+
+static void OMX_CONF_CallbackBegin(OMX_CONF_CALLBACKSAMPLETYPE *pSample)
+{
+    pSample->nThreadId = 0;
+    if (!(g_OMX_OSAL_TraceFlags & OMX_OSAL_TRACE_STATISTICS))
+        return;
+    pSample->nThreadId = OMX_OSAL_GetThreadId();
+    pSample->bSwitches = OMX_OSAL_GetThreadSwitches(pSample->nThreadId, &pSample->nVoluntary, &pSample->nInvoluntary) == OMX_ErrorNone ? OMX_TRUE : OMX_FALSE;
+}
+
+static void OMX_CONF_CallbackEnd(OMX_CONF_CALLBACKTHREADSTYPE *pStats, OMX_CONF_TRACEAPITYPE eApi, 
+                                 OMX_CONF_CALLBACKSAMPLETYPE *pSample, OMX_U64 nNsec)
+{
+    OMX_CONF_CALLBACKTHREADTYPE *pThread;
+    OMX_U64 nVoluntary = 0, nInvoluntary = 0;
+    OMX_BOOL bSwitches;
+    OMX_U32 i;
+
+    if (!pSample->nThreadId)
+        return;
+    bSwitches = pSample->bSwitches && 
+        OMX_OSAL_GetThreadSwitches(pSample->nThreadId, &nVoluntary, &nInvoluntary) == OMX_ErrorNone ? OMX_TRUE : OMX_FALSE;
+
+    if (g_OMX_CONF_hTraceMutex) OMX_OSAL_MutexLock(g_OMX_CONF_hTraceMutex);
+    OMX_CONF_HistogramRecord(&pStats->oDuration[eApi - OMX_CONF_TraceApiEventHandler], nNsec);
+    for (i = 0; i < pStats->nThreads && pStats->oThreads[i].nThreadId != pSample->nThreadId; i++)
+        ;
+    if (i == OMX_CONF_MAXCALLBACKTHREADS) {
+        pStats->nUntracked++;
+    } else {
+        pThread = &pStats->oThreads[i];
+        if (i == pStats->nThreads) {
+            pStats->nThreads++;
+            pThread->nThreadId = pSample->nThreadId;
+            pThread->bSwitches = bSwitches;
+            pThread->nFirstVoluntary = pSample->nVoluntary;
+            pThread->nFirstInvoluntary = pSample->nInvoluntary;
+        }
+        pThread->nCallbacks[eApi - OMX_CONF_TraceApiEventHandler]++;
+        if (OMX_CONF_InILCall(pSample->nThreadId))
+            pThread->nReentrant++;
+        pThread->nCallbackNs += nNsec;
+        if (nNsec > pThread->nMaxNs)
+            pThread->nMaxNs = nNsec;
+        if (bSwitches && pThread->bSwitches) {
+            pThread->nCallbackVoluntary += nVoluntary - pSample->nVoluntary;
+            pThread->nCallbackInvoluntary += nInvoluntary - pSample->nInvoluntary;
+            pThread->nLastVoluntary = nVoluntary;
+            pThread->nLastInvoluntary = nInvoluntary;
+        }
+    }
+    if (g_OMX_CONF_hTraceMutex) OMX_OSAL_MutexUnlock(g_OMX_CONF_hTraceMutex);
+}
+
+/* Called with g_OMX_CONF_hTraceMutex held. */
+static void OMX_CONF_CallbackThreadReport(OMX_STRING sComponentName, OMX_CONF_CALLBACKTHREADSTYPE *pStats)
+{
+    OMX_CONF_CALLBACKTHREADTYPE *pThread;
+    OMX_U64 nVoluntary, nInvoluntary;
+    OMX_U32 nCallbacks, nReentrant = 0;
+    OMX_U32 i;
+
+    if (!pStats->nThreads)
+        return;
+    for (i = 0; i < pStats->nThreads; i++)
+        nReentrant += pStats->oThreads[i].nReentrant;
+    OMX_OSAL_Trace(OMX_OSAL_TRACE_INFO, "Callback threads of %s: %u thread%s, %u callbacks re-entered an IL call\n",
+        sComponentName, pStats->nThreads, pStats->nThreads == 1 ? "" : "s", nReentrant);
+
+    for (i = 0; i < pStats->nThreads; i++) {
+        pThread = &pStats->oThreads[i];
+        nCallbacks = pThread->nCallbacks[0] + pThread->nCallbacks[1] + pThread->nCallbacks[2];
+        OMX_OSAL_Trace(OMX_OSAL_TRACE_INFO, "\tthread %u: %u EventHandler, %u EmptyBufferDone, %u FillBufferDone, %u re-entrant\n",
+            pThread->nThreadId, pThread->nCallbacks[0], pThread->nCallbacks[1], pThread->nCallbacks[2], pThread->nReentrant);
+        OMX_OSAL_Trace(OMX_OSAL_TRACE_INFO, "\t\tin callbacks %llu us, avg %llu us, max %llu us\n",
+            (unsigned long long)(pThread->nCallbackNs / 1000), (unsigned long long)(pThread->nCallbackNs / nCallbacks / 1000),
+            (unsigned long long)(pThread->nMaxNs / 1000));
+        if (!pThread->bSwitches)
+            continue;
+        /* a thread that has exited keeps the counts after its latest callback */
+        if (OMX_OSAL_GetThreadSwitches(pThread->nThreadId, &nVoluntary, &nInvoluntary) != OMX_ErrorNone) {
+            nVoluntary = pThread->nLastVoluntary;
+            nInvoluntary = pThread->nLastInvoluntary;
+        }
+        OMX_OSAL_Trace(OMX_OSAL_TRACE_INFO, "\t\tcontext switches in callbacks %llu voluntary %llu involuntary, since the first callback %llu voluntary %llu involuntary\n",
+            (unsigned long long)pThread->nCallbackVoluntary, (unsigned long long)pThread->nCallbackInvoluntary,
+            (unsigned long long)(nVoluntary - pThread->nFirstVoluntary), (unsigned long long)(nInvoluntary - pThread->nFirstInvoluntary));
+    }
+    if (pStats->nUntracked)
+        OMX_OSAL_Trace(OMX_OSAL_TRACE_INFO, "\t%u callbacks on further threads\n", pStats->nUntracked);
+
+    for (i = 0; i < OMX_CONF_CALLBACKAPIS; i++) {
+        if (!pStats->oDuration[i].nCount)
+            continue;
+        OMX_OSAL_Trace(OMX_OSAL_TRACE_INFO, "\t%s us p50 %llu p99 %llu max %llu\n",
+            g_OMX_CONF_sTraceApiNames[OMX_CONF_TraceApiEventHandler + i],
+            (unsigned long long)(OMX_CONF_HistogramPercentile(&pStats->oDuration[i], 500) / 1000),
+            (unsigned long long)(OMX_CONF_HistogramPercentile(&pStats->oDuration[i], 990) / 1000),
+            (unsigned long long)(pStats->oDuration[i].nMax / 1000));
+    }
+}
+
+/**************************************************************
+ * COUNTERS - performance counters read around each test, and
+ * with OMX_OSAL_TRACE_COUNTERS set around each call into a 
+ * traced component on the calling thread.
+ **************************************************************/
+
+typedef struct OMX_CONF_CALLCOUNTERSTYPE {
+    OMX_U64 nCalls;
+    OMX_U32 nValid;
+    OMX_U64 nValue[OMX_OSAL_COUNTERS];
+} OMX_CONF_CALLCOUNTERSTYPE;
+
+static void OMX_CONF_CallCountersBegin(OMX_OSAL_COUNTERSTYPE *pBegin)
+{
+    pBegin->nValid = 0;
+    if (g_OMX_OSAL_TraceFlags & OMX_OSAL_TRACE_COUNTERS)
+        OMX_OSAL_CountersRead(OMX_TRUE, pBegin);
+}
+
+static void OMX_CONF_CallCountersEnd(OMX_CONF_CALLCOUNTERSTYPE *pTotals, OMX_OSAL_COUNTERSTYPE *pBegin)
+{
+    OMX_OSAL_COUNTERSTYPE oEnd;
+    OMX_U32 i;
+
+    if (!pBegin->nValid)
+        return;
+    OMX_OSAL_CountersRead(OMX_TRUE, &oEnd);
+    if (g_OMX_CONF_hTraceMutex) OMX_OSAL_MutexLock(g_OMX_CONF_hTraceMutex);
+    pTotals->nCalls++;
+    pTotals->nValid |= pBegin->nValid & oEnd.nValid;
+    for (i = 0; i < OMX_OSAL_COUNTERS; i++) {
+        if ((pBegin->nValid & oEnd.nValid & (1 << i)) && oEnd.nValue[i] > pBegin->nValue[i])
+            pTotals->nValue[i] += oEnd.nValue[i] - pBegin->nValue[i];
+    }
+    if (g_OMX_CONF_hTraceMutex) OMX_OSAL_MutexUnlock(g_OMX_CONF_hTraceMutex);
+}
+
+/* Report the average counters per call of each entry point of a tracer. 
+   Called with g_OMX_CONF_hTraceMutex held. */
+static void OMX_CONF_CallCountersReport(OMX_STRING sComponentName, OMX_CONF_CALLCOUNTERSTYPE *pTotals)
+{
+    OMX_CONF_CALLCOUNTERSTYPE *pApi;
+    OMX_U32 i;
+    OMX_BOOL bHeader = OMX_FALSE;
+
+    for (i = 0; i < OMX_CONF_TRACE_COMPONENTAPIS; i++) {
+        pApi = &pTotals[i];
+        if (!pApi->nCalls)
+            continue;
+        if (!bHeader) {
+            OMX_OSAL_Trace(OMX_OSAL_TRACE_INFO, "Counters per call of %s on the calling thread:\n", sComponentName);
+            bHeader = OMX_TRUE;
+        }
+        OMX_OSAL_Trace(OMX_OSAL_TRACE_INFO, "\t%-22s %8llu calls, cpu %llu ns, %llu voluntary and %llu involuntary switches per 1000 calls\n",
+            g_OMX_CONF_sTraceApiNames[i], (unsigned long long)pApi->nCalls,
+            (unsigned long long)(pApi->nValue[OMX_OSAL_CounterCpuNs] / pApi->nCalls),
+            (unsigned long long)(pApi->nValue[OMX_OSAL_CounterVoluntarySwitches] * 1000 / pApi->nCalls),
+            (unsigned long long)(pApi->nValue[OMX_OSAL_CounterInvoluntarySwitches] * 1000 / pApi->nCalls));
+        if (pApi->nValid & (1 << OMX_OSAL_CounterCycles)) {
+            OMX_OSAL_Trace(OMX_OSAL_TRACE_INFO, "\t%-22s cycles %llu, instructions %llu, cache misses %llu, branch misses %llu\n", "",
+                (unsigned long long)(pApi->nValue[OMX_OSAL_CounterCycles] / pApi->nCalls),
+                (unsigned long long)(pApi->nValue[OMX_OSAL_CounterInstructions] / pApi->nCalls),
+                (unsigned long long)(pApi->nValue[OMX_OSAL_CounterCacheMisses] / pApi->nCalls),
+                (unsigned long long)(pApi->nValue[OMX_OSAL_CounterBranchMisses] / pApi->nCalls));
+        }
+    }
+}
+
+void OMX_CONF_PrintCounters( OMX_IN OMX_STRING sWhat, OMX_IN OMX_OSAL_COUNTERSTYPE *pBegin, 
+                             OMX_IN OMX_OSAL_COUNTERSTYPE *pEnd, OMX_IN OMX_U64 nWallNs)
+{
+    OMX_U64 nDelta[OMX_OSAL_COUNTERS];
+    OMX_U32 nValid = pBegin->nValid & pEnd->nValid;
+    OMX_U32 i;
+
+    for (i = 0; i < OMX_OSAL_COUNTERS; i++)
+        nDelta[i] = ((nValid & (1 << i)) && pEnd->nValue[i] > pBegin->nValue[i]) ? pEnd->nValue[i] - pBegin->nValue[i] : 0;
+    if (!nWallNs)
+        nWallNs = 1;
+
+    if (nValid & (1 << OMX_OSAL_CounterCpuNs)) {
+        /* CPU time of all threads against wall time: well below one CPU means the test mostly waited */
+        OMX_OSAL_Trace(OMX_OSAL_TRACE_INFO, "Counters of %s: wall %llu.%03llu ms, cpu %llu.%03llu ms (%.0f%%), %s\n", sWhat,
+            (unsigned long long)(nWallNs / 1000000), (unsigned long long)(nWallNs / 1000 % 1000),
+            (unsigned long long)(nDelta[OMX_OSAL_CounterCpuNs] / 1000000), (unsigned long long)(nDelta[OMX_OSAL_CounterCpuNs] / 1000 % 1000),
+            nDelta[OMX_OSAL_CounterCpuNs] * 100.0 / nWallNs,
+            nDelta[OMX_OSAL_CounterCpuNs] * 2 >= nWallNs ? "CPU-bound" : "wait-bound");
+        OMX_OSAL_Trace(OMX_OSAL_TRACE_INFO, "\tcontext switches %llu voluntary, %llu involuntary, page faults %llu\n",
+            (unsigned long long)nDelta[OMX_OSAL_CounterVoluntarySwitches], 
+            (unsigned long long)nDelta[OMX_OSAL_CounterInvoluntarySwitches],
+            (unsigned long long)nDelta[OMX_OSAL_CounterPageFaults]);
+    }
+    if ((nValid & (1 << OMX_OSAL_CounterCycles)) && (nValid & (1 << OMX_OSAL_CounterInstructions))) {
+        OMX_OSAL_Trace(OMX_OSAL_TRACE_INFO, "\tcycles %llu, instructions %llu (IPC %.2f), cache misses %llu, branch misses %llu\n",
+            (unsigned long long)nDelta[OMX_OSAL_CounterCycles], (unsigned long long)nDelta[OMX_OSAL_CounterInstructions],
+            nDelta[OMX_OSAL_CounterCycles] ? (double)nDelta[OMX_OSAL_CounterInstructions] / nDelta[OMX_OSAL_CounterCycles] : 0.0,
+            (unsigned long long)nDelta[OMX_OSAL_CounterCacheMisses], (unsigned long long)nDelta[OMX_OSAL_CounterBranchMisses]);
+    }
+}
+
 /**************************************************************
  * COMPONENT TRACER - wraps an existing component structure
  * with functions that trace calls, parameters, and return
@@ -478,8 +1641,23 @@ OMX_ERRORTYPE OMX_CONF_TraceBuffer(OMX_BUFFERHEADERTYPE *pHeader)
 typedef struct OMX_CONF_COMPTRACERDATATYPE {
     OMX_PTR pOrigComponent;
     char sComponentName[OMX_MAX_STRINGNAME_SIZE];
+    OMX_U16 nNameId;
+    OMX_CONF_HISTOGRAMTYPE oLatency[OMX_CONF_TRACE_COMPONENTAPIS];
+    OMX_CONF_PORTTRAFFICTYPE oTraffic[OMX_CONF_MAXTRACEDPORTS];
+    OMX_CONF_BUFFERCHECKSTYPE oChecks;
+    OMX_CONF_CALLCOUNTERSTYPE oCounters[OMX_CONF_TRACE_COMPONENTAPIS];
+    OMX_BOOL bParametersSet;    /* port definitions may differ from the topology snapshot */
 } OMX_CONF_COMPTRACERDATATYPE;
 
+/* Called with g_OMX_CONF_hTraceMutex held. */
+static void OMX_CONF_TraceLatency(OMX_HANDLETYPE hComponent, OMX_CONF_TRACEAPITYPE eApi, OMX_U64 nNsec)
+{
+    OMX_CONF_COMPTRACERDATATYPE *pTracerData = (OMX_CONF_COMPTRACERDATATYPE *)((OMX_COMPONENTTYPE *)hComponent)->pApplicationPrivate;
+    if (!(g_OMX_OSAL_TraceFlags & OMX_OSAL_TRACE_STATISTICS))
+        return;
+    OMX_CONF_HistogramRecord(&pTracerData->oLatency[eApi], nNsec);
+}
+
 /* Wrapper functions */
 
 OMX_ERRORTYPE Trace_GetComponentVersion(
@@ -489,15 +1667,32 @@ OMX_ERRORTYPE Trace_GetComponentVersion(
         OMX_OUT OMX_VERSIONTYPE* pSpecVersion,
         OMX_OUT OMX_UUIDTYPE* pComponentUUID)
 {
+    OMX_CONF_COMPTRACERDATATYPE *pTracerData = (OMX_CONF_COMPTRACERDATATYPE *)((OMX_COMPONENTTYPE *)hComponent)->pApplicationPrivate;
     OMX_ERRORTYPE eError;
     OMX_COMPONENTTYPE *pComp;
-    OMX_U32 nMsec;
-    OMX_STRING sCompName = ((OMX_CONF_COMPTRACERDATATYPE *)(((OMX_COMPONENTTYPE *)hComponent)->pApplicationPrivate))->sComponentName;
-
-    pComp = ((OMX_CONF_COMPTRACERDATATYPE *)(((OMX_COMPONENTTYPE *)hComponent)->pApplicationPrivate))->pOrigComponent;
-    nMsec = OMX_OSAL_GetTime();
+    OMX_U64 nBeginNs, nNsec;
+    OMX_BOOL bInCall;
+    OMX_OSAL_COUNTERSTYPE oCounters;
+    OMX_CONF_RECORDEDCALLTYPE oArgs;
+    OMX_STRING sCompName = pTracerData->sComponentName;
+
+    pComp = pTracerData->pOrigComponent;
+    if (!OMX_CONF_TraceTimed())
+        return pComp->GetComponentVersion((OMX_HANDLETYPE)pComp, pComponentName, pComponentVersion, pSpecVersion, pComponentUUID);
+    bInCall = OMX_CONF_ILCallEnter();
+    OMX_CONF_CallCountersBegin(&oCounters);
+    nBeginNs = OMX_OSAL_GetTimeNs();
     eError = pComp->GetComponentVersion((OMX_HANDLETYPE)pComp, pComponentName, pComponentVersion, pSpecVersion, pComponentUUID);
-    nMsec = OMX_OSAL_GetTime() - nMsec;
+    nNsec = OMX_OSAL_GetTimeNs() - nBeginNs;
+    OMX_CONF_ILCallLeave(bInCall);
+    OMX_CONF_CallCountersEnd(&pTracerData->oCounters[OMX_CONF_TraceApiGetComponentVersion], &oCounters);
+    OMX_CONF_TraceEvent(pTracerData->nNameId, OMX_CONF_TraceApiGetComponentVersion, nBeginNs, nNsec, NULL, eError);
+    if (g_OMX_CONF_bRecordArguments) {
+        OMX_CONF_RecordArgs(&oArgs, OMX_CONF_TraceApiGetComponentVersion, pComp, NULL, 0, 0, 0);
+        OMX_CONF_TraceRecord(pTracerData->nNameId, OMX_CONF_TraceApiGetComponentVersion, nBeginNs, nNsec, eError, &oArgs, NULL, 0);
+    }
+    if (!OMX_CONF_TraceWanted(OMX_CONF_TRACE_CALLFLAGS | OMX_OSAL_TRACE_STATISTICS, nNsec, OMX_CONF_SHORT_TIMELIMIT))
+        return eError;
 
     if (g_OMX_CONF_hTraceMutex) OMX_OSAL_MutexLock(g_OMX_CONF_hTraceMutex);
 
@@ -508,69 +1703,115 @@ OMX_ERRORTYPE Trace_GetComponentVersion(
     OMX_OSAL_Trace(OMX_OSAL_TRACE_PARAMETERS, "\n\tpComponentVersion = %s", pComponentVersion);
     OMX_OSAL_Trace(OMX_OSAL_TRACE_PARAMETERS, "\n\tpSpecVersion = %s", pSpecVersion);
     OMX_OSAL_Trace(OMX_OSAL_TRACE_PARAMETERS, "\n\tpComponentUUID = %s", pComponentUUID);
-    OMX_OSAL_TraceResultAndTime(eError,nMsec,OMX_CONF_SHORT_TIMELIMIT, sCompName, "GetComponentVersion");
+    OMX_CONF_TraceLatency(hComponent, OMX_CONF_TraceApiGetComponentVersion, nNsec);
+    OMX_OSAL_TraceResultAndTime(eError,nNsec,OMX_CONF_SHORT_TIMELIMIT, sCompName, "GetComponentVersion");
 
     if (g_OMX_CONF_hTraceMutex) OMX_OSAL_MutexUnlock(g_OMX_CONF_hTraceMutex);
 
     return eError;
 }
 
+/* The ports of the component, read from it directly so the tracer does not log it; 0 if it will not tell. */
+static OMX_U32 OMX_CONF_TracePorts(OMX_COMPONENTTYPE *pComp)
+{
+    static const OMX_INDEXTYPE eDomainInits[] = {
+        OMX_IndexParamAudioInit, OMX_IndexParamVideoInit, OMX_IndexParamImageInit, OMX_IndexParamOtherInit
+    };
+    OMX_PORT_PARAM_TYPE oParam;
+    OMX_U32 i, nPorts = 0;
+
+    for (i = 0; i < sizeof(eDomainInits) / sizeof(eDomainInits[0]); i++) {
+        OMX_CONF_INIT_STRUCT(oParam, OMX_PORT_PARAM_TYPE);
+        if (OMX_ErrorNone == pComp->GetParameter((OMX_HANDLETYPE)pComp, eDomainInits[i], &oParam))
+            nPorts += oParam.nPorts;
+    }
+    return nPorts;
+}
+
 OMX_ERRORTYPE Trace_SendCommand(
         OMX_IN  OMX_HANDLETYPE hComponent,
         OMX_IN  OMX_COMMANDTYPE Cmd,
         OMX_IN  OMX_U32 nParam1,
         OMX_IN  OMX_PTR pCmdData)
 {
+    OMX_CONF_COMPTRACERDATATYPE *pTracerData = (OMX_CONF_COMPTRACERDATATYPE *)((OMX_COMPONENTTYPE *)hComponent)->pApplicationPrivate;
     OMX_ERRORTYPE eError;
     OMX_COMPONENTTYPE *pComp;
     char sCmdName[256];
     char sStateName[256];
-    OMX_U32 nMsec;
+    OMX_U64 nBeginNs, nNsec;
+    OMX_BOOL bInCall;
+    OMX_OSAL_COUNTERSTYPE oCounters;
+    OMX_CONF_RECORDEDCALLTYPE oArgs;
     OMX_MARKTYPE *pMark;
-    OMX_STRING sCompName = ((OMX_CONF_COMPTRACERDATATYPE *)(((OMX_COMPONENTTYPE *)hComponent)->pApplicationPrivate))->sComponentName;
-
-    pComp = ((OMX_CONF_COMPTRACERDATATYPE *)(((OMX_COMPONENTTYPE *)hComponent)->pApplicationPrivate))->pOrigComponent;
-    nMsec = OMX_OSAL_GetTime();
-
-    if (g_OMX_CONF_hTraceMutex) OMX_OSAL_MutexLock(g_OMX_CONF_hTraceMutex);
-    OMX_OSAL_Trace(OMX_OSAL_TRACE_CALLSEQUENCE, "calling %s<- SendCommand(", sCompName);
-    OMX_OSAL_Trace(OMX_OSAL_TRACE_PARAMETERS, "\n\thComponent = 0x%08x", hComponent);
-    if (OMX_ErrorNone == OMX_CONF_CommandToString(Cmd,sCmdName)){
-        OMX_OSAL_Trace(OMX_OSAL_TRACE_CALLSEQUENCE, "\n\tCmd = %s", sCmdName);
-    } else {
-        OMX_OSAL_Trace(OMX_OSAL_TRACE_PARAMETERS, "\n\tCmd = 0x%08x", Cmd);
+    OMX_STRING sCompName = pTracerData->sComponentName;
+
+    pComp = pTracerData->pOrigComponent;
+    /* before the call, which may complete the command before it returns */
+    OMX_CONF_TimeoutCommandSent(sCompName, Cmd, nParam1,
+        (Cmd != OMX_CommandStateSet && nParam1 == OMX_ALL) ? OMX_CONF_TracePorts(pComp) : 1);
+    if (!OMX_CONF_TraceTimed()) {
+        eError = pComp->SendCommand((OMX_HANDLETYPE)pComp, Cmd, nParam1, pCmdData);
+        if (eError != OMX_ErrorNone)
+            OMX_CONF_TimeoutCommandRejected(sCompName, Cmd);
+        return eError;
     }
-    switch(Cmd){
-    case OMX_CommandStateSet:
-        if (OMX_ErrorNone == OMX_CONF_StateToString((OMX_COMMANDTYPE)nParam1, sStateName)){
-            OMX_OSAL_Trace(OMX_OSAL_TRACE_CALLSEQUENCE, "\n\tstate(nParam1) = %s", sStateName);
-        }else {
-            OMX_OSAL_Trace(OMX_OSAL_TRACE_PARAMETERS, "\n\tstate(nParam1) = 0x%08x", nParam1);
+    nBeginNs = OMX_OSAL_GetTimeNs();
+
+    if (g_OMX_OSAL_TraceFlags & OMX_CONF_TRACE_CALLFLAGS) {
+        if (g_OMX_CONF_hTraceMutex) OMX_OSAL_MutexLock(g_OMX_CONF_hTraceMutex);
+        OMX_OSAL_Trace(OMX_OSAL_TRACE_CALLSEQUENCE, "calling %s<- SendCommand(", sCompName);
+        OMX_OSAL_Trace(OMX_OSAL_TRACE_PARAMETERS, "\n\thComponent = 0x%08x", hComponent);
+        if (OMX_ErrorNone == OMX_CONF_CommandToString(Cmd,sCmdName)){
+            OMX_OSAL_Trace(OMX_OSAL_TRACE_CALLSEQUENCE, "\n\tCmd = %s", sCmdName);
+        } else {
+            OMX_OSAL_Trace(OMX_OSAL_TRACE_PARAMETERS, "\n\tCmd = 0x%08x", Cmd);
         }
-        OMX_OSAL_Trace(OMX_OSAL_TRACE_PARAMETERS, "\n\tpCmdData = 0x%08x", pCmdData);
-        break;
-    case OMX_CommandFlush:
-    case OMX_CommandPortDisable:
-    case OMX_CommandPortEnable:
-        OMX_OSAL_Trace(OMX_OSAL_TRACE_PARAMETERS, "\n\tnPortIndex(nParam1) = 0x%08x", nParam1);
-        OMX_OSAL_Trace(OMX_OSAL_TRACE_PARAMETERS, "\n\tpCmdData = 0x%08x", pCmdData);
-        break;
-    case OMX_CommandMarkBuffer:
-        OMX_OSAL_Trace(OMX_OSAL_TRACE_PARAMETERS, "\n\tnParam1 = 0x%08x", nParam1);
-        OMX_OSAL_Trace(OMX_OSAL_TRACE_PARAMETERS, "\n\tpMarkData(pCmdData) = 0x%08x", pCmdData);
-        pMark = (OMX_MARKTYPE *)pCmdData;
-        OMX_OSAL_Trace(OMX_OSAL_TRACE_PARAMETERS, "\n\t\thMarkTargetComponent = 0x%08x", pMark->hMarkTargetComponent);
-        OMX_OSAL_Trace(OMX_OSAL_TRACE_PARAMETERS, "\n\t\tpMarkData = 0x%08x", pMark->pMarkData);
-        break;
-    default:
-        OMX_OSAL_Trace(OMX_OSAL_TRACE_PARAMETERS, "\n\tnParam1 = 0x%08x", nParam1);
-        OMX_OSAL_Trace(OMX_OSAL_TRACE_PARAMETERS, "\n\tpCmdData = 0x%08x", pCmdData);
+        switch(Cmd){
+        case OMX_CommandStateSet:
+            if (OMX_ErrorNone == OMX_CONF_StateToString((OMX_COMMANDTYPE)nParam1, sStateName)){
+                OMX_OSAL_Trace(OMX_OSAL_TRACE_CALLSEQUENCE, "\n\tstate(nParam1) = %s", sStateName);
+            }else {
+                OMX_OSAL_Trace(OMX_OSAL_TRACE_PARAMETERS, "\n\tstate(nParam1) = 0x%08x", nParam1);
+            }
+            OMX_OSAL_Trace(OMX_OSAL_TRACE_PARAMETERS, "\n\tpCmdData = 0x%08x", pCmdData);
+            break;
+        case OMX_CommandFlush:
+        case OMX_CommandPortDisable:
+        case OMX_CommandPortEnable:
+            OMX_OSAL_Trace(OMX_OSAL_TRACE_PARAMETERS, "\n\tnPortIndex(nParam1) = 0x%08x", nParam1);
+            OMX_OSAL_Trace(OMX_OSAL_TRACE_PARAMETERS, "\n\tpCmdData = 0x%08x", pCmdData);
+            break;
+        case OMX_CommandMarkBuffer:
+            OMX_OSAL_Trace(OMX_OSAL_TRACE_PARAMETERS, "\n\tnParam1 = 0x%08x", nParam1);
+            OMX_OSAL_Trace(OMX_OSAL_TRACE_PARAMETERS, "\n\tpMarkData(pCmdData) = 0x%08x", pCmdData);
+            pMark = (OMX_MARKTYPE *)pCmdData;
+            OMX_OSAL_Trace(OMX_OSAL_TRACE_PARAMETERS, "\n\t\thMarkTargetComponent = 0x%08x", pMark->hMarkTargetComponent);
+            OMX_OSAL_Trace(OMX_OSAL_TRACE_PARAMETERS, "\n\t\tpMarkData = 0x%08x", pMark->pMarkData);
+            break;
+        default:
+            OMX_OSAL_Trace(OMX_OSAL_TRACE_PARAMETERS, "\n\tnParam1 = 0x%08x", nParam1);
+            OMX_OSAL_Trace(OMX_OSAL_TRACE_PARAMETERS, "\n\tpCmdData = 0x%08x", pCmdData);
+        }
+        OMX_OSAL_Trace(OMX_OSAL_TRACE_CALLSEQUENCE, "\n)....\n");
+        if (g_OMX_CONF_hTraceMutex) OMX_OSAL_MutexUnlock(g_OMX_CONF_hTraceMutex);
     }
-    OMX_OSAL_Trace(OMX_OSAL_TRACE_CALLSEQUENCE, "\n)....\n");
-    if (g_OMX_CONF_hTraceMutex) OMX_OSAL_MutexUnlock(g_OMX_CONF_hTraceMutex);
 
+    bInCall = OMX_CONF_ILCallEnter();
+    OMX_CONF_CallCountersBegin(&oCounters);
     eError = pComp->SendCommand((OMX_HANDLETYPE)pComp, Cmd, nParam1, pCmdData);
-    nMsec = OMX_OSAL_GetTime() - nMsec;
+    nNsec = OMX_OSAL_GetTimeNs() - nBeginNs;
+    if (eError != OMX_ErrorNone)
+        OMX_CONF_TimeoutCommandRejected(sCompName, Cmd);
+    OMX_CONF_ILCallLeave(bInCall);
+    OMX_CONF_CallCountersEnd(&pTracerData->oCounters[OMX_CONF_TraceApiSendCommand], &oCounters);
+    OMX_CONF_TraceEvent(pTracerData->nNameId, OMX_CONF_TraceApiSendCommand, nBeginNs, nNsec, NULL, eError);
+    if (g_OMX_CONF_bRecordArguments) {
+        OMX_CONF_RecordArgs(&oArgs, OMX_CONF_TraceApiSendCommand, pComp, NULL, (OMX_U32)Cmd, nParam1, 0);
+        OMX_CONF_TraceRecord(pTracerData->nNameId, OMX_CONF_TraceApiSendCommand, nBeginNs, nNsec, eError, &oArgs, NULL, 0);
+    }
+    if (!OMX_CONF_TraceWanted(OMX_CONF_TRACE_CALLFLAGS | OMX_OSAL_TRACE_STATISTICS, nNsec, OMX_CONF_SHORT_TIMELIMIT))
+        return eError;
 
     if (g_OMX_CONF_hTraceMutex) OMX_OSAL_MutexLock(g_OMX_CONF_hTraceMutex);
 
@@ -608,7 +1849,8 @@ OMX_ERRORTYPE Trace_SendCommand(
         OMX_OSAL_Trace(OMX_OSAL_TRACE_PARAMETERS, "\n\tnParam1 = 0x%08x", nParam1);
         OMX_OSAL_Trace(OMX_OSAL_TRACE_PARAMETERS, "\n\tpCmdData = 0x%08x", pCmdData);
     }
-    OMX_OSAL_TraceResultAndTime(eError,nMsec,OMX_CONF_SHORT_TIMELIMIT, sCompName, "SendCommand");
+    OMX_CONF_TraceLatency(hComponent, OMX_CONF_TraceApiSendCommand, nNsec);
+    OMX_OSAL_TraceResultAndTime(eError,nNsec,OMX_CONF_SHORT_TIMELIMIT, sCompName, "SendCommand");
 
     if (g_OMX_CONF_hTraceMutex) OMX_OSAL_MutexUnlock(g_OMX_CONF_hTraceMutex);
 
@@ -621,16 +1863,33 @@ OMX_ERRORTYPE Trace_GetParameter(
         OMX_IN  OMX_INDEXTYPE nParamIndex,
         OMX_INOUT OMX_PTR ComponentParameterStructure)
 {
+    OMX_CONF_COMPTRACERDATATYPE *pTracerData = (OMX_CONF_COMPTRACERDATATYPE *)((OMX_COMPONENTTYPE *)hComponent)->pApplicationPrivate;
     OMX_ERRORTYPE eError;
     OMX_COMPONENTTYPE *pComp;
     char sIndexName[256];
-    OMX_U32 nMsec;
-    OMX_STRING sCompName = ((OMX_CONF_COMPTRACERDATATYPE *)(((OMX_COMPONENTTYPE *)hComponent)->pApplicationPrivate))->sComponentName;
-
-    pComp = ((OMX_CONF_COMPTRACERDATATYPE *)(((OMX_COMPONENTTYPE *)hComponent)->pApplicationPrivate))->pOrigComponent;
-    nMsec = OMX_OSAL_GetTime();
+    OMX_U64 nBeginNs, nNsec;
+    OMX_BOOL bInCall;
+    OMX_OSAL_COUNTERSTYPE oCounters;
+    OMX_CONF_RECORDEDCALLTYPE oArgs;
+    OMX_STRING sCompName = pTracerData->sComponentName;
+
+    pComp = pTracerData->pOrigComponent;
+    if (!OMX_CONF_TraceTimed())
+        return pComp->GetParameter((OMX_HANDLETYPE)pComp, nParamIndex, ComponentParameterStructure);
+    bInCall = OMX_CONF_ILCallEnter();
+    OMX_CONF_CallCountersBegin(&oCounters);
+    nBeginNs = OMX_OSAL_GetTimeNs();
     eError = pComp->GetParameter((OMX_HANDLETYPE)pComp, nParamIndex, ComponentParameterStructure);
-    nMsec = OMX_OSAL_GetTime() - nMsec;
+    nNsec = OMX_OSAL_GetTimeNs() - nBeginNs;
+    OMX_CONF_ILCallLeave(bInCall);
+    OMX_CONF_CallCountersEnd(&pTracerData->oCounters[OMX_CONF_TraceApiGetParameter], &oCounters);
+    OMX_CONF_TraceEvent(pTracerData->nNameId, OMX_CONF_TraceApiGetParameter, nBeginNs, nNsec, NULL, eError);
+    if (g_OMX_CONF_bRecordArguments) {
+        OMX_CONF_RecordArgs(&oArgs, OMX_CONF_TraceApiGetParameter, pComp, NULL, (OMX_U32)nParamIndex, 0, 0);
+        OMX_CONF_TraceRecord(pTracerData->nNameId, OMX_CONF_TraceApiGetParameter, nBeginNs, nNsec, eError, &oArgs, ComponentParameterStructure, OMX_CONF_StructBytes(ComponentParameterStructure));
+    }
+    if (!OMX_CONF_TraceWanted(OMX_CONF_TRACE_CALLFLAGS | OMX_OSAL_TRACE_STATISTICS, nNsec, OMX_CONF_LONG_TIMELIMIT))
+        return eError;
 
     if (g_OMX_CONF_hTraceMutex) OMX_OSAL_MutexLock(g_OMX_CONF_hTraceMutex);
 
@@ -642,7 +1901,8 @@ OMX_ERRORTYPE Trace_GetParameter(
         OMX_OSAL_Trace(OMX_OSAL_TRACE_PARAMETERS, "\n\tnParamIndex = 0x%08x", nParamIndex);
     }
     OMX_OSAL_Trace(OMX_OSAL_TRACE_PARAMETERS, "\n\tComponentParameterStructure = 0x%08x", ComponentParameterStructure);
-    OMX_OSAL_TraceResultAndTime(eError,nMsec,OMX_CONF_LONG_TIMELIMIT, sCompName, "GetParameter");
+    OMX_CONF_TraceLatency(hComponent, OMX_CONF_TraceApiGetParameter, nNsec);
+    OMX_OSAL_TraceResultAndTime(eError,nNsec,OMX_CONF_LONG_TIMELIMIT, sCompName, "GetParameter");
 
     if (g_OMX_CONF_hTraceMutex) OMX_OSAL_MutexUnlock(g_OMX_CONF_hTraceMutex);
 
@@ -655,16 +1915,39 @@ OMX_ERRORTYPE Trace_SetParameter(
         OMX_IN  OMX_INDEXTYPE nIndex,
         OMX_IN  OMX_PTR ComponentParameterStructure)
 {
+    OMX_CONF_COMPTRACERDATATYPE *pTracerData = (OMX_CONF_COMPTRACERDATATYPE *)((OMX_COMPONENTTYPE *)hComponent)->pApplicationPrivate;
     OMX_ERRORTYPE eError;
     OMX_COMPONENTTYPE *pComp;
     char sIndexName[256];
-    OMX_U32 nMsec;
-    OMX_STRING sCompName = ((OMX_CONF_COMPTRACERDATATYPE *)(((OMX_COMPONENTTYPE *)hComponent)->pApplicationPrivate))->sComponentName;
-
-    pComp = ((OMX_CONF_COMPTRACERDATATYPE *)(((OMX_COMPONENTTYPE *)hComponent)->pApplicationPrivate))->pOrigComponent;
-    nMsec = OMX_OSAL_GetTime();
+    OMX_U64 nBeginNs, nNsec;
+    OMX_BOOL bInCall;
+    OMX_OSAL_COUNTERSTYPE oCounters;
+    OMX_CONF_RECORDEDCALLTYPE oArgs;
+    OMX_STRING sCompName = pTracerData->sComponentName;
+
+    pComp = pTracerData->pOrigComponent;
+    if (!OMX_CONF_TraceTimed()) {
+        eError = pComp->SetParameter((OMX_HANDLETYPE)pComp, nIndex, ComponentParameterStructure);
+        if (OMX_ErrorNone == eError && OMX_IndexParamCompBufferSupplier != nIndex)
+            pTracerData->bParametersSet = OMX_TRUE;
+        return eError;
+    }
+    bInCall = OMX_CONF_ILCallEnter();
+    OMX_CONF_CallCountersBegin(&oCounters);
+    nBeginNs = OMX_OSAL_GetTimeNs();
     eError = pComp->SetParameter((OMX_HANDLETYPE)pComp, nIndex, ComponentParameterStructure);
-    nMsec = OMX_OSAL_GetTime() - nMsec;
+    nNsec = OMX_OSAL_GetTimeNs() - nBeginNs;
+    OMX_CONF_ILCallLeave(bInCall);
+    if (OMX_ErrorNone == eError && OMX_IndexParamCompBufferSupplier != nIndex)
+        pTracerData->bParametersSet = OMX_TRUE;
+    OMX_CONF_CallCountersEnd(&pTracerData->oCounters[OMX_CONF_TraceApiSetParameter], &oCounters);
+    OMX_CONF_TraceEvent(pTracerData->nNameId, OMX_CONF_TraceApiSetParameter, nBeginNs, nNsec, NULL, eError);
+    if (g_OMX_CONF_bRecordArguments) {
+        OMX_CONF_RecordArgs(&oArgs, OMX_CONF_TraceApiSetParameter, pComp, NULL, (OMX_U32)nIndex, 0, 0);
+        OMX_CONF_TraceRecord(pTracerData->nNameId, OMX_CONF_TraceApiSetParameter, nBeginNs, nNsec, eError, &oArgs, ComponentParameterStructure, OMX_CONF_StructBytes(ComponentParameterStructure));
+    }
+    if (!OMX_CONF_TraceWanted(OMX_CONF_TRACE_CALLFLAGS | OMX_OSAL_TRACE_STATISTICS, nNsec, OMX_CONF_LONG_TIMELIMIT))
+        return eError;
 
     if (g_OMX_CONF_hTraceMutex) OMX_OSAL_MutexLock(g_OMX_CONF_hTraceMutex);
 
@@ -676,7 +1959,8 @@ OMX_ERRORTYPE Trace_SetParameter(
         OMX_OSAL_Trace(OMX_OSAL_TRACE_PARAMETERS, "\n\tnIndex = 0x%08x", nIndex);
     }
     OMX_OSAL_Trace(OMX_OSAL_TRACE_PARAMETERS, "\n\tComponentParameterStructure = 0x%08x", ComponentParameterStructure);
-    OMX_OSAL_TraceResultAndTime(eError,nMsec,OMX_CONF_LONG_TIMELIMIT, sCompName, "SetParameter");
+    OMX_CONF_TraceLatency(hComponent, OMX_CONF_TraceApiSetParameter, nNsec);
+    OMX_OSAL_TraceResultAndTime(eError,nNsec,OMX_CONF_LONG_TIMELIMIT, sCompName, "SetParameter");
 
     if (g_OMX_CONF_hTraceMutex) OMX_OSAL_MutexUnlock(g_OMX_CONF_hTraceMutex);
 
@@ -689,16 +1973,33 @@ OMX_ERRORTYPE Trace_GetConfig(
         OMX_IN  OMX_INDEXTYPE nIndex,
         OMX_INOUT OMX_PTR pComponentConfigStructure)
 {
+    OMX_CONF_COMPTRACERDATATYPE *pTracerData = (OMX_CONF_COMPTRACERDATATYPE *)((OMX_COMPONENTTYPE *)hComponent)->pApplicationPrivate;
     OMX_ERRORTYPE eError;
     OMX_COMPONENTTYPE *pComp;
     char sIndexName[256];
-    OMX_U32 nMsec;
-    OMX_STRING sCompName = ((OMX_CONF_COMPTRACERDATATYPE *)(((OMX_COMPONENTTYPE *)hComponent)->pApplicationPrivate))->sComponentName;
-
-    pComp = ((OMX_CONF_COMPTRACERDATATYPE *)(((OMX_COMPONENTTYPE *)hComponent)->pApplicationPrivate))->pOrigComponent;
-    nMsec = OMX_OSAL_GetTime();
+    OMX_U64 nBeginNs, nNsec;
+    OMX_BOOL bInCall;
+    OMX_OSAL_COUNTERSTYPE oCounters;
+    OMX_CONF_RECORDEDCALLTYPE oArgs;
+    OMX_STRING sCompName = pTracerData->sComponentName;
+
+    pComp = pTracerData->pOrigComponent;
+    if (!OMX_CONF_TraceTimed())
+        return pComp->GetConfig((OMX_HANDLETYPE)pComp, nIndex, pComponentConfigStructure);
+    bInCall = OMX_CONF_ILCallEnter();
+    OMX_CONF_CallCountersBegin(&oCounters);
+    nBeginNs = OMX_OSAL_GetTimeNs();
     eError = pComp->GetConfig((OMX_HANDLETYPE)pComp, nIndex, pComponentConfigStructure);
-    nMsec = OMX_OSAL_GetTime() - nMsec;
+    nNsec = OMX_OSAL_GetTimeNs() - nBeginNs;
+    OMX_CONF_ILCallLeave(bInCall);
+    OMX_CONF_CallCountersEnd(&pTracerData->oCounters[OMX_CONF_TraceApiGetConfig], &oCounters);
+    OMX_CONF_TraceEvent(pTracerData->nNameId, OMX_CONF_TraceApiGetConfig, nBeginNs, nNsec, NULL, eError);
+    if (g_OMX_CONF_bRecordArguments) {
+        OMX_CONF_RecordArgs(&oArgs, OMX_CONF_TraceApiGetConfig, pComp, NULL, (OMX_U32)nIndex, 0, 0);
+        OMX_CONF_TraceRecord(pTracerData->nNameId, OMX_CONF_TraceApiGetConfig, nBeginNs, nNsec, eError, &oArgs, pComponentConfigStructure, OMX_CONF_StructBytes(pComponentConfigStructure));
+    }
+    if (!OMX_CONF_TraceWanted(OMX_CONF_TRACE_CALLFLAGS | OMX_OSAL_TRACE_STATISTICS, nNsec, OMX_CONF_SHORT_TIMELIMIT))
+        return eError;
 
     if (g_OMX_CONF_hTraceMutex) OMX_OSAL_MutexLock(g_OMX_CONF_hTraceMutex);
 
@@ -710,7 +2011,8 @@ OMX_ERRORTYPE Trace_GetConfig(
         OMX_OSAL_Trace(OMX_OSAL_TRACE_PARAMETERS, "\n\tnIndex = 0x%08x", nIndex);
     }
     OMX_OSAL_Trace(OMX_OSAL_TRACE_PARAMETERS, "\n\tpComponentConfigStructure = 0x%08x", pComponentConfigStructure);
-    OMX_OSAL_TraceResultAndTime(eError,nMsec,OMX_CONF_SHORT_TIMELIMIT, sCompName, "GetConfig");
+    OMX_CONF_TraceLatency(hComponent, OMX_CONF_TraceApiGetConfig, nNsec);
+    OMX_OSAL_TraceResultAndTime(eError,nNsec,OMX_CONF_SHORT_TIMELIMIT, sCompName, "GetConfig");
 
     if (g_OMX_CONF_hTraceMutex) OMX_OSAL_MutexUnlock(g_OMX_CONF_hTraceMutex);
 
@@ -723,16 +2025,33 @@ OMX_ERRORTYPE Trace_SetConfig(
         OMX_IN  OMX_INDEXTYPE nIndex,
         OMX_IN  OMX_PTR pComponentConfigStructure)
 {
+    OMX_CONF_COMPTRACERDATATYPE *pTracerData = (OMX_CONF_COMPTRACERDATATYPE *)((OMX_COMPONENTTYPE *)hComponent)->pApplicationPrivate;
     OMX_ERRORTYPE eError;
     OMX_COMPONENTTYPE *pComp;
     char sIndexName[256];
-    OMX_U32 nMsec;
-    OMX_STRING sCompName = ((OMX_CONF_COMPTRACERDATATYPE *)(((OMX_COMPONENTTYPE *)hComponent)->pApplicationPrivate))->sComponentName;
-
-    pComp = ((OMX_CONF_COMPTRACERDATATYPE *)(((OMX_COMPONENTTYPE *)hComponent)->pApplicationPrivate))->pOrigComponent;
-    nMsec = OMX_OSAL_GetTime();
+    OMX_U64 nBeginNs, nNsec;
+    OMX_BOOL bInCall;
+    OMX_OSAL_COUNTERSTYPE oCounters;
+    OMX_CONF_RECORDEDCALLTYPE oArgs;
+    OMX_STRING sCompName = pTracerData->sComponentName;
+
+    pComp = pTracerData->pOrigComponent;
+    if (!OMX_CONF_TraceTimed())
+        return pComp->SetConfig((OMX_HANDLETYPE)pComp, nIndex, pComponentConfigStructure);
+    bInCall = OMX_CONF_ILCallEnter();
+    OMX_CONF_CallCountersBegin(&oCounters);
+    nBeginNs = OMX_OSAL_GetTimeNs();
     eError = pComp->SetConfig((OMX_HANDLETYPE)pComp, nIndex, pComponentConfigStructure);
-    nMsec = OMX_OSAL_GetTime() - nMsec;
+    nNsec = OMX_OSAL_GetTimeNs() - nBeginNs;
+    OMX_CONF_ILCallLeave(bInCall);
+    OMX_CONF_CallCountersEnd(&pTracerData->oCounters[OMX_CONF_TraceApiSetConfig], &oCounters);
+    OMX_CONF_TraceEvent(pTracerData->nNameId, OMX_CONF_TraceApiSetConfig, nBeginNs, nNsec, NULL, eError);
+    if (g_OMX_CONF_bRecordArguments) {
+        OMX_CONF_RecordArgs(&oArgs, OMX_CONF_TraceApiSetConfig, pComp, NULL, (OMX_U32)nIndex, 0, 0);
+        OMX_CONF_TraceRecord(pTracerData->nNameId, OMX_CONF_TraceApiSetConfig, nBeginNs, nNsec, eError, &oArgs, pComponentConfigStructure, OMX_CONF_StructBytes(pComponentConfigStructure));
+    }
+    if (!OMX_CONF_TraceWanted(OMX_CONF_TRACE_CALLFLAGS | OMX_OSAL_TRACE_STATISTICS, nNsec, OMX_CONF_SHORT_TIMELIMIT))
+        return eError;
 
     if (g_OMX_CONF_hTraceMutex) OMX_OSAL_MutexLock(g_OMX_CONF_hTraceMutex);
 
@@ -744,7 +2063,8 @@ OMX_ERRORTYPE Trace_SetConfig(
         OMX_OSAL_Trace(OMX_OSAL_TRACE_PARAMETERS, "\n\tnIndex = 0x%08x", nIndex);
     }
     OMX_OSAL_Trace(OMX_OSAL_TRACE_PARAMETERS, "\n\tpComponentConfigStructure = 0x%08x", pComponentConfigStructure);
-    OMX_OSAL_TraceResultAndTime(eError,nMsec,OMX_CONF_SHORT_TIMELIMIT, sCompName, "SetConfig");
+    OMX_CONF_TraceLatency(hComponent, OMX_CONF_TraceApiSetConfig, nNsec);
+    OMX_OSAL_TraceResultAndTime(eError,nNsec,OMX_CONF_SHORT_TIMELIMIT, sCompName, "SetConfig");
 
     if (g_OMX_CONF_hTraceMutex) OMX_OSAL_MutexUnlock(g_OMX_CONF_hTraceMutex);
 
@@ -757,15 +2077,32 @@ OMX_ERRORTYPE Trace_GetExtensionIndex(
         OMX_IN  OMX_STRING cParameterName,
         OMX_OUT OMX_INDEXTYPE* pIndexType)
 {
+    OMX_CONF_COMPTRACERDATATYPE *pTracerData = (OMX_CONF_COMPTRACERDATATYPE *)((OMX_COMPONENTTYPE *)hComponent)->pApplicationPrivate;
     OMX_ERRORTYPE eError;
     OMX_COMPONENTTYPE *pComp;
-    OMX_U32 nMsec;
-    OMX_STRING sCompName = ((OMX_CONF_COMPTRACERDATATYPE *)(((OMX_COMPONENTTYPE *)hComponent)->pApplicationPrivate))->sComponentName;
-
-    pComp = ((OMX_CONF_COMPTRACERDATATYPE *)(((OMX_COMPONENTTYPE *)hComponent)->pApplicationPrivate))->pOrigComponent;
-    nMsec = OMX_OSAL_GetTime();
+    OMX_U64 nBeginNs, nNsec;
+    OMX_BOOL bInCall;
+    OMX_OSAL_COUNTERSTYPE oCounters;
+    OMX_CONF_RECORDEDCALLTYPE oArgs;
+    OMX_STRING sCompName = pTracerData->sComponentName;
+
+    pComp = pTracerData->pOrigComponent;
+    if (!OMX_CONF_TraceTimed())
+        return pComp->GetExtensionIndex((OMX_HANDLETYPE)pComp, cParameterName, pIndexType);
+    bInCall = OMX_CONF_ILCallEnter();
+    OMX_CONF_CallCountersBegin(&oCounters);
+    nBeginNs = OMX_OSAL_GetTimeNs();
     eError = pComp->GetExtensionIndex((OMX_HANDLETYPE)pComp, cParameterName, pIndexType);
-    nMsec = OMX_OSAL_GetTime() - nMsec;
+    nNsec = OMX_OSAL_GetTimeNs() - nBeginNs;
+    OMX_CONF_ILCallLeave(bInCall);
+    OMX_CONF_CallCountersEnd(&pTracerData->oCounters[OMX_CONF_TraceApiGetExtensionIndex], &oCounters);
+    OMX_CONF_TraceEvent(pTracerData->nNameId, OMX_CONF_TraceApiGetExtensionIndex, nBeginNs, nNsec, NULL, eError);
+    if (g_OMX_CONF_bRecordArguments) {
+        OMX_CONF_RecordArgs(&oArgs, OMX_CONF_TraceApiGetExtensionIndex, pComp, NULL, (eError == OMX_ErrorNone) ? (OMX_U32)*pIndexType : 0, 0, 0);
+        OMX_CONF_TraceRecord(pTracerData->nNameId, OMX_CONF_TraceApiGetExtensionIndex, nBeginNs, nNsec, eError, &oArgs, cParameterName, cParameterName ? (OMX_U32)strlen(cParameterName) + 1 : 0);
+    }
+    if (!OMX_CONF_TraceWanted(OMX_CONF_TRACE_CALLFLAGS | OMX_OSAL_TRACE_STATISTICS, nNsec, OMX_CONF_SHORT_TIMELIMIT))
+        return eError;
 
     if (g_OMX_CONF_hTraceMutex) OMX_OSAL_MutexLock(g_OMX_CONF_hTraceMutex);
 
@@ -773,7 +2110,8 @@ OMX_ERRORTYPE Trace_GetExtensionIndex(
     OMX_OSAL_Trace(OMX_OSAL_TRACE_PARAMETERS, "\n\thComponent = 0x%08x", hComponent);
     OMX_OSAL_Trace(OMX_OSAL_TRACE_PARAMETERS, "\n\tcParameterName = %s", cParameterName);
     OMX_OSAL_Trace(OMX_OSAL_TRACE_PARAMETERS, "\n\tpIndexType = 0x%08x", pIndexType);
-    OMX_OSAL_TraceResultAndTime(eError,nMsec,OMX_CONF_SHORT_TIMELIMIT, sCompName, "GetExtensionIndex");
+    OMX_CONF_TraceLatency(hComponent, OMX_CONF_TraceApiGetExtensionIndex, nNsec);
+    OMX_OSAL_TraceResultAndTime(eError,nNsec,OMX_CONF_SHORT_TIMELIMIT, sCompName, "GetExtensionIndex");
 
     if (g_OMX_CONF_hTraceMutex) OMX_OSAL_MutexUnlock(g_OMX_CONF_hTraceMutex);
 
@@ -785,16 +2123,33 @@ OMX_ERRORTYPE Trace_GetState(
         OMX_IN  OMX_HANDLETYPE hComponent,
         OMX_OUT OMX_STATETYPE* pState)
 {
+    OMX_CONF_COMPTRACERDATATYPE *pTracerData = (OMX_CONF_COMPTRACERDATATYPE *)((OMX_COMPONENTTYPE *)hComponent)->pApplicationPrivate;
     OMX_ERRORTYPE eError;
     OMX_COMPONENTTYPE *pComp;
     char sStateName[256];
-    OMX_U32 nMsec;
-    OMX_STRING sCompName = ((OMX_CONF_COMPTRACERDATATYPE *)(((OMX_COMPONENTTYPE *)hComponent)->pApplicationPrivate))->sComponentName;
-
-    pComp = ((OMX_CONF_COMPTRACERDATATYPE *)(((OMX_COMPONENTTYPE *)hComponent)->pApplicationPrivate))->pOrigComponent;
-    nMsec = OMX_OSAL_GetTime();
+    OMX_U64 nBeginNs, nNsec;
+    OMX_BOOL bInCall;
+    OMX_OSAL_COUNTERSTYPE oCounters;
+    OMX_CONF_RECORDEDCALLTYPE oArgs;
+    OMX_STRING sCompName = pTracerData->sComponentName;
+
+    pComp = pTracerData->pOrigComponent;
+    if (!OMX_CONF_TraceTimed())
+        return pComp->GetState((OMX_HANDLETYPE)pComp, pState);
+    bInCall = OMX_CONF_ILCallEnter();
+    OMX_CONF_CallCountersBegin(&oCounters);
+    nBeginNs = OMX_OSAL_GetTimeNs();
     eError = pComp->GetState((OMX_HANDLETYPE)pComp, pState);
-    nMsec = OMX_OSAL_GetTime() - nMsec;
+    nNsec = OMX_OSAL_GetTimeNs() - nBeginNs;
+    OMX_CONF_ILCallLeave(bInCall);
+    OMX_CONF_CallCountersEnd(&pTracerData->oCounters[OMX_CONF_TraceApiGetState], &oCounters);
+    OMX_CONF_TraceEvent(pTracerData->nNameId, OMX_CONF_TraceApiGetState, nBeginNs, nNsec, NULL, eError);
+    if (g_OMX_CONF_bRecordArguments) {
+        OMX_CONF_RecordArgs(&oArgs, OMX_CONF_TraceApiGetState, pComp, NULL, (eError == OMX_ErrorNone) ? (OMX_U32)*pState : 0, 0, 0);
+        OMX_CONF_TraceRecord(pTracerData->nNameId, OMX_CONF_TraceApiGetState, nBeginNs, nNsec, eError, &oArgs, NULL, 0);
+    }
+    if (!OMX_CONF_TraceWanted(OMX_CONF_TRACE_CALLFLAGS | OMX_OSAL_TRACE_STATISTICS, nNsec, OMX_CONF_SHORT_TIMELIMIT))
+        return eError;
 
     if (g_OMX_CONF_hTraceMutex) OMX_OSAL_MutexLock(g_OMX_CONF_hTraceMutex);
 
@@ -805,7 +2160,8 @@ OMX_ERRORTYPE Trace_GetState(
     }else {
         OMX_OSAL_Trace(OMX_OSAL_TRACE_PARAMETERS, "\n\t*pState = 0x%08x", pState);
     }
-    OMX_OSAL_TraceResultAndTime(eError,nMsec,OMX_CONF_SHORT_TIMELIMIT, sCompName, "GetState");
+    OMX_CONF_TraceLatency(hComponent, OMX_CONF_TraceApiGetState, nNsec);
+    OMX_OSAL_TraceResultAndTime(eError,nNsec,OMX_CONF_SHORT_TIMELIMIT, sCompName, "GetState");
 
     if (g_OMX_CONF_hTraceMutex) OMX_OSAL_MutexUnlock(g_OMX_CONF_hTraceMutex);
 
@@ -813,6 +2169,21 @@ OMX_ERRORTYPE Trace_GetState(
 }
 
 
+/* Note the tunnel set up on nPort of the original component hComp for the buffer checks.
+   The peer hands buffers over through its own tracer if the client tunneled the tracers. */
+static void OMX_CONF_TraceTunnel(OMX_HANDLETYPE hComp, OMX_U32 nPort, OMX_HANDLETYPE hTunneledComp)
+{
+    OMX_HANDLETYPE hPeer = NULL;
+    OMX_STRING sPeerName;
+    OMX_BOOL bParametersSet;
+
+    if (hTunneledComp && OMX_ErrorNone == OMX_CONF_ComponentTracerInfo(hTunneledComp, &sPeerName, &bParametersSet))
+        hPeer = ((OMX_CONF_COMPTRACERDATATYPE *)((OMX_COMPONENTTYPE *)hTunneledComp)->pApplicationPrivate)->pOrigComponent;
+    if (g_OMX_CONF_hTraceMutex) OMX_OSAL_MutexLock(g_OMX_CONF_hTraceMutex);
+    OMX_CONF_BufferTunnelSet(hComp, nPort, hTunneledComp ? OMX_TRUE : OMX_FALSE, hPeer);
+    if (g_OMX_CONF_hTraceMutex) OMX_OSAL_MutexUnlock(g_OMX_CONF_hTraceMutex);
+}
+
 OMX_ERRORTYPE Trace_ComponentTunnelRequest(
     OMX_IN  OMX_HANDLETYPE hComp,
     OMX_IN  OMX_U32 nPort,
@@ -820,26 +2191,50 @@ OMX_ERRORTYPE Trace_ComponentTunnelRequest(
     OMX_IN  OMX_U32 nTunneledPort,
     OMX_INOUT  OMX_TUNNELSETUPTYPE* pTunnelSetup)
 {
+    OMX_CONF_COMPTRACERDATATYPE *pTracerData = (OMX_CONF_COMPTRACERDATATYPE *)((OMX_COMPONENTTYPE *)hComp)->pApplicationPrivate;
     OMX_ERRORTYPE eError;
     OMX_COMPONENTTYPE *pComp;
-    OMX_U32 nMsec;
-    OMX_STRING sCompName = ((OMX_CONF_COMPTRACERDATATYPE *)(((OMX_COMPONENTTYPE *)hComp)->pApplicationPrivate))->sComponentName;
-
-    pComp = ((OMX_CONF_COMPTRACERDATATYPE *)(((OMX_COMPONENTTYPE *)hComp)->pApplicationPrivate))->pOrigComponent;
-    nMsec = OMX_OSAL_GetTime();
+    OMX_U64 nBeginNs, nNsec;
+    OMX_BOOL bInCall;
+    OMX_OSAL_COUNTERSTYPE oCounters;
+    OMX_CONF_RECORDEDCALLTYPE oArgs;
+    OMX_STRING sCompName = pTracerData->sComponentName;
+
+    pComp = pTracerData->pOrigComponent;
+    if (!OMX_CONF_TraceTimed()) {
+        eError = pComp->ComponentTunnelRequest((OMX_HANDLETYPE)pComp, nPort, hTunneledComp, nTunneledPort, pTunnelSetup);
+        if (eError == OMX_ErrorNone)
+            OMX_CONF_TraceTunnel(pComp, nPort, hTunneledComp);
+        return eError;
+    }
+    bInCall = OMX_CONF_ILCallEnter();
+    OMX_CONF_CallCountersBegin(&oCounters);
+    nBeginNs = OMX_OSAL_GetTimeNs();
     eError = pComp->ComponentTunnelRequest((OMX_HANDLETYPE)pComp, nPort, hTunneledComp, nTunneledPort, pTunnelSetup);
-    nMsec = OMX_OSAL_GetTime() - nMsec;
+    nNsec = OMX_OSAL_GetTimeNs() - nBeginNs;
+    OMX_CONF_ILCallLeave(bInCall);
+    if (eError == OMX_ErrorNone)
+        OMX_CONF_TraceTunnel(pComp, nPort, hTunneledComp);
+    OMX_CONF_CallCountersEnd(&pTracerData->oCounters[OMX_CONF_TraceApiComponentTunnelRequest], &oCounters);
+    OMX_CONF_TraceEvent(pTracerData->nNameId, OMX_CONF_TraceApiComponentTunnelRequest, nBeginNs, nNsec, NULL, eError);
+    if (g_OMX_CONF_bRecordArguments) {
+        OMX_CONF_RecordArgs(&oArgs, OMX_CONF_TraceApiComponentTunnelRequest, pComp, NULL, nPort, nTunneledPort, 0);
+        OMX_CONF_TraceRecord(pTracerData->nNameId, OMX_CONF_TraceApiComponentTunnelRequest, nBeginNs, nNsec, eError, &oArgs, NULL, 0);
+    }
+    if (!OMX_CONF_TraceWanted(OMX_CONF_TRACE_CALLFLAGS | OMX_OSAL_TRACE_STATISTICS, nNsec, OMX_CONF_SHORT_TIMELIMIT))
+        return eError;
 
     if (g_OMX_CONF_hTraceMutex) OMX_OSAL_MutexLock(g_OMX_CONF_hTraceMutex);
 
     OMX_OSAL_Trace(OMX_OSAL_TRACE_CALLSEQUENCE, "%s<- ComponentTunnelRequest(",
-        ((OMX_CONF_COMPTRACERDATATYPE *)(((OMX_COMPONENTTYPE *)hComp)->pApplicationPrivate))->sComponentName);
+        pTracerData->sComponentName);
     OMX_OSAL_Trace(OMX_OSAL_TRACE_PARAMETERS, "\n\thComp = 0x%08x", hComp);
     OMX_OSAL_Trace(OMX_OSAL_TRACE_PARAMETERS, "\n\tnPort = 0x%08x", nPort);
     OMX_OSAL_Trace(OMX_OSAL_TRACE_PARAMETERS, "\n\thTunneledComp = 0x%08x", hTunneledComp);
     OMX_OSAL_Trace(OMX_OSAL_TRACE_PARAMETERS, "\n\tnTunneledPort = 0x%08x", nTunneledPort);
     OMX_OSAL_Trace(OMX_OSAL_TRACE_PARAMETERS, "\n\tpTunnelSetup = 0x%08x", pTunnelSetup);
-    OMX_OSAL_TraceResultAndTime(eError,nMsec,OMX_CONF_SHORT_TIMELIMIT, sCompName, "ComponentTunnelRequest");
+    OMX_CONF_TraceLatency(hComp, OMX_CONF_TraceApiComponentTunnelRequest, nNsec);
+    OMX_OSAL_TraceResultAndTime(eError,nNsec,OMX_CONF_SHORT_TIMELIMIT, sCompName, "ComponentTunnelRequest");
 
     if (g_OMX_CONF_hTraceMutex) OMX_OSAL_MutexUnlock(g_OMX_CONF_hTraceMutex);
 
@@ -855,15 +2250,38 @@ OMX_ERRORTYPE Trace_UseBuffer(
         OMX_IN OMX_U32 nSizeBytes,
         OMX_IN OMX_U8* pBuffer)
 {
+    OMX_CONF_COMPTRACERDATATYPE *pTracerData = (OMX_CONF_COMPTRACERDATATYPE *)((OMX_COMPONENTTYPE *)hComponent)->pApplicationPrivate;
     OMX_ERRORTYPE eError;
     OMX_COMPONENTTYPE *pComp;
-    OMX_U32 nMsec;
-    OMX_STRING sCompName = ((OMX_CONF_COMPTRACERDATATYPE *)(((OMX_COMPONENTTYPE *)hComponent)->pApplicationPrivate))->sComponentName;
-
-    pComp = ((OMX_CONF_COMPTRACERDATATYPE *)(((OMX_COMPONENTTYPE *)hComponent)->pApplicationPrivate))->pOrigComponent;
-    nMsec = OMX_OSAL_GetTime();
+    OMX_U64 nBeginNs, nNsec;
+    OMX_BOOL bInCall;
+    OMX_OSAL_COUNTERSTYPE oCounters;
+    OMX_CONF_RECORDEDCALLTYPE oArgs;
+    OMX_STRING sCompName = pTracerData->sComponentName;
+
+    pComp = pTracerData->pOrigComponent;
+    if (!OMX_CONF_TraceTimed()) {
+        eError = pComp->UseBuffer((OMX_HANDLETYPE)pComp, ppBufferHdr, nPortIndex, pAppPrivate, nSizeBytes, pBuffer);
+        if (eError == OMX_ErrorNone)
+            OMX_CONF_ValidateBuffer(&pTracerData->oChecks, sCompName, OMX_CONF_TraceApiUseBuffer, pComp, *ppBufferHdr, nPortIndex);
+        return eError;
+    }
+    bInCall = OMX_CONF_ILCallEnter();
+    OMX_CONF_CallCountersBegin(&oCounters);
+    nBeginNs = OMX_OSAL_GetTimeNs();
     eError = pComp->UseBuffer((OMX_HANDLETYPE)pComp, ppBufferHdr, nPortIndex, pAppPrivate, nSizeBytes, pBuffer);
-    nMsec = OMX_OSAL_GetTime() - nMsec;
+    nNsec = OMX_OSAL_GetTimeNs() - nBeginNs;
+    OMX_CONF_ILCallLeave(bInCall);
+    OMX_CONF_CallCountersEnd(&pTracerData->oCounters[OMX_CONF_TraceApiUseBuffer], &oCounters);
+    if (eError == OMX_ErrorNone)
+        OMX_CONF_ValidateBuffer(&pTracerData->oChecks, sCompName, OMX_CONF_TraceApiUseBuffer, pComp, *ppBufferHdr, nPortIndex);
+    OMX_CONF_TraceEvent(pTracerData->nNameId, OMX_CONF_TraceApiUseBuffer, nBeginNs, nNsec, (eError == OMX_ErrorNone) ? *ppBufferHdr : NULL, eError);
+    if (g_OMX_CONF_bRecordArguments) {
+        OMX_CONF_RecordArgs(&oArgs, OMX_CONF_TraceApiUseBuffer, pComp, (eError == OMX_ErrorNone) ? *ppBufferHdr : NULL, nPortIndex, nSizeBytes, 0);
+        OMX_CONF_TraceRecord(pTracerData->nNameId, OMX_CONF_TraceApiUseBuffer, nBeginNs, nNsec, eError, &oArgs, NULL, 0);
+    }
+    if (!OMX_CONF_TraceWanted(OMX_CONF_TRACE_CALLFLAGS | OMX_OSAL_TRACE_STATISTICS, nNsec, OMX_CONF_LONG_TIMELIMIT))
+        return eError;
 
     if (g_OMX_CONF_hTraceMutex) OMX_OSAL_MutexLock(g_OMX_CONF_hTraceMutex);
 
@@ -875,7 +2293,8 @@ OMX_ERRORTYPE Trace_UseBuffer(
     OMX_OSAL_Trace(OMX_OSAL_TRACE_PARAMETERS, "\n\tpAppPrivate = 0x%08x", pAppPrivate);
     OMX_OSAL_Trace(OMX_OSAL_TRACE_PARAMETERS, "\n\tnSizeBytes = 0x%08x", nSizeBytes);
     OMX_OSAL_Trace(OMX_OSAL_TRACE_PARAMETERS, "\n\tpBuffer = 0x%08x", pBuffer);
-    OMX_OSAL_TraceResultAndTime(eError,nMsec,OMX_CONF_LONG_TIMELIMIT, sCompName, "UseBuffer");
+    OMX_CONF_TraceLatency(hComponent, OMX_CONF_TraceApiUseBuffer, nNsec);
+    OMX_OSAL_TraceResultAndTime(eError,nNsec,OMX_CONF_LONG_TIMELIMIT, sCompName, "UseBuffer");
 
     if (g_OMX_CONF_hTraceMutex) OMX_OSAL_MutexUnlock(g_OMX_CONF_hTraceMutex);
 
@@ -890,15 +2309,38 @@ OMX_ERRORTYPE Trace_AllocateBuffer(
         OMX_IN OMX_PTR pAppPrivate,
         OMX_IN OMX_U32 nSizeBytes)
 {
+    OMX_CONF_COMPTRACERDATATYPE *pTracerData = (OMX_CONF_COMPTRACERDATATYPE *)((OMX_COMPONENTTYPE *)hComponent)->pApplicationPrivate;
     OMX_ERRORTYPE eError;
     OMX_COMPONENTTYPE *pComp;
-    OMX_U32 nMsec;
-    OMX_STRING sCompName = ((OMX_CONF_COMPTRACERDATATYPE *)(((OMX_COMPONENTTYPE *)hComponent)->pApplicationPrivate))->sComponentName;
-
-    pComp = ((OMX_CONF_COMPTRACERDATATYPE *)(((OMX_COMPONENTTYPE *)hComponent)->pApplicationPrivate))->pOrigComponent;
-    nMsec = OMX_OSAL_GetTime();
+    OMX_U64 nBeginNs, nNsec;
+    OMX_BOOL bInCall;
+    OMX_OSAL_COUNTERSTYPE oCounters;
+    OMX_CONF_RECORDEDCALLTYPE oArgs;
+    OMX_STRING sCompName = pTracerData->sComponentName;
+
+    pComp = pTracerData->pOrigComponent;
+    if (!OMX_CONF_TraceTimed()) {
+        eError = pComp->AllocateBuffer((OMX_HANDLETYPE)pComp, pBuffer, nPortIndex, pAppPrivate, nSizeBytes);
+        if (eError == OMX_ErrorNone)
+            OMX_CONF_ValidateBuffer(&pTracerData->oChecks, sCompName, OMX_CONF_TraceApiAllocateBuffer, pComp, *pBuffer, nPortIndex);
+        return eError;
+    }
+    bInCall = OMX_CONF_ILCallEnter();
+    OMX_CONF_CallCountersBegin(&oCounters);
+    nBeginNs = OMX_OSAL_GetTimeNs();
     eError = pComp->AllocateBuffer((OMX_HANDLETYPE)pComp, pBuffer, nPortIndex, pAppPrivate, nSizeBytes);
-    nMsec = OMX_OSAL_GetTime() - nMsec;
+    nNsec = OMX_OSAL_GetTimeNs() - nBeginNs;
+    OMX_CONF_ILCallLeave(bInCall);
+    OMX_CONF_CallCountersEnd(&pTracerData->oCounters[OMX_CONF_TraceApiAllocateBuffer], &oCounters);
+    if (eError == OMX_ErrorNone)
+        OMX_CONF_ValidateBuffer(&pTracerData->oChecks, sCompName, OMX_CONF_TraceApiAllocateBuffer, pComp, *pBuffer, nPortIndex);
+    OMX_CONF_TraceEvent(pTracerData->nNameId, OMX_CONF_TraceApiAllocateBuffer, nBeginNs, nNsec, (eError == OMX_ErrorNone) ? *pBuffer : NULL, eError);
+    if (g_OMX_CONF_bRecordArguments) {
+        OMX_CONF_RecordArgs(&oArgs, OMX_CONF_TraceApiAllocateBuffer, pComp, (eError == OMX_ErrorNone) ? *pBuffer : NULL, nPortIndex, nSizeBytes, 0);
+        OMX_CONF_TraceRecord(pTracerData->nNameId, OMX_CONF_TraceApiAllocateBuffer, nBeginNs, nNsec, eError, &oArgs, NULL, 0);
+    }
+    if (!OMX_CONF_TraceWanted(OMX_CONF_TRACE_CALLFLAGS | OMX_OSAL_TRACE_STATISTICS, nNsec, OMX_CONF_SHORT_TIMELIMIT))
+        return eError;
 
     if (g_OMX_CONF_hTraceMutex) OMX_OSAL_MutexLock(g_OMX_CONF_hTraceMutex);
 
@@ -909,7 +2351,8 @@ OMX_ERRORTYPE Trace_AllocateBuffer(
     OMX_OSAL_Trace(OMX_OSAL_TRACE_PARAMETERS, "\n\tnPortIndex = 0x%08x", nPortIndex);
     OMX_OSAL_Trace(OMX_OSAL_TRACE_PARAMETERS, "\n\tpAppPrivate = 0x%08x", pAppPrivate);
     OMX_OSAL_Trace(OMX_OSAL_TRACE_PARAMETERS, "\n\tnSizeBytes = 0x%08x", nSizeBytes);
-    OMX_OSAL_TraceResultAndTime(eError,nMsec,OMX_CONF_SHORT_TIMELIMIT, sCompName, "AllocateBuffer");
+    OMX_CONF_TraceLatency(hComponent, OMX_CONF_TraceApiAllocateBuffer, nNsec);
+    OMX_OSAL_TraceResultAndTime(eError,nNsec,OMX_CONF_SHORT_TIMELIMIT, sCompName, "AllocateBuffer");
 
     if (g_OMX_CONF_hTraceMutex) OMX_OSAL_MutexUnlock(g_OMX_CONF_hTraceMutex);
 
@@ -922,29 +2365,51 @@ OMX_ERRORTYPE Trace_FreeBuffer(
         OMX_IN OMX_U32 nPortIndex,
         OMX_IN  OMX_BUFFERHEADERTYPE* pBuffer)
 {
+    OMX_CONF_COMPTRACERDATATYPE *pTracerData = (OMX_CONF_COMPTRACERDATATYPE *)((OMX_COMPONENTTYPE *)hComponent)->pApplicationPrivate;
     OMX_ERRORTYPE eError;
     OMX_COMPONENTTYPE *pComp;
-    OMX_U32 nMsec;
-    OMX_STRING sCompName = ((OMX_CONF_COMPTRACERDATATYPE *)(((OMX_COMPONENTTYPE *)hComponent)->pApplicationPrivate))->sComponentName;
+    OMX_U64 nBeginNs, nNsec;
+    OMX_BOOL bInCall;
+    OMX_OSAL_COUNTERSTYPE oCounters;
+    OMX_BOOL bRecord = g_OMX_CONF_bRecordArguments;
+    OMX_CONF_RECORDEDCALLTYPE oArgs;
+    OMX_STRING sCompName = pTracerData->sComponentName;
 
     /* do a trace buffer prior to freeing the buffer */
-    if (g_OMX_CONF_hTraceMutex) OMX_OSAL_MutexLock(g_OMX_CONF_hTraceMutex);
+    if (g_OMX_OSAL_TraceFlags & OMX_CONF_TRACE_CALLFLAGS) {
+        if (g_OMX_CONF_hTraceMutex) OMX_OSAL_MutexLock(g_OMX_CONF_hTraceMutex);
 
-    OMX_OSAL_Trace(OMX_OSAL_TRACE_CALLSEQUENCE, "%s<- FreeBuffer(", sCompName);
-    OMX_OSAL_Trace(OMX_OSAL_TRACE_PARAMETERS, "\n\thComponent = 0x%08x", hComponent);
-    OMX_OSAL_Trace(OMX_OSAL_TRACE_PARAMETERS, "\n\tnPortIndex = 0x%08x", nPortIndex);
-    OMX_OSAL_Trace(OMX_OSAL_TRACE_PARAMETERS, "\n\tpBuffer = 0x%08x", pBuffer);
-    OMX_CONF_TraceBuffer(pBuffer);
+        OMX_OSAL_Trace(OMX_OSAL_TRACE_CALLSEQUENCE, "%s<- FreeBuffer(", sCompName);
+        OMX_OSAL_Trace(OMX_OSAL_TRACE_PARAMETERS, "\n\thComponent = 0x%08x", hComponent);
+        OMX_OSAL_Trace(OMX_OSAL_TRACE_PARAMETERS, "\n\tnPortIndex = 0x%08x", nPortIndex);
+        OMX_OSAL_Trace(OMX_OSAL_TRACE_PARAMETERS, "\n\tpBuffer = 0x%08x", pBuffer);
+        OMX_CONF_TraceBuffer(pBuffer);
 
-    if (g_OMX_CONF_hTraceMutex) OMX_OSAL_MutexUnlock(g_OMX_CONF_hTraceMutex);
+        if (g_OMX_CONF_hTraceMutex) OMX_OSAL_MutexUnlock(g_OMX_CONF_hTraceMutex);
+    }
 
-    pComp = ((OMX_CONF_COMPTRACERDATATYPE *)(((OMX_COMPONENTTYPE *)hComponent)->pApplicationPrivate))->pOrigComponent;
-    nMsec = OMX_OSAL_GetTime();
+    pComp = pTracerData->pOrigComponent;
+    OMX_CONF_ValidateBuffer(&pTracerData->oChecks, sCompName, OMX_CONF_TraceApiFreeBuffer, pComp, pBuffer, nPortIndex);
+    if (!OMX_CONF_TraceTimed())
+        return pComp->FreeBuffer((OMX_HANDLETYPE)pComp, nPortIndex, pBuffer);
+    if (bRecord)
+        OMX_CONF_RecordArgs(&oArgs, OMX_CONF_TraceApiFreeBuffer, pComp, pBuffer, nPortIndex, 0, 0);
+    bInCall = OMX_CONF_ILCallEnter();
+    OMX_CONF_CallCountersBegin(&oCounters);
+    nBeginNs = OMX_OSAL_GetTimeNs();
     eError = pComp->FreeBuffer((OMX_HANDLETYPE)pComp, nPortIndex, pBuffer);
-    nMsec = OMX_OSAL_GetTime() - nMsec;
+    nNsec = OMX_OSAL_GetTimeNs() - nBeginNs;
+    OMX_CONF_ILCallLeave(bInCall);
+    OMX_CONF_CallCountersEnd(&pTracerData->oCounters[OMX_CONF_TraceApiFreeBuffer], &oCounters);
+    OMX_CONF_TraceEvent(pTracerData->nNameId, OMX_CONF_TraceApiFreeBuffer, nBeginNs, nNsec, pBuffer, eError);
+    if (bRecord)
+        OMX_CONF_TraceRecord(pTracerData->nNameId, OMX_CONF_TraceApiFreeBuffer, nBeginNs, nNsec, eError, &oArgs, NULL, 0);
+    if (!OMX_CONF_TraceWanted(OMX_CONF_TRACE_CALLFLAGS | OMX_OSAL_TRACE_STATISTICS, nNsec, OMX_CONF_LONG_TIMELIMIT))
+        return eError;
 
     if (g_OMX_CONF_hTraceMutex) OMX_OSAL_MutexLock(g_OMX_CONF_hTraceMutex);
-    OMX_OSAL_TraceResultAndTime(eError,nMsec,OMX_CONF_LONG_TIMELIMIT, sCompName, "FreeBuffer");
+    OMX_CONF_TraceLatency(hComponent, OMX_CONF_TraceApiFreeBuffer, nNsec);
+    OMX_OSAL_TraceResultAndTime(eError,nNsec,OMX_CONF_LONG_TIMELIMIT, sCompName, "FreeBuffer");
     if (g_OMX_CONF_hTraceMutex) OMX_OSAL_MutexUnlock(g_OMX_CONF_hTraceMutex);
 
     return eError;
@@ -955,27 +2420,60 @@ OMX_ERRORTYPE Trace_EmptyThisBuffer(
         OMX_IN  OMX_HANDLETYPE hComponent,
         OMX_IN  OMX_BUFFERHEADERTYPE* pBuffer)
 {
+    OMX_CONF_COMPTRACERDATATYPE *pTracerData = (OMX_CONF_COMPTRACERDATATYPE *)((OMX_COMPONENTTYPE *)hComponent)->pApplicationPrivate;
     OMX_ERRORTYPE eError;
     OMX_COMPONENTTYPE *pComp;
-    OMX_U32 nMsec;
-    OMX_STRING sCompName = ((OMX_CONF_COMPTRACERDATATYPE *)(((OMX_COMPONENTTYPE *)hComponent)->pApplicationPrivate))->sComponentName;
-
-    if (g_OMX_CONF_hTraceMutex) OMX_OSAL_MutexLock(g_OMX_CONF_hTraceMutex);
-
-    OMX_OSAL_Trace(OMX_OSAL_TRACE_CALLSEQUENCE, "%s<- EmptyThisBuffer(", sCompName);
-    OMX_OSAL_Trace(OMX_OSAL_TRACE_PARAMETERS, "\n\thComponent = 0x%08x", hComponent);
-    OMX_OSAL_Trace(OMX_OSAL_TRACE_PARAMETERS, "\n\tpBuffer = 0x%08x", pBuffer);
-    OMX_CONF_TraceBuffer(pBuffer);
-
-    if (g_OMX_CONF_hTraceMutex) OMX_OSAL_MutexUnlock(g_OMX_CONF_hTraceMutex);
+    OMX_U64 nBeginNs, nNsec;
+    OMX_BOOL bInCall;
+    OMX_OSAL_COUNTERSTYPE oCounters;
+    OMX_BOOL bRecord = g_OMX_CONF_bRecordArguments;
+    OMX_CONF_RECORDEDCALLTYPE oArgs;
+    OMX_STRING sCompName = pTracerData->sComponentName;
+
+    if (g_OMX_OSAL_TraceFlags & (OMX_CONF_TRACE_CALLFLAGS | OMX_OSAL_TRACE_STATISTICS | OMX_OSAL_TRACE_VALIDATE)) {
+        if (g_OMX_CONF_hTraceMutex) OMX_OSAL_MutexLock(g_OMX_CONF_hTraceMutex);
+
+        OMX_OSAL_Trace(OMX_OSAL_TRACE_CALLSEQUENCE, "%s<- EmptyThisBuffer(", sCompName);
+        OMX_OSAL_Trace(OMX_OSAL_TRACE_PARAMETERS, "\n\thComponent = 0x%08x", hComponent);
+        OMX_OSAL_Trace(OMX_OSAL_TRACE_PARAMETERS, "\n\tpBuffer = 0x%08x", pBuffer);
+        OMX_CONF_TraceBuffer(pBuffer);
+        OMX_CONF_BufferSubmitted(pTracerData->oTraffic, pBuffer, OMX_FALSE);
+        if (g_OMX_OSAL_TraceFlags & OMX_OSAL_TRACE_VALIDATE)
+            OMX_CONF_BufferCheck(&pTracerData->oChecks, sCompName, OMX_CONF_TraceApiEmptyThisBuffer, 
+                                 pTracerData->pOrigComponent, pBuffer, 0);
+
+        if (g_OMX_CONF_hTraceMutex) OMX_OSAL_MutexUnlock(g_OMX_CONF_hTraceMutex);
+    }
 
-    pComp = ((OMX_CONF_COMPTRACERDATATYPE *)(((OMX_COMPONENTTYPE *)hComponent)->pApplicationPrivate))->pOrigComponent;
-    nMsec = OMX_OSAL_GetTime();
+    pComp = pTracerData->pOrigComponent;
+    if (!OMX_CONF_TraceTimed()) {
+        eError = pComp->EmptyThisBuffer((OMX_HANDLETYPE)pComp, pBuffer);
+        if (eError != OMX_ErrorNone)
+            OMX_CONF_BufferRefused(pBuffer);
+        return eError;
+    }
+    if (bRecord)
+        OMX_CONF_RecordArgs(&oArgs, OMX_CONF_TraceApiEmptyThisBuffer, pComp, pBuffer, 0, 0, 0);
+    bInCall = OMX_CONF_ILCallEnter();
+    OMX_CONF_CallCountersBegin(&oCounters);
+    nBeginNs = OMX_OSAL_GetTimeNs();
     eError = pComp->EmptyThisBuffer((OMX_HANDLETYPE)pComp, pBuffer);
-    nMsec = OMX_OSAL_GetTime() - nMsec;
+    nNsec = OMX_OSAL_GetTimeNs() - nBeginNs;
+    OMX_CONF_ILCallLeave(bInCall);
+    OMX_CONF_CallCountersEnd(&pTracerData->oCounters[OMX_CONF_TraceApiEmptyThisBuffer], &oCounters);
+    if (eError != OMX_ErrorNone)
+        OMX_CONF_BufferRefused(pBuffer);
+    OMX_CONF_TraceEvent(pTracerData->nNameId, OMX_CONF_TraceApiEmptyThisBuffer, nBeginNs, nNsec, pBuffer, eError);
+    if (bRecord)
+        OMX_CONF_TraceRecord(pTracerData->nNameId, OMX_CONF_TraceApiEmptyThisBuffer, nBeginNs, nNsec, eError, &oArgs, NULL, 0);
+    if (!OMX_CONF_TraceWanted(OMX_CONF_TRACE_CALLFLAGS | OMX_OSAL_TRACE_STATISTICS, nNsec, OMX_CONF_SHORT_TIMELIMIT))
+        return eError;
 
     if (g_OMX_CONF_hTraceMutex) OMX_OSAL_MutexLock(g_OMX_CONF_hTraceMutex);
-    OMX_OSAL_TraceResultAndTime(eError,nMsec,OMX_CONF_SHORT_TIMELIMIT, sCompName, "EmptyThisBuffer");
+    if (eError != OMX_ErrorNone)
+        OMX_CONF_BufferReturned(pBuffer, nBeginNs + nNsec, OMX_FALSE);
+    OMX_CONF_TraceLatency(hComponent, OMX_CONF_TraceApiEmptyThisBuffer, nNsec);
+    OMX_OSAL_TraceResultAndTime(eError,nNsec,OMX_CONF_SHORT_TIMELIMIT, sCompName, "EmptyThisBuffer");
     if (g_OMX_CONF_hTraceMutex) OMX_OSAL_MutexUnlock(g_OMX_CONF_hTraceMutex);
 
     return eError;
@@ -986,27 +2484,60 @@ OMX_ERRORTYPE Trace_FillThisBuffer(
         OMX_IN  OMX_HANDLETYPE hComponent,
         OMX_IN  OMX_BUFFERHEADERTYPE* pBuffer)
 {
+    OMX_CONF_COMPTRACERDATATYPE *pTracerData = (OMX_CONF_COMPTRACERDATATYPE *)((OMX_COMPONENTTYPE *)hComponent)->pApplicationPrivate;
     OMX_ERRORTYPE eError;
     OMX_COMPONENTTYPE *pComp;
-    OMX_U32 nMsec;
-    OMX_STRING sCompName = ((OMX_CONF_COMPTRACERDATATYPE *)(((OMX_COMPONENTTYPE *)hComponent)->pApplicationPrivate))->sComponentName;
-
-    if (g_OMX_CONF_hTraceMutex) OMX_OSAL_MutexLock(g_OMX_CONF_hTraceMutex);
-
-    OMX_OSAL_Trace(OMX_OSAL_TRACE_CALLSEQUENCE, "%s<- FillThisBuffer(", sCompName);
-    OMX_OSAL_Trace(OMX_OSAL_TRACE_PARAMETERS, "\n\thComponent = 0x%08x", hComponent);
-    OMX_OSAL_Trace(OMX_OSAL_TRACE_PARAMETERS, "\n\tpBuffer = 0x%08x", pBuffer);
-    OMX_CONF_TraceBuffer(pBuffer);
-
-    if (g_OMX_CONF_hTraceMutex) OMX_OSAL_MutexUnlock(g_OMX_CONF_hTraceMutex);
+    OMX_U64 nBeginNs, nNsec;
+    OMX_BOOL bInCall;
+    OMX_OSAL_COUNTERSTYPE oCounters;
+    OMX_BOOL bRecord = g_OMX_CONF_bRecordArguments;
+    OMX_CONF_RECORDEDCALLTYPE oArgs;
+    OMX_STRING sCompName = pTracerData->sComponentName;
+
+    if (g_OMX_OSAL_TraceFlags & (OMX_CONF_TRACE_CALLFLAGS | OMX_OSAL_TRACE_STATISTICS | OMX_OSAL_TRACE_VALIDATE)) {
+        if (g_OMX_CONF_hTraceMutex) OMX_OSAL_MutexLock(g_OMX_CONF_hTraceMutex);
+
+        OMX_OSAL_Trace(OMX_OSAL_TRACE_CALLSEQUENCE, "%s<- FillThisBuffer(", sCompName);
+        OMX_OSAL_Trace(OMX_OSAL_TRACE_PARAMETERS, "\n\thComponent = 0x%08x", hComponent);
+        OMX_OSAL_Trace(OMX_OSAL_TRACE_PARAMETERS, "\n\tpBuffer = 0x%08x", pBuffer);
+        OMX_CONF_TraceBuffer(pBuffer);
+        OMX_CONF_BufferSubmitted(pTracerData->oTraffic, pBuffer, OMX_TRUE);
+        if (g_OMX_OSAL_TraceFlags & OMX_OSAL_TRACE_VALIDATE)
+            OMX_CONF_BufferCheck(&pTracerData->oChecks, sCompName, OMX_CONF_TraceApiFillThisBuffer, 
+                                 pTracerData->pOrigComponent, pBuffer, 0);
+
+        if (g_OMX_CONF_hTraceMutex) OMX_OSAL_MutexUnlock(g_OMX_CONF_hTraceMutex);
+    }
 
-    pComp = ((OMX_CONF_COMPTRACERDATATYPE *)(((OMX_COMPONENTTYPE *)hComponent)->pApplicationPrivate))->pOrigComponent;
-    nMsec = OMX_OSAL_GetTime();
+    pComp = pTracerData->pOrigComponent;
+    if (!OMX_CONF_TraceTimed()) {
+        eError = pComp->FillThisBuffer((OMX_HANDLETYPE)pComp, pBuffer);
+        if (eError != OMX_ErrorNone)
+            OMX_CONF_BufferRefused(pBuffer);
+        return eError;
+    }
+    if (bRecord)
+        OMX_CONF_RecordArgs(&oArgs, OMX_CONF_TraceApiFillThisBuffer, pComp, pBuffer, 0, 0, 0);
+    bInCall = OMX_CONF_ILCallEnter();
+    OMX_CONF_CallCountersBegin(&oCounters);
+    nBeginNs = OMX_OSAL_GetTimeNs();
     eError = pComp->FillThisBuffer((OMX_HANDLETYPE)pComp, pBuffer);
-    nMsec = OMX_OSAL_GetTime() - nMsec;
+    nNsec = OMX_OSAL_GetTimeNs() - nBeginNs;
+    OMX_CONF_ILCallLeave(bInCall);
+    OMX_CONF_CallCountersEnd(&pTracerData->oCounters[OMX_CONF_TraceApiFillThisBuffer], &oCounters);
+    if (eError != OMX_ErrorNone)
+        OMX_CONF_BufferRefused(pBuffer);
+    OMX_CONF_TraceEvent(pTracerData->nNameId, OMX_CONF_TraceApiFillThisBuffer, nBeginNs, nNsec, pBuffer, eError);
+    if (bRecord)
+        OMX_CONF_TraceRecord(pTracerData->nNameId, OMX_CONF_TraceApiFillThisBuffer, nBeginNs, nNsec, eError, &oArgs, NULL, 0);
+    if (!OMX_CONF_TraceWanted(OMX_CONF_TRACE_CALLFLAGS | OMX_OSAL_TRACE_STATISTICS, nNsec, OMX_CONF_SHORT_TIMELIMIT))
+        return eError;
 
     if (g_OMX_CONF_hTraceMutex) OMX_OSAL_MutexLock(g_OMX_CONF_hTraceMutex);
-    OMX_OSAL_TraceResultAndTime(eError,nMsec,OMX_CONF_SHORT_TIMELIMIT, sCompName, "FillThisBuffer");
+    if (eError != OMX_ErrorNone)
+        OMX_CONF_BufferReturned(pBuffer, nBeginNs + nNsec, OMX_FALSE);
+    OMX_CONF_TraceLatency(hComponent, OMX_CONF_TraceApiFillThisBuffer, nNsec);
+    OMX_OSAL_TraceResultAndTime(eError,nNsec,OMX_CONF_SHORT_TIMELIMIT, sCompName, "FillThisBuffer");
     if (g_OMX_CONF_hTraceMutex) OMX_OSAL_MutexUnlock(g_OMX_CONF_hTraceMutex);
 
     return eError;
@@ -1017,15 +2548,32 @@ OMX_ERRORTYPE Trace_SetCallbacks(
         OMX_IN  OMX_CALLBACKTYPE* pCallbacks,
         OMX_IN  OMX_PTR pAppData)
 {
+    OMX_CONF_COMPTRACERDATATYPE *pTracerData = (OMX_CONF_COMPTRACERDATATYPE *)((OMX_COMPONENTTYPE *)hComponent)->pApplicationPrivate;
     OMX_ERRORTYPE eError;
     OMX_COMPONENTTYPE *pComp;
-    OMX_U32 nMsec;
-    OMX_STRING sCompName = ((OMX_CONF_COMPTRACERDATATYPE *)(((OMX_COMPONENTTYPE *)hComponent)->pApplicationPrivate))->sComponentName;
-
-    pComp = ((OMX_CONF_COMPTRACERDATATYPE *)(((OMX_COMPONENTTYPE *)hComponent)->pApplicationPrivate))->pOrigComponent;
-    nMsec = OMX_OSAL_GetTime();
+    OMX_U64 nBeginNs, nNsec;
+    OMX_BOOL bInCall;
+    OMX_OSAL_COUNTERSTYPE oCounters;
+    OMX_CONF_RECORDEDCALLTYPE oArgs;
+    OMX_STRING sCompName = pTracerData->sComponentName;
+
+    pComp = pTracerData->pOrigComponent;
+    if (!OMX_CONF_TraceTimed())
+        return pComp->SetCallbacks((OMX_HANDLETYPE)pComp, pCallbacks, pAppData);
+    bInCall = OMX_CONF_ILCallEnter();
+    OMX_CONF_CallCountersBegin(&oCounters);
+    nBeginNs = OMX_OSAL_GetTimeNs();
     eError = pComp->SetCallbacks((OMX_HANDLETYPE)pComp, pCallbacks, pAppData);
-    nMsec = OMX_OSAL_GetTime() - nMsec;
+    nNsec = OMX_OSAL_GetTimeNs() - nBeginNs;
+    OMX_CONF_ILCallLeave(bInCall);
+    OMX_CONF_CallCountersEnd(&pTracerData->oCounters[OMX_CONF_TraceApiSetCallbacks], &oCounters);
+    OMX_CONF_TraceEvent(pTracerData->nNameId, OMX_CONF_TraceApiSetCallbacks, nBeginNs, nNsec, NULL, eError);
+    if (g_OMX_CONF_bRecordArguments) {
+        OMX_CONF_RecordArgs(&oArgs, OMX_CONF_TraceApiSetCallbacks, pComp, NULL, 0, 0, 0);
+        OMX_CONF_TraceRecord(pTracerData->nNameId, OMX_CONF_TraceApiSetCallbacks, nBeginNs, nNsec, eError, &oArgs, NULL, 0);
+    }
+    if (!OMX_CONF_TraceWanted(OMX_CONF_TRACE_CALLFLAGS | OMX_OSAL_TRACE_STATISTICS, nNsec, OMX_CONF_SHORT_TIMELIMIT))
+        return eError;
 
     if (g_OMX_CONF_hTraceMutex) OMX_OSAL_MutexLock(g_OMX_CONF_hTraceMutex);
 
@@ -1033,7 +2581,8 @@ OMX_ERRORTYPE Trace_SetCallbacks(
     OMX_OSAL_Trace(OMX_OSAL_TRACE_PARAMETERS, "\n\thComponent = 0x%08x", hComponent);
     OMX_OSAL_Trace(OMX_OSAL_TRACE_PARAMETERS, "\n\tpCallbacks = 0x%08x", pCallbacks);
     OMX_OSAL_Trace(OMX_OSAL_TRACE_PARAMETERS, "\n\tpAppData = 0x%08x", pAppData);
-    OMX_OSAL_TraceResultAndTime(eError,nMsec,OMX_CONF_SHORT_TIMELIMIT, sCompName, "SetCallbacks");
+    OMX_CONF_TraceLatency(hComponent, OMX_CONF_TraceApiSetCallbacks, nNsec);
+    OMX_OSAL_TraceResultAndTime(eError,nNsec,OMX_CONF_SHORT_TIMELIMIT, sCompName, "SetCallbacks");
 
     if (g_OMX_CONF_hTraceMutex) OMX_OSAL_MutexUnlock(g_OMX_CONF_hTraceMutex);
 
@@ -1043,21 +2592,39 @@ OMX_ERRORTYPE Trace_SetCallbacks(
 OMX_ERRORTYPE Trace_ComponentDeInit(
         OMX_IN  OMX_HANDLETYPE hComponent)
 {
+    OMX_CONF_COMPTRACERDATATYPE *pTracerData = (OMX_CONF_COMPTRACERDATATYPE *)((OMX_COMPONENTTYPE *)hComponent)->pApplicationPrivate;
     OMX_ERRORTYPE eError;
     OMX_COMPONENTTYPE *pComp;
-    OMX_U32 nMsec;
-    OMX_STRING sCompName = ((OMX_CONF_COMPTRACERDATATYPE *)(((OMX_COMPONENTTYPE *)hComponent)->pApplicationPrivate))->sComponentName;
-
-    pComp = ((OMX_CONF_COMPTRACERDATATYPE *)(((OMX_COMPONENTTYPE *)hComponent)->pApplicationPrivate))->pOrigComponent;
-    nMsec = OMX_OSAL_GetTime();
+    OMX_U64 nBeginNs, nNsec;
+    OMX_BOOL bInCall;
+    OMX_OSAL_COUNTERSTYPE oCounters;
+    OMX_CONF_RECORDEDCALLTYPE oArgs;
+    OMX_STRING sCompName = pTracerData->sComponentName;
+
+    pComp = pTracerData->pOrigComponent;
+    if (!OMX_CONF_TraceTimed())
+        return (pComp->ComponentDeInit)((OMX_HANDLETYPE)pComp);
+    bInCall = OMX_CONF_ILCallEnter();
+    OMX_CONF_CallCountersBegin(&oCounters);
+    nBeginNs = OMX_OSAL_GetTimeNs();
     eError = (pComp->ComponentDeInit)((OMX_HANDLETYPE)pComp);
-    nMsec = OMX_OSAL_GetTime() - nMsec;
+    nNsec = OMX_OSAL_GetTimeNs() - nBeginNs;
+    OMX_CONF_ILCallLeave(bInCall);
+    OMX_CONF_CallCountersEnd(&pTracerData->oCounters[OMX_CONF_TraceApiComponentDeInit], &oCounters);
+    OMX_CONF_TraceEvent(pTracerData->nNameId, OMX_CONF_TraceApiComponentDeInit, nBeginNs, nNsec, NULL, eError);
+    if (g_OMX_CONF_bRecordArguments) {
+        OMX_CONF_RecordArgs(&oArgs, OMX_CONF_TraceApiComponentDeInit, pComp, NULL, 0, 0, 0);
+        OMX_CONF_TraceRecord(pTracerData->nNameId, OMX_CONF_TraceApiComponentDeInit, nBeginNs, nNsec, eError, &oArgs, NULL, 0);
+    }
+    if (!OMX_CONF_TraceWanted(OMX_CONF_TRACE_CALLFLAGS | OMX_OSAL_TRACE_STATISTICS, nNsec, OMX_CONF_LONG_TIMELIMIT))
+        return eError;
 
     if (g_OMX_CONF_hTraceMutex) OMX_OSAL_MutexLock(g_OMX_CONF_hTraceMutex);
 
     OMX_OSAL_Trace(OMX_OSAL_TRACE_CALLSEQUENCE, "%s<- ComponentDeInit(", sCompName);
     OMX_OSAL_Trace(OMX_OSAL_TRACE_PARAMETERS, "\n\thComponent = 0x%08x", hComponent);
-    OMX_OSAL_TraceResultAndTime(eError,nMsec,OMX_CONF_LONG_TIMELIMIT, sCompName, "ComponentDeInit");
+    OMX_CONF_TraceLatency(hComponent, OMX_CONF_TraceApiComponentDeInit, nNsec);
+    OMX_OSAL_TraceResultAndTime(eError,nNsec,OMX_CONF_LONG_TIMELIMIT, sCompName, "ComponentDeInit");
 
     if (g_OMX_CONF_hTraceMutex) OMX_OSAL_MutexUnlock(g_OMX_CONF_hTraceMutex);
 
@@ -1073,6 +2640,7 @@ OMX_ERRORTYPE OMX_CONF_ComponentTracerCreate( OMX_IN OMX_HANDLETYPE hOrigComp,
     OMX_CONF_COMPTRACERDATATYPE *pTracerData;
     OMX_COMPONENTTYPE *pOrigComp;
     OMX_COMPONENTTYPE *pWrappedComp;
+    OMX_CONF_RECORDEDCALLTYPE oArgs;
 
     pOrigComp = (OMX_COMPONENTTYPE *)hOrigComp;
 
@@ -1089,9 +2657,17 @@ OMX_ERRORTYPE OMX_CONF_ComponentTracerCreate( OMX_IN OMX_HANDLETYPE hOrigComp,
        return OMX_ErrorInsufficientResources;
     }
 
+    memset(pTracerData, 0, sizeof(OMX_CONF_COMPTRACERDATATYPE));
     pTracerData->pOrigComponent = pOrigComp;
     strcpy(pTracerData->sComponentName, sComponentName);
+    OMX_CONF_TraceApiIdsInit();
+    pTracerData->nNameId = OMX_OSAL_EventLogName(sComponentName);
     pWrappedComp->pApplicationPrivate = (OMX_PTR)pTracerData;
+    if (g_OMX_CONF_bRecordArguments) {
+        OMX_CONF_RecordArgs(&oArgs, OMX_CONF_TraceApiTracerCreate, hOrigComp, NULL, 0, 0, 0);
+        OMX_CONF_TraceRecord(pTracerData->nNameId, OMX_CONF_TraceApiTracerCreate, OMX_OSAL_GetTimeNs(), 0, OMX_ErrorNone,
+                             &oArgs, sComponentName, (OMX_U32)strlen(sComponentName) + 1);
+    }
 
     /* Copy all */
     pWrappedComp->nSize = sizeof(OMX_COMPONENTTYPE);
@@ -1121,14 +2697,46 @@ OMX_ERRORTYPE OMX_CONF_ComponentTracerCreate( OMX_IN OMX_HANDLETYPE hOrigComp,
     return OMX_ErrorNone;
 }
 
+OMX_ERRORTYPE OMX_CONF_ComponentTracerInfo(OMX_IN OMX_HANDLETYPE hComp,
+                                           OMX_OUT OMX_STRING *psComponentName,
+                                           OMX_OUT OMX_BOOL *pbParametersSet)
+{
+    OMX_CONF_COMPTRACERDATATYPE *pTracerData;
+
+    /* only tracers route GetParameter through the wrapper */
+    if (hComp == NULL || ((OMX_COMPONENTTYPE *)hComp)->GetParameter != Trace_GetParameter)
+        return OMX_ErrorBadParameter;
+    pTracerData = (OMX_CONF_COMPTRACERDATATYPE *)((OMX_COMPONENTTYPE *)hComp)->pApplicationPrivate;
+    *psComponentName = pTracerData->sComponentName;
+    *pbParametersSet = pTracerData->bParametersSet;
+    return OMX_ErrorNone;
+}
+
 OMX_ERRORTYPE OMX_CONF_ComponentTracerDestroy(OMX_IN OMX_HANDLETYPE hWrappedComp)
 {
     OMX_COMPONENTTYPE *pWrappedComp;
+    OMX_CONF_COMPTRACERDATATYPE *pTracerData;
+    OMX_CONF_RECORDEDCALLTYPE oArgs;
     pWrappedComp = (OMX_COMPONENTTYPE *)hWrappedComp;
     if (hWrappedComp == NULL)
         return OMX_ErrorNone;
+    pTracerData = (OMX_CONF_COMPTRACERDATATYPE *)pWrappedComp->pApplicationPrivate;
 
-    OMX_OSAL_Free(pWrappedComp->pApplicationPrivate);
+    if (g_OMX_CONF_bRecordArguments) {
+        OMX_CONF_RecordArgs(&oArgs, OMX_CONF_TraceApiTracerDestroy, pTracerData->pOrigComponent, NULL, 0, 0, 0);
+        OMX_CONF_TraceRecord(pTracerData->nNameId, OMX_CONF_TraceApiTracerDestroy, OMX_OSAL_GetTimeNs(), 0, OMX_ErrorNone,
+                             &oArgs, NULL, 0);
+    }
+
+    if (g_OMX_CONF_hTraceMutex) OMX_OSAL_MutexLock(g_OMX_CONF_hTraceMutex);
+    OMX_CONF_LatencyMetrics(pTracerData->oLatency);
+    OMX_CONF_LatencyMerge(pTracerData->sComponentName, pTracerData->oLatency);
+    OMX_CONF_TrafficReport(pTracerData->sComponentName, pTracerData->oTraffic);
+    OMX_CONF_BufferCheckReport(pTracerData->sComponentName, "calls", &pTracerData->oChecks, pTracerData->pOrigComponent);
+    OMX_CONF_CallCountersReport(pTracerData->sComponentName, pTracerData->oCounters);
+    if (g_OMX_CONF_hTraceMutex) OMX_OSAL_MutexUnlock(g_OMX_CONF_hTraceMutex);
+
+    OMX_OSAL_Free(pTracerData);
     OMX_OSAL_Free(pWrappedComp);
     return OMX_ErrorNone;
 }
@@ -1143,6 +2751,9 @@ typedef struct OMX_CONF_APPDATAWRAPPERTYPE {
     OMX_PTR pOrigAppData;
     char sComponentName[OMX_MAX_STRINGNAME_SIZE];
     OMX_CALLBACKTYPE *pOrigCallbacks;
+    OMX_U16 nNameId;
+    OMX_CONF_CALLBACKTHREADSTYPE oThreads;
+    OMX_CONF_BUFFERCHECKSTYPE oChecks;
 } OMX_CONF_APPDATAWRAPPERTYPE;
 
 /* wrapper functions */
@@ -1157,7 +2768,9 @@ OMX_ERRORTYPE Trace_EventHandler(
 {
     OMX_ERRORTYPE eError;
     OMX_CONF_APPDATAWRAPPERTYPE *pAppDataWrapper;
-    OMX_U32 nMsec;
+    OMX_U64 nBeginNs, nNsec;
+    OMX_CONF_RECORDEDCALLTYPE oArgs;
+    OMX_CONF_CALLBACKSAMPLETYPE oSample;
     char sEventName[256];
     char sCmdName[256];
     char sStateName[256];
@@ -1166,10 +2779,28 @@ OMX_ERRORTYPE Trace_EventHandler(
 
     pAppDataWrapper = (OMX_CONF_APPDATAWRAPPERTYPE *)pAppData;
 
-    nMsec = OMX_OSAL_GetTime();
+    /* before the test sees the event, so that it reads the new settings from the component */
+    if (OMX_EventPortSettingsChanged == eEvent)
+        OMX_CONF_TopologyInvalidate(pAppDataWrapper->sComponentName, nData1);
+    else if (OMX_EventCmdComplete == eEvent)
+        OMX_CONF_TimeoutCommandComplete(pAppDataWrapper->sComponentName, (OMX_COMMANDTYPE)nData1, nData2);
+
+    if (!OMX_CONF_TraceTimed())
+        return pAppDataWrapper->pOrigCallbacks->EventHandler(hComponent, pAppDataWrapper->pOrigAppData,
+            eEvent, nData1, nData2, pEventData);
+    OMX_CONF_CallbackBegin(&oSample);
+    nBeginNs = OMX_OSAL_GetTimeNs();
     eError = pAppDataWrapper->pOrigCallbacks->EventHandler(hComponent, pAppDataWrapper->pOrigAppData,
         eEvent, nData1, nData2, pEventData);
-    nMsec = OMX_OSAL_GetTime() - nMsec;
+    nNsec = OMX_OSAL_GetTimeNs() - nBeginNs;
+    OMX_CONF_CallbackEnd(&pAppDataWrapper->oThreads, OMX_CONF_TraceApiEventHandler, &oSample, nNsec);
+    OMX_CONF_TraceEvent(pAppDataWrapper->nNameId, OMX_CONF_TraceApiEventHandler, nBeginNs, nNsec, NULL, eError);
+    if (g_OMX_CONF_bRecordArguments) {
+        OMX_CONF_RecordArgs(&oArgs, OMX_CONF_TraceApiEventHandler, hComponent, NULL, (OMX_U32)eEvent, nData1, nData2);
+        OMX_CONF_TraceRecord(pAppDataWrapper->nNameId, OMX_CONF_TraceApiEventHandler, nBeginNs, nNsec, eError, &oArgs, NULL, 0);
+    }
+    if (!OMX_CONF_TraceWanted(OMX_CONF_TRACE_CALLFLAGS, nNsec, OMX_CONF_NOT_TESTED_TIMELIMIT))
+        return eError;
 
     if (g_OMX_CONF_hTraceMutex) OMX_OSAL_MutexLock(g_OMX_CONF_hTraceMutex);
     sCompName = pAppDataWrapper->sComponentName;
@@ -1235,7 +2866,7 @@ OMX_ERRORTYPE Trace_EventHandler(
         OMX_OSAL_Trace(OMX_OSAL_TRACE_PARAMETERS, "\n\tnData2 = 0x%08x", nData2);
         OMX_OSAL_Trace(OMX_OSAL_TRACE_PARAMETERS, "\n\tpEventData = 0x%08x", pEventData);
     }
-    OMX_OSAL_TraceResultAndTime(eError,nMsec,OMX_CONF_NOT_TESTED_TIMELIMIT, sCompName, "EventHandler");
+    OMX_OSAL_TraceResultAndTime(eError,nNsec,OMX_CONF_NOT_TESTED_TIMELIMIT, sCompName, "EventHandler");
 
     if (g_OMX_CONF_hTraceMutex) OMX_OSAL_MutexUnlock(g_OMX_CONF_hTraceMutex);
 
@@ -1249,15 +2880,38 @@ OMX_ERRORTYPE Trace_EmptyBufferDone(
 {
     OMX_ERRORTYPE eError;
     OMX_CONF_APPDATAWRAPPERTYPE *pAppDataWrapper;
-    OMX_U32 nMsec;
+    OMX_U64 nBeginNs, nNsec;
+    OMX_BOOL bRecord = g_OMX_CONF_bRecordArguments;
+    OMX_CONF_RECORDEDCALLTYPE oArgs;
+    OMX_CONF_CALLBACKSAMPLETYPE oSample;
     OMX_STRING sCompName;
 
     pAppDataWrapper = (OMX_CONF_APPDATAWRAPPERTYPE *)pAppData;
     sCompName = pAppDataWrapper->sComponentName;
 
-    nMsec = OMX_OSAL_GetTime();
+    if (g_OMX_OSAL_TraceFlags & (OMX_OSAL_TRACE_STATISTICS | OMX_OSAL_TRACE_VALIDATE)) {
+        if (g_OMX_CONF_hTraceMutex) OMX_OSAL_MutexLock(g_OMX_CONF_hTraceMutex);
+        if (g_OMX_OSAL_TraceFlags & OMX_OSAL_TRACE_STATISTICS)
+            OMX_CONF_BufferReturned(pBuffer, OMX_OSAL_GetTimeNs(), OMX_TRUE);
+        if (g_OMX_OSAL_TraceFlags & OMX_OSAL_TRACE_VALIDATE)
+            OMX_CONF_BufferCheck(&pAppDataWrapper->oChecks, sCompName, OMX_CONF_TraceApiEmptyBufferDone, hComponent, pBuffer, 0);
+        if (g_OMX_CONF_hTraceMutex) OMX_OSAL_MutexUnlock(g_OMX_CONF_hTraceMutex);
+    }
+
+    if (!OMX_CONF_TraceTimed())
+        return pAppDataWrapper->pOrigCallbacks->EmptyBufferDone(hComponent, pAppDataWrapper->pOrigAppData, pBuffer);
+    if (bRecord)
+        OMX_CONF_RecordArgs(&oArgs, OMX_CONF_TraceApiEmptyBufferDone, hComponent, pBuffer, 0, 0, 0);
+    OMX_CONF_CallbackBegin(&oSample);
+    nBeginNs = OMX_OSAL_GetTimeNs();
     eError = pAppDataWrapper->pOrigCallbacks->EmptyBufferDone(hComponent, pAppDataWrapper->pOrigAppData, pBuffer);
-    nMsec = OMX_OSAL_GetTime() - nMsec;
+    nNsec = OMX_OSAL_GetTimeNs() - nBeginNs;
+    OMX_CONF_CallbackEnd(&pAppDataWrapper->oThreads, OMX_CONF_TraceApiEmptyBufferDone, &oSample, nNsec);
+    OMX_CONF_TraceEvent(pAppDataWrapper->nNameId, OMX_CONF_TraceApiEmptyBufferDone, nBeginNs, nNsec, pBuffer, eError);
+    if (bRecord)
+        OMX_CONF_TraceRecord(pAppDataWrapper->nNameId, OMX_CONF_TraceApiEmptyBufferDone, nBeginNs, nNsec, eError, &oArgs, NULL, 0);
+    if (!OMX_CONF_TraceWanted(OMX_CONF_TRACE_CALLFLAGS, nNsec, OMX_CONF_NOT_TESTED_TIMELIMIT))
+        return eError;
 
     if (g_OMX_CONF_hTraceMutex) OMX_OSAL_MutexLock(g_OMX_CONF_hTraceMutex);
 
@@ -1266,7 +2920,7 @@ OMX_ERRORTYPE Trace_EmptyBufferDone(
     OMX_OSAL_Trace(OMX_OSAL_TRACE_PARAMETERS, "\n\tpAppData = 0x%08x", pAppData);
     OMX_OSAL_Trace(OMX_OSAL_TRACE_PARAMETERS, "\n\tpBuffer = 0x%08x", pBuffer);
     OMX_CONF_TraceBuffer(pBuffer);
-    OMX_OSAL_TraceResultAndTime(eError,nMsec,OMX_CONF_NOT_TESTED_TIMELIMIT, sCompName, "EmptyBufferDone");
+    OMX_OSAL_TraceResultAndTime(eError,nNsec,OMX_CONF_NOT_TESTED_TIMELIMIT, sCompName, "EmptyBufferDone");
 
     if (g_OMX_CONF_hTraceMutex) OMX_OSAL_MutexUnlock(g_OMX_CONF_hTraceMutex);
 
@@ -1280,15 +2934,38 @@ OMX_ERRORTYPE Trace_FillBufferDone(
 {
     OMX_ERRORTYPE eError;
     OMX_CONF_APPDATAWRAPPERTYPE *pAppDataWrapper;
-    OMX_U32 nMsec;
+    OMX_U64 nBeginNs, nNsec;
+    OMX_BOOL bRecord = g_OMX_CONF_bRecordArguments;
+    OMX_CONF_RECORDEDCALLTYPE oArgs;
+    OMX_CONF_CALLBACKSAMPLETYPE oSample;
     OMX_STRING sCompName;
 
     pAppDataWrapper = (OMX_CONF_APPDATAWRAPPERTYPE *)pAppData;
     sCompName = pAppDataWrapper->sComponentName;
 
-    nMsec = OMX_OSAL_GetTime();
+    if (g_OMX_OSAL_TraceFlags & (OMX_OSAL_TRACE_STATISTICS | OMX_OSAL_TRACE_VALIDATE)) {
+        if (g_OMX_CONF_hTraceMutex) OMX_OSAL_MutexLock(g_OMX_CONF_hTraceMutex);
+        if (g_OMX_OSAL_TraceFlags & OMX_OSAL_TRACE_STATISTICS)
+            OMX_CONF_BufferReturned(pBuffer, OMX_OSAL_GetTimeNs(), OMX_TRUE);
+        if (g_OMX_OSAL_TraceFlags & OMX_OSAL_TRACE_VALIDATE)
+            OMX_CONF_BufferCheck(&pAppDataWrapper->oChecks, sCompName, OMX_CONF_TraceApiFillBufferDone, hComponent, pBuffer, 0);
+        if (g_OMX_CONF_hTraceMutex) OMX_OSAL_MutexUnlock(g_OMX_CONF_hTraceMutex);
+    }
+
+    if (!OMX_CONF_TraceTimed())
+        return pAppDataWrapper->pOrigCallbacks->FillBufferDone( hComponent, pAppDataWrapper->pOrigAppData, pBuffer);
+    if (bRecord)
+        OMX_CONF_RecordArgs(&oArgs, OMX_CONF_TraceApiFillBufferDone, hComponent, pBuffer, 0, 0, 0);
+    OMX_CONF_CallbackBegin(&oSample);
+    nBeginNs = OMX_OSAL_GetTimeNs();
     eError = pAppDataWrapper->pOrigCallbacks->FillBufferDone( hComponent, pAppDataWrapper->pOrigAppData, pBuffer);
-    nMsec = OMX_OSAL_GetTime() - nMsec;
+    nNsec = OMX_OSAL_GetTimeNs() - nBeginNs;
+    OMX_CONF_CallbackEnd(&pAppDataWrapper->oThreads, OMX_CONF_TraceApiFillBufferDone, &oSample, nNsec);
+    OMX_CONF_TraceEvent(pAppDataWrapper->nNameId, OMX_CONF_TraceApiFillBufferDone, nBeginNs, nNsec, pBuffer, eError);
+    if (bRecord)
+        OMX_CONF_TraceRecord(pAppDataWrapper->nNameId, OMX_CONF_TraceApiFillBufferDone, nBeginNs, nNsec, eError, &oArgs, NULL, 0);
+    if (!OMX_CONF_TraceWanted(OMX_CONF_TRACE_CALLFLAGS, nNsec, OMX_CONF_NOT_TESTED_TIMELIMIT))
+        return eError;
 
     if (g_OMX_CONF_hTraceMutex) OMX_OSAL_MutexLock(g_OMX_CONF_hTraceMutex);
 
@@ -1297,7 +2974,7 @@ OMX_ERRORTYPE Trace_FillBufferDone(
     OMX_OSAL_Trace(OMX_OSAL_TRACE_PARAMETERS, "\n\tpAppData = 0x%08x", pAppData);
     OMX_OSAL_Trace(OMX_OSAL_TRACE_PARAMETERS, "\n\tpBuffer = 0x%08x", pBuffer);
     OMX_CONF_TraceBuffer(pBuffer);
-    OMX_OSAL_TraceResultAndTime(eError,nMsec,OMX_CONF_NOT_TESTED_TIMELIMIT, sCompName, "FillBufferDone");
+    OMX_OSAL_TraceResultAndTime(eError,nNsec,OMX_CONF_NOT_TESTED_TIMELIMIT, sCompName, "FillBufferDone");
 
     if (g_OMX_CONF_hTraceMutex) OMX_OSAL_MutexUnlock(g_OMX_CONF_hTraceMutex);
 
@@ -1332,9 +3009,12 @@ OMX_ERRORTYPE OMX_CONF_CallbackTracerCreate( OMX_IN OMX_CALLBACKTYPE *pOrigCallb
     }
 
     /* Store original values */
+    memset(*ppWrappedAppData, 0, sizeof(OMX_CONF_APPDATAWRAPPERTYPE));
     ((OMX_CONF_APPDATAWRAPPERTYPE*)*ppWrappedAppData)->pOrigCallbacks = pOrigCallbacks;
     ((OMX_CONF_APPDATAWRAPPERTYPE*)*ppWrappedAppData)->pOrigAppData = pOrigAppData;
     strcpy(((OMX_CONF_APPDATAWRAPPERTYPE*)*ppWrappedAppData)->sComponentName, sComponentName);
+    OMX_CONF_TraceApiIdsInit();
+    ((OMX_CONF_APPDATAWRAPPERTYPE*)*ppWrappedAppData)->nNameId = OMX_OSAL_EventLogName(sComponentName);
 
     return OMX_ErrorNone;
 }
@@ -1342,11 +3022,209 @@ OMX_ERRORTYPE OMX_CONF_CallbackTracerCreate( OMX_IN OMX_CALLBACKTYPE *pOrigCallb
 OMX_ERRORTYPE OMX_CONF_CallbackTracerDestroy(OMX_IN OMX_CALLBACKTYPE *pWrappedCallbacks,
                                              OMX_OUT OMX_PTR *pWrappedAppData)
 {
+   if (g_OMX_CONF_hTraceMutex) OMX_OSAL_MutexLock(g_OMX_CONF_hTraceMutex);
+   if (g_OMX_OSAL_TraceFlags & OMX_OSAL_TRACE_STATISTICS)
+       OMX_CONF_CallbackThreadReport(((OMX_CONF_APPDATAWRAPPERTYPE *)pWrappedAppData)->sComponentName, 
+           &((OMX_CONF_APPDATAWRAPPERTYPE *)pWrappedAppData)->oThreads);
+   OMX_CONF_BufferCheckReport(((OMX_CONF_APPDATAWRAPPERTYPE *)pWrappedAppData)->sComponentName, "callbacks",
+       &((OMX_CONF_APPDATAWRAPPERTYPE *)pWrappedAppData)->oChecks, NULL);
+   if (g_OMX_CONF_hTraceMutex) OMX_OSAL_MutexUnlock(g_OMX_CONF_hTraceMutex);
    OMX_OSAL_Free(pWrappedCallbacks);
    OMX_OSAL_Free(pWrappedAppData);
    return OMX_ErrorNone;
 }
 
+/**************************************************************
+ * TRACER BENCHMARK - cost of the component tracer around 
+ * EmptyThisBuffer of the stubbed component, under the current 
+ * trace flags.
+ **************************************************************/
+
+OMX_ERRORTYPE OMX_CONF_TraceBenchmark(OMX_IN OMX_U32 nCalls)
+{
+    OMX_COMPONENTTYPE oComp;
+    OMX_BUFFERHEADERTYPE oBuffer;
+    OMX_HANDLETYPE hWrappedComp;
+    OMX_ERRORTYPE eError;
+    OMX_U64 nDirectNs, nWrappedNs;
+    OMX_U32 i;
+
+    if (!nCalls)
+        nCalls = OMX_CONF_TRACE_BENCHMARK_CALLS;
+
+    memset(&oComp, 0, sizeof(OMX_COMPONENTTYPE));
+    oComp.nSize = sizeof(OMX_COMPONENTTYPE);
+    oComp.EmptyThisBuffer = StubbedEmptyThisBuffer;
+    memset(&oBuffer, 0, sizeof(OMX_BUFFERHEADERTYPE));
+    oBuffer.nSize = sizeof(OMX_BUFFERHEADERTYPE);
+
+    eError = OMX_CONF_ComponentTracerCreate(&oComp, "OMX.CONF.TraceBenchmark", &hWrappedComp);
+    if (eError != OMX_ErrorNone)
+        return eError;
+
+    nDirectNs = OMX_OSAL_GetTimeNs();
+    for (i = 0; i < nCalls; i++)
+        oComp.EmptyThisBuffer((OMX_HANDLETYPE)&oComp, &oBuffer);
+    nDirectNs = OMX_OSAL_GetTimeNs() - nDirectNs;
+
+    nWrappedNs = OMX_OSAL_GetTimeNs();
+    for (i = 0; i < nCalls; i++)
+        ((OMX_COMPONENTTYPE *)hWrappedComp)->EmptyThisBuffer(hWrappedComp, &oBuffer);
+    nWrappedNs = OMX_OSAL_GetTimeNs() - nWrappedNs;
+
+    OMX_CONF_ComponentTracerDestroy(hWrappedComp);
+
+    OMX_OSAL_Trace(OMX_OSAL_TRACE_INFO, "\nEmptyThisBuffer x %u with trace flags 0x%08x (ns per call):\n", 
+        nCalls, g_OMX_OSAL_TraceFlags);
+    OMX_OSAL_Trace(OMX_OSAL_TRACE_INFO, "\tdirect %.1f, traced %.1f, tracer overhead %.1f\n", 
+        (double)nDirectNs / nCalls, (double)nWrappedNs / nCalls, 
+        ((double)nWrappedNs - (double)nDirectNs) / nCalls);
+    return OMX_ErrorNone;
+}
+
+/**************************************************************
+ * TRACER TESTS - a tunneled pair of stub components handing 
+ * buffers to each other through their tracers with 
+ * OMX_OSAL_TRACE_VALIDATE on. Component is ignored.
+ **************************************************************/
+
+#define OMX_CONF_VALIDATETEST_BUFFERS   4
+#define OMX_CONF_VALIDATETEST_ROUNDS    8
+#define OMX_CONF_VALIDATETEST_SIZE      64
+#define OMX_CONF_VALIDATETEST_OUTPORT   1   /* of the source, the sink supplies its buffers */
+#define OMX_CONF_VALIDATETEST_INPORT    0   /* of the sink */
+
+static OMX_ERRORTYPE ValidateTestTunnelRequest(OMX_IN OMX_HANDLETYPE hComp, OMX_IN OMX_U32 nPort, OMX_IN OMX_HANDLETYPE hTunneledComp,
+                                               OMX_IN OMX_U32 nTunneledPort, OMX_INOUT OMX_TUNNELSETUPTYPE* pTunnelSetup)
+{
+    UNUSED_PARAMETER(hComp);
+    UNUSED_PARAMETER(nPort);
+    UNUSED_PARAMETER(hTunneledComp);
+    UNUSED_PARAMETER(nTunneledPort);
+    UNUSED_PARAMETER(pTunnelSetup);
+    return OMX_ErrorNone;
+}
+
+static OMX_ERRORTYPE ValidateTestUseBuffer(OMX_IN OMX_HANDLETYPE hComponent, OMX_INOUT OMX_BUFFERHEADERTYPE** ppBufferHdr,
+                                           OMX_IN OMX_U32 nPortIndex, OMX_IN OMX_PTR pAppPrivate, OMX_IN OMX_U32 nSizeBytes,
+                                           OMX_IN OMX_U8* pBuffer)
+{
+    OMX_BUFFERHEADERTYPE *pBufferHdr;
+
+    UNUSED_PARAMETER(hComponent);
+    pBufferHdr = (OMX_BUFFERHEADERTYPE *)OMX_OSAL_Malloc(sizeof(OMX_BUFFERHEADERTYPE));
+    if (!pBufferHdr)
+        return OMX_ErrorInsufficientResources;
+    memset(pBufferHdr, 0, sizeof(OMX_BUFFERHEADERTYPE));
+    pBufferHdr->nSize = sizeof(OMX_BUFFERHEADERTYPE);
+    pBufferHdr->nVersion.s.nVersionMajor = OMX_VERSION_MAJOR;
+    pBufferHdr->nVersion.s.nVersionMinor = OMX_VERSION_MINOR;
+    pBufferHdr->pBuffer = pBuffer;
+    pBufferHdr->nAllocLen = nSizeBytes;
+    pBufferHdr->pAppPrivate = pAppPrivate;
+    pBufferHdr->nOutputPortIndex = nPortIndex;
+    *ppBufferHdr = pBufferHdr;
+    return OMX_ErrorNone;
+}
+
+static OMX_ERRORTYPE ValidateTestFreeBuffer(OMX_IN OMX_HANDLETYPE hComponent, OMX_IN OMX_U32 nPortIndex,
+                                            OMX_IN OMX_BUFFERHEADERTYPE* pBuffer)
+{
+    UNUSED_PARAMETER(hComponent);
+    UNUSED_PARAMETER(nPortIndex);
+    OMX_OSAL_Free(pBuffer);
+    return OMX_ErrorNone;
+}
+
+static OMX_ERRORTYPE ValidateTestTakeBuffer(OMX_IN OMX_HANDLETYPE hComponent, OMX_IN OMX_BUFFERHEADERTYPE* pBuffer)
+{
+    UNUSED_PARAMETER(hComponent);
+    UNUSED_PARAMETER(pBuffer);
+    return OMX_ErrorNone;
+}
+
+static OMX_U32 ValidateTestViolations(OMX_HANDLETYPE hWrappedComp, OMX_CONF_BUFFERCHECKTYPE eCheck)
+{
+    return ((OMX_CONF_COMPTRACERDATATYPE *)((OMX_COMPONENTTYPE *)hWrappedComp)->pApplicationPrivate)->oChecks.nViolations[eCheck];
+}
+
+OMX_ERRORTYPE OMX_CONF_TraceValidateTest1(OMX_IN OMX_STRING cComponentName)
+{
+    OMX_ERRORTYPE eError = OMX_ErrorNone;
+    OMX_COMPONENTTYPE oSource, oSink;
+    OMX_COMPONENTTYPE *pSource = NULL, *pSink = NULL;
+    OMX_BUFFERHEADERTYPE *pBufferHdr[OMX_CONF_VALIDATETEST_BUFFERS];
+    OMX_U8 pData[OMX_CONF_VALIDATETEST_BUFFERS][OMX_CONF_VALIDATETEST_SIZE];
+    OMX_U32 nTraceFlags = g_OMX_OSAL_TraceFlags;
+    OMX_U32 nBuffers = 0, nRound, i, j, nViolations;
+
+    UNUSED_PARAMETER(cComponentName);
+
+    memset(&oSource, 0, sizeof(OMX_COMPONENTTYPE));
+    oSource.nSize = sizeof(OMX_COMPONENTTYPE);
+    oSource.ComponentTunnelRequest = ValidateTestTunnelRequest;
+    oSource.UseBuffer = ValidateTestUseBuffer;
+    oSource.FreeBuffer = ValidateTestFreeBuffer;
+    oSource.EmptyThisBuffer = ValidateTestTakeBuffer;
+    oSource.FillThisBuffer = ValidateTestTakeBuffer;
+    memcpy(&oSink, &oSource, sizeof(OMX_COMPONENTTYPE));
+
+    g_OMX_OSAL_TraceFlags |= OMX_OSAL_TRACE_VALIDATE;
+    OMX_CONF_FAIL_IF_ERROR(OMX_CONF_ComponentTracerCreate(&oSource, "OMX.CONF.ValidateSource", (OMX_HANDLETYPE *)&pSource));
+    OMX_CONF_FAIL_IF_ERROR(OMX_CONF_ComponentTracerCreate(&oSink, "OMX.CONF.ValidateSink", (OMX_HANDLETYPE *)&pSink));
+
+    /* as OMX_SetupTunnel does between the tracers */
+    OMX_CONF_FAIL_IF_ERROR(pSource->ComponentTunnelRequest(pSource, OMX_CONF_VALIDATETEST_OUTPORT, pSink, 
+                                                           OMX_CONF_VALIDATETEST_INPORT, NULL));
+    OMX_CONF_FAIL_IF_ERROR(pSink->ComponentTunnelRequest(pSink, OMX_CONF_VALIDATETEST_INPORT, pSource, 
+                                                         OMX_CONF_VALIDATETEST_OUTPORT, NULL));
+
+    /* the sink supplies the buffers, passes them to the source to fill, which passes them back to empty */
+    for (nBuffers = 0; nBuffers < OMX_CONF_VALIDATETEST_BUFFERS; nBuffers++) {
+        OMX_CONF_FAIL_IF_ERROR(pSource->UseBuffer(pSource, &pBufferHdr[nBuffers], OMX_CONF_VALIDATETEST_OUTPORT, NULL,
+                                                  OMX_CONF_VALIDATETEST_SIZE, pData[nBuffers]));
+        pBufferHdr[nBuffers]->nInputPortIndex = OMX_CONF_VALIDATETEST_INPORT;
+    }
+    for (nRound = 0; nRound < OMX_CONF_VALIDATETEST_ROUNDS; nRound++) {
+        for (i = 0; i < nBuffers; i++) {
+            pBufferHdr[i]->nFilledLen = 0;
+            OMX_CONF_FAIL_IF_ERROR(pSource->FillThisBuffer(pSource, pBufferHdr[i]));
+            pBufferHdr[i]->nFilledLen = OMX_CONF_VALIDATETEST_SIZE;
+            OMX_CONF_FAIL_IF_ERROR(pSink->EmptyThisBuffer(pSink, pBufferHdr[i]));
+        }
+    }
+
+    nViolations = 0;
+    for (j = 0; j < OMX_CONF_BUFFERCHECKS; j++)
+        nViolations += ValidateTestViolations(pSource, (OMX_CONF_BUFFERCHECKTYPE)j) + ValidateTestViolations(pSink, (OMX_CONF_BUFFERCHECKTYPE)j);
+    if (nViolations) {
+        OMX_OSAL_Trace(OMX_OSAL_TRACE_ERROR, "%u violations on handovers through a tunnel\n", nViolations);
+        OMX_CONF_FAIL();
+    }
+
+    /* the sink holds them all, the source cannot hand one over again */
+    OMX_CONF_FAIL_IF_ERROR(pSink->EmptyThisBuffer(pSink, pBufferHdr[0]));
+    OMX_CONF_FAIL_IF_NEQ(ValidateTestViolations(pSink, OMX_CONF_BufferCheckOwner), 1);
+
+OMX_CONF_TEST_FAIL:
+    /* the supplier frees its buffers on the source */
+    for (i = 0; i < nBuffers; i++)
+        pSource->FreeBuffer(pSource, OMX_CONF_VALIDATETEST_OUTPORT, pBufferHdr[i]);
+    if (eError == OMX_ErrorNone && (ValidateTestViolations(pSource, OMX_CONF_BufferCheckOwner) ||
+                                    ValidateTestViolations(pSink, OMX_CONF_BufferCheckOwner) != 1)) {
+        OMX_OSAL_Trace(OMX_OSAL_TRACE_ERROR, "Owner violations on freeing the buffers of a tunnel\n");
+        eError = OMX_ErrorUndefined;
+    }
+    if (pSource)
+        pSource->ComponentTunnelRequest(pSource, OMX_CONF_VALIDATETEST_OUTPORT, NULL, 0, NULL);
+    if (pSink)
+        pSink->ComponentTunnelRequest(pSink, OMX_CONF_VALIDATETEST_INPORT, NULL, 0, NULL);
+    OMX_CONF_ComponentTracerDestroy(pSource);
+    OMX_CONF_ComponentTracerDestroy(pSink);
+    g_OMX_OSAL_TraceFlags = nTraceFlags;
+    return eError;
+}
+
 OMX_ERRORTYPE OMX_OSAL_GetTracePrefix(OMX_IN OMX_U32 nTraceFlags, OMX_OUT OMX_STRING szPrefix)
 {
     switch(nTraceFlags)
@@ -197,7 +197,7 @@ OMX_ERRORTYPE TTCConnectDomainPorts(OMX_INDEXTYPE eIndexParamDomainInit, OMX_HAN
     INIT_PARAM(oParam);
 
     /* query the component's other ports */
-    TTC_RETURN_ANY_ERROR(eError = OMX_GetParameter(hCUT, eIndexParamDomainInit, &oParam));
+    TTC_RETURN_ANY_ERROR(eError = OMX_CONF_TopologyGetDomain(hCUT, eIndexParamDomainInit, &oParam));
 
     /* for each discovered port */
     for (i=0;i<oParam.nPorts;i++)
@@ -224,7 +224,7 @@ OMX_ERRORTYPE TTCConnectOtherPortsExceptInputClock(OMX_HANDLETYPE hTTC, OMX_HAND
     INIT_PARAM(oCUTPort);
 
     /* query the component's other ports */
-    TTC_RETURN_ANY_ERROR(eError = OMX_GetParameter(hCUT, OMX_IndexParamOtherInit, &oParam));
+    TTC_RETURN_ANY_ERROR(eError = OMX_CONF_TopologyGetDomain(hCUT, OMX_IndexParamOtherInit, &oParam));
 
     /* for each discovered port */
     for (i=0;i<oParam.nPorts;i++)
@@ -232,7 +232,7 @@ OMX_ERRORTYPE TTCConnectOtherPortsExceptInputClock(OMX_HANDLETYPE hTTC, OMX_HAND
         iCUTPort = oParam.nStartPortNumber + i;
         /* get CUT port definition */
         oCUTPort.nPortIndex = iCUTPort;
-        TTC_RETURN_ANY_ERROR(eError = OMX_GetParameter(hCUT, OMX_IndexParamPortDefinition, &oCUTPort));
+        TTC_RETURN_ANY_ERROR(eError = OMX_CONF_TopologyGetPort(hCUT, &oCUTPort));
         
         if ((OMX_OTHER_FormatTime == oCUTPort.format.other.eFormat) && (OMX_DirInput == oCUTPort.eDir)) {
             TTC_RETURN_ANY_ERROR(OMX_SendCommand(hCUT, OMX_CommandPortDisable, iCUTPort, NULL));
@@ -703,6 +703,12 @@ OMX_ERRORTYPE TTCSendCommand(
                 {
                     if (OMX_ErrorNone != (eError = TTCUpdatePortBufferInfo(pPort))) return eError;
 
+                    /* buffers fed from the input file can take the file pages without a copy */
+                    pPort->bInPlaceBuffers = (OMX_DirOutput == pPort->oPortDef.eDir && 
+                                              !pPort->bBuffersContiguous && 
+                                              pPort->nBufferAlignment <= OMX_OSAL_InputFileBufferAlignment()) ? 
+                                              OMX_TRUE : OMX_FALSE;
+
                     /* allocate buffers and pass them to non-supplier port */
                     for (j=0;j<pPort->nBufferCount;j++)
                     {
@@ -710,7 +716,10 @@ OMX_ERRORTYPE TTCSendCommand(
                         OMX_BUFFERHEADERTYPE *pBufferHeader = NULL;
 
                         //malloc a buffer
-                        pBuf = (OMX_U8*)OMX_OSAL_MallocBuffer(pPort->nBufferSize, 
+                        if (pPort->bInPlaceBuffers)
+                            OMX_OSAL_AllocInputFileBuffer(pPort->nBufferSize, (OMX_PTR *)&pBuf);
+                        else
+                            pBuf = (OMX_U8*)OMX_OSAL_MallocBuffer(pPort->nBufferSize, 
                                                 pPort->bBuffersContiguous, 
                                                 pPort->nBufferAlignment);
                         if (NULL == pBuf)
@@ -770,7 +779,10 @@ OMX_ERRORTYPE TTCSendCommand(
                         {
                             /* free buffer */
                             if (pPort->pBuffer[j]) {
-                                OMX_OSAL_FreeBuffer(pPort->pBuffer[j], pPort->bBuffersContiguous, pPort->nBufferAlignment);
+                                if (pPort->bInPlaceBuffers)
+                                    OMX_OSAL_FreeInputFileBuffer(pPort->pBuffer[j], pPort->nBufferSize);
+                                else
+                                    OMX_OSAL_FreeBuffer(pPort->pBuffer[j], pPort->bBuffersContiguous, pPort->nBufferAlignment);
                                 pPort->pBuffer[j] = 0;              
                             }
 
@@ -1049,8 +1061,12 @@ OMX_ERRORTYPE TTCFillThisBuffer(
 
     /* read more data from input file */
     /* if we didn't get as much data as expected then send EOS */ 
-    pBuffer->nFilledLen = OMX_OSAL_ReadFromInputFileWithSize(pBuffer->pBuffer,
-        pBuffer->nAllocLen, pBuffer->nInputPortIndex);
+    if (pPort->bInPlaceBuffers && TTCPortIsSupplier(pPort))
+        pBuffer->nFilledLen = OMX_OSAL_ReadFromInputFileInPlace(pBuffer->pBuffer,
+            pBuffer->nAllocLen, &pBuffer->nOffset, pBuffer->nInputPortIndex);
+    else
+        pBuffer->nFilledLen = OMX_OSAL_ReadFromInputFileWithSize(pBuffer->pBuffer,
+            pBuffer->nAllocLen, pBuffer->nInputPortIndex);
     if (OMX_OSAL_InputFileAtEOS(pBuffer->nInputPortIndex))
     {
         pBuffer->nFlags |= OMX_BUFFERFLAG_EOS;
@@ -1154,7 +1170,10 @@ OMX_ERRORTYPE TTCReleaseBuffers(OMX_IN  OMX_HANDLETYPE hTunnelTestComponent)
 
                     /* free buffer */
                     if (pPort->pBuffer[j]) {
-                        OMX_OSAL_FreeBuffer(pPort->pBuffer[j], pPort->bBuffersContiguous, pPort->nBufferAlignment);
+                        if (pPort->bInPlaceBuffers)
+                            OMX_OSAL_FreeInputFileBuffer(pPort->pBuffer[j], pPort->nBufferSize);
+                        else
+                            OMX_OSAL_FreeBuffer(pPort->pBuffer[j], pPort->bBuffersContiguous, pPort->nBufferAlignment);
                         pPort->pBuffer[j] = 0;
                     }
 
@@ -1255,6 +1274,7 @@ OMX_ERRORTYPE TunnelTestComponentInit(OMX_IN  OMX_HANDLETYPE hComponent)
         for(j=0;j<MAX_TTCBUFFERS;j++) pData->oPort[i].bHoldingBuffer[j] = OMX_FALSE;
 	pData->oPort[i].bBuffersContiguous=OMX_FALSE;
 	pData->oPort[i].nBufferAlignment=0;
+	pData->oPort[i].bInPlaceBuffers=OMX_FALSE;
       }
 
     /* initialize state */
@@ -1386,8 +1406,12 @@ OMX_ERRORTYPE TTCReadFromFile(OMX_IN  TTCPORTTYPE *pPort, OMX_IN  OMX_BUFFERHEAD
 
     /* read more data from input file */
     /* if we didn't get as much data as expected then send EOS */ 
-    pBuffer->nFilledLen = OMX_OSAL_ReadFromInputFileWithSize(pBuffer->pBuffer,
-        pBuffer->nAllocLen, pBuffer->nInputPortIndex);
+    if (pPort->bInPlaceBuffers && TTCPortIsSupplier(pPort))
+        pBuffer->nFilledLen = OMX_OSAL_ReadFromInputFileInPlace(pBuffer->pBuffer,
+            pBuffer->nAllocLen, &pBuffer->nOffset, pBuffer->nInputPortIndex);
+    else
+        pBuffer->nFilledLen = OMX_OSAL_ReadFromInputFileWithSize(pBuffer->pBuffer,
+            pBuffer->nAllocLen, pBuffer->nInputPortIndex);
     if (OMX_OSAL_InputFileAtEOS(pBuffer->nInputPortIndex))
     {
         pBuffer->nFlags |= OMX_BUFFERFLAG_EOS;
@@ -68,6 +68,7 @@ typedef struct TTCPORTTYPE {
     OMX_U32 nPlaneBytesTotal;
     OMX_BOOL bBuffersContiguous;
     OMX_U32  nBufferAlignment;
+    OMX_BOOL bInPlaceBuffers;  /* supplied buffers the input file is mapped into */
 } TTCPORTTYPE;
 
 /** Tunnel Test Component Context */
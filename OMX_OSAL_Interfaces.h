@@ -43,6 +43,16 @@ void OMX_OSAL_FreeBuffer( OMX_IN OMX_PTR pData,
                             OMX_BOOL bBuffersContiguous, 
                             OMX_U32 nBufferAlignment );    
 
+/** Configure the buffer pools behind OMX_OSAL_MallocBuffer. bHugePages backs new
+ *  slabs with hugepages where the platform allows it. nContiguousBytes sizes the
+ *  region contiguous buffers are carved from (0 keeps the current size); it can
+ *  only be changed before the first contiguous allocation or after a release. */
+OMX_ERRORTYPE OMX_OSAL_BufferPoolSetup( OMX_IN OMX_BOOL bHugePages, OMX_IN OMX_U32 nContiguousBytes );
+
+/** Return all pooled buffer memory to the system. Fails with OMX_ErrorNotReady
+ *  while any buffer is still allocated. */
+OMX_ERRORTYPE OMX_OSAL_BufferPoolRelease();
+
 /**********************************************************************
  * THREADS               
  **********************************************************************/
@@ -50,13 +60,91 @@ void OMX_OSAL_FreeBuffer( OMX_IN OMX_PTR pData,
 /** Create a thread given the thread function, a data parameter to pass 
  *  to the thread, and the thread priority (higher values=higher priority,
  *  0 = normal priority). The thread is created and executed immediately 
- *  calling the thread function with the supplied data parameter. */
+ *  calling the thread function with the supplied data parameter. 
+ *  On Linux priorities 1 to 19 raise the nice level and higher values 
+ *  select realtime (SCHED_FIFO) scheduling. */
 OMX_ERRORTYPE OMX_OSAL_ThreadCreate( OMX_IN OMX_U32 (*pFunc)(OMX_PTR pParam), 
                                      OMX_IN OMX_PTR pParam, 
                                      OMX_IN OMX_U32 nPriority, 
                                      OMX_OUT OMX_HANDLETYPE *phThread );
 OMX_ERRORTYPE OMX_OSAL_ThreadDestroy( OMX_IN OMX_HANDLETYPE hThread ); /** Destroy a thread */
 
+/** Returns an id of the calling thread that is unique among the live threads
+ *  of the process (the kernel thread id on Linux). */
+OMX_U32 OMX_OSAL_GetThreadId();
+
+/** Returns the number of voluntary (blocking) and involuntary (preempted)
+ *  context switches of the given thread of this process so far. Returns 
+ *  OMX_ErrorBadParameter if the thread has exited. */
+OMX_ERRORTYPE OMX_OSAL_GetThreadSwitches( OMX_IN OMX_U32 nThreadId, 
+                                          OMX_OUT OMX_U64 *pnVoluntary, 
+                                          OMX_OUT OMX_U64 *pnInvoluntary );
+
+/**********************************************************************
+ * THREAD POOL
+ **********************************************************************/
+
+/** Queue a work item on the shared thread pool. pFunc is called with pParam on a 
+ *  pooled worker thread, at the given priority (as for OMX_OSAL_ThreadCreate) and
+ *  restricted to the CPUs set in nAffinityMask (bit n = CPU n, 0 = any CPU). 
+ *  Work items start without waiting for other items to finish. */
+OMX_ERRORTYPE OMX_OSAL_ThreadPoolSubmit( OMX_IN OMX_U32 (*pFunc)(OMX_PTR pParam), 
+                                         OMX_IN OMX_PTR pParam, 
+                                         OMX_IN OMX_U32 nPriority, 
+                                         OMX_IN OMX_U64 nAffinityMask,
+                                         OMX_OUT OMX_HANDLETYPE *phWork );
+
+/** Wait for a work item to complete and release its handle. The return value of
+ *  the work function is stored in puReturn unless it is NULL. */
+OMX_ERRORTYPE OMX_OSAL_ThreadPoolWait( OMX_IN OMX_HANDLETYPE hWork, OMX_OUT OMX_U32 *puReturn );
+
+/** Cancel a work item that has not started yet and release its handle. Returns
+ *  OMX_ErrorNotReady if the item is already running, it must then be waited for. */
+OMX_ERRORTYPE OMX_OSAL_ThreadPoolCancel( OMX_IN OMX_HANDLETYPE hWork );
+
+/** Start nThreads worker threads ahead of the first submitted work item. */
+OMX_ERRORTYPE OMX_OSAL_ThreadPoolSetup( OMX_IN OMX_U32 nThreads );
+
+/** Stop all worker threads once queued work has completed. */
+OMX_ERRORTYPE OMX_OSAL_ThreadPoolRelease();
+
+/**********************************************************************
+ * PROCESSES
+ *
+ * Runs a function in a child process, so that a crash or a hang there 
+ * leaves the caller running. The child starts as a copy of the caller 
+ * with only the calling thread; its trace output is captured and written
+ * to the caller's trace output when the child is destroyed. Start children
+ * while no other thread of the caller is tracing or using the thread pool.
+ **********************************************************************/
+
+/** Start pFunc(pParam) in a child process. Returns OMX_ErrorNotImplemented 
+ *  where processes are not supported, the function must then be called 
+ *  directly. */
+OMX_ERRORTYPE OMX_OSAL_ProcessStart( OMX_IN OMX_U32 (*pFunc)(OMX_PTR pParam), 
+                                     OMX_IN OMX_PTR pParam, 
+                                     OMX_OUT OMX_HANDLETYPE *phProcess );
+
+/** Wait up to mSec for any of nProcesses children to finish and set *pnIndex
+ *  to the index of one that did. Returns OMX_ErrorTimeout if none finished. */
+OMX_ERRORTYPE OMX_OSAL_ProcessWait( OMX_IN OMX_HANDLETYPE *phProcesses, 
+                                    OMX_IN OMX_U32 nProcesses, 
+                                    OMX_IN OMX_U32 mSec, 
+                                    OMX_OUT OMX_U32 *pnIndex );
+
+/** Called by the function running in a child, hand a copy of nBytes of pData
+ *  back to the caller along with the return value. */
+OMX_ERRORTYPE OMX_OSAL_ProcessReply( OMX_IN OMX_PTR pData, OMX_IN OMX_U32 nBytes );
+
+/** Kill the child if it is still running, write out its trace output and 
+ *  release the handle. Returns OMX_ErrorNone with the return value of the 
+ *  function in *puReturn, OMX_ErrorTimeout if the child had to be killed, or
+ *  OMX_ErrorUndefined if it ended without returning (e.g. it crashed). If 
+ *  ppReply is not NULL it is set to the data the child passed to 
+ *  OMX_OSAL_ProcessReply, to be released with OMX_OSAL_Free, or NULL. */
+OMX_ERRORTYPE OMX_OSAL_ProcessDestroy( OMX_IN OMX_HANDLETYPE hProcess, OMX_OUT OMX_U32 *puReturn,
+                                       OMX_OUT OMX_PTR *ppReply, OMX_OUT OMX_U32 *pnReplyBytes );
+
 /**********************************************************************
  * MUTEX               
  **********************************************************************/
@@ -81,6 +169,56 @@ OMX_ERRORTYPE OMX_OSAL_EventSet(OMX_IN OMX_HANDLETYPE hEvent);/** Set an event *
  *  the event was signaled. */
 OMX_ERRORTYPE OMX_OSAL_EventWait(OMX_IN OMX_HANDLETYPE hEvent, OMX_IN OMX_U32 mSec, OMX_OUT OMX_BOOL *pbTimedOut); 
 
+/** OMX_OSAL_EventWait that accounts the wait to the call site sFile:nLine.
+ *  Calls to OMX_OSAL_EventWait are routed here by the macro below, so that 
+ *  every wait in the tests is attributed to where it is made. */
+OMX_ERRORTYPE OMX_OSAL_EventWaitAt(OMX_IN OMX_HANDLETYPE hEvent, OMX_IN OMX_U32 mSec, OMX_OUT OMX_BOOL *pbTimedOut,
+                                   OMX_IN const char *sFile, OMX_IN OMX_U32 nLine);
+#define OMX_OSAL_EventWait(hEvent, mSec, pbTimedOut) OMX_OSAL_EventWaitAt(hEvent, mSec, pbTimedOut, __FILE__, __LINE__)
+
+/** Waits made at one call site since the statistics were last reset. */
+typedef struct OMX_OSAL_WAITSITETYPE {
+    const char *sFile;
+    OMX_U32 nLine;
+    OMX_U32 nWaits;
+    OMX_U32 nTimedOut;          /**< waits that ran into their timeout */
+    OMX_U64 nBlockedNs;         /**< time spent in the waits */
+    OMX_U64 nAllowedNs;         /**< sum of the timeouts of the waits, INFINITE_WAIT ones counted as blocked */
+    OMX_U64 nMaxSignaledNs;     /**< longest wait that was ended by the event */
+} OMX_OSAL_WAITSITETYPE;
+
+/** Copy the statistics of up to nMaxSites call sites into pSites, the sites
+ *  that blocked longest first, and return in pnSites how many were copied. 
+ *  With bReset the statistics start over afterwards. pSites may be NULL to
+ *  only reset. */
+OMX_ERRORTYPE OMX_OSAL_WaitSitesGet(OMX_OUT OMX_OSAL_WAITSITETYPE *pSites, OMX_IN OMX_U32 nMaxSites, 
+                                    OMX_OUT OMX_U32 *pnSites, OMX_IN OMX_BOOL bReset);
+
+/** Select the implementation behind mutexes and events created from now on.
+ *  bFutex picks the lightweight native primitives where the platform has them
+ *  (otherwise the portable ones are used); nMaxSpin bounds how many iterations
+ *  a waiter spins before going to sleep. Existing objects are not affected. */
+OMX_ERRORTYPE OMX_OSAL_SyncConfigure(OMX_IN OMX_BOOL bFutex, OMX_IN OMX_U32 nMaxSpin);
+
+/**********************************************************************
+ * QUEUES
+ **********************************************************************/
+
+/** Create a bounded queue of pointers (typically OMX_BUFFERHEADERTYPE*) that
+ *  holds at least nEntries. Any number of threads may push and pop concurrently. */
+OMX_ERRORTYPE OMX_OSAL_QueueCreate(OMX_IN OMX_U32 nEntries, OMX_OUT OMX_HANDLETYPE *phQueue);
+OMX_ERRORTYPE OMX_OSAL_QueueDestroy(OMX_IN OMX_HANDLETYPE hQueue); /** Destroy a queue */
+/** Append an entry. Fails with OMX_ErrorInsufficientResources when the queue is full. */
+OMX_ERRORTYPE OMX_OSAL_QueuePush(OMX_IN OMX_HANDLETYPE hQueue, OMX_IN OMX_PTR pEntry);
+/** Remove the oldest entry, waiting at most mSec milliseconds for one to arrive
+ *  (INFINITE_WAIT waits indefinitely, 0 does not wait). Returns OMX_ErrorTimeout 
+ *  if the queue stayed empty. */
+OMX_ERRORTYPE OMX_OSAL_QueuePop(OMX_IN OMX_HANDLETYPE hQueue, OMX_IN OMX_U32 mSec, OMX_OUT OMX_PTR *ppEntry);
+/** Return the oldest entry without removing it, OMX_ErrorNotReady if the queue is 
+ *  empty. Only meaningful while no other thread pops from the queue. */
+OMX_ERRORTYPE OMX_OSAL_QueuePeek(OMX_IN OMX_HANDLETYPE hQueue, OMX_OUT OMX_PTR *ppEntry);
+OMX_U32 OMX_OSAL_QueueCount(OMX_IN OMX_HANDLETYPE hQueue); /** Number of entries in the queue */
+
 /**********************************************************************
  * TIME
  **********************************************************************/
@@ -92,6 +230,51 @@ OMX_ERRORTYPE OMX_OSAL_EventWait(OMX_IN OMX_HANDLETYPE hEvent, OMX_IN OMX_U32 mS
  *  instance, to compute the duration of call. */
 OMX_U32 OMX_OSAL_GetTime();
 
+/** Returns a monotonic time value in nanoseconds based on a clock starting
+ *  at some arbitrary base. Unlike GetTime the value does not wrap and is not
+ *  affected by changes to the wall clock. This method is used to time calls
+ *  that may complete in well under a millisecond. */
+OMX_U64 OMX_OSAL_GetTimeNs();
+
+/**********************************************************************
+ * PERFORMANCE COUNTERS
+ *
+ * Hardware counters where the platform provides them, next to the CPU 
+ * time, context switches and page faults the OS accounts anyway. A 
+ * counter that could not be read has its bit clear in nValid.
+ **********************************************************************/
+
+typedef enum OMX_OSAL_COUNTERTYPE {
+    OMX_OSAL_CounterCycles,
+    OMX_OSAL_CounterInstructions,
+    OMX_OSAL_CounterCacheMisses,
+    OMX_OSAL_CounterBranchMisses,
+    OMX_OSAL_CounterCpuNs,                  /**< user and system CPU time */
+    OMX_OSAL_CounterVoluntarySwitches,      /**< context switches to wait for something */
+    OMX_OSAL_CounterInvoluntarySwitches,    /**< preemptions */
+    OMX_OSAL_CounterPageFaults,
+    OMX_OSAL_CounterPeakRssKb,              /**< peak resident memory of the process since the last
+                                                 OMX_OSAL_CountersResetPeak, not a count */
+    OMX_OSAL_COUNTERS
+} OMX_OSAL_COUNTERTYPE;
+
+typedef struct OMX_OSAL_COUNTERSTYPE {
+    OMX_U32 nValid;                         /**< bit n set if counter n was read */
+    OMX_U64 nValue[OMX_OSAL_COUNTERS];
+} OMX_OSAL_COUNTERSTYPE;
+
+/** Start the hardware counters of the process. They count the calling thread
+ *  and the threads started after it, so call it before starting any. */
+OMX_ERRORTYPE OMX_OSAL_CountersOpen();
+/** Read the counters of the whole process, or with bThread set those of the 
+ *  calling thread only. */
+OMX_ERRORTYPE OMX_OSAL_CountersRead(OMX_IN OMX_BOOL bThread, OMX_OUT OMX_OSAL_COUNTERSTYPE *pCounters);
+/** Restart the peak resident memory of the process from its current size. 
+ *  Without it the peak is that of the whole process lifetime. */
+OMX_ERRORTYPE OMX_OSAL_CountersResetPeak();
+/** Stop the hardware counters of the process. */
+OMX_ERRORTYPE OMX_OSAL_CountersClose();
+
 /***********************************************************************
  * TRACE
  *
@@ -115,10 +298,23 @@ extern OMX_HANDLETYPE g_OMX_CONF_hTraceMutex;
 #define OMX_OSAL_TRACE_ERROR          0x0010 /**< Errors that occur during processing. */
 #define OMX_OSAL_TRACE_BUFFER         0x0020 /**< Buffer header fields. */
 #define OMX_OSAL_TRACE_WARNING        0x0040 /**< Warnings reported during processing. */
+#define OMX_OSAL_TRACE_STATISTICS     0x0080 /**< Call latency and buffer traffic gathered by the tracers. */
+#define OMX_OSAL_TRACE_VALIDATE       0x0100 /**< Buffer header and ownership checks by the tracers, violations reported as warnings. */
+#define OMX_OSAL_TRACE_COUNTERS       0x0200 /**< Performance counters per test and per traced call. */
 
 /** Output a trace message */
 OMX_ERRORTYPE OMX_OSAL_Trace(OMX_IN OMX_U32 nTraceFlags, OMX_IN char *format, ...);
 
+/** Configure trace buffering. With nRingEntries > 0 every thread queues its 
+ *  trace messages in a lock free ring of that many entries and a background 
+ *  thread writes them out; a message that finds the ring full is dropped and
+ *  counted. Pass/fail and error messages, and messages too long for a ring 
+ *  entry, are written and flushed synchronously. The format string is kept by reference, so it must stay valid 
+ *  (e.g. a string literal). 0 writes each message synchronously. */
+OMX_ERRORTYPE OMX_OSAL_TraceConfigure(OMX_IN OMX_U32 nRingEntries);
+/** Write out all buffered trace messages before returning. */
+OMX_ERRORTYPE OMX_OSAL_TraceFlush();
+
 OMX_ERRORTYPE OMX_OSAL_ProcessCommandsFromFile(OMX_STRING sFileName);
 OMX_ERRORTYPE OMX_OSAL_ProcessCommandsFromPrompt();
 
@@ -128,6 +324,82 @@ OMX_ERRORTYPE OMX_OSAL_OpenLogfile(OMX_IN OMX_STRING sFilename);
 /** Close logfile.*/
 OMX_ERRORTYPE OMX_OSAL_CloseLogfile();
 
+/**********************************************************************
+ * EVENT LOG
+ *
+ * Binary log of timed calls for offline analysis. The file starts with an
+ * OMX_OSAL_EVENTLOGHEADERTYPE followed by records. Name and data records
+ * are followed by nResult bytes of name or data, padded to a multiple of 
+ * 8 bytes. A data record always directly follows the call it belongs to.
+ **********************************************************************/
+
+#define OMX_OSAL_EVENTLOG_MAGIC       0x4C454D4F  /* "OMEL" */
+#define OMX_OSAL_EVENTLOG_VERSION     2
+
+#define OMX_OSAL_EVENTLOG_CALL        1   /**< nKind of a timed call */
+#define OMX_OSAL_EVENTLOG_NAME        2   /**< nKind of a name definition */
+#define OMX_OSAL_EVENTLOG_DATA        3   /**< nKind of the arguments of the preceding call */
+
+#define OMX_OSAL_EVENTLOG_CALLBACK    0x0001  /**< call made by the component into the harness */
+#define OMX_OSAL_EVENTLOG_HASDATA     0x0002  /**< call is followed by a data record */
+#define OMX_OSAL_EVENTLOG_TEST        0x0004  /**< span of a whole test, nApiId names the test */
+
+typedef struct OMX_OSAL_EVENTLOGHEADERTYPE {
+    OMX_U32 nMagic;
+    OMX_U32 nVersion;
+} OMX_OSAL_EVENTLOGHEADERTYPE;
+
+typedef struct OMX_OSAL_EVENTLOGRECORDTYPE {
+    OMX_U16 nKind;          /**< OMX_OSAL_EVENTLOG_CALL, _NAME or _DATA */
+    OMX_U16 nNameId;        /**< component name id, or the id a name record defines */
+    OMX_U16 nApiId;         /**< name id of the function called */
+    OMX_U16 nFlags;         /**< OMX_OSAL_EVENTLOG_CALLBACK, OMX_OSAL_EVENTLOG_HASDATA */
+    OMX_U32 nThreadId;
+    OMX_U32 nResult;        /**< returned OMX_ERRORTYPE, name or data length for name and data records */
+    OMX_U64 nBeginNs;       /**< OMX_OSAL_GetTimeNs at entry */
+    OMX_U64 nEndNs;         /**< OMX_OSAL_GetTimeNs at return */
+    OMX_U64 nBuffer;        /**< buffer header involved, 0 if none */
+} OMX_OSAL_EVENTLOGRECORDTYPE;
+
+/** Open a binary event log. Calls logged from now on are written to it. */
+OMX_ERRORTYPE OMX_OSAL_EventLogOpen(OMX_IN OMX_STRING sFilename);
+/** Close the event log after writing out all buffered records. */
+OMX_ERRORTYPE OMX_OSAL_EventLogClose();
+/** Return whether an event log is open, so callers can skip timing calls. */
+OMX_BOOL OMX_OSAL_EventLogActive();
+/** Return the id of a component or function name, assigning one on first use.
+ *  Ids stay valid across logs. Returns 0 if the name table is full. */
+OMX_U16 OMX_OSAL_EventLogName(OMX_IN OMX_STRING sName);
+/** Log a call of function nApiId on component nNameId that ran from nBeginNs 
+ *  to nEndNs. Does nothing while no event log is open. */
+void OMX_OSAL_EventLogCall(OMX_IN OMX_U16 nNameId, OMX_IN OMX_U16 nApiId, OMX_IN OMX_U16 nFlags,
+                           OMX_IN OMX_U64 nBeginNs, OMX_IN OMX_U64 nEndNs, 
+                           OMX_IN OMX_PTR pBuffer, OMX_IN OMX_U32 nResult);
+/** Log a call as OMX_OSAL_EventLogCall does, followed by nDataBytes of pData 
+ *  describing its arguments. Written straight to the file so it is never 
+ *  dropped. Does nothing while no event log is open. */
+void OMX_OSAL_EventLogCallData(OMX_IN OMX_U16 nNameId, OMX_IN OMX_U16 nApiId, OMX_IN OMX_U16 nFlags,
+                               OMX_IN OMX_U64 nBeginNs, OMX_IN OMX_U64 nEndNs, 
+                               OMX_IN OMX_PTR pBuffer, OMX_IN OMX_U32 nResult,
+                               OMX_IN OMX_PTR pData, OMX_IN OMX_U32 nDataBytes);
+/** Read the whole event log sFilename into memory allocated with OMX_OSAL_Malloc,
+ *  checking its header. The caller frees *ppLog with OMX_OSAL_Free. */
+OMX_ERRORTYPE OMX_OSAL_EventLogLoad(OMX_IN OMX_STRING sFilename, OMX_OUT OMX_U8 **ppLog, OMX_OUT OMX_U32 *pnBytes);
+/** Convert event log sLogName to the Chrome trace event JSON file sJsonName,
+ *  which timeline viewers such as chrome://tracing and Perfetto open. */
+OMX_ERRORTYPE OMX_OSAL_ConvertEventLog(OMX_IN OMX_STRING sLogName, OMX_IN OMX_STRING sJsonName);
+
+/**********************************************************************
+ * FILE I/O
+ **********************************************************************/
+
+/** Configure how port input/output files are read and written. With nDepth > 0 
+ *  input files are read ahead and output files written behind by a background 
+ *  thread, using up to nDepth chunks of nChunkBytes per file (0 keeps the current
+ *  chunk size). nDepth 0 does all file I/O synchronously in the caller. Applies 
+ *  to files opened from now on. */
+OMX_ERRORTYPE OMX_OSAL_FileIoConfigure( OMX_IN OMX_U32 nDepth, OMX_IN OMX_U32 nChunkBytes );
+
 /**********************************************************************
  * INPUT FILE MAPPING
  **********************************************************************/
@@ -142,10 +414,62 @@ OMX_U32 OMX_OSAL_ReadFromInputFile( OMX_OUT OMX_PTR pData, OMX_IN OMX_U32 nBytes
 /** Read a specified number of bytes from input file associated with the given port index. The specified number of bytes is either the maxbytes passed in, or it is the corresponding number of bytes specified in a .length file */
 OMX_U32 OMX_OSAL_ReadFromInputFileWithSize( OMX_OUT OMX_PTR pData, OMX_IN OMX_U32 nMaxBytes, OMX_IN OMX_U32 nPortIndex);
  
+/** Allocate a buffer of nBytes that OMX_OSAL_ReadFromInputFileInPlace can fill without
+ *  copying. Suitable to hand to OMX_UseBuffer; free it with OMX_OSAL_FreeInputFileBuffer. */
+OMX_ERRORTYPE OMX_OSAL_AllocInputFileBuffer( OMX_IN OMX_U32 nBytes, OMX_OUT OMX_PTR *ppBuffer );
+void OMX_OSAL_FreeInputFileBuffer( OMX_IN OMX_PTR pBuffer, OMX_IN OMX_U32 nBytes );
+/** The alignment of the buffers from OMX_OSAL_AllocInputFileBuffer, the page size. */
+OMX_U32 OMX_OSAL_InputFileBufferAlignment();
+
+/** Same as OMX_OSAL_ReadFromInputFileWithSize for a buffer from OMX_OSAL_AllocInputFileBuffer,
+ *  but where possible the file pages are mapped into the buffer instead of copied. The data 
+ *  then starts at the returned *pnOffset rather than at the start of the buffer. */
+OMX_U32 OMX_OSAL_ReadFromInputFileInPlace( OMX_IN OMX_PTR pBuffer, OMX_IN OMX_U32 nAllocLen, 
+                                           OMX_OUT OMX_U32 *pnOffset, OMX_IN OMX_U32 nPortIndex );
+
+/** Binary frame index. If <inputfile>.index exists it is used instead of 
+ *  <inputfile>.length: a header, nSettings port settings (as in the .length file),
+ *  then, at nFramesOffset, nFrames frame entries. All fields are host byte order. */
+#define OMX_OSAL_FRAMEINDEX_MAGIC   0x49584D4F  /* "OMXI" */
+#define OMX_OSAL_FRAMEINDEX_VERSION 1
+
+typedef struct OMX_OSAL_FRAMEINDEXHEADERTYPE {
+    OMX_U32 nMagic;
+    OMX_U32 nVersion;
+    OMX_U8  sPortIndex[8];      /* port specifier, e.g. "v0" */
+    OMX_U32 nSettings;
+    OMX_U32 nMaxFrameSize;
+    OMX_U64 nFrames;
+    OMX_U64 nFramesOffset;      /* from the start of the index, 8 byte aligned */
+} OMX_OSAL_FRAMEINDEXHEADERTYPE;
+
+typedef struct OMX_OSAL_FRAMEINFOTYPE {
+    OMX_U64 nOffset;            /* of the frame in the input file */
+    OMX_U32 nSize;
+    OMX_U32 nFlags;             /* OMX_BUFFERFLAG_* */
+    OMX_S64 nTimeStamp;
+} OMX_OSAL_FRAMEINFOTYPE;
+
+/** Write the binary frame index equivalent of a text .length file. */
+OMX_ERRORTYPE OMX_OSAL_ConvertBufferVarianceFile( OMX_IN OMX_STRING sLengthFileName, 
+                                                  OMX_IN OMX_STRING sIndexFileName );
+
+/** Number of frames in the frame index of the input file, 0 if it has none. */
+OMX_U32 OMX_OSAL_InputFileFrameCount( OMX_IN OMX_U32 nPortIndex );
+
+/** Look up a frame in the frame index of the input file. */
+OMX_ERRORTYPE OMX_OSAL_InputFileGetFrame( OMX_IN OMX_U32 nPortIndex, OMX_IN OMX_U32 nFrame, 
+                                          OMX_OUT OMX_OSAL_FRAMEINFOTYPE *pFrame );
+
+/** Make frame nFrame the next one read from the input file. Needs a frame index; 
+ *  returns OMX_ErrorNotImplemented without one. */
+OMX_ERRORTYPE OMX_OSAL_InputFileSeekFrame( OMX_IN OMX_U32 nPortIndex, OMX_IN OMX_U32 nFrame );
+
 /** Return if an input file associated with the given port index is at EOS or not. */
 OMX_BOOL OMX_OSAL_InputFileAtEOS( OMX_IN OMX_U32 nPortIndex );
 
-/** Close the input file associated with the given port index.*/
+/** Close the input file associated with the given port index. Reports the read throughput 
+ *  of the port.*/
 OMX_ERRORTYPE OMX_OSAL_CloseInputFile( OMX_IN OMX_U32 nPortIndex );
 
 /**********************************************************************
@@ -159,7 +483,8 @@ OMX_ERRORTYPE OMX_OSAL_OpenOutputFile( OMX_IN OMX_U32 nPortIndex );
  *  Return the actual number of bytes written. */
 OMX_U32 OMX_OSAL_WriteToOutputFile( OMX_OUT OMX_PTR pData, OMX_IN OMX_U32 nBytes, OMX_IN OMX_U32 nPortIndex );
 
-/** Close the output file associated with the given port index.*/
+/** Close the output file associated with the given port index. Data still queued
+ *  for writing is flushed to the file first.*/
 OMX_ERRORTYPE OMX_OSAL_CloseOutputFile( OMX_IN OMX_U32 nPortIndex );
 
 
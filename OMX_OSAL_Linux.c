@@ -19,18 +19,35 @@
  *  mutex, event, time query and tracing functionality.
  */
 
+#define _GNU_SOURCE         /* XOpen 7 (recursive locks) plus mmap/hugepage extensions */
+
 #include "OMX_OSAL_Interfaces.h"
 #include "OMX_CONF_TestHarness.h"
 
-#define _XOPEN_SOURCE 600   /* version 6.0 of XOpen source (for recursive locks) */
 #include <stdio.h>
+#include <stdint.h>
+#include <stddef.h>
 #include <sys/time.h>
+#include <time.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
 #include <pthread.h>
+#include <sched.h>
+#include <sys/resource.h>
 #include <stdarg.h>
 #include <errno.h>
 #include <stdlib.h>
 #include <string.h>
 #include <ctype.h>
+#include <limits.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <sys/wait.h>
+#include <signal.h>
+#include <poll.h>
+#include <linux/futex.h>
+#include <linux/perf_event.h>
 
 extern OMX_U32 g_OMX_OSAL_TraceFlags;
 
@@ -47,39 +64,342 @@ void OMX_OSAL_Free( OMX_IN OMX_PTR pData )
     free(pData);
 }
 
+/**********************************************************************
+ * BUFFER POOLS
+ *
+ * Buffers handed out by OMX_OSAL_MallocBuffer are carved from slabs and
+ * grouped in pools by (size class, alignment, contiguous). Freed buffers
+ * go back on their pool's free list and are reused by later tests; slabs
+ * are only returned to the system by OMX_OSAL_BufferPoolRelease.
+ *
+ * Every buffer is preceded by a small header (OMX_OSAL_BUFFERBLOCKTYPE)
+ * so OMX_OSAL_FreeBuffer can find its pool without a lookup.
+ **********************************************************************/
+
+#define OMX_OSAL_BUFFER_MAGIC          0x4F4D5842  /* 'OMXB', block handed out */
+#define OMX_OSAL_BUFFER_FREEMAGIC      0x4F4D5846  /* 'OMXF', block on a free list */
+#define OMX_OSAL_BUFFER_MINCLASS       6           /* smallest size class is 64 bytes */
+#define OMX_OSAL_BUFFER_NUMCLASSES     26          /* largest size class is 2^31 bytes */
+#define OMX_OSAL_BUFFER_HEADERBYTES    64          /* header slot in front of every buffer */
+#define OMX_OSAL_BUFFER_MINALIGNMENT   64          /* all buffers are at least cache line aligned */
+#define OMX_OSAL_BUFFER_SLABBYTES      (2*1024*1024)
+#define OMX_OSAL_BUFFER_HUGEPAGEBYTES  (2*1024*1024)
+#define OMX_OSAL_BUFFER_CONTIGBYTES    (64*1024*1024)
+
+typedef struct OMX_OSAL_BUFFERBLOCKTYPE {
+    struct OMX_OSAL_BUFFERBLOCKTYPE *pNext;     /* free list link */
+    struct OMX_OSAL_BUFFERPOOLTYPE *pPool;      /* owning pool */
+    OMX_U32 nMagic;
+} OMX_OSAL_BUFFERBLOCKTYPE;
+
+typedef struct OMX_OSAL_BUFFERPOOLTYPE {
+    struct OMX_OSAL_BUFFERPOOLTYPE *pNext;
+    OMX_U32 nClass;
+    OMX_U32 nAlignment;
+    OMX_BOOL bContiguous;
+    OMX_OSAL_BUFFERBLOCKTYPE *pFree;
+    OMX_U32 nOutstanding;
+    OMX_U32 nAllocs;
+    OMX_U32 nReuses;
+} OMX_OSAL_BUFFERPOOLTYPE;
+
+typedef struct OMX_OSAL_BUFFERSLABTYPE {
+    struct OMX_OSAL_BUFFERSLABTYPE *pNext;
+    OMX_U8 *pBase;
+    size_t nBytes;
+} OMX_OSAL_BUFFERSLABTYPE;
+
+static pthread_mutex_t g_OMX_OSAL_BufferPoolMutex = PTHREAD_MUTEX_INITIALIZER;
+static OMX_OSAL_BUFFERPOOLTYPE *g_OMX_OSAL_pBufferPools = NULL;
+static OMX_OSAL_BUFFERSLABTYPE *g_OMX_OSAL_pBufferSlabs = NULL;
+static OMX_BOOL g_OMX_OSAL_bBufferHugePages = OMX_FALSE;
+
+/* contiguous carve-out: one large locked mapping that emulates physically contiguous memory */
+static OMX_U8 *g_OMX_OSAL_pContigBase = NULL;
+static size_t g_OMX_OSAL_nContigBytes = OMX_OSAL_BUFFER_CONTIGBYTES;
+static size_t g_OMX_OSAL_nContigUsed = 0;
+
+static size_t OMX_OSAL_RoundUp(size_t nValue, size_t nMultiple)
+{
+    return (nValue + nMultiple - 1) & ~(nMultiple - 1);
+}
+
+static OMX_U32 OMX_OSAL_BufferSizeClass(OMX_U32 size)
+{
+    OMX_U32 nClass = OMX_OSAL_BUFFER_MINCLASS;
+    while (nClass < OMX_OSAL_BUFFER_MINCLASS + OMX_OSAL_BUFFER_NUMCLASSES - 1 && ((size_t)1 << nClass) < size)
+        nClass++;
+    return nClass;
+}
+
+static OMX_U8 *OMX_OSAL_MapSlab(size_t *pnBytes)
+{
+    OMX_U8 *pBase = MAP_FAILED;
+
+#ifdef MAP_HUGETLB
+    if (g_OMX_OSAL_bBufferHugePages)
+    {
+        size_t nHugeBytes = OMX_OSAL_RoundUp(*pnBytes, OMX_OSAL_BUFFER_HUGEPAGEBYTES);
+        pBase = mmap(NULL, nHugeBytes, PROT_READ|PROT_WRITE, MAP_PRIVATE|MAP_ANONYMOUS|MAP_HUGETLB, -1, 0);
+        if (pBase != MAP_FAILED)
+            *pnBytes = nHugeBytes;
+    }
+#endif
+    if (pBase == MAP_FAILED)
+    {
+        pBase = mmap(NULL, *pnBytes, PROT_READ|PROT_WRITE, MAP_PRIVATE|MAP_ANONYMOUS, -1, 0);
+        if (pBase == MAP_FAILED)
+            return NULL;
+#ifdef MADV_HUGEPAGE
+        /* no reserved hugepages; ask for transparent ones instead */
+        if (g_OMX_OSAL_bBufferHugePages)
+            madvise(pBase, *pnBytes, MADV_HUGEPAGE);
+#endif
+    }
+    return pBase;
+}
+
+static OMX_U8 *OMX_OSAL_CarveContiguous(size_t nBytes)
+{
+    OMX_U8 *pBase;
+
+    if (!g_OMX_OSAL_pContigBase)
+    {
+        g_OMX_OSAL_pContigBase = mmap(NULL, g_OMX_OSAL_nContigBytes, PROT_READ|PROT_WRITE,
+                                      MAP_PRIVATE|MAP_ANONYMOUS|MAP_POPULATE, -1, 0);
+        if (g_OMX_OSAL_pContigBase == MAP_FAILED) {
+            g_OMX_OSAL_pContigBase = NULL;
+            return NULL;
+        }
+        /* pin the carve-out so it behaves like a reserved physical region (best effort) */
+        mlock(g_OMX_OSAL_pContigBase, g_OMX_OSAL_nContigBytes);
+        g_OMX_OSAL_nContigUsed = 0;
+    }
+
+    if (nBytes > g_OMX_OSAL_nContigBytes - g_OMX_OSAL_nContigUsed)
+        return NULL;
+
+    pBase = g_OMX_OSAL_pContigBase + g_OMX_OSAL_nContigUsed;
+    g_OMX_OSAL_nContigUsed += nBytes;
+    return pBase;
+}
+
+/* Carve a fresh run of blocks for the pool and put them on its free list. */
+static OMX_ERRORTYPE OMX_OSAL_BufferPoolGrow(OMX_OSAL_BUFFERPOOLTYPE *pPool)
+{
+    size_t nBlockBytes = (size_t)1 << pPool->nClass;
+    size_t nStride = OMX_OSAL_RoundUp(nBlockBytes + OMX_OSAL_BUFFER_HEADERBYTES, pPool->nAlignment);
+    size_t nBytes, nFirst;
+    OMX_U8 *pBase, *pData;
+    OMX_OSAL_BUFFERSLABTYPE *pSlab = NULL;
+    OMX_OSAL_BUFFERBLOCKTYPE *pBlock;
+
+    /* worst case distance from the slab base to the first aligned data pointer */
+    nFirst = OMX_OSAL_BUFFER_HEADERBYTES + pPool->nAlignment;
+
+    if (pPool->bContiguous)
+    {
+        /* contiguous carve-outs are taken one block at a time so the region is not wasted */
+        nBytes = nFirst + nBlockBytes;
+        pBase = OMX_OSAL_CarveContiguous(OMX_OSAL_RoundUp(nBytes, OMX_OSAL_BUFFER_MINALIGNMENT));
+        if (!pBase) {
+            OMX_OSAL_Trace(OMX_OSAL_TRACE_ERROR, "Contiguous buffer region exhausted (%u of %u bytes used).\n",
+                           (OMX_U32)g_OMX_OSAL_nContigUsed, (OMX_U32)g_OMX_OSAL_nContigBytes);
+            return OMX_ErrorInsufficientResources;
+        }
+    }
+    else
+    {
+        nBytes = nFirst + nBlockBytes;
+        if (nBytes < OMX_OSAL_BUFFER_SLABBYTES)
+            nBytes = OMX_OSAL_BUFFER_SLABBYTES;
+        pSlab = (OMX_OSAL_BUFFERSLABTYPE *)malloc(sizeof(OMX_OSAL_BUFFERSLABTYPE));
+        if (!pSlab)
+            return OMX_ErrorInsufficientResources;
+        pBase = OMX_OSAL_MapSlab(&nBytes);
+        if (!pBase) {
+            free(pSlab);
+            return OMX_ErrorInsufficientResources;
+        }
+        pSlab->pBase = pBase;
+        pSlab->nBytes = nBytes;
+        pSlab->pNext = g_OMX_OSAL_pBufferSlabs;
+        g_OMX_OSAL_pBufferSlabs = pSlab;
+    }
+
+    /* align against the absolute address; the stride keeps every following block aligned */
+    pData = (OMX_U8 *)OMX_OSAL_RoundUp((size_t)(uintptr_t)(pBase + OMX_OSAL_BUFFER_HEADERBYTES), pPool->nAlignment);
+    while (pData + nBlockBytes <= pBase + nBytes)
+    {
+        pBlock = (OMX_OSAL_BUFFERBLOCKTYPE *)(pData - OMX_OSAL_BUFFER_HEADERBYTES);
+        pBlock->nMagic = OMX_OSAL_BUFFER_FREEMAGIC;
+        pBlock->pPool = pPool;
+        pBlock->pNext = pPool->pFree;
+        pPool->pFree = pBlock;
+        pData += nStride;
+    }
+
+    return pPool->pFree ? OMX_ErrorNone : OMX_ErrorInsufficientResources;
+}
+
+static OMX_OSAL_BUFFERPOOLTYPE *OMX_OSAL_FindBufferPool(OMX_U32 nClass, OMX_U32 nAlignment, OMX_BOOL bContiguous)
+{
+    OMX_OSAL_BUFFERPOOLTYPE *pPool;
+
+    for (pPool = g_OMX_OSAL_pBufferPools; pPool; pPool = pPool->pNext) {
+        if (pPool->nClass == nClass && pPool->nAlignment == nAlignment && pPool->bContiguous == bContiguous)
+            return pPool;
+    }
+
+    pPool = (OMX_OSAL_BUFFERPOOLTYPE *)malloc(sizeof(OMX_OSAL_BUFFERPOOLTYPE));
+    if (!pPool)
+        return NULL;
+    memset(pPool, 0, sizeof(OMX_OSAL_BUFFERPOOLTYPE));
+    pPool->nClass = nClass;
+    pPool->nAlignment = nAlignment;
+    pPool->bContiguous = bContiguous;
+    pPool->pNext = g_OMX_OSAL_pBufferPools;
+    g_OMX_OSAL_pBufferPools = pPool;
+    return pPool;
+}
+
+OMX_ERRORTYPE OMX_OSAL_BufferPoolSetup( OMX_IN OMX_BOOL bHugePages, OMX_IN OMX_U32 nContiguousBytes )
+{
+    OMX_ERRORTYPE eError = OMX_ErrorNone;
+
+    pthread_mutex_lock(&g_OMX_OSAL_BufferPoolMutex);
+    g_OMX_OSAL_bBufferHugePages = bHugePages;
+    if (nContiguousBytes)
+    {
+        if (g_OMX_OSAL_pContigBase) {
+            /* region already mapped and in use; size can only change after a release */
+            eError = OMX_ErrorIncorrectStateOperation;
+        } else {
+            g_OMX_OSAL_nContigBytes = OMX_OSAL_RoundUp(nContiguousBytes, OMX_OSAL_BUFFER_HUGEPAGEBYTES);
+        }
+    }
+    pthread_mutex_unlock(&g_OMX_OSAL_BufferPoolMutex);
+    return eError;
+}
+
+OMX_ERRORTYPE OMX_OSAL_BufferPoolRelease()
+{
+    OMX_OSAL_BUFFERPOOLTYPE *pPool, *pNextPool;
+    OMX_OSAL_BUFFERSLABTYPE *pSlab, *pNextSlab;
+
+    pthread_mutex_lock(&g_OMX_OSAL_BufferPoolMutex);
+
+    for (pPool = g_OMX_OSAL_pBufferPools; pPool; pPool = pPool->pNext) {
+        if (pPool->nOutstanding) {
+            pthread_mutex_unlock(&g_OMX_OSAL_BufferPoolMutex);
+            OMX_OSAL_Trace(OMX_OSAL_TRACE_WARNING, "Buffer pools not released, %u buffers of %u bytes still in use.\n",
+                           pPool->nOutstanding, 1 << pPool->nClass);
+            return OMX_ErrorNotReady;
+        }
+    }
+
+    for (pPool = g_OMX_OSAL_pBufferPools; pPool; pPool = pNextPool) {
+        pNextPool = pPool->pNext;
+        free(pPool);
+    }
+    g_OMX_OSAL_pBufferPools = NULL;
+
+    for (pSlab = g_OMX_OSAL_pBufferSlabs; pSlab; pSlab = pNextSlab) {
+        pNextSlab = pSlab->pNext;
+        munmap(pSlab->pBase, pSlab->nBytes);
+        free(pSlab);
+    }
+    g_OMX_OSAL_pBufferSlabs = NULL;
+
+    if (g_OMX_OSAL_pContigBase) {
+        munmap(g_OMX_OSAL_pContigBase, g_OMX_OSAL_nContigBytes);
+        g_OMX_OSAL_pContigBase = NULL;
+        g_OMX_OSAL_nContigUsed = 0;
+    }
+
+    pthread_mutex_unlock(&g_OMX_OSAL_BufferPoolMutex);
+    return OMX_ErrorNone;
+}
+
 OMX_PTR OMX_OSAL_MallocBuffer(    OMX_IN OMX_U32 size,
                             OMX_BOOL bBuffersContiguous, 
                             OMX_U32 nBufferAlignment )
 {
-/** The memory allocation will fail if contiguous memory and/or if a specific byte alignment is requested. 
-These definitions must be modified by the implementer if required to handle contiguous memory allocation and/or specific byte alignment. */
-    if ((OMX_FALSE != bBuffersContiguous) || (0 != nBufferAlignment)) 
+    OMX_OSAL_BUFFERPOOLTYPE *pPool;
+    OMX_OSAL_BUFFERBLOCKTYPE *pBlock = NULL;
+    OMX_U32 nAlignment = OMX_OSAL_BUFFER_MINALIGNMENT;
+
+    /* OpenMAX alignments are powers of two; anything else cannot be honoured */
+    if (nBufferAlignment & (nBufferAlignment - 1)) {
+        OMX_OSAL_Trace(OMX_OSAL_TRACE_ERROR, "Buffer alignment %u is not a power of two.\n", nBufferAlignment);
+        return NULL;
+    }
+    if (nBufferAlignment > nAlignment)
+        nAlignment = nBufferAlignment;
+    if (size > ((OMX_U32)1 << (OMX_OSAL_BUFFER_MINCLASS + OMX_OSAL_BUFFER_NUMCLASSES - 1))) {
+        OMX_OSAL_Trace(OMX_OSAL_TRACE_ERROR, "Buffer allocation of %u bytes exceeds the largest size class.\n", size);
+        return NULL;
+    }
+
+    pthread_mutex_lock(&g_OMX_OSAL_BufferPoolMutex);
+
+    pPool = OMX_OSAL_FindBufferPool(OMX_OSAL_BufferSizeClass(size), nAlignment,
+                                    bBuffersContiguous ? OMX_TRUE : OMX_FALSE);
+    if (pPool)
+    {
+        if (pPool->pFree) {
+            pPool->nReuses++;
+        } else if (OMX_ErrorNone != OMX_OSAL_BufferPoolGrow(pPool)) {
+            pPool = NULL;
+        }
+    }
+    if (pPool)
     {
-        /** Log the error and return a NULL pointer */
-        OMX_OSAL_Trace(OMX_OSAL_TRACE_ERROR,
-                    "Support for aligned/contiguous memory allocation not implemented.\n"); 
-        return(NULL);
+        pBlock = pPool->pFree;
+        pPool->pFree = pBlock->pNext;
+        pBlock->pNext = NULL;
+        pBlock->nMagic = OMX_OSAL_BUFFER_MAGIC;
+        pPool->nOutstanding++;
+        pPool->nAllocs++;
     }
-    return OMX_OSAL_Malloc(size);
+
+    pthread_mutex_unlock(&g_OMX_OSAL_BufferPoolMutex);
+
+    if (!pBlock) {
+        OMX_OSAL_Trace(OMX_OSAL_TRACE_ERROR, "Buffer allocation of %u bytes (alignment %u%s) failed.\n",
+                       size, nAlignment, bBuffersContiguous ? ", contiguous" : "");
+        return NULL;
+    }
+    return (OMX_PTR)((OMX_U8 *)pBlock + OMX_OSAL_BUFFER_HEADERBYTES);
 }
 
 void OMX_OSAL_FreeBuffer( OMX_IN OMX_PTR pData,
                             OMX_BOOL bBuffersContiguous, 
                             OMX_U32 nBufferAlignment )  
 {
-/** The memory de-allocation will fail if contiguous memory and/or if a specific byte alignment is requested. 
-These definitions must be modified by the implementer if required to handle contiguous memory allocation and/or specific byte alignment. */
-    if ((OMX_FALSE != bBuffersContiguous) || (0 != nBufferAlignment)) 
-    {
-        /** Log the error and return */
-        OMX_OSAL_Trace(OMX_OSAL_TRACE_ERROR,
-                    "Support for aligned/contiguous memory allocation not implemented.\n");
-                    
+    OMX_OSAL_BUFFERBLOCKTYPE *pBlock;
+
+    /* the pool is recorded in the block header; the flags are only used as a sanity check */
+    UNUSED_PARAMETER(nBufferAlignment);
+
+    if (!pData)
+        return;
+
+    pBlock = (OMX_OSAL_BUFFERBLOCKTYPE *)((OMX_U8 *)pData - OMX_OSAL_BUFFER_HEADERBYTES);
+    if (pBlock->nMagic != OMX_OSAL_BUFFER_MAGIC) {
+        OMX_OSAL_Trace(OMX_OSAL_TRACE_ERROR, "OMX_OSAL_FreeBuffer: 0x%08x is not an allocated buffer.\n", pData);
+        return;
     }
-    else 
-    {
-        OMX_OSAL_Free(pData);
+    if ((bBuffersContiguous ? OMX_TRUE : OMX_FALSE) != pBlock->pPool->bContiguous) {
+        OMX_OSAL_Trace(OMX_OSAL_TRACE_WARNING, "OMX_OSAL_FreeBuffer: contiguous flag does not match allocation.\n");
     }
+
+    pthread_mutex_lock(&g_OMX_OSAL_BufferPoolMutex);
+    pBlock->nMagic = OMX_OSAL_BUFFER_FREEMAGIC;
+    pBlock->pNext = pBlock->pPool->pFree;
+    pBlock->pPool->pFree = pBlock;
+    pBlock->pPool->nOutstanding--;
+    pthread_mutex_unlock(&g_OMX_OSAL_BufferPoolMutex);
 }
                             
 OMX_PTR OMX_OSAL_Memset( OMX_IN OMX_PTR pDest, OMX_IN OMX_U32 cChar, OMX_IN OMX_U32 nCount)
@@ -96,18 +416,58 @@ OMX_PTR OMX_OSAL_Memcpy( OMX_IN OMX_PTR pDest, OMX_IN OMX_PTR pSrc, OMX_IN OMX_U
  * THREADS               
  **********************************************************************/
 
+#define OMX_OSAL_PRIORITY_NICELEVELS 19     /* 1..19 map to nice -1..-19, above that SCHED_FIFO */
+
 typedef struct OMX_OSAL_THREADDATATYPE {
     pthread_t oPosixThread;
     pthread_attr_t oThreadAttr;
     OMX_U32 (*pFunc)(OMX_PTR pParam);
     OMX_PTR pParam;
+    OMX_U32 nPriority;
     OMX_U32 uReturn;
 } OMX_OSAL_THREADDATATYPE;
 
+/* Apply an OSAL priority to the calling thread. 0 is normal priority,
+   1..OMX_OSAL_PRIORITY_NICELEVELS raise the nice level and higher values
+   select SCHED_FIFO. Raising priority usually needs privileges; failing to
+   do so is not an error, the thread just runs at normal priority. */
+static void OMX_OSAL_ApplyPriority(OMX_U32 nPriority)
+{
+    static OMX_BOOL bWarned = OMX_FALSE;
+    struct sched_param sched;
+    int nPolicy = SCHED_OTHER;
+    int nNice = 0;
+    int err;
+
+    memset(&sched, 0, sizeof(sched));
+    if (nPriority > OMX_OSAL_PRIORITY_NICELEVELS) {
+        nPolicy = SCHED_FIFO;
+        sched.sched_priority = sched_get_priority_min(SCHED_FIFO) + 
+                               (int)(nPriority - OMX_OSAL_PRIORITY_NICELEVELS - 1);
+        if (sched.sched_priority > sched_get_priority_max(SCHED_FIFO))
+            sched.sched_priority = sched_get_priority_max(SCHED_FIFO);
+    }
+    else {
+        nNice = -(int)nPriority;
+    }
+
+    err = pthread_setschedparam(pthread_self(), nPolicy, &sched);
+    if (!err && nPolicy == SCHED_OTHER)
+        err = setpriority(PRIO_PROCESS, (id_t)syscall(SYS_gettid), nNice) ? errno : 0;
+
+    if (err && nPriority && !bWarned) {
+        bWarned = OMX_TRUE;
+        OMX_OSAL_Trace(OMX_OSAL_TRACE_INFO, "Unable to apply thread priority %d (error %d), using normal priority\n",
+                       nPriority, err);
+    }
+}
+
 static void *threadFunc(void *pParameter)
 { 
    OMX_OSAL_THREADDATATYPE *pThreadData;
    pThreadData = (OMX_OSAL_THREADDATATYPE *)pParameter;
+   if (pThreadData->nPriority)
+       OMX_OSAL_ApplyPriority(pThreadData->nPriority);
    pThreadData->uReturn = pThreadData->pFunc(pThreadData->pParam);
    return pThreadData;
 }
@@ -122,7 +482,6 @@ OMX_ERRORTYPE OMX_OSAL_ThreadCreate( OMX_IN OMX_U32 (*pFunc)(OMX_PTR pParam),
                                      OMX_OUT OMX_HANDLETYPE *phThread )
 {
     OMX_OSAL_THREADDATATYPE *pThreadData;
-    struct sched_param sched;
 
     pThreadData = (OMX_OSAL_THREADDATATYPE*)OMX_OSAL_Malloc(sizeof(OMX_OSAL_THREADDATATYPE));
     if (pThreadData == NULL)
@@ -130,15 +489,11 @@ OMX_ERRORTYPE OMX_OSAL_ThreadCreate( OMX_IN OMX_U32 (*pFunc)(OMX_PTR pParam),
 
     pThreadData->pFunc = pFunc;
     pThreadData->pParam = pParam;
+    pThreadData->nPriority = nPriority;
     pThreadData->uReturn = 0;
     
     pthread_attr_init(&pThreadData->oThreadAttr);
 
-    pthread_attr_getschedparam(&pThreadData->oThreadAttr, &sched);
-    sched.sched_priority += nPriority; /* relative to the default priority */
-    pthread_attr_setschedparam(&pThreadData->oThreadAttr, &sched);
-
-
     if (pthread_create(&pThreadData->oPosixThread,
                        &pThreadData->oThreadAttr,
                        threadFunc,
@@ -164,25 +519,419 @@ OMX_ERRORTYPE OMX_OSAL_ThreadDestroy( OMX_IN OMX_HANDLETYPE hThread )
     return OMX_ErrorNone;       
 }
 
+static int OMX_OSAL_ThreadId();
+
+OMX_U32 OMX_OSAL_GetThreadId()
+{
+    return (OMX_U32)OMX_OSAL_ThreadId();
+}
+
+/* The calling thread is answered by getrusage, which reports the same
+   counters as /proc without the cost of opening a file. */
+OMX_ERRORTYPE OMX_OSAL_GetThreadSwitches( OMX_IN OMX_U32 nThreadId, 
+                                          OMX_OUT OMX_U64 *pnVoluntary, 
+                                          OMX_OUT OMX_U64 *pnInvoluntary )
+{
+    char sPath[64];
+    char sLine[128];
+    unsigned long long nValue;
+    struct rusage oUsage;
+    FILE *pFile;
+    int nFound = 0;
+
+    if (nThreadId == (OMX_U32)OMX_OSAL_ThreadId() && getrusage(RUSAGE_THREAD, &oUsage) == 0) {
+        *pnVoluntary = (OMX_U64)oUsage.ru_nvcsw;
+        *pnInvoluntary = (OMX_U64)oUsage.ru_nivcsw;
+        return OMX_ErrorNone;
+    }
+
+    sprintf(sPath, "/proc/self/task/%u/status", nThreadId);
+    pFile = fopen(sPath, "r");
+    if (!pFile)
+        return OMX_ErrorBadParameter;
+    while (nFound != 3 && fgets(sLine, sizeof(sLine), pFile)) {
+        if (sscanf(sLine, "voluntary_ctxt_switches: %llu", &nValue) == 1) {
+            *pnVoluntary = (OMX_U64)nValue;
+            nFound |= 1;
+        } else if (sscanf(sLine, "nonvoluntary_ctxt_switches: %llu", &nValue) == 1) {
+            *pnInvoluntary = (OMX_U64)nValue;
+            nFound |= 2;
+        }
+    }
+    fclose(pFile);
+    return nFound == 3 ? OMX_ErrorNone : OMX_ErrorBadParameter;
+}
+
+/**********************************************************************
+ * THREAD POOL
+ *
+ * Work items run on pooled worker threads that are created on demand and
+ * kept for reuse, so tests do not pay thread creation on every run. A
+ * new worker is only started when no idle worker is available; work
+ * items may therefore block on each other without deadlocking the pool.
+ * Priority and affinity are applied per work item and undone afterwards.
+ **********************************************************************/
+
+typedef enum OMX_OSAL_WORKSTATETYPE {
+    OMX_OSAL_WorkQueued,
+    OMX_OSAL_WorkRunning,
+    OMX_OSAL_WorkDone
+} OMX_OSAL_WORKSTATETYPE;
+
+typedef struct OMX_OSAL_WORKITEMTYPE {
+    struct OMX_OSAL_WORKITEMTYPE *pNext;
+    OMX_U32 (*pFunc)(OMX_PTR pParam);
+    OMX_PTR pParam;
+    OMX_U32 nPriority;
+    OMX_U64 nAffinityMask;
+    OMX_U32 uReturn;
+    OMX_OSAL_WORKSTATETYPE eState;
+    pthread_cond_t oDone;
+} OMX_OSAL_WORKITEMTYPE;
+
+typedef struct OMX_OSAL_WORKERTYPE {
+    struct OMX_OSAL_WORKERTYPE *pNext;
+    pthread_t oPosixThread;
+} OMX_OSAL_WORKERTYPE;
+
+static pthread_mutex_t g_OMX_OSAL_ThreadPoolMutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t g_OMX_OSAL_ThreadPoolCond = PTHREAD_COND_INITIALIZER;
+static OMX_OSAL_WORKITEMTYPE *g_OMX_OSAL_pWorkHead = NULL;
+static OMX_OSAL_WORKITEMTYPE *g_OMX_OSAL_pWorkTail = NULL;
+static OMX_OSAL_WORKERTYPE *g_OMX_OSAL_pWorkers = NULL;
+static OMX_U32 g_OMX_OSAL_nWorkQueued = 0;
+static OMX_U32 g_OMX_OSAL_nIdleWorkers = 0;
+static OMX_BOOL g_OMX_OSAL_bThreadPoolShutdown = OMX_FALSE;
+
+static void *OMX_OSAL_WorkerFunc(void *pParameter)
+{
+    OMX_OSAL_WORKITEMTYPE *pWork;
+    cpu_set_t oDefaultSet, oSet;
+    OMX_U32 i;
+
+    UNUSED_PARAMETER(pParameter);
+    pthread_getaffinity_np(pthread_self(), sizeof(oDefaultSet), &oDefaultSet);
+
+    pthread_mutex_lock(&g_OMX_OSAL_ThreadPoolMutex);
+    for (;;) {
+        while (g_OMX_OSAL_pWorkHead == NULL && !g_OMX_OSAL_bThreadPoolShutdown) {
+            g_OMX_OSAL_nIdleWorkers++;
+            pthread_cond_wait(&g_OMX_OSAL_ThreadPoolCond, &g_OMX_OSAL_ThreadPoolMutex);
+            g_OMX_OSAL_nIdleWorkers--;
+        }
+        if (g_OMX_OSAL_pWorkHead == NULL)
+            break;
+
+        pWork = g_OMX_OSAL_pWorkHead;
+        g_OMX_OSAL_pWorkHead = pWork->pNext;
+        if (g_OMX_OSAL_pWorkHead == NULL)
+            g_OMX_OSAL_pWorkTail = NULL;
+        g_OMX_OSAL_nWorkQueued--;
+        pWork->eState = OMX_OSAL_WorkRunning;
+        pthread_mutex_unlock(&g_OMX_OSAL_ThreadPoolMutex);
+
+        if (pWork->nAffinityMask) {
+            CPU_ZERO(&oSet);
+            for (i = 0; i < 64 && i < CPU_SETSIZE; i++) {
+                if (pWork->nAffinityMask & ((OMX_U64)1 << i))
+                    CPU_SET(i, &oSet);
+            }
+            pthread_setaffinity_np(pthread_self(), sizeof(oSet), &oSet);
+        }
+        if (pWork->nPriority)
+            OMX_OSAL_ApplyPriority(pWork->nPriority);
+
+        pWork->uReturn = pWork->pFunc(pWork->pParam);
+
+        if (pWork->nPriority)
+            OMX_OSAL_ApplyPriority(0);
+        if (pWork->nAffinityMask)
+            pthread_setaffinity_np(pthread_self(), sizeof(oDefaultSet), &oDefaultSet);
+
+        pthread_mutex_lock(&g_OMX_OSAL_ThreadPoolMutex);
+        pWork->eState = OMX_OSAL_WorkDone;
+        pthread_cond_broadcast(&pWork->oDone);
+    }
+    pthread_mutex_unlock(&g_OMX_OSAL_ThreadPoolMutex);
+    return NULL;
+}
+
+/* Called with the pool mutex held. */
+static OMX_ERRORTYPE OMX_OSAL_StartWorker()
+{
+    OMX_OSAL_WORKERTYPE *pWorker;
+
+    pWorker = (OMX_OSAL_WORKERTYPE *)OMX_OSAL_Malloc(sizeof(OMX_OSAL_WORKERTYPE));
+    if (pWorker == NULL)
+        return OMX_ErrorInsufficientResources;
+    if (pthread_create(&pWorker->oPosixThread, NULL, OMX_OSAL_WorkerFunc, NULL)) {
+        OMX_OSAL_Free(pWorker);
+        return OMX_ErrorInsufficientResources;
+    }
+    pWorker->pNext = g_OMX_OSAL_pWorkers;
+    g_OMX_OSAL_pWorkers = pWorker;
+    return OMX_ErrorNone;
+}
+
+/** Start nThreads idle workers ahead of time. */
+OMX_ERRORTYPE OMX_OSAL_ThreadPoolSetup( OMX_IN OMX_U32 nThreads )
+{
+    OMX_ERRORTYPE eError = OMX_ErrorNone;
+    OMX_U32 i;
+
+    pthread_mutex_lock(&g_OMX_OSAL_ThreadPoolMutex);
+    g_OMX_OSAL_bThreadPoolShutdown = OMX_FALSE;
+    for (i = 0; i < nThreads && eError == OMX_ErrorNone; i++)
+        eError = OMX_OSAL_StartWorker();
+    pthread_mutex_unlock(&g_OMX_OSAL_ThreadPoolMutex);
+    return eError;
+}
+
+/** Stop and join all workers. Work still queued is run first. */
+OMX_ERRORTYPE OMX_OSAL_ThreadPoolRelease()
+{
+    OMX_OSAL_WORKERTYPE *pWorker, *pNext;
+
+    pthread_mutex_lock(&g_OMX_OSAL_ThreadPoolMutex);
+    g_OMX_OSAL_bThreadPoolShutdown = OMX_TRUE;
+    pthread_cond_broadcast(&g_OMX_OSAL_ThreadPoolCond);
+    pWorker = g_OMX_OSAL_pWorkers;
+    g_OMX_OSAL_pWorkers = NULL;
+    pthread_mutex_unlock(&g_OMX_OSAL_ThreadPoolMutex);
+
+    while (pWorker) {
+        pNext = pWorker->pNext;
+        pthread_join(pWorker->oPosixThread, NULL);
+        OMX_OSAL_Free(pWorker);
+        pWorker = pNext;
+    }
+
+    pthread_mutex_lock(&g_OMX_OSAL_ThreadPoolMutex);
+    g_OMX_OSAL_bThreadPoolShutdown = OMX_FALSE;
+    pthread_mutex_unlock(&g_OMX_OSAL_ThreadPoolMutex);
+    return OMX_ErrorNone;
+}
+
+/** Queue pFunc(pParam) to run on a pool thread. */
+OMX_ERRORTYPE OMX_OSAL_ThreadPoolSubmit( OMX_IN OMX_U32 (*pFunc)(OMX_PTR pParam), 
+                                         OMX_IN OMX_PTR pParam, 
+                                         OMX_IN OMX_U32 nPriority, 
+                                         OMX_IN OMX_U64 nAffinityMask,
+                                         OMX_OUT OMX_HANDLETYPE *phWork )
+{
+    OMX_OSAL_WORKITEMTYPE *pWork;
+    OMX_ERRORTYPE eError = OMX_ErrorNone;
+
+    if (pFunc == NULL || phWork == NULL)
+        return OMX_ErrorBadParameter;
+
+    pWork = (OMX_OSAL_WORKITEMTYPE *)OMX_OSAL_Malloc(sizeof(OMX_OSAL_WORKITEMTYPE));
+    if (pWork == NULL)
+        return OMX_ErrorInsufficientResources;
+
+    pWork->pNext = NULL;
+    pWork->pFunc = pFunc;
+    pWork->pParam = pParam;
+    pWork->nPriority = nPriority;
+    pWork->nAffinityMask = nAffinityMask;
+    pWork->uReturn = 0;
+    pWork->eState = OMX_OSAL_WorkQueued;
+    pthread_cond_init(&pWork->oDone, NULL);
+
+    pthread_mutex_lock(&g_OMX_OSAL_ThreadPoolMutex);
+    if (g_OMX_OSAL_nIdleWorkers <= g_OMX_OSAL_nWorkQueued) {
+        eError = OMX_OSAL_StartWorker();
+    }
+    if (eError == OMX_ErrorNone) {
+        if (g_OMX_OSAL_pWorkTail)
+            g_OMX_OSAL_pWorkTail->pNext = pWork;
+        else
+            g_OMX_OSAL_pWorkHead = pWork;
+        g_OMX_OSAL_pWorkTail = pWork;
+        g_OMX_OSAL_nWorkQueued++;
+        pthread_cond_signal(&g_OMX_OSAL_ThreadPoolCond);
+    }
+    pthread_mutex_unlock(&g_OMX_OSAL_ThreadPoolMutex);
+
+    if (eError != OMX_ErrorNone) {
+        pthread_cond_destroy(&pWork->oDone);
+        OMX_OSAL_Free(pWork);
+        return eError;
+    }
+    *phWork = (OMX_HANDLETYPE)pWork;
+    return OMX_ErrorNone;
+}
+
+/** Wait for a work item to finish and release it. */
+OMX_ERRORTYPE OMX_OSAL_ThreadPoolWait( OMX_IN OMX_HANDLETYPE hWork, OMX_OUT OMX_U32 *puReturn )
+{
+    OMX_OSAL_WORKITEMTYPE *pWork = (OMX_OSAL_WORKITEMTYPE *)hWork;
+
+    if (pWork == NULL)
+        return OMX_ErrorBadParameter;
+
+    pthread_mutex_lock(&g_OMX_OSAL_ThreadPoolMutex);
+    while (pWork->eState != OMX_OSAL_WorkDone)
+        pthread_cond_wait(&pWork->oDone, &g_OMX_OSAL_ThreadPoolMutex);
+    pthread_mutex_unlock(&g_OMX_OSAL_ThreadPoolMutex);
+
+    if (puReturn)
+        *puReturn = pWork->uReturn;
+    pthread_cond_destroy(&pWork->oDone);
+    OMX_OSAL_Free(pWork);
+    return OMX_ErrorNone;
+}
+
+/** Remove a work item that has not started yet and release it. */
+OMX_ERRORTYPE OMX_OSAL_ThreadPoolCancel( OMX_IN OMX_HANDLETYPE hWork )
+{
+    OMX_OSAL_WORKITEMTYPE *pWork = (OMX_OSAL_WORKITEMTYPE *)hWork;
+    OMX_OSAL_WORKITEMTYPE **ppLink, *pPrev = NULL;
+
+    if (pWork == NULL)
+        return OMX_ErrorBadParameter;
+
+    pthread_mutex_lock(&g_OMX_OSAL_ThreadPoolMutex);
+    if (pWork->eState != OMX_OSAL_WorkQueued) {
+        pthread_mutex_unlock(&g_OMX_OSAL_ThreadPoolMutex);
+        return OMX_ErrorNotReady;
+    }
+    for (ppLink = &g_OMX_OSAL_pWorkHead; *ppLink != pWork; ppLink = &(*ppLink)->pNext)
+        pPrev = *ppLink;
+    *ppLink = pWork->pNext;
+    if (g_OMX_OSAL_pWorkTail == pWork)
+        g_OMX_OSAL_pWorkTail = pPrev;
+    g_OMX_OSAL_nWorkQueued--;
+    pthread_mutex_unlock(&g_OMX_OSAL_ThreadPoolMutex);
+
+    pthread_cond_destroy(&pWork->oDone);
+    OMX_OSAL_Free(pWork);
+    return OMX_ErrorNone;
+}
+
+/**********************************************************************
+ * SYNCHRONISATION PRIMITIVES
+ *
+ * Mutexes and events are built directly on futexes: the uncontended
+ * lock/unlock and set/wait paths are a single atomic operation with no
+ * system call. Waiters may spin briefly before sleeping; the spin count
+ * adapts per object to how long the lock or event usually takes.
+ * The pthread based implementation is kept so the two can be compared
+ * (see OMX_OSAL_SyncConfigure), and each object remembers which one it
+ * was created with.
+ **********************************************************************/
+
+static OMX_BOOL g_OMX_OSAL_bFutexSync = OMX_TRUE;
+static OMX_U32 g_OMX_OSAL_nSyncMaxSpin = 100;
+static __thread int g_OMX_OSAL_nThreadId = 0;
+
+/** Select the implementation used by subsequently created mutexes and events
+ *  and the maximum number of iterations a waiter spins before sleeping. */
+OMX_ERRORTYPE OMX_OSAL_SyncConfigure(OMX_IN OMX_BOOL bFutex, OMX_IN OMX_U32 nMaxSpin)
+{
+    g_OMX_OSAL_bFutexSync = bFutex;
+    g_OMX_OSAL_nSyncMaxSpin = nMaxSpin;
+    return OMX_ErrorNone;
+}
+
+static int OMX_OSAL_ThreadId()
+{
+    if (!g_OMX_OSAL_nThreadId)
+        g_OMX_OSAL_nThreadId = (int)syscall(SYS_gettid);
+    return g_OMX_OSAL_nThreadId;
+}
+
+static void OMX_OSAL_CpuRelax()
+{
+#if defined(__i386__) || defined(__x86_64__)
+    __asm__ __volatile__("pause");
+#elif defined(__aarch64__) || defined(__arm__)
+    __asm__ __volatile__("yield");
+#endif
+}
+
+/* Sleeps while *pWord == nValue. pDeadline is an absolute CLOCK_MONOTONIC
+   time or NULL to wait forever. Returns ETIMEDOUT once the deadline passed. */
+static int OMX_OSAL_FutexWait(volatile int *pWord, int nValue, const struct timespec *pDeadline)
+{
+    if (syscall(SYS_futex, pWord, FUTEX_WAIT_BITSET | FUTEX_PRIVATE_FLAG,
+                nValue, pDeadline, NULL, FUTEX_BITSET_MATCH_ANY) == -1)
+        return errno;
+    return 0;
+}
+
+static void OMX_OSAL_FutexWake(volatile int *pWord, int nCount)
+{
+    syscall(SYS_futex, pWord, FUTEX_WAKE | FUTEX_PRIVATE_FLAG, nCount, NULL, NULL, 0);
+}
+
+/* Spins up to the object's current estimate waiting for *pWord to leave
+   nBusy. The estimate grows when spinning paid off and shrinks when not. */
+static OMX_BOOL OMX_OSAL_AdaptiveSpin(volatile int *pWord, int nBusy, OMX_S32 *pSpin)
+{
+    static long nCpus = 0;
+    OMX_S32 nLimit = *pSpin * 2 + 10;
+    OMX_S32 i;
+
+    /* nobody can release us while we spin on a single cpu */
+    if (!nCpus)
+        nCpus = sysconf(_SC_NPROCESSORS_ONLN);
+    if (nCpus <= 1)
+        return OMX_FALSE;
+
+    if (nLimit > (OMX_S32)g_OMX_OSAL_nSyncMaxSpin)
+        nLimit = (OMX_S32)g_OMX_OSAL_nSyncMaxSpin;
+
+    for (i = 0; i < nLimit; i++) {
+        if (__atomic_load_n(pWord, __ATOMIC_ACQUIRE) != nBusy) {
+            *pSpin += (i - *pSpin) / 8;
+            return OMX_TRUE;
+        }
+        OMX_OSAL_CpuRelax();
+    }
+    *pSpin += (nLimit - *pSpin) / 8;
+    return OMX_FALSE;
+}
+
 /**********************************************************************
  * MUTEX               
  **********************************************************************/
 
+/* Recursive mutex. nState is 0 when unlocked, 1 when locked and 2 when
+   locked with (possible) sleepers. */
+typedef struct OMX_OSAL_MUTEXTYPE {
+    OMX_BOOL bFutex;
+    volatile int nState;
+    volatile int nOwner;
+    OMX_U32 nRecursion;
+    OMX_S32 nSpin;
+    pthread_mutex_t oPosixMutex;
+} OMX_OSAL_MUTEXTYPE;
+
 OMX_ERRORTYPE OMX_OSAL_MutexCreate(OMX_OUT OMX_HANDLETYPE *phMutex)
 {
-    pthread_mutex_t *pMutex = (pthread_mutex_t *)OMX_OSAL_Malloc(sizeof(pthread_mutex_t));
+    OMX_OSAL_MUTEXTYPE *pMutex = (OMX_OSAL_MUTEXTYPE *)OMX_OSAL_Malloc(sizeof(OMX_OSAL_MUTEXTYPE));
     static pthread_mutexattr_t oAttr;
     static pthread_mutexattr_t *pAttr = NULL;
-    if (pAttr == NULL
-        && !pthread_mutexattr_init(&oAttr)
-        && !pthread_mutexattr_settype(&oAttr, PTHREAD_MUTEX_RECURSIVE))
-    {
-        pAttr = &oAttr;
-    }
 
-    if (pMutex == NULL || pthread_mutex_init(pMutex, pAttr)) {
-        OMX_OSAL_Free(pMutex);
+    if (pMutex == NULL)
         return OMX_ErrorInsufficientResources;
+
+    memset(pMutex, 0, sizeof(OMX_OSAL_MUTEXTYPE));
+    pMutex->bFutex = g_OMX_OSAL_bFutexSync;
+
+    if (!pMutex->bFutex) {
+        if (pAttr == NULL
+            && !pthread_mutexattr_init(&oAttr)
+            && !pthread_mutexattr_settype(&oAttr, PTHREAD_MUTEX_RECURSIVE))
+        {
+            pAttr = &oAttr;
+        }
+
+        if (pthread_mutex_init(&pMutex->oPosixMutex, pAttr)) {
+            OMX_OSAL_Free(pMutex);
+            return OMX_ErrorInsufficientResources;
+        }
     }
     *phMutex = (void *)pMutex;
     return OMX_ErrorNone;       
@@ -191,8 +940,14 @@ OMX_ERRORTYPE OMX_OSAL_MutexCreate(OMX_OUT OMX_HANDLETYPE *phMutex)
 
 OMX_ERRORTYPE OMX_OSAL_MutexDestroy(OMX_IN OMX_HANDLETYPE hMutex)
 {
-    pthread_mutex_t *pMutex = (pthread_mutex_t *)hMutex;
-    if (pMutex == NULL || pthread_mutex_destroy(pMutex)) {
+    OMX_OSAL_MUTEXTYPE *pMutex = (OMX_OSAL_MUTEXTYPE *)hMutex;
+    if (pMutex == NULL)
+        return OMX_ErrorBadParameter;
+    if (pMutex->bFutex) {
+        if (__atomic_load_n(&pMutex->nState, __ATOMIC_ACQUIRE) != 0)
+            return OMX_ErrorBadParameter;
+    }
+    else if (pthread_mutex_destroy(&pMutex->oPosixMutex)) {
         return OMX_ErrorBadParameter;
     }    
     OMX_OSAL_Free(pMutex);
@@ -201,11 +956,40 @@ OMX_ERRORTYPE OMX_OSAL_MutexDestroy(OMX_IN OMX_HANDLETYPE hMutex)
 
 OMX_ERRORTYPE OMX_OSAL_MutexLock(OMX_IN OMX_HANDLETYPE hMutex)
 {
-    pthread_mutex_t *pMutex = (pthread_mutex_t *)hMutex;
+    OMX_OSAL_MUTEXTYPE *pMutex = (OMX_OSAL_MUTEXTYPE *)hMutex;
+    int nThreadId;
+    int nExpected;
     int err;
     if (pMutex == NULL)
         return OMX_ErrorBadParameter;
-    err = pthread_mutex_lock(pMutex);
+
+    if (pMutex->bFutex) {
+        nThreadId = OMX_OSAL_ThreadId();
+        if (__atomic_load_n(&pMutex->nOwner, __ATOMIC_RELAXED) == nThreadId) {
+            pMutex->nRecursion++;
+            return OMX_ErrorNone;
+        }
+
+        nExpected = 0;
+        if (!__atomic_compare_exchange_n(&pMutex->nState, &nExpected, 1, OMX_FALSE,
+                                         __ATOMIC_ACQUIRE, __ATOMIC_RELAXED)) {
+            /* contended: spin a little, then mark the lock as having sleepers */
+            if (nExpected == 1 && OMX_OSAL_AdaptiveSpin(&pMutex->nState, 1, &pMutex->nSpin)) {
+                nExpected = 0;
+                __atomic_compare_exchange_n(&pMutex->nState, &nExpected, 1, OMX_FALSE,
+                                            __ATOMIC_ACQUIRE, __ATOMIC_RELAXED);
+            }
+            if (nExpected != 0) {
+                while (__atomic_exchange_n(&pMutex->nState, 2, __ATOMIC_ACQUIRE) != 0)
+                    OMX_OSAL_FutexWait(&pMutex->nState, 2, NULL);
+            }
+        }
+        __atomic_store_n(&pMutex->nOwner, nThreadId, __ATOMIC_RELAXED);
+        pMutex->nRecursion = 1;
+        return OMX_ErrorNone;
+    }
+
+    err = pthread_mutex_lock(&pMutex->oPosixMutex);
     switch (err) {
     case 0:
         return OMX_ErrorNone;
@@ -222,11 +1006,24 @@ OMX_ERRORTYPE OMX_OSAL_MutexLock(OMX_IN OMX_HANDLETYPE hMutex)
 
 OMX_ERRORTYPE OMX_OSAL_MutexUnlock(OMX_IN OMX_HANDLETYPE hMutex)
 {
-    pthread_mutex_t *pMutex = (pthread_mutex_t *)hMutex;
+    OMX_OSAL_MUTEXTYPE *pMutex = (OMX_OSAL_MUTEXTYPE *)hMutex;
     int err;
     if (pMutex == NULL)
         return OMX_ErrorBadParameter;
-    err = pthread_mutex_unlock(pMutex);
+
+    if (pMutex->bFutex) {
+        if (__atomic_load_n(&pMutex->nOwner, __ATOMIC_RELAXED) != OMX_OSAL_ThreadId())
+            return OMX_ErrorNotReady;
+        if (--pMutex->nRecursion > 0)
+            return OMX_ErrorNone;
+
+        __atomic_store_n(&pMutex->nOwner, 0, __ATOMIC_RELAXED);
+        if (__atomic_exchange_n(&pMutex->nState, 0, __ATOMIC_RELEASE) == 2)
+            OMX_OSAL_FutexWake(&pMutex->nState, 1);
+        return OMX_ErrorNone;
+    }
+
+    err = pthread_mutex_unlock(&pMutex->oPosixMutex);
     switch (err) {
     case 0:
         return OMX_ErrorNone;
@@ -245,6 +1042,10 @@ OMX_ERRORTYPE OMX_OSAL_MutexUnlock(OMX_IN OMX_HANDLETYPE hMutex)
  **********************************************************************/
 
 typedef struct {
+    OMX_BOOL bFutex;
+    volatile int nSignaled;     /* futex word, 1 while set */
+    volatile int nWaiters;      /* threads sleeping (or about to) on nSignaled */
+    OMX_S32 nSpin;
     OMX_BOOL bSignaled;
     pthread_mutex_t mutex;
     pthread_cond_t  condition;
@@ -259,20 +1060,31 @@ OMX_ERRORTYPE OMX_OSAL_EventCreate(OMX_OUT OMX_HANDLETYPE *phEvent)
         - is unnamed
     */
     OMX_OSAL_THREAD_EVENT *pEvent = OMX_OSAL_Malloc(sizeof(OMX_OSAL_THREAD_EVENT));
+    pthread_condattr_t attr;
 
     if (pEvent == NULL)
         return OMX_ErrorInsufficientResources;
 
-        pEvent->bSignaled = OMX_FALSE;
+    memset(pEvent, 0, sizeof(OMX_OSAL_THREAD_EVENT));
+    pEvent->bFutex = g_OMX_OSAL_bFutexSync;
+    pEvent->bSignaled = OMX_FALSE;
 
-    if (pthread_mutex_init(&pEvent->mutex, NULL)) {
-        OMX_OSAL_Free(pEvent);
-        return OMX_ErrorInsufficientResources;
-    }
-    if (pthread_cond_init(&pEvent->condition, NULL)) {
-        pthread_mutex_destroy(&pEvent->mutex);
-        OMX_OSAL_Free(pEvent);
-        return OMX_ErrorInsufficientResources;
+    if (!pEvent->bFutex) {
+        if (pthread_mutex_init(&pEvent->mutex, NULL)) {
+            OMX_OSAL_Free(pEvent);
+            return OMX_ErrorInsufficientResources;
+        }
+        /* timed waits are measured against the monotonic clock so that they
+           are not disturbed by adjustments to the wall clock */
+        pthread_condattr_init(&attr);
+        pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+        if (pthread_cond_init(&pEvent->condition, &attr)) {
+            pthread_condattr_destroy(&attr);
+            pthread_mutex_destroy(&pEvent->mutex);
+            OMX_OSAL_Free(pEvent);
+            return OMX_ErrorInsufficientResources;
+        }
+        pthread_condattr_destroy(&attr);
     }
 
     *phEvent = (OMX_HANDLETYPE)pEvent;
@@ -285,12 +1097,14 @@ OMX_ERRORTYPE OMX_OSAL_EventDestroy(OMX_IN OMX_HANDLETYPE hEvent)
     if (pEvent == NULL)
         return OMX_ErrorBadParameter;
 
-    if (pthread_mutex_lock(&pEvent->mutex))
-        return OMX_ErrorBadParameter;
+    if (!pEvent->bFutex) {
+        if (pthread_mutex_lock(&pEvent->mutex))
+            return OMX_ErrorBadParameter;
 
-    pthread_cond_destroy(&pEvent->condition);
-    pthread_mutex_unlock(&pEvent->mutex);
-    pthread_mutex_destroy(&pEvent->mutex);
+        pthread_cond_destroy(&pEvent->condition);
+        pthread_mutex_unlock(&pEvent->mutex);
+        pthread_mutex_destroy(&pEvent->mutex);
+    }
     
     OMX_OSAL_Free(pEvent);
     return OMX_ErrorNone;       
@@ -302,6 +1116,11 @@ OMX_ERRORTYPE OMX_OSAL_EventReset(OMX_IN OMX_HANDLETYPE hEvent)
     if (pEvent == NULL)
         return OMX_ErrorBadParameter;
 
+    if (pEvent->bFutex) {
+        __atomic_store_n(&pEvent->nSignaled, 0, __ATOMIC_RELEASE);
+        return OMX_ErrorNone;
+    }
+
     if (pthread_mutex_lock(&pEvent->mutex))
         return OMX_ErrorBadParameter;
     pEvent->bSignaled = OMX_FALSE;
@@ -316,143 +1135,2025 @@ OMX_ERRORTYPE OMX_OSAL_EventSet(OMX_IN OMX_HANDLETYPE hEvent)
     if (pEvent == NULL)
         return OMX_ErrorBadParameter;
 
+    if (pEvent->bFutex) {
+        /* manual-reset: every waiter is released, and only a transition
+           with sleepers present costs a system call */
+        if (__atomic_exchange_n(&pEvent->nSignaled, 1, __ATOMIC_SEQ_CST) == 0
+            && __atomic_load_n(&pEvent->nWaiters, __ATOMIC_SEQ_CST) > 0)
+            OMX_OSAL_FutexWake(&pEvent->nSignaled, INT_MAX);
+        return OMX_ErrorNone;
+    }
+
     if (pthread_mutex_lock(&pEvent->mutex))
         return OMX_ErrorBadParameter;
     pEvent->bSignaled = OMX_TRUE;
-    pthread_cond_signal(&pEvent->condition);
+    pthread_cond_broadcast(&pEvent->condition);
     pthread_mutex_unlock(&pEvent->mutex);
 
     return OMX_ErrorNone;       
 }
 
-OMX_ERRORTYPE OMX_OSAL_EventWait(OMX_IN OMX_HANDLETYPE hEvent, OMX_IN OMX_U32 uMSec, OMX_OUT OMX_BOOL *pbTimedOut)
+static OMX_ERRORTYPE OMX_OSAL_EventBlock(OMX_HANDLETYPE hEvent, OMX_U32 uMSec, OMX_BOOL *pbTimedOut)
+{
+    OMX_OSAL_THREAD_EVENT *pEvent = (OMX_OSAL_THREAD_EVENT *)hEvent;
+    OMX_U64         timeout_ns;
+    struct timespec timeout;
+    int             retcode;
+
+    *pbTimedOut = OMX_FALSE;
+
+    if (pEvent == NULL)
+        return OMX_ErrorBadParameter;
+
+    if (pEvent->bFutex && __atomic_load_n(&pEvent->nSignaled, __ATOMIC_ACQUIRE))
+        return OMX_ErrorNone;
+
+    /* deadline on the monotonic clock the event condition was created with */
+    timeout_ns = OMX_OSAL_GetTimeNs() + (OMX_U64)uMSec * 1000000;
+    timeout.tv_sec = (time_t)(timeout_ns / 1000000000);
+    timeout.tv_nsec = (long)(timeout_ns % 1000000000);
+
+    if (pEvent->bFutex) {
+        if (uMSec == 0) {
+            *pbTimedOut = OMX_TRUE;
+            return OMX_ErrorNone;
+        }
+        if (OMX_OSAL_AdaptiveSpin(&pEvent->nSignaled, 0, &pEvent->nSpin))
+            return OMX_ErrorNone;
+
+        __atomic_add_fetch(&pEvent->nWaiters, 1, __ATOMIC_SEQ_CST);
+        while (!__atomic_load_n(&pEvent->nSignaled, __ATOMIC_SEQ_CST)) {
+            retcode = OMX_OSAL_FutexWait(&pEvent->nSignaled, 0, 
+                                         uMSec == INFINITE_WAIT ? NULL : &timeout);
+            if (retcode == ETIMEDOUT && !__atomic_load_n(&pEvent->nSignaled, __ATOMIC_SEQ_CST)) {
+                *pbTimedOut = OMX_TRUE;
+                break;
+            }
+        }
+        __atomic_sub_fetch(&pEvent->nWaiters, 1, __ATOMIC_SEQ_CST);
+        return OMX_ErrorNone;
+    }
+
+    if (pthread_mutex_lock(&pEvent->mutex))
+        return OMX_ErrorBadParameter;
+
+    if (uMSec == 0) {
+        if (!pEvent->bSignaled) {
+            *pbTimedOut = OMX_TRUE;
+        }
+    }
+    else if (uMSec == INFINITE_WAIT) {
+        while (!pEvent->bSignaled) {
+            pthread_cond_wait(&pEvent->condition, &pEvent->mutex);
+        }
+    }
+    else {
+        while (!pEvent->bSignaled) {
+            retcode = pthread_cond_timedwait(&pEvent->condition, &pEvent->mutex, &timeout);
+            if (retcode == ETIMEDOUT && !pEvent->bSignaled) {
+                *pbTimedOut = OMX_TRUE;
+                break;
+            }
+        }
+    }
+
+    pthread_mutex_unlock(&pEvent->mutex);
+    return OMX_ErrorNone;
+}
+
+/* Wait statistics per call site, in an open addressing table keyed by the 
+   file name literal and line. A site that finds the table full is not 
+   accounted. */
+#define OMX_OSAL_WAITSITES 512     /* power of two */
+
+static OMX_OSAL_WAITSITETYPE g_OMX_OSAL_WaitSites[OMX_OSAL_WAITSITES];
+static pthread_mutex_t g_OMX_OSAL_WaitSiteMutex = PTHREAD_MUTEX_INITIALIZER;
+
+static void OMX_OSAL_WaitSiteRecord(const char *sFile, OMX_U32 nLine, OMX_U32 uMSec, OMX_U64 nBlockedNs, OMX_BOOL bTimedOut)
+{
+    OMX_OSAL_WAITSITETYPE *pSite = NULL;
+    OMX_U32 i, n;
+
+    pthread_mutex_lock(&g_OMX_OSAL_WaitSiteMutex);
+    for (i = (OMX_U32)(((size_t)sFile >> 3) * 31 + nLine) & (OMX_OSAL_WAITSITES - 1), n = 0; n < OMX_OSAL_WAITSITES; 
+         i = (i + 1) & (OMX_OSAL_WAITSITES - 1), n++) {
+        if (!g_OMX_OSAL_WaitSites[i].sFile || (g_OMX_OSAL_WaitSites[i].sFile == sFile && g_OMX_OSAL_WaitSites[i].nLine == nLine)) {
+            pSite = &g_OMX_OSAL_WaitSites[i];
+            break;
+        }
+    }
+    if (pSite) {
+        pSite->sFile = sFile;
+        pSite->nLine = nLine;
+        pSite->nWaits++;
+        pSite->nBlockedNs += nBlockedNs;
+        pSite->nAllowedNs += (uMSec == INFINITE_WAIT) ? nBlockedNs : (OMX_U64)uMSec * 1000000;
+        if (bTimedOut)
+            pSite->nTimedOut++;
+        else if (nBlockedNs > pSite->nMaxSignaledNs)
+            pSite->nMaxSignaledNs = nBlockedNs;
+    }
+    pthread_mutex_unlock(&g_OMX_OSAL_WaitSiteMutex);
+}
+
+OMX_ERRORTYPE OMX_OSAL_EventWaitAt(OMX_IN OMX_HANDLETYPE hEvent, OMX_IN OMX_U32 mSec, OMX_OUT OMX_BOOL *pbTimedOut,
+                                   OMX_IN const char *sFile, OMX_IN OMX_U32 nLine)
+{
+    OMX_U64 nBeginNs = OMX_OSAL_GetTimeNs();
+    OMX_ERRORTYPE eError = OMX_OSAL_EventBlock(hEvent, mSec, pbTimedOut);
+
+    if (sFile && eError == OMX_ErrorNone)
+        OMX_OSAL_WaitSiteRecord(sFile, nLine, mSec, OMX_OSAL_GetTimeNs() - nBeginNs, *pbTimedOut);
+    return eError;
+}
+
+/* parenthesized so that the OMX_OSAL_EventWait macro leaves it alone */
+OMX_ERRORTYPE (OMX_OSAL_EventWait)(OMX_IN OMX_HANDLETYPE hEvent, OMX_IN OMX_U32 mSec, OMX_OUT OMX_BOOL *pbTimedOut)
+{
+    return OMX_OSAL_EventBlock(hEvent, mSec, pbTimedOut);
+}
+
+static int OMX_OSAL_WaitSiteCompare(const void *pA, const void *pB)
+{
+    OMX_U64 nA = ((const OMX_OSAL_WAITSITETYPE *)pA)->nBlockedNs;
+    OMX_U64 nB = ((const OMX_OSAL_WAITSITETYPE *)pB)->nBlockedNs;
+    return nA < nB ? 1 : (nA > nB ? -1 : 0);
+}
+
+OMX_ERRORTYPE OMX_OSAL_WaitSitesGet(OMX_OUT OMX_OSAL_WAITSITETYPE *pSites, OMX_IN OMX_U32 nMaxSites, 
+                                    OMX_OUT OMX_U32 *pnSites, OMX_IN OMX_BOOL bReset)
+{
+    OMX_OSAL_WAITSITETYPE *pAll;
+    OMX_U32 i, nSites = 0;
+
+    *pnSites = 0;
+    pAll = (OMX_OSAL_WAITSITETYPE *)OMX_OSAL_Malloc(sizeof(g_OMX_OSAL_WaitSites));
+    if (!pAll)
+        return OMX_ErrorInsufficientResources;
+    pthread_mutex_lock(&g_OMX_OSAL_WaitSiteMutex);
+    for (i = 0; i < OMX_OSAL_WAITSITES; i++) {
+        if (g_OMX_OSAL_WaitSites[i].sFile)
+            pAll[nSites++] = g_OMX_OSAL_WaitSites[i];
+    }
+    if (bReset)
+        memset(g_OMX_OSAL_WaitSites, 0, sizeof(g_OMX_OSAL_WaitSites));
+    pthread_mutex_unlock(&g_OMX_OSAL_WaitSiteMutex);
+
+    if (pSites) {
+        qsort(pAll, nSites, sizeof(OMX_OSAL_WAITSITETYPE), OMX_OSAL_WaitSiteCompare);
+        *pnSites = nSites < nMaxSites ? nSites : nMaxSites;
+        memcpy(pSites, pAll, *pnSites * sizeof(OMX_OSAL_WAITSITETYPE));
+    }
+    OMX_OSAL_Free(pAll);
+    return OMX_ErrorNone;
+}
+
+/**********************************************************************
+ * QUEUES
+ *
+ * Bounded multi-producer/multi-consumer queue of pointers, used to hand
+ * buffer headers between component callbacks and test threads. Each
+ * cell carries a sequence number that tells producers and consumers
+ * whether it is free or filled for the current lap, so push and pop are
+ * a single compare-and-swap on their own (cache line padded) index.
+ * Consumers that find the queue empty sleep on a futex that producers
+ * only wake when somebody is actually sleeping.
+ **********************************************************************/
+
+#define OMX_OSAL_CACHELINE 64
+
+typedef struct OMX_OSAL_QUEUECELLTYPE {
+    volatile OMX_U32 nSequence;
+    OMX_PTR pEntry;
+} OMX_OSAL_QUEUECELLTYPE;
+
+typedef struct OMX_OSAL_QUEUETYPE {
+    volatile OMX_U32 nEnqueuePos;
+    OMX_U8 aPad1[OMX_OSAL_CACHELINE - sizeof(OMX_U32)];
+    volatile OMX_U32 nDequeuePos;
+    OMX_U8 aPad2[OMX_OSAL_CACHELINE - sizeof(OMX_U32)];
+    volatile int nSignal;       /* bumped on every push, consumers sleep on it */
+    volatile int nSleepers;
+    OMX_U8 aPad3[OMX_OSAL_CACHELINE - 2 * sizeof(int)];
+    OMX_U32 nMask;
+    OMX_OSAL_QUEUECELLTYPE *pCells;
+} OMX_OSAL_QUEUETYPE;
+
+OMX_ERRORTYPE OMX_OSAL_QueueCreate(OMX_IN OMX_U32 nEntries, OMX_OUT OMX_HANDLETYPE *phQueue)
+{
+    OMX_OSAL_QUEUETYPE *pQueue;
+    OMX_U32 nCells = 2;
+    OMX_U32 i;
+
+    if (phQueue == NULL || nEntries == 0 || nEntries > 0x40000000)
+        return OMX_ErrorBadParameter;
+    while (nCells < nEntries)
+        nCells <<= 1;
+
+    if (posix_memalign((void **)&pQueue, OMX_OSAL_CACHELINE, sizeof(OMX_OSAL_QUEUETYPE)))
+        return OMX_ErrorInsufficientResources;
+    if (posix_memalign((void **)&pQueue->pCells, OMX_OSAL_CACHELINE, nCells * sizeof(OMX_OSAL_QUEUECELLTYPE))) {
+        free(pQueue);
+        return OMX_ErrorInsufficientResources;
+    }
+
+    memset(pQueue, 0, offsetof(OMX_OSAL_QUEUETYPE, pCells));
+    pQueue->nMask = nCells - 1;
+    for (i = 0; i < nCells; i++) {
+        pQueue->pCells[i].nSequence = i;
+        pQueue->pCells[i].pEntry = NULL;
+    }
+    *phQueue = (OMX_HANDLETYPE)pQueue;
+    return OMX_ErrorNone;
+}
+
+OMX_ERRORTYPE OMX_OSAL_QueueDestroy(OMX_IN OMX_HANDLETYPE hQueue)
+{
+    OMX_OSAL_QUEUETYPE *pQueue = (OMX_OSAL_QUEUETYPE *)hQueue;
+    if (pQueue == NULL)
+        return OMX_ErrorBadParameter;
+    free(pQueue->pCells);
+    free(pQueue);
+    return OMX_ErrorNone;
+}
+
+OMX_ERRORTYPE OMX_OSAL_QueuePush(OMX_IN OMX_HANDLETYPE hQueue, OMX_IN OMX_PTR pEntry)
+{
+    OMX_OSAL_QUEUETYPE *pQueue = (OMX_OSAL_QUEUETYPE *)hQueue;
+    OMX_OSAL_QUEUECELLTYPE *pCell;
+    OMX_U32 nPos, nSequence;
+    OMX_S32 nDiff;
+
+    if (pQueue == NULL)
+        return OMX_ErrorBadParameter;
+
+    nPos = __atomic_load_n(&pQueue->nEnqueuePos, __ATOMIC_RELAXED);
+    for (;;) {
+        pCell = &pQueue->pCells[nPos & pQueue->nMask];
+        nSequence = __atomic_load_n(&pCell->nSequence, __ATOMIC_ACQUIRE);
+        nDiff = (OMX_S32)(nSequence - nPos);
+        if (nDiff == 0) {
+            if (__atomic_compare_exchange_n(&pQueue->nEnqueuePos, &nPos, nPos + 1, OMX_TRUE,
+                                            __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+                break;
+        }
+        else if (nDiff < 0) {
+            return OMX_ErrorInsufficientResources;     /* full */
+        }
+        else {
+            nPos = __atomic_load_n(&pQueue->nEnqueuePos, __ATOMIC_RELAXED);
+        }
+    }
+    pCell->pEntry = pEntry;
+    __atomic_store_n(&pCell->nSequence, nPos + 1, __ATOMIC_RELEASE);
+
+    __atomic_add_fetch(&pQueue->nSignal, 1, __ATOMIC_SEQ_CST);
+    if (__atomic_load_n(&pQueue->nSleepers, __ATOMIC_SEQ_CST) > 0)
+        OMX_OSAL_FutexWake(&pQueue->nSignal, 1);
+    return OMX_ErrorNone;
+}
+
+static OMX_BOOL OMX_OSAL_QueueTryPop(OMX_OSAL_QUEUETYPE *pQueue, OMX_PTR *ppEntry)
+{
+    OMX_OSAL_QUEUECELLTYPE *pCell;
+    OMX_U32 nPos, nSequence;
+    OMX_S32 nDiff;
+
+    nPos = __atomic_load_n(&pQueue->nDequeuePos, __ATOMIC_RELAXED);
+    for (;;) {
+        pCell = &pQueue->pCells[nPos & pQueue->nMask];
+        nSequence = __atomic_load_n(&pCell->nSequence, __ATOMIC_ACQUIRE);
+        nDiff = (OMX_S32)(nSequence - (nPos + 1));
+        if (nDiff == 0) {
+            if (__atomic_compare_exchange_n(&pQueue->nDequeuePos, &nPos, nPos + 1, OMX_TRUE,
+                                            __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+                break;
+        }
+        else if (nDiff < 0) {
+            return OMX_FALSE;                           /* empty */
+        }
+        else {
+            nPos = __atomic_load_n(&pQueue->nDequeuePos, __ATOMIC_RELAXED);
+        }
+    }
+    *ppEntry = pCell->pEntry;
+    __atomic_store_n(&pCell->nSequence, nPos + pQueue->nMask + 1, __ATOMIC_RELEASE);
+    return OMX_TRUE;
+}
+
+OMX_ERRORTYPE OMX_OSAL_QueuePop(OMX_IN OMX_HANDLETYPE hQueue, OMX_IN OMX_U32 uMSec, OMX_OUT OMX_PTR *ppEntry)
+{
+    OMX_OSAL_QUEUETYPE *pQueue = (OMX_OSAL_QUEUETYPE *)hQueue;
+    OMX_U64 timeout_ns;
+    struct timespec timeout;
+    int nSignal;
+    int retcode;
+
+    if (pQueue == NULL || ppEntry == NULL)
+        return OMX_ErrorBadParameter;
+
+    if (OMX_OSAL_QueueTryPop(pQueue, ppEntry))
+        return OMX_ErrorNone;
+    if (uMSec == 0)
+        return OMX_ErrorTimeout;
+
+    timeout_ns = OMX_OSAL_GetTimeNs() + (OMX_U64)uMSec * 1000000;
+    timeout.tv_sec = (time_t)(timeout_ns / 1000000000);
+    timeout.tv_nsec = (long)(timeout_ns % 1000000000);
+
+    for (;;) {
+        nSignal = __atomic_load_n(&pQueue->nSignal, __ATOMIC_SEQ_CST);
+        if (OMX_OSAL_QueueTryPop(pQueue, ppEntry))
+            return OMX_ErrorNone;
+
+        __atomic_add_fetch(&pQueue->nSleepers, 1, __ATOMIC_SEQ_CST);
+        retcode = OMX_OSAL_FutexWait(&pQueue->nSignal, nSignal, 
+                                     uMSec == INFINITE_WAIT ? NULL : &timeout);
+        __atomic_sub_fetch(&pQueue->nSleepers, 1, __ATOMIC_SEQ_CST);
+
+        if (retcode == ETIMEDOUT)
+            return OMX_OSAL_QueueTryPop(pQueue, ppEntry) ? OMX_ErrorNone : OMX_ErrorTimeout;
+    }
+}
+
+OMX_ERRORTYPE OMX_OSAL_QueuePeek(OMX_IN OMX_HANDLETYPE hQueue, OMX_OUT OMX_PTR *ppEntry)
+{
+    OMX_OSAL_QUEUETYPE *pQueue = (OMX_OSAL_QUEUETYPE *)hQueue;
+    OMX_OSAL_QUEUECELLTYPE *pCell;
+    OMX_U32 nPos;
+
+    if (pQueue == NULL || ppEntry == NULL)
+        return OMX_ErrorBadParameter;
+
+    nPos = __atomic_load_n(&pQueue->nDequeuePos, __ATOMIC_ACQUIRE);
+    pCell = &pQueue->pCells[nPos & pQueue->nMask];
+    if (__atomic_load_n(&pCell->nSequence, __ATOMIC_ACQUIRE) != nPos + 1)
+        return OMX_ErrorNotReady;
+    *ppEntry = pCell->pEntry;
+    return OMX_ErrorNone;
+}
+
+OMX_U32 OMX_OSAL_QueueCount(OMX_IN OMX_HANDLETYPE hQueue)
+{
+    OMX_OSAL_QUEUETYPE *pQueue = (OMX_OSAL_QUEUETYPE *)hQueue;
+    OMX_U32 nDequeue, nEnqueue;
+
+    if (pQueue == NULL)
+        return 0;
+    nDequeue = __atomic_load_n(&pQueue->nDequeuePos, __ATOMIC_ACQUIRE);
+    nEnqueue = __atomic_load_n(&pQueue->nEnqueuePos, __ATOMIC_ACQUIRE);
+    /* a push that won its slot but is not filled yet is counted already */
+    return (OMX_S32)(nEnqueue - nDequeue) > 0 ? nEnqueue - nDequeue : 0;
+}
+
+/**********************************************************************
+ * TIME
+ **********************************************************************/
+
+/** Returns a time value in milliseconds based on a clock starting at
+ *  some arbitrary base. Given a call to GetTime that returns a value
+ *  of n a subsequent call to GetTime made m milliseconds later should 
+ *  return a value of (approximately) (n+m). This method is used, for
+ *  instance, to compute the duration of call. */
+OMX_U32 OMX_OSAL_GetTime()
+{
+    return (OMX_U32)(OMX_OSAL_GetTimeNs() / 1000000);
+}
+
+/** Returns a monotonic time value in nanoseconds. */
+OMX_U64 OMX_OSAL_GetTimeNs()
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return ((OMX_U64)now.tv_sec) * 1000000000 + (OMX_U64)now.tv_nsec;
+}
+
+/**********************************************************************
+ * PERFORMANCE COUNTERS
+ *
+ * The process counters are opened on the main thread with inherit set, 
+ * so that the threads it starts later are counted too, and are read one
+ * by one. Thread counters are opened as one group the first time a 
+ * thread reads them and come back with a single read; a key destructor
+ * closes them when the thread exits. Events the kernel refuses (no PMU 
+ * in a virtual machine, perf_event_paranoid) are left out. CPU time comes
+ * from the CPU time clocks and the remaining counters from getrusage.
+ **********************************************************************/
+
+#define OMX_OSAL_HWCOUNTERS 4   /* OMX_OSAL_COUNTERTYPE values below this come from perf */
+
+static const OMX_U64 g_OMX_OSAL_nHwCounterEvents[OMX_OSAL_HWCOUNTERS] = {
+    PERF_COUNT_HW_CPU_CYCLES,
+    PERF_COUNT_HW_INSTRUCTIONS,
+    PERF_COUNT_HW_CACHE_MISSES,
+    PERF_COUNT_HW_BRANCH_MISSES
+};
+
+typedef struct OMX_OSAL_HWCOUNTERSTYPE {
+    int nFd[OMX_OSAL_HWCOUNTERS];           /* -1 if the event was refused */
+    OMX_U32 nGroup[OMX_OSAL_HWCOUNTERS];    /* counters in the order of a group read */
+    OMX_U32 nGrouped;
+} OMX_OSAL_HWCOUNTERSTYPE;
+
+static OMX_OSAL_HWCOUNTERSTYPE g_OMX_OSAL_ProcessCounters = { { -1, -1, -1, -1 }, { 0 }, 0 };
+static OMX_BOOL g_OMX_OSAL_bHwCounters = OMX_FALSE;
+static __thread OMX_OSAL_HWCOUNTERSTYPE *g_OMX_OSAL_pThreadCounters = NULL;
+static pthread_once_t g_OMX_OSAL_CounterKeyOnce = PTHREAD_ONCE_INIT;
+static pthread_key_t g_OMX_OSAL_CounterKey;
+
+static int OMX_OSAL_PerfOpen(OMX_U64 nEvent, OMX_BOOL bInherit, int nGroupFd)
+{
+    struct perf_event_attr oAttr;
+
+    memset(&oAttr, 0, sizeof(oAttr));
+    oAttr.size = sizeof(oAttr);
+    oAttr.type = PERF_TYPE_HARDWARE;
+    oAttr.config = nEvent;
+    oAttr.exclude_kernel = 1;
+    oAttr.exclude_hv = 1;
+    oAttr.inherit = bInherit ? 1 : 0;
+    /* inherited counters cannot be read as a group */
+    oAttr.read_format = bInherit ? (PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING) : PERF_FORMAT_GROUP;
+    return (int)syscall(SYS_perf_event_open, &oAttr, 0, -1, nGroupFd, PERF_FLAG_FD_CLOEXEC);
+}
+
+static void OMX_OSAL_CountersRelease(void *pCounters)
+{
+    OMX_OSAL_HWCOUNTERSTYPE *pThread = (OMX_OSAL_HWCOUNTERSTYPE *)pCounters;
+    OMX_U32 i;
+
+    for (i = 0; i < OMX_OSAL_HWCOUNTERS; i++) {
+        if (pThread->nFd[i] >= 0)
+            close(pThread->nFd[i]);
+    }
+    OMX_OSAL_Free(pThread);
+    g_OMX_OSAL_pThreadCounters = NULL;
+}
+
+static void OMX_OSAL_CountersCreateKey()
+{
+    pthread_key_create(&g_OMX_OSAL_CounterKey, OMX_OSAL_CountersRelease);
+}
+
+static OMX_OSAL_HWCOUNTERSTYPE *OMX_OSAL_ThreadCounters()
+{
+    OMX_OSAL_HWCOUNTERSTYPE *pThread;
+    int nLeader = -1;
+    OMX_U32 i;
+
+    if (g_OMX_OSAL_pThreadCounters)
+        return g_OMX_OSAL_pThreadCounters;
+
+    pthread_once(&g_OMX_OSAL_CounterKeyOnce, OMX_OSAL_CountersCreateKey);
+    pThread = (OMX_OSAL_HWCOUNTERSTYPE *)OMX_OSAL_Malloc(sizeof(OMX_OSAL_HWCOUNTERSTYPE));
+    if (!pThread)
+        return NULL;
+    pThread->nGrouped = 0;
+    for (i = 0; i < OMX_OSAL_HWCOUNTERS; i++) {
+        pThread->nFd[i] = OMX_OSAL_PerfOpen(g_OMX_OSAL_nHwCounterEvents[i], OMX_FALSE, nLeader);
+        if (pThread->nFd[i] < 0)
+            continue;
+        if (nLeader < 0)
+            nLeader = pThread->nFd[i];
+        pThread->nGroup[pThread->nGrouped++] = i;
+    }
+    pthread_setspecific(g_OMX_OSAL_CounterKey, pThread);
+    g_OMX_OSAL_pThreadCounters = pThread;
+    return pThread;
+}
+
+OMX_ERRORTYPE OMX_OSAL_CountersOpen()
+{
+    OMX_U32 i;
+
+    if (g_OMX_OSAL_bHwCounters)
+        return OMX_ErrorNone;
+    for (i = 0; i < OMX_OSAL_HWCOUNTERS; i++) {
+        g_OMX_OSAL_ProcessCounters.nFd[i] = OMX_OSAL_PerfOpen(g_OMX_OSAL_nHwCounterEvents[i], OMX_TRUE, -1);
+        if (g_OMX_OSAL_ProcessCounters.nFd[i] >= 0)
+            g_OMX_OSAL_bHwCounters = OMX_TRUE;
+    }
+    return g_OMX_OSAL_bHwCounters ? OMX_ErrorNone : OMX_ErrorNotImplemented;
+}
+
+/* ru_maxrss never goes down, VmHWM does after OMX_OSAL_CountersResetPeak */
+static OMX_U64 OMX_OSAL_PeakRssKb(OMX_U64 nMaxRss)
+{
+    char sLine[128];
+    unsigned long long nValue;
+    FILE *pFile;
+
+    pFile = fopen("/proc/self/status", "r");
+    if (!pFile)
+        return nMaxRss;
+    while (fgets(sLine, sizeof(sLine), pFile)) {
+        if (sscanf(sLine, "VmHWM: %llu", &nValue) == 1) {
+            nMaxRss = (OMX_U64)nValue;
+            break;
+        }
+    }
+    fclose(pFile);
+    return nMaxRss;
+}
+
+OMX_ERRORTYPE OMX_OSAL_CountersResetPeak()
+{
+    ssize_t nWritten;
+    int nFd;
+
+    /* 5 resets the peak resident set size of the process */
+    nFd = open("/proc/self/clear_refs", O_WRONLY);
+    if (nFd < 0)
+        return OMX_ErrorNotImplemented;
+    nWritten = write(nFd, "5", 1);
+    close(nFd);
+    return nWritten == 1 ? OMX_ErrorNone : OMX_ErrorNotImplemented;
+}
+
+OMX_ERRORTYPE OMX_OSAL_CountersRead(OMX_IN OMX_BOOL bThread, OMX_OUT OMX_OSAL_COUNTERSTYPE *pCounters)
+{
+    OMX_OSAL_HWCOUNTERSTYPE *pThread;
+    struct rusage oUsage;
+    struct timespec oCpu;
+    OMX_U64 nValues[3 + OMX_OSAL_HWCOUNTERS];
+    OMX_U32 i;
+
+    pCounters->nValid = 0;
+    /* the CPU time clocks are exact where rusage times are sampled at ticks */
+    if (clock_gettime(bThread ? CLOCK_THREAD_CPUTIME_ID : CLOCK_PROCESS_CPUTIME_ID, &oCpu) == 0) {
+        pCounters->nValue[OMX_OSAL_CounterCpuNs] = (OMX_U64)oCpu.tv_sec * 1000000000 + (OMX_U64)oCpu.tv_nsec;
+        pCounters->nValid |= 1 << OMX_OSAL_CounterCpuNs;
+    }
+    if (getrusage(bThread ? RUSAGE_THREAD : RUSAGE_SELF, &oUsage) == 0) {
+        pCounters->nValue[OMX_OSAL_CounterVoluntarySwitches] = (OMX_U64)oUsage.ru_nvcsw;
+        pCounters->nValue[OMX_OSAL_CounterInvoluntarySwitches] = (OMX_U64)oUsage.ru_nivcsw;
+        pCounters->nValue[OMX_OSAL_CounterPageFaults] = (OMX_U64)oUsage.ru_minflt + oUsage.ru_majflt;
+        pCounters->nValid |= (1 << OMX_OSAL_CounterVoluntarySwitches) | (1 << OMX_OSAL_CounterInvoluntarySwitches) | 
+                             (1 << OMX_OSAL_CounterPageFaults);
+        /* the peak is the same for all threads */
+        if (!bThread) {
+            pCounters->nValue[OMX_OSAL_CounterPeakRssKb] = OMX_OSAL_PeakRssKb((OMX_U64)oUsage.ru_maxrss);
+            pCounters->nValid |= 1 << OMX_OSAL_CounterPeakRssKb;
+        }
+    }
+    if (!g_OMX_OSAL_bHwCounters)
+        return pCounters->nValid ? OMX_ErrorNone : OMX_ErrorUndefined;
+
+    if (bThread) {
+        pThread = OMX_OSAL_ThreadCounters();
+        if (!pThread || !pThread->nGrouped || 
+            read(pThread->nFd[pThread->nGroup[0]], nValues, sizeof(nValues)) < (ssize_t)((1 + pThread->nGrouped) * sizeof(OMX_U64)))
+            return OMX_ErrorNone;
+        for (i = 0; i < pThread->nGrouped && i < nValues[0]; i++) {
+            pCounters->nValue[pThread->nGroup[i]] = nValues[1 + i];
+            pCounters->nValid |= 1 << pThread->nGroup[i];
+        }
+        return OMX_ErrorNone;
+    }
+
+    for (i = 0; i < OMX_OSAL_HWCOUNTERS; i++) {
+        if (g_OMX_OSAL_ProcessCounters.nFd[i] < 0 || 
+            read(g_OMX_OSAL_ProcessCounters.nFd[i], nValues, 3 * sizeof(OMX_U64)) != 3 * sizeof(OMX_U64))
+            continue;
+        /* scale up counts taken while the PMU was shared with other events */
+        if (nValues[2] && nValues[2] < nValues[1])
+            nValues[0] = (OMX_U64)((double)nValues[0] * nValues[1] / nValues[2]);
+        pCounters->nValue[i] = nValues[0];
+        pCounters->nValid |= 1 << i;
+    }
+    return OMX_ErrorNone;
+}
+
+OMX_ERRORTYPE OMX_OSAL_CountersClose()
+{
+    OMX_U32 i;
+
+    for (i = 0; i < OMX_OSAL_HWCOUNTERS; i++) {
+        if (g_OMX_OSAL_ProcessCounters.nFd[i] >= 0)
+            close(g_OMX_OSAL_ProcessCounters.nFd[i]);
+        g_OMX_OSAL_ProcessCounters.nFd[i] = -1;
+    }
+    g_OMX_OSAL_bHwCounters = OMX_FALSE;
+    return OMX_ErrorNone;
+}
+
+/**************************************************************
+ * LOG FILES
+ **************************************************************/
+
+FILE *g_pLogFile=NULL;
+static FILE *g_OMX_OSAL_pEventLog = NULL;
+static pthread_mutex_t g_OMX_OSAL_LogFileMutex = PTHREAD_MUTEX_INITIALIZER;
+
+/** Open logfile. All enabled tracing will be sent to the file (in addition
+ *  to the display). */
+OMX_ERRORTYPE OMX_OSAL_OpenLogfile(OMX_IN OMX_STRING sFilename)
+{
+    FILE *pLogFile;
+
+    OMX_OSAL_CloseLogfile();
+    pLogFile = fopen(sFilename, "w");
+    pthread_mutex_lock(&g_OMX_OSAL_LogFileMutex);
+    g_pLogFile = pLogFile;
+    pthread_mutex_unlock(&g_OMX_OSAL_LogFileMutex);
+    return g_pLogFile? OMX_ErrorNone : OMX_ErrorBadParameter;
+}
+
+/** Close logfile.*/
+OMX_ERRORTYPE OMX_OSAL_CloseLogfile()
+{
+    OMX_OSAL_TraceFlush();
+    pthread_mutex_lock(&g_OMX_OSAL_LogFileMutex);
+    if (g_pLogFile){
+        fclose(g_pLogFile);
+        g_pLogFile = NULL;
+    }
+    pthread_mutex_unlock(&g_OMX_OSAL_LogFileMutex);
+    return OMX_ErrorNone;
+}
+
+/***********************************************************************
+ * TRACE
+ *
+ * With ring buffering enabled (OMX_OSAL_TraceConfigure) each thread writes
+ * its trace records into a ring of its own without taking any lock. A record
+ * keeps the format string and the raw arguments, strings are copied, and is 
+ * only formatted when a background thread drains the rings in call order.
+ * A record that does not fit a full ring is dropped and counted. Pass/fail
+ * and error messages, and messages too long for a record, drain the rings 
+ * and are written in full by the caller, so a crash does not lose them.
+ ***********************************************************************/
+
+#define OMX_OSAL_TRACE_ARGSLOTS     28
+#define OMX_OSAL_TRACE_LINEBYTES    1024
+#define OMX_OSAL_TRACE_DRAIN_MS     20
+
+#define OMX_OSAL_TRACE_NOPREFIX     0x1 /* format starts with '#' or '\n' */
+#define OMX_OSAL_TRACE_OPENLINE     0x2 /* format does not end the line */
+#define OMX_OSAL_TRACE_EMPTY        0x4 /* empty format, line state unchanged */
+#define OMX_OSAL_TRACE_TEXT         0x8 /* aArgs holds the formatted text */
+#define OMX_OSAL_TRACE_EVENT        0x10 /* aArgs holds an event log record */
+
+typedef struct OMX_OSAL_TRACERECORDTYPE {
+    OMX_U64 nSeq;
+    const char *sFormat;
+    OMX_U32 nTraceFlags;
+    OMX_U32 nFlags;
+    OMX_U64 aArgs[OMX_OSAL_TRACE_ARGSLOTS];   /* raw arguments, strings inline */
+} OMX_OSAL_TRACERECORDTYPE;
+
+typedef struct OMX_OSAL_TRACERINGTYPE {
+    struct OMX_OSAL_TRACERINGTYPE *pNext;
+    OMX_OSAL_TRACERECORDTYPE *pRecords;
+    OMX_U32 nMask;
+    OMX_U32 nThreadId;
+    OMX_BOOL bRetired;
+    OMX_U32 nHead;                            /* written by the owning thread */
+    OMX_U32 nDropped;
+    char aPad[64];
+    OMX_U32 nTail;                            /* written by the drain */
+    OMX_U32 nDroppedReported;
+    OMX_BOOL bSkipPrefix;
+    OMX_U32 nPending;
+    char sPending[OMX_OSAL_TRACE_LINEBYTES];  /* unterminated line */
+} OMX_OSAL_TRACERINGTYPE;
+
+static OMX_BOOL bSkipPrefix = OMX_FALSE;
+static OMX_BOOL g_OMX_OSAL_bTraceRings = OMX_FALSE;
+static OMX_U32 g_OMX_OSAL_nTraceRingEntries = 0;
+static OMX_U64 g_OMX_OSAL_nTraceSeq = 0;
+static OMX_OSAL_TRACERINGTYPE *g_OMX_OSAL_pTraceRings = NULL;
+static __thread OMX_OSAL_TRACERINGTYPE *g_OMX_OSAL_pTraceRing = NULL;
+static pthread_mutex_t g_OMX_OSAL_TraceRingMutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t g_OMX_OSAL_TraceDrainCond = PTHREAD_COND_INITIALIZER;
+static pthread_once_t g_OMX_OSAL_TraceKeyOnce = PTHREAD_ONCE_INIT;
+static pthread_key_t g_OMX_OSAL_TraceKey;
+static pthread_t g_OMX_OSAL_TraceDrainThread;
+static OMX_BOOL g_OMX_OSAL_bTraceDrainRunning = OMX_FALSE;
+static OMX_BOOL g_OMX_OSAL_bTraceDrainStop = OMX_FALSE;
+
+/* Called with the log file mutex held. */
+static void OMX_OSAL_TraceWrite(const char *pText, size_t nLength)
+{
+    fwrite(pText, 1, nLength, stdout);
+    if (g_pLogFile)
+        fwrite(pText, 1, nLength, g_pLogFile);
+}
+
+/* Thread exit: the ring stays registered until drained and is then handed
+   to the next thread that traces. */
+static void OMX_OSAL_TraceRetireRing(void *pRing)
+{
+    g_OMX_OSAL_pTraceRing = NULL;
+    __atomic_store_n(&((OMX_OSAL_TRACERINGTYPE *)pRing)->bRetired, OMX_TRUE, __ATOMIC_RELEASE);
+}
+
+static void OMX_OSAL_TraceCreateKey()
+{
+    pthread_key_create(&g_OMX_OSAL_TraceKey, OMX_OSAL_TraceRetireRing);
+}
+
+static OMX_OSAL_TRACERINGTYPE *OMX_OSAL_TraceGetRing()
+{
+    OMX_OSAL_TRACERINGTYPE *pRing;
+    OMX_U32 nEntries;
+
+    if (g_OMX_OSAL_pTraceRing)
+        return g_OMX_OSAL_pTraceRing;
+
+    pthread_once(&g_OMX_OSAL_TraceKeyOnce, OMX_OSAL_TraceCreateKey);
+    pthread_mutex_lock(&g_OMX_OSAL_TraceRingMutex);
+    for (pRing = g_OMX_OSAL_pTraceRings; pRing; pRing = pRing->pNext) {
+        if (__atomic_load_n(&pRing->bRetired, __ATOMIC_ACQUIRE)) 
+            break;
+    }
+    if (pRing) {
+        pRing->bRetired = OMX_FALSE;
+    } else {
+        for (nEntries = 1; nEntries < g_OMX_OSAL_nTraceRingEntries; nEntries <<= 1);
+        pRing = (OMX_OSAL_TRACERINGTYPE *)OMX_OSAL_Malloc(sizeof(OMX_OSAL_TRACERINGTYPE));
+        if (pRing) {
+            memset(pRing, 0, sizeof(OMX_OSAL_TRACERINGTYPE));
+            pRing->pRecords = (OMX_OSAL_TRACERECORDTYPE *)OMX_OSAL_Malloc(
+                nEntries * sizeof(OMX_OSAL_TRACERECORDTYPE));
+            if (!pRing->pRecords) {
+                OMX_OSAL_Free(pRing);
+                pRing = NULL;
+            } else {
+                pRing->nMask = nEntries - 1;
+                pRing->pNext = g_OMX_OSAL_pTraceRings;
+                __atomic_store_n(&g_OMX_OSAL_pTraceRings, pRing, __ATOMIC_RELEASE);
+            }
+        }
+    }
+    if (pRing) {
+        pRing->nThreadId = OMX_OSAL_ThreadId();
+        pthread_setspecific(g_OMX_OSAL_TraceKey, pRing);
+    }
+    pthread_mutex_unlock(&g_OMX_OSAL_TraceRingMutex);
+
+    g_OMX_OSAL_pTraceRing = pRing;
+    return pRing;
+}
+
+/* Steps over one conversion specification. *ppC points behind the '%' on
+   entry and behind the conversion character on return. Returns the 
+   conversion character and the argument class: 'i' int, 'l' long, 'q' long
+   long, 'd' double, 'p' pointer, 's' string, 0 unsupported. *pnStars counts
+   '*' width/precision arguments. */
+static char OMX_OSAL_TraceParseSpec(const char **ppC, char *pcClass, OMX_U32 *pnStars)
+{
+    const char *pC = *ppC;
+    char cLength = 0;
+    char cConv;
+
+    *pnStars = 0;
+    while (*pC && strchr("-+ #0'", *pC)) pC++;
+    if (*pC == '*') { (*pnStars)++; pC++; }
+    while (isdigit((unsigned char)*pC)) pC++;
+    if (*pC == '.') {
+        pC++;
+        if (*pC == '*') { (*pnStars)++; pC++; }
+        while (isdigit((unsigned char)*pC)) pC++;
+    }
+    if (*pC == 'h') {
+        pC++;
+        if (*pC == 'h') pC++;
+    } else if (*pC == 'l') {
+        cLength = 'l';
+        pC++;
+        if (*pC == 'l') { cLength = 'q'; pC++; }
+    } else if (*pC == 'z' || *pC == 't') {
+        cLength = 'l';
+        pC++;
+    } else if (*pC == 'j' || *pC == 'q') {
+        cLength = 'q';
+        pC++;
+    } else if (*pC == 'L') {
+        cLength = 'L';
+        pC++;
+    }
+
+    cConv = *pC;
+    if (cConv) pC++;
+    *ppC = pC;
+
+    if (strchr("diouxXc", cConv) && cConv)
+        *pcClass = cLength == 'L' ? 0 : (cLength ? cLength : 'i');
+    else if (strchr("eEfFgGaA", cConv) && cConv)
+        *pcClass = cLength == 'L' ? 0 : 'd';
+    else if (cConv == 'p')
+        *pcClass = 'p';
+    else if (cConv == 's')
+        *pcClass = cLength ? 0 : 's';
+    else
+        *pcClass = 0;
+    return cConv;
+}
+
+/* Copies the arguments of format into the record. Returns OMX_FALSE if the
+   format has a conversion that can not be captured raw. */
+static OMX_BOOL OMX_OSAL_TraceCapture(OMX_OSAL_TRACERECORDTYPE *pRecord, const char *format, va_list args)
+{
+    OMX_U8 *pArg = (OMX_U8 *)pRecord->aArgs;
+    OMX_U8 *pEnd = pArg + sizeof(pRecord->aArgs);
+    const char *pC = format;
+    const char *sString;
+    OMX_U32 nStars, nLength;
+    char cClass;
+
+    while ((pC = strchr(pC, '%')) != NULL) {
+        pC++;
+        if (*pC == '%') {
+            pC++;
+            continue;
+        }
+        OMX_OSAL_TraceParseSpec(&pC, &cClass, &nStars);
+        if (!cClass || pArg + (nStars + 1) * sizeof(OMX_U64) > pEnd)
+            return OMX_FALSE;
+        for (; nStars; nStars--, pArg += sizeof(OMX_U64))
+            *(OMX_S64 *)pArg = va_arg(args, int);
+
+        switch (cClass) {
+        case 'i': *(OMX_S64 *)pArg = va_arg(args, int); break;
+        case 'l': *(OMX_S64 *)pArg = va_arg(args, long); break;
+        case 'q': *(OMX_S64 *)pArg = va_arg(args, long long); break;
+        case 'd': *(double *)pArg = va_arg(args, double); break;
+        case 'p': *(void **)pArg = va_arg(args, void *); break;
+        case 's':
+            sString = va_arg(args, const char *);
+            if (!sString) sString = "(null)";
+            nLength = strlen(sString);
+            if (nLength >= (OMX_U32)(pEnd - pArg))
+                return OMX_FALSE;
+            memcpy(pArg, sString, nLength);
+            pArg[nLength] = 0;
+            pArg += (nLength + sizeof(OMX_U64)) & ~(sizeof(OMX_U64) - 1);
+            continue;
+        }
+        pArg += sizeof(OMX_U64);
+    }
+    return OMX_TRUE;
+}
+
+/* Formats a captured record into sText, returns the length written. */
+static size_t OMX_OSAL_TraceFormat(OMX_OSAL_TRACERECORDTYPE *pRecord, char *sText, size_t nSize)
+{
+    const OMX_U8 *pArg = (const OMX_U8 *)pRecord->aArgs;
+    const char *pC, *pSpec;
+    char sSpec[64];
+    size_t nLength = 0, nSpec, nArgBytes;
+    OMX_U32 nStars;
+    OMX_S64 nStar;
+    char cClass;
+    int nWritten;
+
+    if (pRecord->nFlags & OMX_OSAL_TRACE_TEXT) {
+        nLength = strlen((const char *)pArg);
+        if (nLength >= nSize) nLength = nSize - 1;
+        memcpy(sText, pArg, nLength);
+        sText[nLength] = 0;
+        return nLength;
+    }
+
+    for (pC = pRecord->sFormat; *pC && nLength < nSize - 1; ) {
+        if (*pC != '%' || pC[1] == '%') {
+            sText[nLength++] = *pC;
+            pC += (*pC == '%') ? 2 : 1;
+            continue;
+        }
+
+        /* rebuild the specification with '*' replaced by the captured value */
+        pSpec = pC++;
+        OMX_OSAL_TraceParseSpec(&pC, &cClass, &nStars);
+        for (nSpec = 0; pSpec < pC && nSpec < sizeof(sSpec) - 24; pSpec++) {
+            if (*pSpec != '*') {
+                sSpec[nSpec++] = *pSpec;
+                continue;
+            }
+            nStar = *(const OMX_S64 *)pArg;
+            pArg += sizeof(OMX_U64);
+            if (nStar < 0 && pSpec[-1] == '.') {
+                nSpec--;
+                continue;
+            }
+            nSpec += sprintf(sSpec + nSpec, "%d", (int)nStar);
+        }
+        sSpec[nSpec] = 0;
+
+        nArgBytes = sizeof(OMX_U64);
+        switch (cClass) {
+        case 'i': nWritten = snprintf(sText + nLength, nSize - nLength, sSpec, (int)*(const OMX_S64 *)pArg); break;
+        case 'l': nWritten = snprintf(sText + nLength, nSize - nLength, sSpec, (long)*(const OMX_S64 *)pArg); break;
+        case 'q': nWritten = snprintf(sText + nLength, nSize - nLength, sSpec, (long long)*(const OMX_S64 *)pArg); break;
+        case 'd': nWritten = snprintf(sText + nLength, nSize - nLength, sSpec, *(const double *)pArg); break;
+        case 'p': nWritten = snprintf(sText + nLength, nSize - nLength, sSpec, *(void * const *)pArg); break;
+        case 's': 
+            nWritten = snprintf(sText + nLength, nSize - nLength, sSpec, (const char *)pArg); 
+            nArgBytes = (strlen((const char *)pArg) + sizeof(OMX_U64)) & ~(sizeof(OMX_U64) - 1);
+            break;
+        default: nWritten = 0; break;
+        }
+        pArg += nArgBytes;
+        if (nWritten > 0)
+            nLength += ((size_t)nWritten < nSize - nLength) ? (size_t)nWritten : nSize - nLength - 1;
+    }
+    sText[nLength] = 0;
+    return nLength;
+}
+
+/* Hands complete lines of a ring to the output, the rest waits for the
+   thread to finish the line so lines of different threads do not mix.
+   Called with the log file mutex held. */
+static void OMX_OSAL_TraceEmitText(OMX_OSAL_TRACERINGTYPE *pRing, OMX_U32 nTraceFlags, OMX_U32 nFlags,
+                                   const char *pText, size_t nLength)
+{
+    char sPrefix[8];
+    size_t nPrefix = 0;
+    char *pEol;
+
+    if (!(nFlags & OMX_OSAL_TRACE_NOPREFIX) && !pRing->bSkipPrefix) {
+        OMX_OSAL_GetTracePrefix(nTraceFlags, sPrefix);
+        nPrefix = strlen(sPrefix);
+    }
+    if (!(nFlags & OMX_OSAL_TRACE_EMPTY))
+        pRing->bSkipPrefix = (nFlags & OMX_OSAL_TRACE_OPENLINE) ? OMX_TRUE : OMX_FALSE;
+
+    if (pRing->nPending + nPrefix + nLength >= sizeof(pRing->sPending)) {
+        OMX_OSAL_TraceWrite(pRing->sPending, pRing->nPending);
+        pRing->nPending = 0;
+        if (nPrefix + nLength >= sizeof(pRing->sPending)) {
+            OMX_OSAL_TraceWrite(sPrefix, nPrefix);
+            OMX_OSAL_TraceWrite(pText, nLength);
+            return;
+        }
+    }
+    memcpy(pRing->sPending + pRing->nPending, sPrefix, nPrefix);
+    memcpy(pRing->sPending + pRing->nPending + nPrefix, pText, nLength);
+    pRing->nPending += nPrefix + nLength;
+
+    for (pEol = pRing->sPending + pRing->nPending; pEol > pRing->sPending && pEol[-1] != '\n'; pEol--);
+    if (pEol > pRing->sPending) {
+        nLength = pEol - pRing->sPending;
+        OMX_OSAL_TraceWrite(pRing->sPending, nLength);
+        pRing->nPending -= nLength;
+        memmove(pRing->sPending, pEol, pRing->nPending);
+    }
+}
+
+/* Called with the log file mutex held. */
+static void OMX_OSAL_TraceEmit(OMX_OSAL_TRACERINGTYPE *pRing, OMX_OSAL_TRACERECORDTYPE *pRecord)
+{
+    char sText[OMX_OSAL_TRACE_LINEBYTES];
+
+    if (pRecord->nFlags & OMX_OSAL_TRACE_EVENT) {
+        if (g_OMX_OSAL_pEventLog)
+            fwrite(pRecord->aArgs, sizeof(OMX_OSAL_EVENTLOGRECORDTYPE), 1, g_OMX_OSAL_pEventLog);
+        return;
+    }
+    OMX_OSAL_TraceEmitText(pRing, pRecord->nTraceFlags, pRecord->nFlags, sText, 
+                           OMX_OSAL_TraceFormat(pRecord, sText, sizeof(sText)));
+}
+
+/* Drains all rings, oldest record first. */
+static void OMX_OSAL_TraceDrain()
+{
+    OMX_OSAL_TRACERINGTYPE *pRing, *pOldest;
+    OMX_U64 nOldest;
+    OMX_U32 nDropped;
+    OMX_BOOL bWritten = OMX_FALSE;
+    char sDropped[96];
+
+    pthread_mutex_lock(&g_OMX_OSAL_LogFileMutex);
+    for (;;) {
+        pOldest = NULL;
+        nOldest = 0;
+        for (pRing = __atomic_load_n(&g_OMX_OSAL_pTraceRings, __ATOMIC_ACQUIRE); pRing; pRing = pRing->pNext) {
+            if (pRing->nTail == __atomic_load_n(&pRing->nHead, __ATOMIC_ACQUIRE))
+                continue;
+            if (!pOldest || pRing->pRecords[pRing->nTail & pRing->nMask].nSeq < nOldest) {
+                pOldest = pRing;
+                nOldest = pRing->pRecords[pRing->nTail & pRing->nMask].nSeq;
+            }
+        }
+        if (!pOldest)
+            break;
+        OMX_OSAL_TraceEmit(pOldest, &pOldest->pRecords[pOldest->nTail & pOldest->nMask]);
+        __atomic_store_n(&pOldest->nTail, pOldest->nTail + 1, __ATOMIC_RELEASE);
+        bWritten = OMX_TRUE;
+    }
+    for (pRing = g_OMX_OSAL_pTraceRings; pRing; pRing = pRing->pNext) {
+        nDropped = __atomic_load_n(&pRing->nDropped, __ATOMIC_RELAXED);
+        if (nDropped != pRing->nDroppedReported) {
+            OMX_OSAL_TraceWrite(sDropped, sprintf(sDropped, "%s[thread %u dropped %u trace messages, ring full]\n",
+                pRing->nPending ? "\n" : "", pRing->nThreadId, nDropped - pRing->nDroppedReported));
+            pRing->nDroppedReported = nDropped;
+            bWritten = OMX_TRUE;
+        }
+    }
+    if (bWritten) {
+        fflush(stdout);
+        if (g_pLogFile)
+            fflush(g_pLogFile);
+        if (g_OMX_OSAL_pEventLog)
+            fflush(g_OMX_OSAL_pEventLog);
+    }
+    pthread_mutex_unlock(&g_OMX_OSAL_LogFileMutex);
+}
+
+static void *OMX_OSAL_TraceDrainFunc(void *pParameter)
+{
+    struct timespec oDeadline;
+
+    UNUSED_PARAMETER(pParameter);
+    pthread_mutex_lock(&g_OMX_OSAL_TraceRingMutex);
+    while (!g_OMX_OSAL_bTraceDrainStop) {
+        pthread_mutex_unlock(&g_OMX_OSAL_TraceRingMutex);
+        OMX_OSAL_TraceDrain();
+        pthread_mutex_lock(&g_OMX_OSAL_TraceRingMutex);
+        if (g_OMX_OSAL_bTraceDrainStop)
+            break;
+        clock_gettime(CLOCK_REALTIME, &oDeadline);
+        oDeadline.tv_nsec += OMX_OSAL_TRACE_DRAIN_MS * 1000000;
+        if (oDeadline.tv_nsec >= 1000000000) {
+            oDeadline.tv_sec++;
+            oDeadline.tv_nsec -= 1000000000;
+        }
+        pthread_cond_timedwait(&g_OMX_OSAL_TraceDrainCond, &g_OMX_OSAL_TraceRingMutex, &oDeadline);
+    }
+    pthread_mutex_unlock(&g_OMX_OSAL_TraceRingMutex);
+    OMX_OSAL_TraceDrain();
+    return NULL;
+}
+
+/* Returns the next free record of the calling thread's ring, or NULL if the
+   ring is full and the record is dropped. */
+static OMX_OSAL_TRACERECORDTYPE *OMX_OSAL_TraceReserve(OMX_OSAL_TRACERINGTYPE *pRing)
+{
+    OMX_U32 nUsed = pRing->nHead - __atomic_load_n(&pRing->nTail, __ATOMIC_ACQUIRE);
+
+    if (nUsed > pRing->nMask) {
+        __atomic_store_n(&pRing->nDropped, pRing->nDropped + 1, __ATOMIC_RELAXED);
+        return NULL;
+    }
+    return &pRing->pRecords[pRing->nHead & pRing->nMask];
+}
+
+/* Publishes the record returned by OMX_OSAL_TraceReserve. */
+static void OMX_OSAL_TraceCommit(OMX_OSAL_TRACERINGTYPE *pRing)
+{
+    OMX_U32 nHead = pRing->nHead;
+
+    pRing->pRecords[nHead & pRing->nMask].nSeq = __atomic_fetch_add(&g_OMX_OSAL_nTraceSeq, 1, __ATOMIC_RELAXED);
+    __atomic_store_n(&pRing->nHead, nHead + 1, __ATOMIC_RELEASE);
+
+    /* wake the drain early rather than drop */
+    if (nHead - __atomic_load_n(&pRing->nTail, __ATOMIC_RELAXED) == (pRing->nMask + 1) / 2)
+        pthread_cond_signal(&g_OMX_OSAL_TraceDrainCond);
+}
+
+/** Configure trace buffering. With nRingEntries > 0 each thread queues its
+ *  trace messages into a lock free ring of that many records, written out by
+ *  a background thread; 0 makes every trace call write synchronously. Rings 
+ *  already created keep their size. */
+OMX_ERRORTYPE OMX_OSAL_TraceConfigure(OMX_IN OMX_U32 nRingEntries)
+{
+    OMX_BOOL bStop = OMX_FALSE;
+
+    pthread_mutex_lock(&g_OMX_OSAL_TraceRingMutex);
+    g_OMX_OSAL_nTraceRingEntries = nRingEntries;
+    if (nRingEntries && !g_OMX_OSAL_bTraceDrainRunning) {
+        g_OMX_OSAL_bTraceDrainStop = OMX_FALSE;
+        if (pthread_create(&g_OMX_OSAL_TraceDrainThread, NULL, OMX_OSAL_TraceDrainFunc, NULL)) {
+            pthread_mutex_unlock(&g_OMX_OSAL_TraceRingMutex);
+            return OMX_ErrorInsufficientResources;
+        }
+        g_OMX_OSAL_bTraceDrainRunning = OMX_TRUE;
+    } else if (!nRingEntries && g_OMX_OSAL_bTraceDrainRunning) {
+        g_OMX_OSAL_bTraceDrainStop = bStop = OMX_TRUE;
+        g_OMX_OSAL_bTraceDrainRunning = OMX_FALSE;
+        pthread_cond_signal(&g_OMX_OSAL_TraceDrainCond);
+    }
+    __atomic_store_n(&g_OMX_OSAL_bTraceRings, nRingEntries ? OMX_TRUE : OMX_FALSE, __ATOMIC_RELEASE);
+    pthread_mutex_unlock(&g_OMX_OSAL_TraceRingMutex);
+
+    if (bStop)
+        pthread_join(g_OMX_OSAL_TraceDrainThread, NULL);
+    return OMX_ErrorNone;
+}
+
+/** Write out all buffered trace messages before returning. */
+OMX_ERRORTYPE OMX_OSAL_TraceFlush()
+{
+    if (__atomic_load_n(&g_OMX_OSAL_pTraceRings, __ATOMIC_ACQUIRE))
+        OMX_OSAL_TraceDrain();
+    return OMX_ErrorNone;
+}
+
+/** Output a trace message */
+OMX_ERRORTYPE OMX_OSAL_Trace(OMX_IN OMX_U32 nTraceFlags, OMX_IN char *format, ...)
+{
+    OMX_OSAL_TRACERINGTYPE *pRing;
+    OMX_OSAL_TRACERECORDTYPE *pRecord;
+    char szPrefix[5];
+    char sText[OMX_OSAL_TRACE_LINEBYTES];
+    char *pText;
+    va_list args, argsCopy;
+    size_t nLength;
+    OMX_U32 nFlags;
+    OMX_BOOL bSync;
+    int nWritten;
+
+    if (!(g_OMX_OSAL_TraceFlags & nTraceFlags))
+        return OMX_ErrorNone;
+
+    bSync = (nTraceFlags & (OMX_OSAL_TRACE_PASSFAIL | OMX_OSAL_TRACE_ERROR)) ? OMX_TRUE : OMX_FALSE;
+    if (__atomic_load_n(&g_OMX_OSAL_bTraceRings, __ATOMIC_ACQUIRE) && (pRing = OMX_OSAL_TraceGetRing()) != NULL)
+    {
+        nLength = strlen(format);
+        nFlags = (format[0] == '#' || format[0] == '\n') ? OMX_OSAL_TRACE_NOPREFIX : 0;
+        if (!nLength)
+            nFlags |= OMX_OSAL_TRACE_EMPTY;
+        else if (format[nLength - 1] != '\n')
+            nFlags |= OMX_OSAL_TRACE_OPENLINE;
+
+        if (!bSync) {
+            pRecord = OMX_OSAL_TraceReserve(pRing);
+            if (!pRecord)
+                return OMX_ErrorNone;
+            pRecord->sFormat = format;
+            pRecord->nTraceFlags = nTraceFlags;
+            pRecord->nFlags = nFlags;
+
+            va_start(args, format);
+            if (!OMX_OSAL_TraceCapture(pRecord, format, args)) {
+                /* too many or unusual arguments, format it here instead */
+                va_end(args);
+                va_start(args, format);
+                nWritten = vsnprintf((char *)pRecord->aArgs, sizeof(pRecord->aArgs), format, args);
+                pRecord->nFlags |= OMX_OSAL_TRACE_TEXT;
+                bSync = (nWritten < 0 || (size_t)nWritten >= sizeof(pRecord->aArgs)) ? OMX_TRUE : OMX_FALSE;
+            }
+            va_end(args);
+            if (!bSync) {
+                OMX_OSAL_TraceCommit(pRing);
+                return OMX_ErrorNone;
+            }
+        }
+
+        /* written here in full, after what the rings hold, with the line state of the ring */
+        OMX_OSAL_TraceDrain();
+        va_start(args, format);
+        va_copy(argsCopy, args);
+        pText = sText;
+        nWritten = vsnprintf(sText, sizeof(sText), format, args);
+        if (nWritten >= (int)sizeof(sText) && (pText = (char *)malloc((size_t)nWritten + 1)) != NULL)
+            vsnprintf(pText, (size_t)nWritten + 1, format, argsCopy);
+        va_end(argsCopy);
+        va_end(args);
+        if (!pText)
+            pText = sText;
+        nLength = nWritten < 0 ? 0 : strlen(pText);
+
+        pthread_mutex_lock(&g_OMX_OSAL_LogFileMutex);
+        OMX_OSAL_TraceEmitText(pRing, nTraceFlags, nFlags, pText, nLength);
+        fflush(stdout);
+        if (g_pLogFile)
+            fflush(g_pLogFile);
+        pthread_mutex_unlock(&g_OMX_OSAL_LogFileMutex);
+        if (pText != sText)
+            free(pText);
+        return OMX_ErrorNone;
+    }
+
+    /* records still queued from ring buffering go out first */
+    OMX_OSAL_TraceFlush();
+
+    if (g_OMX_CONF_hTraceMutex) OMX_OSAL_MutexLock(g_OMX_CONF_hTraceMutex);
+    pthread_mutex_lock(&g_OMX_OSAL_LogFileMutex);
+
+    if (format[0]!='#' && format[0]!='\n' && !bSkipPrefix)
+    {
+        /* emit trace prefix */
+        OMX_OSAL_GetTracePrefix(nTraceFlags,szPrefix);
+        fputs(szPrefix, stdout);
+        if (g_pLogFile){
+            fputs(szPrefix, g_pLogFile);
+        }
+    }
+
+    /* emit trace */
+    va_start(args, format);
+    va_copy(argsCopy, args);
+    vprintf(format, args);
+    if (g_pLogFile){
+        vfprintf(g_pLogFile,format, argsCopy);
+    }
+    va_end(argsCopy);
+    va_end(args);
+
+    /* skip prefix on next output if this is no the end of line */
+    if (format[0] != 0)
+        bSkipPrefix = (format[strlen(format)-1]  != '\n');
+    if (bSync) {
+        fflush(stdout);
+        if (g_pLogFile)
+            fflush(g_pLogFile);
+    }
+
+    pthread_mutex_unlock(&g_OMX_OSAL_LogFileMutex);
+    if (g_OMX_CONF_hTraceMutex) OMX_OSAL_MutexUnlock(g_OMX_CONF_hTraceMutex);
+
+    return OMX_ErrorNone;       
+}
+
+/***********************************************************************
+ * EVENT LOG
+ ***********************************************************************/
+
+#define OMX_OSAL_EVENTLOG_MAXNAMES  1024
+#define OMX_OSAL_EVENTLOG_MAXNAMELENGTH 1024  /* longer names are not logged, and mark a log corrupt */
+
+static OMX_STRING g_OMX_OSAL_sEventLogNames[OMX_OSAL_EVENTLOG_MAXNAMES];
+static OMX_U32 g_OMX_OSAL_nEventLogNames = 0;
+
+/* Called with the log file mutex held. */
+static void OMX_OSAL_EventLogWriteName(OMX_U16 nNameId)
+{
+    OMX_OSAL_EVENTLOGRECORDTYPE oRecord;
+    OMX_STRING sName = g_OMX_OSAL_sEventLogNames[nNameId - 1];
+    OMX_U64 nPad = 0;
+
+    memset(&oRecord, 0, sizeof(oRecord));
+    oRecord.nKind = OMX_OSAL_EVENTLOG_NAME;
+    oRecord.nNameId = nNameId;
+    oRecord.nResult = (OMX_U32)strlen(sName);
+    fwrite(&oRecord, sizeof(oRecord), 1, g_OMX_OSAL_pEventLog);
+    fwrite(sName, 1, oRecord.nResult, g_OMX_OSAL_pEventLog);
+    fwrite(&nPad, 1, (8 - (oRecord.nResult & 7)) & 7, g_OMX_OSAL_pEventLog);
+}
+
+OMX_ERRORTYPE OMX_OSAL_EventLogOpen(OMX_IN OMX_STRING sFilename)
+{
+    OMX_OSAL_EVENTLOGHEADERTYPE oHeader;
+    FILE *pEventLog;
+    OMX_U32 i;
+
+    OMX_OSAL_EventLogClose();
+    pEventLog = fopen(sFilename, "wb");
+    if (!pEventLog)
+        return OMX_ErrorBadParameter;
+
+    oHeader.nMagic = OMX_OSAL_EVENTLOG_MAGIC;
+    oHeader.nVersion = OMX_OSAL_EVENTLOG_VERSION;
+    fwrite(&oHeader, sizeof(oHeader), 1, pEventLog);
+
+    pthread_mutex_lock(&g_OMX_OSAL_LogFileMutex);
+    g_OMX_OSAL_pEventLog = pEventLog;
+    for (i = 0; i < g_OMX_OSAL_nEventLogNames; i++)
+        OMX_OSAL_EventLogWriteName((OMX_U16)(i + 1));
+    pthread_mutex_unlock(&g_OMX_OSAL_LogFileMutex);
+    return OMX_ErrorNone;
+}
+
+OMX_ERRORTYPE OMX_OSAL_EventLogClose()
+{
+    OMX_ERRORTYPE eError = OMX_ErrorNone;
+
+    OMX_OSAL_TraceFlush();
+    pthread_mutex_lock(&g_OMX_OSAL_LogFileMutex);
+    if (g_OMX_OSAL_pEventLog) {
+        if (ferror(g_OMX_OSAL_pEventLog) | fclose(g_OMX_OSAL_pEventLog))
+            eError = OMX_ErrorHardware;
+        __atomic_store_n(&g_OMX_OSAL_pEventLog, NULL, __ATOMIC_RELEASE);
+    }
+    pthread_mutex_unlock(&g_OMX_OSAL_LogFileMutex);
+    return eError;
+}
+
+OMX_BOOL OMX_OSAL_EventLogActive()
+{
+    return __atomic_load_n(&g_OMX_OSAL_pEventLog, __ATOMIC_ACQUIRE) ? OMX_TRUE : OMX_FALSE;
+}
+
+OMX_U16 OMX_OSAL_EventLogName(OMX_IN OMX_STRING sName)
+{
+    OMX_U16 nNameId = 0;
+    OMX_U32 i;
+
+    pthread_mutex_lock(&g_OMX_OSAL_LogFileMutex);
+    for (i = 0; i < g_OMX_OSAL_nEventLogNames && !nNameId; i++) {
+        if (!strcmp(g_OMX_OSAL_sEventLogNames[i], sName))
+            nNameId = (OMX_U16)(i + 1);
+    }
+    if (!nNameId && g_OMX_OSAL_nEventLogNames < OMX_OSAL_EVENTLOG_MAXNAMES && strlen(sName) <= OMX_OSAL_EVENTLOG_MAXNAMELENGTH
+        && (g_OMX_OSAL_sEventLogNames[g_OMX_OSAL_nEventLogNames] = strdup(sName)) != NULL) {
+        nNameId = (OMX_U16)++g_OMX_OSAL_nEventLogNames;
+        if (g_OMX_OSAL_pEventLog)
+            OMX_OSAL_EventLogWriteName(nNameId);
+    }
+    pthread_mutex_unlock(&g_OMX_OSAL_LogFileMutex);
+    return nNameId;
+}
+
+void OMX_OSAL_EventLogCall(OMX_IN OMX_U16 nNameId, OMX_IN OMX_U16 nApiId, OMX_IN OMX_U16 nFlags,
+                           OMX_IN OMX_U64 nBeginNs, OMX_IN OMX_U64 nEndNs, 
+                           OMX_IN OMX_PTR pBuffer, OMX_IN OMX_U32 nResult)
+{
+    OMX_OSAL_EVENTLOGRECORDTYPE oRecord, *pEvent = &oRecord;
+    OMX_OSAL_TRACERINGTYPE *pRing = NULL;
+    OMX_OSAL_TRACERECORDTYPE *pRecord = NULL;
+
+    if (!__atomic_load_n(&g_OMX_OSAL_pEventLog, __ATOMIC_ACQUIRE))
+        return;
+
+    /* queue behind the thread's trace messages when rings are in use */
+    if (__atomic_load_n(&g_OMX_OSAL_bTraceRings, __ATOMIC_ACQUIRE) && (pRing = OMX_OSAL_TraceGetRing()) != NULL) {
+        if ((pRecord = OMX_OSAL_TraceReserve(pRing)) == NULL)
+            return;
+        pRecord->nFlags = OMX_OSAL_TRACE_EVENT;
+        pEvent = (OMX_OSAL_EVENTLOGRECORDTYPE *)pRecord->aArgs;
+    }
+
+    pEvent->nKind = OMX_OSAL_EVENTLOG_CALL;
+    pEvent->nNameId = nNameId;
+    pEvent->nApiId = nApiId;
+    pEvent->nFlags = nFlags;
+    pEvent->nThreadId = (OMX_U32)OMX_OSAL_ThreadId();
+    pEvent->nResult = nResult;
+    pEvent->nBeginNs = nBeginNs;
+    pEvent->nEndNs = nEndNs;
+    pEvent->nBuffer = (OMX_U64)(uintptr_t)pBuffer;
+
+    if (pRecord) {
+        OMX_OSAL_TraceCommit(pRing);
+    } else {
+        pthread_mutex_lock(&g_OMX_OSAL_LogFileMutex);
+        if (g_OMX_OSAL_pEventLog)
+            fwrite(pEvent, sizeof(*pEvent), 1, g_OMX_OSAL_pEventLog);
+        pthread_mutex_unlock(&g_OMX_OSAL_LogFileMutex);
+    }
+}
+
+void OMX_OSAL_EventLogCallData(OMX_IN OMX_U16 nNameId, OMX_IN OMX_U16 nApiId, OMX_IN OMX_U16 nFlags,
+                               OMX_IN OMX_U64 nBeginNs, OMX_IN OMX_U64 nEndNs, 
+                               OMX_IN OMX_PTR pBuffer, OMX_IN OMX_U32 nResult,
+                               OMX_IN OMX_PTR pData, OMX_IN OMX_U32 nDataBytes)
+{
+    OMX_OSAL_EVENTLOGRECORDTYPE oRecords[2];
+    OMX_U64 nPad = 0;
+
+    if (!__atomic_load_n(&g_OMX_OSAL_pEventLog, __ATOMIC_ACQUIRE))
+        return;
+
+    memset(oRecords, 0, sizeof(oRecords));
+    oRecords[0].nKind = OMX_OSAL_EVENTLOG_CALL;
+    oRecords[0].nNameId = nNameId;
+    oRecords[0].nApiId = nApiId;
+    oRecords[0].nFlags = nFlags | OMX_OSAL_EVENTLOG_HASDATA;
+    oRecords[0].nThreadId = (OMX_U32)OMX_OSAL_ThreadId();
+    oRecords[0].nResult = nResult;
+    oRecords[0].nBeginNs = nBeginNs;
+    oRecords[0].nEndNs = nEndNs;
+    oRecords[0].nBuffer = (OMX_U64)(uintptr_t)pBuffer;
+    oRecords[1].nKind = OMX_OSAL_EVENTLOG_DATA;
+    oRecords[1].nNameId = nNameId;
+    oRecords[1].nApiId = nApiId;
+    oRecords[1].nResult = nDataBytes;
+
+    /* both records go out under one lock so the data follows its call */
+    pthread_mutex_lock(&g_OMX_OSAL_LogFileMutex);
+    if (g_OMX_OSAL_pEventLog) {
+        fwrite(oRecords, sizeof(oRecords), 1, g_OMX_OSAL_pEventLog);
+        fwrite(pData, 1, nDataBytes, g_OMX_OSAL_pEventLog);
+        fwrite(&nPad, 1, (8 - (nDataBytes & 7)) & 7, g_OMX_OSAL_pEventLog);
+    }
+    pthread_mutex_unlock(&g_OMX_OSAL_LogFileMutex);
+}
+
+/* Read and check the header of an event log. Version 1 logs have no data records. */
+static OMX_BOOL OMX_OSAL_EventLogHeader(FILE *pLog)
+{
+    OMX_OSAL_EVENTLOGHEADERTYPE oHeader;
+
+    return (fread(&oHeader, sizeof(oHeader), 1, pLog) == 1 && oHeader.nMagic == OMX_OSAL_EVENTLOG_MAGIC
+            && oHeader.nVersion >= 1 && oHeader.nVersion <= OMX_OSAL_EVENTLOG_VERSION) ? OMX_TRUE : OMX_FALSE;
+}
+
+OMX_ERRORTYPE OMX_OSAL_EventLogLoad(OMX_IN OMX_STRING sFilename, OMX_OUT OMX_U8 **ppLog, OMX_OUT OMX_U32 *pnBytes)
+{
+    FILE *pLog;
+    long nSize;
+    OMX_U8 *pData = NULL;
+    OMX_ERRORTYPE eError = OMX_ErrorNone;
+
+    *ppLog = NULL;
+    *pnBytes = 0;
+    pLog = fopen(sFilename, "rb");
+    if (!pLog) {
+        OMX_OSAL_Trace(OMX_OSAL_TRACE_ERROR, "Failed to open event log %s\n", sFilename);
+        return OMX_ErrorBadParameter;
+    }
+    if (!OMX_OSAL_EventLogHeader(pLog)) {
+        OMX_OSAL_Trace(OMX_OSAL_TRACE_ERROR, "%s is not an event log\n", sFilename);
+        eError = OMX_ErrorBadParameter;
+    } else if (fseek(pLog, 0, SEEK_END) || (nSize = ftell(pLog)) < 0 || fseek(pLog, 0, SEEK_SET)) {
+        eError = OMX_ErrorHardware;
+    } else if ((pData = (OMX_U8 *)OMX_OSAL_Malloc((OMX_U32)nSize)) == NULL) {
+        eError = OMX_ErrorInsufficientResources;
+    } else if (fread(pData, 1, (size_t)nSize, pLog) != (size_t)nSize) {
+        OMX_OSAL_Free(pData);
+        eError = OMX_ErrorHardware;
+    } else {
+        *ppLog = pData;
+        *pnBytes = (OMX_U32)nSize;
+    }
+    fclose(pLog);
+    return eError;
+}
+
+static void OMX_OSAL_JsonString(FILE *pFile, const char *sValue)
+{
+    fputc('"', pFile);
+    for (; *sValue; sValue++) {
+        if (*sValue == '"' || *sValue == '\\')
+            fputc('\\', pFile);
+        if ((unsigned char)*sValue >= ' ')
+            fputc(*sValue, pFile);
+    }
+    fputc('"', pFile);
+}
+
+OMX_ERRORTYPE OMX_OSAL_ConvertEventLog(OMX_IN OMX_STRING sLogName, OMX_IN OMX_STRING sJsonName)
+{
+    OMX_OSAL_EVENTLOGRECORDTYPE oRecord;
+    OMX_STRING sNames[OMX_OSAL_EVENTLOG_MAXNAMES + 1];
+    OMX_ERRORTYPE eError = OMX_ErrorNone;
+    FILE *pLog, *pJson = NULL;
+    OMX_U64 nBase = (OMX_U64)-1, nEvents = 0;
+    OMX_U32 nPadded, nPass, i;
+    char sResult[256];
+
+    memset(sNames, 0, sizeof(sNames));
+    pLog = fopen(sLogName, "rb");
+    if (!pLog) {
+        OMX_OSAL_Trace(OMX_OSAL_TRACE_ERROR, "Failed to open event log %s\n", sLogName);
+        return OMX_ErrorBadParameter;
+    }
+    if (!OMX_OSAL_EventLogHeader(pLog)) {
+        OMX_OSAL_Trace(OMX_OSAL_TRACE_ERROR, "%s is not an event log\n", sLogName);
+        fclose(pLog);
+        return OMX_ErrorBadParameter;
+    }
+
+    /* the first pass collects names and the time base, the second writes events */
+    for (nPass = 0; nPass < 2 && eError == OMX_ErrorNone; nPass++) {
+        fseek(pLog, sizeof(OMX_OSAL_EVENTLOGHEADERTYPE), SEEK_SET);
+        if (nPass == 1) {
+            if ((pJson = fopen(sJsonName, "w")) == NULL) {
+                OMX_OSAL_Trace(OMX_OSAL_TRACE_ERROR, "Failed to open %s\n", sJsonName);
+                eError = OMX_ErrorBadParameter;
+                break;
+            }
+            fprintf(pJson, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n");
+        }
+        while (fread(&oRecord, sizeof(oRecord), 1, pLog) == 1) {
+            if (oRecord.nKind == OMX_OSAL_EVENTLOG_NAME) {
+                if (oRecord.nResult > OMX_OSAL_EVENTLOG_MAXNAMELENGTH)
+                    break;
+                nPadded = (oRecord.nResult + 7) & ~7;
+                if (nPass == 0 && oRecord.nNameId && oRecord.nNameId <= OMX_OSAL_EVENTLOG_MAXNAMES 
+                    && !sNames[oRecord.nNameId] && (sNames[oRecord.nNameId] = (OMX_STRING)calloc(1, nPadded + 1)) != NULL) {
+                    if (fread(sNames[oRecord.nNameId], 1, nPadded, pLog) != nPadded)
+                        break;
+                    sNames[oRecord.nNameId][oRecord.nResult] = 0;
+                } else {
+                    fseek(pLog, nPadded, SEEK_CUR);
+                }
+                continue;
+            }
+            if (oRecord.nKind == OMX_OSAL_EVENTLOG_DATA) {
+                fseek(pLog, (oRecord.nResult + 7) & ~7, SEEK_CUR);
+                continue;
+            }
+            if (oRecord.nKind != OMX_OSAL_EVENTLOG_CALL)
+                break;
+            if (nPass == 0) {
+                if (oRecord.nBeginNs < nBase) nBase = oRecord.nBeginNs;
+                continue;
+            }
+
+            if (OMX_ErrorNone != OMX_CONF_ErrorToString((OMX_ERRORTYPE)oRecord.nResult, sResult))
+                sprintf(sResult, "0x%08x", oRecord.nResult);
+            fprintf(pJson, "%s{\"name\":", nEvents++ ? ",\n" : "");
+            OMX_OSAL_JsonString(pJson, sNames[oRecord.nApiId] ? sNames[oRecord.nApiId] : "?");
+            fprintf(pJson, ",\"cat\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%llu.%03u,\"dur\":%llu.%03u,\"args\":{\"component\":",
+                (oRecord.nFlags & OMX_OSAL_EVENTLOG_TEST) ? "test" : (oRecord.nFlags & OMX_OSAL_EVENTLOG_CALLBACK) ? "callback" : "component", oRecord.nThreadId,
+                (unsigned long long)((oRecord.nBeginNs - nBase) / 1000), (unsigned)((oRecord.nBeginNs - nBase) % 1000),
+                (unsigned long long)((oRecord.nEndNs - oRecord.nBeginNs) / 1000), (unsigned)((oRecord.nEndNs - oRecord.nBeginNs) % 1000));
+            OMX_OSAL_JsonString(pJson, sNames[oRecord.nNameId] ? sNames[oRecord.nNameId] : "?");
+            fprintf(pJson, ",\"buffer\":\"0x%llx\",\"result\":\"%s\"}}", (unsigned long long)oRecord.nBuffer, sResult);
+        }
+    }
+
+    if (pJson) {
+        fprintf(pJson, "\n]}\n");
+        if (ferror(pJson) | fclose(pJson))
+            eError = OMX_ErrorHardware;
+        OMX_OSAL_Trace(OMX_OSAL_TRACE_INFO, "Wrote %llu events to %s\n", (unsigned long long)nEvents, sJsonName);
+    }
+    fclose(pLog);
+    for (i = 0; i <= OMX_OSAL_EVENTLOG_MAXNAMES; i++)
+        free(sNames[i]);
+    return eError;
+}
+
+/**********************************************************************
+ * PROCESSES
+ *
+ * Children are forked while the caller holds the log file and thread 
+ * pool mutexes, so that neither the trace drain nor a pool worker is 
+ * half way through an update the child would inherit. The child gets 
+ * fresh counters, no pool workers and no log files, and traces without
+ * rings to a line buffered stdout, so that a child which crashes has 
+ * written everything up to the crash. Its stdout and stderr go to an 
+ * unlinked temporary file the parent copies to the trace output 
+ * afterwards. The return value and the reply, if any, come back over a 
+ * pipe whose end of file also tells the parent that a child died.
+ **********************************************************************/
+
+#define OMX_OSAL_PROCESS_MAXWAIT 64     /* children one OMX_OSAL_ProcessWait can wait for */
+
+typedef struct OMX_OSAL_PROCESSTYPE {
+    pid_t nPid;
+    int nResultFd;      /* read end of the pipe the return value comes over */
+    int nOutputFd;      /* stdout and stderr of the child */
+} OMX_OSAL_PROCESSTYPE;
+
+/* what a child writes to the pipe as it returns, followed by the reply */
+typedef struct OMX_OSAL_PROCESSRESULTTYPE {
+    OMX_U32 uReturn;
+    OMX_U32 nReplyBytes;
+} OMX_OSAL_PROCESSRESULTTYPE;
+
+/* in a child only */
+static OMX_BOOL g_OMX_OSAL_bProcessChild = OMX_FALSE;
+static OMX_U8 *g_OMX_OSAL_pProcessReply = NULL;
+static OMX_U32 g_OMX_OSAL_nProcessReplyBytes = 0;
+
+static OMX_BOOL OMX_OSAL_ProcessTransfer(int nFd, OMX_U8 *pData, size_t nBytes, OMX_BOOL bWrite)
+{
+    ssize_t nDone;
+
+    while (nBytes) {
+        nDone = bWrite ? write(nFd, pData, nBytes) : read(nFd, pData, nBytes);
+        if (nDone < 0 && errno == EINTR)
+            continue;
+        if (nDone <= 0)
+            return OMX_FALSE;
+        pData += nDone;
+        nBytes -= (size_t)nDone;
+    }
+    return OMX_TRUE;
+}
+
+/* Runs in the child, on the copy of the thread that called OMX_OSAL_ProcessStart. */
+static void OMX_OSAL_ProcessChildInit()
+{
+    g_OMX_OSAL_bProcessChild = OMX_TRUE;
+    g_OMX_OSAL_pProcessReply = NULL;
+    g_OMX_OSAL_nProcessReplyBytes = 0;
+    /* the only thread of the child has a tid of its own */
+    g_OMX_OSAL_nThreadId = 0;
+
+    if (g_pLogFile)
+        fclose(g_pLogFile);
+    g_pLogFile = NULL;
+    /* the event log records of the parent are still buffered in this copy */
+    g_OMX_OSAL_pEventLog = NULL;
+
+    g_OMX_OSAL_pWorkers = NULL;
+    g_OMX_OSAL_nIdleWorkers = 0;
+
+    /* the drain thread was not forked, and the rings were drained before the fork */
+    g_OMX_OSAL_bTraceDrainRunning = OMX_FALSE;
+    g_OMX_OSAL_nTraceRingEntries = 0;
+    g_OMX_OSAL_bTraceRings = OMX_FALSE;
+    setvbuf(stdout, NULL, _IOLBF, BUFSIZ);
+
+    if (g_OMX_OSAL_pThreadCounters) {
+        pthread_setspecific(g_OMX_OSAL_CounterKey, NULL);
+        OMX_OSAL_CountersRelease(g_OMX_OSAL_pThreadCounters);
+    }
+    if (g_OMX_OSAL_bHwCounters) {
+        OMX_OSAL_CountersClose();
+        OMX_OSAL_CountersOpen();
+    }
+}
+
+OMX_ERRORTYPE OMX_OSAL_ProcessStart( OMX_IN OMX_U32 (*pFunc)(OMX_PTR pParam), 
+                                     OMX_IN OMX_PTR pParam, 
+                                     OMX_OUT OMX_HANDLETYPE *phProcess )
+{
+    OMX_OSAL_PROCESSTYPE *pProcess;
+    char sOutputName[] = "/tmp/omxconfXXXXXX";
+    int nPipe[2];
+    OMX_OSAL_PROCESSRESULTTYPE oResult;
+
+    pProcess = (OMX_OSAL_PROCESSTYPE *)OMX_OSAL_Malloc(sizeof(OMX_OSAL_PROCESSTYPE));
+    if (!pProcess)
+        return OMX_ErrorInsufficientResources;
+    if (pipe2(nPipe, O_CLOEXEC)) {
+        OMX_OSAL_Free(pProcess);
+        return OMX_ErrorInsufficientResources;
+    }
+    pProcess->nOutputFd = mkostemp(sOutputName, O_CLOEXEC);
+    if (pProcess->nOutputFd < 0) {
+        close(nPipe[0]);
+        close(nPipe[1]);
+        OMX_OSAL_Free(pProcess);
+        return OMX_ErrorInsufficientResources;
+    }
+    unlink(sOutputName);
+
+    OMX_OSAL_TraceFlush();
+    pthread_mutex_lock(&g_OMX_OSAL_ThreadPoolMutex);
+    pthread_mutex_lock(&g_OMX_OSAL_LogFileMutex);
+    fflush(stdout);
+    fflush(stderr);
+    if (g_pLogFile)
+        fflush(g_pLogFile);
+    if (g_OMX_OSAL_pEventLog)
+        fflush(g_OMX_OSAL_pEventLog);
+
+    pProcess->nPid = fork();
+    if (pProcess->nPid == 0) {
+        pthread_mutex_unlock(&g_OMX_OSAL_LogFileMutex);
+        pthread_mutex_unlock(&g_OMX_OSAL_ThreadPoolMutex);
+        close(nPipe[0]);
+        dup2(pProcess->nOutputFd, STDOUT_FILENO);
+        dup2(pProcess->nOutputFd, STDERR_FILENO);
+        OMX_OSAL_ProcessChildInit();
+
+        oResult.uReturn = pFunc(pParam);
+        oResult.nReplyBytes = g_OMX_OSAL_nProcessReplyBytes;
+
+        fflush(stdout);
+        fflush(stderr);
+        if (!OMX_OSAL_ProcessTransfer(nPipe[1], (OMX_U8 *)&oResult, sizeof(oResult), OMX_TRUE) ||
+            !OMX_OSAL_ProcessTransfer(nPipe[1], g_OMX_OSAL_pProcessReply, g_OMX_OSAL_nProcessReplyBytes, OMX_TRUE))
+            _exit(1);
+        _exit(0);
+    }
+
+    pthread_mutex_unlock(&g_OMX_OSAL_LogFileMutex);
+    pthread_mutex_unlock(&g_OMX_OSAL_ThreadPoolMutex);
+    close(nPipe[1]);
+    if (pProcess->nPid < 0) {
+        close(nPipe[0]);
+        close(pProcess->nOutputFd);
+        OMX_OSAL_Free(pProcess);
+        return OMX_ErrorInsufficientResources;
+    }
+    pProcess->nResultFd = nPipe[0];
+    *phProcess = (OMX_HANDLETYPE)pProcess;
+    return OMX_ErrorNone;
+}
+
+OMX_ERRORTYPE OMX_OSAL_ProcessWait( OMX_IN OMX_HANDLETYPE *phProcesses, 
+                                    OMX_IN OMX_U32 nProcesses, 
+                                    OMX_IN OMX_U32 mSec, 
+                                    OMX_OUT OMX_U32 *pnIndex )
+{
+    struct pollfd oFds[OMX_OSAL_PROCESS_MAXWAIT];
+    OMX_U64 nDeadlineNs;
+    OMX_U32 i;
+    int nReady;
+
+    if (nProcesses == 0 || nProcesses > OMX_OSAL_PROCESS_MAXWAIT)
+        return OMX_ErrorBadParameter;
+    for (i = 0; i < nProcesses; i++) {
+        oFds[i].fd = ((OMX_OSAL_PROCESSTYPE *)phProcesses[i])->nResultFd;
+        oFds[i].events = POLLIN;
+        oFds[i].revents = 0;
+    }
+
+    nDeadlineNs = OMX_OSAL_GetTimeNs() + (OMX_U64)mSec * 1000000;
+    do {
+        nReady = poll(oFds, nProcesses, (int)((nDeadlineNs - OMX_OSAL_GetTimeNs() + 999999) / 1000000));
+    } while (nReady < 0 && errno == EINTR && OMX_OSAL_GetTimeNs() < nDeadlineNs);
+
+    for (i = 0; nReady > 0 && i < nProcesses; i++) {
+        /* end of file (POLLHUP) when the child died before writing */
+        if (oFds[i].revents) {
+            *pnIndex = i;
+            return OMX_ErrorNone;
+        }
+    }
+    return OMX_ErrorTimeout;
+}
+
+OMX_ERRORTYPE OMX_OSAL_ProcessReply( OMX_IN OMX_PTR pData, OMX_IN OMX_U32 nBytes )
 {
-    OMX_OSAL_THREAD_EVENT *pEvent = (OMX_OSAL_THREAD_EVENT *)hEvent;
-    OMX_U32         timeout_us;
-    struct timespec timeout;
-    int             retcode;
+    OMX_U8 *pReply;
 
-    struct timeval now;
-    gettimeofday(&now, NULL);
-
-    *pbTimedOut = OMX_FALSE;
-
-    timeout_us = now.tv_usec + 1000*uMSec;
-    timeout.tv_sec = now.tv_sec + timeout_us / 1000000;
-    timeout.tv_nsec = (timeout_us % 1000000) * 1000;
+    if (!g_OMX_OSAL_bProcessChild)
+        return OMX_ErrorIncorrectStateOperation;
+    pReply = (OMX_U8 *)OMX_OSAL_Malloc(nBytes ? nBytes : 1);
+    if (!pReply)
+        return OMX_ErrorInsufficientResources;
+    memcpy(pReply, pData, nBytes);
+    if (g_OMX_OSAL_pProcessReply)
+        OMX_OSAL_Free(g_OMX_OSAL_pProcessReply);
+    g_OMX_OSAL_pProcessReply = pReply;
+    g_OMX_OSAL_nProcessReplyBytes = nBytes;
+    return OMX_ErrorNone;
+}
 
-    if (pEvent == NULL)
-        return OMX_ErrorBadParameter;
-    if (pthread_mutex_lock(&pEvent->mutex))
+OMX_ERRORTYPE OMX_OSAL_ProcessDestroy( OMX_IN OMX_HANDLETYPE hProcess, OMX_OUT OMX_U32 *puReturn,
+                                       OMX_OUT OMX_PTR *ppReply, OMX_OUT OMX_U32 *pnReplyBytes )
+{
+    OMX_OSAL_PROCESSTYPE *pProcess = (OMX_OSAL_PROCESSTYPE *)hProcess;
+    OMX_ERRORTYPE eError = OMX_ErrorUndefined;
+    struct pollfd oFd;
+    OMX_OSAL_PROCESSRESULTTYPE oResult;
+    OMX_U8 *pReply = NULL;
+    char sOutput[4096];
+    ssize_t nBytes;
+    int nStatus = 0;
+
+    if (ppReply)
+        *ppReply = NULL;
+    if (pnReplyBytes)
+        *pnReplyBytes = 0;
+    if (pProcess == NULL)
         return OMX_ErrorBadParameter;
 
-    if (uMSec == 0) {
-        if (!pEvent->bSignaled) {
-            *pbTimedOut = OMX_TRUE;
-        }
-    }
-    else if (uMSec == INFINITE_WAIT) {
-        while (!pEvent->bSignaled) {
-            pthread_cond_wait(&pEvent->condition, &pEvent->mutex);
-        }
-    }
-    else {
-        while (!pEvent->bSignaled) {
-            retcode = pthread_cond_timedwait(&pEvent->condition, &pEvent->mutex, &timeout);
-            if (retcode == ETIMEDOUT && !pEvent->bSignaled) {
-                *pbTimedOut = OMX_TRUE;
-                break;
+    oFd.fd = pProcess->nResultFd;
+    oFd.events = POLLIN;
+    if (poll(&oFd, 1, 0) <= 0) {
+        kill(pProcess->nPid, SIGKILL);
+        eError = OMX_ErrorTimeout;
+    } else if (OMX_OSAL_ProcessTransfer(pProcess->nResultFd, (OMX_U8 *)&oResult, sizeof(oResult), OMX_FALSE)) {
+        /* the child blocks on a reply larger than the pipe until it is read here */
+        pReply = (OMX_U8 *)OMX_OSAL_Malloc(oResult.nReplyBytes ? oResult.nReplyBytes : 1);
+        if (pReply && OMX_OSAL_ProcessTransfer(pProcess->nResultFd, pReply, oResult.nReplyBytes, OMX_FALSE)) {
+            if (puReturn)
+                *puReturn = oResult.uReturn;
+            if (ppReply && pnReplyBytes && oResult.nReplyBytes) {
+                *ppReply = pReply;
+                *pnReplyBytes = oResult.nReplyBytes;
+                pReply = NULL;
             }
+            eError = OMX_ErrorNone;
         }
+        if (pReply)
+            OMX_OSAL_Free(pReply);
     }
-
-    pthread_mutex_unlock(&pEvent->mutex);
-    return OMX_ErrorNone;
+    while (waitpid(pProcess->nPid, &nStatus, 0) < 0 && errno == EINTR);
+
+    OMX_OSAL_TraceFlush();
+    pthread_mutex_lock(&g_OMX_OSAL_LogFileMutex);
+    lseek(pProcess->nOutputFd, 0, SEEK_SET);
+    while ((nBytes = read(pProcess->nOutputFd, sOutput, sizeof(sOutput))) > 0)
+        OMX_OSAL_TraceWrite(sOutput, (size_t)nBytes);
+    fflush(stdout);
+    if (g_pLogFile)
+        fflush(g_pLogFile);
+    pthread_mutex_unlock(&g_OMX_OSAL_LogFileMutex);
+
+    close(pProcess->nResultFd);
+    close(pProcess->nOutputFd);
+    if (eError == OMX_ErrorUndefined) {
+        if (WIFSIGNALED(nStatus))
+            OMX_OSAL_Trace(OMX_OSAL_TRACE_ERROR, "Process %d was terminated by signal %d (%s)\n", 
+                           (int)pProcess->nPid, WTERMSIG(nStatus), strsignal(WTERMSIG(nStatus)));
+        else
+            OMX_OSAL_Trace(OMX_OSAL_TRACE_ERROR, "Process %d exited with status %d before returning\n", 
+                           (int)pProcess->nPid, WEXITSTATUS(nStatus));
+    }
+    OMX_OSAL_Free(pProcess);
+    return eError;
 }
 
 /**********************************************************************
- * TIME
+ * ASYNCHRONOUS FILE I/O
+ *
+ * Port files are read ahead and written behind by a pool thread per open
+ * file, so that the disk is not touched from inside buffer callbacks. 
+ * Chunks circulate between two queues: the worker takes chunks from
+ * hFree and hands them over on hFull. For reading, the worker fills
+ * chunks ahead of the reader (for mapped files a chunk is a view into
+ * the mapping whose pages the worker faults in). For writing, the writer
+ * fills chunks and the worker writes them out. A NULL entry stops the
+ * worker.
  **********************************************************************/
 
-/** Returns a time value in milliseconds based on a clock starting at
- *  some arbitrary base. Given a call to GetTime that returns a value
- *  of n a subsequent call to GetTime made m milliseconds later should 
- *  return a value of (approximately) (n+m). This method is used, for
- *  instance, to compute the duration of call. */
-OMX_U32 OMX_OSAL_GetTime()
+typedef struct OMX_OSAL_FILECHUNKTYPE {
+    OMX_U8 *pData;
+    OMX_U32 nBytes;
+    OMX_U32 nUsed;
+} OMX_OSAL_FILECHUNKTYPE;
+
+typedef struct OMX_OSAL_FILEQUEUETYPE {
+    FILE *pFile;
+    OMX_U8 *pMap;           /* read ahead from this mapping instead of pFile */
+    size_t nMapSize;
+    size_t nFetchPos;
+    OMX_HANDLETYPE hFree;
+    OMX_HANDLETYPE hFull;
+    OMX_HANDLETYPE hWorker;
+    OMX_U32 nChunkBytes;
+    OMX_OSAL_FILECHUNKTYPE *pChunk;     /* chunk being consumed/filled by the caller */
+    OMX_BOOL bEnd;
+    OMX_BOOL bError;
+    OMX_OSAL_FILECHUNKTYPE oChunks[1];  /* followed by the rest of the chunks and their data */
+} OMX_OSAL_FILEQUEUETYPE;
+
+static OMX_U32 g_OMX_OSAL_nFileIoDepth = 8;
+static OMX_U32 g_OMX_OSAL_nFileIoChunkBytes = 256 * 1024;
+
+OMX_ERRORTYPE OMX_OSAL_FileIoConfigure( OMX_IN OMX_U32 nDepth, OMX_IN OMX_U32 nChunkBytes )
 {
-    struct timeval now;
-    gettimeofday(&now, NULL);
-    return ((OMX_U32)now.tv_sec) * 1000 + ((OMX_U32)now.tv_usec) / 1000;
+    g_OMX_OSAL_nFileIoDepth = nDepth;
+    if (nChunkBytes) g_OMX_OSAL_nFileIoChunkBytes = nChunkBytes;
+    return OMX_ErrorNone;
 }
 
-/**************************************************************
- * LOG FILES
- **************************************************************/
+static OMX_U32 OMX_OSAL_FileReadAhead(OMX_PTR pParam)
+{
+    OMX_OSAL_FILEQUEUETYPE *pQueue = (OMX_OSAL_FILEQUEUETYPE *)pParam;
+    OMX_OSAL_FILECHUNKTYPE *pChunk;
+    size_t nPageSize = (size_t)sysconf(_SC_PAGESIZE);
+    size_t i;
+    volatile OMX_U8 nTouch;
+
+    for (;;) {
+        OMX_OSAL_QueuePop(pQueue->hFree, INFINITE_WAIT, (OMX_PTR *)&pChunk);
+        if (!pChunk) break;
+
+        if (pQueue->pMap) {
+            pChunk->pData = pQueue->pMap + pQueue->nFetchPos;
+            pChunk->nBytes = pQueue->nChunkBytes;
+            if (pChunk->nBytes > pQueue->nMapSize - pQueue->nFetchPos)
+                pChunk->nBytes = (OMX_U32)(pQueue->nMapSize - pQueue->nFetchPos);
+            pQueue->nFetchPos += pChunk->nBytes;
+            for (i = 0; i < pChunk->nBytes; i += nPageSize) {
+                nTouch = pChunk->pData[i];
+            }
+        } else {
+            pChunk->nBytes = (OMX_U32)fread(pChunk->pData, 1, pQueue->nChunkBytes, pQueue->pFile);
+        }
+        pChunk->nUsed = 0;
+        OMX_OSAL_QueuePush(pQueue->hFull, pChunk);
 
-FILE *g_pLogFile=NULL;
+        /* an empty chunk marks the end of the file */
+        if (!pChunk->nBytes) break;
+    }
+    (void)nTouch;
+    return 0;
+}
 
-/** Open logfile. All enabled tracing will be sent to the file (in addition
- *  to the display). */
-OMX_ERRORTYPE OMX_OSAL_OpenLogfile(OMX_IN OMX_STRING sFilename)
+static OMX_U32 OMX_OSAL_FileWriteBehind(OMX_PTR pParam)
 {
-    OMX_OSAL_CloseLogfile();
-    g_pLogFile = fopen(sFilename, "w");
-    return g_pLogFile? OMX_ErrorNone : OMX_ErrorBadParameter;
+    OMX_OSAL_FILEQUEUETYPE *pQueue = (OMX_OSAL_FILEQUEUETYPE *)pParam;
+    OMX_OSAL_FILECHUNKTYPE *pChunk;
+
+    for (;;) {
+        OMX_OSAL_QueuePop(pQueue->hFull, INFINITE_WAIT, (OMX_PTR *)&pChunk);
+        if (!pChunk) break;
+
+        if (fwrite(pChunk->pData, 1, pChunk->nBytes, pQueue->pFile) != pChunk->nBytes)
+            pQueue->bError = OMX_TRUE;
+        OMX_OSAL_QueuePush(pQueue->hFree, pChunk);
+    }
+    return 0;
 }
 
-/** Close logfile.*/
-OMX_ERRORTYPE OMX_OSAL_CloseLogfile()
+static void OMX_OSAL_FileQueueDestroy(OMX_OSAL_FILEQUEUETYPE *pQueue)
 {
-    if (g_pLogFile){
-        fclose(g_pLogFile);
-        g_pLogFile = NULL;
-    }
-    return OMX_ErrorNone;
+    if (!pQueue) return;
+    if (pQueue->hFree) OMX_OSAL_QueueDestroy(pQueue->hFree);
+    if (pQueue->hFull) OMX_OSAL_QueueDestroy(pQueue->hFull);
+    OMX_OSAL_Free(pQueue);
 }
 
-/***********************************************************************
- * TRACE
- ***********************************************************************/
+/* Start read ahead (bWrite false) or write behind on pFile. pMap, if given, is 
+ * the mapping of the whole file to read from, starting at nMapPos. Returns NULL when asynchronous 
+ * I/O is off or cannot be set up; the caller then does synchronous I/O. */
+static OMX_OSAL_FILEQUEUETYPE *OMX_OSAL_FileQueueCreate(FILE *pFile, OMX_U8 *pMap, size_t nMapSize, size_t nMapPos, 
+                                                        OMX_BOOL bWrite)
+{
+    OMX_OSAL_FILEQUEUETYPE *pQueue;
+    OMX_U32 nDepth = g_OMX_OSAL_nFileIoDepth;
+    OMX_U32 nChunkBytes = g_OMX_OSAL_nFileIoChunkBytes;
+    size_t nHeader;
+    OMX_U32 i;
 
-static OMX_BOOL bSkipPrefix = OMX_FALSE;
+    if (!nDepth) return NULL;
+
+    nHeader = offsetof(OMX_OSAL_FILEQUEUETYPE, oChunks) + nDepth * sizeof(OMX_OSAL_FILECHUNKTYPE);
+    nHeader = (nHeader + 63) & ~(size_t)63;
+    pQueue = (OMX_OSAL_FILEQUEUETYPE *)OMX_OSAL_Malloc(nHeader + (pMap ? 0 : (size_t)nDepth * nChunkBytes));
+    if (!pQueue) return NULL;
+    memset(pQueue, 0, nHeader);
+    pQueue->pFile = pFile;
+    pQueue->pMap = pMap;
+    pQueue->nMapSize = nMapSize;
+    pQueue->nFetchPos = nMapPos;
+    pQueue->nChunkBytes = nChunkBytes;
+
+    /* one spare entry each for the NULL that stops the worker */
+    if (OMX_OSAL_QueueCreate(nDepth + 1, &pQueue->hFree) != OMX_ErrorNone ||
+        OMX_OSAL_QueueCreate(nDepth + 1, &pQueue->hFull) != OMX_ErrorNone) {
+        OMX_OSAL_FileQueueDestroy(pQueue);
+        return NULL;
+    }
+    for (i = 0; i < nDepth; i++) {
+        pQueue->oChunks[i].pData = pMap ? NULL : (OMX_U8 *)pQueue + nHeader + (size_t)i * nChunkBytes;
+        OMX_OSAL_QueuePush(pQueue->hFree, &pQueue->oChunks[i]);
+    }
 
-/** Output a trace message */
-OMX_ERRORTYPE OMX_OSAL_Trace(OMX_IN OMX_U32 nTraceFlags, OMX_IN char *format, ...)
+    if (OMX_OSAL_ThreadPoolSubmit(bWrite ? OMX_OSAL_FileWriteBehind : OMX_OSAL_FileReadAhead, 
+                                  pQueue, 0, 0, &pQueue->hWorker) != OMX_ErrorNone) {
+        OMX_OSAL_FileQueueDestroy(pQueue);
+        return NULL;
+    }
+    return pQueue;
+}
+
+/* Stop the worker; everything written so far reaches the file first. 
+ * Returns OMX_FALSE if any write failed. */
+static OMX_BOOL OMX_OSAL_FileQueueClose(OMX_OSAL_FILEQUEUETYPE *pQueue, OMX_BOOL bWrite)
 {
-    char szPrefix[5];
-    va_list args;
+    OMX_BOOL bOk;
+
+    if (bWrite) {
+        if (pQueue->pChunk && pQueue->pChunk->nBytes)
+            OMX_OSAL_QueuePush(pQueue->hFull, pQueue->pChunk);
+        OMX_OSAL_QueuePush(pQueue->hFull, NULL);
+    } else {
+        OMX_OSAL_QueuePush(pQueue->hFree, NULL);
+    }
+    OMX_OSAL_ThreadPoolWait(pQueue->hWorker, NULL);
 
-    if (g_OMX_CONF_hTraceMutex) OMX_OSAL_MutexLock(g_OMX_CONF_hTraceMutex);
+    bOk = pQueue->bError ? OMX_FALSE : OMX_TRUE;
+    OMX_OSAL_FileQueueDestroy(pQueue);
+    return bOk;
+}
 
-    if (g_OMX_OSAL_TraceFlags & nTraceFlags)
-    {
-        if (format[0]!='#' && format[0]!='\n' && !bSkipPrefix)
-        {
-            /* emit trace prefix */
-            OMX_OSAL_GetTracePrefix(nTraceFlags,szPrefix);
-            printf(szPrefix);
-            if (g_pLogFile){
-                fprintf(g_pLogFile,szPrefix);
+/* Take up to nBytes from the read ahead, copying them to pData unless it is
+ * NULL. Returns fewer bytes only at the end of the file. */
+static OMX_U32 OMX_OSAL_FileQueueRead(OMX_OSAL_FILEQUEUETYPE *pQueue, OMX_U8 *pData, OMX_U32 nBytes)
+{
+    OMX_OSAL_FILECHUNKTYPE *pChunk;
+    OMX_U32 nDone = 0, n;
+
+    while (nDone < nBytes && !pQueue->bEnd) {
+        if (!pQueue->pChunk) {
+            OMX_OSAL_QueuePop(pQueue->hFull, INFINITE_WAIT, (OMX_PTR *)&pQueue->pChunk);
+            if (!pQueue->pChunk->nBytes) {
+                pQueue->bEnd = OMX_TRUE;
+                pQueue->pChunk = NULL;
+                break;
             }
         }
-
-        /* emit trace */
-        va_start(args, format);
-        vprintf(format, args);
-        if (g_pLogFile){
-            vfprintf(g_pLogFile,format, args);
+        pChunk = pQueue->pChunk;
+        n = pChunk->nBytes - pChunk->nUsed;
+        if (n > nBytes - nDone) n = nBytes - nDone;
+        if (pData) memcpy(pData + nDone, pChunk->pData + pChunk->nUsed, n);
+        pChunk->nUsed += n;
+        nDone += n;
+        if (pChunk->nUsed == pChunk->nBytes) {
+            OMX_OSAL_QueuePush(pQueue->hFree, pChunk);
+            pQueue->pChunk = NULL;
         }
-        va_end(args);
-
-        /* skip prefix on next output if this is no the end of line */
-        if (format[0] != 0)
-            bSkipPrefix = (format[strlen(format)-1]  != '\n');
-    }    
+    }
+    return nDone;
+}
 
-    if (g_OMX_CONF_hTraceMutex) OMX_OSAL_MutexUnlock(g_OMX_CONF_hTraceMutex);
+/* Hand nBytes to the write behind. Blocks only while all chunks are queued. */
+static void OMX_OSAL_FileQueueWrite(OMX_OSAL_FILEQUEUETYPE *pQueue, const OMX_U8 *pData, OMX_U32 nBytes)
+{
+    OMX_OSAL_FILECHUNKTYPE *pChunk;
+    OMX_U32 nDone = 0, n;
 
-    return OMX_ErrorNone;       
+    while (nDone < nBytes) {
+        if (!pQueue->pChunk) {
+            OMX_OSAL_QueuePop(pQueue->hFree, INFINITE_WAIT, (OMX_PTR *)&pQueue->pChunk);
+            pQueue->pChunk->nBytes = 0;
+        }
+        pChunk = pQueue->pChunk;
+        n = pQueue->nChunkBytes - pChunk->nBytes;
+        if (n > nBytes - nDone) n = nBytes - nDone;
+        memcpy(pChunk->pData + pChunk->nBytes, pData + nDone, n);
+        pChunk->nBytes += n;
+        nDone += n;
+        if (pChunk->nBytes == pQueue->nChunkBytes) {
+            OMX_OSAL_QueuePush(pQueue->hFull, pChunk);
+            pQueue->pChunk = NULL;
+        }
+    }
 }
 
 /**********************************************************************
@@ -470,6 +3171,166 @@ OMX_ERRORTYPE OMX_OSAL_ReadBufferVarianceFile (OMX_OUT OMX_U8 *sPortIndex,
 FILE *g_OMX_CONF_pInFile[OMX_CONF_MAXINFILEMAPPINGS];
 OMX_CONF_INFILEMAPPINGSIZETYPE g_OMX_CONF_pInFileSizes[OMX_CONF_MAXINFILEMAPPINGS];
 
+/* Input files are mapped once and read from the mapping. Files that cannot be 
+ * mapped (pipes, devices, too large for the address space) fall back to fread. */
+typedef struct OMX_OSAL_INFILEVIEWTYPE {
+    OMX_U8 *pMap;           /* whole file, read only; NULL if not mapped */
+    size_t nMapSize;
+    size_t nPos;            /* read position within the file */
+    OMX_U64 nBytesRead;     /* throughput accounting, reported on close */
+    OMX_U64 nReadNs;
+    OMX_U32 nReads;
+    OMX_U32 nInPlace;       /* reads that mapped the file into the buffer */
+    OMX_OSAL_FILEQUEUETYPE *pQueue;     /* read ahead; NULL for synchronous reads */
+    OMX_OSAL_FRAMEINDEXHEADERTYPE *pIndex;  /* mapped <input>.index, NULL if there is none */
+    size_t nIndexSize;
+    const OMX_OSAL_FRAMEINFOTYPE *pFrames;
+} OMX_OSAL_INFILEVIEWTYPE;
+
+OMX_OSAL_INFILEVIEWTYPE g_OMX_OSAL_InFileView[OMX_CONF_MAXINFILEMAPPINGS];
+
+static void OMX_OSAL_InputFileMap(OMX_U32 nArrayIndex)
+{
+    OMX_OSAL_INFILEVIEWTYPE *pView = &g_OMX_OSAL_InFileView[nArrayIndex];
+    struct stat sStat;
+    void *pMap;
+
+    memset(pView, 0, sizeof(*pView));
+    if (!fstat(fileno(g_OMX_CONF_pInFile[nArrayIndex]), &sStat) && S_ISREG(sStat.st_mode) && 
+        sStat.st_size > 0 && (OMX_U64)sStat.st_size <= (OMX_U64)SIZE_MAX) {
+        pMap = mmap(NULL, (size_t)sStat.st_size, PROT_READ, MAP_PRIVATE, fileno(g_OMX_CONF_pInFile[nArrayIndex]), 0);
+        if (pMap != MAP_FAILED) {
+            madvise(pMap, (size_t)sStat.st_size, MADV_SEQUENTIAL);
+            pView->pMap = (OMX_U8 *)pMap;
+            pView->nMapSize = (size_t)sStat.st_size;
+        }
+    }
+    pView->pQueue = OMX_OSAL_FileQueueCreate(g_OMX_CONF_pInFile[nArrayIndex], pView->pMap, pView->nMapSize, 0, OMX_FALSE);
+}
+
+/* Map sIndexName if it is a valid frame index. The index is only ever read 
+ * through the mapping, so opening it costs the same for any number of frames. */
+static OMX_BOOL OMX_OSAL_InputFileMapIndex(OMX_U32 nArrayIndex, const char *sIndexName)
+{
+    OMX_OSAL_INFILEVIEWTYPE *pView = &g_OMX_OSAL_InFileView[nArrayIndex];
+    OMX_OSAL_FRAMEINDEXHEADERTYPE *pIndex;
+    struct stat sStat;
+    void *pMap;
+    int fd;
+
+    fd = open(sIndexName, O_RDONLY);
+    if (fd < 0) return OMX_FALSE;
+    if (fstat(fd, &sStat) || sStat.st_size < (off_t)sizeof(OMX_OSAL_FRAMEINDEXHEADERTYPE) ||
+        (OMX_U64)sStat.st_size > (OMX_U64)SIZE_MAX) {
+        close(fd);
+        return OMX_FALSE;
+    }
+    pMap = mmap(NULL, (size_t)sStat.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (pMap == MAP_FAILED) return OMX_FALSE;
+
+    pIndex = (OMX_OSAL_FRAMEINDEXHEADERTYPE *)pMap;
+    if (pIndex->nMagic != OMX_OSAL_FRAMEINDEX_MAGIC || pIndex->nVersion != OMX_OSAL_FRAMEINDEX_VERSION ||
+        (pIndex->nFramesOffset & 7) || pIndex->nFramesOffset > (OMX_U64)sStat.st_size ||
+        pIndex->nFrames > ((OMX_U64)sStat.st_size - pIndex->nFramesOffset) / sizeof(OMX_OSAL_FRAMEINFOTYPE) ||
+        pIndex->nFrames > 0xFFFFFFFF) {
+        OMX_OSAL_Trace(OMX_OSAL_TRACE_ERROR, "%s is not a valid frame index\n", sIndexName);
+        munmap(pMap, (size_t)sStat.st_size);
+        return OMX_FALSE;
+    }
+    pView->pIndex = pIndex;
+    pView->nIndexSize = (size_t)sStat.st_size;
+    pView->pFrames = (const OMX_OSAL_FRAMEINFOTYPE *)((OMX_U8 *)pMap + pIndex->nFramesOffset);
+    g_OMX_CONF_pInFileSizes[nArrayIndex].nEntries = (OMX_U32)pIndex->nFrames;
+    g_OMX_CONF_pInFileSizes[nArrayIndex].nMaxBufSize = pIndex->nMaxFrameSize;
+    return OMX_TRUE;
+}
+
+/* Move the read position of the input file, restarting the read ahead there */
+static void OMX_OSAL_InputFileSetPos(OMX_U32 nArrayIndex, OMX_U64 nPos)
+{
+    OMX_OSAL_INFILEVIEWTYPE *pView = &g_OMX_OSAL_InFileView[nArrayIndex];
+
+    if (pView->pMap && nPos > pView->nMapSize) nPos = pView->nMapSize;
+    if (pView->pQueue) {
+        OMX_OSAL_FileQueueClose(pView->pQueue, OMX_FALSE);
+        pView->pQueue = NULL;
+    }
+    if (!pView->pMap) {
+        fseeko(g_OMX_CONF_pInFile[nArrayIndex], (off_t)nPos, SEEK_SET);
+    }
+    pView->nPos = (size_t)nPos;
+    pView->pQueue = OMX_OSAL_FileQueueCreate(g_OMX_CONF_pInFile[nArrayIndex], pView->pMap, pView->nMapSize, 
+                                             pView->nPos, OMX_FALSE);
+}
+
+/* Size of the next read: nMaxBytes, or less if the .length file says so */
+static OMX_U32 OMX_OSAL_InputFileNextSize(OMX_U32 nArrayIndex, OMX_U32 nMaxBytes)
+{
+    OMX_OSAL_INFILEVIEWTYPE *pView = &g_OMX_OSAL_InFileView[nArrayIndex];
+    OMX_U32 nBytes = nMaxBytes;
+    OMX_U32 nCurrent = g_OMX_CONF_pInFileSizes[nArrayIndex].nCurrent;
+
+    if (pView->pFrames)
+    {
+        if (nCurrent < g_OMX_CONF_pInFileSizes[nArrayIndex].nEntries)
+        {
+            /* frames need not be stored back to back */
+            if (pView->pFrames[nCurrent].nOffset != pView->nPos)
+                OMX_OSAL_InputFileSetPos(nArrayIndex, pView->pFrames[nCurrent].nOffset);
+            if (pView->pFrames[nCurrent].nSize < nBytes)
+                nBytes = pView->pFrames[nCurrent].nSize;
+            g_OMX_CONF_pInFileSizes[nArrayIndex].nCurrent += 1;
+        }
+        else
+            g_OMX_CONF_pInFileSizes[nArrayIndex].bEOS = OMX_TRUE;
+    }
+    else if (g_OMX_CONF_pInFileSizes[nArrayIndex].pSizes)
+    {
+        if (nCurrent < g_OMX_CONF_pInFileSizes[nArrayIndex].nEntries)
+        {
+            if (g_OMX_CONF_pInFileSizes[nArrayIndex].pSizes[nCurrent] < nBytes)
+                nBytes = g_OMX_CONF_pInFileSizes[nArrayIndex].pSizes[nCurrent];
+            g_OMX_CONF_pInFileSizes[nArrayIndex].nCurrent += 1;
+        }
+        else
+            g_OMX_CONF_pInFileSizes[nArrayIndex].bEOS = OMX_TRUE;
+    }
+    return nBytes;
+}
+
+/* Copy the next nBytes of the input file into pData */
+static OMX_U32 OMX_OSAL_InputFileCopy(OMX_U32 nArrayIndex, OMX_PTR pData, OMX_U32 nBytes)
+{
+    OMX_OSAL_INFILEVIEWTYPE *pView = &g_OMX_OSAL_InFileView[nArrayIndex];
+
+    if (pView->pQueue) {
+        nBytes = OMX_OSAL_FileQueueRead(pView->pQueue, (OMX_U8 *)pData, nBytes);
+        pView->nPos += nBytes;
+        return nBytes;
+    }
+    if (!pView->pMap) {
+        nBytes = (OMX_U32)fread(pData, 1, nBytes, g_OMX_CONF_pInFile[nArrayIndex]);
+        pView->nPos += nBytes;
+        return nBytes;
+    }
+    if (nBytes > pView->nMapSize - pView->nPos) {
+        nBytes = (OMX_U32)(pView->nMapSize - pView->nPos);
+    }
+    memcpy(pData, pView->pMap + pView->nPos, nBytes);
+    pView->nPos += nBytes;
+    return nBytes;
+}
+
+static void OMX_OSAL_InputFileAccount(OMX_U32 nArrayIndex, OMX_U32 nBytes, OMX_U64 nStart)
+{
+    OMX_OSAL_INFILEVIEWTYPE *pView = &g_OMX_OSAL_InFileView[nArrayIndex];
+
+    pView->nBytesRead += nBytes;
+    pView->nReadNs += OMX_OSAL_GetTimeNs() - nStart;
+    pView->nReads++;
+}
+
 OMX_ERRORTYPE OMX_OSAL_PortIndexToArrayIndex( OMX_IN OMX_U32 nPortIndex, OMX_OUT OMX_U32 *pArrayIndex )
 {
     OMX_U32 i;
@@ -485,7 +3346,8 @@ OMX_ERRORTYPE OMX_OSAL_PortIndexToArrayIndex( OMX_IN OMX_U32 nPortIndex, OMX_OUT
 OMX_ERRORTYPE OMX_OSAL_OpenInputFile( OMX_IN OMX_U32 nPortIndex )
 {
     OMX_U32 nArrayIndex;
-    char szLengthName[256];
+    char szIndexName[sizeof(g_OMX_CONF_InFileMap[0].sInputFileName) + sizeof(".index")];
+    char szLengthName[sizeof(g_OMX_CONF_InFileMap[0].sInputFileName) + sizeof(".length")];
     OMX_U8 sPortIndex[16];
     OMX_U32 i=0;
     OMX_U32 nFieldArraySize;
@@ -496,6 +3358,11 @@ OMX_ERRORTYPE OMX_OSAL_OpenInputFile( OMX_IN OMX_U32 nPortIndex )
     if ( OMX_ErrorNone != OMX_OSAL_PortIndexToArrayIndex(nPortIndex, &nArrayIndex)){
         return OMX_ErrorBadParameter;
     }
+
+    /* named before the file is opened, so that a name too long leaks nothing */
+    if (snprintf( szIndexName, sizeof(szIndexName), "%s.index", g_OMX_CONF_InFileMap[nArrayIndex].sInputFileName) >= (int)sizeof(szIndexName) ||
+        snprintf( szLengthName, sizeof(szLengthName), "%s.length", g_OMX_CONF_InFileMap[nArrayIndex].sInputFileName) >= (int)sizeof(szLengthName))
+        return OMX_ErrorBadParameter;
     
     g_OMX_CONF_pInFile[nArrayIndex] = fopen(g_OMX_CONF_InFileMap[nArrayIndex].sInputFileName, "rb");
     g_OMX_CONF_pInFileSizes[nArrayIndex].nEntries = 0;
@@ -505,9 +3372,12 @@ OMX_ERRORTYPE OMX_OSAL_OpenInputFile( OMX_IN OMX_U32 nPortIndex )
     g_OMX_CONF_pInFileSizes[nArrayIndex].bEOS = OMX_FALSE;
 
     if (!g_OMX_CONF_pInFile[nArrayIndex]) return OMX_ErrorUndefined;
+    OMX_OSAL_InputFileMap(nArrayIndex);
+
+    /* A binary frame index takes precedence over the text length file */
+    if (OMX_OSAL_InputFileMapIndex(nArrayIndex, szIndexName)) return OMX_ErrorNone;
 
     /* If corresponding length file exists, open it and initialize data */
-    sprintf( szLengthName, "%s.length", g_OMX_CONF_InFileMap[nArrayIndex].sInputFileName);
     fpInSize = fopen( szLengthName, "r");
     if ( fpInSize )
     {
@@ -534,21 +3404,27 @@ OMX_ERRORTYPE OMX_OSAL_OpenInputFile( OMX_IN OMX_U32 nPortIndex )
 OMX_U32 OMX_OSAL_ReadFromInputFile( OMX_OUT OMX_PTR pData, OMX_IN OMX_U32 nBytes, OMX_IN OMX_U32 nPortIndex )
 {
     OMX_U32 nArrayIndex;
+    OMX_U64 nStart;
+    OMX_U32 nRetVal;
+
     if ( OMX_ErrorNone != OMX_OSAL_PortIndexToArrayIndex(nPortIndex, &nArrayIndex)){
         return 0;
     }
 
     if (!g_OMX_CONF_pInFile[nArrayIndex]) return 0;
 
-    return (OMX_U32)fread(pData, 1, nBytes, g_OMX_CONF_pInFile[nArrayIndex]);
+    nStart = OMX_OSAL_GetTimeNs();
+    nRetVal = OMX_OSAL_InputFileCopy(nArrayIndex, pData, nBytes);
+    OMX_OSAL_InputFileAccount(nArrayIndex, nRetVal, nStart);
+    return nRetVal;
 }
 
 OMX_U32 OMX_OSAL_ReadFromInputFileWithSize( OMX_OUT OMX_PTR pData, OMX_IN OMX_U32 nMaxBytes, OMX_IN OMX_U32 nPortIndex)
 {
     OMX_U32 nArrayIndex;
-    OMX_U32 nBytes = nMaxBytes;
-    OMX_U32 nCurrent;
+    OMX_U32 nBytes;
     OMX_U32 nRetVal = 0;
+    OMX_U64 nStart;
 
     if ( OMX_ErrorNone != OMX_OSAL_PortIndexToArrayIndex(nPortIndex, &nArrayIndex)){
         return 0;
@@ -556,25 +3432,105 @@ OMX_U32 OMX_OSAL_ReadFromInputFileWithSize( OMX_OUT OMX_PTR pData, OMX_IN OMX_U3
 
     if (!g_OMX_CONF_pInFile[nArrayIndex]) return 0;
 
-    nCurrent = g_OMX_CONF_pInFileSizes[nArrayIndex].nCurrent;
+    nStart = OMX_OSAL_GetTimeNs();
+    nBytes = OMX_OSAL_InputFileNextSize(nArrayIndex, nMaxBytes);
+    nRetVal = OMX_OSAL_InputFileCopy(nArrayIndex, pData, nBytes);
 
-    if (g_OMX_CONF_pInFileSizes[nArrayIndex].pSizes)
-    {
-        if (nCurrent < g_OMX_CONF_pInFileSizes[nArrayIndex].nEntries)
-        {
-            if (g_OMX_CONF_pInFileSizes[nArrayIndex].pSizes[nCurrent] < nBytes)
-                nBytes = g_OMX_CONF_pInFileSizes[nArrayIndex].pSizes[nCurrent];
-            g_OMX_CONF_pInFileSizes[nArrayIndex].nCurrent += 1;
-        }
-        else
-            g_OMX_CONF_pInFileSizes[nArrayIndex].bEOS = OMX_TRUE;
+    if (nRetVal != nBytes)
+        g_OMX_CONF_pInFileSizes[nArrayIndex].bEOS = OMX_TRUE;
+
+    OMX_OSAL_InputFileAccount(nArrayIndex, nRetVal, nStart);
+    return nRetVal;
+}
+
+OMX_ERRORTYPE OMX_OSAL_AllocInputFileBuffer( OMX_IN OMX_U32 nBytes, OMX_OUT OMX_PTR *ppBuffer )
+{
+    size_t nPageSize = (size_t)sysconf(_SC_PAGESIZE);
+    void *pBuffer;
+
+    if (!ppBuffer || !nBytes) return OMX_ErrorBadParameter;
+
+    pBuffer = mmap(NULL, (nBytes + nPageSize - 1) & ~(nPageSize - 1), PROT_READ | PROT_WRITE, 
+                   MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (pBuffer == MAP_FAILED) {
+        *ppBuffer = NULL;
+        return OMX_ErrorInsufficientResources;
+    }
+    *ppBuffer = pBuffer;
+    return OMX_ErrorNone;
+}
+
+void OMX_OSAL_FreeInputFileBuffer( OMX_IN OMX_PTR pBuffer, OMX_IN OMX_U32 nBytes )
+{
+    size_t nPageSize = (size_t)sysconf(_SC_PAGESIZE);
+
+    if (pBuffer) munmap(pBuffer, (nBytes + nPageSize - 1) & ~(nPageSize - 1));
+}
+
+OMX_U32 OMX_OSAL_InputFileBufferAlignment()
+{
+    return (OMX_U32)sysconf(_SC_PAGESIZE);
+}
+
+OMX_U32 OMX_OSAL_ReadFromInputFileInPlace( OMX_IN OMX_PTR pBuffer, OMX_IN OMX_U32 nAllocLen, 
+                                           OMX_OUT OMX_U32 *pnOffset, OMX_IN OMX_U32 nPortIndex )
+{
+    OMX_OSAL_INFILEVIEWTYPE *pView;
+    size_t nPageSize = (size_t)sysconf(_SC_PAGESIZE);
+    size_t nPageOffset, nMapLen;
+    OMX_U32 nArrayIndex;
+    OMX_U32 nBytes;
+    OMX_U32 nRetVal = 0;
+    OMX_U64 nStart;
+
+    *pnOffset = 0;
+    if ( OMX_ErrorNone != OMX_OSAL_PortIndexToArrayIndex(nPortIndex, &nArrayIndex)){
+        return 0;
     }
 
-    nRetVal = (OMX_U32)fread(pData, 1, nBytes, g_OMX_CONF_pInFile[nArrayIndex]);
+    if (!g_OMX_CONF_pInFile[nArrayIndex]) return 0;
+
+    nStart = OMX_OSAL_GetTimeNs();
+    pView = &g_OMX_OSAL_InFileView[nArrayIndex];
+    nBytes = OMX_OSAL_InputFileNextSize(nArrayIndex, nAllocLen);
 
+    nPageOffset = pView->nPos & (nPageSize - 1);
+    if (pView->pMap && !((size_t)pBuffer & (nPageSize - 1)) && nPageOffset < nAllocLen) {
+        /* without a .length file the input is a plain byte stream, so a short read
+         * that brings the file position back onto a page boundary costs nothing */
+        if (!g_OMX_CONF_pInFileSizes[nArrayIndex].pSizes && !pView->pFrames && nPageOffset + nBytes > nAllocLen) {
+            nBytes = nAllocLen - (OMX_U32)nPageOffset;
+        }
+        if (nPageOffset + nBytes <= nAllocLen) {
+            nRetVal = nBytes;
+            if (nRetVal > pView->nMapSize - pView->nPos) {
+                nRetVal = (OMX_U32)(pView->nMapSize - pView->nPos);
+            }
+            nMapLen = (nPageOffset + nRetVal + nPageSize - 1) & ~(nPageSize - 1);
+            if (nRetVal && mmap(pBuffer, nMapLen, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_FIXED, 
+                                fileno(g_OMX_CONF_pInFile[nArrayIndex]), 
+                                (off_t)(pView->nPos - nPageOffset)) != MAP_FAILED) {
+                /* private mapping: whatever the component writes never reaches the file */
+                *pnOffset = (OMX_U32)nPageOffset;
+                if (pView->pQueue)
+                    OMX_OSAL_FileQueueRead(pView->pQueue, NULL, nRetVal);
+                pView->nPos += nRetVal;
+                pView->nInPlace++;
+                goto done;
+            }
+            if (nRetVal) {
+                /* a failed fixed mapping may have dropped the old pages */
+                mmap(pBuffer, nMapLen, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED, -1, 0);
+            }
+        }
+    }
+    nRetVal = OMX_OSAL_InputFileCopy(nArrayIndex, pBuffer, nBytes);
+
+done:
     if (nRetVal != nBytes)
         g_OMX_CONF_pInFileSizes[nArrayIndex].bEOS = OMX_TRUE;
 
+    OMX_OSAL_InputFileAccount(nArrayIndex, nRetVal, nStart);
     return nRetVal;
 }
 
@@ -594,6 +3550,7 @@ OMX_BOOL OMX_OSAL_InputFileAtEOS(OMX_IN OMX_U32 nPortIndex)
 
 OMX_ERRORTYPE OMX_OSAL_CloseInputFile( OMX_IN OMX_U32 nPortIndex )
 {
+    OMX_OSAL_INFILEVIEWTYPE *pView;
     OMX_U32 nArrayIndex;
     if ( OMX_ErrorNone != OMX_OSAL_PortIndexToArrayIndex(nPortIndex, &nArrayIndex)){
         return OMX_ErrorBadParameter;
@@ -601,6 +3558,26 @@ OMX_ERRORTYPE OMX_OSAL_CloseInputFile( OMX_IN OMX_U32 nPortIndex )
 
     if (!g_OMX_CONF_pInFile[nArrayIndex]) return OMX_ErrorBadParameter;
 
+    pView = &g_OMX_OSAL_InFileView[nArrayIndex];
+    if (pView->nReads) {
+        OMX_U64 nUsec = pView->nReadNs / 1000;
+        OMX_OSAL_Trace(OMX_OSAL_TRACE_INFO, 
+                       "Input port %d: %u KB in %u reads (%u in place, %s), %u.%03u ms, %u MB/s\n",
+                       nPortIndex, (OMX_U32)(pView->nBytesRead >> 10), pView->nReads, pView->nInPlace, 
+                       pView->pMap ? "mmap" : "fread", (OMX_U32)(nUsec / 1000), (OMX_U32)(nUsec % 1000), 
+                       (OMX_U32)(nUsec ? pView->nBytesRead / nUsec : 0));
+    }
+    if (pView->pQueue) {
+        OMX_OSAL_FileQueueClose(pView->pQueue, OMX_FALSE);
+    }
+    if (pView->pMap) {
+        munmap(pView->pMap, pView->nMapSize);
+    }
+    if (pView->pIndex) {
+        munmap(pView->pIndex, pView->nIndexSize);
+    }
+    memset(pView, 0, sizeof(*pView));
+
     if (fclose(g_OMX_CONF_pInFile[nArrayIndex])) 
     {
         return OMX_ErrorUndefined;
@@ -619,11 +3596,116 @@ OMX_ERRORTYPE OMX_OSAL_CloseInputFile( OMX_IN OMX_U32 nPortIndex )
     return OMX_ErrorNone;
 }
 
+OMX_U32 OMX_OSAL_InputFileFrameCount( OMX_IN OMX_U32 nPortIndex )
+{
+    OMX_U32 nArrayIndex;
+
+    if ( OMX_ErrorNone != OMX_OSAL_PortIndexToArrayIndex(nPortIndex, &nArrayIndex)){
+        return 0;
+    }
+    if (!g_OMX_CONF_pInFile[nArrayIndex] || !g_OMX_OSAL_InFileView[nArrayIndex].pFrames) return 0;
+
+    return g_OMX_CONF_pInFileSizes[nArrayIndex].nEntries;
+}
+
+OMX_ERRORTYPE OMX_OSAL_InputFileGetFrame( OMX_IN OMX_U32 nPortIndex, OMX_IN OMX_U32 nFrame, 
+                                          OMX_OUT OMX_OSAL_FRAMEINFOTYPE *pFrame )
+{
+    OMX_U32 nArrayIndex;
+
+    if ( OMX_ErrorNone != OMX_OSAL_PortIndexToArrayIndex(nPortIndex, &nArrayIndex)){
+        return OMX_ErrorBadParameter;
+    }
+    if (!g_OMX_CONF_pInFile[nArrayIndex] || !g_OMX_OSAL_InFileView[nArrayIndex].pFrames) return OMX_ErrorNotImplemented;
+    if (nFrame >= g_OMX_CONF_pInFileSizes[nArrayIndex].nEntries) return OMX_ErrorBadParameter;
+
+    *pFrame = g_OMX_OSAL_InFileView[nArrayIndex].pFrames[nFrame];
+    return OMX_ErrorNone;
+}
+
+OMX_ERRORTYPE OMX_OSAL_InputFileSeekFrame( OMX_IN OMX_U32 nPortIndex, OMX_IN OMX_U32 nFrame )
+{
+    OMX_OSAL_INFILEVIEWTYPE *pView;
+    OMX_U32 nArrayIndex;
+
+    if ( OMX_ErrorNone != OMX_OSAL_PortIndexToArrayIndex(nPortIndex, &nArrayIndex)){
+        return OMX_ErrorBadParameter;
+    }
+    pView = &g_OMX_OSAL_InFileView[nArrayIndex];
+    if (!g_OMX_CONF_pInFile[nArrayIndex] || !pView->pFrames) return OMX_ErrorNotImplemented;
+    if (nFrame > g_OMX_CONF_pInFileSizes[nArrayIndex].nEntries) return OMX_ErrorBadParameter;
+
+    g_OMX_CONF_pInFileSizes[nArrayIndex].nCurrent = nFrame;
+    g_OMX_CONF_pInFileSizes[nArrayIndex].bEOS = OMX_FALSE;
+    if (nFrame < g_OMX_CONF_pInFileSizes[nArrayIndex].nEntries)
+        OMX_OSAL_InputFileSetPos(nArrayIndex, pView->pFrames[nFrame].nOffset);
+    return OMX_ErrorNone;
+}
+
+OMX_ERRORTYPE OMX_OSAL_ConvertBufferVarianceFile( OMX_IN OMX_STRING sLengthFileName, 
+                                                  OMX_IN OMX_STRING sIndexFileName )
+{
+    OMX_OSAL_FRAMEINDEXHEADERTYPE oHeader;
+    OMX_OSAL_FRAMEINFOTYPE oFrame;
+    OMX_CONF_INFILEPORTSETTINGTYPE *pSettings = NULL;
+    OMX_U32 *pSizes = NULL;
+    OMX_U8 sPortIndex[16];
+    OMX_U32 nSettings = 0, nFrames = 0, nMaxSize = 0, i;
+    OMX_U64 nPad = 0;
+    OMX_ERRORTYPE eError = OMX_ErrorNone;
+    FILE *pIn, *pOut;
+
+    pIn = fopen(sLengthFileName, "r");
+    if (!pIn) return OMX_ErrorBadParameter;
+    eError = OMX_OSAL_ReadBufferVarianceFile(sPortIndex, &nSettings, &pSettings, &nFrames, &nMaxSize, &pSizes, pIn);
+    fclose(pIn);
+    if (eError != OMX_ErrorNone) return eError;
+
+    pOut = fopen(sIndexFileName, "wb");
+    if (!pOut) {
+        eError = OMX_ErrorUndefined;
+        goto cleanup;
+    }
+
+    memset(&oHeader, 0, sizeof(oHeader));
+    oHeader.nMagic = OMX_OSAL_FRAMEINDEX_MAGIC;
+    oHeader.nVersion = OMX_OSAL_FRAMEINDEX_VERSION;
+    for (i = 0; i < sizeof(oHeader.sPortIndex) - 1 && sPortIndex[i] && 
+                sPortIndex[i] != '\n' && sPortIndex[i] != '\r'; i++)
+        oHeader.sPortIndex[i] = sPortIndex[i];
+    oHeader.nSettings = nSettings;
+    oHeader.nMaxFrameSize = nMaxSize;
+    oHeader.nFrames = nFrames;
+    oHeader.nFramesOffset = (sizeof(oHeader) + nSettings * sizeof(OMX_CONF_INFILEPORTSETTINGTYPE) + 7) & ~(OMX_U64)7;
+
+    /* the text format has sizes only; frames are back to back and untimed */
+    if (fwrite(&oHeader, sizeof(oHeader), 1, pOut) != 1 ||
+        (nSettings && fwrite(pSettings, sizeof(OMX_CONF_INFILEPORTSETTINGTYPE), nSettings, pOut) != nSettings) ||
+        fwrite(&nPad, 1, (size_t)(oHeader.nFramesOffset - sizeof(oHeader) - 
+                                   nSettings * sizeof(OMX_CONF_INFILEPORTSETTINGTYPE)), pOut) != 
+               (size_t)(oHeader.nFramesOffset - sizeof(oHeader) - nSettings * sizeof(OMX_CONF_INFILEPORTSETTINGTYPE))) {
+        eError = OMX_ErrorUndefined;
+    }
+    memset(&oFrame, 0, sizeof(oFrame));
+    for (i = 0; i < nFrames && eError == OMX_ErrorNone; i++) {
+        oFrame.nSize = pSizes[i];
+        if (fwrite(&oFrame, sizeof(oFrame), 1, pOut) != 1) eError = OMX_ErrorUndefined;
+        oFrame.nOffset += pSizes[i];
+    }
+    if (fclose(pOut) && eError == OMX_ErrorNone) eError = OMX_ErrorUndefined;
+
+cleanup:
+    if (pSettings && nSettings) free(pSettings);
+    if (pSizes) OMX_OSAL_Free(pSizes);
+    return eError;
+}
+
 /**********************************************************************
  * OUTPUT FILE MAPPING
  **********************************************************************/
 
 FILE *g_OMX_CONF_pOutFile[OMX_CONF_MAXOUTFILEMAPPINGS];
+OMX_OSAL_FILEQUEUETYPE *g_OMX_OSAL_pOutFileQueue[OMX_CONF_MAXOUTFILEMAPPINGS];
 
 OMX_ERRORTYPE OMX_OSAL_OutPortIndexToArrayIndex( OMX_IN OMX_U32 nPortIndex, OMX_OUT OMX_U32 *pArrayIndex )
 {
@@ -649,6 +3731,7 @@ OMX_ERRORTYPE OMX_OSAL_OpenOutputFile( OMX_IN OMX_U32 nPortIndex )
 
     if (!g_OMX_CONF_pOutFile[nArrayIndex]) return OMX_ErrorUndefined;
 
+    g_OMX_OSAL_pOutFileQueue[nArrayIndex] = OMX_OSAL_FileQueueCreate(g_OMX_CONF_pOutFile[nArrayIndex], NULL, 0, 0, OMX_TRUE);
     return OMX_ErrorNone;
 }
 
@@ -661,11 +3744,16 @@ OMX_U32 OMX_OSAL_WriteToOutputFile( OMX_OUT OMX_PTR pData, OMX_IN OMX_U32 nBytes
 
     if (!g_OMX_CONF_pOutFile[nArrayIndex]) return 0;
 
+    if (g_OMX_OSAL_pOutFileQueue[nArrayIndex]) {
+        OMX_OSAL_FileQueueWrite(g_OMX_OSAL_pOutFileQueue[nArrayIndex], (OMX_U8 *)pData, nBytes);
+        return nBytes;
+    }
     return (OMX_U32)fwrite(pData, 1, nBytes, g_OMX_CONF_pOutFile[nArrayIndex]);
 }
 
 OMX_ERRORTYPE OMX_OSAL_CloseOutputFile( OMX_IN OMX_U32 nPortIndex )
 {
+    OMX_BOOL bWritten = OMX_TRUE;
     OMX_U32 nArrayIndex;
     if ( OMX_ErrorNone != OMX_OSAL_OutPortIndexToArrayIndex(nPortIndex, &nArrayIndex)){
         return OMX_ErrorBadParameter;
@@ -673,10 +3761,19 @@ OMX_ERRORTYPE OMX_OSAL_CloseOutputFile( OMX_IN OMX_U32 nPortIndex )
     
     if (!g_OMX_CONF_pOutFile[nArrayIndex]) return OMX_ErrorBadParameter;
 
+    /* flush the write behind before the file goes away */
+    if (g_OMX_OSAL_pOutFileQueue[nArrayIndex]) {
+        bWritten = OMX_OSAL_FileQueueClose(g_OMX_OSAL_pOutFileQueue[nArrayIndex], OMX_TRUE);
+        g_OMX_OSAL_pOutFileQueue[nArrayIndex] = NULL;
+        if (!bWritten) {
+            OMX_OSAL_Trace(OMX_OSAL_TRACE_ERROR, "Writing output file for port %d failed\n", nPortIndex);
+        }
+    }
+
     if (fclose(g_OMX_CONF_pOutFile[nArrayIndex])) return OMX_ErrorUndefined;
     g_OMX_CONF_pOutFile[nArrayIndex] = 0;
 
-    return OMX_ErrorNone;
+    return bWritten ? OMX_ErrorNone : OMX_ErrorUndefined;
 }
 
 /***********************************************************************
@@ -691,6 +3788,7 @@ OMX_ERRORTYPE OMX_OSAL_ProcessCommandsFromFile(OMX_STRING sFileName)
     fptr = fopen(sFileName, "r");
     if (!fptr) {
         OMX_OSAL_Trace(OMX_OSAL_TRACE_ERROR, "Failed to open script file %s\n", sFileName);
+        OMX_OSAL_TraceFlush();
         exit(1);
     }
     
@@ -701,6 +3799,7 @@ OMX_ERRORTYPE OMX_OSAL_ProcessCommandsFromFile(OMX_STRING sFileName)
             while (sLine[len-1] == '\n' || sLine[len-1] == '\r')
                 sLine[--len] = 0;
             OMX_CONF_ParseCommand(sLine);  
+            OMX_OSAL_TraceFlush();
         }
     }
     fclose(fptr);
@@ -720,6 +3819,7 @@ OMX_ERRORTYPE OMX_OSAL_ProcessCommandsFromPrompt()
             while (sLine[len-1] == '\n' || sLine[len-1] == '\r')
                 sLine[--len] = 0;
             OMX_CONF_ParseCommand(sLine);  
+            OMX_OSAL_TraceFlush();
         }
     } while (1 != strlen(sLine) || ('q' != tolower(sLine[0])));
 
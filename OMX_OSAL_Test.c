@@ -21,6 +21,8 @@
 #include "OMX_OSAL_Interfaces.h"
 #include "OMX_CONF_TestHarness.h"
 
+#include <string.h>
+
 #define OMX_OSAL_TESTERR( eError ) if( OMX_ErrorNone != eError ) {                            \
         OMX_OSAL_Trace(OMX_OSAL_TRACE_ERROR, "%s:%d Error %x\n", __FILE__, __LINE__, eError); \
         goto OMX_OSAL_TEST_BAIL;                                                              \
@@ -61,6 +63,72 @@ OMX_ERRORTYPE OMX_OSAL_MemoryTest1(OMX_IN OMX_STRING cComponentName)
 }
 
 
+/* ******************************************************************
+ *  Buffer pool test 1:
+ * ******************************************************************
+ *  Aligned and contiguous buffer allocation. Buffers must honour the
+ *  requested alignment and a freed buffer must be handed out again
+ *  for the next request of the same size class.
+ */
+#define BUFFERPOOL_TEST1_NUMBUFFERS 8
+#define BUFFERPOOL_TEST1_SIZE       (100*1024)
+
+OMX_ERRORTYPE OMX_OSAL_BufferPoolTest1(OMX_IN OMX_STRING cComponentName)
+{
+    OMX_ERRORTYPE eError = OMX_ErrorNone;
+    OMX_U8 *pBuffer[BUFFERPOOL_TEST1_NUMBUFFERS];
+    OMX_U8 *pFreed;
+    OMX_U32 nAlignment[] = {0, 64, 128, 4096};
+    OMX_U32 i, j;
+
+    UNUSED_PARAMETER(cComponentName);
+
+    for (j = 0; j < sizeof(nAlignment)/sizeof(nAlignment[0]) && eError == OMX_ErrorNone; j++)
+    {
+        for (i = 0; i < BUFFERPOOL_TEST1_NUMBUFFERS; i++) {
+            pBuffer[i] = OMX_OSAL_MallocBuffer(BUFFERPOOL_TEST1_SIZE, OMX_FALSE, nAlignment[j]);
+            if (!pBuffer[i] || (nAlignment[j] && ((OMX_U32)(size_t)pBuffer[i] & (nAlignment[j]-1)))) {
+                OMX_OSAL_Trace(OMX_OSAL_TRACE_ERROR, "Buffer %d misaligned for alignment %d\n", i, nAlignment[j]);
+                eError = OMX_ErrorUndefined;
+            }
+            if (pBuffer[i]) memset(pBuffer[i], (int)i, BUFFERPOOL_TEST1_SIZE);
+        }
+
+        /* released buffer should be reused by the next allocation of that size */
+        pFreed = pBuffer[BUFFERPOOL_TEST1_NUMBUFFERS/2];
+        OMX_OSAL_FreeBuffer(pFreed, OMX_FALSE, nAlignment[j]);
+        pBuffer[BUFFERPOOL_TEST1_NUMBUFFERS/2] = OMX_OSAL_MallocBuffer(BUFFERPOOL_TEST1_SIZE, OMX_FALSE, nAlignment[j]);
+        if (pBuffer[BUFFERPOOL_TEST1_NUMBUFFERS/2] != pFreed) {
+            OMX_OSAL_Trace(OMX_OSAL_TRACE_ERROR, "Freed buffer was not reused (alignment %d)\n", nAlignment[j]);
+            eError = OMX_ErrorUndefined;
+        }
+
+        for (i = 0; i < BUFFERPOOL_TEST1_NUMBUFFERS; i++) {
+            if (pBuffer[i]) OMX_OSAL_FreeBuffer(pBuffer[i], OMX_FALSE, nAlignment[j]);
+        }
+    }
+
+    /* contiguous buffers */
+    for (i = 0; i < BUFFERPOOL_TEST1_NUMBUFFERS; i++) {
+        pBuffer[i] = OMX_OSAL_MallocBuffer(BUFFERPOOL_TEST1_SIZE, OMX_TRUE, 4096);
+        if (!pBuffer[i] || ((OMX_U32)(size_t)pBuffer[i] & 4095)) {
+            OMX_OSAL_Trace(OMX_OSAL_TRACE_ERROR, "Contiguous buffer %d failed or misaligned\n", i);
+            eError = OMX_ErrorUndefined;
+        }
+    }
+    for (i = 0; i < BUFFERPOOL_TEST1_NUMBUFFERS; i++) {
+        if (pBuffer[i]) OMX_OSAL_FreeBuffer(pBuffer[i], OMX_TRUE, 4096);
+    }
+
+    /* with everything returned the pools can be released */
+    if (OMX_ErrorNone != OMX_OSAL_BufferPoolRelease()) {
+        eError = OMX_ErrorUndefined;
+    }
+
+    return eError;
+}
+
+
 /* ******************************************************************
  *  Multi-thread test 1:
  * ******************************************************************
@@ -288,6 +356,509 @@ OMX_OSAL_TEST_BAIL:
     return eError;
 }
 
+/* ******************************************************************
+ *  Thread pool test 1:
+ * ******************************************************************
+ *  Work items that block on each other must all be running at the
+ *  same time, return values must come back through the wait, and a
+ *  cancelled item must never run. Also compares the cost of a pooled
+ *  work item against creating and joining a thread.
+ */
+#define THREADPOOL_TEST1_NUMITEMS 8
+#define THREADPOOL_TEST1_LOOPSIZE 200
+
+typedef struct SThreadPoolTest1Param 
+{
+    OMX_HANDLETYPE  oMutex;
+    OMX_HANDLETYPE  oAllStarted;
+    OMX_U32 *       pStarted;
+    OMX_U32         nIndex;
+} ThreadPoolTest1Param;
+
+OMX_U32 ThreadPoolTest1Func(OMX_PTR pParam)
+{
+    ThreadPoolTest1Param *pData = (ThreadPoolTest1Param *)pParam;
+    OMX_BOOL bTimeout = OMX_FALSE;
+
+    OMX_OSAL_MutexLock( pData->oMutex );
+    if (++(*pData->pStarted) == THREADPOOL_TEST1_NUMITEMS) {
+        OMX_OSAL_EventSet( pData->oAllStarted );
+    }
+    OMX_OSAL_MutexUnlock( pData->oMutex );
+
+    /* only completes if every item got a thread of its own */
+    OMX_OSAL_EventWait( pData->oAllStarted, OMX_CONF_TIMEOUT_EXPECTING_SUCCESS, &bTimeout );
+    return bTimeout ? 0 : pData->nIndex + 1;
+}
+
+OMX_U32 ThreadPoolTest1EmptyFunc(OMX_PTR pParam)
+{
+    UNUSED_PARAMETER(pParam);
+    return 0;
+}
+
+OMX_U32 ThreadPoolTest1CancelledFunc(OMX_PTR pParam)
+{
+    *(OMX_U32 *)pParam = 1;
+    return 0;
+}
+
+OMX_ERRORTYPE OMX_OSAL_ThreadPoolTest1(OMX_IN OMX_STRING cComponentName)
+{
+    OMX_ERRORTYPE           eError = OMX_ErrorNone;
+    OMX_HANDLETYPE          oWork[THREADPOOL_TEST1_NUMITEMS];
+    ThreadPoolTest1Param    oParams[THREADPOOL_TEST1_NUMITEMS];
+    OMX_HANDLETYPE          oMutex = 0;
+    OMX_HANDLETYPE          oAllStarted = 0;
+    OMX_HANDLETYPE          hWork;
+    OMX_U32                 nStarted = 0;
+    OMX_U32                 nCancelledRan = 0;
+    OMX_U32                 nIndex;
+    OMX_U32                 uReturn;
+    OMX_U64                 nBegin, nEnd;
+
+    UNUSED_PARAMETER(cComponentName);
+
+    for(nIndex = 0; nIndex < THREADPOOL_TEST1_NUMITEMS; nIndex++) {
+        oWork[nIndex] = 0; 
+    }
+
+    eError = OMX_OSAL_MutexCreate( &oMutex ); 
+    OMX_OSAL_TESTERR( eError );
+    eError = OMX_OSAL_EventCreate( &oAllStarted ); 
+    OMX_OSAL_TESTERR( eError );
+
+    /* items that wait on each other, first one pinned to cpu 0 */
+    for(nIndex = 0; nIndex < THREADPOOL_TEST1_NUMITEMS; nIndex++) {
+        oParams[nIndex].oMutex      = oMutex;
+        oParams[nIndex].oAllStarted = oAllStarted;
+        oParams[nIndex].pStarted    = &nStarted;
+        oParams[nIndex].nIndex      = nIndex;
+        eError = OMX_OSAL_ThreadPoolSubmit( ThreadPoolTest1Func, (OMX_PTR) &oParams[nIndex],
+                                            0, nIndex ? 0 : 1, &oWork[nIndex] );
+        OMX_OSAL_TESTERR( eError );
+    }
+    for(nIndex = 0; nIndex < THREADPOOL_TEST1_NUMITEMS; nIndex++) {
+        eError = OMX_OSAL_ThreadPoolWait( oWork[nIndex], &uReturn );
+        oWork[nIndex] = 0;
+        OMX_OSAL_TESTERR( eError );
+        if (uReturn != nIndex + 1) {
+            OMX_OSAL_Trace(OMX_OSAL_TRACE_ERROR, "Work item %d returned %d\n", nIndex, uReturn);
+            eError = OMX_ErrorUndefined;
+        }
+    }
+    OMX_OSAL_TESTERR( eError );
+
+    /* cancelling either removes the item or tells us it already started */
+    eError = OMX_OSAL_ThreadPoolSubmit( ThreadPoolTest1CancelledFunc, (OMX_PTR) &nCancelledRan, 0, 0, &hWork );
+    OMX_OSAL_TESTERR( eError );
+    eError = OMX_OSAL_ThreadPoolCancel( hWork );
+    if (eError == OMX_ErrorNotReady) {
+        eError = OMX_OSAL_ThreadPoolWait( hWork, NULL );
+    }
+    else if (eError == OMX_ErrorNone && nCancelledRan) {
+        OMX_OSAL_Trace(OMX_OSAL_TRACE_ERROR, "Cancelled work item ran\n");
+        eError = OMX_ErrorUndefined;
+    }
+    OMX_OSAL_TESTERR( eError );
+
+    /* cost of pooled work against a thread of its own */
+    nBegin = OMX_OSAL_GetTimeNs();
+    for(nIndex = 0; nIndex < THREADPOOL_TEST1_LOOPSIZE; nIndex++) {
+        eError = OMX_OSAL_ThreadPoolSubmit( ThreadPoolTest1EmptyFunc, 0, 0, 0, &hWork );
+        OMX_OSAL_TESTERR( eError );
+        OMX_OSAL_ThreadPoolWait( hWork, NULL );
+    }
+    nEnd = OMX_OSAL_GetTimeNs();
+    OMX_OSAL_Trace(OMX_OSAL_TRACE_INFO, "Pooled work item: %u ns\n", 
+                   (OMX_U32)((nEnd - nBegin) / THREADPOOL_TEST1_LOOPSIZE));
+
+    nBegin = OMX_OSAL_GetTimeNs();
+    for(nIndex = 0; nIndex < THREADPOOL_TEST1_LOOPSIZE; nIndex++) {
+        eError = OMX_OSAL_ThreadCreate( ThreadPoolTest1EmptyFunc, 0, 0, &hWork );
+        OMX_OSAL_TESTERR( eError );
+        OMX_OSAL_ThreadDestroy( hWork );
+    }
+    nEnd = OMX_OSAL_GetTimeNs();
+    OMX_OSAL_Trace(OMX_OSAL_TRACE_INFO, "Thread create/destroy: %u ns\n", 
+                   (OMX_U32)((nEnd - nBegin) / THREADPOOL_TEST1_LOOPSIZE));
+
+OMX_OSAL_TEST_BAIL:
+    for(nIndex = 0; nIndex < THREADPOOL_TEST1_NUMITEMS; nIndex++) {
+        if( oWork[nIndex] ) OMX_OSAL_ThreadPoolWait( oWork[nIndex], NULL ); 
+    }
+    if( oAllStarted ) OMX_OSAL_EventDestroy( oAllStarted );
+    if( oMutex ) OMX_OSAL_MutexDestroy( oMutex );
+    return eError;
+}
+
+/* ******************************************************************
+ *  Queue test 1:
+ * ******************************************************************
+ *  A pop on an empty queue must time out, a push on a full queue must
+ *  fail and entries must come back in order. Then several producers and
+ *  consumers share one queue; every entry pushed must be popped exactly
+ *  once. Also measures the cost of a push/pop pair.
+ */
+#define QUEUE_TEST1_NUMPRODUCERS 4
+#define QUEUE_TEST1_NUMCONSUMERS 4
+#define QUEUE_TEST1_NUMENTRIES   10000
+#define QUEUE_TEST1_SIZE         64
+#define QUEUE_TEST1_LOOPSIZE     100000
+
+typedef struct SQueueTest1Param 
+{
+    OMX_HANDLETYPE  oQueue;
+    OMX_U8 *        pSeen;
+    OMX_U32         nIndex;
+} QueueTest1Param;
+
+OMX_U32 QueueTest1ProducerFunc(OMX_PTR pParam)
+{
+    QueueTest1Param *pData = (QueueTest1Param *)pParam;
+    OMX_U32 nEntry;
+
+    /* entries are 1 based so that none of them is NULL */
+    for(nEntry = pData->nIndex + 1; nEntry <= QUEUE_TEST1_NUMENTRIES; nEntry += QUEUE_TEST1_NUMPRODUCERS) {
+        if (OMX_OSAL_QueuePush( pData->oQueue, (OMX_PTR)(size_t)nEntry ) != OMX_ErrorNone) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+OMX_U32 QueueTest1ConsumerFunc(OMX_PTR pParam)
+{
+    QueueTest1Param *pData = (QueueTest1Param *)pParam;
+    OMX_PTR pEntry;
+    OMX_U32 nErrors = 0;
+
+    /* a NULL entry tells the consumer to stop */
+    while(OMX_OSAL_QueuePop( pData->oQueue, OMX_CONF_TIMEOUT_EXPECTING_SUCCESS, &pEntry ) == OMX_ErrorNone) {
+        if (!pEntry) {
+            return nErrors;
+        }
+        if ((size_t)pEntry > QUEUE_TEST1_NUMENTRIES || pData->pSeen[(size_t)pEntry - 1]++) {
+            nErrors++;
+        }
+    }
+    return nErrors + 1;
+}
+
+OMX_ERRORTYPE OMX_OSAL_QueueTest1(OMX_IN OMX_STRING cComponentName)
+{
+    OMX_ERRORTYPE       eError = OMX_ErrorNone;
+    OMX_HANDLETYPE      oProducer[QUEUE_TEST1_NUMPRODUCERS];
+    OMX_HANDLETYPE      oConsumer[QUEUE_TEST1_NUMCONSUMERS];
+    QueueTest1Param     oProducerParams[QUEUE_TEST1_NUMPRODUCERS];
+    QueueTest1Param     oConsumerParams[QUEUE_TEST1_NUMCONSUMERS];
+    OMX_HANDLETYPE      oQueue = 0;
+    OMX_U8 *            pSeen = 0;
+    OMX_PTR             pEntry;
+    OMX_U32             nIndex;
+    OMX_U32             uReturn;
+    OMX_U64             nBegin, nEnd;
+
+    UNUSED_PARAMETER(cComponentName);
+
+    for(nIndex = 0; nIndex < QUEUE_TEST1_NUMPRODUCERS; nIndex++) {
+        oProducer[nIndex] = 0; 
+    }
+    for(nIndex = 0; nIndex < QUEUE_TEST1_NUMCONSUMERS; nIndex++) {
+        oConsumer[nIndex] = 0; 
+    }
+
+    pSeen = (OMX_U8*)OMX_OSAL_Malloc(QUEUE_TEST1_NUMENTRIES);
+    if (!pSeen) OMX_OSAL_TESTERR(OMX_ErrorInsufficientResources);
+    memset(pSeen, 0, QUEUE_TEST1_NUMENTRIES);
+
+    eError = OMX_OSAL_QueueCreate( QUEUE_TEST1_SIZE, &oQueue ); 
+    OMX_OSAL_TESTERR( eError );
+
+    /* empty queue */
+    eError = OMX_OSAL_QueuePop( oQueue, 0, &pEntry );
+    if (eError != OMX_ErrorTimeout) OMX_OSAL_TESTERR( OMX_ErrorUndefined );
+    eError = OMX_OSAL_QueuePop( oQueue, 10, &pEntry );
+    if (eError != OMX_ErrorTimeout) OMX_OSAL_TESTERR( OMX_ErrorUndefined );
+    eError = OMX_OSAL_QueuePeek( oQueue, &pEntry );
+    if (eError != OMX_ErrorNotReady) OMX_OSAL_TESTERR( OMX_ErrorUndefined );
+
+    /* full queue, entries come back in order */
+    for(nIndex = 0; ; nIndex++) {
+        if (OMX_OSAL_QueuePush( oQueue, (OMX_PTR)(size_t)(nIndex + 1) ) != OMX_ErrorNone) break;
+    }
+    if (nIndex < QUEUE_TEST1_SIZE || OMX_OSAL_QueueCount( oQueue ) != nIndex) {
+        OMX_OSAL_Trace(OMX_OSAL_TRACE_ERROR, "Queue of %d held %d entries\n", QUEUE_TEST1_SIZE, nIndex);
+        OMX_OSAL_TESTERR( OMX_ErrorUndefined );
+    }
+    eError = OMX_OSAL_QueuePeek( oQueue, &pEntry );
+    OMX_OSAL_TESTERR( eError );
+    if ((size_t)pEntry != 1) OMX_OSAL_TESTERR( OMX_ErrorUndefined );
+    for(uReturn = 0; uReturn < nIndex; uReturn++) {
+        eError = OMX_OSAL_QueuePop( oQueue, 0, &pEntry );
+        OMX_OSAL_TESTERR( eError );
+        if ((size_t)pEntry != uReturn + 1) OMX_OSAL_TESTERR( OMX_ErrorUndefined );
+    }
+
+    /* producers and consumers at the same time, room for every entry */
+    OMX_OSAL_QueueDestroy( oQueue );
+    oQueue = 0;
+    eError = OMX_OSAL_QueueCreate( QUEUE_TEST1_NUMENTRIES + QUEUE_TEST1_NUMCONSUMERS, &oQueue ); 
+    OMX_OSAL_TESTERR( eError );
+    for(nIndex = 0; nIndex < QUEUE_TEST1_NUMCONSUMERS; nIndex++) {
+        oConsumerParams[nIndex].oQueue = oQueue;
+        oConsumerParams[nIndex].pSeen  = pSeen;
+        oConsumerParams[nIndex].nIndex = nIndex;
+        eError = OMX_OSAL_ThreadPoolSubmit( QueueTest1ConsumerFunc, (OMX_PTR) &oConsumerParams[nIndex], 
+                                            0, 0, &oConsumer[nIndex] );
+        OMX_OSAL_TESTERR( eError );
+    }
+    for(nIndex = 0; nIndex < QUEUE_TEST1_NUMPRODUCERS; nIndex++) {
+        oProducerParams[nIndex].oQueue = oQueue;
+        oProducerParams[nIndex].pSeen  = pSeen;
+        oProducerParams[nIndex].nIndex = nIndex;
+        eError = OMX_OSAL_ThreadCreate( QueueTest1ProducerFunc, (OMX_PTR) &oProducerParams[nIndex], 0, &oProducer[nIndex] );
+        OMX_OSAL_TESTERR( eError );
+    }
+    for(nIndex = 0; nIndex < QUEUE_TEST1_NUMPRODUCERS; nIndex++) {
+        OMX_OSAL_ThreadDestroy( oProducer[nIndex] );
+        oProducer[nIndex] = 0;
+    }
+    for(nIndex = 0; nIndex < QUEUE_TEST1_NUMCONSUMERS; nIndex++) {
+        OMX_OSAL_QueuePush( oQueue, NULL );
+    }
+    for(nIndex = 0; nIndex < QUEUE_TEST1_NUMCONSUMERS; nIndex++) {
+        OMX_OSAL_ThreadPoolWait( oConsumer[nIndex], &uReturn );
+        oConsumer[nIndex] = 0;
+        if (uReturn) eError = OMX_ErrorUndefined;
+    }
+    OMX_OSAL_TESTERR( eError );
+    for(nIndex = 0; nIndex < QUEUE_TEST1_NUMENTRIES; nIndex++) {
+        if (pSeen[nIndex] != 1) {
+            OMX_OSAL_Trace(OMX_OSAL_TRACE_ERROR, "Entry %d popped %d times\n", nIndex + 1, pSeen[nIndex]);
+            eError = OMX_ErrorUndefined;
+            break;
+        }
+    }
+    OMX_OSAL_TESTERR( eError );
+
+    /* uncontended push/pop */
+    nBegin = OMX_OSAL_GetTimeNs();
+    for(nIndex = 0; nIndex < QUEUE_TEST1_LOOPSIZE; nIndex++) {
+        OMX_OSAL_QueuePush( oQueue, (OMX_PTR) pSeen );
+        OMX_OSAL_QueuePop( oQueue, 0, &pEntry );
+    }
+    nEnd = OMX_OSAL_GetTimeNs();
+    OMX_OSAL_Trace(OMX_OSAL_TRACE_INFO, "Queue push/pop: %u ns\n", 
+                   (OMX_U32)((nEnd - nBegin) / QUEUE_TEST1_LOOPSIZE));
+
+OMX_OSAL_TEST_BAIL:
+    for(nIndex = 0; nIndex < QUEUE_TEST1_NUMPRODUCERS; nIndex++) {
+        if( oProducer[nIndex] ) OMX_OSAL_ThreadDestroy( oProducer[nIndex] ); 
+    }
+    for(nIndex = 0; nIndex < QUEUE_TEST1_NUMCONSUMERS; nIndex++) {
+        if( oConsumer[nIndex] ) OMX_OSAL_QueuePush( oQueue, NULL );
+    }
+    for(nIndex = 0; nIndex < QUEUE_TEST1_NUMCONSUMERS; nIndex++) {
+        if( oConsumer[nIndex] ) OMX_OSAL_ThreadPoolWait( oConsumer[nIndex], NULL ); 
+    }
+    if( oQueue ) OMX_OSAL_QueueDestroy( oQueue );
+    if( pSeen ) OMX_OSAL_Free( pSeen );
+    return eError;
+}
+
+/* ******************************************************************
+ *  Sync test 1:
+ * ******************************************************************
+ *  Event broadcast and wake latency. A set on a manual-reset event must
+ *  release every waiter. Then two threads ping-pong over a pair of 
+ *  events to measure the round trip, once with the portable and once
+ *  with the native primitives (see OMX_OSAL_SyncConfigure), and the
+ *  cost of an uncontended lock/unlock is measured the same way.
+ */
+#define SYNC_TEST1_NUMWAITERS  8
+#define SYNC_TEST1_ROUNDTRIPS  10000
+#define SYNC_TEST1_LOCKS       1000000
+#define SYNC_TEST1_MAXSPIN     100
+
+typedef struct SSyncTest1Param 
+{
+    OMX_HANDLETYPE  oPing;
+    OMX_HANDLETYPE  oPong;
+    OMX_HANDLETYPE  oMutex;
+    OMX_HANDLETYPE  oReady;         /* set once every waiter is about to wait */
+    OMX_U32         nReady;
+    OMX_U32         nRoundTrips;
+    OMX_U32         nTimeouts;      /* waiters the broadcast did not release */
+} SyncTest1Param;
+
+OMX_U32 SyncTest1WaiterFunc(OMX_PTR pParam)
+{
+    SyncTest1Param *pData = (SyncTest1Param *)pParam;
+    OMX_BOOL bTimeout = OMX_FALSE;
+
+    OMX_OSAL_MutexLock( pData->oMutex );
+    if (++pData->nReady == SYNC_TEST1_NUMWAITERS)
+        OMX_OSAL_EventSet( pData->oReady );
+    OMX_OSAL_MutexUnlock( pData->oMutex );
+    /* every waiter has to see the one set on oPing */
+    OMX_OSAL_EventWait( pData->oPing, OMX_CONF_TIMEOUT_EXPECTING_SUCCESS, &bTimeout );
+    if (bTimeout) {
+        OMX_OSAL_MutexLock( pData->oMutex );
+        pData->nTimeouts++;
+        OMX_OSAL_MutexUnlock( pData->oMutex );
+    }
+    return bTimeout ? 1 : 0;
+}
+
+OMX_U32 SyncTest1EchoFunc(OMX_PTR pParam)
+{
+    SyncTest1Param *pData = (SyncTest1Param *)pParam;
+    OMX_BOOL bTimeout = OMX_FALSE;
+    OMX_U32 nIndex;
+
+    for(nIndex = 0; nIndex < pData->nRoundTrips; nIndex++) {
+        OMX_OSAL_EventWait( pData->oPing, INFINITE_WAIT, &bTimeout );
+        OMX_OSAL_EventReset( pData->oPing );
+        OMX_OSAL_EventSet( pData->oPong );
+    }
+    return 0;
+}
+
+static OMX_ERRORTYPE OMX_OSAL_SyncTest1Run(OMX_BOOL bFutex)
+{
+    OMX_ERRORTYPE   eError = OMX_ErrorNone;
+    OMX_HANDLETYPE  oThread[SYNC_TEST1_NUMWAITERS];
+    OMX_HANDLETYPE  oMutex = 0;
+    SyncTest1Param  oParam;
+    OMX_BOOL        bTimeout = OMX_FALSE;
+    OMX_U64         nBegin, nEnd;
+    OMX_U32         nIndex;
+    OMX_STRING      sName = bFutex ? "native" : "portable";
+
+    oParam.oPing = 0;
+    oParam.oPong = 0;
+    oParam.oMutex = 0;
+    oParam.oReady = 0;
+    oParam.nReady = 0;
+    oParam.nRoundTrips = SYNC_TEST1_ROUNDTRIPS;
+    oParam.nTimeouts = 0;
+    for(nIndex = 0; nIndex < SYNC_TEST1_NUMWAITERS; nIndex++) {
+        oThread[nIndex] = 0; 
+    }
+
+    eError = OMX_OSAL_SyncConfigure( bFutex, SYNC_TEST1_MAXSPIN );
+    OMX_OSAL_TESTERR( eError );
+    eError = OMX_OSAL_EventCreate( &oParam.oPing ); 
+    OMX_OSAL_TESTERR( eError );
+    eError = OMX_OSAL_EventCreate( &oParam.oPong ); 
+    OMX_OSAL_TESTERR( eError );
+    eError = OMX_OSAL_MutexCreate( &oMutex ); 
+    OMX_OSAL_TESTERR( eError );
+    eError = OMX_OSAL_MutexCreate( &oParam.oMutex ); 
+    OMX_OSAL_TESTERR( eError );
+    eError = OMX_OSAL_EventCreate( &oParam.oReady ); 
+    OMX_OSAL_TESTERR( eError );
+
+    /* broadcast: one set releases all waiters. It is only set once all 
+       waiters have checked in, and they are given time to block, so an 
+       event that wakes a single waiter cannot pass on waiters that were 
+       not waiting yet. */
+    for(nIndex = 0; nIndex < SYNC_TEST1_NUMWAITERS; nIndex++) {
+        eError = OMX_OSAL_ThreadCreate( SyncTest1WaiterFunc, (OMX_PTR) &oParam, 0, &oThread[nIndex] ); 
+        OMX_OSAL_TESTERR( eError );
+    }
+    OMX_OSAL_EventWait( oParam.oReady, OMX_CONF_TIMEOUT_EXPECTING_SUCCESS, &bTimeout );
+    if (bTimeout) {
+        OMX_OSAL_Trace(OMX_OSAL_TRACE_ERROR, "%s waiters did not start\n", sName);
+        eError = OMX_ErrorUndefined;
+        goto OMX_OSAL_TEST_BAIL;
+    }
+    OMX_OSAL_EventWait( oParam.oPong, 10, &bTimeout );
+    OMX_OSAL_EventSet( oParam.oPing );
+    for(nIndex = 0; nIndex < SYNC_TEST1_NUMWAITERS; nIndex++) {
+        OMX_OSAL_ThreadDestroy( oThread[nIndex] );
+        oThread[nIndex] = 0;
+    }
+    if (oParam.nTimeouts) {
+        OMX_OSAL_Trace(OMX_OSAL_TRACE_ERROR, "%s event set released %u of %u waiters\n", 
+                       sName, SYNC_TEST1_NUMWAITERS - oParam.nTimeouts, SYNC_TEST1_NUMWAITERS);
+        eError = OMX_ErrorUndefined;
+        goto OMX_OSAL_TEST_BAIL;
+    }
+    /* a set event stays set until reset */
+    OMX_OSAL_EventWait( oParam.oPing, 0, &bTimeout );
+    if (bTimeout) {
+        OMX_OSAL_Trace(OMX_OSAL_TRACE_ERROR, "%s event did not stay signaled\n", sName);
+        eError = OMX_ErrorUndefined;
+        goto OMX_OSAL_TEST_BAIL;
+    }
+    OMX_OSAL_EventReset( oParam.oPing );
+    OMX_OSAL_EventWait( oParam.oPing, 10, &bTimeout );
+    if (!bTimeout) {
+        OMX_OSAL_Trace(OMX_OSAL_TRACE_ERROR, "%s event did not time out after reset\n", sName);
+        eError = OMX_ErrorUndefined;
+        goto OMX_OSAL_TEST_BAIL;
+    }
+
+    /* wake latency: ping-pong between two threads */
+    eError = OMX_OSAL_ThreadCreate( SyncTest1EchoFunc, (OMX_PTR) &oParam, 0, &oThread[0] ); 
+    OMX_OSAL_TESTERR( eError );
+    nBegin = OMX_OSAL_GetTimeNs();
+    for(nIndex = 0; nIndex < SYNC_TEST1_ROUNDTRIPS; nIndex++) {
+        OMX_OSAL_EventSet( oParam.oPing );
+        OMX_OSAL_EventWait( oParam.oPong, INFINITE_WAIT, &bTimeout );
+        OMX_OSAL_EventReset( oParam.oPong );
+    }
+    nEnd = OMX_OSAL_GetTimeNs();
+    OMX_OSAL_ThreadDestroy( oThread[0] );
+    oThread[0] = 0;
+    OMX_OSAL_Trace(OMX_OSAL_TRACE_INFO, "%s events: %u ns per round trip\n", 
+                   sName, (OMX_U32)((nEnd - nBegin) / SYNC_TEST1_ROUNDTRIPS));
+
+    /* uncontended (and recursive) locking */
+    nBegin = OMX_OSAL_GetTimeNs();
+    for(nIndex = 0; nIndex < SYNC_TEST1_LOCKS; nIndex++) {
+        OMX_OSAL_MutexLock( oMutex );
+        OMX_OSAL_MutexLock( oMutex );
+        OMX_OSAL_MutexUnlock( oMutex );
+        OMX_OSAL_MutexUnlock( oMutex );
+    }
+    nEnd = OMX_OSAL_GetTimeNs();
+    OMX_OSAL_Trace(OMX_OSAL_TRACE_INFO, "%s mutex: %u ns per lock/unlock pair\n", 
+                   sName, (OMX_U32)((nEnd - nBegin) / (2 * SYNC_TEST1_LOCKS)));
+
+OMX_OSAL_TEST_BAIL:
+    for(nIndex = 0; nIndex < SYNC_TEST1_NUMWAITERS; nIndex++) {
+        if( oThread[nIndex] ) {
+            OMX_OSAL_EventSet( oParam.oPing );
+            OMX_OSAL_ThreadDestroy( oThread[nIndex] ); 
+        }
+    }
+    if( oMutex ) OMX_OSAL_MutexDestroy( oMutex );
+    if( oParam.oMutex ) OMX_OSAL_MutexDestroy( oParam.oMutex );
+    if( oParam.oPing ) OMX_OSAL_EventDestroy( oParam.oPing );
+    if( oParam.oPong ) OMX_OSAL_EventDestroy( oParam.oPong );
+    if( oParam.oReady ) OMX_OSAL_EventDestroy( oParam.oReady );
+    return eError;
+}
+
+OMX_ERRORTYPE OMX_OSAL_SyncTest1(OMX_IN OMX_STRING cComponentName)
+{
+    OMX_ERRORTYPE eError;
+
+    UNUSED_PARAMETER(cComponentName);
+
+    eError = OMX_OSAL_SyncTest1Run( OMX_FALSE );
+    if (eError == OMX_ErrorNone) {
+        eError = OMX_OSAL_SyncTest1Run( OMX_TRUE );
+    }
+
+    /* back to the defaults */
+    OMX_OSAL_SyncConfigure( OMX_TRUE, SYNC_TEST1_MAXSPIN );
+    return eError;
+}
+
 
 #define OMX_CONF_DOTEST(_T_) eError = _T_(cComponentName);          \
     if (eError != OMX_ErrorNone) {                                  \
@@ -307,8 +878,12 @@ OMX_ERRORTYPE OMX_OSAL_TestAll(OMX_IN OMX_STRING cComponentName)
     UNUSED_PARAMETER(cComponentName);
 
     OMX_CONF_DOTEST(OMX_OSAL_MemoryTest1);
+    OMX_CONF_DOTEST(OMX_OSAL_BufferPoolTest1);
     OMX_CONF_DOTEST(OMX_OSAL_MultiThreadTest1);
     OMX_CONF_DOTEST(OMX_OSAL_TimerTest1);
+    OMX_CONF_DOTEST(OMX_OSAL_SyncTest1);
+    OMX_CONF_DOTEST(OMX_OSAL_ThreadPoolTest1);
+    OMX_CONF_DOTEST(OMX_OSAL_QueueTest1);
     if (nErrors > 0)
         OMX_OSAL_Trace(OMX_OSAL_TRACE_PASSFAIL, "OMX_OSAL_TestAll FAILED\n");
     return (nErrors > 0) ? OMX_ErrorUndefined : OMX_ErrorNone;
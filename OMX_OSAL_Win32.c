@@ -25,6 +25,8 @@
 #include <stdio.h>
 #include <windows.h>
 #include <mmsystem.h>
+#include <psapi.h>
+#include <malloc.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -47,39 +49,46 @@ void OMX_OSAL_Free( OMX_IN OMX_PTR pData )
     free(pData);
 }
 
+/* Win32 has no pooled allocator; aligned and contiguous requests are served by the CRT
+   aligned heap (contiguity cannot be guaranteed from user mode). */
+#define OMX_OSAL_BUFFER_MINALIGNMENT 64
+
+OMX_ERRORTYPE OMX_OSAL_BufferPoolSetup( OMX_IN OMX_BOOL bHugePages, OMX_IN OMX_U32 nContiguousBytes )
+{
+    UNUSED_PARAMETER(bHugePages);
+    UNUSED_PARAMETER(nContiguousBytes);
+    return OMX_ErrorNone;
+}
+
+OMX_ERRORTYPE OMX_OSAL_BufferPoolRelease()
+{
+    return OMX_ErrorNone;
+}
+
 OMX_PTR OMX_OSAL_MallocBuffer(    OMX_IN OMX_U32 size,
                             OMX_BOOL bBuffersContiguous, 
                             OMX_U32 nBufferAlignment )
 {
-/** The memory allocation will fail if contiguous memory and/or if a specific byte alignment is requested. 
-These definitions must be modified by the implementer if required to handle contiguous memory allocation and/or specific byte alignment. */
-    if ((OMX_FALSE != bBuffersContiguous) || (0 != nBufferAlignment)) 
+    UNUSED_PARAMETER(bBuffersContiguous);
+
+    if (nBufferAlignment & (nBufferAlignment - 1)) 
     {
-        /** Log the error and return a NULL pointer */
-        OMX_OSAL_Trace(OMX_OSAL_TRACE_ERROR,
-                    "Support for aligned/contiguous memory allocation not implemented.\n"); 
+        OMX_OSAL_Trace(OMX_OSAL_TRACE_ERROR, "Buffer alignment %u is not a power of two.\n", nBufferAlignment);
         return(NULL);
     }
-    return OMX_OSAL_Malloc(size);
+    if (nBufferAlignment < OMX_OSAL_BUFFER_MINALIGNMENT)
+        nBufferAlignment = OMX_OSAL_BUFFER_MINALIGNMENT;
+    return (OMX_PTR)_aligned_malloc(size, nBufferAlignment);
 }
 
 void OMX_OSAL_FreeBuffer( OMX_IN OMX_PTR pData,
                             OMX_BOOL bBuffersContiguous, 
                             OMX_U32 nBufferAlignment )  
 {
-/** The memory de-allocation will fail if contiguous memory and/or if a specific byte alignment is requested. 
-These definitions must be modified by the implementer if required to handle contiguous memory allocation and/or specific byte alignment. */
-    if ((OMX_FALSE != bBuffersContiguous) || (0 != nBufferAlignment)) 
-    {
-        /** Log the error and return */
-        OMX_OSAL_Trace(OMX_OSAL_TRACE_ERROR,
-                    "Support for aligned/contiguous memory allocation not implemented.\n");
-                    
-    }
-    else 
-    {
-        OMX_OSAL_Free(pData);
-    }
+    UNUSED_PARAMETER(bBuffersContiguous);
+    UNUSED_PARAMETER(nBufferAlignment);
+
+    _aligned_free(pData);
 }
 
 OMX_PTR OMX_OSAL_Memset( OMX_IN OMX_PTR pDest, OMX_IN OMX_U32 cChar, OMX_IN OMX_U32 nCount)
@@ -158,6 +167,118 @@ OMX_ERRORTYPE OMX_OSAL_ThreadDestroy( OMX_IN OMX_HANDLETYPE hThread )
     return OMX_ErrorNone;       
 }
 
+OMX_U32 OMX_OSAL_GetThreadId()
+{
+    return (OMX_U32)GetCurrentThreadId();
+}
+
+OMX_ERRORTYPE OMX_OSAL_GetThreadSwitches( OMX_IN OMX_U32 nThreadId, 
+                                          OMX_OUT OMX_U64 *pnVoluntary, 
+                                          OMX_OUT OMX_U64 *pnInvoluntary )
+{
+    UNUSED_PARAMETER(nThreadId);
+    UNUSED_PARAMETER(pnVoluntary);
+    UNUSED_PARAMETER(pnInvoluntary);
+    return OMX_ErrorNotImplemented;
+}
+
+/**********************************************************************
+ * THREAD POOL
+ *
+ * Work items run on their own thread here; only the Linux OSAL pools them.
+ **********************************************************************/
+
+OMX_ERRORTYPE OMX_OSAL_ThreadPoolSubmit( OMX_IN OMX_U32 (*pFunc)(OMX_PTR pParam), 
+                                         OMX_IN OMX_PTR pParam, 
+                                         OMX_IN OMX_U32 nPriority, 
+                                         OMX_IN OMX_U64 nAffinityMask,
+                                         OMX_OUT OMX_HANDLETYPE *phWork )
+{
+    OMX_ERRORTYPE eError;
+
+    eError = OMX_OSAL_ThreadCreate(pFunc, pParam, nPriority, phWork);
+    if (eError == OMX_ErrorNone && nAffinityMask) {
+        SetThreadAffinityMask(((OMX_CONF_THREADDATATYPE *)*phWork)->hActualThread, (DWORD_PTR)nAffinityMask);
+    }
+    return eError;
+}
+
+OMX_ERRORTYPE OMX_OSAL_ThreadPoolWait( OMX_IN OMX_HANDLETYPE hWork, OMX_OUT OMX_U32 *puReturn )
+{
+    DWORD uReturn = 0;
+
+    if (hWork == NULL)
+        return OMX_ErrorBadParameter;
+    WaitForSingleObject(((OMX_CONF_THREADDATATYPE *)hWork)->hActualThread, INFINITE);
+    GetExitCodeThread(((OMX_CONF_THREADDATATYPE *)hWork)->hActualThread, &uReturn);
+    if (puReturn)
+        *puReturn = (OMX_U32)uReturn;
+    return OMX_OSAL_ThreadDestroy(hWork);
+}
+
+OMX_ERRORTYPE OMX_OSAL_ThreadPoolCancel( OMX_IN OMX_HANDLETYPE hWork )
+{
+    UNUSED_PARAMETER(hWork);
+    return OMX_ErrorNotReady;
+}
+
+OMX_ERRORTYPE OMX_OSAL_ThreadPoolSetup( OMX_IN OMX_U32 nThreads )
+{
+    UNUSED_PARAMETER(nThreads);
+    return OMX_ErrorNone;
+}
+
+OMX_ERRORTYPE OMX_OSAL_ThreadPoolRelease()
+{
+    return OMX_ErrorNone;
+}
+
+/**********************************************************************
+ * PROCESSES
+ *
+ * Windows cannot start a copy of the running process; only the Linux OSAL
+ * runs functions in child processes, callers here call them directly.
+ **********************************************************************/
+
+OMX_ERRORTYPE OMX_OSAL_ProcessStart( OMX_IN OMX_U32 (*pFunc)(OMX_PTR pParam), 
+                                     OMX_IN OMX_PTR pParam, 
+                                     OMX_OUT OMX_HANDLETYPE *phProcess )
+{
+    UNUSED_PARAMETER(pFunc);
+    UNUSED_PARAMETER(pParam);
+    UNUSED_PARAMETER(phProcess);
+    return OMX_ErrorNotImplemented;
+}
+
+OMX_ERRORTYPE OMX_OSAL_ProcessWait( OMX_IN OMX_HANDLETYPE *phProcesses, 
+                                    OMX_IN OMX_U32 nProcesses, 
+                                    OMX_IN OMX_U32 mSec, 
+                                    OMX_OUT OMX_U32 *pnIndex )
+{
+    UNUSED_PARAMETER(phProcesses);
+    UNUSED_PARAMETER(nProcesses);
+    UNUSED_PARAMETER(mSec);
+    UNUSED_PARAMETER(pnIndex);
+    return OMX_ErrorNotImplemented;
+}
+
+OMX_ERRORTYPE OMX_OSAL_ProcessReply( OMX_IN OMX_PTR pData, OMX_IN OMX_U32 nBytes )
+{
+    UNUSED_PARAMETER(pData);
+    UNUSED_PARAMETER(nBytes);
+    return OMX_ErrorIncorrectStateOperation;
+}
+
+OMX_ERRORTYPE OMX_OSAL_ProcessDestroy( OMX_IN OMX_HANDLETYPE hProcess, OMX_OUT OMX_U32 *puReturn,
+                                       OMX_OUT OMX_PTR *ppReply, OMX_OUT OMX_U32 *pnReplyBytes )
+{
+    UNUSED_PARAMETER(hProcess);
+    UNUSED_PARAMETER(puReturn);
+    UNUSED_PARAMETER(ppReply);
+    UNUSED_PARAMETER(pnReplyBytes);
+    return OMX_ErrorNotImplemented;
+}
+
 /**********************************************************************
  * MUTEX               
  **********************************************************************/
@@ -240,7 +361,8 @@ OMX_ERRORTYPE OMX_OSAL_EventSet(OMX_IN OMX_HANDLETYPE hEvent)
     return OMX_ErrorNone;       
 }
 
-OMX_ERRORTYPE OMX_OSAL_EventWait(OMX_IN OMX_HANDLETYPE hEvent, OMX_IN OMX_U32 mSec, OMX_OUT OMX_BOOL *pbTimedOut)
+/* parenthesized so that the OMX_OSAL_EventWait macro leaves it alone */
+OMX_ERRORTYPE (OMX_OSAL_EventWait)(OMX_IN OMX_HANDLETYPE hEvent, OMX_IN OMX_U32 mSec, OMX_OUT OMX_BOOL *pbTimedOut)
 {
     *pbTimedOut = 0;
     switch (WaitForSingleObject(hEvent, mSec)) 
@@ -254,6 +376,146 @@ OMX_ERRORTYPE OMX_OSAL_EventWait(OMX_IN OMX_HANDLETYPE hEvent, OMX_IN OMX_U32 mS
     }
 }
 
+/* Waits are not accounted per call site here; only the Linux OSAL does. */
+OMX_ERRORTYPE OMX_OSAL_EventWaitAt(OMX_IN OMX_HANDLETYPE hEvent, OMX_IN OMX_U32 mSec, OMX_OUT OMX_BOOL *pbTimedOut,
+                                   OMX_IN const char *sFile, OMX_IN OMX_U32 nLine)
+{
+    UNUSED_PARAMETER(sFile);
+    UNUSED_PARAMETER(nLine);
+    return (OMX_OSAL_EventWait)(hEvent, mSec, pbTimedOut);
+}
+
+OMX_ERRORTYPE OMX_OSAL_WaitSitesGet(OMX_OUT OMX_OSAL_WAITSITETYPE *pSites, OMX_IN OMX_U32 nMaxSites, 
+                                    OMX_OUT OMX_U32 *pnSites, OMX_IN OMX_BOOL bReset)
+{
+    UNUSED_PARAMETER(pSites);
+    UNUSED_PARAMETER(nMaxSites);
+    UNUSED_PARAMETER(bReset);
+    *pnSites = 0;
+    return OMX_ErrorNotImplemented;
+}
+
+/** Win32 mutexes and events are already kernel objects with a user mode
+ *  fast path, there is nothing to select. */
+OMX_ERRORTYPE OMX_OSAL_SyncConfigure(OMX_IN OMX_BOOL bFutex, OMX_IN OMX_U32 nMaxSpin)
+{
+    UNUSED_PARAMETER(bFutex);
+    UNUSED_PARAMETER(nMaxSpin);
+    return OMX_ErrorNone;
+}
+
+/**********************************************************************
+ * QUEUES
+ *
+ * Lock based here; only the Linux OSAL provides the lock-free version.
+ **********************************************************************/
+
+typedef struct OMX_OSAL_QUEUETYPE {
+    CRITICAL_SECTION oLock;
+    CONDITION_VARIABLE oNotEmpty;
+    OMX_U32 nEntries;
+    OMX_U32 nStart;
+    OMX_U32 nInQueue;
+    OMX_PTR *pEntries;
+} OMX_OSAL_QUEUETYPE;
+
+OMX_ERRORTYPE OMX_OSAL_QueueCreate(OMX_IN OMX_U32 nEntries, OMX_OUT OMX_HANDLETYPE *phQueue)
+{
+    OMX_OSAL_QUEUETYPE *pQueue;
+
+    if (phQueue == NULL || nEntries == 0)
+        return OMX_ErrorBadParameter;
+    pQueue = (OMX_OSAL_QUEUETYPE *)OMX_OSAL_Malloc(sizeof(OMX_OSAL_QUEUETYPE));
+    if (pQueue == NULL)
+        return OMX_ErrorInsufficientResources;
+    pQueue->pEntries = (OMX_PTR *)OMX_OSAL_Malloc(nEntries * sizeof(OMX_PTR));
+    if (pQueue->pEntries == NULL) {
+        OMX_OSAL_Free(pQueue);
+        return OMX_ErrorInsufficientResources;
+    }
+    InitializeCriticalSection(&pQueue->oLock);
+    InitializeConditionVariable(&pQueue->oNotEmpty);
+    pQueue->nEntries = nEntries;
+    pQueue->nStart = 0;
+    pQueue->nInQueue = 0;
+    *phQueue = (OMX_HANDLETYPE)pQueue;
+    return OMX_ErrorNone;
+}
+
+OMX_ERRORTYPE OMX_OSAL_QueueDestroy(OMX_IN OMX_HANDLETYPE hQueue)
+{
+    OMX_OSAL_QUEUETYPE *pQueue = (OMX_OSAL_QUEUETYPE *)hQueue;
+    if (pQueue == NULL)
+        return OMX_ErrorBadParameter;
+    DeleteCriticalSection(&pQueue->oLock);
+    OMX_OSAL_Free(pQueue->pEntries);
+    OMX_OSAL_Free(pQueue);
+    return OMX_ErrorNone;
+}
+
+OMX_ERRORTYPE OMX_OSAL_QueuePush(OMX_IN OMX_HANDLETYPE hQueue, OMX_IN OMX_PTR pEntry)
+{
+    OMX_OSAL_QUEUETYPE *pQueue = (OMX_OSAL_QUEUETYPE *)hQueue;
+    if (pQueue == NULL)
+        return OMX_ErrorBadParameter;
+    EnterCriticalSection(&pQueue->oLock);
+    if (pQueue->nInQueue == pQueue->nEntries) {
+        LeaveCriticalSection(&pQueue->oLock);
+        return OMX_ErrorInsufficientResources;
+    }
+    pQueue->pEntries[(pQueue->nStart + pQueue->nInQueue++) % pQueue->nEntries] = pEntry;
+    LeaveCriticalSection(&pQueue->oLock);
+    WakeConditionVariable(&pQueue->oNotEmpty);
+    return OMX_ErrorNone;
+}
+
+OMX_ERRORTYPE OMX_OSAL_QueuePop(OMX_IN OMX_HANDLETYPE hQueue, OMX_IN OMX_U32 mSec, OMX_OUT OMX_PTR *ppEntry)
+{
+    OMX_OSAL_QUEUETYPE *pQueue = (OMX_OSAL_QUEUETYPE *)hQueue;
+    DWORD nDeadline = GetTickCount() + mSec;
+    DWORD nNow;
+
+    if (pQueue == NULL || ppEntry == NULL)
+        return OMX_ErrorBadParameter;
+    EnterCriticalSection(&pQueue->oLock);
+    while (pQueue->nInQueue == 0) {
+        nNow = GetTickCount();
+        if (mSec != INFINITE_WAIT && (LONG)(nDeadline - nNow) <= 0) {
+            LeaveCriticalSection(&pQueue->oLock);
+            return OMX_ErrorTimeout;
+        }
+        SleepConditionVariableCS(&pQueue->oNotEmpty, &pQueue->oLock, 
+                                 mSec == INFINITE_WAIT ? INFINITE : nDeadline - nNow);
+    }
+    *ppEntry = pQueue->pEntries[pQueue->nStart];
+    pQueue->nStart = (pQueue->nStart + 1) % pQueue->nEntries;
+    pQueue->nInQueue--;
+    LeaveCriticalSection(&pQueue->oLock);
+    return OMX_ErrorNone;
+}
+
+OMX_ERRORTYPE OMX_OSAL_QueuePeek(OMX_IN OMX_HANDLETYPE hQueue, OMX_OUT OMX_PTR *ppEntry)
+{
+    OMX_OSAL_QUEUETYPE *pQueue = (OMX_OSAL_QUEUETYPE *)hQueue;
+    OMX_ERRORTYPE eError = OMX_ErrorNotReady;
+
+    if (pQueue == NULL || ppEntry == NULL)
+        return OMX_ErrorBadParameter;
+    EnterCriticalSection(&pQueue->oLock);
+    if (pQueue->nInQueue) {
+        *ppEntry = pQueue->pEntries[pQueue->nStart];
+        eError = OMX_ErrorNone;
+    }
+    LeaveCriticalSection(&pQueue->oLock);
+    return eError;
+}
+
+OMX_U32 OMX_OSAL_QueueCount(OMX_IN OMX_HANDLETYPE hQueue)
+{
+    OMX_OSAL_QUEUETYPE *pQueue = (OMX_OSAL_QUEUETYPE *)hQueue;
+    return pQueue ? pQueue->nInQueue : 0;
+}
+
 /**********************************************************************
  * TIME
  **********************************************************************/
@@ -268,6 +530,67 @@ OMX_U32 OMX_OSAL_GetTime()
     return (OMX_U32) timeGetTime();
 }
 
+/** Returns a monotonic time value in nanoseconds. */
+OMX_U64 OMX_OSAL_GetTimeNs()
+{
+    static LARGE_INTEGER nFrequency = {0};
+    LARGE_INTEGER nCounter;
+
+    if (!nFrequency.QuadPart) QueryPerformanceFrequency(&nFrequency);
+    QueryPerformanceCounter(&nCounter);
+
+    /* split to avoid overflowing the multiply for long uptimes */
+    return (OMX_U64)(nCounter.QuadPart / nFrequency.QuadPart) * 1000000000 +
+           (OMX_U64)(nCounter.QuadPart % nFrequency.QuadPart) * 1000000000 / nFrequency.QuadPart;
+}
+
+/**********************************************************************
+ * PERFORMANCE COUNTERS
+ *
+ * Only CPU time here; only the Linux OSAL reads hardware counters.
+ **********************************************************************/
+
+OMX_ERRORTYPE OMX_OSAL_CountersOpen()
+{
+    return OMX_ErrorNotImplemented;
+}
+
+OMX_ERRORTYPE OMX_OSAL_CountersResetPeak()
+{
+    /* PeakWorkingSetSize cannot be reset */
+    return OMX_ErrorNotImplemented;
+}
+
+OMX_ERRORTYPE OMX_OSAL_CountersRead(OMX_IN OMX_BOOL bThread, OMX_OUT OMX_OSAL_COUNTERSTYPE *pCounters)
+{
+    FILETIME oCreation, oExit, oKernel, oUser;
+    PROCESS_MEMORY_COUNTERS oMemory;
+    BOOL bRead;
+
+    pCounters->nValid = 0;
+    if (bThread)
+        bRead = GetThreadTimes(GetCurrentThread(), &oCreation, &oExit, &oKernel, &oUser);
+    else
+        bRead = GetProcessTimes(GetCurrentProcess(), &oCreation, &oExit, &oKernel, &oUser);
+    if (!bRead)
+        return OMX_ErrorUndefined;
+    /* FILETIME counts 100 ns units */
+    pCounters->nValue[OMX_OSAL_CounterCpuNs] = 
+        ((((OMX_U64)oKernel.dwHighDateTime << 32) | oKernel.dwLowDateTime) +
+         (((OMX_U64)oUser.dwHighDateTime << 32) | oUser.dwLowDateTime)) * 100;
+    pCounters->nValid = 1 << OMX_OSAL_CounterCpuNs;
+    if (!bThread && GetProcessMemoryInfo(GetCurrentProcess(), &oMemory, sizeof(oMemory))) {
+        pCounters->nValue[OMX_OSAL_CounterPeakRssKb] = (OMX_U64)oMemory.PeakWorkingSetSize / 1024;
+        pCounters->nValid |= 1 << OMX_OSAL_CounterPeakRssKb;
+    }
+    return OMX_ErrorNone;
+}
+
+OMX_ERRORTYPE OMX_OSAL_CountersClose()
+{
+    return OMX_ErrorNone;
+}
+
 /**************************************************************
  * LOG FILES
  **************************************************************/
@@ -322,10 +645,12 @@ OMX_ERRORTYPE OMX_OSAL_Trace(OMX_IN OMX_U32 nTraceFlags, OMX_IN char *format, ..
         /* emit trace */
         va_start(args, format);
         vprintf(format, args);
+        va_end(args);
         if (g_pLogFile){
+            va_start(args, format);
             vfprintf(g_pLogFile,format, args);
+            va_end(args);
         }
-        va_end(args);
 
         /* skip prefix on next output if this is no the end of line */
         if (format[0] != 0)
@@ -337,6 +662,101 @@ OMX_ERRORTYPE OMX_OSAL_Trace(OMX_IN OMX_U32 nTraceFlags, OMX_IN char *format, ..
     return OMX_ErrorNone;       
 }
 
+/* trace messages are always written synchronously on this platform */
+OMX_ERRORTYPE OMX_OSAL_TraceConfigure(OMX_IN OMX_U32 nRingEntries)
+{
+    UNUSED_PARAMETER(nRingEntries);
+    return OMX_ErrorNone;
+}
+
+OMX_ERRORTYPE OMX_OSAL_TraceFlush()
+{
+    return OMX_ErrorNone;
+}
+
+/**********************************************************************
+ * EVENT LOG
+ **********************************************************************/
+
+/* no event log support on this platform */
+OMX_ERRORTYPE OMX_OSAL_EventLogOpen(OMX_IN OMX_STRING sFilename)
+{
+    UNUSED_PARAMETER(sFilename);
+    return OMX_ErrorNotImplemented;
+}
+
+OMX_ERRORTYPE OMX_OSAL_EventLogClose()
+{
+    return OMX_ErrorNone;
+}
+
+OMX_BOOL OMX_OSAL_EventLogActive()
+{
+    return OMX_FALSE;
+}
+
+OMX_U16 OMX_OSAL_EventLogName(OMX_IN OMX_STRING sName)
+{
+    UNUSED_PARAMETER(sName);
+    return 0;
+}
+
+void OMX_OSAL_EventLogCall(OMX_IN OMX_U16 nNameId, OMX_IN OMX_U16 nApiId, OMX_IN OMX_U16 nFlags,
+                           OMX_IN OMX_U64 nBeginNs, OMX_IN OMX_U64 nEndNs, 
+                           OMX_IN OMX_PTR pBuffer, OMX_IN OMX_U32 nResult)
+{
+    UNUSED_PARAMETER(nNameId);
+    UNUSED_PARAMETER(nApiId);
+    UNUSED_PARAMETER(nFlags);
+    UNUSED_PARAMETER(nBeginNs);
+    UNUSED_PARAMETER(nEndNs);
+    UNUSED_PARAMETER(pBuffer);
+    UNUSED_PARAMETER(nResult);
+}
+
+void OMX_OSAL_EventLogCallData(OMX_IN OMX_U16 nNameId, OMX_IN OMX_U16 nApiId, OMX_IN OMX_U16 nFlags,
+                               OMX_IN OMX_U64 nBeginNs, OMX_IN OMX_U64 nEndNs, 
+                               OMX_IN OMX_PTR pBuffer, OMX_IN OMX_U32 nResult,
+                               OMX_IN OMX_PTR pData, OMX_IN OMX_U32 nDataBytes)
+{
+    UNUSED_PARAMETER(nNameId);
+    UNUSED_PARAMETER(nApiId);
+    UNUSED_PARAMETER(nFlags);
+    UNUSED_PARAMETER(nBeginNs);
+    UNUSED_PARAMETER(nEndNs);
+    UNUSED_PARAMETER(pBuffer);
+    UNUSED_PARAMETER(nResult);
+    UNUSED_PARAMETER(pData);
+    UNUSED_PARAMETER(nDataBytes);
+}
+
+OMX_ERRORTYPE OMX_OSAL_EventLogLoad(OMX_IN OMX_STRING sFilename, OMX_OUT OMX_U8 **ppLog, OMX_OUT OMX_U32 *pnBytes)
+{
+    UNUSED_PARAMETER(sFilename);
+    *ppLog = NULL;
+    *pnBytes = 0;
+    return OMX_ErrorNotImplemented;
+}
+
+OMX_ERRORTYPE OMX_OSAL_ConvertEventLog(OMX_IN OMX_STRING sLogName, OMX_IN OMX_STRING sJsonName)
+{
+    UNUSED_PARAMETER(sLogName);
+    UNUSED_PARAMETER(sJsonName);
+    return OMX_ErrorNotImplemented;
+}
+
+/**********************************************************************
+ * FILE I/O
+ **********************************************************************/
+
+/* file I/O is always synchronous on this platform */
+OMX_ERRORTYPE OMX_OSAL_FileIoConfigure( OMX_IN OMX_U32 nDepth, OMX_IN OMX_U32 nChunkBytes )
+{
+    UNUSED_PARAMETER(nDepth);
+    UNUSED_PARAMETER(nChunkBytes);
+    return OMX_ErrorNone;
+}
+
 /**********************************************************************
  * INPUT FILE MAPPING
  **********************************************************************/
@@ -459,6 +879,36 @@ OMX_U32 OMX_OSAL_ReadFromInputFileWithSize( OMX_OUT OMX_PTR pData, OMX_IN OMX_U3
     return nRetVal;
 }
 
+OMX_ERRORTYPE OMX_OSAL_AllocInputFileBuffer( OMX_IN OMX_U32 nBytes, OMX_OUT OMX_PTR *ppBuffer )
+{
+    if (!ppBuffer || !nBytes) return OMX_ErrorBadParameter;
+
+    *ppBuffer = VirtualAlloc(NULL, nBytes, MEM_COMMIT | MEM_RESERVE, PAGE_READWRITE);
+    return *ppBuffer ? OMX_ErrorNone : OMX_ErrorInsufficientResources;
+}
+
+void OMX_OSAL_FreeInputFileBuffer( OMX_IN OMX_PTR pBuffer, OMX_IN OMX_U32 nBytes )
+{
+    UNUSED_PARAMETER(nBytes);
+    if (pBuffer) VirtualFree(pBuffer, 0, MEM_RELEASE);
+}
+
+OMX_U32 OMX_OSAL_InputFileBufferAlignment()
+{
+    SYSTEM_INFO oInfo;
+
+    GetSystemInfo(&oInfo);
+    return (OMX_U32)oInfo.dwPageSize;
+}
+
+/* no in place mapping on this platform; always copies */
+OMX_U32 OMX_OSAL_ReadFromInputFileInPlace( OMX_IN OMX_PTR pBuffer, OMX_IN OMX_U32 nAllocLen, 
+                                           OMX_OUT OMX_U32 *pnOffset, OMX_IN OMX_U32 nPortIndex )
+{
+    *pnOffset = 0;
+    return OMX_OSAL_ReadFromInputFileWithSize(pBuffer, nAllocLen, nPortIndex);
+}
+
 OMX_BOOL OMX_OSAL_InputFileAtEOS(OMX_IN OMX_U32 nPortIndex)
 {
     OMX_U32 nArrayIndex;
@@ -497,6 +947,87 @@ OMX_ERRORTYPE OMX_OSAL_CloseInputFile( OMX_IN OMX_U32 nPortIndex )
     return OMX_ErrorNone;
 }
 
+/* no frame index support on this platform; .index files are ignored */
+OMX_U32 OMX_OSAL_InputFileFrameCount( OMX_IN OMX_U32 nPortIndex )
+{
+    UNUSED_PARAMETER(nPortIndex);
+    return 0;
+}
+
+OMX_ERRORTYPE OMX_OSAL_InputFileGetFrame( OMX_IN OMX_U32 nPortIndex, OMX_IN OMX_U32 nFrame, 
+                                          OMX_OUT OMX_OSAL_FRAMEINFOTYPE *pFrame )
+{
+    UNUSED_PARAMETER(nPortIndex);
+    UNUSED_PARAMETER(nFrame);
+    UNUSED_PARAMETER(pFrame);
+    return OMX_ErrorNotImplemented;
+}
+
+OMX_ERRORTYPE OMX_OSAL_InputFileSeekFrame( OMX_IN OMX_U32 nPortIndex, OMX_IN OMX_U32 nFrame )
+{
+    UNUSED_PARAMETER(nPortIndex);
+    UNUSED_PARAMETER(nFrame);
+    return OMX_ErrorNotImplemented;
+}
+
+OMX_ERRORTYPE OMX_OSAL_ConvertBufferVarianceFile( OMX_IN OMX_STRING sLengthFileName, 
+                                                  OMX_IN OMX_STRING sIndexFileName )
+{
+    OMX_OSAL_FRAMEINDEXHEADERTYPE oHeader;
+    OMX_OSAL_FRAMEINFOTYPE oFrame;
+    OMX_CONF_INFILEPORTSETTINGTYPE *pSettings = NULL;
+    OMX_U32 *pSizes = NULL;
+    OMX_U8 sPortIndex[16];
+    OMX_U32 nSettings = 0, nFrames = 0, nMaxSize = 0, i;
+    OMX_U64 nPad = 0;
+    OMX_ERRORTYPE eError = OMX_ErrorNone;
+    FILE *pIn, *pOut;
+
+    pIn = fopen(sLengthFileName, "r");
+    if (!pIn) return OMX_ErrorBadParameter;
+    eError = OMX_OSAL_ReadBufferVarianceFile(sPortIndex, &nSettings, &pSettings, &nFrames, &nMaxSize, &pSizes, pIn);
+    fclose(pIn);
+    if (eError != OMX_ErrorNone) return eError;
+
+    pOut = fopen(sIndexFileName, "wb");
+    if (!pOut) {
+        eError = OMX_ErrorUndefined;
+        goto cleanup;
+    }
+
+    memset(&oHeader, 0, sizeof(oHeader));
+    oHeader.nMagic = OMX_OSAL_FRAMEINDEX_MAGIC;
+    oHeader.nVersion = OMX_OSAL_FRAMEINDEX_VERSION;
+    for (i = 0; i < sizeof(oHeader.sPortIndex) - 1 && sPortIndex[i] && 
+                sPortIndex[i] != '\n' && sPortIndex[i] != '\r'; i++)
+        oHeader.sPortIndex[i] = sPortIndex[i];
+    oHeader.nSettings = nSettings;
+    oHeader.nMaxFrameSize = nMaxSize;
+    oHeader.nFrames = nFrames;
+    oHeader.nFramesOffset = (sizeof(oHeader) + nSettings * sizeof(OMX_CONF_INFILEPORTSETTINGTYPE) + 7) & ~(OMX_U64)7;
+
+    /* the text format has sizes only; frames are back to back and untimed */
+    if (fwrite(&oHeader, sizeof(oHeader), 1, pOut) != 1 ||
+        (nSettings && fwrite(pSettings, sizeof(OMX_CONF_INFILEPORTSETTINGTYPE), nSettings, pOut) != nSettings) ||
+        fwrite(&nPad, 1, (size_t)(oHeader.nFramesOffset - sizeof(oHeader) - 
+                                   nSettings * sizeof(OMX_CONF_INFILEPORTSETTINGTYPE)), pOut) != 
+               (size_t)(oHeader.nFramesOffset - sizeof(oHeader) - nSettings * sizeof(OMX_CONF_INFILEPORTSETTINGTYPE))) {
+        eError = OMX_ErrorUndefined;
+    }
+    memset(&oFrame, 0, sizeof(oFrame));
+    for (i = 0; i < nFrames && eError == OMX_ErrorNone; i++) {
+        oFrame.nSize = pSizes[i];
+        if (fwrite(&oFrame, sizeof(oFrame), 1, pOut) != 1) eError = OMX_ErrorUndefined;
+        oFrame.nOffset += pSizes[i];
+    }
+    if (fclose(pOut) && eError == OMX_ErrorNone) eError = OMX_ErrorUndefined;
+
+cleanup:
+    if (pSettings && nSettings) free(pSettings);
+    if (pSizes) OMX_OSAL_Free(pSizes);
+    return eError;
+}
+
 /**********************************************************************
  * OUTPUT FILE MAPPING
  **********************************************************************/
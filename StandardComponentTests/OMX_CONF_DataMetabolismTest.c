@@ -68,12 +68,10 @@ OMX_U32 nStartTime;
     OMX_OSAL_Trace(OMX_OSAL_TRACE_ERROR, _s_);\
     goto OMX_CONF_TEST_BAIL
 
-#define OMX_CONF_TIMEOUT_STATE_CHANGE 2000 /* duration of event timeout in msec when changing states */
-
 #define OMX_CONF_WAIT_STATE(_p_, _s_, _e_)\
 {\
     OMX_BOOL _bTimeout_;\
-    OMX_OSAL_EventWait((_p_)->hStateChangeEvent, OMX_CONF_TIMEOUT_STATE_CHANGE, &_bTimeout_);\
+    OMX_OSAL_EventWait((_p_)->hStateChangeEvent, OMX_CONF_TIMEOUT_EXPECTING_SUCCESS, &_bTimeout_);\
     if (OMX_TRUE == _bTimeout_)\
     {\
         OMX_CONF_StateToString(_s_, szState);\
@@ -107,65 +105,17 @@ OMX_U32 nStartTime;
     OMX_CONF_SET_STATE(_p_, _s_, _e_);\
     OMX_CONF_WAIT_STATE(_p_, _s_, _e_)
     
-#define Q_ALLOC(_p_, _n_)\
-    _p_ = (QTYPE*)OMX_OSAL_Malloc(sizeof(QTYPE) + (sizeof(OMX_PTR) * (_n_ + 1)));\
-    if (0x0 != _p_)\
-    {\
-        _p_->nNumEntries = _n_;\
-        _p_->nEnd = 0;\
-        _p_->nStart = 0;\
-        _p_->nInQueue = 0;\
-    }
-
-#define Q_FREE(_p_)\
-    if (0x0 != _p_)\
-    {\
-        OMX_OSAL_Free(_p_);\
-    }\
-    _p_ = 0x0
-    
-#define Q_ADD(_p_, _e_)\
-    _p_->aEntires[_p_->nStart++] = (OMX_PTR)_e_;\
-    if (_p_->nStart == _p_->nNumEntries) _p_->nStart = 0;\
-    _p_->nInQueue++
-
-#define Q_PEEK(_p_, _e_)\
-    if (0x0 != _p_->nInQueue)\
-    {\
-        _e_ = _p_->aEntires[_p_->nEnd];\
-    }    
-
-#define Q_REMOVE(_p_, _e_)\
-    if (0x0 != _p_->nInQueue)\
-    {\
-        _e_ = _p_->aEntires[_p_->nEnd++];\
-        if (_p_->nEnd == _p_->nNumEntries) _p_->nEnd = 0;\
-        _p_->nInQueue--;\
-    }    
-
-#define Q_INQUEUE(_p_) _p_->nInQueue
-
 /*
  *     D E F I N I T I O N S
  */
 
 typedef struct _TEST_CTXTYPE TEST_CTXTYPE;
 
-typedef struct _QTYPE
-{
-    OMX_U32 nNumEntries;
-    OMX_U32 nEnd;
-    OMX_U32 nStart;
-    OMX_U32 nInQueue;
-    OMX_PTR aEntires[1];
-
-} QTYPE;
-
 typedef struct _TEST_PORTTYPE
 {
     TEST_CTXTYPE *pCtx;
     OMX_PARAM_PORTDEFINITIONTYPE sPortDef;
-    QTYPE *pQ;
+    OMX_HANDLETYPE hQueue;
     OMX_U32 nBuffersOutstanding;
     OMX_BOOL bEOS;
     OMX_BOOL bOpenFile;
@@ -246,9 +196,9 @@ OMX_ERRORTYPE DataMetabolismTest_EmptyBufferDone(
             /* when the queue is full, don't add another buffer header
                as something is wrong with the component.  It is 
                incorrectly returning more buffers than sent in */
-            if (Q_INQUEUE(pPort->pQ) < pPort->sPortDef.nBufferCountActual)
+            if (OMX_OSAL_QueueCount(pPort->hQueue) < pPort->sPortDef.nBufferCountActual)
             {
-                Q_ADD(pPort->pQ, pBufHdr);
+                OMX_OSAL_QueuePush(pPort->hQueue, pBufHdr);
                 pPort->nBuffersOutstanding--;
                 pCtx->nBuffersProcessed++;
                 OMX_OSAL_EventSet(pCtx->hBufferCallbackEvent);
@@ -288,7 +238,7 @@ OMX_ERRORTYPE DataMetabolismTest_FillBufferDone(
             /* when the queue is full, don't add another buffer header
                as something is wrong with the component.  It is 
                incorrectly returning more buffers than sent in */
-            if (Q_INQUEUE(pPort->pQ) < pPort->sPortDef.nBufferCountActual)
+            if (OMX_OSAL_QueueCount(pPort->hQueue) < pPort->sPortDef.nBufferCountActual)
             {
                 /* write to file if enabled */
                 if (OMX_TRUE == pPort->bOpenFile)
@@ -296,7 +246,7 @@ OMX_ERRORTYPE DataMetabolismTest_FillBufferDone(
                     OMX_OSAL_WriteToBufferVarOutputFile((pBufHdr->pBuffer + pBufHdr->nOffset),pBufHdr->nFilledLen,pPort->pFile);
                 }
 
-                Q_ADD(pPort->pQ, pBufHdr);
+                OMX_OSAL_QueuePush(pPort->hQueue, pBufHdr);
                 OMX_OSAL_EventSet(pCtx->hBufferCallbackEvent);
             }
 
@@ -437,7 +387,7 @@ OMX_ERRORTYPE DataMetabolismTest_SendNBuffers(
 
     if (OMX_DirInput == pPort->sPortDef.eDir)
     {
-        while ((0x0 != Q_INQUEUE(pPort->pQ)) && (0x0 != nNumBuffers))
+        while ((0x0 != OMX_OSAL_QueueCount(pPort->hQueue)) && (0x0 != nNumBuffers))
         {
             if (OMX_TRUE == pPort->bEOS)
             {
@@ -446,7 +396,7 @@ OMX_ERRORTYPE DataMetabolismTest_SendNBuffers(
                                         "End of stream on port, no more data to send\n");
             }
 
-            Q_REMOVE(pPort->pQ, pBufHdr);
+            OMX_OSAL_QueuePop(pPort->hQueue, 0, (OMX_PTR *)&pBufHdr);
             if (OMX_TRUE == bReadFromInputFile)
             {
                 pBufHdr->nFilledLen = OMX_OSAL_ReadFromBufferVarInputFile(  pBufHdr->pBuffer, 
@@ -474,9 +424,9 @@ OMX_ERRORTYPE DataMetabolismTest_SendNBuffers(
 
     } else
     {
-        while ((0x0 != Q_INQUEUE(pPort->pQ)) && (0x0 != nNumBuffers))
+        while ((0x0 != OMX_OSAL_QueueCount(pPort->hQueue)) && (0x0 != nNumBuffers))
         {
-            Q_REMOVE(pPort->pQ, pBufHdr);
+            OMX_OSAL_QueuePop(pPort->hQueue, 0, (OMX_PTR *)&pBufHdr);
 
             /* mark buffer header as empty on OMX_FillThisBuffer calls */
             pBufHdr->nFlags = 0x0; 
@@ -521,7 +471,7 @@ OMX_ERRORTYPE DataMetabolismTest_ProcessNBuffers(
         pPort = pCtx->aPorts; 
         for (i = 0; i < pCtx->nNumPorts; i++)
         {
-            nToSend = Q_INQUEUE(pPort->pQ);    
+            nToSend = OMX_OSAL_QueueCount(pPort->hQueue);    
             /*If nToSend greater than nBufToProcess,buffers to be processed 
               then restrict it to the number of buffers to be processed*/
             if(pPort->sPortDef.eDir==OMX_DirInput && (nToSend>nBufToProcess)) {
@@ -573,7 +523,7 @@ OMX_ERRORTYPE DataMetabolismTest_PortAllocateNumBuffers(
                                     pPort->sPortDef.nPortIndex, 
                                     pPort, pPort->sPortDef.nBufferSize);
         OMX_CONF_BAIL_ON_ERROR(eError);
-        Q_ADD(pPort->pQ, pBufHdr);
+        OMX_OSAL_QueuePush(pPort->hQueue, pBufHdr);
         if (pBufHdr->pAppPrivate != (OMX_PTR)pPort)
         {
             OMX_CONF_SET_ERROR_BAIL(eError, OMX_ErrorUndefined, 
@@ -599,9 +549,9 @@ OMX_ERRORTYPE DataMetabolismTest_PortFreeNumBuffers(
     OMX_ERRORTYPE eError = OMX_ErrorNone;
     OMX_BUFFERHEADERTYPE *pBufHdr = NULL;
 
-    while ((0x0 != Q_INQUEUE(pPort->pQ)) && (0x0 != nNumBuffers))
+    while ((0x0 != OMX_OSAL_QueueCount(pPort->hQueue)) && (0x0 != nNumBuffers))
     {
-        Q_REMOVE(pPort->pQ, pBufHdr);
+        OMX_OSAL_QueuePop(pPort->hQueue, 0, (OMX_PTR *)&pBufHdr);
         eError = OMX_FreeBuffer(pCtx->hWrappedComp, pPort->sPortDef.nPortIndex, pBufHdr);
         OMX_CONF_BAIL_ON_ERROR(eError);
         nNumBuffers--;
@@ -664,8 +614,7 @@ OMX_ERRORTYPE DataMetabolismTest_AllocatePortStructures(
             }
 
             /* allocate LIFO with that or the actual required buffers */
-            Q_ALLOC(pPort->pQ, (pPort->sPortDef.nBufferCountActual));
-            if (0x0 == pPort->pQ)
+            if (OMX_ErrorNone != OMX_OSAL_QueueCreate(pPort->sPortDef.nBufferCountActual, &pPort->hQueue))
             {
                 OMX_CONF_SET_ERROR_BAIL(eError, OMX_ErrorUndefined, 
                                         "memory allocation failure\n");
@@ -697,23 +646,23 @@ OMX_ERRORTYPE DataMetabolismTest_FreePortStructures(TEST_CTXTYPE *pCtx)
         for (i = 0; i < pCtx->nNumPorts; i++)
         {
             /* free all allocated buffers */
-            if (0x0 != pPort->pQ)
+            if (0x0 != pPort->hQueue)
             {
                 if (OMX_ErrorNone == eError)
                 {
                     /* record the return code, but don't exit on failure as the 
                        test has memory it must free */
-                    eError = DataMetabolismTest_PortFreeNumBuffers(pCtx, pPort, Q_INQUEUE(pPort->pQ));
+                    eError = DataMetabolismTest_PortFreeNumBuffers(pCtx, pPort, OMX_OSAL_QueueCount(pPort->hQueue));
   
                 } else
                 {
                     /* preserve the first failure from freeing buffers */
-                    DataMetabolismTest_PortFreeNumBuffers(pCtx, pPort, Q_INQUEUE(pPort->pQ));
+                    DataMetabolismTest_PortFreeNumBuffers(pCtx, pPort, OMX_OSAL_QueueCount(pPort->hQueue));
                 }    
        
                 /* free LIFO */
-                Q_FREE(pPort->pQ);
-                pPort->pQ = 0x0;
+                OMX_OSAL_QueueDestroy(pPort->hQueue);
+                pPort->hQueue = 0x0;
 
             }
 
@@ -745,7 +694,7 @@ OMX_ERRORTYPE DataMetabolismTest_AllocateAllBuffers(TEST_CTXTYPE *pCtx)
                        pPort->sPortDef.nBufferCountActual, pPort->sPortDef.nPortIndex);
         /* allocate all buffers on each port */
         nCount = pPort->sPortDef.nBufferCountActual;
-        nCount -= Q_INQUEUE(pPort->pQ);
+        nCount -= OMX_OSAL_QueueCount(pPort->hQueue);
         eError = DataMetabolismTest_PortAllocateNumBuffers(pCtx, pPort, nCount);
         OMX_CONF_BAIL_ON_ERROR(eError);
         pPort++;
@@ -772,7 +721,7 @@ OMX_ERRORTYPE DataMetabolismTest_FreeAllBuffers(TEST_CTXTYPE *pCtx)
         OMX_OSAL_Trace(OMX_OSAL_TRACE_INFO, "Freeing all buffers on port %i\n",
                        pPort->sPortDef.nPortIndex);
         eError = DataMetabolismTest_PortFreeNumBuffers(pCtx, pPort, 
-                                              Q_INQUEUE(pPort->pQ));
+                                              OMX_OSAL_QueueCount(pPort->hQueue));
         OMX_CONF_BAIL_ON_ERROR(eError);
         pPort++;
     }
@@ -43,7 +43,7 @@ OMX_ERRORTYPE StdComponentTest_PopulateRolesArray(OMX_STRING cComponentName, OMX
     eError = OMX_Init();
     OMX_CONF_BAIL_ON_ERROR(eError);
 
-    eError = OMX_GetRolesOfComponent (cComponentName, nNumRoles, NULL);
+    eError = OMX_CONF_TopologyGetRoles(cComponentName, nNumRoles, NULL);
     OMX_CONF_BAIL_ON_ERROR(eError);
   
     for (i = 0; i < *nNumRoles; i++) {
@@ -53,7 +53,7 @@ OMX_ERRORTYPE StdComponentTest_PopulateRolesArray(OMX_STRING cComponentName, OMX
         OMX_CONF_BAIL_ON_ERROR(eError);
     }
    
-    eError = OMX_GetRolesOfComponent (cComponentName, nNumRoles, (OMX_U8**) sRolesArray);
+    eError = OMX_CONF_TopologyGetRoles(cComponentName, nNumRoles, (OMX_U8**) sRolesArray);
     OMX_CONF_BAIL_ON_ERROR(eError);
 
     eError = OMX_Deinit();
@@ -212,8 +212,7 @@ OMX_BOOL StdComponentTest_IsInputPort(TEST_CTXTYPE *pCtx, OMX_U32 nPortIndex)
 
     OMX_CONF_INIT_STRUCT(sPortDefinition, OMX_PARAM_PORTDEFINITIONTYPE);
     sPortDefinition.nPortIndex = nPortIndex;
-    eError = OMX_GetParameter(pCtx->hWrappedComp, OMX_IndexParamPortDefinition,
-                              (OMX_PTR)&sPortDefinition);
+    eError = OMX_CONF_TopologyGetPort(pCtx->hWrappedComp, &sPortDefinition);
     OMX_CONF_BAIL_ON_ERROR(eError);
 
     if (sPortDefinition.eDir == OMX_DirInput) 
@@ -232,8 +231,7 @@ OMX_BOOL StdComponentTest_IsOutputPort(TEST_CTXTYPE *pCtx, OMX_U32 nPortIndex)
 
     OMX_CONF_INIT_STRUCT(sPortDefinition, OMX_PARAM_PORTDEFINITIONTYPE);
     sPortDefinition.nPortIndex = nPortIndex;
-    eError = OMX_GetParameter(pCtx->hWrappedComp, OMX_IndexParamPortDefinition,
-                              (OMX_PTR)&sPortDefinition);
+    eError = OMX_CONF_TopologyGetPort(pCtx->hWrappedComp, &sPortDefinition);
     OMX_CONF_BAIL_ON_ERROR(eError);
 
     if (sPortDefinition.eDir == OMX_DirOutput)